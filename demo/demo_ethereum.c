@@ -271,9 +271,9 @@ Function: BoatEthereumMainEntry(void)
 BOAT_RESULT BoatEthereumMainEntry(void)
 {
     BOAT_RESULT result = BOAT_SUCCESS;
-    BCHAR * cur_balance_wei = NULL;
-    BoatFieldVariable prase_result = {NULL, 0};
-	double cur_balance_eth = 0;
+    BUINT256 cur_balance_wei;
+    BUINT256 min_balance_wei;
+    BCHAR cur_balance_eth_str[BOAT_WEI_ETH_STR_SIZE];
 
 #if 1
     result = BoatEthereumPreCondition();
@@ -283,23 +283,20 @@ BOAT_RESULT BoatEthereumMainEntry(void)
 
     if ( BOAT_SUCCESS == result )
     {
-        cur_balance_wei = BoatEthWalletGetBalance(g_boat_ethereum_wallet_ptr, NULL);
-		result = BoatEthPraseRpcResponseResult( cur_balance_wei, "", &prase_result);
-		if( result == BOAT_SUCCESS )
-		{
-			BoatLog( BOAT_LOG_NORMAL, "BoatEthWalletGetBalance returns: %s", prase_result.field_ptr );
-		}
-		else
-		{
-			return BOAT_ERROR;
-		}
-		
-        BoatLog(BOAT_LOG_VERBOSE, "cur_balance_wei: %s wei", prase_result.field_ptr);
-        cur_balance_eth = UtilityWeiStrToEthDouble((BCHAR*)prase_result.field_ptr);
-        BoatLog(BOAT_LOG_VERBOSE, "cur_balance_eth: %10lf ETH", cur_balance_eth);
-        if (cur_balance_eth < 0.000001)
+        result = BoatEthWalletGetBalanceUint256(g_boat_ethereum_wallet_ptr, NULL, &cur_balance_wei);
+        if( result != BOAT_SUCCESS )
+        {
+            return BOAT_ERROR;
+        }
+
+        UtilityWeiToEthStr(cur_balance_eth_str, sizeof(cur_balance_eth_str), &cur_balance_wei);
+        BoatLog(BOAT_LOG_VERBOSE, "cur_balance_eth: %s ETH", cur_balance_eth_str);
+
+        // At least 0.000001 ETH, i.e. 1e12 wei
+        UtilityUint256FromUint64(&min_balance_wei, 1000000000000ull);
+        if (UtilityUint256Compare(&cur_balance_wei, &min_balance_wei) < 0)
         {
-            BoatLog(BOAT_LOG_NORMAL, "the account balance is not enough ETH, the current balance is: %10lf ETH", cur_balance_eth);
+            BoatLog(BOAT_LOG_NORMAL, "the account balance is not enough ETH, the current balance is: %s ETH", cur_balance_eth_str);
             return BOAT_ERROR;
         }
 
@@ -315,10 +312,6 @@ BOAT_RESULT BoatEthereumMainEntry(void)
         BoatLog(BOAT_LOG_NORMAL, "Block to Ethereum Chain Passed.");
     }
 
-	//free prase_result
-	BoatFree(prase_result.field_ptr);
-	prase_result.field_ptr = 0;
-	
     return result;
 }
 
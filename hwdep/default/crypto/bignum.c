@@ -556,7 +556,215 @@ void bn_sqrt(bignum256 *x, const bignum256 *prime)
 	memzero(&p, sizeof(p));
 }
 
-#if ! USE_INVERSE_FAST
+#if USE_INVERSE_SAFEGCD
+
+// Constant time modular inversion using the safegcd algorithm of Bernstein
+// and Yang ("Fast constant-time gcd computation and modular inversion"),
+// following the 30-bit variant of libsecp256k1's modinv32 by Peter Dettman
+// and Pieter Wuille.
+//
+// Numbers are kept as 9 signed 30-bit limbs, which is the bignum256 layout
+// with signed limbs. 20 rounds of 30 branchless divsteps each are done,
+// 600 >= 590 divsteps are enough for any modulus below 2^256.
+
+typedef struct {
+	int32_t v[9];
+} bn_signed30;
+
+// 2x2 transition matrix of 30 divsteps, scaled by 2^30
+typedef struct {
+	int32_t u, v, q, r;
+} bn_trans2x2;
+
+#define BN_M30 ((int32_t)0x3FFFFFFF)
+
+// apply 30 divsteps on the lowest limbs f0 (odd) and g0, return the new zeta
+// (zeta = -(delta + 1/2), starts at -1)
+static int32_t bn_divsteps_30(int32_t zeta, uint32_t f0, uint32_t g0, bn_trans2x2 *t)
+{
+	uint32_t u = 1, v = 0, q = 0, r = 1;
+	uint32_t c1, c2, f = f0, g = g0, x, y, z;
+	int i;
+
+	for (i = 0; i < 30; i++) {
+		// c1 = (zeta < 0) ? -1 : 0, c2 = (g odd) ? -1 : 0
+		c1 = (uint32_t)(zeta >> 31);
+		c2 = -(g & 1);
+		// conditionally negate f, u, v when zeta < 0
+		x = (f ^ c1) - c1;
+		y = (u ^ c1) - c1;
+		z = (v ^ c1) - c1;
+		// conditionally add them to g, q, r when g is odd
+		g += x & c2;
+		q += y & c2;
+		r += z & c2;
+		// swap when zeta < 0 and g was odd
+		c1 &= c2;
+		zeta = (int32_t)(((uint32_t)zeta ^ c1) - 1);
+		f += g & c1;
+		u += q & c1;
+		v += r & c1;
+		g >>= 1;
+		u <<= 1;
+		v <<= 1;
+	}
+	t->u = (int32_t)u;
+	t->v = (int32_t)v;
+	t->q = (int32_t)q;
+	t->r = (int32_t)r;
+	return zeta;
+}
+
+// [d, e] = t * [d, e] / 2^30 mod modulus, adding multiples of the modulus
+// to make the division exact. inputs and outputs are in (-2*modulus, modulus)
+static void bn_update_de_30(bn_signed30 *d, bn_signed30 *e, const bn_trans2x2 *t, const bn_signed30 *modulus, uint32_t modulus_inv30)
+{
+	const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+	int32_t di, ei, md, me, sd, se;
+	int64_t cd, ce;
+	int i;
+
+	// md, me are chosen so that the lowest 30 bits of the result vanish
+	// and negative inputs get the modulus added
+	sd = d->v[8] >> 31;
+	se = e->v[8] >> 31;
+	md = (u & sd) + (v & se);
+	me = (q & sd) + (r & se);
+	di = d->v[0];
+	ei = e->v[0];
+	cd = (int64_t)u * di + (int64_t)v * ei;
+	ce = (int64_t)q * di + (int64_t)r * ei;
+	md -= (int32_t)((modulus_inv30 * (uint32_t)cd + (uint32_t)md) & BN_M30);
+	me -= (int32_t)((modulus_inv30 * (uint32_t)ce + (uint32_t)me) & BN_M30);
+	cd += (int64_t)modulus->v[0] * md;
+	ce += (int64_t)modulus->v[0] * me;
+	cd >>= 30;
+	ce >>= 30;
+	for (i = 1; i < 9; i++) {
+		di = d->v[i];
+		ei = e->v[i];
+		cd += (int64_t)u * di + (int64_t)v * ei + (int64_t)modulus->v[i] * md;
+		ce += (int64_t)q * di + (int64_t)r * ei + (int64_t)modulus->v[i] * me;
+		d->v[i - 1] = (int32_t)cd & BN_M30;
+		e->v[i - 1] = (int32_t)ce & BN_M30;
+		cd >>= 30;
+		ce >>= 30;
+	}
+	d->v[8] = (int32_t)cd;
+	e->v[8] = (int32_t)ce;
+}
+
+// [f, g] = t * [f, g] / 2^30 (the division is exact)
+static void bn_update_fg_30(bn_signed30 *f, bn_signed30 *g, const bn_trans2x2 *t)
+{
+	const int32_t u = t->u, v = t->v, q = t->q, r = t->r;
+	int32_t fi, gi;
+	int64_t cf, cg;
+	int i;
+
+	fi = f->v[0];
+	gi = g->v[0];
+	cf = (int64_t)u * fi + (int64_t)v * gi;
+	cg = (int64_t)q * fi + (int64_t)r * gi;
+	cf >>= 30;
+	cg >>= 30;
+	for (i = 1; i < 9; i++) {
+		fi = f->v[i];
+		gi = g->v[i];
+		cf += (int64_t)u * fi + (int64_t)v * gi;
+		cg += (int64_t)q * fi + (int64_t)r * gi;
+		f->v[i - 1] = (int32_t)cf & BN_M30;
+		g->v[i - 1] = (int32_t)cg & BN_M30;
+		cf >>= 30;
+		cg >>= 30;
+	}
+	f->v[8] = (int32_t)cf;
+	g->v[8] = (int32_t)cg;
+}
+
+// bring d from (-2*modulus, modulus) to [0, modulus), negating it first
+// if sign < 0. the result limbs are normalized to 30 bits.
+static void bn_normalize_30(bn_signed30 *d, int32_t sign, const bn_signed30 *modulus)
+{
+	int32_t cond_add, cond_negate;
+	int i;
+
+	cond_add = d->v[8] >> 31;
+	for (i = 0; i < 9; i++) {
+		d->v[i] += modulus->v[i] & cond_add;
+	}
+	cond_negate = sign >> 31;
+	for (i = 0; i < 9; i++) {
+		d->v[i] = (d->v[i] ^ cond_negate) - cond_negate;
+	}
+	for (i = 0; i < 8; i++) {
+		d->v[i + 1] += d->v[i] >> 30;
+		d->v[i] &= BN_M30;
+	}
+	cond_add = d->v[8] >> 31;
+	for (i = 0; i < 9; i++) {
+		d->v[i] += modulus->v[i] & cond_add;
+	}
+	for (i = 0; i < 8; i++) {
+		d->v[i + 1] += d->v[i] >> 30;
+		d->v[i] &= BN_M30;
+	}
+}
+
+// in field G_prime, constant time
+// prime must be odd and below 2^256 (any curve prime or group order).
+// the input must not be 0 mod prime.
+// the result is smaller than prime
+void bn_inverse(bignum256 *x, const bignum256 *prime)
+{
+	bn_signed30 d, e, f, g, modulus;
+	bn_trans2x2 t;
+	uint32_t modulus_inv30;
+	int32_t zeta = -1;
+	int i;
+
+	// reduce x modulo prime, the divsteps need 0 <= x < prime
+	bn_fast_mod(x, prime);
+	bn_mod(x, prime);
+
+	for (i = 0; i < 9; i++) {
+		modulus.v[i] = (int32_t)prime->val[i];
+		f.v[i] = modulus.v[i];
+		g.v[i] = (int32_t)x->val[i];
+		d.v[i] = 0;
+		e.v[i] = 0;
+	}
+	e.v[0] = 1;
+
+	// prime^-1 mod 2^30 by Newton iteration, each step doubles the
+	// number of correct bits (prime * prime == 1 mod 8 for odd prime)
+	modulus_inv30 = prime->val[0];
+	for (i = 0; i < 4; i++) {
+		modulus_inv30 *= 2 - prime->val[0] * modulus_inv30;
+	}
+
+	for (i = 0; i < 20; i++) {
+		zeta = bn_divsteps_30(zeta, (uint32_t)f.v[0], (uint32_t)g.v[0], &t);
+		bn_update_de_30(&d, &e, &t, &modulus, modulus_inv30);
+		bn_update_fg_30(&f, &g, &t);
+	}
+
+	// f is now +-1, d holds +-x^-1
+	bn_normalize_30(&d, f.v[8], &modulus);
+	for (i = 0; i < 9; i++) {
+		x->val[i] = (uint32_t)d.v[i];
+	}
+
+	memzero(&d, sizeof(d));
+	memzero(&e, sizeof(e));
+	memzero(&f, sizeof(f));
+	memzero(&g, sizeof(g));
+	memzero(&t, sizeof(t));
+}
+
+#undef BN_M30
+
+#elif ! USE_INVERSE_FAST
 
 // in field G_prime, small but slow
 void bn_inverse(bignum256 *x, const bignum256 *prime)
@@ -591,12 +799,16 @@ void bn_inverse(bignum256 *x, const bignum256 *prime)
 	memcpy(x, &res, sizeof(bignum256));
 }
 
-#else
+#endif
+
+#if USE_INVERSE_FAST
 
-// in field G_prime, big and complicated but fast
+// in field G_prime, big and complicated but fast, not constant time
 // the input must not be 0 mod prime.
 // the result is smaller than prime
-void bn_inverse(bignum256 *x, const bignum256 *prime)
+// with USE_INVERSE_SAFEGCD this is kept only to cross-check and benchmark
+// the safegcd bn_inverse() against
+void bn_inverse_fast(bignum256 *x, const bignum256 *prime)
 {
 	int i, j, k, cmp;
 	struct combo {
@@ -865,6 +1077,14 @@ void bn_inverse(bignum256 *x, const bignum256 *prime)
 	memzero(&us, sizeof(us));
 	memzero(&vr, sizeof(vr));
 }
+
+#if ! USE_INVERSE_SAFEGCD
+void bn_inverse(bignum256 *x, const bignum256 *prime)
+{
+	bn_inverse_fast(x, prime);
+}
+#endif
+
 #endif
 
 void bn_normalize(bignum256 *a) {
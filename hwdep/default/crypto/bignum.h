@@ -131,6 +131,10 @@ void bn_sqrt(bignum256 *x, const bignum256 *prime);
 
 void bn_inverse(bignum256 *x, const bignum256 *prime);
 
+#if USE_INVERSE_FAST
+void bn_inverse_fast(bignum256 *x, const bignum256 *prime);
+#endif
+
 void bn_normalize(bignum256 *a);
 
 void bn_add(bignum256 *a, const bignum256 *b);
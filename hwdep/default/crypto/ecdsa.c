@@ -34,6 +34,7 @@
 #include "ecdsa.h"
 #include "base58.h"
 #include "secp256k1.h"
+#include "secp256k1_fe52.h"
 #include "rfc6979.h"
 #include "memzero.h"
 
@@ -431,14 +432,21 @@ void point_multiply(const ecdsa_curve *curve, const bignum256 *k, const curve_po
 	//  Side Channel Attacks.
 	assert (bn_is_less(k, &curve->order));
 
+#if USE_SECP256K1_5X52
+	if (curve == &secp256k1) {
+		point52_multiply(k, p, res);
+		return;
+	}
+#endif
+
 	int i, j;
-	static CONFIDENTIAL bignum256 a;
+	bignum256 a;
 	uint32_t *aptr;
 	uint32_t abits;
 	int ashift;
 	uint32_t is_even = (k->val[0] & 1) - 1;
 	uint32_t bits, sign, nsign;
-	static CONFIDENTIAL jacobian_curve_point jres;
+	jacobian_curve_point jres;
 	curve_point pmult[8];
 	const bignum256 *prime = &curve->prime;
 
@@ -552,11 +560,18 @@ void scalar_multiply(const ecdsa_curve *curve, const bignum256 *k, curve_point *
 {
 	assert (bn_is_less(k, &curve->order));
 
+#if USE_SECP256K1_5X52
+	if (curve == &secp256k1) {
+		scalar52_multiply(k, res);
+		return;
+	}
+#endif
+
 	int i, j;
-	static CONFIDENTIAL bignum256 a;
+	bignum256 a;
 	uint32_t is_even = (k->val[0] & 1) - 1;
 	uint32_t lowbits;
-	static CONFIDENTIAL jacobian_curve_point jres;
+	jacobian_curve_point jres;
 	const bignum256 *prime = &curve->prime;
 
 	// is_even = 0xffffffff if k is even, 0 otherwise.
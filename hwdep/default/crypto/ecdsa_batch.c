@@ -0,0 +1,675 @@
+/**
+ * Copyright (c) 2020 aitos.io
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+ * OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "bignum.h"
+#include "ecdsa.h"
+#include "ecdsa_batch.h"
+#include "secp256k1.h"
+#include "secp256k1_fe52.h"
+#include "memzero.h"
+
+#if USE_ECDSA_BATCH_THREADS
+#include <pthread.h>
+#endif
+
+// Everything in here only handles public data (signatures, digests and
+// public keys), so variable time algorithms are fine.
+
+static void ecdsa_verify_digest_each(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count)
+{
+	size_t i;
+	for (i = 0; i < count; i++) {
+		items[i].result = ecdsa_verify_digest(curve, items[i].pub_key, items[i].sig, items[i].digest);
+	}
+}
+
+static void ecdsa_recover_pub_from_sig_each(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count)
+{
+	size_t i;
+	for (i = 0; i < count; i++) {
+		items[i].result = ecdsa_recover_pub_from_sig(curve, items[i].pub_key_out, items[i].sig, items[i].digest, items[i].recid);
+	}
+}
+
+#if USE_SECP256K1_5X52
+
+// signatures handled at once. The inversions of a chunk are shared, the
+// stack usage is about 1.5kB per item.
+#define ECDSA_BATCH_CHUNK 16
+
+// wNAF window width, the tables hold the odd multiples 1P, 3P, .. 15P
+#define ECDSA_BATCH_WINDOW 5
+#define ECDSA_BATCH_TABLE (1 << (ECDSA_BATCH_WINDOW - 2))
+
+#define ECDSA_BATCH_WNAF_LEN 257
+
+// affine point
+typedef struct {
+	fe52 x, y;
+} ge52;
+
+// jacobian point that can be infinity
+typedef struct {
+	jacobian_point52 p;
+	int infinity;
+} gej52;
+
+// r[i] = a[i]^-1 for all i using a single inversion (Montgomery's trick)
+// all a[i] must be non-zero, r and a must not overlap
+static void fe52_inverse_all(fe52 *r, const fe52 *a, size_t n)
+{
+	fe52 inv, t;
+	size_t i;
+
+	if (n == 0) {
+		return;
+	}
+	// r[i] = a[0] * .. * a[i]
+	r[0] = a[0];
+	for (i = 1; i < n; i++) {
+		fe52_mul(&r[i], &r[i - 1], &a[i]);
+	}
+	fe52_inverse(&inv, &r[n - 1]);
+	for (i = n - 1; i > 0; i--) {
+		fe52_mul(&t, &inv, &r[i - 1]);
+		fe52_mul(&inv, &inv, &a[i]);
+		r[i] = t;
+	}
+	r[0] = inv;
+}
+
+// x[i] = x[i]^-1 mod prime for all i using a single inversion
+// all x[i] must be non-zero
+static void bn_inverse_all(bignum256 *x, size_t n, const bignum256 *prime)
+{
+	bignum256 acc[ECDSA_BATCH_CHUNK];
+	bignum256 inv, t;
+	size_t i;
+
+	if (n == 0) {
+		return;
+	}
+	acc[0] = x[0];
+	for (i = 1; i < n; i++) {
+		acc[i] = acc[i - 1];
+		bn_multiply(&x[i], &acc[i], prime);
+	}
+	inv = acc[n - 1];
+	bn_inverse(&inv, prime);
+	for (i = n - 1; i > 0; i--) {
+		t = inv;
+		bn_multiply(&acc[i - 1], &t, prime);
+		bn_multiply(&x[i], &inv, prime);
+		bn_mod(&t, prime);
+		x[i] = t;
+	}
+	bn_mod(&inv, prime);
+	x[0] = inv;
+}
+
+static void ge52_set_jacobian(ge52 *r, const jacobian_point52 *a, const fe52 *zinv)
+{
+	fe52 zi2, zi3;
+	fe52_sqr(&zi2, zinv);
+	fe52_mul(&zi3, &zi2, zinv);
+	fe52_mul(&r->x, &a->x, &zi2);
+	fe52_mul(&r->y, &a->y, &zi3);
+}
+
+// y^2 = x^3 + 7, y gets the parity odd, returns 0 if x is not on the curve
+static int ge52_set_xo(ge52 *r, const bignum256 *x, int odd)
+{
+	fe52 t, seven;
+
+	fe52_from_bn(x, &r->x);
+	fe52_sqr(&t, &r->x);
+	fe52_mul(&t, &t, &r->x);
+	fe52_set_int(&seven, 7);
+	fe52_add(&t, &seven);
+	if (!fe52_sqrt(&r->y, &t)) {
+		return 0;
+	}
+	fe52_normalize(&r->y);
+	if ((int)(r->y.n[0] & 1) != (odd & 1)) {
+		fe52_negate(&r->y, &r->y, 1);
+		fe52_normalize(&r->y);
+	}
+	return 1;
+}
+
+// same as ecdsa_read_pubkey() for secp256k1
+static int ge52_read_pubkey(const uint8_t *pub_key, ge52 *q)
+{
+	bignum256 x, y;
+	fe52 lhs, rhs, seven;
+
+	if (pub_key[0] == 0x04) {
+		bn_read_be(pub_key + 1, &x);
+		bn_read_be(pub_key + 33, &y);
+		if (!bn_is_less(&x, &secp256k1.prime) || !bn_is_less(&y, &secp256k1.prime)) {
+			return 0;
+		}
+		fe52_from_bn(&x, &q->x);
+		fe52_from_bn(&y, &q->y);
+		fe52_sqr(&lhs, &q->y);
+		fe52_sqr(&rhs, &q->x);
+		fe52_mul(&rhs, &rhs, &q->x);
+		fe52_set_int(&seven, 7);
+		fe52_add(&rhs, &seven);
+		return fe52_equal(&lhs, &rhs);
+	}
+	if (pub_key[0] == 0x02 || pub_key[0] == 0x03) {
+		bn_read_be(pub_key + 1, &x);
+		if (!bn_is_less(&x, &secp256k1.prime)) {
+			return 0;
+		}
+		return ge52_set_xo(q, &x, pub_key[0]);
+	}
+	return 0;
+}
+
+// r += b, with all special cases (infinity, doubling, inverse)
+static void gej52_add_ge_var(gej52 *r, const ge52 *b)
+{
+	fe52 z12, u1, u2, s1, s2, h, i, i2, h2, h3, t;
+
+	if (r->infinity) {
+		r->p.x = b->x;
+		r->p.y = b->y;
+		fe52_set_int(&r->p.z, 1);
+		r->infinity = 0;
+		return;
+	}
+
+	fe52_sqr(&z12, &r->p.z);
+	u1 = r->p.x;
+	fe52_mul(&u2, &b->x, &z12);
+	s1 = r->p.y;
+	fe52_mul(&s2, &b->y, &z12);
+	fe52_mul(&s2, &s2, &r->p.z);
+	fe52_negate(&h, &u1, 1);
+	fe52_add(&h, &u2);                 // h = u2 - u1
+	fe52_negate(&i, &s1, 1);
+	fe52_add(&i, &s2);                 // i = s2 - s1
+
+	if (fe52_normalizes_to_zero(&h)) {
+		if (fe52_normalizes_to_zero(&i)) {
+			point52_jacobian_double(&r->p);
+		} else {
+			r->infinity = 1;
+		}
+		return;
+	}
+
+	fe52_sqr(&i2, &i);
+	fe52_sqr(&h2, &h);
+	fe52_mul(&h3, &h, &h2);
+	fe52_mul(&r->p.z, &r->p.z, &h);    // z3 = z1*h
+	fe52_mul(&t, &u1, &h2);            // t = u1*h^2
+
+	// x3 = i^2 - h^3 - 2*u1*h^2
+	r->p.x = t;
+	fe52_mul_int(&r->p.x, 2);
+	fe52_add(&r->p.x, &h3);
+	fe52_negate(&r->p.x, &r->p.x, 3);
+	fe52_add(&r->p.x, &i2);
+	fe52_normalize_weak(&r->p.x);
+
+	// y3 = i*(u1*h^2 - x3) - s1*h^3
+	fe52_negate(&r->p.y, &r->p.x, 1);
+	fe52_add(&r->p.y, &t);
+	fe52_mul(&r->p.y, &r->p.y, &i);
+	fe52_mul(&h3, &h3, &s1);
+	fe52_negate(&h3, &h3, 1);
+	fe52_add(&r->p.y, &h3);
+	fe52_normalize_weak(&r->p.y);
+}
+
+static void gej52_add_table_var(gej52 *r, const ge52 *table, int digit)
+{
+	ge52 neg;
+
+	if (digit > 0) {
+		gej52_add_ge_var(r, &table[(digit - 1) / 2]);
+	} else {
+		neg.x = table[(-digit - 1) / 2].x;
+		fe52_negate(&neg.y, &table[(-digit - 1) / 2].y, 1);
+		fe52_normalize_weak(&neg.y);
+		gej52_add_ge_var(r, &neg);
+	}
+}
+
+// width-w non-adjacent form of a, returns the number of digits
+static int ecdsa_batch_wnaf(int8_t *wnaf, const bignum256 *a)
+{
+	uint8_t bytes[32];
+	uint32_t k[9];
+	uint32_t carry;
+	int i, len = 0, digit;
+
+	bn_write_le(a, bytes);
+	for (i = 0; i < 8; i++) {
+		k[i] = read_le(bytes + 4 * i);
+	}
+	k[8] = 0;
+
+	memset(wnaf, 0, ECDSA_BATCH_WNAF_LEN);
+	while (k[0] | k[1] | k[2] | k[3] | k[4] | k[5] | k[6] | k[7] | k[8]) {
+		digit = 0;
+		if (k[0] & 1) {
+			digit = k[0] & ((1 << ECDSA_BATCH_WINDOW) - 1);
+			if (digit >= (1 << (ECDSA_BATCH_WINDOW - 1))) {
+				digit -= (1 << ECDSA_BATCH_WINDOW);
+			}
+			// k -= digit, the low bits become zero
+			if (digit > 0) {
+				k[0] -= digit;
+			} else {
+				carry = (uint32_t)-digit;
+				for (i = 0; i < 9 && carry; i++) {
+					k[i] += carry;
+					carry = k[i] < carry;
+				}
+			}
+		}
+		wnaf[len++] = (int8_t)digit;
+		for (i = 0; i < 8; i++) {
+			k[i] = (k[i] >> 1) | (k[i + 1] << 31);
+		}
+		k[8] >>= 1;
+	}
+	return len;
+}
+
+static void ecdsa_batch_g_table(ge52 *gtable)
+{
+	int j;
+#if USE_PRECOMPUTED_CP
+	// secp256k1.cp[0][j] = (2*j+1) * G
+	for (j = 0; j < ECDSA_BATCH_TABLE; j++) {
+		fe52_from_bn(&secp256k1.cp[0][j].x, &gtable[j].x);
+		fe52_from_bn(&secp256k1.cp[0][j].y, &gtable[j].y);
+	}
+#else
+	curve_point pmult[ECDSA_BATCH_TABLE], g2;
+	g2 = secp256k1.G;
+	point_double(&secp256k1, &g2);
+	pmult[0] = secp256k1.G;
+	for (j = 1; j < ECDSA_BATCH_TABLE; j++) {
+		pmult[j] = g2;
+		point_add(&secp256k1, &pmult[j - 1], &pmult[j]);
+	}
+	for (j = 0; j < ECDSA_BATCH_TABLE; j++) {
+		fe52_from_bn(&pmult[j].x, &gtable[j].x);
+		fe52_from_bn(&pmult[j].y, &gtable[j].y);
+	}
+#endif
+}
+
+// res[i] = u1[i] * G + u2[i] * q[i] for i < n <= ECDSA_BATCH_CHUNK
+// using Shamir/Strauss interleaving with wNAF. The tables of odd multiples
+// of all q[i] are converted to affine with two shared inversions.
+static void ecdsa_batch_ecmult(const ge52 *gtable, const ge52 *q, const bignum256 *u1, const bignum256 *u2, gej52 *res, size_t n)
+{
+	ge52 table[ECDSA_BATCH_CHUNK][ECDSA_BATCH_TABLE];
+	ge52 dbl[ECDSA_BATCH_CHUNK];
+	jacobian_point52 jdbl[ECDSA_BATCH_CHUNK];
+	fe52 zs[ECDSA_BATCH_CHUNK * (ECDSA_BATCH_TABLE - 1)];
+	fe52 zinv[ECDSA_BATCH_CHUNK * (ECDSA_BATCH_TABLE - 1)];
+	int8_t wnaf1[ECDSA_BATCH_WNAF_LEN], wnaf2[ECDSA_BATCH_WNAF_LEN];
+	gej52 acc;
+	size_t i;
+	int j, len1, len2, bit;
+
+	// 2*q[i], then all odd multiples q[i] + k*2*q[i]
+	for (i = 0; i < n; i++) {
+		jdbl[i].x = q[i].x;
+		jdbl[i].y = q[i].y;
+		fe52_set_int(&jdbl[i].z, 1);
+		point52_jacobian_double(&jdbl[i]);
+		zs[i] = jdbl[i].z;
+	}
+	fe52_inverse_all(zinv, zs, n);
+	for (i = 0; i < n; i++) {
+		ge52_set_jacobian(&dbl[i], &jdbl[i], &zinv[i]);
+	}
+
+	for (i = 0; i < n; i++) {
+		table[i][0] = q[i];
+		acc.infinity = 1;
+		gej52_add_ge_var(&acc, &q[i]);
+		for (j = 1; j < ECDSA_BATCH_TABLE; j++) {
+			gej52_add_ge_var(&acc, &dbl[i]);
+			table[i][j].x = acc.p.x;
+			table[i][j].y = acc.p.y;
+			zs[i * (ECDSA_BATCH_TABLE - 1) + j - 1] = acc.p.z;
+		}
+	}
+	fe52_inverse_all(zinv, zs, n * (ECDSA_BATCH_TABLE - 1));
+	for (i = 0; i < n; i++) {
+		for (j = 1; j < ECDSA_BATCH_TABLE; j++) {
+			jacobian_point52 jp;
+			jp.x = table[i][j].x;
+			jp.y = table[i][j].y;
+			ge52_set_jacobian(&table[i][j], &jp, &zinv[i * (ECDSA_BATCH_TABLE - 1) + j - 1]);
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		len1 = ecdsa_batch_wnaf(wnaf1, &u1[i]);
+		len2 = ecdsa_batch_wnaf(wnaf2, &u2[i]);
+		res[i].infinity = 1;
+		for (bit = (len1 > len2 ? len1 : len2) - 1; bit >= 0; bit--) {
+			if (!res[i].infinity) {
+				point52_jacobian_double(&res[i].p);
+			}
+			if (wnaf1[bit]) {
+				gej52_add_table_var(&res[i], gtable, wnaf1[bit]);
+			}
+			if (wnaf2[bit]) {
+				gej52_add_table_var(&res[i], table[i], wnaf2[bit]);
+			}
+		}
+	}
+}
+
+static void ecdsa_verify_digest_chunk(const ge52 *gtable, ecdsa_batch_item *items, size_t count)
+{
+	ge52 q[ECDSA_BATCH_CHUNK];
+	bignum256 r[ECDSA_BATCH_CHUNK], s[ECDSA_BATCH_CHUNK];
+	bignum256 u1[ECDSA_BATCH_CHUNK], u2[ECDSA_BATCH_CHUNK];
+	gej52 res[ECDSA_BATCH_CHUNK];
+	size_t idx[ECDSA_BATCH_CHUNK];
+	size_t i, n = 0;
+	const bignum256 *order = &secp256k1.order;
+
+	for (i = 0; i < count; i++) {
+		ecdsa_batch_item *item = &items[i];
+		if (!ge52_read_pubkey(item->pub_key, &q[n])) {
+			item->result = 1;
+			continue;
+		}
+		bn_read_be(item->sig, &r[n]);
+		bn_read_be(item->sig + 32, &s[n]);
+		if (bn_is_zero(&r[n]) || bn_is_zero(&s[n]) ||
+			(!bn_is_less(&r[n], order)) ||
+			(!bn_is_less(&s[n], order))) {
+			item->result = 2;
+			continue;
+		}
+		idx[n++] = i;
+	}
+
+	bn_inverse_all(s, n, order);                   // s^-1
+
+	for (i = 0; i < n; i++) {
+		bn_read_be(items[idx[i]].digest, &u1[i]);
+		bn_multiply(&s[i], &u1[i], order);         // z*s^-1
+		bn_mod(&u1[i], order);
+		u2[i] = r[i];
+		bn_multiply(&s[i], &u2[i], order);         // r*s^-1
+		bn_mod(&u2[i], order);
+	}
+
+	ecdsa_batch_ecmult(gtable, q, u1, u2, res, n);
+
+	for (i = 0; i < n; i++) {
+		ecdsa_batch_item *item = &items[idx[i]];
+		fe52 zz, rz;
+		bignum256 rn;
+
+		if (bn_is_zero(&u1[i])) {
+			// our message hashes to zero
+			item->result = 3;
+			continue;
+		}
+		if (res[i].infinity) {
+			item->result = 5;
+			continue;
+		}
+		// compare x/z^2 mod n with r without an inversion:
+		// x == r*z^2, or x == (r+n)*z^2 if r+n < p
+		fe52_sqr(&zz, &res[i].p.z);
+		fe52_from_bn(&r[i], &rz);
+		fe52_mul(&rz, &rz, &zz);
+		if (fe52_equal(&rz, &res[i].p.x)) {
+			item->result = 0;
+			continue;
+		}
+		rn = r[i];
+		bn_add(&rn, order);
+		if (bn_is_less(&rn, &secp256k1.prime)) {
+			fe52_from_bn(&rn, &rz);
+			fe52_mul(&rz, &rz, &zz);
+			if (fe52_equal(&rz, &res[i].p.x)) {
+				item->result = 0;
+				continue;
+			}
+		}
+		item->result = 5;
+	}
+}
+
+static void ecdsa_recover_pub_from_sig_chunk(const ge52 *gtable, ecdsa_batch_item *items, size_t count)
+{
+	ge52 q[ECDSA_BATCH_CHUNK];
+	bignum256 r[ECDSA_BATCH_CHUNK], s[ECDSA_BATCH_CHUNK];
+	bignum256 u1[ECDSA_BATCH_CHUNK], u2[ECDSA_BATCH_CHUNK];
+	gej52 res[ECDSA_BATCH_CHUNK];
+	fe52 zs[ECDSA_BATCH_CHUNK], zinv[ECDSA_BATCH_CHUNK];
+	size_t idx[ECDSA_BATCH_CHUNK];
+	size_t i, n = 0, m = 0;
+	const bignum256 *order = &secp256k1.order;
+
+	for (i = 0; i < count; i++) {
+		ecdsa_batch_item *item = &items[i];
+		bignum256 x;
+
+		item->result = 1;
+		bn_read_be(item->sig, &r[n]);
+		bn_read_be(item->sig + 32, &s[n]);
+		if (!bn_is_less(&r[n], order) || bn_is_zero(&r[n])) {
+			continue;
+		}
+		if (!bn_is_less(&s[n], order) || bn_is_zero(&s[n])) {
+			continue;
+		}
+		// R = k * G (k is secret nonce when signing)
+		x = r[n];
+		if (item->recid & 2) {
+			bn_add(&x, order);
+			if (!bn_is_less(&x, &secp256k1.prime)) {
+				continue;
+			}
+		}
+		if (!ge52_set_xo(&q[n], &x, item->recid & 1)) {
+			continue;
+		}
+		idx[n++] = i;
+	}
+
+	bn_inverse_all(r, n, order);                   // r^-1
+
+	for (i = 0; i < n; i++) {
+		// pub = r^-1 * (s*R - digest*G)
+		bn_read_be(items[idx[i]].digest, &u1[i]);
+		bn_subtractmod(order, &u1[i], &u1[i], order);
+		bn_fast_mod(&u1[i], order);
+		bn_mod(&u1[i], order);
+		bn_multiply(&r[i], &u1[i], order);         // -digest * r^-1
+		bn_mod(&u1[i], order);
+		u2[i] = s[i];
+		bn_multiply(&r[i], &u2[i], order);         // s * r^-1
+		bn_mod(&u2[i], order);
+	}
+
+	ecdsa_batch_ecmult(gtable, q, u1, u2, res, n);
+
+	for (i = 0; i < n; i++) {
+		if (!res[i].infinity) {
+			zs[m++] = res[i].p.z;
+		}
+	}
+	fe52_inverse_all(zinv, zs, m);
+
+	for (i = 0, m = 0; i < n; i++) {
+		ecdsa_batch_item *item = &items[idx[i]];
+		ge52 pub;
+		bignum256 coord;
+
+		if (res[i].infinity) {
+			continue;
+		}
+		ge52_set_jacobian(&pub, &res[i].p, &zinv[m++]);
+		item->pub_key_out[0] = 0x04;
+		fe52_to_bn(&pub.x, &coord);
+		bn_write_be(&coord, item->pub_key_out + 1);
+		fe52_to_bn(&pub.y, &coord);
+		bn_write_be(&coord, item->pub_key_out + 33);
+		item->result = 0;
+	}
+}
+
+#endif
+
+void ecdsa_verify_digest_batch(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count)
+{
+#if USE_SECP256K1_5X52
+	if (curve == &secp256k1) {
+		ge52 gtable[ECDSA_BATCH_TABLE];
+		size_t n;
+
+		ecdsa_batch_g_table(gtable);
+		while (count > 0) {
+			n = count < ECDSA_BATCH_CHUNK ? count : ECDSA_BATCH_CHUNK;
+			ecdsa_verify_digest_chunk(gtable, items, n);
+			items += n;
+			count -= n;
+		}
+		return;
+	}
+#endif
+	ecdsa_verify_digest_each(curve, items, count);
+}
+
+void ecdsa_recover_pub_from_sig_batch(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count)
+{
+#if USE_SECP256K1_5X52
+	if (curve == &secp256k1) {
+		ge52 gtable[ECDSA_BATCH_TABLE];
+		size_t n;
+
+		ecdsa_batch_g_table(gtable);
+		while (count > 0) {
+			n = count < ECDSA_BATCH_CHUNK ? count : ECDSA_BATCH_CHUNK;
+			ecdsa_recover_pub_from_sig_chunk(gtable, items, n);
+			items += n;
+			count -= n;
+		}
+		return;
+	}
+#endif
+	ecdsa_recover_pub_from_sig_each(curve, items, count);
+}
+
+#if USE_ECDSA_BATCH_THREADS
+
+#define ECDSA_BATCH_MAX_THREADS 64
+
+typedef struct {
+	const ecdsa_curve *curve;
+	ecdsa_batch_item *items;
+	size_t count;
+	int recover;
+} ecdsa_batch_job;
+
+static void *ecdsa_batch_thread(void *arg)
+{
+	ecdsa_batch_job *job = (ecdsa_batch_job *)arg;
+	if (job->recover) {
+		ecdsa_recover_pub_from_sig_batch(job->curve, job->items, job->count);
+	} else {
+		ecdsa_verify_digest_batch(job->curve, job->items, job->count);
+	}
+	return NULL;
+}
+
+static int ecdsa_batch_mt(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count, int num_threads, int recover)
+{
+	pthread_t threads[ECDSA_BATCH_MAX_THREADS];
+	int started[ECDSA_BATCH_MAX_THREADS];
+	ecdsa_batch_job jobs[ECDSA_BATCH_MAX_THREADS];
+	size_t per_thread, offset = 0;
+	int t, nt = num_threads, ret = 0;
+
+	// the generic point multiplication uses static buffers, only the
+	// secp256k1 batch code may run in several threads
+	if (curve != &secp256k1 || !USE_SECP256K1_5X52 || nt <= 1 || count < 2) {
+		nt = 1;
+	}
+	if (nt > ECDSA_BATCH_MAX_THREADS) {
+		nt = ECDSA_BATCH_MAX_THREADS;
+	}
+	per_thread = (count + nt - 1) / nt;
+
+	for (t = 0; t < nt; t++) {
+		jobs[t].curve = curve;
+		jobs[t].items = items + offset;
+		jobs[t].count = offset >= count ? 0 : (count - offset < per_thread ? count - offset : per_thread);
+		jobs[t].recover = recover;
+		offset += jobs[t].count;
+		started[t] = 0;
+		// job 0 runs in the calling thread
+		if (t > 0 && jobs[t].count > 0) {
+			started[t] = pthread_create(&threads[t], NULL, ecdsa_batch_thread, &jobs[t]) == 0;
+			if (!started[t]) {
+				ret = 1;
+			}
+		}
+	}
+
+	ecdsa_batch_thread(&jobs[0]);
+
+	for (t = 1; t < nt; t++) {
+		if (started[t]) {
+			pthread_join(threads[t], NULL);
+		} else if (jobs[t].count > 0) {
+			ecdsa_batch_thread(&jobs[t]);
+		}
+	}
+	return ret;
+}
+
+int ecdsa_verify_digest_batch_mt(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count, int num_threads)
+{
+	return ecdsa_batch_mt(curve, items, count, num_threads, 0);
+}
+
+int ecdsa_recover_pub_from_sig_batch_mt(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count, int num_threads)
+{
+	return ecdsa_batch_mt(curve, items, count, num_threads, 1);
+}
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2020 aitos.io
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+ * OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __ECDSA_BATCH_H__
+#define __ECDSA_BATCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "options.h"
+#include "ecdsa.h"
+
+// one signature of a batch
+typedef struct {
+	const uint8_t *sig;       // 64 bytes r || s
+	const uint8_t *digest;    // 32 bytes message digest
+	const uint8_t *pub_key;   // verify: 33 or 65 bytes public key
+	uint8_t *pub_key_out;     // recover: 65 bytes buffer for the public key
+	int recid;                // recover: recovery id (0..3)
+	int result;               // output: 0 on success, otherwise the same
+	                          // code as ecdsa_verify_digest() or
+	                          // ecdsa_recover_pub_from_sig() would return
+} ecdsa_batch_item;
+
+// Verify / recover count signatures. Every item gets its own result, a bad
+// item does not affect the other ones. Operations on secp256k1 with
+// USE_SECP256K1_5X52 share the field and scalar inversions of the batch and
+// use interleaved wNAF double-scalar multiplication. Other curves fall back
+// to the single signature functions.
+void ecdsa_verify_digest_batch(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count);
+void ecdsa_recover_pub_from_sig_batch(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count);
+
+#if USE_ECDSA_BATCH_THREADS
+// Same as above, but split the batch across up to num_threads threads.
+// returns 0 on success, 1 if a thread could not be started (the items of
+// that thread are then processed by the calling thread).
+int ecdsa_verify_digest_batch_mt(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count, int num_threads);
+int ecdsa_recover_pub_from_sig_batch_mt(const ecdsa_curve *curve, ecdsa_batch_item *items, size_t count, int num_threads);
+#endif
+
+#endif
@@ -28,7 +28,82 @@
 #define USE_PRECOMPUTED_CP 1
 #endif
 
-// use fast inverse method
+// use 5*52 bit limb field arithmetic for secp256k1 point operations.
+// requires unsigned __int128, hence it is only enabled on 64-bit hosts.
+#ifndef USE_SECP256K1_5X52
+#if defined(__SIZEOF_INT128__) && (defined(__x86_64__) || defined(__aarch64__))
+#define USE_SECP256K1_5X52 1
+#else
+#define USE_SECP256K1_5X52 0
+#endif
+#endif
+
+// window width in bits of the fixed-base table for k * G on secp256k1 with
+// 5*52 limbs. The table is generated in RAM on first use and takes
+// ceil(256/w) * 2^(w-1) points of 80 bytes (w = 4: 512 points, 40 KiB);
+// k * G then takes ceil(256/w) - 1 point additions instead of the 63 of
+// USE_PRECOMPUTED_CP. Each addition reads a whole row of 2^(w-1) points so
+// that memory accesses do not depend on the secret scalar, hence wider
+// windows save additions but scan longer rows: k * G is fastest at w = 4..6
+// and, at about the speed of USE_PRECOMPUTED_CP, then mainly buys constant
+// time lookups. 0 disables the table.
+#ifndef USE_SECP256K1_GEN_WINDOW
+#if USE_SECP256K1_5X52 && (defined(__linux__) || defined(__CYGWIN__))
+#define USE_SECP256K1_GEN_WINDOW 4
+#else
+#define USE_SECP256K1_GEN_WINDOW 0
+#endif
+#endif
+
+// allow the batch ECDSA functions to split their work across POSIX threads
+#ifndef USE_ECDSA_BATCH_THREADS
+#if defined(__linux__) || defined(__CYGWIN__)
+#define USE_ECDSA_BATCH_THREADS 1
+#else
+#define USE_ECDSA_BATCH_THREADS 0
+#endif
+#endif
+
+// unrolled scalar Keccak permutation with lane complementing, meant for
+// 64-bit targets (the generic round functions are smaller on 32-bit ones);
+// the generic permutation is still built as keccak_f1600_generic() for the
+// test cases to compare against
+#ifndef USE_KECCAK_UNROLLED
+#if defined(__LP64__) || defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__)
+#define USE_KECCAK_UNROLLED 1
+#else
+#define USE_KECCAK_UNROLLED 0
+#endif
+#endif
+
+// 4-way AVX2 Keccak for keccak_256_x4() / keccak_256_batch(), selected at
+// runtime if the CPU supports AVX2
+#ifndef USE_KECCAK_AVX2
+#if defined(__x86_64__) && defined(__GNUC__)
+#define USE_KECCAK_AVX2 1
+#else
+#define USE_KECCAK_AVX2 0
+#endif
+#endif
+
+// hardware SHA-256 compression (x86 SHA extensions, ARMv8 SHA2), selected
+// at runtime if the CPU supports it
+#ifndef USE_SHA2_HW
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__) || (defined(__aarch64__) && defined(__linux__)))
+#define USE_SHA2_HW 1
+#else
+#define USE_SHA2_HW 0
+#endif
+#endif
+
+// use the constant time safegcd inverse method (takes precedence over
+// USE_INVERSE_FAST)
+#ifndef USE_INVERSE_SAFEGCD
+#define USE_INVERSE_SAFEGCD 1
+#endif
+
+// use fast inverse method; together with USE_INVERSE_SAFEGCD it is still
+// built as bn_inverse_fast() for the test cases to compare against
 #ifndef USE_INVERSE_FAST
 #define USE_INVERSE_FAST 1
 #endif
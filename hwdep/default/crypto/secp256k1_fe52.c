@@ -0,0 +1,953 @@
+/**
+ * Copyright (c) 2013 Pieter Wuille
+ * Copyright (c) 2020 aitos.io
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+ * OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "options.h"
+#include "secp256k1_fe52.h"
+
+#if USE_SECP256K1_5X52
+
+#include "rand.h"
+#include "secp256k1.h"
+#include "memzero.h"
+
+// The field arithmetic follows the 5x52 int128 implementation of
+// libsecp256k1. p = 2^256 - 0x1000003D1, hence 2^256 = 0x1000003D1 mod p
+// and 2^260 = 0x1000003D10 mod p, which is used to fold the upper half of
+// a product back into the lower five limbs.
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+#define FE52_M 0xFFFFFFFFFFFFFULL
+#define FE52_R 0x1000003D10ULL
+
+void fe52_from_bn(const bignum256 *a, fe52 *r)
+{
+	const uint32_t *v = a->val;
+	uint64_t w0, w1, w2, w3;
+
+	w0 = (uint64_t)v[0] | ((uint64_t)v[1] << 30) | ((uint64_t)v[2] << 60);
+	w1 = ((uint64_t)v[2] >> 4) | ((uint64_t)v[3] << 26) | ((uint64_t)v[4] << 56);
+	w2 = ((uint64_t)v[4] >> 8) | ((uint64_t)v[5] << 22) | ((uint64_t)v[6] << 52);
+	w3 = ((uint64_t)v[6] >> 12) | ((uint64_t)v[7] << 18) | ((uint64_t)v[8] << 48);
+
+	r->n[0] = w0 & FE52_M;
+	r->n[1] = (w0 >> 52) | ((w1 & 0xFFFFFFFFFFULL) << 12);
+	r->n[2] = (w1 >> 40) | ((w2 & 0xFFFFFFFULL) << 24);
+	r->n[3] = (w2 >> 28) | ((w3 & 0xFFFFULL) << 36);
+	r->n[4] = w3 >> 16;
+}
+
+void fe52_to_bn(const fe52 *a, bignum256 *r)
+{
+	fe52 t = *a;
+	uint64_t w[5];
+	int i;
+
+	fe52_normalize(&t);
+	w[0] = t.n[0] | (t.n[1] << 52);
+	w[1] = (t.n[1] >> 12) | (t.n[2] << 40);
+	w[2] = (t.n[2] >> 24) | (t.n[3] << 28);
+	w[3] = (t.n[3] >> 36) | (t.n[4] << 16);
+	w[4] = 0;
+
+	for (i = 0; i < 9; i++) {
+		int pos = 30 * i;
+		int word = pos >> 6;
+		int shift = pos & 63;
+		uint64_t bits = w[word] >> shift;
+		if (shift > 34) {
+			bits |= w[word + 1] << (64 - shift);
+		}
+		r->val[i] = (uint32_t)(bits & 0x3FFFFFFF);
+	}
+	memzero(&t, sizeof(t));
+	memzero(w, sizeof(w));
+}
+
+void fe52_set_int(fe52 *r, uint64_t a)
+{
+	r->n[0] = a & FE52_M;
+	r->n[1] = a >> 52;
+	r->n[2] = r->n[3] = r->n[4] = 0;
+}
+
+void fe52_normalize_weak(fe52 *r)
+{
+	uint64_t t0 = r->n[0], t1 = r->n[1], t2 = r->n[2], t3 = r->n[3], t4 = r->n[4];
+
+	// reduce t4 at the start so there will be at most a single carry
+	// from the first pass
+	uint64_t x = t4 >> 48; t4 &= 0x0FFFFFFFFFFFFULL;
+
+	t0 += x * 0x1000003D1ULL;
+	t1 += (t0 >> 52); t0 &= FE52_M;
+	t2 += (t1 >> 52); t1 &= FE52_M;
+	t3 += (t2 >> 52); t2 &= FE52_M;
+	t4 += (t3 >> 52); t3 &= FE52_M;
+
+	r->n[0] = t0; r->n[1] = t1; r->n[2] = t2; r->n[3] = t3; r->n[4] = t4;
+}
+
+void fe52_normalize(fe52 *r)
+{
+	uint64_t t0 = r->n[0], t1 = r->n[1], t2 = r->n[2], t3 = r->n[3], t4 = r->n[4];
+	uint64_t m;
+	uint64_t x = t4 >> 48; t4 &= 0x0FFFFFFFFFFFFULL;
+
+	t0 += x * 0x1000003D1ULL;
+	t1 += (t0 >> 52); t0 &= FE52_M;
+	t2 += (t1 >> 52); t1 &= FE52_M; m = t1;
+	t3 += (t2 >> 52); t2 &= FE52_M; m &= t2;
+	t4 += (t3 >> 52); t3 &= FE52_M; m &= t3;
+
+	// at most a single final reduction is needed: the value is >= p iff
+	// it overflowed 2^256 or all limbs equal those of p
+	x = (t4 >> 48) | ((t4 == 0x0FFFFFFFFFFFFULL) & (m == FE52_M)
+		& (t0 >= 0xFFFFEFFFFFC2FULL));
+
+	t0 += x * 0x1000003D1ULL;
+	t1 += (t0 >> 52); t0 &= FE52_M;
+	t2 += (t1 >> 52); t1 &= FE52_M;
+	t3 += (t2 >> 52); t2 &= FE52_M;
+	t4 += (t3 >> 52); t3 &= FE52_M;
+	t4 &= 0x0FFFFFFFFFFFFULL;
+
+	r->n[0] = t0; r->n[1] = t1; r->n[2] = t2; r->n[3] = t3; r->n[4] = t4;
+}
+
+int fe52_normalizes_to_zero(const fe52 *a)
+{
+	uint64_t t0 = a->n[0], t1 = a->n[1], t2 = a->n[2], t3 = a->n[3], t4 = a->n[4];
+	// z0 tracks a possible raw value of 0, z1 tracks a possible raw value of p
+	uint64_t z0, z1;
+	uint64_t x = t4 >> 48; t4 &= 0x0FFFFFFFFFFFFULL;
+
+	t0 += x * 0x1000003D1ULL;
+	t1 += (t0 >> 52); t0 &= FE52_M; z0 = t0; z1 = t0 ^ 0x1000003D0ULL;
+	t2 += (t1 >> 52); t1 &= FE52_M; z0 |= t1; z1 &= t1;
+	t3 += (t2 >> 52); t2 &= FE52_M; z0 |= t2; z1 &= t2;
+	t4 += (t3 >> 52); t3 &= FE52_M; z0 |= t3; z1 &= t3;
+	z0 |= t4; z1 &= t4 ^ 0xF000000000000ULL;
+
+	return (z0 == 0) | (z1 == FE52_M);
+}
+
+void fe52_mul(fe52 *r, const fe52 *a, const fe52 *b)
+{
+	uint128_t c, d;
+	uint64_t t3, t4, tx, u0;
+	uint64_t a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3], a4 = a->n[4];
+	uint64_t b0 = b->n[0], b1 = b->n[1], b2 = b->n[2], b3 = b->n[3], b4 = b->n[4];
+
+	// [d 0 0 0] = [p3 0 0 0]
+	d  = (uint128_t)a0 * b3 + (uint128_t)a1 * b2 + (uint128_t)a2 * b1 + (uint128_t)a3 * b0;
+	// [c 0 0 0 0 d 0 0 0] = [p8 0 0 0 0 p3 0 0 0]
+	c  = (uint128_t)a4 * b4;
+	d += (c & FE52_M) * FE52_R; c >>= 52;
+	t3 = (uint64_t)d & FE52_M; d >>= 52;
+
+	// [c 0 0 0 0 d t3 0 0 0] = [p8 0 0 0 p4 p3 0 0 0]
+	d += (uint128_t)a0 * b4 + (uint128_t)a1 * b3 + (uint128_t)a2 * b2
+	   + (uint128_t)a3 * b1 + (uint128_t)a4 * b0;
+	d += c * FE52_R;
+	t4 = (uint64_t)d & FE52_M; d >>= 52;
+	tx = (t4 >> 48); t4 &= (FE52_M >> 4);
+
+	// [d t4+(tx<<48) t3 0 0 c] = [p8 0 0 0 p4 p3 0 0 p0]
+	c  = (uint128_t)a0 * b0;
+	d += (uint128_t)a1 * b4 + (uint128_t)a2 * b3 + (uint128_t)a3 * b2 + (uint128_t)a4 * b1;
+	u0 = (uint64_t)d & FE52_M; d >>= 52;
+	u0 = (u0 << 4) | tx;
+	c += (uint128_t)u0 * (FE52_R >> 4);
+	r->n[0] = (uint64_t)c & FE52_M; c >>= 52;
+
+	// [d 0 t4 t3 0 c r0] = [p8 0 0 p5 p4 p3 0 p1 p0]
+	c += (uint128_t)a0 * b1 + (uint128_t)a1 * b0;
+	d += (uint128_t)a2 * b4 + (uint128_t)a3 * b3 + (uint128_t)a4 * b2;
+	c += (d & FE52_M) * FE52_R; d >>= 52;
+	r->n[1] = (uint64_t)c & FE52_M; c >>= 52;
+
+	// [d 0 0 t4 t3 c r1 r0] = [p8 0 p6 p5 p4 p3 p2 p1 p0]
+	c += (uint128_t)a0 * b2 + (uint128_t)a1 * b1 + (uint128_t)a2 * b0;
+	d += (uint128_t)a3 * b4 + (uint128_t)a4 * b3;
+	c += (d & FE52_M) * FE52_R; d >>= 52;
+	r->n[2] = (uint64_t)c & FE52_M; c >>= 52;
+
+	// [d t4 t3 c r2 r1 r0] = [p8 p7 p6 p5 p4 p3 p2 p1 p0]
+	c += d * FE52_R + t3;
+	r->n[3] = (uint64_t)c & FE52_M; c >>= 52;
+	c += t4;
+	r->n[4] = (uint64_t)c;
+}
+
+void fe52_sqr(fe52 *r, const fe52 *a)
+{
+	uint128_t c, d;
+	uint64_t t3, t4, tx, u0;
+	uint64_t a0 = a->n[0], a1 = a->n[1], a2 = a->n[2], a3 = a->n[3], a4 = a->n[4];
+
+	d  = (uint128_t)(a0 * 2) * a3 + (uint128_t)(a1 * 2) * a2;
+	c  = (uint128_t)a4 * a4;
+	d += (c & FE52_M) * FE52_R; c >>= 52;
+	t3 = (uint64_t)d & FE52_M; d >>= 52;
+
+	a4 *= 2;
+	d += (uint128_t)a0 * a4 + (uint128_t)(a1 * 2) * a3 + (uint128_t)a2 * a2;
+	d += c * FE52_R;
+	t4 = (uint64_t)d & FE52_M; d >>= 52;
+	tx = (t4 >> 48); t4 &= (FE52_M >> 4);
+
+	c  = (uint128_t)a0 * a0;
+	d += (uint128_t)a1 * a4 + (uint128_t)(a2 * 2) * a3;
+	u0 = (uint64_t)d & FE52_M; d >>= 52;
+	u0 = (u0 << 4) | tx;
+	c += (uint128_t)u0 * (FE52_R >> 4);
+	r->n[0] = (uint64_t)c & FE52_M; c >>= 52;
+
+	a0 *= 2;
+	c += (uint128_t)a0 * a1;
+	d += (uint128_t)a2 * a4 + (uint128_t)a3 * a3;
+	c += (d & FE52_M) * FE52_R; d >>= 52;
+	r->n[1] = (uint64_t)c & FE52_M; c >>= 52;
+
+	c += (uint128_t)a0 * a2 + (uint128_t)a1 * a1;
+	d += (uint128_t)a3 * a4;
+	c += (d & FE52_M) * FE52_R; d >>= 52;
+	r->n[2] = (uint64_t)c & FE52_M; c >>= 52;
+
+	c += d * FE52_R + t3;
+	r->n[3] = (uint64_t)c & FE52_M; c >>= 52;
+	c += t4;
+	r->n[4] = (uint64_t)c;
+}
+
+void fe52_negate(fe52 *r, const fe52 *a, uint32_t m)
+{
+	uint64_t k = 2 * ((uint64_t)m + 1);
+
+	r->n[0] = 0xFFFFEFFFFFC2FULL * k - a->n[0];
+	r->n[1] = 0xFFFFFFFFFFFFFULL * k - a->n[1];
+	r->n[2] = 0xFFFFFFFFFFFFFULL * k - a->n[2];
+	r->n[3] = 0xFFFFFFFFFFFFFULL * k - a->n[3];
+	r->n[4] = 0x0FFFFFFFFFFFFULL * k - a->n[4];
+}
+
+void fe52_half(fe52 *r)
+{
+	uint64_t t0 = r->n[0], t1 = r->n[1], t2 = r->n[2], t3 = r->n[3], t4 = r->n[4];
+	// add p if the value is odd, the result is even and can be shifted
+	uint64_t mask = -(t0 & 1) >> 12;
+
+	t0 += 0xFFFFEFFFFFC2FULL & mask;
+	t1 += mask;
+	t2 += mask;
+	t3 += mask;
+	t4 += mask >> 4;
+
+	r->n[0] = (t0 >> 1) + ((t1 & 1) << 51);
+	r->n[1] = (t1 >> 1) + ((t2 & 1) << 51);
+	r->n[2] = (t2 >> 1) + ((t3 & 1) << 51);
+	r->n[3] = (t3 >> 1) + ((t4 & 1) << 51);
+	r->n[4] = (t4 >> 1);
+}
+
+void fe52_cmov(fe52 *r, const fe52 *a, int cond)
+{
+	uint64_t mask = -(uint64_t)(cond & 1);
+	int i;
+	for (i = 0; i < 5; i++) {
+		r->n[i] = (r->n[i] & ~mask) | (a->n[i] & mask);
+	}
+}
+
+// r = a^(p-2) using the addition chain from libsecp256k1
+// (255 squarings and 15 multiplications)
+void fe52_inverse(fe52 *r, const fe52 *a)
+{
+	fe52 x2, x3, x6, x9, x11, x22, x44, x88, x176, x220, x223, t1;
+	int j;
+
+	fe52_sqr(&x2, a);
+	fe52_mul(&x2, &x2, a);
+
+	fe52_sqr(&x3, &x2);
+	fe52_mul(&x3, &x3, a);
+
+	x6 = x3;
+	for (j = 0; j < 3; j++) fe52_sqr(&x6, &x6);
+	fe52_mul(&x6, &x6, &x3);
+
+	x9 = x6;
+	for (j = 0; j < 3; j++) fe52_sqr(&x9, &x9);
+	fe52_mul(&x9, &x9, &x3);
+
+	x11 = x9;
+	for (j = 0; j < 2; j++) fe52_sqr(&x11, &x11);
+	fe52_mul(&x11, &x11, &x2);
+
+	x22 = x11;
+	for (j = 0; j < 11; j++) fe52_sqr(&x22, &x22);
+	fe52_mul(&x22, &x22, &x11);
+
+	x44 = x22;
+	for (j = 0; j < 22; j++) fe52_sqr(&x44, &x44);
+	fe52_mul(&x44, &x44, &x22);
+
+	x88 = x44;
+	for (j = 0; j < 44; j++) fe52_sqr(&x88, &x88);
+	fe52_mul(&x88, &x88, &x44);
+
+	x176 = x88;
+	for (j = 0; j < 88; j++) fe52_sqr(&x176, &x176);
+	fe52_mul(&x176, &x176, &x88);
+
+	x220 = x176;
+	for (j = 0; j < 44; j++) fe52_sqr(&x220, &x220);
+	fe52_mul(&x220, &x220, &x44);
+
+	x223 = x220;
+	for (j = 0; j < 3; j++) fe52_sqr(&x223, &x223);
+	fe52_mul(&x223, &x223, &x3);
+
+	// the final result: p-2 = [223 ones] 0 [22 ones] 0000 1 0 11 0 1
+	t1 = x223;
+	for (j = 0; j < 23; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(&t1, &t1, &x22);
+	for (j = 0; j < 5; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(&t1, &t1, a);
+	for (j = 0; j < 3; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(&t1, &t1, &x2);
+	for (j = 0; j < 2; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(r, &t1, a);
+
+	memzero(&t1, sizeof(t1));
+}
+
+// r = a^((p+1)/4), the square root if it exists. (p+1)/4 has blocks of
+// 223, 22 and 2 ones, the chain is shared with fe52_inverse up to x223
+int fe52_sqrt(fe52 *r, const fe52 *a)
+{
+	fe52 x2, x3, x6, x9, x11, x22, x44, x88, x176, x220, x223, t1;
+	int j;
+
+	fe52_sqr(&x2, a);
+	fe52_mul(&x2, &x2, a);
+
+	fe52_sqr(&x3, &x2);
+	fe52_mul(&x3, &x3, a);
+
+	x6 = x3;
+	for (j = 0; j < 3; j++) fe52_sqr(&x6, &x6);
+	fe52_mul(&x6, &x6, &x3);
+
+	x9 = x6;
+	for (j = 0; j < 3; j++) fe52_sqr(&x9, &x9);
+	fe52_mul(&x9, &x9, &x3);
+
+	x11 = x9;
+	for (j = 0; j < 2; j++) fe52_sqr(&x11, &x11);
+	fe52_mul(&x11, &x11, &x2);
+
+	x22 = x11;
+	for (j = 0; j < 11; j++) fe52_sqr(&x22, &x22);
+	fe52_mul(&x22, &x22, &x11);
+
+	x44 = x22;
+	for (j = 0; j < 22; j++) fe52_sqr(&x44, &x44);
+	fe52_mul(&x44, &x44, &x22);
+
+	x88 = x44;
+	for (j = 0; j < 44; j++) fe52_sqr(&x88, &x88);
+	fe52_mul(&x88, &x88, &x44);
+
+	x176 = x88;
+	for (j = 0; j < 88; j++) fe52_sqr(&x176, &x176);
+	fe52_mul(&x176, &x176, &x88);
+
+	x220 = x176;
+	for (j = 0; j < 44; j++) fe52_sqr(&x220, &x220);
+	fe52_mul(&x220, &x220, &x44);
+
+	x223 = x220;
+	for (j = 0; j < 3; j++) fe52_sqr(&x223, &x223);
+	fe52_mul(&x223, &x223, &x3);
+
+	t1 = x223;
+	for (j = 0; j < 23; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(&t1, &t1, &x22);
+	for (j = 0; j < 6; j++) fe52_sqr(&t1, &t1);
+	fe52_mul(&t1, &t1, &x2);
+	fe52_sqr(&t1, &t1);
+	fe52_sqr(r, &t1);
+
+	// check that r^2 == a
+	fe52_sqr(&t1, r);
+	return fe52_equal(&t1, a);
+}
+
+int fe52_equal(const fe52 *a, const fe52 *b)
+{
+	fe52 t;
+	fe52_negate(&t, a, 1);
+	fe52_add(&t, b);
+	return fe52_normalizes_to_zero(&t);
+}
+
+// cond is 0 or 0xffffffff as for conditional_negate()
+static void fe52_conditional_negate(uint32_t cond, fe52 *a)
+{
+	fe52 neg;
+	fe52_negate(&neg, a, 1);
+	fe52_cmov(a, &neg, cond & 1);
+	fe52_normalize_weak(a);
+}
+
+// jp = (x, y) with a random z coordinate
+static void affine_to_jacobian52(const fe52 *x, const fe52 *y, jacobian_point52 *jp)
+{
+	bignum256 z;
+	fe52 t;
+	int i;
+
+	// randomize z coordinate
+	do {
+		for (i = 0; i < 8; i++) {
+			z.val[i] = random32() & 0x3FFFFFFF;
+		}
+		z.val[8] = random32() & 0xFFFF;
+	} while (bn_is_zero(&z) || !bn_is_less(&z, &secp256k1.prime));
+	fe52_from_bn(&z, &jp->z);
+
+	fe52_sqr(&t, &jp->z);              // t = z^2
+	fe52_mul(&jp->x, x, &t);           // x = x * z^2
+	fe52_mul(&t, &t, &jp->z);          // t = z^3
+	fe52_mul(&jp->y, y, &t);           // y = y * z^3
+	memzero(&z, sizeof(z));
+}
+
+static void curve_to_jacobian52(const curve_point *p, jacobian_point52 *jp)
+{
+	fe52 x, y;
+
+	fe52_from_bn(&p->x, &x);
+	fe52_from_bn(&p->y, &y);
+	affine_to_jacobian52(&x, &y, jp);
+}
+
+static void jacobian52_to_curve(const jacobian_point52 *jp, curve_point *p)
+{
+	fe52 zi, zi2, t;
+
+	fe52_inverse(&zi, &jp->z);         // zi = z^-1
+	fe52_sqr(&zi2, &zi);               // zi2 = z^-2
+	fe52_mul(&t, &jp->x, &zi2);
+	fe52_to_bn(&t, &p->x);             // x = jp->x * z^-2
+	fe52_mul(&zi2, &zi2, &zi);         // zi2 = z^-3
+	fe52_mul(&t, &jp->y, &zi2);
+	fe52_to_bn(&t, &p->y);             // y = jp->y * z^-3
+}
+
+// same formulas as point_jacobian_add() in ecdsa.c with a = 0.
+// p2 coordinates have magnitude 1 on input and on output.
+static void affine52_jacobian_add(const fe52 *x1, const fe52 *y1, jacobian_point52 *p2)
+{
+	fe52 r, h, r2, t;
+	fe52 hcby, hsqx;
+	fe52 xz, yz;
+	int is_doubling;
+
+	fe52_sqr(&xz, &p2->z);             // xz = z2^2
+	fe52_mul(&yz, &xz, &p2->z);        // yz = z2^3
+
+	fe52_mul(&xz, &xz, x1);            // xz = x1' = x1*z2^2
+	fe52_negate(&h, &p2->x, 1);
+	fe52_add(&h, &xz);                 // h = x1' - x2          (mag 3)
+	fe52_add(&xz, &p2->x);             // xz = x1' + x2         (mag 2)
+
+	is_doubling = fe52_normalizes_to_zero(&h);
+
+	fe52_mul(&yz, &yz, y1);            // yz = y1' = y1*z2^3
+	fe52_negate(&r, &p2->y, 1);
+	fe52_add(&r, &yz);                 // r = y1' - y2          (mag 3)
+	fe52_add(&yz, &p2->y);             // yz = y1' + y2         (mag 2)
+
+	fe52_sqr(&r2, &p2->x);
+	fe52_mul_int(&r2, 3);              // r2 = 3 x2^2           (mag 3)
+
+	fe52_cmov(&r, &r2, is_doubling);
+	fe52_cmov(&h, &yz, is_doubling);
+
+	fe52_sqr(&hsqx, &h);               // hsqx = h^2
+	fe52_mul(&hcby, &hsqx, &h);        // hcby = h^3
+	fe52_mul(&hsqx, &hsqx, &xz);       // hsqx = h^2 * (x1 + x2)
+	fe52_mul(&hcby, &hcby, &yz);       // hcby = h^3 * (y1 + y2)
+	fe52_mul(&p2->z, &p2->z, &h);      // z3 = h*z2
+
+	// x3 = r^2 - h^2 (x1 + x2)
+	fe52_sqr(&p2->x, &r);
+	fe52_negate(&t, &hsqx, 1);
+	fe52_add(&p2->x, &t);
+	fe52_normalize_weak(&p2->x);
+
+	// y3 = 1/2 (r*(h^2 (x1 + x2) - 2x3) - h^3 (y1 + y2))
+	fe52_negate(&t, &p2->x, 1);
+	fe52_mul_int(&t, 2);
+	fe52_add(&t, &hsqx);               //                       (mag 5)
+	fe52_mul(&p2->y, &t, &r);
+	fe52_negate(&t, &hcby, 1);
+	fe52_add(&p2->y, &t);
+	fe52_half(&p2->y);
+	fe52_normalize_weak(&p2->y);
+}
+
+void point52_jacobian_add(const curve_point *p1, jacobian_point52 *p2)
+{
+	fe52 x1, y1;
+
+	fe52_from_bn(&p1->x, &x1);
+	fe52_from_bn(&p1->y, &y1);
+	affine52_jacobian_add(&x1, &y1, p2);
+}
+
+// same formulas as point_jacobian_double() in ecdsa.c with a = 0.
+void point52_jacobian_double(jacobian_point52 *p)
+{
+	fe52 m, msq, ysq, xysq, t;
+
+	// m = 3*x^2 / 2
+	fe52_sqr(&m, &p->x);
+	fe52_mul_int(&m, 3);
+	fe52_half(&m);                     //                       (mag 2)
+
+	fe52_sqr(&msq, &m);                // msq = m^2
+	fe52_sqr(&ysq, &p->y);             // ysq = y^2
+	fe52_mul(&xysq, &p->x, &ysq);      // xysq = xy^2
+
+	fe52_mul(&p->z, &p->z, &p->y);     // z3 = yz
+
+	// x3 = m^2 - 2*xy^2
+	fe52_negate(&p->x, &xysq, 1);
+	fe52_mul_int(&p->x, 2);
+	fe52_add(&p->x, &msq);
+	fe52_normalize_weak(&p->x);
+
+	// y3 = m*(xy^2 - x3) - y^4
+	fe52_negate(&t, &p->x, 1);
+	fe52_add(&t, &xysq);
+	fe52_mul(&p->y, &t, &m);
+	fe52_sqr(&ysq, &ysq);
+	fe52_negate(&t, &ysq, 1);
+	fe52_add(&p->y, &t);
+	fe52_normalize_weak(&p->y);
+}
+
+// res = k * p, see point_multiply() in ecdsa.c for the algorithm
+void point52_multiply(const bignum256 *k, const curve_point *p, curve_point *res)
+{
+	const ecdsa_curve *curve = &secp256k1;
+	assert (bn_is_less(k, &curve->order));
+
+	int i, j;
+	bignum256 a;
+	uint32_t *aptr;
+	uint32_t abits;
+	int ashift;
+	uint32_t is_even = (k->val[0] & 1) - 1;
+	uint32_t bits, sign, nsign;
+	jacobian_point52 jres;
+	curve_point pmult[8];
+
+	uint32_t tmp = 1;
+	uint32_t is_non_zero = 0;
+	for (j = 0; j < 8; j++) {
+		is_non_zero |= k->val[j];
+		tmp += 0x3fffffff + k->val[j] - (curve->order.val[j] & is_even);
+		a.val[j] = tmp & 0x3fffffff;
+		tmp >>= 30;
+	}
+	is_non_zero |= k->val[j];
+	a.val[j] = tmp + 0xffff + k->val[j] - (curve->order.val[j] & is_even);
+	assert((a.val[0] & 1) != 0);
+
+	if (!is_non_zero) {
+		point_set_infinity(res);
+		return;
+	}
+
+	// pmult[i] = (2*i+1) * p
+	pmult[7] = *p;
+	point_double(curve, &pmult[7]);
+	pmult[0] = *p;
+	for (i = 1; i < 8; i++) {
+		pmult[i] = pmult[7];
+		point_add(curve, &pmult[i-1], &pmult[i]);
+	}
+
+	aptr = &a.val[8];
+	abits = *aptr;
+	ashift = 12;
+	bits = abits >> ashift;
+	sign = (bits >> 4) - 1;
+	bits ^= sign;
+	bits &= 15;
+	curve_to_jacobian52(&pmult[bits>>1], &jres);
+	for (i = 62; i >= 0; i--) {
+		point52_jacobian_double(&jres);
+		point52_jacobian_double(&jres);
+		point52_jacobian_double(&jres);
+		point52_jacobian_double(&jres);
+
+		ashift -= 4;
+		if (ashift < 0) {
+			bits = abits << (-ashift);
+			abits = *(--aptr);
+			ashift += 30;
+			bits |= abits >> ashift;
+		} else {
+			bits = abits >> ashift;
+		}
+		bits &= 31;
+		nsign = (bits >> 4) - 1;
+		bits ^= nsign;
+		bits &= 15;
+
+		fe52_conditional_negate(sign ^ nsign, &jres.z);
+		point52_jacobian_add(&pmult[bits >> 1], &jres);
+		sign = nsign;
+	}
+	fe52_conditional_negate(sign, &jres.z);
+	jacobian52_to_curve(&jres, res);
+	memzero(&a, sizeof(a));
+	memzero(&jres, sizeof(jres));
+}
+
+#if USE_PRECOMPUTED_CP
+
+// res = k * G, see scalar_multiply() in ecdsa.c for the algorithm
+void scalar52_multiply_cp(const bignum256 *k, curve_point *res)
+{
+	const ecdsa_curve *curve = &secp256k1;
+	assert (bn_is_less(k, &curve->order));
+
+	int i, j;
+	bignum256 a;
+	uint32_t is_even = (k->val[0] & 1) - 1;
+	uint32_t lowbits;
+	jacobian_point52 jres;
+
+	uint32_t tmp = 1;
+	uint32_t is_non_zero = 0;
+	for (j = 0; j < 8; j++) {
+		is_non_zero |= k->val[j];
+		tmp += 0x3fffffff + k->val[j] - (curve->order.val[j] & is_even);
+		a.val[j] = tmp & 0x3fffffff;
+		tmp >>= 30;
+	}
+	is_non_zero |= k->val[j];
+	a.val[j] = tmp + 0xffff + k->val[j] - (curve->order.val[j] & is_even);
+	assert((a.val[0] & 1) != 0);
+
+	if (!is_non_zero) {
+		point_set_infinity(res);
+		return;
+	}
+
+	lowbits = a.val[0] & ((1 << 5) - 1);
+	lowbits ^= (lowbits >> 4) - 1;
+	lowbits &= 15;
+	curve_to_jacobian52(&curve->cp[0][lowbits >> 1], &jres);
+	for (i = 1; i < 64; i ++) {
+		for (j = 0; j < 8; j++) {
+			a.val[j] = (a.val[j] >> 4) | ((a.val[j + 1] & 0xf) << 26);
+		}
+		a.val[j] >>= 4;
+
+		lowbits = a.val[0] & ((1 << 5) - 1);
+		lowbits ^= (lowbits >> 4) - 1;
+		lowbits &= 15;
+		fe52_conditional_negate((lowbits & 1) - 1, &jres.y);
+		point52_jacobian_add(&curve->cp[i][lowbits >> 1], &jres);
+	}
+	fe52_conditional_negate(((a.val[0] >> 4) & 1) - 1, &jres.y);
+	jacobian52_to_curve(&jres, res);
+	memzero(&a, sizeof(a));
+	memzero(&jres, sizeof(jres));
+}
+
+#else
+
+void scalar52_multiply_cp(const bignum256 *k, curve_point *res)
+{
+	point52_multiply(k, &secp256k1.G, res);
+}
+
+#endif
+
+// p = jp in affine coordinates
+static void jacobian52_to_affine(const jacobian_point52 *jp, affine_point52 *p)
+{
+	fe52 zi, zi2;
+
+	fe52_inverse(&zi, &jp->z);
+	fe52_sqr(&zi2, &zi);
+	fe52_mul(&p->x, &jp->x, &zi2);
+	fe52_mul(&zi2, &zi2, &zi);
+	fe52_mul(&p->y, &jp->y, &zi2);
+	fe52_normalize(&p->x);
+	fe52_normalize(&p->y);
+}
+
+static void affine_to_jacobian52_z1(const affine_point52 *p, jacobian_point52 *jp)
+{
+	jp->x = p->x;
+	jp->y = p->y;
+	fe52_set_int(&jp->z, 1);
+}
+
+int scalar52_gen_table_build(scalar52_gen_table *table, int window, affine_point52 *points)
+{
+	jacobian_point52 jp[1 << (SCALAR52_GEN_MAX_WINDOW - 1)];
+	fe52 prod[1 << (SCALAR52_GEN_MAX_WINDOW - 1)];
+	affine_point52 base, twice;
+	fe52 inv, zi, zi2;
+	affine_point52 *row;
+	int teeth, windows;
+	int i, j;
+
+	if (window < 2 || window > SCALAR52_GEN_MAX_WINDOW) {
+		return 1;
+	}
+	teeth = 1 << (window - 1);
+	windows = (256 + window - 1) / window;
+
+	fe52_from_bn(&secp256k1.G.x, &base.x);
+	fe52_from_bn(&secp256k1.G.y, &base.y);
+
+	for (i = 0; i < windows; i++) {
+		// base = 2^(window*i) * G
+		affine_to_jacobian52_z1(&base, &jp[0]);
+		point52_jacobian_double(&jp[0]);
+		jacobian52_to_affine(&jp[0], &twice);
+
+		// jp[j] = (2*j+1) * base
+		affine_to_jacobian52_z1(&base, &jp[0]);
+		prod[0] = jp[0].z;
+		for (j = 1; j < teeth; j++) {
+			jp[j] = jp[j - 1];
+			affine52_jacobian_add(&twice.x, &twice.y, &jp[j]);
+			fe52_mul(&prod[j], &prod[j - 1], &jp[j].z);
+		}
+
+		// convert the row to affine with a single inversion
+		row = &points[i * teeth];
+		fe52_inverse(&inv, &prod[teeth - 1]);
+		for (j = teeth - 1; j >= 0; j--) {
+			if (j > 0) {
+				fe52_mul(&zi, &inv, &prod[j - 1]);
+				fe52_mul(&inv, &inv, &jp[j].z);
+			} else {
+				zi = inv;
+			}
+			fe52_sqr(&zi2, &zi);
+			fe52_mul(&row[j].x, &jp[j].x, &zi2);
+			fe52_mul(&zi2, &zi2, &zi);
+			fe52_mul(&row[j].y, &jp[j].y, &zi2);
+			fe52_normalize(&row[j].x);
+			fe52_normalize(&row[j].y);
+		}
+
+		affine_to_jacobian52_z1(&base, &jp[0]);
+		for (j = 0; j < window; j++) {
+			point52_jacobian_double(&jp[0]);
+		}
+		jacobian52_to_affine(&jp[0], &base);
+	}
+
+	table->window = window;
+	table->windows = windows;
+	table->points = points;
+	return 0;
+}
+
+// r = a as 5 little endian 64 bit words, a must be normalized
+static void bn_to_u64(const bignum256 *a, uint64_t r[5])
+{
+	int i, pos;
+
+	memzero(r, 5 * sizeof(uint64_t));
+	for (i = 0; i < 9; i++) {
+		pos = 30 * i;
+		r[pos >> 6] |= (uint64_t)a->val[i] << (pos & 63);
+		if ((pos & 63) > 34) {
+			r[(pos >> 6) + 1] |= (uint64_t)a->val[i] >> (64 - (pos & 63));
+		}
+	}
+}
+
+// count (<= 32) bits of m starting at bit pos
+static uint32_t u64_bits(const uint64_t m[5], int pos, int count)
+{
+	int limb = pos >> 6, shift = pos & 63;
+	uint64_t v = m[limb] >> shift;
+
+	if (shift + count > 64 && limb < 4) {
+		v |= m[limb + 1] << (64 - shift);
+	}
+	return (uint32_t)v & ((1u << count) - 1);
+}
+
+// p = row[idx]. Every entry of the row is read and the one wanted is selected
+// with masks, so that neither the memory access pattern nor the timing
+// depends on the secret idx.
+static void affine52_row_lookup(const affine_point52 *row, int teeth, uint32_t idx, affine_point52 *p)
+{
+	uint32_t d;
+	int j;
+
+	*p = row[0];
+	for (j = 1; j < teeth; j++) {
+		d = (uint32_t)j ^ idx;
+		d = ((d | (0u - d)) >> 31) ^ 1;    // 1 iff j == idx
+		fe52_cmov(&p->x, &row[j].x, (int)d);
+		fe52_cmov(&p->y, &row[j].y, (int)d);
+	}
+}
+
+// res = k * G with a table of scalar52_gen_table_build()
+//
+// As in scalar_multiply(), m = k + 2^(w*n) (minus the order if k is even) is
+// odd, where w is the window width and n the number of windows. Any odd
+// m < 2^(w*n+1) is sum_{i<n} d_i 2^(w*i) + 2^(w*n) with odd digits
+// |d_i| < 2^w: d_i = (m_i mod 2^(w+1)) - 2^w, where m_i = (m >> w*i) | 1.
+// Hence k = sum_{i<n} d_i 2^(w*i) (mod order), i.e. one table lookup and
+// one addition per window and no doublings at all.
+void scalar52_multiply_table(const scalar52_gen_table *table, const bignum256 *k, curve_point *res)
+{
+	const ecdsa_curve *curve = &secp256k1;
+	affine_point52 p;
+	const int w = table->window;
+	const int teeth = 1 << (w - 1);
+	const uint32_t mask = (1u << w) - 1;
+	uint64_t m[5], o[5];
+	uint64_t even, t, lt, borrow, carry;
+	uint32_t u, neg, idx;
+	jacobian_point52 jres;
+	int i, top;
+
+	assert (bn_is_less(k, &curve->order));
+
+	bn_to_u64(k, m);
+	bn_to_u64(&curve->order, o);
+
+	if ((m[0] | m[1] | m[2] | m[3]) == 0) {
+		point_set_infinity(res);
+		return;
+	}
+
+	// m = k - (order if k is even), modulo 2^320
+	even = (m[0] & 1) - 1;
+	borrow = 0;
+	for (i = 0; i < 5; i++) {
+		t = o[i] & even;
+		lt = (m[i] < t) | ((m[i] - t) < borrow);
+		m[i] = m[i] - t - borrow;
+		borrow = lt;
+	}
+
+	// m += 2^(w*n)
+	top = w * table->windows;
+	carry = 1ULL << (top & 63);
+	for (i = top >> 6; i < 5; i++) {
+		m[i] += carry;
+		carry = m[i] < carry;
+	}
+	assert((m[0] & 1) != 0);
+
+	for (i = 0; i < table->windows; i++) {
+		u = u64_bits(m, w * i, w + 1) | 1;
+		neg = ((u >> w) & 1) - 1;          // 0xffffffff if d_i < 0
+		idx = ((u ^ neg) & mask) >> 1;     // (|d_i| - 1) / 2
+
+		affine52_row_lookup(&table->points[i * teeth], teeth, idx, &p);
+		fe52_conditional_negate(neg, &p.y);
+		if (i == 0) {
+			affine_to_jacobian52(&p.x, &p.y, &jres);
+		} else {
+			affine52_jacobian_add(&p.x, &p.y, &jres);
+		}
+	}
+
+	jacobian52_to_curve(&jres, res);
+	memzero(m, sizeof(m));
+	memzero(&jres, sizeof(jres));
+	memzero(&p, sizeof(p));
+}
+
+#if USE_SECP256K1_GEN_WINDOW
+
+#if USE_SECP256K1_GEN_WINDOW < 2 || USE_SECP256K1_GEN_WINDOW > SCALAR52_GEN_MAX_WINDOW
+#error "USE_SECP256K1_GEN_WINDOW must be 0 or 2..8"
+#endif
+
+static affine_point52 gen_table_points[SCALAR52_GEN_TABLE_POINTS(USE_SECP256K1_GEN_WINDOW)];
+static scalar52_gen_table gen_table;
+static int gen_table_state = 0;     // 0: not built, 1: being built, 2: ready
+
+// The first caller builds the table. Callers racing with it don't wait but
+// take the precomputed table path until the table is ready.
+static const scalar52_gen_table *scalar52_gen_table_get(void)
+{
+	int state = __atomic_load_n(&gen_table_state, __ATOMIC_ACQUIRE);
+
+	if (state == 2) {
+		return &gen_table;
+	}
+	if (state == 0 && __atomic_compare_exchange_n(&gen_table_state, &state, 1, 0,
+	                                              __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		scalar52_gen_table_build(&gen_table, USE_SECP256K1_GEN_WINDOW, gen_table_points);
+		__atomic_store_n(&gen_table_state, 2, __ATOMIC_RELEASE);
+		return &gen_table;
+	}
+	return NULL;
+}
+
+#endif
+
+void scalar52_multiply(const bignum256 *k, curve_point *res)
+{
+#if USE_SECP256K1_GEN_WINDOW
+	const scalar52_gen_table *table = scalar52_gen_table_get();
+
+	if (table != NULL) {
+		scalar52_multiply_table(table, k, res);
+		return;
+	}
+#endif
+	scalar52_multiply_cp(k, res);
+}
+
+#endif
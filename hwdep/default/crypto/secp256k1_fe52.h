@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2013 Pieter Wuille
+ * Copyright (c) 2020 aitos.io
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES
+ * OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __SECP256K1_FE52_H__
+#define __SECP256K1_FE52_H__
+
+#include <stdint.h>
+
+#include "options.h"
+#include "bignum.h"
+#include "ecdsa.h"
+
+#if USE_SECP256K1_5X52
+
+// secp256k1 field element, stored as 5*52 bit limbs (n[4] holds 48 bits
+// when normalized). Limbs may temporarily exceed 52 bits; the "magnitude"
+// m of an element means every limb is at most m*2*(2^52-1).
+// Elements returned by fe52_mul/fe52_sqr have magnitude 1.
+typedef struct {
+	uint64_t n[5];
+} fe52;
+
+// jacobian point on secp256k1 with 5x52 coordinates
+typedef struct {
+	fe52 x, y, z;
+} jacobian_point52;
+
+// conversion from/to the generic 9*30 bit representation
+// bn must be normalized (each limb < 2^30); fe52_to_bn fully reduces mod p
+void fe52_from_bn(const bignum256 *a, fe52 *r);
+void fe52_to_bn(const fe52 *a, bignum256 *r);
+
+void fe52_set_int(fe52 *r, uint64_t a);
+
+// reduce magnitude to 1 (weak) or to the unique value in [0, p)
+void fe52_normalize_weak(fe52 *r);
+void fe52_normalize(fe52 *r);
+
+// returns 1 iff a == 0 mod p (constant time)
+int fe52_normalizes_to_zero(const fe52 *a);
+
+// r = a * b, r = a^2 (inputs up to magnitude 8, r may alias inputs)
+void fe52_mul(fe52 *r, const fe52 *a, const fe52 *b);
+void fe52_sqr(fe52 *r, const fe52 *a);
+
+// r += a; r *= k; magnitudes add up / multiply
+static inline void fe52_add(fe52 *r, const fe52 *a) {
+	r->n[0] += a->n[0];
+	r->n[1] += a->n[1];
+	r->n[2] += a->n[2];
+	r->n[3] += a->n[3];
+	r->n[4] += a->n[4];
+}
+
+static inline void fe52_mul_int(fe52 *r, uint32_t k) {
+	r->n[0] *= k;
+	r->n[1] *= k;
+	r->n[2] *= k;
+	r->n[3] *= k;
+	r->n[4] *= k;
+}
+
+// r = -a, where a has at most magnitude m; r has magnitude m+1
+void fe52_negate(fe52 *r, const fe52 *a, uint32_t m);
+
+// r = a / 2 mod p (constant time)
+void fe52_half(fe52 *r);
+
+// r = a^-1 mod p (constant time, via Fermat's little theorem)
+void fe52_inverse(fe52 *r, const fe52 *a);
+
+// r = sqrt(a) mod p, returns 1 iff a is a square (r may not alias a)
+int fe52_sqrt(fe52 *r, const fe52 *a);
+
+// returns 1 iff a == b mod p
+int fe52_equal(const fe52 *a, const fe52 *b);
+
+// r = cond ? a : r, cond must be 0 or 1
+void fe52_cmov(fe52 *r, const fe52 *a, int cond);
+
+// secp256k1 specific replacements of the generic point operations
+void point52_jacobian_add(const curve_point *p1, jacobian_point52 *p2);
+void point52_jacobian_double(jacobian_point52 *p);
+void point52_multiply(const bignum256 *k, const curve_point *p, curve_point *res);
+void scalar52_multiply(const bignum256 *k, curve_point *res);
+// res = k * G with the secp256k1 cp table (USE_PRECOMPUTED_CP) and without
+// the fixed-base table of USE_SECP256K1_GEN_WINDOW
+void scalar52_multiply_cp(const bignum256 *k, curve_point *res);
+
+// affine point with 5x52 coordinates
+typedef struct {
+	fe52 x, y;
+} affine_point52;
+
+// fixed-base table for k * G with w bit windows:
+// points[i * 2^(w-1) + j] = (2*j+1) * 2^(w*i) * G for each of the
+// ceil(256/w) windows i. k * G then takes ceil(256/w) - 1 additions.
+typedef struct {
+	int window;
+	int windows;
+	const affine_point52 *points;
+} scalar52_gen_table;
+
+#define SCALAR52_GEN_MAX_WINDOW 8
+#define SCALAR52_GEN_TABLE_POINTS(w) ((size_t)((256 + (w) - 1) / (w)) << ((w) - 1))
+
+// window must be in 2..SCALAR52_GEN_MAX_WINDOW and points must hold
+// SCALAR52_GEN_TABLE_POINTS(window) entries. returns 0 on success.
+int scalar52_gen_table_build(scalar52_gen_table *table, int window, affine_point52 *points);
+void scalar52_multiply_table(const scalar52_gen_table *table, const bignum256 *k, curve_point *res);
+
+#endif
+
+#endif
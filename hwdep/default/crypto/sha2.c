@@ -31,6 +31,7 @@
 #include <string.h>
 #include <stdint.h>
 #include "sha2.h"
+#include "options.h"
 #include "memzero.h"
 
 /*
@@ -698,7 +699,7 @@ void sha256_Init(SHA256_CTX* context) {
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+void sha256_Transform_sw(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1;
 	sha2_word32 W256[16];
@@ -755,7 +756,7 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+void sha256_Transform_sw(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, T2, W256[16];
 	int		j;
@@ -826,6 +827,161 @@ void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+/*
+ * Hardware SHA-256 compression: x86 SHA extensions (SHA-NI) and the ARMv8
+ * SHA2 instructions. Both are compiled with a function level target
+ * attribute and selected at runtime, so the build flags are unchanged and
+ * CPUs without the extensions use the portable code above. As everywhere
+ * in this file, data holds the block as host order words.
+ */
+#if USE_SHA2_HW && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+
+#define SHA256_HW_TARGET __attribute__((target("sha,sse4.1")))
+
+static int sha256_hw_detect(void) {
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid_max(0, NULL) < 7) {
+		return 0;
+	}
+	__cpuid(1, eax, ebx, ecx, edx);
+	if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) {
+		return 0;
+	}
+	__cpuid_count(7, 0, eax, ebx, ecx, edx);
+	return (ebx & bit_SHA) ? 1 : 0;
+}
+
+static SHA256_HW_TARGET void sha256_Transform_hw(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	__m128i state0, state1, msg, tmp, abef_save, cdgh_save, w[4];
+	int i;
+
+	/* reorder the state words for sha256rnds2: ABEF and CDGH */
+	tmp    = _mm_loadu_si128((const __m128i*)(const void*)&state_in[0]);
+	state1 = _mm_loadu_si128((const __m128i*)(const void*)&state_in[4]);
+	tmp    = _mm_shuffle_epi32(tmp, 0xB1);          /* CDAB */
+	state1 = _mm_shuffle_epi32(state1, 0x1B);       /* EFGH */
+	state0 = _mm_alignr_epi8(tmp, state1, 8);       /* ABEF */
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);    /* CDGH */
+	abef_save = state0;
+	cdgh_save = state1;
+
+	for (i = 0; i < 4; i++) {
+		w[i] = _mm_loadu_si128((const __m128i*)(const void*)&data[4 * i]);
+	}
+
+	/* 16 groups of 4 rounds, w[] holds the message schedule ring */
+	for (i = 0; i < 16; i++) {
+		msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i*)(const void*)&K256[4 * i]));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+		if (i >= 3 && i <= 14) {
+			tmp = _mm_alignr_epi8(w[i & 3], w[(i - 1) & 3], 4);
+			w[(i + 1) & 3] = _mm_add_epi32(w[(i + 1) & 3], tmp);
+			w[(i + 1) & 3] = _mm_sha256msg2_epu32(w[(i + 1) & 3], w[i & 3]);
+		}
+		msg = _mm_shuffle_epi32(msg, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+		if (i >= 1 && i <= 12) {
+			w[(i - 1) & 3] = _mm_sha256msg1_epu32(w[(i - 1) & 3], w[i & 3]);
+		}
+	}
+
+	state0 = _mm_add_epi32(state0, abef_save);
+	state1 = _mm_add_epi32(state1, cdgh_save);
+
+	/* back to ABCD and EFGH */
+	tmp    = _mm_shuffle_epi32(state0, 0x1B);       /* FEBA */
+	state1 = _mm_shuffle_epi32(state1, 0xB1);       /* DCHG */
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);    /* DCBA */
+	state1 = _mm_alignr_epi8(state1, tmp, 8);       /* ABEF */
+	_mm_storeu_si128((__m128i*)(void*)&state_out[0], state0);
+	_mm_storeu_si128((__m128i*)(void*)&state_out[4], state1);
+}
+
+#define SHA256_HW_AVAILABLE 1
+
+#elif USE_SHA2_HW && defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+
+#if defined(__clang__)
+#define SHA256_HW_TARGET __attribute__((target("crypto")))
+#else
+#define SHA256_HW_TARGET __attribute__((target("+crypto")))
+#endif
+
+static int sha256_hw_detect(void) {
+	return (getauxval(AT_HWCAP) & HWCAP_SHA2) ? 1 : 0;
+}
+
+static SHA256_HW_TARGET void sha256_Transform_hw(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+	uint32x4_t state0, state1, abcd_save, efgh_save, abcd, msg, w[4];
+	int i;
+
+	state0 = vld1q_u32(&state_in[0]);
+	state1 = vld1q_u32(&state_in[4]);
+	abcd_save = state0;
+	efgh_save = state1;
+
+	for (i = 0; i < 4; i++) {
+		w[i] = vld1q_u32(&data[4 * i]);
+	}
+
+	/* 16 groups of 4 rounds, w[] holds the message schedule ring */
+	for (i = 0; i < 16; i++) {
+		msg = vaddq_u32(w[i & 3], vld1q_u32(&K256[4 * i]));
+		if (i < 12) {
+			w[i & 3] = vsha256su0q_u32(w[i & 3], w[(i + 1) & 3]);
+		}
+		abcd = state0;
+		state0 = vsha256hq_u32(state0, state1, msg);
+		state1 = vsha256h2q_u32(state1, abcd, msg);
+		if (i < 12) {
+			w[i & 3] = vsha256su1q_u32(w[i & 3], w[(i + 2) & 3], w[(i + 3) & 3]);
+		}
+	}
+
+	vst1q_u32(&state_out[0], vaddq_u32(state0, abcd_save));
+	vst1q_u32(&state_out[4], vaddq_u32(state1, efgh_save));
+}
+
+#define SHA256_HW_AVAILABLE 1
+
+#else
+#define SHA256_HW_AVAILABLE 0
+#endif
+
+int sha256_hw_supported(void) {
+#if SHA256_HW_AVAILABLE
+	/* the detection result is the same for every thread, a racing first
+	   call just detects twice */
+	static volatile int hw_supported = -1;
+
+	if (hw_supported < 0) {
+		hw_supported = sha256_hw_detect();
+	}
+	return hw_supported;
+#else
+	return 0;
+#endif
+}
+
+void sha256_Transform(const sha2_word32* state_in, const sha2_word32* data, sha2_word32* state_out) {
+#if SHA256_HW_AVAILABLE
+	if (sha256_hw_supported()) {
+		sha256_Transform_hw(state_in, data, state_out);
+		return;
+	}
+#endif
+	sha256_Transform_sw(state_in, data, state_out);
+}
+
 void sha256_Update(SHA256_CTX* context, const sha2_byte *data, size_t len) {
 	unsigned int	freespace, usedspace;
 
@@ -98,6 +98,10 @@ void sha1_Raw(const uint8_t*, size_t, uint8_t[SHA1_DIGEST_LENGTH]);
 char* sha1_Data(const uint8_t*, size_t, char[SHA1_DIGEST_STRING_LENGTH]);
 
 void sha256_Transform(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out);
+// the portable transform; sha256_Transform() uses the hardware instructions
+// instead if sha256_hw_supported() returns 1
+void sha256_Transform_sw(const uint32_t* state_in, const uint32_t* data, uint32_t* state_out);
+int sha256_hw_supported(void);
 void sha256_Init(SHA256_CTX *);
 void sha256_Update(SHA256_CTX*, const uint8_t*, size_t);
 void sha256_Final(SHA256_CTX*, uint8_t[SHA256_DIGEST_LENGTH]);
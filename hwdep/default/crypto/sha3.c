@@ -18,6 +18,7 @@
  */
 
 #include <assert.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "sha3.h"
@@ -163,7 +164,12 @@ static void keccak_chi(uint64_t *A)
 	}
 }
 
-static void sha3_permutation(uint64_t *state)
+/*
+ * Keccak-f[1600] with the generic round functions. With USE_KECCAK_UNROLLED
+ * it is kept only to cross-check and benchmark the unrolled permutation
+ * against.
+ */
+void keccak_f1600_generic(uint64_t *state)
 {
 	int round;
 	for (round = 0; round < NumberOfRounds; round++)
@@ -204,6 +210,279 @@ static void sha3_permutation(uint64_t *state)
 	}
 }
 
+#if USE_KECCAK_UNROLLED
+
+/*
+ * Unrolled Keccak-f[1600] with lane complementing (see the Keccak team's
+ * implementation overview, section "lane complementing transform").
+ * Lanes 1, 2, 8, 12, 17 and 20 are kept inverted, which turns most of the
+ * NOTs of chi into AND/OR. The state is kept in local variables and two
+ * rounds are done per loop iteration, alternating between the A and E set.
+ */
+static void keccak_complement_lanes(uint64_t *A)
+{
+	A[ 1] = ~A[ 1];
+	A[ 2] = ~A[ 2];
+	A[ 8] = ~A[ 8];
+	A[12] = ~A[12];
+	A[17] = ~A[17];
+	A[20] = ~A[20];
+}
+
+/* permutation on a state in complemented representation */
+static void keccak_permutation_complemented(uint64_t *state)
+{
+	uint64_t Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki;
+	uint64_t Ako, Aku, Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+	uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki;
+	uint64_t Eko, Eku, Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+	uint64_t B0, B1, B2, B3, B4, C0, C1, C2, C3, C4, D0, D1, D2, D3, D4, RC;
+	int round;
+
+	Aba = state[ 0];
+	Abe = state[ 1];
+	Abi = state[ 2];
+	Abo = state[ 3];
+	Abu = state[ 4];
+	Aga = state[ 5];
+	Age = state[ 6];
+	Agi = state[ 7];
+	Ago = state[ 8];
+	Agu = state[ 9];
+	Aka = state[10];
+	Ake = state[11];
+	Aki = state[12];
+	Ako = state[13];
+	Aku = state[14];
+	Ama = state[15];
+	Ame = state[16];
+	Ami = state[17];
+	Amo = state[18];
+	Amu = state[19];
+	Asa = state[20];
+	Ase = state[21];
+	Asi = state[22];
+	Aso = state[23];
+	Asu = state[24];
+
+	for (round = 0; round < NumberOfRounds; round += 2) {
+		RC = keccak_round_constants[round];
+		C0 = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+		C1 = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+		C2 = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+		C3 = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+		C4 = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+		D0 = C4 ^ ROTL64(C1, 1);
+		D1 = C0 ^ ROTL64(C2, 1);
+		D2 = C1 ^ ROTL64(C3, 1);
+		D3 = C2 ^ ROTL64(C4, 1);
+		D4 = C3 ^ ROTL64(C0, 1);
+
+		B0 = Aba ^ D0;
+		B1 = ROTL64(Age ^ D1, 44);
+		B2 = ROTL64(Aki ^ D2, 43);
+		B3 = ROTL64(Amo ^ D3, 21);
+		B4 = ROTL64(Asu ^ D4, 14);
+		Eba = B0 ^ (B1 | B2) ^ RC;
+		Ebe = B1 ^ (~B2 | B3);
+		Ebi = B2 ^ (B3 & B4);
+		Ebo = B3 ^ (B4 | B0);
+		Ebu = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Abo ^ D3, 28);
+		B1 = ROTL64(Agu ^ D4, 20);
+		B2 = ROTL64(Aka ^ D0, 3);
+		B3 = ROTL64(Ame ^ D1, 45);
+		B4 = ROTL64(Asi ^ D2, 61);
+		Ega = B0 ^ (B1 | B2);
+		Ege = B1 ^ (B2 & B3);
+		Egi = B2 ^ (B3 | ~B4);
+		Ego = B3 ^ (B4 | B0);
+		Egu = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Abe ^ D1, 1);
+		B1 = ROTL64(Agi ^ D2, 6);
+		B2 = ROTL64(Ako ^ D3, 25);
+		B3 = ROTL64(Amu ^ D4, 8);
+		B4 = ROTL64(Asa ^ D0, 18);
+		Eka = B0 ^ (B1 | B2);
+		Eke = B1 ^ (B2 & B3);
+		Eki = B2 ^ (~B3 & B4);
+		Eko = ~B3 ^ (B4 | B0);
+		Eku = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Abu ^ D4, 27);
+		B1 = ROTL64(Aga ^ D0, 36);
+		B2 = ROTL64(Ake ^ D1, 10);
+		B3 = ROTL64(Ami ^ D2, 15);
+		B4 = ROTL64(Aso ^ D3, 56);
+		Ema = B0 ^ (B1 & B2);
+		Eme = B1 ^ (B2 | B3);
+		Emi = B2 ^ (~B3 | B4);
+		Emo = ~B3 ^ (B4 & B0);
+		Emu = B4 ^ (B0 | B1);
+
+		B0 = ROTL64(Abi ^ D2, 62);
+		B1 = ROTL64(Ago ^ D3, 55);
+		B2 = ROTL64(Aku ^ D4, 39);
+		B3 = ROTL64(Ama ^ D0, 41);
+		B4 = ROTL64(Ase ^ D1, 2);
+		Esa = B0 ^ (~B1 & B2);
+		Ese = ~B1 ^ (B2 | B3);
+		Esi = B2 ^ (B3 & B4);
+		Eso = B3 ^ (B4 | B0);
+		Esu = B4 ^ (B0 & B1);
+
+		RC = keccak_round_constants[round + 1];
+		C0 = Eba ^ Ega ^ Eka ^ Ema ^ Esa;
+		C1 = Ebe ^ Ege ^ Eke ^ Eme ^ Ese;
+		C2 = Ebi ^ Egi ^ Eki ^ Emi ^ Esi;
+		C3 = Ebo ^ Ego ^ Eko ^ Emo ^ Eso;
+		C4 = Ebu ^ Egu ^ Eku ^ Emu ^ Esu;
+		D0 = C4 ^ ROTL64(C1, 1);
+		D1 = C0 ^ ROTL64(C2, 1);
+		D2 = C1 ^ ROTL64(C3, 1);
+		D3 = C2 ^ ROTL64(C4, 1);
+		D4 = C3 ^ ROTL64(C0, 1);
+
+		B0 = Eba ^ D0;
+		B1 = ROTL64(Ege ^ D1, 44);
+		B2 = ROTL64(Eki ^ D2, 43);
+		B3 = ROTL64(Emo ^ D3, 21);
+		B4 = ROTL64(Esu ^ D4, 14);
+		Aba = B0 ^ (B1 | B2) ^ RC;
+		Abe = B1 ^ (~B2 | B3);
+		Abi = B2 ^ (B3 & B4);
+		Abo = B3 ^ (B4 | B0);
+		Abu = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Ebo ^ D3, 28);
+		B1 = ROTL64(Egu ^ D4, 20);
+		B2 = ROTL64(Eka ^ D0, 3);
+		B3 = ROTL64(Eme ^ D1, 45);
+		B4 = ROTL64(Esi ^ D2, 61);
+		Aga = B0 ^ (B1 | B2);
+		Age = B1 ^ (B2 & B3);
+		Agi = B2 ^ (B3 | ~B4);
+		Ago = B3 ^ (B4 | B0);
+		Agu = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Ebe ^ D1, 1);
+		B1 = ROTL64(Egi ^ D2, 6);
+		B2 = ROTL64(Eko ^ D3, 25);
+		B3 = ROTL64(Emu ^ D4, 8);
+		B4 = ROTL64(Esa ^ D0, 18);
+		Aka = B0 ^ (B1 | B2);
+		Ake = B1 ^ (B2 & B3);
+		Aki = B2 ^ (~B3 & B4);
+		Ako = ~B3 ^ (B4 | B0);
+		Aku = B4 ^ (B0 & B1);
+
+		B0 = ROTL64(Ebu ^ D4, 27);
+		B1 = ROTL64(Ega ^ D0, 36);
+		B2 = ROTL64(Eke ^ D1, 10);
+		B3 = ROTL64(Emi ^ D2, 15);
+		B4 = ROTL64(Eso ^ D3, 56);
+		Ama = B0 ^ (B1 & B2);
+		Ame = B1 ^ (B2 | B3);
+		Ami = B2 ^ (~B3 | B4);
+		Amo = ~B3 ^ (B4 & B0);
+		Amu = B4 ^ (B0 | B1);
+
+		B0 = ROTL64(Ebi ^ D2, 62);
+		B1 = ROTL64(Ego ^ D3, 55);
+		B2 = ROTL64(Eku ^ D4, 39);
+		B3 = ROTL64(Ema ^ D0, 41);
+		B4 = ROTL64(Ese ^ D1, 2);
+		Asa = B0 ^ (~B1 & B2);
+		Ase = ~B1 ^ (B2 | B3);
+		Asi = B2 ^ (B3 & B4);
+		Aso = B3 ^ (B4 | B0);
+		Asu = B4 ^ (B0 & B1);
+	}
+
+	state[ 0] = Aba;
+	state[ 1] = Abe;
+	state[ 2] = Abi;
+	state[ 3] = Abo;
+	state[ 4] = Abu;
+	state[ 5] = Aga;
+	state[ 6] = Age;
+	state[ 7] = Agi;
+	state[ 8] = Ago;
+	state[ 9] = Agu;
+	state[10] = Aka;
+	state[11] = Ake;
+	state[12] = Aki;
+	state[13] = Ako;
+	state[14] = Aku;
+	state[15] = Ama;
+	state[16] = Ame;
+	state[17] = Ami;
+	state[18] = Amo;
+	state[19] = Amu;
+	state[20] = Asa;
+	state[21] = Ase;
+	state[22] = Asi;
+	state[23] = Aso;
+	state[24] = Asu;
+}
+
+static void sha3_permutation(uint64_t *state)
+{
+	keccak_complement_lanes(state);
+	keccak_permutation_complemented(state);
+	keccak_complement_lanes(state);
+}
+
+/**
+ * Absorb a run of full blocks. The state stays complemented between the
+ * blocks; aligned input is XORed in place, unaligned input lane by lane.
+ *
+ * @param hash the algorithm state
+ * @param msg the message blocks
+ * @param blocks number of blocks
+ * @param block_size the size of a block in bytes
+ */
+static void sha3_absorb_blocks(uint64_t hash[25], const unsigned char *msg, size_t blocks, size_t block_size)
+{
+	const size_t lanes = block_size / 8;
+	size_t i;
+
+	keccak_complement_lanes(hash);
+	for (; blocks > 0; blocks--) {
+		if (IS_ALIGNED_64(msg)) {
+			const uint64_t *block = (const uint64_t *)(const void *)msg;
+			for (i = 0; i < lanes; i++) {
+				hash[i] ^= le2me_64(block[i]);
+			}
+		} else {
+			for (i = 0; i < lanes; i++) {
+				uint64_t lane;
+				memcpy(&lane, msg + 8 * i, 8);
+				hash[i] ^= le2me_64(lane);
+			}
+		}
+		keccak_permutation_complemented(hash);
+		msg += block_size;
+	}
+	keccak_complement_lanes(hash);
+}
+
+#else
+
+static void sha3_permutation(uint64_t *state)
+{
+	keccak_f1600_generic(state);
+}
+
+#endif /* USE_KECCAK_UNROLLED */
+
+void keccak_f1600(uint64_t *state)
+{
+	sha3_permutation(state);
+}
+
 /**
  * The core transformation. Process the specified block of data.
  *
@@ -286,6 +565,14 @@ void sha3_Update(SHA3_CTX *ctx, const unsigned char *msg, size_t size)
 		msg  += left;
 		size -= left;
 	}
+#if USE_KECCAK_UNROLLED
+	if (size >= block_size) {
+		size_t blocks = size / block_size;
+		sha3_absorb_blocks(ctx->hash, msg, blocks, block_size);
+		msg  += blocks * block_size;
+		size -= blocks * block_size;
+	}
+#else
 	while (size >= block_size) {
 		uint64_t* aligned_message_block;
 		if (IS_ALIGNED_64(msg)) {
@@ -301,6 +588,7 @@ void sha3_Update(SHA3_CTX *ctx, const unsigned char *msg, size_t size)
 		msg  += block_size;
 		size -= block_size;
 	}
+#endif
 	if (size) {
 		memcpy(ctx->message, msg, size); /* save leftovers */
 	}
@@ -378,6 +666,205 @@ void keccak_512(const unsigned char* data, size_t len, unsigned char* digest)
 	keccak_Update(&ctx, data, len);
 	keccak_Final(&ctx, digest);
 }
+
+/*
+ * Four way interleaved Keccak-256 on AVX2. Each 256-bit register holds the
+ * same lane of four independent states. Messages are absorbed in lockstep
+ * as long as all four have blocks left (the padded last block included);
+ * the states of longer messages are then finished one by one with the
+ * scalar code.
+ */
+#if USE_KECCAK_AVX2
+#include <immintrin.h>
+
+#define KECCAK_X4_TARGET __attribute__((target("avx2")))
+#define KECCAK_X4_ROTL(v, n) _mm256_or_si256(_mm256_slli_epi64((v), (n)), _mm256_srli_epi64((v), 64 - (n)))
+
+static KECCAK_X4_TARGET void keccak_x4_permutation(__m256i A[25])
+{
+	__m256i B[25], C0, C1, C2, C3, C4, D;
+	int round;
+
+	for (round = 0; round < NumberOfRounds; round++) {
+		/* theta */
+		C0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[0], A[5]), _mm256_xor_si256(A[10], A[15])), A[20]);
+		C1 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[1], A[6]), _mm256_xor_si256(A[11], A[16])), A[21]);
+		C2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[2], A[7]), _mm256_xor_si256(A[12], A[17])), A[22]);
+		C3 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[3], A[8]), _mm256_xor_si256(A[13], A[18])), A[23]);
+		C4 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(A[4], A[9]), _mm256_xor_si256(A[14], A[19])), A[24]);
+		D = _mm256_xor_si256(C4, KECCAK_X4_ROTL(C1, 1));
+		A[0] = _mm256_xor_si256(A[0], D); A[5] = _mm256_xor_si256(A[5], D); A[10] = _mm256_xor_si256(A[10], D); A[15] = _mm256_xor_si256(A[15], D); A[20] = _mm256_xor_si256(A[20], D);
+		D = _mm256_xor_si256(C0, KECCAK_X4_ROTL(C2, 1));
+		A[1] = _mm256_xor_si256(A[1], D); A[6] = _mm256_xor_si256(A[6], D); A[11] = _mm256_xor_si256(A[11], D); A[16] = _mm256_xor_si256(A[16], D); A[21] = _mm256_xor_si256(A[21], D);
+		D = _mm256_xor_si256(C1, KECCAK_X4_ROTL(C3, 1));
+		A[2] = _mm256_xor_si256(A[2], D); A[7] = _mm256_xor_si256(A[7], D); A[12] = _mm256_xor_si256(A[12], D); A[17] = _mm256_xor_si256(A[17], D); A[22] = _mm256_xor_si256(A[22], D);
+		D = _mm256_xor_si256(C2, KECCAK_X4_ROTL(C4, 1));
+		A[3] = _mm256_xor_si256(A[3], D); A[8] = _mm256_xor_si256(A[8], D); A[13] = _mm256_xor_si256(A[13], D); A[18] = _mm256_xor_si256(A[18], D); A[23] = _mm256_xor_si256(A[23], D);
+		D = _mm256_xor_si256(C3, KECCAK_X4_ROTL(C0, 1));
+		A[4] = _mm256_xor_si256(A[4], D); A[9] = _mm256_xor_si256(A[9], D); A[14] = _mm256_xor_si256(A[14], D); A[19] = _mm256_xor_si256(A[19], D); A[24] = _mm256_xor_si256(A[24], D);
+		/* rho and pi */
+		B[ 0] = A[ 0];
+		B[10] = KECCAK_X4_ROTL(A[ 1], 1);
+		B[20] = KECCAK_X4_ROTL(A[ 2], 62);
+		B[ 5] = KECCAK_X4_ROTL(A[ 3], 28);
+		B[15] = KECCAK_X4_ROTL(A[ 4], 27);
+		B[16] = KECCAK_X4_ROTL(A[ 5], 36);
+		B[ 1] = KECCAK_X4_ROTL(A[ 6], 44);
+		B[11] = KECCAK_X4_ROTL(A[ 7], 6);
+		B[21] = KECCAK_X4_ROTL(A[ 8], 55);
+		B[ 6] = KECCAK_X4_ROTL(A[ 9], 20);
+		B[ 7] = KECCAK_X4_ROTL(A[10], 3);
+		B[17] = KECCAK_X4_ROTL(A[11], 10);
+		B[ 2] = KECCAK_X4_ROTL(A[12], 43);
+		B[12] = KECCAK_X4_ROTL(A[13], 25);
+		B[22] = KECCAK_X4_ROTL(A[14], 39);
+		B[23] = KECCAK_X4_ROTL(A[15], 41);
+		B[ 8] = KECCAK_X4_ROTL(A[16], 45);
+		B[18] = KECCAK_X4_ROTL(A[17], 15);
+		B[ 3] = KECCAK_X4_ROTL(A[18], 21);
+		B[13] = KECCAK_X4_ROTL(A[19], 8);
+		B[14] = KECCAK_X4_ROTL(A[20], 18);
+		B[24] = KECCAK_X4_ROTL(A[21], 2);
+		B[ 9] = KECCAK_X4_ROTL(A[22], 61);
+		B[19] = KECCAK_X4_ROTL(A[23], 56);
+		B[ 4] = KECCAK_X4_ROTL(A[24], 14);
+		/* chi */
+		A[ 0] = _mm256_xor_si256(B[ 0], _mm256_andnot_si256(B[ 1], B[ 2]));
+		A[ 1] = _mm256_xor_si256(B[ 1], _mm256_andnot_si256(B[ 2], B[ 3]));
+		A[ 2] = _mm256_xor_si256(B[ 2], _mm256_andnot_si256(B[ 3], B[ 4]));
+		A[ 3] = _mm256_xor_si256(B[ 3], _mm256_andnot_si256(B[ 4], B[ 0]));
+		A[ 4] = _mm256_xor_si256(B[ 4], _mm256_andnot_si256(B[ 0], B[ 1]));
+		A[ 5] = _mm256_xor_si256(B[ 5], _mm256_andnot_si256(B[ 6], B[ 7]));
+		A[ 6] = _mm256_xor_si256(B[ 6], _mm256_andnot_si256(B[ 7], B[ 8]));
+		A[ 7] = _mm256_xor_si256(B[ 7], _mm256_andnot_si256(B[ 8], B[ 9]));
+		A[ 8] = _mm256_xor_si256(B[ 8], _mm256_andnot_si256(B[ 9], B[ 5]));
+		A[ 9] = _mm256_xor_si256(B[ 9], _mm256_andnot_si256(B[ 5], B[ 6]));
+		A[10] = _mm256_xor_si256(B[10], _mm256_andnot_si256(B[11], B[12]));
+		A[11] = _mm256_xor_si256(B[11], _mm256_andnot_si256(B[12], B[13]));
+		A[12] = _mm256_xor_si256(B[12], _mm256_andnot_si256(B[13], B[14]));
+		A[13] = _mm256_xor_si256(B[13], _mm256_andnot_si256(B[14], B[10]));
+		A[14] = _mm256_xor_si256(B[14], _mm256_andnot_si256(B[10], B[11]));
+		A[15] = _mm256_xor_si256(B[15], _mm256_andnot_si256(B[16], B[17]));
+		A[16] = _mm256_xor_si256(B[16], _mm256_andnot_si256(B[17], B[18]));
+		A[17] = _mm256_xor_si256(B[17], _mm256_andnot_si256(B[18], B[19]));
+		A[18] = _mm256_xor_si256(B[18], _mm256_andnot_si256(B[19], B[15]));
+		A[19] = _mm256_xor_si256(B[19], _mm256_andnot_si256(B[15], B[16]));
+		A[20] = _mm256_xor_si256(B[20], _mm256_andnot_si256(B[21], B[22]));
+		A[21] = _mm256_xor_si256(B[21], _mm256_andnot_si256(B[22], B[23]));
+		A[22] = _mm256_xor_si256(B[22], _mm256_andnot_si256(B[23], B[24]));
+		A[23] = _mm256_xor_si256(B[23], _mm256_andnot_si256(B[24], B[20]));
+		A[24] = _mm256_xor_si256(B[24], _mm256_andnot_si256(B[20], B[21]));
+		/* iota */
+		A[0] = _mm256_xor_si256(A[0], _mm256_set1_epi64x((long long)keccak_round_constants[round]));
+	}
+}
+
+static inline uint64_t keccak_x4_load64(const unsigned char *p)
+{
+	uint64_t v;
+	memcpy(&v, p, 8);
+	return le2me_64(v);
+}
+
+static KECCAK_X4_TARGET void keccak_x4_absorb(__m256i A[25], const unsigned char *const block[4])
+{
+	int i;
+	for (i = 0; i < SHA3_256_BLOCK_LENGTH / 8; i++) {
+		A[i] = _mm256_xor_si256(A[i], _mm256_set_epi64x(
+			(long long)keccak_x4_load64(block[3] + 8 * i), (long long)keccak_x4_load64(block[2] + 8 * i),
+			(long long)keccak_x4_load64(block[1] + 8 * i), (long long)keccak_x4_load64(block[0] + 8 * i)));
+	}
+}
+
+static KECCAK_X4_TARGET void keccak_256_x4_avx2(const unsigned char *const data[4], const size_t len[4], unsigned char *const digest[4])
+{
+	__m256i A[25];
+	uint64_t lanes[25][4];
+	unsigned char last[4][SHA3_256_BLOCK_LENGTH];
+	const unsigned char *block[4];
+	size_t blocks[4], common, k;
+	int i, j;
+
+	/* number of blocks including the padded last one */
+	common = SIZE_MAX;
+	for (i = 0; i < 4; i++) {
+		size_t rest = len[i] % SHA3_256_BLOCK_LENGTH;
+		blocks[i] = len[i] / SHA3_256_BLOCK_LENGTH + 1;
+		if (blocks[i] < common) {
+			common = blocks[i];
+		}
+		memset(last[i], 0, SHA3_256_BLOCK_LENGTH);
+		memcpy(last[i], data[i] + len[i] - rest, rest);
+		last[i][rest] |= 0x01;
+		last[i][SHA3_256_BLOCK_LENGTH - 1] |= 0x80;
+	}
+
+	for (i = 0; i < 25; i++) {
+		A[i] = _mm256_setzero_si256();
+	}
+	for (k = 0; k < common; k++) {
+		for (i = 0; i < 4; i++) {
+			block[i] = (k + 1 == blocks[i]) ? last[i] : data[i] + k * SHA3_256_BLOCK_LENGTH;
+		}
+		keccak_x4_absorb(A, block);
+		keccak_x4_permutation(A);
+	}
+
+	for (i = 0; i < 25; i++) {
+		_mm256_storeu_si256((__m256i *)(void *)lanes[i], A[i]);
+	}
+	for (i = 0; i < 4; i++) {
+		if (blocks[i] == common) {
+			for (j = 0; j < 4; j++) {
+				uint64_t v = le2me_64(lanes[j][i]);
+				memcpy(digest[i] + 8 * j, &v, 8);
+			}
+		} else {
+			SHA3_CTX ctx;
+			keccak_256_Init(&ctx);
+			for (j = 0; j < 25; j++) {
+				ctx.hash[j] = lanes[j][i];
+			}
+			keccak_Update(&ctx, data[i] + common * SHA3_256_BLOCK_LENGTH, len[i] - common * SHA3_256_BLOCK_LENGTH);
+			keccak_Final(&ctx, digest[i]);
+		}
+	}
+
+	memzero(A, sizeof(A));
+	memzero(lanes, sizeof(lanes));
+	memzero(last, sizeof(last));
+}
+
+#undef KECCAK_X4_ROTL
+#endif /* USE_KECCAK_AVX2 */
+
+void keccak_256_x4(const unsigned char *const data[4], const size_t len[4], unsigned char *const digest[4])
+{
+	int i;
+
+#if USE_KECCAK_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		keccak_256_x4_avx2(data, len, digest);
+		return;
+	}
+#endif
+
+	for (i = 0; i < 4; i++) {
+		keccak_256(data[i], len[i], digest[i]);
+	}
+}
+
+void keccak_256_batch(const unsigned char *const *data, const size_t *len, unsigned char *const *digest, size_t count)
+{
+	size_t i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		keccak_256_x4(data + i, len + i, digest + i);
+	}
+	for (; i < count; i++) {
+		keccak_256(data[i], len[i], digest[i]);
+	}
+}
 #endif /* USE_KECCAK */
 
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest)
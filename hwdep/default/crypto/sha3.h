@@ -68,6 +68,11 @@ void sha3_512_Init(SHA3_CTX *ctx);
 void sha3_Update(SHA3_CTX *ctx, const unsigned char* msg, size_t size);
 void sha3_Final(SHA3_CTX *ctx, unsigned char* result);
 
+/* Keccak-f[1600] on a state of 25 lanes as used by the hash functions, and
+   with the generic round functions (see USE_KECCAK_UNROLLED) */
+void keccak_f1600(uint64_t *state);
+void keccak_f1600_generic(uint64_t *state);
+
 #if USE_KECCAK
 #define keccak_224_Init sha3_224_Init
 #define keccak_256_Init sha3_256_Init
@@ -77,6 +82,11 @@ void sha3_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_256(const unsigned char* data, size_t len, unsigned char* digest);
 void keccak_512(const unsigned char* data, size_t len, unsigned char* digest);
+
+/* hash several independent messages at once, using the 4-way AVX2
+   implementation if the CPU supports it */
+void keccak_256_x4(const unsigned char *const data[4], const size_t len[4], unsigned char *const digest[4]);
+void keccak_256_batch(const unsigned char *const *data, const size_t *len, unsigned char *const *digest, size_t count);
 #endif
 
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest);
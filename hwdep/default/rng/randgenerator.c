@@ -136,8 +136,13 @@ BUINT8 * read_random_sdram(BUINT32 len)
     current_time = time(NULL);
     keccak_256((unsigned char *)&current_time, sizeof(size_t), time_digest);
     
+#if BOAT_USE_STATIC_POOL == 1
+    // No heap in static pool mode
+    random_sdram_ptr = NULL;
+#else
     // Allocate extra 256 bytes so an random offset can be given by current time
     random_sdram_ptr = malloc(len+256);
+#endif
 
     if( random_sdram_ptr != NULL )
     {
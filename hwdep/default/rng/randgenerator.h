@@ -23,7 +23,7 @@ randgenerator.h is the random number generator header file.
 #ifndef __RANDGENERATOR_H__
 #define __RANDGENERATOR_H__
 
-#include "boatinternal.h"
+#include "boatiotsdk.h"
 
 #ifdef __cplusplus
 extern "C" {
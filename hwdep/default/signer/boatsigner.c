@@ -0,0 +1,198 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Default secp256k1 Signer
+
+@file
+boatsigner.c implements the secp256k1 signer on top of the built-in crypto
+library. See signer_libsecp256k1.c for the libsecp256k1 backend.
+*/
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_SIGNER
+
+#include "boatinternal.h"
+#include "boatsigner.h"
+
+#if BOAT_SIGNER_USE_LIBSECP256K1 == 0
+
+#include "ecdsa.h"
+#include "secp256k1.h"
+
+
+/*!*****************************************************************************
+@brief Get the name of the signer backend
+
+Function: BoatSignerBackendName()
+
+    This function returns a human readable name of the backend selected at
+    build time, e.g. for logs and benchmarks.
+
+@return
+    This function returns a constant string.
+
+@param This function doesn't take any argument.
+*******************************************************************************/
+const BCHAR *BoatSignerBackendName(void)
+{
+    return "builtin";
+}
+
+
+/*!*****************************************************************************
+@brief Sign a 32-byte digest with secp256k1
+
+Function: BoatSignerSignDigest()
+
+    This function signs a message digest with the given private key using
+    deterministic k (RFC6979). Both backends normalize s to the lower half of
+    the group order, thus they generate identical signatures.
+
+@return
+    This function returns BOAT_SUCCESS if signing succeeds. Otherwise it
+    returns one of the error codes.
+
+@param[in] priv_key
+    32-byte private key.
+
+@param[in] digest
+    32-byte message digest.
+
+@param[out] sig
+    64-byte buffer to hold r||s.
+
+@param[out] recovery_id_ptr
+    Pointer to hold the recovery id (parity of R.y), may be NULL.
+*******************************************************************************/
+BOAT_RESULT BoatSignerSignDigest(const BUINT8 *priv_key,
+                                 const BUINT8 *digest,
+                                 BUINT8 *sig,
+                                 BUINT8 *recovery_id_ptr)
+{
+    BUINT8 recid;
+
+    if( priv_key == NULL || digest == NULL || sig == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    if( ecdsa_sign_digest(&secp256k1, priv_key, digest, sig, &recid, NULL) != 0 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to sign digest.");
+        return BOAT_ERROR;
+    }
+
+    if( recovery_id_ptr != NULL )
+    {
+        *recovery_id_ptr = recid;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Recover the public key from a signature
+
+Function: BoatSignerRecoverPubkey()
+
+    This function recovers the public key that generated the signature over
+    the given digest.
+
+@return
+    This function returns BOAT_SUCCESS if the public key is recovered.
+    Otherwise it returns one of the error codes.
+
+@param[in] sig
+    64-byte signature r||s.
+
+@param[in] digest
+    32-byte message digest.
+
+@param[in] recovery_id
+    The recovery id (0 to 3) returned by BoatSignerSignDigest().
+
+@param[out] pub_key
+    64-byte buffer to hold the recovered public key.
+*******************************************************************************/
+BOAT_RESULT BoatSignerRecoverPubkey(const BUINT8 *sig,
+                                    const BUINT8 *digest,
+                                    BUINT8 recovery_id,
+                                    BUINT8 *pub_key)
+{
+    BUINT8 pub_key65[65];
+
+    if( sig == NULL || digest == NULL || pub_key == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    if( recovery_id > 3 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid recovery id: %u.", recovery_id);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( ecdsa_recover_pub_from_sig(&secp256k1, pub_key65, sig, digest, recovery_id) != 0 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to recover public key.");
+        return BOAT_ERROR;
+    }
+
+    // Skip the 0x04 SECG prefix
+    memcpy(pub_key, &pub_key65[1], 64);
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Derive the public key from a private key
+
+Function: BoatSignerGetPubkey()
+
+    This function calculates the uncompressed public key of a private key.
+
+@return
+    This function returns BOAT_SUCCESS if the public key is derived.
+    Otherwise it returns one of the error codes.
+
+@param[in] priv_key
+    32-byte private key.
+
+@param[out] pub_key
+    64-byte buffer to hold the public key.
+*******************************************************************************/
+BOAT_RESULT BoatSignerGetPubkey(const BUINT8 *priv_key, BUINT8 *pub_key)
+{
+    BUINT8 pub_key65[65];
+
+    if( priv_key == NULL || pub_key == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    ecdsa_get_public_key65(&secp256k1, priv_key, pub_key65);
+
+    // Skip the 0x04 SECG prefix
+    memcpy(pub_key, &pub_key65[1], 64);
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,57 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief secp256k1 Signer Header File
+
+@file
+boatsigner.h is the header file of the secp256k1 signer.
+
+The signer hides the ECDSA implementation from the protocol layer. The default
+backend is the built-in crypto library. If BOAT_SIGNER_USE_LIBSECP256K1 is set
+to 1 in boatoptions.h, libsecp256k1 is used instead.
+
+Public keys handled by the signer are 64-byte X||Y without the 0x04 prefix,
+signatures are 64-byte r||s with s in the lower half of the group order.
+*/
+
+#ifndef __BOATSIGNER_H__
+#define __BOATSIGNER_H__
+
+#include "boatiotsdk.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const BCHAR *BoatSignerBackendName(void);
+
+BOAT_RESULT BoatSignerSignDigest(const BUINT8 *priv_key,
+                                 const BUINT8 *digest,
+                                 BUINT8 *sig,
+                                 BUINT8 *recovery_id_ptr);
+
+BOAT_RESULT BoatSignerRecoverPubkey(const BUINT8 *sig,
+                                    const BUINT8 *digest,
+                                    BUINT8 recovery_id,
+                                    BUINT8 *pub_key);
+
+BOAT_RESULT BoatSignerGetPubkey(const BUINT8 *priv_key, BUINT8 *pub_key);
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
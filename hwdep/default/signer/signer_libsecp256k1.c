@@ -0,0 +1,213 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief libsecp256k1 Signer
+
+@file
+signer_libsecp256k1.c implements the secp256k1 signer on top of the
+libsecp256k1 context API. It is compiled only if BOAT_SIGNER_USE_LIBSECP256K1
+is set to 1 in boatoptions.h.
+
+libsecp256k1 ships its own secp256k1.h, which collides with the one of the
+built-in crypto library. This file thus must not include boatinternal.h and
+is compiled without the crypto directory in the include path.
+*/
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_SIGNER
+
+#include "boatiotsdk.h"
+#include "boatsigner.h"
+
+#if BOAT_SIGNER_USE_LIBSECP256K1 == 1
+
+#include <pthread.h>
+#include <secp256k1.h>
+#include <secp256k1_recovery.h>
+#include "randgenerator.h"
+// The built-in crypto headers are hidden from this file, see the Makefile
+#include "../crypto/memzero.h"
+
+// The context holds the precomputed ecmult_gen tables. It is created once on
+// first use, whichever thread signs first, and kept until the process exits.
+static secp256k1_context *g_signer_secp256k1_ctx_ptr = NULL;
+static pthread_once_t g_signer_secp256k1_ctx_once = PTHREAD_ONCE_INIT;
+
+
+static void BoatSignerCreateContext(void)
+{
+    BUINT8 seed[32];
+    secp256k1_context *ctx_ptr;
+
+    ctx_ptr = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    if( ctx_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Fail to create libsecp256k1 context.");
+        return;
+    }
+
+    // Blind the ecmult_gen tables against side-channel leakage
+    if( random_stream(seed, sizeof(seed)) == BOAT_SUCCESS )
+    {
+        if( secp256k1_context_randomize(ctx_ptr, seed) != 1 )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Fail to randomize libsecp256k1 context.");
+        }
+    }
+    memzero(seed, sizeof(seed));
+
+    g_signer_secp256k1_ctx_ptr = ctx_ptr;
+}
+
+
+// pthread_once() makes the created context visible to every caller
+static secp256k1_context *BoatSignerGetContext(void)
+{
+    if( pthread_once(&g_signer_secp256k1_ctx_once, BoatSignerCreateContext) != 0 )
+    {
+        return NULL;
+    }
+
+    return g_signer_secp256k1_ctx_ptr;
+}
+
+
+// See boatsigner.c for the description of the signer API
+
+const BCHAR *BoatSignerBackendName(void)
+{
+    return "libsecp256k1";
+}
+
+
+BOAT_RESULT BoatSignerSignDigest(const BUINT8 *priv_key,
+                                 const BUINT8 *digest,
+                                 BUINT8 *sig,
+                                 BUINT8 *recovery_id_ptr)
+{
+    secp256k1_context *ctx_ptr;
+    secp256k1_ecdsa_recoverable_signature rec_sig;
+    int recid;
+
+    if( priv_key == NULL || digest == NULL || sig == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    ctx_ptr = BoatSignerGetContext();
+    if( ctx_ptr == NULL )
+    {
+        return BOAT_ERROR_EXT_MODULE_OPERATION_FAIL;
+    }
+
+    // NULL nonce function selects RFC6979, the same as the built-in backend
+    if( secp256k1_ecdsa_sign_recoverable(ctx_ptr, &rec_sig, digest, priv_key, NULL, NULL) != 1 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to sign digest.");
+        return BOAT_ERROR_EXT_MODULE_OPERATION_FAIL;
+    }
+
+    secp256k1_ecdsa_recoverable_signature_serialize_compact(ctx_ptr, sig, &recid, &rec_sig);
+    memset(&rec_sig, 0x00, sizeof(rec_sig));
+
+    if( recovery_id_ptr != NULL )
+    {
+        *recovery_id_ptr = (BUINT8)recid;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT BoatSignerRecoverPubkey(const BUINT8 *sig,
+                                    const BUINT8 *digest,
+                                    BUINT8 recovery_id,
+                                    BUINT8 *pub_key)
+{
+    secp256k1_context *ctx_ptr;
+    secp256k1_ecdsa_recoverable_signature rec_sig;
+    secp256k1_pubkey pubkey;
+    BUINT8 pub_key65[65];
+    size_t pub_key65_len = sizeof(pub_key65);
+
+    if( sig == NULL || digest == NULL || pub_key == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    if( recovery_id > 3 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid recovery id: %u.", recovery_id);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    ctx_ptr = BoatSignerGetContext();
+    if( ctx_ptr == NULL )
+    {
+        return BOAT_ERROR_EXT_MODULE_OPERATION_FAIL;
+    }
+
+    if(    secp256k1_ecdsa_recoverable_signature_parse_compact(ctx_ptr, &rec_sig, sig, recovery_id) != 1
+        || secp256k1_ecdsa_recover(ctx_ptr, &pubkey, &rec_sig, digest) != 1 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to recover public key.");
+        return BOAT_ERROR;
+    }
+
+    secp256k1_ec_pubkey_serialize(ctx_ptr, pub_key65, &pub_key65_len, &pubkey, SECP256K1_EC_UNCOMPRESSED);
+
+    // Skip the 0x04 SECG prefix
+    memcpy(pub_key, &pub_key65[1], 64);
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT BoatSignerGetPubkey(const BUINT8 *priv_key, BUINT8 *pub_key)
+{
+    secp256k1_context *ctx_ptr;
+    secp256k1_pubkey pubkey;
+    BUINT8 pub_key65[65];
+    size_t pub_key65_len = sizeof(pub_key65);
+
+    if( priv_key == NULL || pub_key == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    ctx_ptr = BoatSignerGetContext();
+    if( ctx_ptr == NULL )
+    {
+        return BOAT_ERROR_EXT_MODULE_OPERATION_FAIL;
+    }
+
+    if( secp256k1_ec_pubkey_create(ctx_ptr, &pubkey, priv_key) != 1 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to derive public key.");
+        return BOAT_ERROR;
+    }
+
+    secp256k1_ec_pubkey_serialize(ctx_ptr, pub_key65, &pub_key65_len, &pubkey, SECP256K1_EC_UNCOMPRESSED);
+
+    // Skip the 0x04 SECG prefix
+    memcpy(pub_key, &pub_key65[1], 64);
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,1049 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Indexed single-file keystore
+
+@file
+keystore.c contains the indexed single-file keystore. See keystore.h for an
+overview.
+*/
+
+// pwrite(), fdatasync() and mmap() are POSIX.1-2008
+#define _POSIX_C_SOURCE 200809L
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_STORAGE
+
+#include "boatinternal.h"
+#include "keystore.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+//!@brief Keystore file magic, followed by the format version
+#define BOAT_KEYSTORE_MAGIC "BOATKS\r\n"
+#define BOAT_KEYSTORE_VERSION 1
+
+//!@brief The index of a new or compacted keystore has at least so many slots
+#define BOAT_KEYSTORE_MIN_SLOT_NUM 64
+
+//!@brief The index is grown when more than 3/4 of the slots are used or removed
+#define BOAT_KEYSTORE_MAX_LOAD(slot_num) ((slot_num) / 4 * 3)
+
+//!@brief Dead space is not reclaimed until it exceeds both this size and the live records
+#define BOAT_KEYSTORE_COMPACT_MIN_DEAD_LEN (64 * 1024)
+
+//!@brief The mapping is at least so large to avoid remapping on every append
+#define BOAT_KEYSTORE_MIN_MAP_LEN (1024 * 1024)
+
+#define BOAT_KEYSTORE_MAX_NAME_LEN 1024
+
+// Special offsets in an index slot. Offset 0 is the file header, thus never a record.
+#define BOAT_KEYSTORE_SLOT_EMPTY   0x00000000u
+#define BOAT_KEYSTORE_SLOT_REMOVED 0xFFFFFFFFu
+
+//!@brief Records are 8-byte aligned
+#define BOAT_KEYSTORE_ALIGN(len) (((len) + 7) & ~(BUINT32)7)
+
+/*
+ File layout (all integers in host byte order):
+
+ ---------------------------------------------------------------------------
+ | header (64 bytes) | index (slot_num * 16 bytes) | record | record | ... |
+ ---------------------------------------------------------------------------
+
+ A record is | name_len | data_len | name | data | 0~7 byte padding |.
+
+ The index is an open-addressing hash table with linear probing, keyed by the
+ 64-bit FNV-1a hash of the record name. Hash collisions are resolved by
+ comparing the name stored in the record.
+*/
+typedef struct TBoatKeystoreHeader
+{
+    BUINT8  magic[8];
+    BUINT32 version;
+    BUINT32 slot_num;         //!< Number of index slots, a power of 2
+    BUINT32 record_num;       //!< Number of live records
+    BUINT32 removed_slot_num; //!< Number of slots marked as BOAT_KEYSTORE_SLOT_REMOVED
+    BUINT32 data_end;         //!< File offset to append the next record at
+    BUINT32 dead_len;         //!< Bytes taken by overwritten or removed records
+    BUINT8  reserved[32];
+}BoatKeystoreHeader;
+
+typedef struct TBoatKeystoreSlot
+{
+    BUINT64 name_hash;
+    BUINT32 offset; //!< File offset of the record, or BOAT_KEYSTORE_SLOT_EMPTY/REMOVED
+    BUINT32 length; //!< Total (aligned) length of the record
+}BoatKeystoreSlot;
+
+typedef struct TBoatKeystoreRecordHeader
+{
+    BUINT32 name_len;
+    BUINT32 data_len;
+}BoatKeystoreRecordHeader;
+
+struct TBoatKeystore
+{
+    BCHAR *file_name_str;
+    int fd;
+    const BUINT8 *map_ptr; //!< Read-only shared mapping of the file
+    size_t map_len;
+    BoatKeystoreHeader header; //!< In-memory copy of the file header
+};
+
+
+__BOATSTATIC BUINT64 KeystoreNameHash(const BCHAR *name_str, BUINT32 name_len)
+{
+    BUINT64 hash = 0xcbf29ce484222325ULL;
+    BUINT32 i;
+
+    for( i = 0; i < name_len; i++ )
+    {
+        hash ^= (BUINT8)name_str[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+__BOATSTATIC BUINT32 KeystoreIndexEnd(BUINT32 slot_num)
+{
+    return sizeof(BoatKeystoreHeader) + slot_num * sizeof(BoatKeystoreSlot);
+}
+
+
+__BOATSTATIC const BoatKeystoreSlot *KeystoreSlot(const BoatKeystore *keystore_ptr, BUINT32 slot_index)
+{
+    return (const BoatKeystoreSlot *)(keystore_ptr->map_ptr + sizeof(BoatKeystoreHeader)) + slot_index;
+}
+
+
+__BOATSTATIC BOAT_RESULT KeystoreWrite(int fd, const void *data_ptr, size_t data_len, off_t offset)
+{
+    const BUINT8 *ptr = data_ptr;
+    ssize_t written;
+
+    while( data_len > 0 )
+    {
+        written = pwrite(fd, ptr, data_len, offset);
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return BOAT_ERROR;
+        }
+
+        ptr += written;
+        data_len -= written;
+        offset += written;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Map the file up to data_end
+
+Function: KeystoreMap()
+
+    The mapping is made larger than the file so that appending records does not
+    remap every time. Pages beyond the end of the file are never accessed.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreMap(BoatKeystore *keystore_ptr)
+{
+    void *map_ptr;
+    size_t map_len;
+    long page_size;
+
+    if( keystore_ptr->map_ptr != NULL && keystore_ptr->map_len >= keystore_ptr->header.data_end )
+    {
+        return BOAT_SUCCESS;
+    }
+
+    map_len = (size_t)keystore_ptr->header.data_end * 2;
+    if( map_len < BOAT_KEYSTORE_MIN_MAP_LEN )
+    {
+        map_len = BOAT_KEYSTORE_MIN_MAP_LEN;
+    }
+    page_size = sysconf(_SC_PAGESIZE);
+    if( page_size > 0 )
+    {
+        map_len = (map_len + page_size - 1) / page_size * page_size;
+    }
+
+    map_ptr = mmap(NULL, map_len, PROT_READ, MAP_SHARED, keystore_ptr->fd, 0);
+    if( map_ptr == MAP_FAILED )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to map keystore %s.", keystore_ptr->file_name_str);
+        return BOAT_ERROR;
+    }
+
+    if( keystore_ptr->map_ptr != NULL )
+    {
+        munmap((void *)keystore_ptr->map_ptr, keystore_ptr->map_len);
+    }
+
+    keystore_ptr->map_ptr = map_ptr;
+    keystore_ptr->map_len = map_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Look up a record name in the index
+
+Function: KeystoreFind()
+
+@return
+    This function returns BOAT_TRUE if the name is found. The slot holding it is
+    returned in <slot_index_ptr>.\n
+    Otherwise it returns BOAT_FALSE and <slot_index_ptr> is the slot where a
+    record with that name would be inserted, or slot_num if the index is full.
+
+*******************************************************************************/
+__BOATSTATIC BBOOL KeystoreFind(const BoatKeystore *keystore_ptr,
+                                const BCHAR *name_str,
+                                BUINT32 name_len,
+                                BUINT64 name_hash,
+                                BUINT32 *slot_index_ptr)
+{
+    const BoatKeystoreSlot *slot_ptr;
+    BoatKeystoreRecordHeader record_header;
+    BUINT32 slot_num = keystore_ptr->header.slot_num;
+    BUINT32 insert_index = slot_num;
+    BUINT32 slot_index;
+    BUINT32 probe;
+
+    slot_index = (BUINT32)name_hash & (slot_num - 1);
+
+    for( probe = 0; probe < slot_num; probe++ )
+    {
+        slot_ptr = KeystoreSlot(keystore_ptr, slot_index);
+
+        if( slot_ptr->offset == BOAT_KEYSTORE_SLOT_EMPTY )
+        {
+            if( insert_index == slot_num )
+            {
+                insert_index = slot_index;
+            }
+            break;
+        }
+        else if( slot_ptr->offset == BOAT_KEYSTORE_SLOT_REMOVED )
+        {
+            if( insert_index == slot_num )
+            {
+                insert_index = slot_index;
+            }
+        }
+        else if( slot_ptr->name_hash == name_hash )
+        {
+            memcpy(&record_header, keystore_ptr->map_ptr + slot_ptr->offset, sizeof(record_header));
+
+            if(    record_header.name_len == name_len
+                && 0 == memcmp(keystore_ptr->map_ptr + slot_ptr->offset + sizeof(record_header), name_str, name_len) )
+            {
+                *slot_index_ptr = slot_index;
+                return BOAT_TRUE;
+            }
+        }
+
+        slot_index = (slot_index + 1) & (slot_num - 1);
+    }
+
+    *slot_index_ptr = insert_index;
+
+    return BOAT_FALSE;
+}
+
+
+/******************************************************************************
+@brief Recount the header fields from the index
+
+Function: KeystoreRecover()
+
+    The index slot and the header are updated after the record is synced, but
+    not atomically. If the process is interrupted in between, the counters and
+    <data_end> in the header may lag behind the index. The index is the reference,
+    thus the header is rebuilt from it when the keystore is opened.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreRecover(BoatKeystore *keystore_ptr, off_t file_size)
+{
+    BoatKeystoreHeader *header_ptr = &keystore_ptr->header;
+    const BoatKeystoreSlot *slot_ptr;
+    BUINT32 index_end = KeystoreIndexEnd(header_ptr->slot_num);
+    BUINT32 live_len = 0;
+    BUINT32 data_end = BOAT_MAX(header_ptr->data_end, index_end);
+    BUINT32 i;
+
+    header_ptr->record_num = 0;
+    header_ptr->removed_slot_num = 0;
+
+    for( i = 0; i < header_ptr->slot_num; i++ )
+    {
+        slot_ptr = KeystoreSlot(keystore_ptr, i);
+
+        if( slot_ptr->offset == BOAT_KEYSTORE_SLOT_REMOVED )
+        {
+            header_ptr->removed_slot_num++;
+        }
+        else if( slot_ptr->offset != BOAT_KEYSTORE_SLOT_EMPTY )
+        {
+            if(    slot_ptr->offset < index_end
+                || (off_t)slot_ptr->offset + slot_ptr->length > file_size )
+            {
+                return BOAT_ERROR;
+            }
+
+            header_ptr->record_num++;
+            live_len += slot_ptr->length;
+            data_end = BOAT_MAX(data_end, slot_ptr->offset + slot_ptr->length);
+        }
+    }
+
+    header_ptr->data_end = data_end;
+    header_ptr->dead_len = data_end - index_end - live_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+__BOATSTATIC BOAT_RESULT KeystoreCreateFile(const BCHAR *file_name_str,
+                                            BUINT32 slot_num,
+                                            const BoatKeystoreSlot *slot_array,
+                                            int *fd_ptr,
+                                            BoatKeystoreHeader *header_ptr)
+{
+    int fd;
+
+    memset(header_ptr, 0x00, sizeof(BoatKeystoreHeader));
+    memcpy(header_ptr->magic, BOAT_KEYSTORE_MAGIC, sizeof(header_ptr->magic));
+    header_ptr->version = BOAT_KEYSTORE_VERSION;
+    header_ptr->slot_num = slot_num;
+    header_ptr->data_end = KeystoreIndexEnd(slot_num);
+
+    fd = open(file_name_str, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if( fd < 0 )
+    {
+        return BOAT_ERROR;
+    }
+
+    if(    KeystoreWrite(fd, header_ptr, sizeof(BoatKeystoreHeader), 0) != BOAT_SUCCESS
+        || (    slot_array != NULL
+             && KeystoreWrite(fd, slot_array, slot_num * sizeof(BoatKeystoreSlot), sizeof(BoatKeystoreHeader)) != BOAT_SUCCESS )
+        || ftruncate(fd, header_ptr->data_end) != 0 )
+    {
+        close(fd);
+        return BOAT_ERROR;
+    }
+
+    *fd_ptr = fd;
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Sync the directory holding <file_name_str>, making a rename durable
+
+Function: KeystoreSyncDir()
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreSyncDir(const BCHAR *file_name_str)
+{
+    const BCHAR *slash_ptr = strrchr(file_name_str, '/');
+    BCHAR *dir_name_str;
+    size_t dir_len;
+    int dir_fd;
+    BOAT_RESULT result = BOAT_ERROR;
+
+    if( slash_ptr == NULL )
+    {
+        dir_name_str = BoatMalloc(sizeof("."));
+        dir_len = 1;
+        if( dir_name_str != NULL )
+        {
+            dir_name_str[0] = '.';
+        }
+    }
+    else
+    {
+        // The root directory keeps its slash
+        dir_len = (slash_ptr == file_name_str) ? 1 : (size_t)(slash_ptr - file_name_str);
+        dir_name_str = BoatMalloc(dir_len + 1);
+        if( dir_name_str != NULL )
+        {
+            memcpy(dir_name_str, file_name_str, dir_len);
+        }
+    }
+
+    if( dir_name_str == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+    dir_name_str[dir_len] = '\0';
+
+    dir_fd = open(dir_name_str, O_RDONLY);
+    if( dir_fd >= 0 )
+    {
+        if( fsync(dir_fd) == 0 )
+        {
+            result = BOAT_SUCCESS;
+        }
+        close(dir_fd);
+    }
+    BoatFree(dir_name_str);
+
+    return result;
+}
+
+
+/******************************************************************************
+@brief Rewrite the live records into a new file with an index of <slot_num> slots
+
+Function: KeystoreRebuild()
+
+    The new file is written as <file_name>.tmp, synced and then renamed over
+    the keystore, and the directory is synced for the rename to survive a
+    power loss. If anything fails before the rename, the keystore is left
+    untouched.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreRebuild(BoatKeystore *keystore_ptr, BUINT32 slot_num)
+{
+    BoatKeystoreHeader header;
+    BoatKeystoreSlot *slot_array = NULL;
+    const BoatKeystoreSlot *old_slot_ptr;
+    BCHAR *tmp_name_str = NULL;
+    size_t name_len;
+    BUINT32 slot_index;
+    BUINT32 i;
+    int fd = -1;
+    BOAT_RESULT result = BOAT_ERROR;
+
+    name_len = strlen(keystore_ptr->file_name_str);
+    tmp_name_str = BoatMalloc(name_len + sizeof(".tmp"));
+    slot_array = BoatMalloc(slot_num * sizeof(BoatKeystoreSlot));
+    if( tmp_name_str == NULL || slot_array == NULL )
+    {
+        goto KeystoreRebuild_cleanup;
+    }
+    memcpy(tmp_name_str, keystore_ptr->file_name_str, name_len);
+    memcpy(tmp_name_str + name_len, ".tmp", sizeof(".tmp"));
+    memset(slot_array, 0x00, slot_num * sizeof(BoatKeystoreSlot));
+
+    if( KeystoreCreateFile(tmp_name_str, slot_num, NULL, &fd, &header) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to create %s.", tmp_name_str);
+        goto KeystoreRebuild_cleanup;
+    }
+
+    // Copy the live records, which are still valid after compaction as is
+    for( i = 0; i < keystore_ptr->header.slot_num; i++ )
+    {
+        old_slot_ptr = KeystoreSlot(keystore_ptr, i);
+        if(    old_slot_ptr->offset == BOAT_KEYSTORE_SLOT_EMPTY
+            || old_slot_ptr->offset == BOAT_KEYSTORE_SLOT_REMOVED )
+        {
+            continue;
+        }
+
+        if( KeystoreWrite(fd, keystore_ptr->map_ptr + old_slot_ptr->offset, old_slot_ptr->length, header.data_end) != BOAT_SUCCESS )
+        {
+            goto KeystoreRebuild_cleanup;
+        }
+
+        slot_index = (BUINT32)old_slot_ptr->name_hash & (slot_num - 1);
+        while( slot_array[slot_index].offset != BOAT_KEYSTORE_SLOT_EMPTY )
+        {
+            slot_index = (slot_index + 1) & (slot_num - 1);
+        }
+        slot_array[slot_index].name_hash = old_slot_ptr->name_hash;
+        slot_array[slot_index].offset = header.data_end;
+        slot_array[slot_index].length = old_slot_ptr->length;
+
+        header.data_end += old_slot_ptr->length;
+        header.record_num++;
+    }
+
+    if(    KeystoreWrite(fd, slot_array, slot_num * sizeof(BoatKeystoreSlot), sizeof(BoatKeystoreHeader)) != BOAT_SUCCESS
+        || KeystoreWrite(fd, &header, sizeof(header), 0) != BOAT_SUCCESS
+        || fsync(fd) != 0 )
+    {
+        goto KeystoreRebuild_cleanup;
+    }
+
+    if( rename(tmp_name_str, keystore_ptr->file_name_str) != 0 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to replace %s.", keystore_ptr->file_name_str);
+        goto KeystoreRebuild_cleanup;
+    }
+
+    // Either file is a consistent keystore, so a failure here only risks
+    // finding the old one after a power loss
+    if( KeystoreSyncDir(keystore_ptr->file_name_str) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to sync the directory of %s.", keystore_ptr->file_name_str);
+    }
+
+    // Switch to the new file
+    close(keystore_ptr->fd);
+    keystore_ptr->fd = fd;
+    fd = -1;
+    munmap((void *)keystore_ptr->map_ptr, keystore_ptr->map_len);
+    keystore_ptr->map_ptr = NULL;
+    keystore_ptr->map_len = 0;
+    memcpy(&keystore_ptr->header, &header, sizeof(header));
+
+    result = KeystoreMap(keystore_ptr);
+
+KeystoreRebuild_cleanup:
+    if( fd >= 0 )
+    {
+        close(fd);
+        unlink(tmp_name_str);
+    }
+    BoatFree(slot_array);
+    BoatFree(tmp_name_str);
+
+    return result;
+}
+
+
+__BOATSTATIC BUINT32 KeystoreSlotNumFor(BUINT32 record_num)
+{
+    BUINT32 slot_num = BOAT_KEYSTORE_MIN_SLOT_NUM;
+
+    // Leave the index at most half full
+    while( slot_num / 2 < record_num + 1 )
+    {
+        slot_num *= 2;
+    }
+
+    return slot_num;
+}
+
+
+/******************************************************************************
+@brief Reclaim dead space if it's worth
+
+Function: KeystoreMaybeCompact()
+
+    Compaction is triggered only if the dead space exceeds the live records, so
+    every byte is rewritten at most once on average per byte overwritten.
+
+*******************************************************************************/
+__BOATSTATIC void KeystoreMaybeCompact(BoatKeystore *keystore_ptr)
+{
+    const BoatKeystoreHeader *header_ptr = &keystore_ptr->header;
+    BUINT32 live_len;
+
+    live_len = header_ptr->data_end - KeystoreIndexEnd(header_ptr->slot_num) - header_ptr->dead_len;
+
+    if(    header_ptr->dead_len > BOAT_KEYSTORE_COMPACT_MIN_DEAD_LEN
+        && header_ptr->dead_len > live_len )
+    {
+        // On failure the keystore stays valid, only the dead space is kept
+        BoatKeystoreCompact(keystore_ptr);
+    }
+}
+
+
+/*!*****************************************************************************
+@brief Open a keystore file
+
+Function: BoatKeystoreOpen()
+
+    This function opens a keystore file, or creates an empty one if the file
+    doesn't exist. The file is mapped into memory and no record is read until
+    it's looked up.
+
+@return
+    This function returns the keystore handle if successful.\n
+    Otherwise it returns NULL.
+
+@param[in] file_name_str
+    Path of the keystore file.
+
+*******************************************************************************/
+BoatKeystore *BoatKeystoreOpen(const BCHAR *file_name_str)
+{
+    BoatKeystore *keystore_ptr;
+    BoatKeystoreHeader *header_ptr;
+    struct stat file_stat;
+    size_t name_len;
+    ssize_t read_len;
+
+    if( file_name_str == NULL )
+    {
+        return NULL;
+    }
+
+    keystore_ptr = BoatMalloc(sizeof(BoatKeystore));
+    if( keystore_ptr == NULL )
+    {
+        return NULL;
+    }
+    memset(keystore_ptr, 0x00, sizeof(BoatKeystore));
+    keystore_ptr->fd = -1;
+    header_ptr = &keystore_ptr->header;
+
+    name_len = strlen(file_name_str);
+    keystore_ptr->file_name_str = BoatMalloc(name_len + 1);
+    if( keystore_ptr->file_name_str == NULL )
+    {
+        goto BoatKeystoreOpen_fail;
+    }
+    memcpy(keystore_ptr->file_name_str, file_name_str, name_len + 1);
+
+    keystore_ptr->fd = open(file_name_str, O_RDWR);
+    if( keystore_ptr->fd < 0 )
+    {
+        if( errno != ENOENT
+            || KeystoreCreateFile(file_name_str, BOAT_KEYSTORE_MIN_SLOT_NUM, NULL,
+                                  &keystore_ptr->fd, header_ptr) != BOAT_SUCCESS )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Fail to open keystore %s.", file_name_str);
+            goto BoatKeystoreOpen_fail;
+        }
+    }
+    else
+    {
+        read_len = pread(keystore_ptr->fd, header_ptr, sizeof(BoatKeystoreHeader), 0);
+
+        if(    read_len != sizeof(BoatKeystoreHeader)
+            || memcmp(header_ptr->magic, BOAT_KEYSTORE_MAGIC, sizeof(header_ptr->magic)) != 0
+            || header_ptr->version != BOAT_KEYSTORE_VERSION
+            || header_ptr->slot_num < BOAT_KEYSTORE_MIN_SLOT_NUM
+            || (header_ptr->slot_num & (header_ptr->slot_num - 1)) != 0
+            || header_ptr->slot_num > (0xFFFFFFFFu - sizeof(BoatKeystoreHeader)) / sizeof(BoatKeystoreSlot)
+            || fstat(keystore_ptr->fd, &file_stat) != 0
+            || file_stat.st_size < KeystoreIndexEnd(header_ptr->slot_num) )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "%s is not a valid keystore.", file_name_str);
+            goto BoatKeystoreOpen_fail;
+        }
+
+        // Map the index first. KeystoreRecover() may only move data_end forward.
+        header_ptr->data_end = KeystoreIndexEnd(header_ptr->slot_num);
+        if(    KeystoreMap(keystore_ptr) != BOAT_SUCCESS
+            || KeystoreRecover(keystore_ptr, file_stat.st_size) != BOAT_SUCCESS )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "%s is corrupted.", file_name_str);
+            goto BoatKeystoreOpen_fail;
+        }
+    }
+
+    if( KeystoreMap(keystore_ptr) != BOAT_SUCCESS )
+    {
+        goto BoatKeystoreOpen_fail;
+    }
+
+    return keystore_ptr;
+
+BoatKeystoreOpen_fail:
+    BoatKeystoreClose(keystore_ptr);
+
+    return NULL;
+}
+
+
+/*!*****************************************************************************
+@brief Close a keystore
+
+Function: BoatKeystoreClose()
+
+    This function unmaps and closes the keystore file and frees the handle.
+    Pointers returned by BoatKeystoreGet() become invalid.
+
+@return This function doesn't return any thing.
+
+@param[in] keystore_ptr
+    The keystore to close. It may be NULL.
+
+*******************************************************************************/
+void BoatKeystoreClose(BoatKeystore *keystore_ptr)
+{
+    if( keystore_ptr == NULL )
+    {
+        return;
+    }
+
+    if( keystore_ptr->map_ptr != NULL )
+    {
+        munmap((void *)keystore_ptr->map_ptr, keystore_ptr->map_len);
+    }
+    if( keystore_ptr->fd >= 0 )
+    {
+        close(keystore_ptr->fd);
+    }
+
+    BoatFree(keystore_ptr->file_name_str);
+    BoatFree(keystore_ptr);
+}
+
+
+/*!*****************************************************************************
+@brief Put a record into the keystore
+
+Function: BoatKeystorePut()
+
+    This function appends a record to the keystore file and points the index
+    at it. An existing record with the same name is replaced. The record is
+    synced to the storage before the index is updated, thus an interrupted put
+    leaves either the old or the new record.
+
+    Pointers returned by BoatKeystoreGet() become invalid.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] keystore_ptr
+    The keystore.
+
+@param[in] name_str
+    Name of the record, up to 1024 bytes.
+
+@param[in] record_ptr
+    The record data.
+
+@param[in] record_len
+    Length (in byte) of <record_ptr>.
+
+*******************************************************************************/
+BOAT_RESULT BoatKeystorePut(BoatKeystore *keystore_ptr,
+                            const BCHAR *name_str,
+                            const BUINT8 *record_ptr,
+                            BUINT32 record_len)
+{
+    BoatKeystoreHeader *header_ptr;
+    BoatKeystoreHeader header;
+    BoatKeystoreRecordHeader record_header;
+    BoatKeystoreSlot slot;
+    BoatKeystoreSlot old_slot;
+    BUINT8 *buf_ptr;
+    BUINT64 name_hash;
+    BUINT32 name_len;
+    BUINT32 total_len;
+    BUINT32 slot_index;
+    BBOOL is_found;
+    BOAT_RESULT result;
+
+    if( keystore_ptr == NULL || name_str == NULL || (record_ptr == NULL && record_len != 0) )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    header_ptr = &keystore_ptr->header;
+    name_len = strlen(name_str);
+
+    if(    name_len > BOAT_KEYSTORE_MAX_NAME_LEN
+        || record_len > 0x7FFFFFFFu - header_ptr->data_end )
+    {
+        return BOAT_ERROR_INVALID_LENGTH;
+    }
+
+    total_len = BOAT_KEYSTORE_ALIGN(sizeof(record_header) + name_len + record_len);
+    name_hash = KeystoreNameHash(name_str, name_len);
+
+    is_found = KeystoreFind(keystore_ptr, name_str, name_len, name_hash, &slot_index);
+
+    // A new name takes an empty or removed slot. Grow the index before it gets crowded.
+    if(    is_found == BOAT_FALSE
+        && (   slot_index == header_ptr->slot_num
+            || header_ptr->record_num + header_ptr->removed_slot_num + 1 > BOAT_KEYSTORE_MAX_LOAD(header_ptr->slot_num) ) )
+    {
+        result = KeystoreRebuild(keystore_ptr, KeystoreSlotNumFor(header_ptr->record_num + 1));
+        if( result != BOAT_SUCCESS )
+        {
+            return result;
+        }
+
+        KeystoreFind(keystore_ptr, name_str, name_len, name_hash, &slot_index);
+    }
+
+    // Append the record
+    buf_ptr = BoatMalloc(total_len);
+    if( buf_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    record_header.name_len = name_len;
+    record_header.data_len = record_len;
+    memset(buf_ptr, 0x00, total_len);
+    memcpy(buf_ptr, &record_header, sizeof(record_header));
+    memcpy(buf_ptr + sizeof(record_header), name_str, name_len);
+    if( record_len != 0 )
+    {
+        memcpy(buf_ptr + sizeof(record_header) + name_len, record_ptr, record_len);
+    }
+
+    result = KeystoreWrite(keystore_ptr->fd, buf_ptr, total_len, header_ptr->data_end);
+    BoatFree(buf_ptr);
+
+    if( result != BOAT_SUCCESS || fdatasync(keystore_ptr->fd) != 0 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to write keystore %s.", keystore_ptr->file_name_str);
+        return BOAT_ERROR;
+    }
+
+    // Point the index at the new record. The header is updated in a copy,
+    // which replaces the in-memory header only once it is on disk.
+    slot.name_hash = name_hash;
+    slot.offset = header_ptr->data_end;
+    slot.length = total_len;
+
+    memcpy(&old_slot, KeystoreSlot(keystore_ptr, slot_index), sizeof(old_slot));
+    memcpy(&header, header_ptr, sizeof(header));
+    if( is_found == BOAT_TRUE )
+    {
+        header.dead_len += KeystoreSlot(keystore_ptr, slot_index)->length;
+    }
+    else
+    {
+        if( KeystoreSlot(keystore_ptr, slot_index)->offset == BOAT_KEYSTORE_SLOT_REMOVED )
+        {
+            header.removed_slot_num--;
+        }
+        header.record_num++;
+    }
+    header.data_end += total_len;
+
+    if(    KeystoreWrite(keystore_ptr->fd, &slot, sizeof(slot),
+                         sizeof(BoatKeystoreHeader) + slot_index * sizeof(BoatKeystoreSlot)) != BOAT_SUCCESS
+        || KeystoreWrite(keystore_ptr->fd, &header, sizeof(header), 0) != BOAT_SUCCESS
+        || fdatasync(keystore_ptr->fd) != 0 )
+    {
+        // Best effort to put the index and the header back as they are in memory
+        KeystoreWrite(keystore_ptr->fd, &old_slot, sizeof(old_slot),
+                      sizeof(BoatKeystoreHeader) + slot_index * sizeof(BoatKeystoreSlot));
+        KeystoreWrite(keystore_ptr->fd, header_ptr, sizeof(BoatKeystoreHeader), 0);
+        BoatLog(BOAT_LOG_NORMAL, "Fail to update keystore %s.", keystore_ptr->file_name_str);
+        return BOAT_ERROR;
+    }
+
+    memcpy(header_ptr, &header, sizeof(header));
+    if( KeystoreMap(keystore_ptr) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to map keystore %s.", keystore_ptr->file_name_str);
+        return BOAT_ERROR;
+    }
+
+    KeystoreMaybeCompact(keystore_ptr);
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Look up a record in the keystore
+
+Function: BoatKeystoreGet()
+
+    This function looks up a record by name. The record is not copied: the
+    returned pointer points into the read-only mapping of the keystore file.
+    It's valid until the next BoatKeystorePut(), BoatKeystoreRemove(),
+    BoatKeystoreCompact() or BoatKeystoreClose() on the same keystore.
+
+@return
+    This function returns BOAT_SUCCESS if the record is found.\n
+    It returns BOAT_ERROR if there's no record with that name.
+
+@param[in] keystore_ptr
+    The keystore.
+
+@param[in] name_str
+    Name of the record.
+
+@param[out] record_ptr_ptr
+    The record data.
+
+@param[out] record_len_ptr
+    Length (in byte) of the record data.
+
+*******************************************************************************/
+BOAT_RESULT BoatKeystoreGet(BoatKeystore *keystore_ptr,
+                            const BCHAR *name_str,
+                            const BUINT8 **record_ptr_ptr,
+                            BUINT32 *record_len_ptr)
+{
+    const BoatKeystoreSlot *slot_ptr;
+    BoatKeystoreRecordHeader record_header;
+    BUINT32 name_len;
+    BUINT32 slot_index;
+
+    if( keystore_ptr == NULL || name_str == NULL || record_ptr_ptr == NULL || record_len_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    name_len = strlen(name_str);
+
+    if( KeystoreFind(keystore_ptr, name_str, name_len,
+                     KeystoreNameHash(name_str, name_len), &slot_index) != BOAT_TRUE )
+    {
+        return BOAT_ERROR;
+    }
+
+    slot_ptr = KeystoreSlot(keystore_ptr, slot_index);
+    memcpy(&record_header, keystore_ptr->map_ptr + slot_ptr->offset, sizeof(record_header));
+
+    if( sizeof(record_header) + (BUINT64)record_header.name_len + record_header.data_len > slot_ptr->length )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Record %s in keystore is corrupted.", name_str);
+        return BOAT_ERROR;
+    }
+
+    *record_ptr_ptr = keystore_ptr->map_ptr + slot_ptr->offset + sizeof(record_header) + name_len;
+    *record_len_ptr = record_header.data_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Remove a record from the keystore
+
+Function: BoatKeystoreRemove()
+
+    This function marks the index slot of a record as removed. The record data
+    stays in the file as dead space until compaction.
+
+    Pointers returned by BoatKeystoreGet() become invalid.
+
+@return
+    This function returns BOAT_SUCCESS if the record is removed.\n
+    It returns BOAT_ERROR if there's no record with that name.
+
+@param[in] keystore_ptr
+    The keystore.
+
+@param[in] name_str
+    Name of the record.
+
+*******************************************************************************/
+BOAT_RESULT BoatKeystoreRemove(BoatKeystore *keystore_ptr, const BCHAR *name_str)
+{
+    BoatKeystoreHeader *header_ptr;
+    BoatKeystoreHeader header;
+    BoatKeystoreSlot slot;
+    BoatKeystoreSlot old_slot;
+    BUINT32 name_len;
+    BUINT32 slot_index;
+
+    if( keystore_ptr == NULL || name_str == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    header_ptr = &keystore_ptr->header;
+    name_len = strlen(name_str);
+
+    if( KeystoreFind(keystore_ptr, name_str, name_len,
+                     KeystoreNameHash(name_str, name_len), &slot_index) != BOAT_TRUE )
+    {
+        return BOAT_ERROR;
+    }
+
+    // As in BoatKeystorePut(), the header is replaced once it is on disk
+    memcpy(&old_slot, KeystoreSlot(keystore_ptr, slot_index), sizeof(old_slot));
+    memcpy(&header, header_ptr, sizeof(header));
+    header.dead_len += KeystoreSlot(keystore_ptr, slot_index)->length;
+    header.record_num--;
+    header.removed_slot_num++;
+
+    memset(&slot, 0x00, sizeof(slot));
+    slot.offset = BOAT_KEYSTORE_SLOT_REMOVED;
+
+    if(    KeystoreWrite(keystore_ptr->fd, &slot, sizeof(slot),
+                         sizeof(BoatKeystoreHeader) + slot_index * sizeof(BoatKeystoreSlot)) != BOAT_SUCCESS
+        || KeystoreWrite(keystore_ptr->fd, &header, sizeof(header), 0) != BOAT_SUCCESS
+        || fdatasync(keystore_ptr->fd) != 0 )
+    {
+        // Best effort to put the index and the header back as they are in memory
+        KeystoreWrite(keystore_ptr->fd, &old_slot, sizeof(old_slot),
+                      sizeof(BoatKeystoreHeader) + slot_index * sizeof(BoatKeystoreSlot));
+        KeystoreWrite(keystore_ptr->fd, header_ptr, sizeof(BoatKeystoreHeader), 0);
+        BoatLog(BOAT_LOG_NORMAL, "Fail to update keystore %s.", keystore_ptr->file_name_str);
+        return BOAT_ERROR;
+    }
+
+    memcpy(header_ptr, &header, sizeof(header));
+
+    KeystoreMaybeCompact(keystore_ptr);
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Compact the keystore
+
+Function: BoatKeystoreCompact()
+
+    This function rewrites the live records into a new keystore file, dropping
+    the dead space and the removed index slots. The index is resized to keep
+    it at most half full. It's called automatically when there is more dead
+    space than live data, thus it's rarely necessary to call it explicitly.
+
+    Pointers returned by BoatKeystoreGet() become invalid.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes and the keystore is unchanged.
+
+@param[in] keystore_ptr
+    The keystore.
+
+*******************************************************************************/
+BOAT_RESULT BoatKeystoreCompact(BoatKeystore *keystore_ptr)
+{
+    if( keystore_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    return KeystoreRebuild(keystore_ptr, KeystoreSlotNumFor(keystore_ptr->header.record_num));
+}
+
+
+/*!*****************************************************************************
+@brief Get the number of records in the keystore
+
+Function: BoatKeystoreRecordNum()
+
+@return
+    This function returns the number of records.
+
+@param[in] keystore_ptr
+    The keystore.
+
+*******************************************************************************/
+BUINT32 BoatKeystoreRecordNum(const BoatKeystore *keystore_ptr)
+{
+    return keystore_ptr != NULL ? keystore_ptr->header.record_num : 0;
+}
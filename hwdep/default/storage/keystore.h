@@ -0,0 +1,74 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Indexed single-file keystore
+
+@file
+keystore.h declares a container that keeps many named records in one file.
+
+The file starts with a header and an open-addressing hash index (name hash to
+record offset), followed by the records in append order. The file is mapped
+read-only into memory, thus looking up a record is a hash probe in the mapped
+index without any file system access.
+
+Records are opaque to the container. The persistent storage encrypts each
+record separately before it's put into the container (see persiststore.c).
+
+Writes append the new record and then update the index in place, so an
+overwritten or removed record leaves dead space in the file. Dead space is
+reclaimed by compaction, which rewrites the live records into a new file and
+atomically renames it over the old one. Compaction is also used to grow the
+index. Both happen automatically.
+
+A keystore is not thread-safe. The file is meant to be opened by one process.
+*/
+
+#ifndef __KEYSTORE_H__
+#define __KEYSTORE_H__
+
+#include "boatinternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TBoatKeystore BoatKeystore;
+
+BoatKeystore *BoatKeystoreOpen(const BCHAR *file_name_str);
+void BoatKeystoreClose(BoatKeystore *keystore_ptr);
+
+BOAT_RESULT BoatKeystorePut(BoatKeystore *keystore_ptr,
+                            const BCHAR *name_str,
+                            const BUINT8 *record_ptr,
+                            BUINT32 record_len);
+
+BOAT_RESULT BoatKeystoreGet(BoatKeystore *keystore_ptr,
+                            const BCHAR *name_str,
+                            const BUINT8 **record_ptr_ptr,
+                            BUINT32 *record_len_ptr);
+
+BOAT_RESULT BoatKeystoreRemove(BoatKeystore *keystore_ptr, const BCHAR *name_str);
+
+BOAT_RESULT BoatKeystoreCompact(BoatKeystore *keystore_ptr);
+
+BUINT32 BoatKeystoreRecordNum(const BoatKeystore *keystore_ptr);
+
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
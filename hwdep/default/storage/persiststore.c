@@ -20,19 +20,47 @@
 persiststore.c contains APIs for default persistent storage as a file.
 */
 
+// open() flags and fsync() are POSIX
+#define _POSIX_C_SOURCE 200809L
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_STORAGE
+
 #include "boatinternal.h"
+#include "persiststore.h"
 #include "randgenerator.h"
 #include "sha3.h"
 
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+#include "keystore.h"
+#include <pthread.h>
+#endif
+
 
 #if BOAT_USE_OPENSSL != 0
 #include <openssl/evp.h>
 #include <openssl/aes.h>
 #endif
 
+#include <errno.h>
+#include <fcntl.h>
+
 //!@brief Salt size for keystore
 #define BOAT_STORAGE_SALT_SIZE 16
 
+//!@brief AES-GCM storage format: | magic | nonce | AES-GCM(data) | tag |
+#define BOAT_STORAGE_AEAD_MAGIC "BGCM"
+#define BOAT_STORAGE_AEAD_MAGIC_SIZE 4
+#define BOAT_STORAGE_NONCE_SIZE 12
+#define BOAT_STORAGE_TAG_SIZE 16
+#define BOAT_STORAGE_AEAD_HEADER_SIZE (BOAT_STORAGE_AEAD_MAGIC_SIZE + BOAT_STORAGE_NONCE_SIZE)
+
+// AES-GCM requires OpenSSL. Otherwise the hash-checked format is written.
+#if BOAT_PERSIST_USE_AEAD == 1 && BOAT_USE_OPENSSL != 0
+#define BOAT_STORAGE_SEAL_AEAD 1
+#else
+#define BOAT_STORAGE_SEAL_AEAD 0
+#endif
+
 // AES KEY FOR DEVELOPMENT ONLY. DO NOT USE IT FOR PRODUCTION.
 // Either replace it with a production key or replace the persitent storage
 // mechanism with a secure one.
@@ -43,6 +71,7 @@ __BOATSTATIC const BUINT8 g_aes_key[32] = { 0x7F ,0x78, 0xBC, 0xEC, 0xD8, 0xBA,
 
 
 
+#if BOAT_STORAGE_SEAL_AEAD == 0
 /******************************************************************************
 @brief AES encryption wrapper
 
@@ -185,6 +214,7 @@ __BOATSTATIC BOAT_RESULT KeystoreEncrypt(BOAT_OUT BUINT8 *encrypted_ptr, BOAT_IN
 
     return result;
 }
+#endif  // BOAT_STORAGE_SEAL_AEAD == 0
 
 
 
@@ -229,7 +259,7 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
 {
 #if BOAT_USE_OPENSSL != 0
     BUINT32 plain_total_len = 0;
-    BUINT8 temp_plain_array[encrypted_len];
+    BUINT8 *temp_plain_ptr = NULL;
 
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
     EVP_CIPHER_CTX ctx;
@@ -259,6 +289,13 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
 
 #if BOAT_USE_OPENSSL != 0
 
+    // Decrypted data including padding may be as large as the encrypted data
+    temp_plain_ptr = BoatMalloc(encrypted_len);
+    if( temp_plain_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
     // Initialize OpenSSL EVP context for cipher/decipher
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
     EVP_CIPHER_CTX_init(ctx_ptr);
@@ -276,13 +313,13 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
             plain_total_len = 0;
 
             // Decryption update
-            openssl_ret = EVP_DecryptUpdate(ctx_ptr, temp_plain_array, &openssl_len, encrypted_ptr, encrypted_len);
+            openssl_ret = EVP_DecryptUpdate(ctx_ptr, temp_plain_ptr, &openssl_len, encrypted_ptr, encrypted_len);
             if( openssl_ret == 1 )
             {
                 plain_total_len += openssl_len;
                 
                 // Finalize encryption
-                openssl_ret = EVP_DecryptFinal_ex(ctx_ptr, temp_plain_array + plain_total_len, &openssl_len);
+                openssl_ret = EVP_DecryptFinal_ex(ctx_ptr, temp_plain_ptr + plain_total_len, &openssl_len);
                 if( openssl_ret == 1 )
                 {
                     plain_total_len += openssl_len;
@@ -291,7 +328,7 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
                     if( *plain_len_ptr >= plain_total_len )
                     {
                         *plain_len_ptr = plain_total_len;
-                        memcpy(plain_ptr, temp_plain_array, plain_total_len);
+                        memcpy(plain_ptr, temp_plain_ptr, plain_total_len);
                         
                         result = BOAT_SUCCESS;
                     }
@@ -312,6 +349,9 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
     }
 #endif
 
+    memset(temp_plain_ptr, 0x00, encrypted_len);
+    BoatFree(temp_plain_ptr);
+
 #else   // BOAT_USE_OPENSSL != 0
 
     BSINT32 i;
@@ -335,12 +375,425 @@ __BOATSTATIC BOAT_RESULT KeystoreDecrypt(BOAT_OUT BUINT8 *plain_ptr, BOAT_INOUT
 }
 
 
+#if BOAT_STORAGE_SEAL_AEAD != 0
+/******************************************************************************
+@brief AES-GCM encryption wrapper
+
+Function: KeystoreAeadEncrypt()
+
+    This function encrypts and authenticates the data with AES-256 GCM in a
+    single pass. The encrypted data is the same size as the plain data and no
+    padding is added. <aad_ptr> is authenticated but not encrypted.
+
+    It's for internally use only.
+
+
+@see KeystoreAeadDecrypt()
+
+@return
+    This function returns BOAT_SUCCESS if it successfully encrypts the data.\n
+    Otherwise it returns one of the error codes.
+
+@param[out] encrypted_ptr
+    Output buffer of the encrypted data, at least <plain_len> bytes.
+
+@param[out] tag_ptr
+    Output buffer of the 16-byte authentication tag.
+
+@param[in] iv_ptr
+    12-byte nonce. It must never be reused with the same key.
+
+@param[in] aad_ptr
+    Additional data to authenticate.
+
+@param[in] aad_len
+    Length (in byte) of <aad_ptr>.
+
+@param[in] plain_ptr
+    Plain data to encrypt.
+
+@param[in] plain_len
+    Length (in byte) of <plain_ptr>.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreAeadEncrypt(BOAT_OUT BUINT8 *encrypted_ptr, BOAT_OUT BUINT8 *tag_ptr, const BUINT8 *iv_ptr, const BUINT8 *aad_ptr, BUINT32 aad_len, const BUINT8 *plain_ptr, BUINT32 plain_len)
+{
+    EVP_CIPHER_CTX *ctx_ptr;
+    int openssl_len;
+    BOAT_RESULT result = BOAT_ERROR;
+
+    ctx_ptr = EVP_CIPHER_CTX_new();
+    if( ctx_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    // The default IV length of GCM is 12 bytes
+    if(    EVP_EncryptInit_ex(ctx_ptr, EVP_aes_256_gcm(), NULL, g_aes_key, iv_ptr) == 1
+        && EVP_EncryptUpdate(ctx_ptr, NULL, &openssl_len, aad_ptr, aad_len) == 1
+        && EVP_EncryptUpdate(ctx_ptr, encrypted_ptr, &openssl_len, plain_ptr, plain_len) == 1
+        && EVP_EncryptFinal_ex(ctx_ptr, encrypted_ptr + openssl_len, &openssl_len) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx_ptr, EVP_CTRL_GCM_GET_TAG, BOAT_STORAGE_TAG_SIZE, tag_ptr) == 1 )
+    {
+        result = BOAT_SUCCESS;
+    }
+
+    EVP_CIPHER_CTX_free(ctx_ptr);
+
+    return result;
+}
+#endif  // BOAT_STORAGE_SEAL_AEAD != 0
+
+
+#if BOAT_USE_OPENSSL != 0
+/******************************************************************************
+@brief AES-GCM decryption wrapper
+
+Function: KeystoreAeadDecrypt()
+
+    This function decrypts the data with AES-256 GCM and verifies the
+    authentication tag over <aad_ptr> and the encrypted data.
+
+    The decrypted data is written to <plain_ptr> before the tag is verified.
+    The caller must discard it if this function fails.
+
+    It's for internally use only.
+
+
+@see KeystoreAeadEncrypt()
+
+@return
+    This function returns BOAT_SUCCESS if the data is decrypted and authentic.\n
+    Otherwise it returns one of the error codes.
+
+@param[out] plain_ptr
+    Output buffer of the decrypted data, at least <encrypted_len> bytes.
+
+@param[in] tag_ptr
+    16-byte authentication tag.
+
+@param[in] iv_ptr
+    12-byte nonce.
+
+@param[in] aad_ptr
+    Additional data to authenticate.
+
+@param[in] aad_len
+    Length (in byte) of <aad_ptr>.
+
+@param[in] encrypted_ptr
+    Encrypted data to decrypt.
+
+@param[in] encrypted_len
+    Length (in byte) of <encrypted_ptr>.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT KeystoreAeadDecrypt(BOAT_OUT BUINT8 *plain_ptr, const BUINT8 *tag_ptr, const BUINT8 *iv_ptr, const BUINT8 *aad_ptr, BUINT32 aad_len, const BUINT8 *encrypted_ptr, BUINT32 encrypted_len)
+{
+    EVP_CIPHER_CTX *ctx_ptr;
+    int openssl_len;
+    BOAT_RESULT result = BOAT_ERROR;
+
+    ctx_ptr = EVP_CIPHER_CTX_new();
+    if( ctx_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    if(    EVP_DecryptInit_ex(ctx_ptr, EVP_aes_256_gcm(), NULL, g_aes_key, iv_ptr) == 1
+        && EVP_DecryptUpdate(ctx_ptr, NULL, &openssl_len, aad_ptr, aad_len) == 1
+        && EVP_DecryptUpdate(ctx_ptr, plain_ptr, &openssl_len, encrypted_ptr, encrypted_len) == 1
+        && EVP_CIPHER_CTX_ctrl(ctx_ptr, EVP_CTRL_GCM_SET_TAG, BOAT_STORAGE_TAG_SIZE, (void *)tag_ptr) == 1
+        && EVP_DecryptFinal_ex(ctx_ptr, plain_ptr + openssl_len, &openssl_len) == 1 )
+    {
+        result = BOAT_SUCCESS;
+    }
+
+    EVP_CIPHER_CTX_free(ctx_ptr);
+
+    return result;
+}
+#endif  // BOAT_USE_OPENSSL != 0
+
+
+/******************************************************************************
+@brief Encrypt data into the storage format
+
+Function: PersistSeal()
+
+    This function encrypts the data into a heap buffer in the format described
+    in BoatPersistStore(). The caller must free <*sealed_ptr_ptr> with BoatFree().
+
+    The data is sealed in AES-GCM format if BOAT_PERSIST_USE_AEAD is set and
+    OpenSSL is available. Otherwise it's sealed in the hash-checked format.
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistSeal(const void *data_ptr, BUINT32 data_len, BUINT8 **sealed_ptr_ptr, BUINT32 *sealed_len_ptr)
+{
+    BUINT8 *sealed_ptr;
+    BUINT32 sealed_len;
+    BOAT_RESULT result;
+
+#if BOAT_STORAGE_SEAL_AEAD != 0
+    // | 4 byte magic | 12 byte nonce | AES-GCM(data) | 16 byte tag |
+    sealed_len = BOAT_STORAGE_AEAD_HEADER_SIZE + data_len + BOAT_STORAGE_TAG_SIZE;
+    sealed_ptr = BoatMalloc(sealed_len);
+    if( sealed_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    memcpy(sealed_ptr, BOAT_STORAGE_AEAD_MAGIC, BOAT_STORAGE_AEAD_MAGIC_SIZE);
+    random_stream(sealed_ptr + BOAT_STORAGE_AEAD_MAGIC_SIZE, BOAT_STORAGE_NONCE_SIZE);
+
+    // The header (magic and nonce) is authenticated as additional data
+    result = KeystoreAeadEncrypt(sealed_ptr + BOAT_STORAGE_AEAD_HEADER_SIZE,
+                                 sealed_ptr + BOAT_STORAGE_AEAD_HEADER_SIZE + data_len,
+                                 sealed_ptr + BOAT_STORAGE_AEAD_MAGIC_SIZE,
+                                 sealed_ptr, BOAT_STORAGE_AEAD_HEADER_SIZE,
+                                 data_ptr, data_len);
+#else
+    // | 16 byte salt | 32 byte hash | AES(data) | 1~31 byte AES paddiing |
+    BUINT32 encrypted_len = data_len + 31; // 31 for AES padding
+
+    sealed_ptr = BoatMalloc(BOAT_STORAGE_SALT_SIZE + 32 + encrypted_len);
+    if( sealed_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    // Generate 16-byte salt as AES initial vector
+    random_stream(sealed_ptr, BOAT_STORAGE_SALT_SIZE);
+
+    // Calculate data hash
+    keccak_256(data_ptr, data_len, sealed_ptr + BOAT_STORAGE_SALT_SIZE);
+
+    // Encrypt the data
+    result = KeystoreEncrypt(sealed_ptr + BOAT_STORAGE_SALT_SIZE + 32, &encrypted_len, sealed_ptr, data_ptr, data_len);
+    sealed_len = BOAT_STORAGE_SALT_SIZE + 32 + encrypted_len;
+#endif
+
+    if( result != BOAT_SUCCESS )
+    {
+        BoatFree(sealed_ptr);
+        return result;
+    }
+
+    *sealed_ptr_ptr = sealed_ptr;
+    *sealed_len_ptr = sealed_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Decrypt and verify data in the hash-checked storage format
+
+Function: PersistUnsealHashed()
+
+    This function decrypts data in the | salt | hash | AES-CBC(data) | format,
+    which is written by earlier versions, and checks its hash.
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistUnsealHashed(const BUINT8 *sealed_ptr, BUINT32 sealed_len, BOAT_OUT void *data_ptr, BUINT32 len_to_read)
+{
+    BUINT8 data_hash_array[32];
+    BUINT8 *plain_ptr;
+    BUINT32 plain_len = len_to_read;
+    BOAT_RESULT result;
+
+    if( sealed_len < BOAT_STORAGE_SALT_SIZE + sizeof(data_hash_array) + len_to_read )
+    {
+        return BOAT_ERROR;
+    }
+
+    plain_ptr = BoatMalloc(len_to_read);
+    if( plain_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    result = KeystoreDecrypt(plain_ptr, &plain_len, sealed_ptr,
+                             sealed_ptr + BOAT_STORAGE_SALT_SIZE + sizeof(data_hash_array),
+                             BOAT_MIN(len_to_read + 31, sealed_len - BOAT_STORAGE_SALT_SIZE - sizeof(data_hash_array)));
+
+    // Check size of the decrypted data matches the length to read
+    if( result == BOAT_SUCCESS && plain_len == len_to_read )
+    {
+        // Check if decrypted hash is the same as the original one
+        keccak_256(plain_ptr, len_to_read, data_hash_array);
+        if( 0 == memcmp(sealed_ptr + BOAT_STORAGE_SALT_SIZE, data_hash_array, sizeof(data_hash_array)) )
+        {
+            memcpy(data_ptr, plain_ptr, len_to_read);
+        }
+        else
+        {
+            result = BOAT_ERROR;
+        }
+    }
+    else
+    {
+        result = BOAT_ERROR;
+    }
+
+    memset(plain_ptr, 0x00, len_to_read);
+    BoatFree(plain_ptr);
+
+    return result;
+}
+
+
+/******************************************************************************
+@brief Decrypt and verify data in the storage format
+
+Function: PersistUnseal()
+
+    This function decrypts data encrypted by PersistSeal() or by an earlier
+    version.
+
+    The two formats are told apart by length: an AES-GCM record is exactly
+    32 bytes longer than the data, while a hash-checked record is at least 49
+    bytes longer. The magic is checked as well.
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistUnseal(const BUINT8 *sealed_ptr, BUINT32 sealed_len, BOAT_OUT void *data_ptr, BUINT32 len_to_read)
+{
+#if BOAT_USE_OPENSSL != 0
+    BUINT8 *plain_ptr;
+    BOAT_RESULT result;
+#endif
+
+    if(    sealed_len != BOAT_STORAGE_AEAD_HEADER_SIZE + len_to_read + BOAT_STORAGE_TAG_SIZE
+        || memcmp(sealed_ptr, BOAT_STORAGE_AEAD_MAGIC, BOAT_STORAGE_AEAD_MAGIC_SIZE) != 0 )
+    {
+        return PersistUnsealHashed(sealed_ptr, sealed_len, data_ptr, len_to_read);
+    }
+
+#if BOAT_USE_OPENSSL != 0
+    // Decrypt into a temporary buffer so that <data_ptr> is untouched on failure
+    plain_ptr = BoatMalloc(len_to_read);
+    if( plain_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    result = KeystoreAeadDecrypt(plain_ptr,
+                                 sealed_ptr + BOAT_STORAGE_AEAD_HEADER_SIZE + len_to_read,
+                                 sealed_ptr + BOAT_STORAGE_AEAD_MAGIC_SIZE,
+                                 sealed_ptr, BOAT_STORAGE_AEAD_HEADER_SIZE,
+                                 sealed_ptr + BOAT_STORAGE_AEAD_HEADER_SIZE, len_to_read);
+    if( result == BOAT_SUCCESS )
+    {
+        memcpy(data_ptr, plain_ptr, len_to_read);
+    }
+
+    memset(plain_ptr, 0x00, len_to_read);
+    BoatFree(plain_ptr);
+
+    return result;
+#else
+    BoatLog(BOAT_LOG_NORMAL, "AES-GCM storage requires OpenSSL.");
+
+    return BOAT_ERROR;
+#endif
+}
+
+
+/******************************************************************************
+@brief Load a storage file written as a separate file
+
+Function: PersistFileLoad()
+
+    This function reads up to <max_len> bytes of a storage file into a heap
+    buffer. The caller must free <*sealed_ptr_ptr> with BoatFree().
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistFileLoad(const BCHAR *storage_name_str, BUINT32 max_len, BUINT8 **sealed_ptr_ptr, BUINT32 *sealed_len_ptr)
+{
+    FILE *file_ptr;
+    long file_size;
+    BUINT8 *sealed_ptr;
+    BUINT32 sealed_len;
+
+    file_ptr = fopen(storage_name_str, "rb");
+    if( file_ptr == NULL )
+    {
+        return BOAT_ERROR;
+    }
+
+    fseek(file_ptr, 0, SEEK_END);
+    file_size = ftell(file_ptr);
+    rewind(file_ptr);
+
+    sealed_len = (file_size > 0) ? BOAT_MIN((BUINT32)file_size, max_len) : 0;
+    sealed_ptr = BoatMalloc(sealed_len + 1);
+    if( sealed_ptr == NULL )
+    {
+        fclose(file_ptr);
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    sealed_len = fread(sealed_ptr, 1, sealed_len, file_ptr);
+    fclose(file_ptr);
+
+    *sealed_ptr_ptr = sealed_ptr;
+    *sealed_len_ptr = sealed_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+__BOATSTATIC BoatKeystore *g_persist_keystore_ptr = NULL;
+__BOATSTATIC pthread_mutex_t g_persist_keystore_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/******************************************************************************
+@brief Lock the keystore holding all persistent storages
+
+Function: PersistKeystoreLock()
+
+    The keystore is opened on first use and stays open. It's shared by all
+    threads, so it's locked until PersistKeystoreUnlock() is called, even if
+    NULL is returned. Records got from the keystore are only valid while it's
+    locked.
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BoatKeystore *PersistKeystoreLock(void)
+{
+    pthread_mutex_lock(&g_persist_keystore_lock);
+
+    if( g_persist_keystore_ptr == NULL )
+    {
+        g_persist_keystore_ptr = BoatKeystoreOpen(BOAT_KEYSTORE_FILE_NAME);
+    }
+
+    return g_persist_keystore_ptr;
+}
+
+
+__BOATSTATIC void PersistKeystoreUnlock(void)
+{
+    pthread_mutex_unlock(&g_persist_keystore_lock);
+}
+#endif
+
+
 /*!*****************************************************************************
 @brief Persitently store data in an encrypted file
 
 Function: BoatPersistStore()
 
-    This function persistently stores data in an encrypted file with hash check.
+    This function persistently stores data in an authenticated encrypted file.
 
     NOTE:
     This is a default implementation for persistent storage with AES-256
@@ -350,11 +803,27 @@ Function: BoatPersistStore()
     re-implement this function according to the system configuration.
 
 
-    This function encrypts the data and saves them into the specified file in
-    following format.
+    This function encrypts the data and saves them into the specified file.
+
+    By default (BOAT_PERSIST_USE_AEAD), the data is encrypted and authenticated
+    in a single pass with AES-256 GCM, in following format.
+
+    @verbatim
+    AES-GCM file format:\n
+     --------------------------------------------------------------------------
+     | 4 byte magic "BGCM" | 12 byte nonce | AES-GCM(plain_data) | 16 byte tag |
+     --------------------------------------------------------------------------
+    @endverbatim
+
+    The nonce is random. The tag authenticates the magic, the nonce and the
+    encrypted data, which is the same size as the plain data. Any corruption
+    of them, or a wrong AES key, fails the tag check in BoatPersistRead().
+
+    Without OpenSSL or BOAT_PERSIST_USE_AEAD, and in files written by earlier
+    versions, the data is hash-checked in following format. BoatPersistRead() accepts both formats.
     
     @verbatim
-    File format:\n
+    Hash-checked file format:\n
      --------------------------------------------------------------------------
      | 16 byte salt | 32 byte hash | AES(plain_data) | 0~31 byte AES paddiing |
      --------------------------------------------------------------------------
@@ -429,7 +898,16 @@ Function: BoatPersistStore()
     Thus the total padding size varies between 1~31 bytes. The output buffer
     must have enough room to hold the encrypted data.
 
-    
+
+    [KEYSTORE]
+
+    If BOAT_PERSIST_USE_KEYSTORE is 1, the encrypted data in above format is
+    not saved as a separate file. Instead it's put as a record named
+    <storage_name_str> into the keystore file BOAT_KEYSTORE_FILE_NAME, which
+    holds all persistent storages with an index (see keystore.h). Each record
+    is encrypted separately with its own salt.
+
+
 
 @see BoatPersistRead()
 
@@ -454,13 +932,14 @@ BOAT_RESULT BoatPersistStore(const BCHAR *storage_name_str, const void *data_ptr
     // Storage format: | 16 byte salt | 32 byte hash | AES(data) | 1~31 byte AES paddiing |
     // Where, hash = keccak256(data)
 
-    BUINT8 salt_array[BOAT_STORAGE_SALT_SIZE];
-    BUINT8 data_hash_array[32];
-    BUINT8 encrypted_array[data_len + 31]; // 31 for AES padding
-    BUINT32 encrypted_len = sizeof(encrypted_array);
-    
+    BUINT8 *sealed_ptr = NULL;
+    BUINT32 sealed_len = 0;
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    BoatKeystore *keystore_ptr;
+#else
     FILE *file_ptr;
-    BSINT32 count = 0;
+#endif
 
     BOAT_RESULT result;
 
@@ -474,34 +953,34 @@ BOAT_RESULT BoatPersistStore(const BCHAR *storage_name_str, const void *data_ptr
         return BOAT_SUCCESS;
     }
 
-    // Calculate data hash
-    keccak_256(data_ptr, data_len, data_hash_array);
-
-    
-    // Generate 16-byte salt as AES initial vector
-    random_stream(salt_array, BOAT_STORAGE_SALT_SIZE);
-
-    // Encrypt the data
-    result = KeystoreEncrypt(encrypted_array, &encrypted_len, salt_array, data_ptr, data_len);
+    result = PersistSeal(data_ptr, data_len, &sealed_ptr, &sealed_len);
 
     if( result == BOAT_SUCCESS )
     {
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+        keystore_ptr = PersistKeystoreLock();
+        result = (keystore_ptr != NULL) ? BoatKeystorePut(keystore_ptr, storage_name_str, sealed_ptr, sealed_len) : BOAT_ERROR;
+        PersistKeystoreUnlock();
+#else
         file_ptr = fopen(storage_name_str, "wb");
 
         if( file_ptr != NULL )
         {
-            // Store 16-byte salt
-            count += fwrite(salt_array, 1, sizeof(salt_array), file_ptr);
-
-            // Store 32-byte hash
-            count += fwrite(data_hash_array, 1, sizeof(data_hash_array), file_ptr);
-            
-            // Store AES(data) | 0~15 byte AES paddiing
-            count += fwrite(encrypted_array, 1, encrypted_len, file_ptr);
+            // Store | 16-byte salt | 32-byte hash | AES(data) | 1~31 byte AES paddiing |
+            if( fwrite(sealed_ptr, 1, sealed_len, file_ptr) != sealed_len )
+            {
+                result = BOAT_ERROR;
+            }
 
             fclose(file_ptr);
         }
+        else
+        {
+            result = BOAT_ERROR;
+        }
+#endif
 
+        BoatFree(sealed_ptr);
     }
 
     return result;
@@ -547,22 +1026,18 @@ Function: BoatPersistRead()
 *******************************************************************************/
 BOAT_RESULT BoatPersistRead(const BCHAR *storage_name_str, BOAT_OUT void *data_ptr, BUINT32 len_to_read)
 {
-    FILE *file_ptr;
-    BSINT32 file_size;
-    BSINT32 count = 0;
-
     // Storage format: | 16 byte salt | 32 byte hash | AES(data) | 1~31 byte AES paddiing |
     // Where, hash = keccak256(data)
 
-    BUINT8 salt_array[BOAT_STORAGE_SALT_SIZE];
-    BUINT8 original_data_hash_array[32];
-    BUINT8 data_hash_array[32];
-    BUINT8 encrypted_array[len_to_read + 31]; // 31 for AES padding
+    BUINT8 *sealed_ptr = NULL;
+    BUINT32 sealed_len = 0;
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    BoatKeystore *keystore_ptr;
+    const BUINT8 *record_ptr;
+    BUINT32 record_len;
+#endif
 
-    // Plain buffer
-    BUINT8 plain_array[len_to_read];
-    BUINT32 plain_len = sizeof(plain_array);
-    
     BOAT_RESULT result = BOAT_ERROR;
 
     if( storage_name_str == NULL || (data_ptr == NULL && len_to_read != 0 ) )
@@ -575,51 +1050,47 @@ BOAT_RESULT BoatPersistRead(const BCHAR *storage_name_str, BOAT_OUT void *data_p
         return BOAT_SUCCESS;
     }
 
-    file_ptr = fopen(storage_name_str, "rb");
-
-    if( file_ptr != NULL )
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    // The keystore stays locked until the storage is read, either from the
+    // keystore or imported into it
+    keystore_ptr = PersistKeystoreLock();
+    if( keystore_ptr == NULL )
     {
-        fseek(file_ptr, 0, SEEK_END);
-        file_size = ftell(file_ptr);
-        rewind(file_ptr);
+        PersistKeystoreUnlock();
+        return BOAT_ERROR;
+    }
 
-        if( file_size >= BOAT_STORAGE_SALT_SIZE + sizeof(data_hash_array) + len_to_read )
-        {
-            // Read salt
-            count = fread(salt_array, 1, BOAT_STORAGE_SALT_SIZE, file_ptr);
+    if( BoatKeystoreGet(keystore_ptr, storage_name_str, &record_ptr, &record_len) == BOAT_SUCCESS )
+    {
+        result = PersistUnseal(record_ptr, record_len, data_ptr, len_to_read);
+        PersistKeystoreUnlock();
+        return result;
+    }
+#endif
 
-            // Read original data hash
-            count = fread(original_data_hash_array, 1, sizeof(original_data_hash_array), file_ptr);
+    // Read the storage as a separate file. With keystore, this is the storage
+    // written by an earlier version and it's imported into the keystore.
+    result = PersistFileLoad(storage_name_str, BOAT_STORAGE_SALT_SIZE + 32 + len_to_read + 31, &sealed_ptr, &sealed_len);
 
-            // Read rest of the file (encrypted data)
-            count = fread(encrypted_array, 1, BOAT_MIN(sizeof(encrypted_array), file_size - BOAT_STORAGE_SALT_SIZE - sizeof(original_data_hash_array)), file_ptr);
-            result = KeystoreDecrypt(plain_array, &plain_len, salt_array, encrypted_array, count);
+    if( result == BOAT_SUCCESS )
+    {
+        result = PersistUnseal(sealed_ptr, sealed_len, data_ptr, len_to_read);
 
-            // Check size of the decrypted data matches the length to read
-            if( result == BOAT_SUCCESS && plain_len == len_to_read)
-            {
-                // Calculate data hash from the decrypted data
-                keccak_256(plain_array, len_to_read, data_hash_array);
-                
-                // Check if decrypted hash is the same as the original one
-                if( 0 == memcmp(original_data_hash_array, data_hash_array, sizeof(data_hash_array)) )
-                {
-                    memcpy(data_ptr, plain_array, len_to_read);
-                    result = BOAT_SUCCESS;
-                }
-                else
-                {
-                    result = BOAT_ERROR;
-                }
-            }
-            else
-            {
-                result = BOAT_ERROR;
-            }
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+        if(    result == BOAT_SUCCESS
+            && BoatKeystorePut(keystore_ptr, storage_name_str, sealed_ptr, sealed_len) != BOAT_SUCCESS )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Fail to import %s into keystore.", storage_name_str);
         }
-        fclose(file_ptr);
+#endif
+
+        BoatFree(sealed_ptr);
     }
 
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    PersistKeystoreUnlock();
+#endif
+
     return result;
 }
 
@@ -642,13 +1113,681 @@ Function: BoatPersistDelete()
 *******************************************************************************/
 BOAT_RESULT BoatPersistDelete(const BCHAR * storage_name_str)
 {
-    // Delete file
-    if( 0 != remove(storage_name_str) )
+    BOAT_RESULT result = BOAT_ERROR;
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    BoatKeystore *keystore_ptr;
+#endif
+
+    if( storage_name_str == NULL )
     {
         return BOAT_ERROR;
     }
-    else
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    keystore_ptr = PersistKeystoreLock();
+    if( keystore_ptr != NULL )
     {
-        return BOAT_SUCCESS;
+        result = BoatKeystoreRemove(keystore_ptr, storage_name_str);
+    }
+    PersistKeystoreUnlock();
+#endif
+
+    // Delete file, which is the storage written by an earlier version with keystore
+    if( 0 == remove(storage_name_str) )
+    {
+        result = BOAT_SUCCESS;
+    }
+
+    return result;
+}
+
+
+#if BOAT_USE_OPENSSL != 0
+
+/*
+ Stream format:
+
+ ---------------------------------------------------------------------------------------
+ | 4 byte magic "BGCS" | 8 byte nonce prefix | 4 byte chunk size | chunk 0 | chunk 1 | ...
+ ---------------------------------------------------------------------------------------
+
+ Every chunk is | AES-GCM(chunk data) | 16 byte tag |. All chunks but the last one carry
+ exactly <chunk size> bytes of data. The last chunk carries 0 ~ <chunk size> - 1 bytes.
+
+ The nonce of chunk i is | nonce prefix | i (4 byte bigendian) |. The additional data is
+ | 16 byte stream header | final flag (1 byte) |, where the final flag is 1 for the last
+ chunk only. Thus reordering, dropping or truncating chunks fails the tag check.
+*/
+#define BOAT_STREAM_MAGIC "BGCS"
+#define BOAT_STREAM_HEADER_SIZE 16
+#define BOAT_STREAM_NONCE_PREFIX_SIZE 8
+
+struct TBoatPersistWriter
+{
+    int fd;
+    BCHAR *file_name_str;
+    BCHAR *tmp_name_str;        //!< The stream is written here and renamed at BoatPersistWriterFinal()
+    EVP_CIPHER_CTX *ctx_ptr;    //!< Keyed once, only the nonce is reset for each chunk
+    BUINT8 header_array[BOAT_STREAM_HEADER_SIZE + 1];
+    BUINT32 chunk_index;
+    BUINT32 plain_len;          //!< Bytes buffered in <plain_ptr>
+    BUINT8 *plain_ptr;          //!< BOAT_PERSIST_STREAM_CHUNK_SIZE bytes
+    BUINT8 *cipher_ptr;         //!< BOAT_PERSIST_STREAM_CHUNK_SIZE + 16 bytes
+};
+
+struct TBoatPersistReader
+{
+    int fd;
+    EVP_CIPHER_CTX *ctx_ptr;
+    BUINT8 header_array[BOAT_STREAM_HEADER_SIZE + 1];
+    BUINT32 chunk_size;
+    BUINT32 chunk_index;
+    BBOOL is_final;             //!< The last chunk is decrypted
+    BUINT32 plain_offset;       //!< Bytes of <plain_ptr> returned to the caller
+    BUINT32 plain_len;          //!< Bytes decrypted in <plain_ptr>
+    BUINT8 *plain_ptr;
+    BUINT8 *cipher_ptr;
+};
+
+
+__BOATSTATIC BOAT_RESULT PersistFdWrite(int fd, const BUINT8 *data_ptr, size_t data_len)
+{
+    ssize_t written;
+
+    while( data_len > 0 )
+    {
+        written = write(fd, data_ptr, data_len);
+        if( written < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return BOAT_ERROR;
+        }
+        data_ptr += written;
+        data_len -= written;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+// Returns the number of bytes read, which is less than <data_len> only at end of file
+__BOATSTATIC ssize_t PersistFdRead(int fd, BUINT8 *data_ptr, size_t data_len)
+{
+    size_t total_len = 0;
+    ssize_t count;
+
+    while( total_len < data_len )
+    {
+        count = read(fd, data_ptr + total_len, data_len - total_len);
+        if( count < 0 )
+        {
+            if( errno == EINTR )
+            {
+                continue;
+            }
+            return -1;
+        }
+        if( count == 0 )
+        {
+            break;
+        }
+        total_len += count;
+    }
+
+    return total_len;
+}
+
+
+__BOATSTATIC void PersistPutBigend32(BUINT8 *ptr, BUINT32 value)
+{
+    ptr[0] = (BUINT8)(value >> 24);
+    ptr[1] = (BUINT8)(value >> 16);
+    ptr[2] = (BUINT8)(value >> 8);
+    ptr[3] = (BUINT8)value;
+}
+
+
+// Nonce of a chunk: | 8 byte nonce prefix | 4 byte bigendian chunk index |
+__BOATSTATIC void PersistStreamNonce(BUINT8 nonce[BOAT_STORAGE_NONCE_SIZE], const BUINT8 *header_ptr, BUINT32 chunk_index)
+{
+    memcpy(nonce, header_ptr + BOAT_STORAGE_AEAD_MAGIC_SIZE, BOAT_STREAM_NONCE_PREFIX_SIZE);
+    PersistPutBigend32(nonce + BOAT_STREAM_NONCE_PREFIX_SIZE, chunk_index);
+}
+
+
+/******************************************************************************
+@brief Encrypt and write the buffered chunk
+
+Function: PersistWriterFlush()
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistWriterFlush(BoatPersistWriter *writer_ptr, BBOOL is_final)
+{
+    BUINT8 nonce[BOAT_STORAGE_NONCE_SIZE];
+    int openssl_len;
+
+    if( writer_ptr->chunk_index == 0xFFFFFFFFu )
+    {
+        // Nonce space exhausted
+        return BOAT_ERROR;
+    }
+
+    PersistStreamNonce(nonce, writer_ptr->header_array, writer_ptr->chunk_index);
+    writer_ptr->header_array[BOAT_STREAM_HEADER_SIZE] = is_final ? 1 : 0;
+
+    if(    EVP_EncryptInit_ex(writer_ptr->ctx_ptr, NULL, NULL, NULL, nonce) != 1
+        || EVP_EncryptUpdate(writer_ptr->ctx_ptr, NULL, &openssl_len,
+                             writer_ptr->header_array, sizeof(writer_ptr->header_array)) != 1
+        || EVP_EncryptUpdate(writer_ptr->ctx_ptr, writer_ptr->cipher_ptr, &openssl_len,
+                             writer_ptr->plain_ptr, writer_ptr->plain_len) != 1
+        || EVP_EncryptFinal_ex(writer_ptr->ctx_ptr, writer_ptr->cipher_ptr + openssl_len, &openssl_len) != 1
+        || EVP_CIPHER_CTX_ctrl(writer_ptr->ctx_ptr, EVP_CTRL_GCM_GET_TAG, BOAT_STORAGE_TAG_SIZE,
+                               writer_ptr->cipher_ptr + writer_ptr->plain_len) != 1 )
+    {
+        return BOAT_ERROR;
     }
+
+    if( PersistFdWrite(writer_ptr->fd, writer_ptr->cipher_ptr, writer_ptr->plain_len + BOAT_STORAGE_TAG_SIZE) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to write %s.", writer_ptr->tmp_name_str);
+        return BOAT_ERROR;
+    }
+
+    writer_ptr->chunk_index++;
+    writer_ptr->plain_len = 0;
+
+    return BOAT_SUCCESS;
 }
+
+
+/*!*****************************************************************************
+@brief Abort a streaming persistent storage writer
+
+Function: BoatPersistWriterAbort()
+
+    This function discards everything written so far and frees the writer.
+    The existing storage with the same name, if any, is unchanged.
+
+@return This function doesn't return any thing.
+
+@param[in] writer_ptr
+    The writer returned by BoatPersistWriterInit(). It may be NULL.
+
+*******************************************************************************/
+void BoatPersistWriterAbort(BoatPersistWriter *writer_ptr)
+{
+    if( writer_ptr == NULL )
+    {
+        return;
+    }
+
+    if( writer_ptr->fd >= 0 )
+    {
+        close(writer_ptr->fd);
+        unlink(writer_ptr->tmp_name_str);
+    }
+    if( writer_ptr->ctx_ptr != NULL )
+    {
+        EVP_CIPHER_CTX_free(writer_ptr->ctx_ptr);
+    }
+    if( writer_ptr->plain_ptr != NULL )
+    {
+        memset(writer_ptr->plain_ptr, 0x00, BOAT_PERSIST_STREAM_CHUNK_SIZE);
+    }
+
+    BoatFree(writer_ptr->plain_ptr);
+    BoatFree(writer_ptr->cipher_ptr);
+    BoatFree(writer_ptr->file_name_str);
+    BoatFree(writer_ptr->tmp_name_str);
+    BoatFree(writer_ptr);
+}
+
+
+/*!*****************************************************************************
+@brief Start writing a persistent storage as a stream
+
+Function: BoatPersistWriterInit()
+
+    This function starts writing an encrypted storage of any size with bounded
+    memory. Data passed to BoatPersistWriterUpdate() is buffered, encrypted
+    and written in chunks of BOAT_PERSIST_STREAM_CHUNK_SIZE bytes, each one
+    authenticated with AES-256 GCM. One cipher context is kept for the whole
+    stream.
+
+    The stream is written to <storage_name_str>.tmp and renamed to
+    <storage_name_str> by BoatPersistWriterFinal(). Stream storages are always
+    separate files, also if BOAT_PERSIST_USE_KEYSTORE is set. They're read by
+    BoatPersistReaderInit() and deleted by BoatPersistDelete().
+
+@see BoatPersistWriterUpdate() BoatPersistWriterFinal() BoatPersistReaderInit()
+
+@return
+    This function returns the writer if successful.\n
+    Otherwise it returns NULL.
+
+@param[in] storage_name_str
+    The file name to store the data.
+
+*******************************************************************************/
+BoatPersistWriter *BoatPersistWriterInit(const BCHAR *storage_name_str)
+{
+    BoatPersistWriter *writer_ptr;
+    size_t name_len;
+
+    if( storage_name_str == NULL )
+    {
+        return NULL;
+    }
+
+    writer_ptr = BoatMalloc(sizeof(BoatPersistWriter));
+    if( writer_ptr == NULL )
+    {
+        return NULL;
+    }
+    memset(writer_ptr, 0x00, sizeof(BoatPersistWriter));
+    writer_ptr->fd = -1;
+
+    name_len = strlen(storage_name_str);
+    writer_ptr->file_name_str = BoatMalloc(name_len + 1);
+    writer_ptr->tmp_name_str = BoatMalloc(name_len + sizeof(".tmp"));
+    writer_ptr->plain_ptr = BoatMalloc(BOAT_PERSIST_STREAM_CHUNK_SIZE);
+    writer_ptr->cipher_ptr = BoatMalloc(BOAT_PERSIST_STREAM_CHUNK_SIZE + BOAT_STORAGE_TAG_SIZE);
+    writer_ptr->ctx_ptr = EVP_CIPHER_CTX_new();
+
+    if(    writer_ptr->file_name_str == NULL
+        || writer_ptr->tmp_name_str == NULL
+        || writer_ptr->plain_ptr == NULL
+        || writer_ptr->cipher_ptr == NULL
+        || writer_ptr->ctx_ptr == NULL )
+    {
+        BoatPersistWriterAbort(writer_ptr);
+        return NULL;
+    }
+
+    memcpy(writer_ptr->file_name_str, storage_name_str, name_len + 1);
+    memcpy(writer_ptr->tmp_name_str, storage_name_str, name_len);
+    memcpy(writer_ptr->tmp_name_str + name_len, ".tmp", sizeof(".tmp"));
+
+    // Stream header: | magic | nonce prefix | chunk size |
+    memcpy(writer_ptr->header_array, BOAT_STREAM_MAGIC, BOAT_STORAGE_AEAD_MAGIC_SIZE);
+    random_stream(writer_ptr->header_array + BOAT_STORAGE_AEAD_MAGIC_SIZE, BOAT_STREAM_NONCE_PREFIX_SIZE);
+    PersistPutBigend32(writer_ptr->header_array + BOAT_STORAGE_AEAD_MAGIC_SIZE + BOAT_STREAM_NONCE_PREFIX_SIZE,
+                       BOAT_PERSIST_STREAM_CHUNK_SIZE);
+
+    // Set up cipher and key once. Each chunk only sets its nonce.
+    if( EVP_EncryptInit_ex(writer_ptr->ctx_ptr, EVP_aes_256_gcm(), NULL, g_aes_key, NULL) != 1 )
+    {
+        BoatPersistWriterAbort(writer_ptr);
+        return NULL;
+    }
+
+    writer_ptr->fd = open(writer_ptr->tmp_name_str, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if(    writer_ptr->fd < 0
+        || PersistFdWrite(writer_ptr->fd, writer_ptr->header_array, BOAT_STREAM_HEADER_SIZE) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to create %s.", writer_ptr->tmp_name_str);
+        BoatPersistWriterAbort(writer_ptr);
+        return NULL;
+    }
+
+    return writer_ptr;
+}
+
+
+/*!*****************************************************************************
+@brief Write data to a persistent storage stream
+
+Function: BoatPersistWriterUpdate()
+
+    This function appends data to the stream. Full chunks are encrypted and
+    written immediately, the rest is buffered.
+
+    If it fails, call BoatPersistWriterAbort().
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] writer_ptr
+    The writer returned by BoatPersistWriterInit().
+
+@param[in] data_ptr
+    Data to append.
+
+@param[in] data_len
+    Length (in byte) of <data_ptr>.
+
+*******************************************************************************/
+BOAT_RESULT BoatPersistWriterUpdate(BoatPersistWriter *writer_ptr, const void *data_ptr, BUINT32 data_len)
+{
+    const BUINT8 *ptr = data_ptr;
+    BUINT32 copy_len;
+
+    if( writer_ptr == NULL || (data_ptr == NULL && data_len != 0) )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    while( data_len > 0 )
+    {
+        // A full buffer is flushed only when more data follows, because the
+        // last chunk must be shorter than a full one
+        if( writer_ptr->plain_len == BOAT_PERSIST_STREAM_CHUNK_SIZE )
+        {
+            if( PersistWriterFlush(writer_ptr, BOAT_FALSE) != BOAT_SUCCESS )
+            {
+                return BOAT_ERROR;
+            }
+        }
+
+        copy_len = BOAT_MIN(data_len, BOAT_PERSIST_STREAM_CHUNK_SIZE - writer_ptr->plain_len);
+        memcpy(writer_ptr->plain_ptr + writer_ptr->plain_len, ptr, copy_len);
+        writer_ptr->plain_len += copy_len;
+        ptr += copy_len;
+        data_len -= copy_len;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Finish writing a persistent storage stream
+
+Function: BoatPersistWriterFinal()
+
+    This function writes the last chunk, syncs the file and renames it to the
+    storage name, replacing any existing storage atomically. The writer is
+    freed whether it succeeds or not.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] writer_ptr
+    The writer returned by BoatPersistWriterInit().
+
+*******************************************************************************/
+BOAT_RESULT BoatPersistWriterFinal(BoatPersistWriter *writer_ptr)
+{
+    BOAT_RESULT result = BOAT_ERROR;
+
+    if( writer_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The last chunk must be shorter than a full chunk
+    if(    (    writer_ptr->plain_len < BOAT_PERSIST_STREAM_CHUNK_SIZE
+             || PersistWriterFlush(writer_ptr, BOAT_FALSE) == BOAT_SUCCESS )
+        && PersistWriterFlush(writer_ptr, BOAT_TRUE) == BOAT_SUCCESS
+        && fsync(writer_ptr->fd) == 0
+        && close(writer_ptr->fd) == 0 )
+    {
+        writer_ptr->fd = -1;
+
+        if( rename(writer_ptr->tmp_name_str, writer_ptr->file_name_str) == 0 )
+        {
+            result = BOAT_SUCCESS;
+        }
+        else
+        {
+            unlink(writer_ptr->tmp_name_str);
+        }
+    }
+
+    BoatPersistWriterAbort(writer_ptr);
+
+    return result;
+}
+
+
+/*!*****************************************************************************
+@brief Finish reading a persistent storage stream
+
+Function: BoatPersistReaderFinal()
+
+    This function frees the reader.
+
+@return
+    This function returns BOAT_SUCCESS if the whole stream was read and
+    authenticated.\n
+    Otherwise it returns BOAT_ERROR, e.g. if the caller stops before the end.
+
+@param[in] reader_ptr
+    The reader returned by BoatPersistReaderInit(). It may be NULL.
+
+*******************************************************************************/
+BOAT_RESULT BoatPersistReaderFinal(BoatPersistReader *reader_ptr)
+{
+    BOAT_RESULT result;
+
+    if( reader_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    result = (    reader_ptr->is_final == BOAT_TRUE
+               && reader_ptr->plain_offset == reader_ptr->plain_len ) ? BOAT_SUCCESS : BOAT_ERROR;
+
+    if( reader_ptr->fd >= 0 )
+    {
+        close(reader_ptr->fd);
+    }
+    if( reader_ptr->ctx_ptr != NULL )
+    {
+        EVP_CIPHER_CTX_free(reader_ptr->ctx_ptr);
+    }
+    if( reader_ptr->plain_ptr != NULL )
+    {
+        memset(reader_ptr->plain_ptr, 0x00, reader_ptr->chunk_size);
+    }
+
+    BoatFree(reader_ptr->plain_ptr);
+    BoatFree(reader_ptr->cipher_ptr);
+    BoatFree(reader_ptr);
+
+    return result;
+}
+
+
+/*!*****************************************************************************
+@brief Start reading a persistent storage stream
+
+Function: BoatPersistReaderInit()
+
+    This function opens a storage written by BoatPersistWriterInit() and its
+    siblings. Data is read, authenticated and decrypted chunk by chunk, thus
+    no data is returned before its chunk passes the tag check.
+
+@see BoatPersistReaderUpdate() BoatPersistReaderFinal() BoatPersistWriterInit()
+
+@return
+    This function returns the reader if successful.\n
+    Otherwise it returns NULL.
+
+@param[in] storage_name_str
+    The file name of the storage.
+
+*******************************************************************************/
+BoatPersistReader *BoatPersistReaderInit(const BCHAR *storage_name_str)
+{
+    BoatPersistReader *reader_ptr;
+    const BUINT8 *chunk_size_ptr;
+
+    if( storage_name_str == NULL )
+    {
+        return NULL;
+    }
+
+    reader_ptr = BoatMalloc(sizeof(BoatPersistReader));
+    if( reader_ptr == NULL )
+    {
+        return NULL;
+    }
+    memset(reader_ptr, 0x00, sizeof(BoatPersistReader));
+
+    reader_ptr->fd = open(storage_name_str, O_RDONLY);
+    if(    reader_ptr->fd < 0
+        || PersistFdRead(reader_ptr->fd, reader_ptr->header_array, BOAT_STREAM_HEADER_SIZE) != BOAT_STREAM_HEADER_SIZE
+        || memcmp(reader_ptr->header_array, BOAT_STREAM_MAGIC, BOAT_STORAGE_AEAD_MAGIC_SIZE) != 0 )
+    {
+        BoatPersistReaderFinal(reader_ptr);
+        return NULL;
+    }
+
+    // The chunk size is authenticated as part of the header, but limit it
+    // before allocating
+    chunk_size_ptr = reader_ptr->header_array + BOAT_STORAGE_AEAD_MAGIC_SIZE + BOAT_STREAM_NONCE_PREFIX_SIZE;
+    reader_ptr->chunk_size = ((BUINT32)chunk_size_ptr[0] << 24) | ((BUINT32)chunk_size_ptr[1] << 16)
+                           | ((BUINT32)chunk_size_ptr[2] << 8) | chunk_size_ptr[3];
+    if( reader_ptr->chunk_size == 0 || reader_ptr->chunk_size > BOAT_PERSIST_STREAM_MAX_CHUNK_SIZE )
+    {
+        BoatPersistReaderFinal(reader_ptr);
+        return NULL;
+    }
+
+    reader_ptr->plain_ptr = BoatMalloc(reader_ptr->chunk_size);
+    reader_ptr->cipher_ptr = BoatMalloc(reader_ptr->chunk_size + BOAT_STORAGE_TAG_SIZE);
+    reader_ptr->ctx_ptr = EVP_CIPHER_CTX_new();
+
+    if(    reader_ptr->plain_ptr == NULL
+        || reader_ptr->cipher_ptr == NULL
+        || reader_ptr->ctx_ptr == NULL
+        || EVP_DecryptInit_ex(reader_ptr->ctx_ptr, EVP_aes_256_gcm(), NULL, g_aes_key, NULL) != 1 )
+    {
+        BoatPersistReaderFinal(reader_ptr);
+        return NULL;
+    }
+
+    return reader_ptr;
+}
+
+
+/******************************************************************************
+@brief Read, authenticate and decrypt the next chunk
+
+Function: PersistReaderFill()
+
+    It's for internally use only.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT PersistReaderFill(BoatPersistReader *reader_ptr)
+{
+    BUINT8 nonce[BOAT_STORAGE_NONCE_SIZE];
+    BUINT8 extra_byte;
+    ssize_t count;
+    BUINT32 data_len;
+    int openssl_len;
+
+    count = PersistFdRead(reader_ptr->fd, reader_ptr->cipher_ptr, reader_ptr->chunk_size + BOAT_STORAGE_TAG_SIZE);
+    if( count < BOAT_STORAGE_TAG_SIZE )
+    {
+        // Truncated
+        return BOAT_ERROR;
+    }
+
+    // Only the last chunk is shorter than a full one, and nothing follows it
+    data_len = count - BOAT_STORAGE_TAG_SIZE;
+    reader_ptr->is_final = (data_len < reader_ptr->chunk_size);
+    if( reader_ptr->is_final == BOAT_TRUE && PersistFdRead(reader_ptr->fd, &extra_byte, 1) != 0 )
+    {
+        return BOAT_ERROR;
+    }
+
+    PersistStreamNonce(nonce, reader_ptr->header_array, reader_ptr->chunk_index);
+    reader_ptr->header_array[BOAT_STREAM_HEADER_SIZE] = reader_ptr->is_final ? 1 : 0;
+
+    if(    EVP_DecryptInit_ex(reader_ptr->ctx_ptr, NULL, NULL, NULL, nonce) != 1
+        || EVP_DecryptUpdate(reader_ptr->ctx_ptr, NULL, &openssl_len,
+                             reader_ptr->header_array, sizeof(reader_ptr->header_array)) != 1
+        || EVP_DecryptUpdate(reader_ptr->ctx_ptr, reader_ptr->plain_ptr, &openssl_len,
+                             reader_ptr->cipher_ptr, data_len) != 1
+        || EVP_CIPHER_CTX_ctrl(reader_ptr->ctx_ptr, EVP_CTRL_GCM_SET_TAG, BOAT_STORAGE_TAG_SIZE,
+                               reader_ptr->cipher_ptr + data_len) != 1
+        || EVP_DecryptFinal_ex(reader_ptr->ctx_ptr, reader_ptr->plain_ptr + openssl_len, &openssl_len) != 1 )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Chunk %u fails authentication.", reader_ptr->chunk_index);
+        reader_ptr->is_final = BOAT_FALSE;
+        return BOAT_ERROR;
+    }
+
+    reader_ptr->chunk_index++;
+    reader_ptr->plain_offset = 0;
+    reader_ptr->plain_len = data_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Read data from a persistent storage stream
+
+Function: BoatPersistReaderUpdate()
+
+    This function reads up to <buf_len> bytes of the decrypted storage. It
+    returns less than <buf_len> bytes only at the end of the storage.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR if the storage is truncated or corrupted. Data
+    returned by earlier calls is authentic, but the storage is incomplete.
+
+@param[in] reader_ptr
+    The reader returned by BoatPersistReaderInit().
+
+@param[out] data_ptr
+    Buffer to hold the decrypted data.
+
+@param[in] buf_len
+    Size (in byte) of <data_ptr>.
+
+@param[out] read_len_ptr
+    Number of bytes read. 0 means the end of the storage.
+
+*******************************************************************************/
+BOAT_RESULT BoatPersistReaderUpdate(BoatPersistReader *reader_ptr, BOAT_OUT void *data_ptr, BUINT32 buf_len, BOAT_OUT BUINT32 *read_len_ptr)
+{
+    BUINT8 *ptr = data_ptr;
+    BUINT32 copy_len;
+    BUINT32 total_len = 0;
+
+    if( reader_ptr == NULL || (data_ptr == NULL && buf_len != 0) || read_len_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    *read_len_ptr = 0;
+
+    while( total_len < buf_len )
+    {
+        if( reader_ptr->plain_offset == reader_ptr->plain_len )
+        {
+            if( reader_ptr->is_final == BOAT_TRUE )
+            {
+                break;
+            }
+            if( PersistReaderFill(reader_ptr) != BOAT_SUCCESS )
+            {
+                return BOAT_ERROR;
+            }
+            continue;
+        }
+
+        copy_len = BOAT_MIN(buf_len - total_len, reader_ptr->plain_len - reader_ptr->plain_offset);
+        memcpy(ptr + total_len, reader_ptr->plain_ptr + reader_ptr->plain_offset, copy_len);
+        reader_ptr->plain_offset += copy_len;
+        total_len += copy_len;
+        *read_len_ptr = total_len;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+#endif  // BOAT_USE_OPENSSL != 0
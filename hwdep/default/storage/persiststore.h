@@ -33,6 +33,21 @@ BOAT_RESULT BoatPersistStore(const BCHAR *storage_name_str, const void *data_ptr
 BOAT_RESULT BoatPersistRead(const BCHAR *storage_name_str, BOAT_OUT void *data_ptr, BUINT32 len_to_read);
 BOAT_RESULT BoatPersistDelete(const BCHAR * storage_name_str);
 
+#if BOAT_USE_OPENSSL != 0
+//!@brief Streaming writer and reader of a large persistent storage, see BoatPersistWriterInit()
+typedef struct TBoatPersistWriter BoatPersistWriter;
+typedef struct TBoatPersistReader BoatPersistReader;
+
+BoatPersistWriter *BoatPersistWriterInit(const BCHAR *storage_name_str);
+BOAT_RESULT BoatPersistWriterUpdate(BoatPersistWriter *writer_ptr, const void *data_ptr, BUINT32 data_len);
+BOAT_RESULT BoatPersistWriterFinal(BoatPersistWriter *writer_ptr);
+void BoatPersistWriterAbort(BoatPersistWriter *writer_ptr);
+
+BoatPersistReader *BoatPersistReaderInit(const BCHAR *storage_name_str);
+BOAT_RESULT BoatPersistReaderUpdate(BoatPersistReader *reader_ptr, BOAT_OUT void *data_ptr, BUINT32 buf_len, BOAT_OUT BUINT32 *read_len_ptr);
+BOAT_RESULT BoatPersistReaderFinal(BoatPersistReader *reader_ptr);
+#endif
+
 
 #ifdef __cplusplus
 }
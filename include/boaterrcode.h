@@ -37,6 +37,7 @@ boaterrcode.h defines error codes.
 #define BOAT_ERROR_INVALID_ARGUMENT (-108)
 #define BOAT_ERROR_BUFFER_EXHAUSTED (-109)
 #define BOAT_ERROR_TX_NOT_MINED (-110)
+#define BOAT_ERROR_INTEGER_OVERFLOW (-111)
 
 #define BOAT_ERROR_TEST_CASE_FAIL (-1000)
 
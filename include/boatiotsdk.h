@@ -34,6 +34,7 @@ boatiotsdk.h is the wrapper header file for 3rd application to include.
 #include "boattypes.h"
 #include "boatexception.h"
 #include "boatutility.h"
+#include "boatuint256.h"
 #include "boatrlp.h"
 #if PROTOCOL_USE_ETHEREUM == 1
 #include "protocolapi/api_ethereum.h"
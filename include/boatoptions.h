@@ -38,13 +38,110 @@ boatoptions.h defines options for compiling.
 
 // BOAT_LOG_LEVEL is a macro that limits the log detail up to that level.
 // Seting it to BOAT_LOG_NONE means outputing nothing.
+// BoatLogSetLevel() lowers the level at runtime.
 #define BOAT_LOG_LEVEL BOAT_LOG_VERBOSE
 
+// ASYNCHRONOUS LOG OPTION: BoatLog() only copies the format string pointer and
+// the arguments into a lock-free ring buffer of the calling thread, which are
+// formatted and printed by a background thread. When a ring buffer is full, the
+// log is dropped and counted instead of blocking, see BoatLogAsyncGetStats().
+// A log takes at most BOAT_LOG_ASYNC_RECORD_MAX_SIZE bytes, longer strings are
+// truncated. The ring buffer size MUST be a power of 2. Ring buffers are taken
+// from the static pools with BOAT_USE_STATIC_POOL set to 1, or from the heap,
+// never from the allocator set by BoatSetAllocator(). It requires POSIX threads.
+#define BOAT_LOG_ASYNC 0
+#define BOAT_LOG_ASYNC_BUFFER_SIZE     (16 * 1024)
+#define BOAT_LOG_ASYNC_RECORD_MAX_SIZE 2048
+
 // #define DEBUG_LOG
 
 // OpenSSL OPTION: Use OpenSSL for random number generation and AES
 #define BOAT_USE_OPENSSL 1
 
+// SIGNER OPTION: Use libsecp256k1 instead of the built-in crypto library for
+// signing, public key recovery and public key derivation.
+// If set to 1, add -lsecp256k1 to EXTERNAL_LIBS in external.env, or build with
+// "make BOAT_SIGNER_USE_LIBSECP256K1=1", which does both.
+#ifndef BOAT_SIGNER_USE_LIBSECP256K1
+#define BOAT_SIGNER_USE_LIBSECP256K1 0
+#endif
+
+// SIGN POOL OPTION: Build the parallel transaction signing pool (boatsignpool.h).
+// It requires POSIX threads (-lpthread).
+#define BOAT_USE_SIGN_POOL 1
+
+// PERSISTENT STORAGE OPTION: Keep all persistent wallets as separately encrypted
+// records of one indexed keystore file (keystore.h) instead of one file per wallet.
+// Wallets stored as separate files are imported into the keystore on first load.
+#define BOAT_PERSIST_USE_KEYSTORE 1
+#define BOAT_KEYSTORE_FILE_NAME "boatkeystore.bin"
+
+// PERSISTENT STORAGE OPTION: Encrypt and authenticate persistent storages with
+// AES-256-GCM (requires OpenSSL). Set to 0 to write the keccak256 hash-checked
+// AES-256-CBC format of earlier versions. Both formats can always be read.
+#define BOAT_PERSIST_USE_AEAD 1
+
+// Chunk size of streaming persistent storages (BoatPersistWriterInit()), which
+// bounds their memory use. Streams with chunks up to BOAT_PERSIST_STREAM_MAX_CHUNK_SIZE
+// can be read.
+#define BOAT_PERSIST_STREAM_CHUNK_SIZE     (64 * 1024)
+#define BOAT_PERSIST_STREAM_MAX_CHUNK_SIZE (4 * 1024 * 1024)
+
+// WALLET CACHE OPTION: Number of recently loaded persistent wallets whose decrypted
+// configuration and public key are kept in locked memory (boatwalletcache.h), so
+// that loading them again skips the persistent storage. Set to 0 to disable.
+#define BOAT_WALLET_CACHE_SIZE 16
+
+// TRANSACTION ARENA OPTION: Temporary memory of sending a transaction is taken
+// from a per-thread arena of BOAT_TX_ARENA_CHUNK_SIZE byte chunks and released
+// at once when the transaction is sent. The first chunk is kept for the next
+// transaction of the thread. Set to 0 to allocate each block separately.
+#define BOAT_TX_ARENA_CHUNK_SIZE 4096
+
+// STATIC POOL OPTION: Take all memory of the SDK from statically sized block
+// pools instead of the heap, so that long running devices never fragment it.
+// A request is served by the smallest free block that fits. When no block fits,
+// BoatMalloc() returns NULL and the failing call returns an error code, usually
+// BOAT_ERROR_OUT_OF_MEMORY. See BoatStaticPoolGetStats() for sizing the pools.
+// Block sizes MUST be multiples of 16 in increasing order.
+// The default sizes hold a few hundred wallets and accounts, and two persistent
+// storage streams at once, each taking two chunk blocks. Nothing larger than
+// the last block can be allocated: a record of BoatPersistStore() is sealed in
+// one block, so larger data must be written through BoatPersistWriterInit().
+// libcurl and OpenSSL keep using their own allocators.
+#define BOAT_USE_STATIC_POOL 0
+#define BOAT_STATIC_POOL_0_BLOCK_SIZE 64
+#define BOAT_STATIC_POOL_0_BLOCK_NUM  512
+#define BOAT_STATIC_POOL_1_BLOCK_SIZE 320   // A wallet or an account
+#define BOAT_STATIC_POOL_1_BLOCK_NUM  512
+#define BOAT_STATIC_POOL_2_BLOCK_SIZE 1024
+#define BOAT_STATIC_POOL_2_BLOCK_NUM  64
+#define BOAT_STATIC_POOL_3_BLOCK_SIZE 4352  // A transaction arena chunk
+#define BOAT_STATIC_POOL_3_BLOCK_NUM  32
+#define BOAT_STATIC_POOL_4_BLOCK_SIZE (16 * 1024 + 64) // An asynchronous log ring buffer
+#define BOAT_STATIC_POOL_4_BLOCK_NUM  8
+#define BOAT_STATIC_POOL_5_BLOCK_SIZE (72 * 1024) // A persistent storage stream chunk
+#define BOAT_STATIC_POOL_5_BLOCK_NUM  8
+
+
+// MEMORY ACCOUNTING OPTION: Prepend a 16-byte header to each block of BoatMalloc()
+// and account live bytes, peak bytes and allocation counts to the subsystem
+// allocating it, see BoatMemGetSnapshot(). Set to 0 for no overhead.
+#define BOAT_MEM_ACCOUNTING 0
+
+// TRANSACTION PROFILING OPTION: Time each phase of sending a transaction, from
+// fetching the nonce to waiting for the receipt, into per-phase latency
+// histograms, see BoatTxProfileGetHistogram(). With BOAT_TX_PROFILING_DUMP_INTERVAL
+// set to a number of seconds, the histograms are logged that often. Set
+// BOAT_TX_PROFILING to 0 to compile the timers out.
+#define BOAT_TX_PROFILING 0
+#define BOAT_TX_PROFILING_DUMP_INTERVAL 0
+
+// SIMD HEX OPTION: Convert HEX strings in UtilityBin2Hex() and UtilityHex2Bin()
+// 16 or 32 bytes at a time, with AVX2, SSSE3 or SSE2 on x86 as detected at runtime
+// (GCC or Clang required) and with NEON on AArch64. Set to 0 to convert a byte
+// at a time, e.g. for compilers without SIMD intrinsics.
+#define BOAT_HEX_USE_SIMD 1
 
 
 // RPC USE OPTION: One and only one RPC_USE option shall be set to 1
@@ -60,6 +157,14 @@ boatoptions.h defines options for compiling.
 #endif
 #undef RPC_USE_COUNT
 
+// RPC ENDPOINT POOL OPTION: Requests to the same node URL share keep-alive
+// connections and DNS and TLS session caches, whatever wallet or thread sends
+// them. Up to BOAT_RPC_ENDPOINT_MAX_NUM node URLs are pooled, each keeping up
+// to BOAT_RPC_ENDPOINT_IDLE_CONN_NUM idle connections. Requests to further
+// node URLs use a connection of their own.
+#define BOAT_RPC_ENDPOINT_MAX_NUM       8
+#define BOAT_RPC_ENDPOINT_IDLE_CONN_NUM 4
+
 
 // Blockchain Protocol OPTION
 #define PROTOCOL_USE_ETHEREUM   1
@@ -48,6 +48,18 @@ typedef signed int BSINT32;
 typedef signed long long int BSINT64;
 //typedef __int128_t BSINT128;
 
+//!@brief 256-bit unsigned integer, see boatuint256.h
+typedef struct TBUINT256
+{
+    BUINT64 limb[4];     //!< 64-bit limbs, the least significant first
+}BUINT256;
+
+//!@brief 256-bit signed integer in two's complement, see boatuint256.h
+typedef struct TBSINT256
+{
+    BUINT64 limb[4];     //!< 64-bit limbs, the least significant first
+}BSINT256;
+
 
 typedef BSINT32 BOAT_RESULT;
 typedef BUINT8 BoatAddress[20];
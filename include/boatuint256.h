@@ -0,0 +1,596 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief 256-bit integer header file
+
+@file
+boatuint256.h declares arithmetic and conversions of BUINT256 and BSINT256, the
+256-bit integers of Ethereum balances, values and uint256/int256 contract
+arguments.
+
+Arithmetic wraps modulo 2^256 like the EVM does, and returns
+BOAT_ERROR_INTEGER_OVERFLOW when the exact result doesn't fit.
+*/
+
+#ifndef __BOATUINT256_H__
+#define __BOATUINT256_H__
+
+#include "boatiotsdk.h"
+
+//!@brief Buffer size of a BUINT256 in HEX, with "0x" prefix and null terminator
+#define BOAT_UINT256_HEX_STR_SIZE 67
+//!@brief Buffer size of a BUINT256 or BSINT256 in decimal, with null terminator
+#define BOAT_UINT256_DEC_STR_SIZE 79
+//!@brief Buffer size of a BUINT256 wei in decimal ether, with null terminator
+#define BOAT_WEI_ETH_STR_SIZE     80
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!*****************************************************************************
+@brief Convert a BUINT64 to BUINT256
+
+Function: UtilityUint256FromUint64()
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_integer
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityUint256FromUint64(BOAT_OUT BUINT256 *to_ptr, BUINT64 from_integer);
+
+
+/*!*****************************************************************************
+@brief Convert a bigendian byte stream to BUINT256
+
+Function: UtilityUint256FromBigendian()
+
+    This function converts up to 32 bytes of bigendian integer, e.g. a uint256
+    in an ABI encoded return value. Longer streams are accepted if the extra
+    leading bytes are zeros.
+
+@return
+    This function returns BOAT_SUCCESS if the integer fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_ptr
+    The bigendian integer to convert.
+
+@param[in] from_len
+    The length of <from_ptr> in byte.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromBigendian(BOAT_OUT BUINT256 *to_ptr, const BUINT8 *from_ptr, BUINT32 from_len);
+
+
+/*!*****************************************************************************
+@brief Convert a BUINT256 to 32 bytes of bigendian integer
+
+Function: UtilityUint256ToBigendian()
+
+    This function writes the 32-byte bigendian form of an integer, as an
+    ABI encoded uint256 argument. UtilityTrimBin() trims its leading zeros for
+    RLP encoding.
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_array
+    The bigendian integer.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityUint256ToBigendian(BOAT_OUT BUINT8 to_array[32], const BUINT256 *from_ptr);
+
+
+/*!*****************************************************************************
+@brief Convert a HEX string to BUINT256
+
+Function: UtilityUint256FromHex()
+
+    This function converts a HEX string, such as a balance returned by the
+    node, to BUINT256. "0x" prefix is optional.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> contains any non-HEX\n
+    character, or BOAT_ERROR_INTEGER_OVERFLOW if it exceeds 256 bits.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated HEX string to convert.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromHex(BOAT_OUT BUINT256 *to_ptr, const BCHAR *from_str);
+
+
+/*!*****************************************************************************
+@brief Convert a BUINT256 to HEX string
+
+Function: UtilityUint256ToHex()
+
+    This function converts an integer to HEX string as a JSON-RPC quantity,
+    i.e. without leading zeros and 0 converted to "0".
+
+@return
+    This function returns the length of the HEX string excluding null terminator.
+
+@param[out] to_str
+    The buffer of at least BOAT_UINT256_HEX_STR_SIZE bytes.
+
+@param[in] from_ptr
+    The integer to convert.
+
+@param[in] prefix_0x_mode
+    BIN2HEX_PREFIX_0x_YES: Prepend a "0x" prefix;\n
+    BIN2HEX_PREFIX_0x_NO:  Don't prepend "0x" prefix.
+
+*******************************************************************************/
+BUINT32 UtilityUint256ToHex(BOAT_OUT BCHAR *to_str, const BUINT256 *from_ptr, BIN2HEX_PREFIX_0x_MODE prefix_0x_mode);
+
+
+/*!*****************************************************************************
+@brief Convert a decimal string to BUINT256
+
+Function: UtilityUint256FromDecStr()
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> is empty or contains\n
+    any non-decimal character, or BOAT_ERROR_INTEGER_OVERFLOW if it exceeds\n
+    2^256 - 1.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated decimal string to convert, such as "1000000000000000000".
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromDecStr(BOAT_OUT BUINT256 *to_ptr, const BCHAR *from_str);
+
+
+/*!*****************************************************************************
+@brief Convert a BUINT256 to decimal string
+
+Function: UtilityUint256ToDecStr()
+
+@return
+    This function returns the length of the decimal string excluding null\n
+    terminator. If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the decimal string. BOAT_UINT256_DEC_STR_SIZE bytes\n
+    are always enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+BUINT32 UtilityUint256ToDecStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BUINT256 *from_ptr);
+
+
+/*!*****************************************************************************
+@brief Compare two BUINT256
+
+Function: UtilityUint256Compare()
+
+@return
+    This function returns a negative number, 0 or a positive number if <a_ptr>\n
+    is less than, equal to or greater than <b_ptr> respectively.
+
+@param[in] a_ptr
+    The integer to compare.
+
+@param[in] b_ptr
+    The integer to compare with.
+
+*******************************************************************************/
+BSINT32 UtilityUint256Compare(const BUINT256 *a_ptr, const BUINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Add two BUINT256
+
+Function: UtilityUint256Add()
+
+    This function computes <a_ptr> + <b_ptr> modulo 2^256. <sum_ptr> may be
+    the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the sum fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] sum_ptr
+    The sum.
+
+@param[in] a_ptr
+    The augend.
+
+@param[in] b_ptr
+    The addend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Add(BOAT_OUT BUINT256 *sum_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Subtract a BUINT256 from another
+
+Function: UtilityUint256Sub()
+
+    This function computes <a_ptr> - <b_ptr> modulo 2^256, e.g. the balance
+    left after a transfer. <difference_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if <a_ptr> is not less than <b_ptr>.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] difference_ptr
+    The difference.
+
+@param[in] a_ptr
+    The minuend.
+
+@param[in] b_ptr
+    The subtrahend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Sub(BOAT_OUT BUINT256 *difference_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Multiply two BUINT256
+
+Function: UtilityUint256Mul()
+
+    This function computes <a_ptr> * <b_ptr> modulo 2^256, e.g. the fee of gas
+    limit times gas price. <product_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the product fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] product_ptr
+    The product.
+
+@param[in] a_ptr
+    The multiplicand.
+
+@param[in] b_ptr
+    The multiplier.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Mul(BOAT_OUT BUINT256 *product_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Divide a BUINT256 by another
+
+Function: UtilityUint256DivMod()
+
+    This function computes the quotient and the remainder of <dividend_ptr>
+    divided by <divisor_ptr>. The outputs may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <divisor_ptr> is 0, it returns BOAT_ERROR_INVALID_ARGUMENT.
+
+@param[out] quotient_ptr
+    The quotient, or NULL if it's not needed.
+
+@param[out] remainder_ptr
+    The remainder, or NULL if it's not needed.
+
+@param[in] dividend_ptr
+    The dividend.
+
+@param[in] divisor_ptr
+    The divisor.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256DivMod(BOAT_OUT BUINT256 *quotient_ptr,
+                                 BOAT_OUT BUINT256 *remainder_ptr,
+                                 const BUINT256 *dividend_ptr,
+                                 const BUINT256 *divisor_ptr);
+
+
+/*!*****************************************************************************
+@brief Convert a BSINT64 to BSINT256
+
+Function: UtilityInt256FromInt64()
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_integer
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityInt256FromInt64(BOAT_OUT BSINT256 *to_ptr, BSINT64 from_integer);
+
+
+/*!*****************************************************************************
+@brief Convert a bigendian two's complement byte stream to BSINT256
+
+Function: UtilityInt256FromBigendian()
+
+    This function converts up to 32 bytes of bigendian two's complement
+    integer, e.g. an int256 in an ABI encoded return value. Shorter streams
+    are sign-extended.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <from_len> exceeds 32, it returns BOAT_ERROR_INVALID_LENGTH.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_ptr
+    The bigendian integer to convert.
+
+@param[in] from_len
+    The length of <from_ptr> in byte.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256FromBigendian(BOAT_OUT BSINT256 *to_ptr, const BUINT8 *from_ptr, BUINT32 from_len);
+
+
+/*!*****************************************************************************
+@brief Convert a BSINT256 to 32 bytes of bigendian two's complement integer
+
+Function: UtilityInt256ToBigendian()
+
+    This function writes the 32-byte bigendian form of an integer, as an
+    ABI encoded int256 argument.
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_array
+    The bigendian integer.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityInt256ToBigendian(BOAT_OUT BUINT8 to_array[32], const BSINT256 *from_ptr);
+
+
+/*!*****************************************************************************
+@brief Convert a decimal string to BSINT256
+
+Function: UtilityInt256FromDecStr()
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> has no digits or\n
+    contains any non-decimal character, or BOAT_ERROR_INTEGER_OVERFLOW if it's\n
+    out of [-2^255, 2^255 - 1].
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated decimal string to convert, with an optional leading\n
+    '-' or '+'.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256FromDecStr(BOAT_OUT BSINT256 *to_ptr, const BCHAR *from_str);
+
+
+/*!*****************************************************************************
+@brief Convert a BSINT256 to decimal string
+
+Function: UtilityInt256ToDecStr()
+
+@return
+    This function returns the length of the decimal string excluding null\n
+    terminator. If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the decimal string. BOAT_UINT256_DEC_STR_SIZE bytes\n
+    are always enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+BUINT32 UtilityInt256ToDecStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BSINT256 *from_ptr);
+
+
+/*!*****************************************************************************
+@brief Compare two BSINT256
+
+Function: UtilityInt256Compare()
+
+@return
+    This function returns a negative number, 0 or a positive number if <a_ptr>\n
+    is less than, equal to or greater than <b_ptr> respectively.
+
+@param[in] a_ptr
+    The integer to compare.
+
+@param[in] b_ptr
+    The integer to compare with.
+
+*******************************************************************************/
+BSINT32 UtilityInt256Compare(const BSINT256 *a_ptr, const BSINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Add two BSINT256
+
+Function: UtilityInt256Add()
+
+    This function computes <a_ptr> + <b_ptr> in two's complement, wrapping on
+    overflow. <sum_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the sum is in [-2^255, 2^255 - 1].\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] sum_ptr
+    The sum.
+
+@param[in] a_ptr
+    The augend.
+
+@param[in] b_ptr
+    The addend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Add(BOAT_OUT BSINT256 *sum_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Subtract a BSINT256 from another
+
+Function: UtilityInt256Sub()
+
+    This function computes <a_ptr> - <b_ptr> in two's complement, wrapping on
+    overflow. <difference_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the difference is in\n
+    [-2^255, 2^255 - 1]. Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] difference_ptr
+    The difference.
+
+@param[in] a_ptr
+    The minuend.
+
+@param[in] b_ptr
+    The subtrahend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Sub(BOAT_OUT BSINT256 *difference_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Multiply two BSINT256
+
+Function: UtilityInt256Mul()
+
+    This function computes <a_ptr> * <b_ptr> in two's complement, wrapping on
+    overflow. <product_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the product is in\n
+    [-2^255, 2^255 - 1]. Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] product_ptr
+    The product.
+
+@param[in] a_ptr
+    The multiplicand.
+
+@param[in] b_ptr
+    The multiplier.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Mul(BOAT_OUT BSINT256 *product_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr);
+
+
+/*!*****************************************************************************
+@brief Divide a BSINT256 by another
+
+Function: UtilityInt256DivMod()
+
+    This function computes the quotient rounded toward zero and the remainder,
+    which has the sign of the dividend, like SDIV and SMOD of the EVM. The
+    outputs may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <divisor_ptr> is 0, it returns BOAT_ERROR_INVALID_ARGUMENT.\n
+    If the quotient of -2^255 divided by -1 wraps to -2^255, it returns\n
+    BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] quotient_ptr
+    The quotient, or NULL if it's not needed.
+
+@param[out] remainder_ptr
+    The remainder, or NULL if it's not needed.
+
+@param[in] dividend_ptr
+    The dividend.
+
+@param[in] divisor_ptr
+    The divisor.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256DivMod(BOAT_OUT BSINT256 *quotient_ptr,
+                                BOAT_OUT BSINT256 *remainder_ptr,
+                                const BSINT256 *dividend_ptr,
+                                const BSINT256 *divisor_ptr);
+
+
+/*!*****************************************************************************
+@brief Convert wei to ether in exact decimal string
+
+Function: UtilityWeiToEthStr()
+
+    This function formats wei as ether without losing precision, e.g.
+    1500000000000000001 wei is converted to "1.500000000000000001". Trailing
+    zeros of the fraction are omitted, and so is the decimal point of a whole
+    number of ether.
+
+@return
+    This function returns the length of the string excluding null terminator.\n
+    If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the string. BOAT_WEI_ETH_STR_SIZE bytes are always\n
+    enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] wei_ptr
+    The amount in wei.
+
+*******************************************************************************/
+BUINT32 UtilityWeiToEthStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BUINT256 *wei_ptr);
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
@@ -58,6 +58,116 @@ typedef struct TStringWithLen
 }StringWithLen;
 
 
+//!@brief Memory allocator wrapped by BoatMalloc() and BoatFree().
+typedef struct TBoatAllocator
+{
+    void *(*malloc_fn)(BUINT32 size); //!< Allocate <size> bytes, or return NULL if it fails
+    void (*free_fn)(void *mem_ptr);   //!< Free the memory returned by <malloc_fn>
+}BoatAllocator;
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+//!@brief Subsystems that memory allocated by BoatMalloc() is accounted to
+typedef enum
+{
+    BOAT_MEM_TAG_OTHER = 0, //!< Memory not attributed to any subsystem, e.g. by the application
+    BOAT_MEM_TAG_WALLET,    //!< Wallet registry, wallet cache and wallet APIs
+    BOAT_MEM_TAG_TX,        //!< Transaction construction and signing of the protocols
+    BOAT_MEM_TAG_RLP,       //!< RLP encoding
+    BOAT_MEM_TAG_JSON,      //!< cJSON objects and strings
+    BOAT_MEM_TAG_WEB3,      //!< Web3 request and response buffers
+    BOAT_MEM_TAG_RPC,       //!< RPC endpoints and HTTP buffers
+    BOAT_MEM_TAG_SIGNER,    //!< Signer
+    BOAT_MEM_TAG_STORAGE,   //!< Persistent storage and keystore
+    BOAT_MEM_TAG_NUM        //!< Number of tags
+}BoatMemTag;
+
+//!@brief Memory accounting of a subsystem, see BoatMemGetSnapshot()
+typedef struct TBoatMemStats
+{
+    BUINT64 live_bytes;  //!< Bytes allocated and not yet freed, excluding accounting headers
+    BUINT64 peak_bytes;  //!< Maximum of <live_bytes> since the last BoatMemResetStats()
+    BUINT64 alloc_num;   //!< Number of successful allocations since the last reset
+    BUINT64 free_num;    //!< Number of blocks freed since the last reset
+    BUINT64 fail_num;    //!< Number of failed allocations since the last reset
+    BUINT64 unfreed_num; //!< Number of arena blocks released by BoatTxArenaEnd() without BoatFree()
+}BoatMemStats;
+
+//!@brief Memory accounting of all subsystems at a moment
+typedef struct TBoatMemSnapshot
+{
+    BoatMemStats tag_stats[BOAT_MEM_TAG_NUM]; //!< Accounting of each BoatMemTag
+    BoatMemStats total_stats;                 //!< Accounting of all tags, whose <peak_bytes> is the peak of the sum
+}BoatMemSnapshot;
+#endif
+
+
+#if BOAT_TX_PROFILING == 1
+//!@brief Phases of sending a transaction timed with BOAT_TX_PROFILING set to 1
+typedef enum
+{
+    BOAT_TX_PHASE_NONCE_FETCH = 0, //!< Getting the nonce from network, BoatEthTxSetNonce()
+    BOAT_TX_PHASE_GAS_PRICE_FETCH, //!< Getting the gas price from network, BoatEthTxSetGasPrice()
+    BOAT_TX_PHASE_RLP_ENCODE,      //!< RLP encoding the unsigned transaction
+    BOAT_TX_PHASE_KECCAK,          //!< Hashing the encoded transaction
+    BOAT_TX_PHASE_SIGN,            //!< ECDSA signing the hash
+    BOAT_TX_PHASE_RLP_REENCODE,    //!< RLP re-encoding the signed transaction
+    BOAT_TX_PHASE_HEX_CONVERT,     //!< Converting the signed transaction to HEX
+    BOAT_TX_PHASE_JSON_BUILD,      //!< Building a JSON-RPC REQUEST
+    BOAT_TX_PHASE_HTTP_ROUNDTRIP,  //!< Posting a REQUEST and receiving its RESPONSE
+    BOAT_TX_PHASE_JSON_PARSE,      //!< Parsing a JSON-RPC RESPONSE
+    BOAT_TX_PHASE_RECEIPT_WAIT,    //!< Waiting for the transaction being mined
+    BOAT_TX_PHASE_NUM              //!< Number of phases
+}BoatTxPhase;
+
+//!@brief Number of buckets of a phase histogram
+#define BOAT_TX_PROFILE_BUCKET_NUM 304
+
+/*!@brief Latency histogram of a phase, see BoatTxProfileGetHistogram()
+
+    Bucket i < 8 counts latencies of i ns. Above that, every power of 2 ns is
+    split into 8 buckets, so that a bucket spans at most 1/8 of the latencies it
+    counts, up to 2^40 ns (about 18 minutes). Longer latencies are counted by
+    the last bucket.
+*/
+typedef struct TBoatTxPhaseHistogram
+{
+    BUINT64 count;    //!< Number of times the phase completed
+    BUINT64 total_ns; //!< Sum of the latencies in ns
+    BUINT64 min_ns;   //!< Minimum latency in ns, or 0 if <count> is 0
+    BUINT64 max_ns;   //!< Maximum latency in ns
+    BUINT32 bucket_count[BOAT_TX_PROFILE_BUCKET_NUM]; //!< Number of latencies in each bucket
+}BoatTxPhaseHistogram;
+#endif
+
+
+#if BOAT_USE_STATIC_POOL == 1
+//!@brief Number of static block pools configured in boatoptions.h
+#define BOAT_STATIC_POOL_NUM 6
+
+//!@brief Usage statistics of a static block pool, see BoatStaticPoolGetStats()
+typedef struct TBoatStaticPoolStats
+{
+    BUINT32 block_size;    //!< Size of a block in byte
+    BUINT32 block_num;     //!< Number of blocks
+    BUINT32 used_num;      //!< Number of blocks in use
+    BUINT32 peak_used_num; //!< Maximum number of blocks in use at the same time
+    BUINT32 fail_num;      //!< Number of failed requests this pool is the best fit for
+}BoatStaticPoolStats;
+#endif
+
+
+#if BOAT_LOG_ASYNC == 1
+//!@brief Counters of the asynchronous log, see BoatLogAsyncGetStats()
+typedef struct TBoatLogAsyncStats
+{
+    BUINT64 written_num;   //!< Number of logs written into the ring buffers
+    BUINT64 dropped_num;   //!< Number of logs dropped for a full ring buffer or no memory
+    BUINT64 truncated_num; //!< Number of logs whose arguments didn't fit in a record
+}BoatLogAsyncStats;
+#endif
+
+
 extern const BCHAR * const g_log_level_name_str[];
 
 #if BOAT_LOG_LEVEL == BOAT_LOG_NONE
@@ -70,10 +180,15 @@ extern const BCHAR * const g_log_level_name_str[];
     Similar to that in printf().
 */
 #define BoatLog(level, format,...)
+#elif BOAT_LOG_ASYNC == 1
+#define BoatLog(level, format,...)\
+    do{\
+        if( level <= BOAT_LOG_LEVEL && level <= BoatLogGetLevel() ) {BoatLogAsyncWrite(level, __FILE__, __LINE__, __func__, format, ##__VA_ARGS__);}\
+    }while(0)
 #else
 #define BoatLog(level, format,...)\
     do{\
-        if( level <= BOAT_LOG_LEVEL ) {printf("%s: "__FILE__":%d, %s(): "format"\n", g_log_level_name_str[level-1], __LINE__, __func__, ##__VA_ARGS__);}\
+        if( level <= BOAT_LOG_LEVEL && level <= BoatLogGetLevel() ) {printf("%s: "__FILE__":%d, %s(): "format"\n", g_log_level_name_str[level-1], __LINE__, __func__, ##__VA_ARGS__);}\
     }while(0)
 #endif
 
@@ -473,20 +588,17 @@ Function: UtilityWeiStrToEthDouble()
     This function converts a string representing wei in HEX to ether in double
     float.
 
-    1 ether is 1e18 wei. Note that in Ethereum an integer type is up to 256 bits
-    while most C compilers natively support up to 64-bit integer. A 64-bit
-    unsigned interger can represent up to 2^64 - 1, which is roughly 1.845e19.
-    Thus it's not possible to convert more than 1.845e19 wei (i.e. 18.45 ether)
-    to native integer type.
-
-    Converting integer type wei to double float type ether loses pricision.
-    Fortunately the unit of ether is usually for friendly human-reading only
-    and slight pricision loss is not a problem.
+    1 ether is 1e18 wei. The wei is parsed as a 256-bit integer and divided by
+    1e18 exactly with UtilityWeiToEthStr(), so that the result is the nearest
+    double float of the exact ether. A double float has 53 bits of mantissa,
+    i.e. about 16 significant decimal digits, which is enough for human-reading.
+    Use UtilityWeiToEthStr() or compare BUINT256 wei where every wei counts.
     
 
 
 @return
-    This function returns the converted ether in double float.
+    This function returns the converted ether in double float.\n
+    If <wei_str> isn't a HEX integer of up to 256 bits, it returns 0.0.
     
 
 @param[in] wei_str
@@ -503,8 +615,18 @@ Function: BoatMalloc()
 
     This function is a wrapper for dynamic memory allocation.
 
-    It typically wraps malloc() in a linux or Windows system.
-    For RTOS it depends on the specification of the RTOS.
+    It allocates from the allocator set by BoatIotSdkInitWithAllocator(), which
+    typically wraps malloc() in a linux or Windows system. For RTOS it depends
+    on the specification of the RTOS. With BOAT_USE_STATIC_POOL set to 1, the
+    default allocator takes blocks from static pools instead.
+
+    Between BoatTxArenaBegin() and BoatTxArenaEnd() the memory is taken from
+    the transaction arena of the calling thread instead, and it's valid until
+    BoatTxArenaEnd(). Memory that lives longer MUST be allocated with
+    BoatMallocPersistent().
+
+    With BOAT_MEM_ACCOUNTING set to 1, it's a macro that accounts the memory to
+    the BOAT_MEM_TAG of the calling source file, see BoatMallocTagged().
 
 
 @return
@@ -519,6 +641,74 @@ Function: BoatMalloc()
 void *BoatMalloc(BUINT32 size);
 
 
+/*!*****************************************************************************
+@brief Wrapper function for memory allocation outside transaction arenas
+
+Function: BoatMallocPersistent()
+
+    This function is the same as BoatMalloc() except that it never allocates
+    from a transaction arena. It's used for memory that outlives the transaction
+    being sent, such as per-thread RPC buffers.
+
+@see BoatMalloc() BoatTxArenaBegin()
+
+@return
+    This function returns the address of the allocated memory. If allocation\n
+    fails, it returns NULL.
+    
+
+@param[in] size
+        How many bytes to allocate.
+
+*******************************************************************************/
+void *BoatMallocPersistent(BUINT32 size);
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+/*!@brief Subsystem the memory allocated by a source file is accounted to
+
+    A source file defines BOAT_MEM_TAG as one of BoatMemTag before including
+    any header, so that its BoatMalloc() and BoatMallocPersistent() calls are
+    accounted to that subsystem.
+*/
+#ifndef BOAT_MEM_TAG
+#define BOAT_MEM_TAG BOAT_MEM_TAG_OTHER
+#endif
+
+#define BoatMalloc(size) BoatMallocTagged((size), BOAT_MEM_TAG, BOAT_FALSE)
+#define BoatMallocPersistent(size) BoatMallocTagged((size), BOAT_MEM_TAG, BOAT_TRUE)
+
+
+/*!*****************************************************************************
+@brief Wrapper function for memory allocation accounted to a subsystem
+
+Function: BoatMallocTagged()
+
+    This function is what BoatMalloc() and BoatMallocPersistent() expand to
+    with BOAT_MEM_ACCOUNTING set to 1. It prepends an accounting header to the
+    block and accounts it to <tag> until BoatFree().
+
+@see BoatMalloc() BoatMemGetSnapshot()
+
+@return
+    This function returns the address of the allocated memory. If allocation\n
+    fails, it returns NULL.
+    
+
+@param[in] size
+        How many bytes to allocate.
+
+@param[in] tag
+        The subsystem the memory is accounted to.
+
+@param[in] is_persistent
+        BOAT_TRUE to allocate as BoatMallocPersistent(), or BOAT_FALSE as BoatMalloc().
+
+*******************************************************************************/
+void *BoatMallocTagged(BUINT32 size, BoatMemTag tag, BBOOL is_persistent);
+#endif
+
+
 /*!*****************************************************************************
 @brief Wrapper function for memory allocation
 
@@ -526,8 +716,7 @@ Function: BoatFree()
 
     This function is a wrapper for dynamic memory de-allocation.
 
-    It typically wraps free() in a linux or Windows system.
-    For RTOS it depends on the specification of the RTOS.
+    Memory taken from a transaction arena is not freed until BoatTxArenaEnd().
 
 
 @see BoatMalloc()
@@ -537,12 +726,376 @@ Function: BoatFree()
     
 
 @param[in] mem_ptr
-    The address to free. The address must be the one returned by BoatMalloc().
+    The address to free. The address must be the one returned by BoatMalloc()\n
+    or BoatMallocPersistent().
 
 *******************************************************************************/
 void BoatFree(void *mem_ptr);
 
 
+/*!*****************************************************************************
+@brief Set the allocator of BoatMalloc()
+
+Function: BoatSetAllocator()
+
+    This function sets the allocator that BoatMalloc() and BoatFree() wrap. It's
+    called by BoatIotSdkInitWithAllocator() before any other use of the SDK.
+
+    The allocator MUST NOT be changed while any memory it allocated is in use.
+
+@return
+    This function doesn't return anything.
+    
+
+@param[in] allocator_ptr
+    The allocator, whose functions MUST be thread-safe. If NULL, the default\n
+    allocator is set, which takes memory from the static pools with\n
+    BOAT_USE_STATIC_POOL set to 1, or wraps malloc() and free() otherwise.
+
+*******************************************************************************/
+void BoatSetAllocator(const BoatAllocator *allocator_ptr);
+
+
+/*!*****************************************************************************
+@brief Begin a transaction arena scope
+
+Function: BoatTxArenaBegin()
+
+    This function makes BoatMalloc() of the calling thread allocate from its
+    transaction arena until the matching BoatTxArenaEnd(). Scopes can be nested,
+    in which case the outermost scope owns the memory.
+
+@see BoatTxArenaEnd()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaBegin(void);
+
+
+/*!*****************************************************************************
+@brief End a transaction arena scope
+
+Function: BoatTxArenaEnd()
+
+    This function ends the scope begun by BoatTxArenaBegin(). When the outermost
+    scope ends, all memory taken from the arena is released at once.
+
+@see BoatTxArenaBegin()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaEnd(void);
+
+
+/*!*****************************************************************************
+@brief Release the transaction arena of the calling thread
+
+Function: BoatTxArenaRelease()
+
+    This function frees the chunk the transaction arena of the calling thread
+    keeps between transactions. Arenas of other threads are freed when the
+    threads exit.
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaRelease(void);
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+/*!*****************************************************************************
+@brief Get a snapshot of memory accounting
+
+Function: BoatMemGetSnapshot()
+
+    This function gets the live and peak bytes and the allocation counts of
+    each subsystem, as accounted by BoatMalloc() and BoatFree() with
+    BOAT_MEM_ACCOUNTING set to 1. Memory budgets of a device are checked
+    against <peak_bytes> after running its workload.
+
+    A non-zero <unfreed_num> means memory that is leaked when no transaction
+    arena is in use.
+
+@return
+    This function returns BOAT_SUCCESS if the snapshot is got.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[out] snapshot_ptr
+    The snapshot. Counters are read one by one while other threads may keep\n
+    allocating, so they may be slightly inconsistent with each other.
+
+*******************************************************************************/
+BOAT_RESULT BoatMemGetSnapshot(BOAT_OUT BoatMemSnapshot *snapshot_ptr);
+
+
+/*!*****************************************************************************
+@brief Reset memory accounting
+
+Function: BoatMemResetStats()
+
+    This function resets the counts of all subsystems to 0 and their peak bytes
+    to their live bytes, so that a workload can be measured on its own. Live
+    bytes are kept.
+
+@see BoatMemGetSnapshot()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatMemResetStats(void);
+#endif
+
+
+#if BOAT_TX_PROFILING == 1
+/*!*****************************************************************************
+@brief Get the latency histogram of a transaction phase
+
+Function: BoatTxProfileGetHistogram()
+
+    This function gets the latencies of a phase of sending transactions timed
+    since start or the last BoatTxProfileReset(), with BOAT_TX_PROFILING set to
+    1. Only phases that complete successfully are timed. The JSON and HTTP
+    phases are timed for every JSON-RPC call, including those of nonce, gas
+    price and receipt queries.
+
+@see BoatTxProfileGetPercentile()
+
+@return
+    This function returns BOAT_SUCCESS if the histogram is got.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[in] phase
+    The phase.
+
+@param[out] histogram_ptr
+    The histogram.
+
+*******************************************************************************/
+BOAT_RESULT BoatTxProfileGetHistogram(BoatTxPhase phase, BOAT_OUT BoatTxPhaseHistogram *histogram_ptr);
+
+
+/*!*****************************************************************************
+@brief Get a percentile of a latency histogram
+
+Function: BoatTxProfileGetPercentile()
+
+@return
+    This function returns the latency in ns that <percentile> percent of the\n
+    latencies don't exceed, accurate to the bucket width, or 0 if the\n
+    histogram is empty.
+    
+
+@param[in] histogram_ptr
+    The histogram got by BoatTxProfileGetHistogram().
+
+@param[in] percentile
+    The percentile, 0.0 ~ 100.0, e.g. 99.9.
+
+*******************************************************************************/
+BUINT64 BoatTxProfileGetPercentile(const BoatTxPhaseHistogram *histogram_ptr, double percentile);
+
+
+/*!*****************************************************************************
+@brief Get the name of a transaction phase
+
+Function: BoatTxProfilePhaseName()
+
+@return
+    This function returns the name of <phase>, or "unknown".
+    
+
+@param[in] phase
+    The phase.
+
+*******************************************************************************/
+const BCHAR *BoatTxProfilePhaseName(BoatTxPhase phase);
+
+
+/*!*****************************************************************************
+@brief Reset the latency histograms of all transaction phases
+
+Function: BoatTxProfileReset()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxProfileReset(void);
+
+
+/*!*****************************************************************************
+@brief Log the latency histograms of all transaction phases
+
+Function: BoatTxProfileDump()
+
+    This function logs the count, mean, median, 90th and 99th percentile and
+    maximum latency of each phase that has been timed. It's called every
+    BOAT_TX_PROFILING_DUMP_INTERVAL seconds if that's not 0.
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxProfileDump(void);
+#endif
+
+
+/*!*****************************************************************************
+@brief Set the log level at runtime
+
+Function: BoatLogSetLevel()
+
+    This function limits the log detail of BoatLog() up to <level>. Logs above
+    BOAT_LOG_LEVEL are compiled out and never output whatever <level> is.
+
+@return
+    This function returns BOAT_SUCCESS if <level> is valid.\n
+    Otherwise it returns BOAT_ERROR_INVALID_ARGUMENT.
+    
+
+@param[in] level
+    One of BOAT_LOG_NONE, BOAT_LOG_CRITICAL, BOAT_LOG_NORMAL or BOAT_LOG_VERBOSE.
+
+*******************************************************************************/
+BOAT_RESULT BoatLogSetLevel(BUINT32 level);
+
+
+/*!*****************************************************************************
+@brief Get the log level set at runtime
+
+Function: BoatLogGetLevel()
+
+@return
+    This function returns the level set by BoatLogSetLevel(), BOAT_LOG_LEVEL by
+    default.
+    
+*******************************************************************************/
+BUINT32 BoatLogGetLevel(void);
+
+
+#if BOAT_LOG_ASYNC == 1
+/*!*****************************************************************************
+@brief Write a log into the ring buffer of the calling thread
+
+Function: BoatLogAsyncWrite()
+
+    This function is called by BoatLog() with BOAT_LOG_ASYNC set to 1. It copies
+    the arguments of <format> into a record of the ring buffer of the calling
+    thread, so <file_str>, <func_str> and <format> MUST be string literals.
+    Strings are copied, up to the size of a record. %n and wide characters are
+    not supported.
+
+    The background thread formatting the records is started by the first log.
+    If the ring buffer is full, the log is dropped. After BoatLogAsyncStop(),
+    logs are printed synchronously.
+
+@return
+    This function doesn't return anything.
+    
+
+@param[in] level
+    Log priority level.
+
+@param[in] file_str
+    Source file of the log.
+
+@param[in] line
+    Source line of the log.
+
+@param[in] func_str
+    Function of the log.
+
+@param[in] format
+    Similar to that in printf().
+
+*******************************************************************************/
+void BoatLogAsyncWrite(BUINT32 level, const BCHAR *file_str, BUINT32 line,
+                       const BCHAR *func_str, const BCHAR *format, ...);
+
+
+/*!*****************************************************************************
+@brief Wait until all logs written before are printed
+
+Function: BoatLogAsyncFlush()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatLogAsyncFlush(void);
+
+
+/*!*****************************************************************************
+@brief Print all pending logs and stop the background thread
+
+Function: BoatLogAsyncStop()
+
+    This function is registered with atexit() when the background thread is
+    started. Logs after it are printed synchronously.
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatLogAsyncStop(void);
+
+
+/*!*****************************************************************************
+@brief Get the counters of the asynchronous log
+
+Function: BoatLogAsyncGetStats()
+
+@return
+    This function returns BOAT_SUCCESS if <stats_ptr> is filled.\n
+    Otherwise it returns BOAT_ERROR_NULL_POINTER.
+    
+
+@param[out] stats_ptr
+    The counters since the process started.
+
+*******************************************************************************/
+BOAT_RESULT BoatLogAsyncGetStats(BOAT_OUT BoatLogAsyncStats *stats_ptr);
+#endif
+
+
+#if BOAT_USE_STATIC_POOL == 1
+/*!*****************************************************************************
+@brief Get usage statistics of a static block pool
+
+Function: BoatStaticPoolGetStats()
+
+    This function gets the usage statistics of one of the BOAT_STATIC_POOL_NUM
+    block pools that BoatMalloc() allocates from with BOAT_USE_STATIC_POOL set to
+    1. A request that fits no free block is counted as a failure of the smallest
+    pool it fits, or of the largest pool if it fits none.
+
+    A pool whose <peak_used_num> reaches <block_num> serves its requests from
+    larger pools, and should be enlarged in boatoptions.h.
+
+@return
+    This function returns BOAT_SUCCESS if the statistics are got.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[in] pool_index
+    Index of the pool, 0 ~ BOAT_STATIC_POOL_NUM - 1, in increasing block size.
+
+@param[out] stats_ptr
+    The statistics of the pool.
+
+*******************************************************************************/
+BOAT_RESULT BoatStaticPoolGetStats(BUINT32 pool_index, BOAT_OUT BoatStaticPoolStats *stats_ptr);
+#endif
+
+
 /*!*****************************************************************************
 @brief Wrapper function for sleep (thread suspension)
 
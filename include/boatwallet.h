@@ -49,15 +49,33 @@ typedef struct TBoatWalletList
     BoatProtocolType protocol_type; //!< Blockchain protocol type
     BCHAR *wallet_name_str;     //!< Wallet name for persist wallet, NULL for one-time wallet
     void * wallet_ptr;         //!< Wallet context of one of BoatWalletInfo type
+    BSINT32 next_free_index;    //!< Next free wallet index if the entry is not used
+    BUINT32 ref_state;          //!< Number of references from BoatWalletAcquire(), plus a loaded flag
 }BoatWalletList;
 
 
+//!@brief Default maximum number of loaded wallets, see BoatIotSdkInitWithCapacity()
 #define BOAT_MAX_WALLET_NUM 4
+//!@brief Upper bound of the wallet capacity
+#define BOAT_MAX_WALLET_CAPACITY (64 * 1024)
+//!@brief Wallet entries are allocated in chunks of this many, which never move once allocated
+#define BOAT_WALLET_CHUNK_LEN 256
+
 //!@brief BoAT IoT SDK Context
 typedef struct TBoatIotSdkContext
 {
     // Protocol specifiec properties are defined in protocol specific WalletInfo structure
-    BoatWalletList wallet_list[BOAT_MAX_WALLET_NUM];  //!< Wallet Info List
+    BoatWalletList *wallet_chunk_list[BOAT_MAX_WALLET_CAPACITY / BOAT_WALLET_CHUNK_LEN]; //!< Wallet Info List in chunks, indexed by wallet index
+    BUINT32 wallet_chunk_len;     //!< Entries per chunk
+    BUINT32 wallet_list_len;      //!< Allocated entries of all chunks, grows up to <wallet_capacity>
+    BUINT32 wallet_capacity;      //!< Maximum number of loaded wallets
+    BUINT32 wallet_num;           //!< Number of loaded wallets
+    BSINT32 free_index;           //!< Head of the free wallet index list, -1 if empty
+
+    // Open addressing hash table from persistent wallet name to wallet index
+    BSINT32 *name_table;          //!< Wallet index, or one of the BOAT_WALLET_NAME_SLOT values
+    BUINT32 name_table_len;       //!< Power of 2
+    BUINT32 name_used_num;        //!< Slots holding an index or a removed mark
 }BoatIotSdkContext;
 
 
@@ -90,6 +108,61 @@ Function: BoatIotSdkInit()
 BOAT_RESULT BoatIotSdkInit(void);
 
 
+/*!*****************************************************************************
+@brief Initialize Boat IoT SDK with a given wallet capacity
+
+Function: BoatIotSdkInitWithCapacity()
+
+    This function is the same as BoatIotSdkInit(), except that up to
+    <max_wallet_num> wallets can be loaded at the same time instead of
+    BOAT_MAX_WALLET_NUM.
+
+    The wallet registry grows on demand, so a large capacity costs no memory
+    until the wallets are loaded. Creating, looking up and unloading a wallet
+    take constant time regardless of the capacity.
+
+@see BoatIotSdkInit() BoatIotSdkDeInit()
+
+@return
+    This function returns BOAT_SUCCESS if initialization is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] max_wallet_num
+    Maximum number of loaded wallets, 1 ~ BOAT_MAX_WALLET_CAPACITY.
+*******************************************************************************/
+BOAT_RESULT BoatIotSdkInitWithCapacity(BUINT32 max_wallet_num);
+
+
+/*!*****************************************************************************
+@brief Initialize Boat IoT SDK with a given wallet capacity and allocator
+
+Function: BoatIotSdkInitWithAllocator()
+
+    This function is the same as BoatIotSdkInitWithCapacity(), except that all
+    memory of the SDK is allocated from <allocator_ptr> instead of the default
+    allocator. Temporary memory of sending a transaction is taken from a
+    per-thread arena in chunks of BOAT_TX_ARENA_CHUNK_SIZE bytes, which are
+    allocated from <allocator_ptr> as well.
+
+    The allocator is kept after BoatIotSdkDeInit(), until the SDK is initialized
+    again.
+
+@see BoatIotSdkInitWithCapacity() BoatSetAllocator()
+
+@return
+    This function returns BOAT_SUCCESS if initialization is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] max_wallet_num
+    Maximum number of loaded wallets, 1 ~ BOAT_MAX_WALLET_CAPACITY.
+
+@param[in] allocator_ptr
+    The allocator, whose functions MUST be thread-safe. If NULL, the default\n
+    allocator is used, see BoatSetAllocator().
+*******************************************************************************/
+BOAT_RESULT BoatIotSdkInitWithAllocator(BUINT32 max_wallet_num, const BoatAllocator *allocator_ptr);
+
+
 /*!*****************************************************************************
 @brief De-initialize BoAT IoT SDK
 
@@ -185,8 +258,11 @@ Function: BoatWalletUnload()
     delete it from non-volatile memory. To delete a persistent wallet from
     non-volatile memory, call BoatWalletDelete().
 
+    If the wallet is referenced by BoatWalletAcquire(), it's no longer found by
+    index or name, but it's de-initialized by the last BoatWalletRelease().
+
 
-@see BoatWalletCreate() BoatWalletDelete()
+@see BoatWalletCreate() BoatWalletDelete() BoatWalletRelease()
 
 @return This function doesn't return any thing.
 
@@ -218,6 +294,46 @@ Function: BoatWalletDelete()
 void BoatWalletDelete(BCHAR * wallet_name_str);
 
 
+/*!*****************************************************************************
+@brief Evict a wallet from the wallet cache
+
+Function: BoatWalletCacheEvict()
+
+    BoatWalletCreate() keeps the decrypted configuration of recently loaded
+    persistent wallets in memory (see BOAT_WALLET_CACHE_SIZE in boatoptions.h),
+    so that loading them again doesn't read the persistent storage.
+
+    This function wipes the cached configuration of a persistent wallet. The
+    next BoatWalletCreate() for this wallet reads its persistent storage again.
+    A loaded wallet is not affected. BoatWalletDelete() evicts the wallet as well.
+
+@see BoatWalletCacheClear() BoatWalletCreate()
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_name_str
+    The wallet name to evict.
+
+*******************************************************************************/
+void BoatWalletCacheEvict(const BCHAR *wallet_name_str);
+
+
+/*!*****************************************************************************
+@brief Evict all wallets from the wallet cache
+
+Function: BoatWalletCacheClear()
+
+    This function wipes all cached wallet configurations, e.g. before the
+    device goes idle. Loaded wallets are not affected.
+
+@see BoatWalletCacheEvict()
+
+@return This function doesn't return any thing.
+
+*******************************************************************************/
+void BoatWalletCacheClear(void);
+
+
 /*!*****************************************************************************
 @brief Get the BoAT wallet context by index.
 
@@ -235,6 +351,71 @@ Function: BoatGetWalletByIndex()
 void * BoatGetWalletByIndex(BSINT32 wallet_index);
 
 
+/*!*****************************************************************************
+@brief Take a reference to a loaded wallet
+
+Function: BoatWalletAcquire()
+
+    This function gets the BoAT wallet context by index like
+    BoatGetWalletByIndex() and takes a reference to it. A referenced wallet is
+    not de-initialized until the reference is released, even if another thread
+    unloads it meanwhile.
+
+    A thread that uses a wallet which another thread may unload MUST hold a
+    reference while using it.
+
+@see BoatWalletRelease() BoatWalletUnload()
+
+@return
+    This function returns a pointer to the wallet context.\n
+    It returns NULL if the wallet is not loaded, and no reference is taken.
+
+@param[in] wallet_index
+    The wallet index.
+
+*******************************************************************************/
+void * BoatWalletAcquire(BSINT32 wallet_index);
+
+
+/*!*****************************************************************************
+@brief Release a reference to a wallet
+
+Function: BoatWalletRelease()
+
+    This function releases a reference taken by BoatWalletAcquire(). The last
+    reference to an unloaded wallet de-initializes it.
+
+@see BoatWalletAcquire()
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_index
+    The wallet index passed to BoatWalletAcquire().
+
+*******************************************************************************/
+void BoatWalletRelease(BSINT32 wallet_index);
+
+
+/*!*****************************************************************************
+@brief Get the index of a loaded persistent wallet by name.
+
+Function: BoatGetWalletIndexByName()
+
+    This function gets the index of a loaded persistent wallet. If the wallet
+    is loaded more than once, the index of the last loaded one is returned.
+
+
+@return
+    This function returns the non-negative index of the wallet.\n
+    It returns -1 if no persistent wallet with the given name is loaded.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+*******************************************************************************/
+BSINT32 BoatGetWalletIndexByName(const BCHAR *wallet_name_str);
+
+
 #ifdef __cplusplus
 }
 #endif /* end of __cplusplus */
@@ -25,8 +25,13 @@ api_ethereum.h is header file for BoAT IoT SDK ethereum's interface.
 
 #include "boatiotsdk.h"
 
+#include <pthread.h>
+
 #define BOAT_ETH_ADDRESS_SIZE 20
 
+//!@brief Maximum number of accounts per wallet, see BoatEthWalletAddAccount()
+#define BOAT_ETH_MAX_ACCOUNT_NUM 8
+
 
 
 //!@brief Account information
@@ -38,6 +43,7 @@ typedef struct TBoatEthAccountInfo
     BUINT8 priv_key_array[32]; //!< Private key of the account.
     BUINT8 pub_key_array[64];  //!< Public key of the account
     BUINT8 address[BOAT_ETH_ADDRESS_SIZE];        //!< Account address calculated from prublic key
+    BUINT32 ref_num;           //!< References taken by BoatEthWalletAcquireAccount()
 }BoatEthAccountInfo;
 
 
@@ -67,14 +73,23 @@ typedef struct TBoatEthNetworkInfo
 //!@brief Wallet information
 
 //! Wallet information consists of account and block chain network information.
-//! Currently only one account per wallet is supported.
+//! A wallet has up to BOAT_ETH_MAX_ACCOUNT_NUM accounts sharing the network.
+//! Account 0 is the account of the wallet configuration. Further accounts are
+//! added by BoatEthWalletAddAccount() and are not persistent.
 typedef struct TBoatEthWallet
 {
-    BoatEthAccountInfo account_info; //!< Account information
+    BoatEthAccountInfo account_info; //!< Account information of account 0
     BoatEthNetworkInfo network_info; //!< Network information
 
-    // Ethereum wallet internal members. DO NOT access them from outside wallet protocol.
-    struct TWeb3IntfContext *web3intf_context_ptr;  //!< Web3 Interface Context
+    //! Accounts 1 ~ BOAT_ETH_MAX_ACCOUNT_NUM - 1 by index - 1, NULL if not added.
+    //! Use BoatEthWalletGetAccount() or BoatEthWalletAcquireAccount() to get any account by index.
+    BoatEthAccountInfo *added_account_ptr_array[BOAT_ETH_MAX_ACCOUNT_NUM - 1];
+    BUINT32 selected_account_index;  //!< Signing account of new transactions, see BoatEthWalletSelectAccount()
+    pthread_mutex_t account_lock;    //!< Guards the accounts and their references
+    pthread_cond_t account_cond;     //!< Signalled when the last reference to an account is released
+
+    // Web3 interface contexts are per thread (web3_thread_context()), so that
+    // a wallet can be used by many threads at the same time.
 }BoatEthWallet;
 
 
@@ -148,6 +163,7 @@ typedef struct TBoatEthTx
     BoatEthWallet *wallet_ptr; //!< Wallet pointer the transaction is combined with
     BoatFieldMax32B tx_hash;   //!< Transaction hash returned from network
     BBOOL is_sync_tx;          //!< True to perform a synchronous transaction (wait for getting mined), False for asynchronous transaction
+    BUINT32 account_index;     //!< Index of the signing account in the wallet, see BoatEthTxSetAccount()
 
     // <rawtx_field> MUST be the last member in this struct to allow inheritance
     BoatEthRawtxFields rawtx_fields;       //!< RAW transaction fields
@@ -317,6 +333,10 @@ Function: BoatEthWalletSetPrivkey()
     private key. The public key is calculated by co-sign algorithm with the
     co-sign server.
 
+    The key is replaced once no reference to account 0 taken by
+    BoatEthWalletAcquireAccount() is held, i.e. after transactions being
+    signed by it are signed. Don't call it while holding such a reference.
+
     NOTE: Be very careful to PROTECT the private key.
 
 @see
@@ -421,6 +441,214 @@ Function: BoatEthWalletGetBalance()
 BCHAR * BoatEthWalletGetBalance(BoatEthWallet *wallet_ptr, BCHAR *alt_address_ptr);
 
 
+/*!*****************************************************************************
+@brief Get Balance of the wallet account in wei
+
+Function: BoatEthWalletGetBalanceUint256()
+
+    This function gets the balance of the wallet account from network, as
+    BoatEthWalletGetBalance() does, and parses it to a 256-bit integer in wei.
+    Compare it with UtilityUint256Compare() and format it with
+    UtilityWeiToEthStr() without losing any wei.
+
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] alt_address_str
+    A string representing which address to get balance from.
+    If NULL, get balance of the selected account of the wallet.\n
+    Otherwise, get balance of the specified altered address, in HEX format like\n
+    "0x19c91A4649654265823512a457D2c16981bB64F5".
+
+@param[out] balance_ptr
+    The balance in wei.
+
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletGetBalanceUint256(BoatEthWallet *wallet_ptr,
+                                           BCHAR *alt_address_str,
+                                           BOAT_OUT BUINT256 *balance_ptr);
+
+
+/*!*****************************************************************************
+@brief Add an account to the wallet
+
+Function: BoatEthWalletAddAccount()
+
+    This function adds an account with given private key to the wallet. All
+    accounts of a wallet share its network information, so a device with
+    several identities on the same network needs only one wallet.
+
+    Added accounts are NOT saved with a persistent wallet. They're wiped when
+    the wallet is unloaded.
+
+    This function may be called while other threads use the wallet.
+
+@see BoatEthWalletRemoveAccount() BoatEthWalletSelectAccount() BoatEthTxSetAccount()
+
+@return
+    This function returns the index of the account, 1 ~ BOAT_ETH_MAX_ACCOUNT_NUM - 1.\n
+    If the account is already in the wallet, its index is returned.\n
+    Otherwise it returns one of the error codes, which are negative.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] priv_key_array
+    Private key of the account.
+        
+*******************************************************************************/
+BSINT32 BoatEthWalletAddAccount(BoatEthWallet *wallet_ptr, const BUINT8 priv_key_array[32]);
+
+
+/*!*****************************************************************************
+@brief Remove an account from the wallet
+
+Function: BoatEthWalletRemoveAccount()
+
+    This function removes an account added by BoatEthWalletAddAccount() and
+    wipes its private key. Account 0 cannot be removed. If the account is
+    selected, account 0 is selected instead. Its index may be reused by a
+    later BoatEthWalletAddAccount().
+
+    Transactions being signed by the account in other threads are finished
+    first: this function waits until every reference taken by
+    BoatEthWalletAcquireAccount() is released. Hence it MUST NOT be called by
+    a thread holding a reference to the account.
+
+@return
+    This function returns BOAT_SUCCESS if the account is removed.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account to remove.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletRemoveAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index);
+
+
+/*!*****************************************************************************
+@brief Select the default account of the wallet
+
+Function: BoatEthWalletSelectAccount()
+
+    This function selects the account which BoatEthTxInit() uses to sign new
+    transactions and BoatEthWalletGetBalance() queries by default. Account 0
+    is selected when the wallet is created.
+
+@see BoatEthWalletFindAccount() BoatEthTxSetAccount()
+
+@return
+    This function returns BOAT_SUCCESS if the account is selected.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account to select.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletSelectAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index);
+
+
+/*!*****************************************************************************
+@brief Find an account of the wallet by address
+
+Function: BoatEthWalletFindAccount()
+
+@return
+    This function returns the index of the account with given address.\n
+    If the wallet has no such account, it returns BOAT_ERROR.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] address
+    Address of the account to find.
+        
+*******************************************************************************/
+BSINT32 BoatEthWalletFindAccount(BoatEthWallet *wallet_ptr, const BUINT8 address[BOAT_ETH_ADDRESS_SIZE]);
+
+
+/*!*****************************************************************************
+@brief Get an account of the wallet by index
+
+Function: BoatEthWalletGetAccount()
+
+    This function takes no reference to the account. An added account may be
+    removed by another thread while the returned pointer is in use, and the
+    key of account 0 may be replaced by BoatEthWalletSetPrivkey(). Use
+    BoatEthWalletAcquireAccount() in that case.
+
+@return
+    This function returns the account information.\n
+    If the wallet has no account with given index, it returns NULL.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account.
+        
+*******************************************************************************/
+BoatEthAccountInfo * BoatEthWalletGetAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index);
+
+
+/*!*****************************************************************************
+@brief Take a reference to an account of the wallet
+
+Function: BoatEthWalletAcquireAccount()
+
+    This function gets an account like BoatEthWalletGetAccount() and keeps it
+    from being freed by BoatEthWalletRemoveAccount() until the reference is
+    released by BoatEthWalletReleaseAccount().
+
+@see BoatEthWalletReleaseAccount()
+
+@return
+    This function returns the account information.\n
+    If the wallet has no account with given index, it returns NULL.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account.
+        
+*******************************************************************************/
+BoatEthAccountInfo * BoatEthWalletAcquireAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index);
+
+
+/*!*****************************************************************************
+@brief Release a reference to an account of the wallet
+
+Function: BoatEthWalletReleaseAccount()
+
+    This function releases a reference taken by BoatEthWalletAcquireAccount().
+
+@see BoatEthWalletAcquireAccount()
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_ptr
+    The account returned by BoatEthWalletAcquireAccount().
+        
+*******************************************************************************/
+void BoatEthWalletReleaseAccount(BoatEthWallet *wallet_ptr, BoatEthAccountInfo *account_ptr);
+
+
 /*!*****************************************************************************
 @brief Prase RPC method RESPONSE
 
@@ -534,6 +762,34 @@ BOAT_RESULT BoatEthTxSetNonce(BoatEthTx *tx_ptr, BUINT64 nonce);
 #define BOAT_ETH_NONCE_AUTO 0xFFFFFFFFFFFFFFFF
 
 
+/*!*****************************************************************************
+@brief Set Transaction Parameter: Signing Account
+
+Function: BoatEthTxSetAccount()
+
+    This function sets the wallet account that signs the transaction and whose
+    transaction count is the nonce. BoatEthTxInit() sets the selected account
+    of the wallet.
+
+    Call this function before BoatEthTxSetNonce(), or before BoatEthTransfer()
+    and BoatEthTxSend() in case the nonce is obtained from network by them.
+
+@see BoatEthWalletSelectAccount()
+
+@return
+    This function returns BOAT_SUCCESS if setting is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] tx_ptr
+    The pointer to the transaction.
+
+@param[in] account_index
+    Index of the signing account in the wallet of the transaction.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthTxSetAccount(BoatEthTx *tx_ptr, BUINT32 account_index);
+
+
 /*!*****************************************************************************
 @brief Set Transaction Parameter: GasPrice
 
@@ -625,6 +881,30 @@ Function: BoatEthTxSetValue()
 BOAT_RESULT BoatEthTxSetValue(BoatEthTx *tx_ptr, BoatFieldMax32B *value_ptr);
 
 
+/*!*****************************************************************************
+@brief Set Transaction Parameter: Transaction Value in 256-bit integer
+
+Function: BoatEthTxSetValueUint256()
+
+    This function sets the value of the transaction from a 256-bit integer in
+    wei, trimming its leading zeros as RLP encoding requires.
+
+
+@return
+    This function returns BOAT_SUCCESS if setting is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] tx_ptr
+    Pointer to the transaction structure.    
+
+@param[in] value_ptr
+    The value of the transaction in wei.\n
+    If <value_ptr> is NULL, it's treated as no value being transfered.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthTxSetValueUint256(BoatEthTx *tx_ptr, const BUINT256 *value_ptr);
+
+
 /*!*****************************************************************************
 @brief Set Transaction Parameter: Data
 
@@ -89,6 +89,7 @@ typedef struct TBoatPlatoneTx
     BoatPlatoneWallet *wallet_ptr; //!< Wallet pointer the transaction is combined with
     BoatFieldMax32B tx_hash;       //!< Transaction hash returned from network
     BBOOL is_sync_tx;              //!< True to perform a synchronous transaction (wait for getting mined), False for asynchronous transaction
+    BUINT32 account_index;         //!< Index of the signing account in the wallet, see BoatPlatoneTxSetAccount()
 
     // rawtx_fields MUST be the last field
     BoatPlatoneRawtxFields rawtx_fields;      //!< RAW transaction fields
@@ -368,6 +369,41 @@ __BOATSTATIC __BOATINLINE BCHAR * BoatPlatoneWalletGetBalance(BoatPlatoneWallet
     return BoatEthWalletGetBalance((BoatEthWallet *)wallet_ptr, alt_address_str);
 }
 
+//!@brief Get Balance in wei
+//!@see BoatEthWalletGetBalanceUint256()
+__BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneWalletGetBalanceUint256(BoatPlatoneWallet *wallet_ptr, BCHAR *alt_address_str, BOAT_OUT BUINT256 *balance_ptr)
+{
+    return BoatEthWalletGetBalanceUint256((BoatEthWallet *)wallet_ptr, alt_address_str, balance_ptr);
+}
+
+//!@brief Add Account
+//!@see BoatEthWalletAddAccount()
+__BOATSTATIC __BOATINLINE BSINT32 BoatPlatoneWalletAddAccount(BoatPlatoneWallet *wallet_ptr, const BUINT8 priv_key_array[32])
+{
+    return BoatEthWalletAddAccount((BoatEthWallet *)wallet_ptr, priv_key_array);
+}
+
+//!@brief Remove Account
+//!@see BoatEthWalletRemoveAccount()
+__BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneWalletRemoveAccount(BoatPlatoneWallet *wallet_ptr, BUINT32 account_index)
+{
+    return BoatEthWalletRemoveAccount((BoatEthWallet *)wallet_ptr, account_index);
+}
+
+//!@brief Select Account
+//!@see BoatEthWalletSelectAccount()
+__BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneWalletSelectAccount(BoatPlatoneWallet *wallet_ptr, BUINT32 account_index)
+{
+    return BoatEthWalletSelectAccount((BoatEthWallet *)wallet_ptr, account_index);
+}
+
+//!@brief Find Account
+//!@see BoatEthWalletFindAccount()
+__BOATSTATIC __BOATINLINE BSINT32 BoatPlatoneWalletFindAccount(BoatPlatoneWallet *wallet_ptr, const BUINT8 address[BOAT_PLATONE_ADDRESS_SIZE])
+{
+    return BoatEthWalletFindAccount((BoatEthWallet *)wallet_ptr, address);
+}
+
 
 
 #define BOAT_PLATONE_NONCE_AUTO BOAT_ETH_NONCE_AUTO
@@ -378,6 +414,13 @@ __BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetNonce(BoatPlatoneTx *tx_pt
     return BoatEthTxSetNonce((BoatEthTx *)tx_ptr, nonce);
 }
 
+//!@brief Set Account
+//!@see BoatEthTxSetAccount()
+__BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetAccount(BoatPlatoneTx *tx_ptr, BUINT32 account_index)
+{
+    return BoatEthTxSetAccount((BoatEthTx *)tx_ptr, account_index);
+}
+
 //!@brief Set GasPrice
 //!@see BoatEthTxSetGasPrice()
 __BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetGasPrice(BoatPlatoneTx *tx_ptr, BoatFieldMax32B *gas_price_ptr)
@@ -406,6 +449,13 @@ __BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetValue(BoatPlatoneTx *tx_pt
     return BoatEthTxSetValue((BoatEthTx *)tx_ptr,value_ptr);
 }
 
+//!@brief Set Value in 256-bit integer
+//!@see BoatEthTxSetValueUint256()
+__BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetValueUint256(BoatPlatoneTx *tx_ptr, const BUINT256 *value_ptr)
+{
+    return BoatEthTxSetValueUint256((BoatEthTx *)tx_ptr, value_ptr);
+}
+
 //!@brief Set Data
 //!@see BoatEthTxSetData()
 __BOATSTATIC __BOATINLINE BOAT_RESULT BoatPlatoneTxSetData(BoatPlatoneTx *tx_ptr, BoatFieldVariable *data_ptr)
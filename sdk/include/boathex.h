@@ -0,0 +1,60 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Bulk HEX conversion
+
+@file
+boathex.h declares the bulk HEX conversion kernels of UtilityBin2Hex() and
+UtilityHex2Bin(), which handle the "0x" prefix and zero trimming themselves and
+leave everything in between to BoatHexEncode() and BoatHexDecode().
+
+With BOAT_HEX_USE_SIMD set to 1, the kernel is the widest one the CPU supports:
+AVX2, SSSE3 or SSE2 on x86, detected at runtime with GCC or Clang, and NEON on
+AArch64. Otherwise, or for the tail shorter than a vector, the portable kernel
+converts a byte at a time.
+*/
+
+#ifndef __BOATHEX_H__
+#define __BOATHEX_H__
+
+#include "boatinternal.h"
+
+//!@brief HEX conversion kernels
+typedef enum
+{
+    BOAT_HEX_KERNEL_PORTABLE = 0, //!< A byte at a time
+    BOAT_HEX_KERNEL_SSE2,         //!< 16 bytes at a time with SSE2 arithmetic
+    BOAT_HEX_KERNEL_SSSE3,        //!< 16 bytes at a time with PSHUFB lookup
+    BOAT_HEX_KERNEL_AVX2,         //!< 32 bytes at a time with VPSHUFB lookup
+    BOAT_HEX_KERNEL_NEON,         //!< 16 bytes at a time with TBL lookup
+    BOAT_HEX_KERNEL_NUM
+}BoatHexKernel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void BoatHexEncode(BOAT_OUT BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len);
+BBOOL BoatHexDecode(BOAT_OUT BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len);
+
+BOAT_RESULT BoatHexSetKernel(BoatHexKernel kernel);
+BoatHexKernel BoatHexGetKernel(void);
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
@@ -0,0 +1,57 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Static block pools
+
+@file
+boatstaticpool.h declares the internal interface of the static block pools.
+
+With BOAT_USE_STATIC_POOL set to 1, the default allocator of BoatMalloc() takes
+fixed size blocks from BOAT_STATIC_POOL_NUM statically allocated pools, whose
+block sizes and numbers are configured in boatoptions.h. Every pool keeps a
+free list guarded by its own lock, so allocation and de-allocation take
+constant time and never fragment.
+
+The public statistics API, BoatStaticPoolGetStats(), is declared in
+boatutility.h.
+
+BoatDefaultMalloc() and BoatDefaultFree() are the built-in allocator, i.e. the
+static pools or the C heap, for memory that must not depend on the allocator
+set by BoatSetAllocator().
+*/
+
+#ifndef __BOATSTATICPOOL_H__
+#define __BOATSTATICPOOL_H__
+
+#include "boatinternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *BoatDefaultMalloc(BUINT32 size);
+void BoatDefaultFree(void *mem_ptr);
+
+#if BOAT_USE_STATIC_POOL == 1
+void *BoatStaticPoolMalloc(BUINT32 size);
+void BoatStaticPoolFree(void *mem_ptr);
+#endif /* end of BOAT_USE_STATIC_POOL */
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
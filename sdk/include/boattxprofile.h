@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Transaction phase timers
+
+@file
+boattxprofile.h declares the timers of the phases of sending a transaction.
+
+A phase is timed as:
+
+    BOAT_TX_PROFILE_DECLARE(profile_start);
+    ...
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+    <the phase>
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_KECCAK, profile_start);
+
+With BOAT_TX_PROFILING set to 0 the macros expand to nothing. Otherwise the
+latency is recorded into the lock-free histogram of the phase. The query API,
+BoatTxProfileGetHistogram(), is declared in boatutility.h.
+*/
+
+#ifndef __BOATTXPROFILE_H__
+#define __BOATTXPROFILE_H__
+
+#include "boatinternal.h"
+
+#if BOAT_TX_PROFILING == 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BUINT64 BoatTxProfileNow(void);
+void BoatTxProfileRecord(BoatTxPhase phase, BUINT64 elapsed_ns);
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#define BOAT_TX_PROFILE_DECLARE(start) BUINT64 start = 0
+#define BOAT_TX_PROFILE_BEGIN(start) ((start) = BoatTxProfileNow())
+#define BOAT_TX_PROFILE_END(phase, start) BoatTxProfileRecord((phase), BoatTxProfileNow() - (start))
+
+#else
+
+#define BOAT_TX_PROFILE_DECLARE(start)
+#define BOAT_TX_PROFILE_BEGIN(start)
+#define BOAT_TX_PROFILE_END(phase, start)
+
+#endif /* end of BOAT_TX_PROFILING */
+
+#endif
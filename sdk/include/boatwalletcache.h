@@ -0,0 +1,67 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Cache of decrypted persistent wallet configurations
+
+@file
+boatwalletcache.h declares the internal interface of the wallet cache.
+
+BoatWalletCreate() keeps the decrypted configuration and the public key of
+recently loaded persistent wallets in a least recently used cache keyed by
+wallet name. Loading a cached wallet again skips reading and decrypting the
+persistent storage as well as deriving the public key.
+
+Configurations contain private keys. They're kept in memory locked against
+swapping and wiped on eviction. The cache size is BOAT_WALLET_CACHE_SIZE.
+
+The public eviction API, BoatWalletCacheEvict() and BoatWalletCacheClear(),
+is declared in boatwallet.h.
+*/
+
+#ifndef __BOATWALLETCACHE_H__
+#define __BOATWALLETCACHE_H__
+
+#include "boatinternal.h"
+
+//!@brief Configurations larger than this are not cached
+#define BOAT_WALLET_CACHE_MAX_CONFIG_SIZE 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BOAT_RESULT BoatWalletCacheInit(void);
+void BoatWalletCacheDeInit(void);
+
+BOAT_RESULT BoatWalletCacheGet(const BCHAR *wallet_name_str,
+                               BoatProtocolType protocol_type,
+                               BOAT_OUT void *wallet_config_ptr,
+                               BUINT32 wallet_config_size,
+                               BOAT_OUT BUINT8 pub_key_array[64],
+                               BOAT_OUT BBOOL *has_pub_key_ptr);
+
+void BoatWalletCachePut(const BCHAR *wallet_name_str,
+                        BoatProtocolType protocol_type,
+                        const void *wallet_config_ptr,
+                        BUINT32 wallet_config_size,
+                        const BUINT8 *pub_key_ptr);
+
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif
@@ -21,8 +21,12 @@ ethereum.c contains functions to construct a raw transaction, serialize it with
 perform it and wait for its receipt.
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_TX
+
 #include "boatinternal.h"
 #include "web3intf.h"
+#include "boatsigner.h"
+#include "boattxprofile.h"
 #include "boatethereum.h"
 
 
@@ -32,12 +36,14 @@ perform it and wait for its receipt.
 
 
 /*!*****************************************************************************
-@brief Construct a raw ethereum transacton asynchronously.
+@brief Construct and sign a raw ethereum transacton.
 
-Function: EthSendRawtx()
+Function: EthSignRawtx()
 
-    This function constructs a raw transacton and sends it asynchronously (i.e.
-    don't wait for it being mined).
+    This function constructs a raw transacton and signs it with the account of
+    the wallet the transaction is combined with. It doesn't access the network
+    and only reads the wallet, thus different transactions may be signed
+    concurrently (see boatsignpool.h).
     
     AN INTRODUCTION OF HOW RAW TRANSACTION IS CONSTRUCTED
     
@@ -111,14 +117,16 @@ Function: EthSendRawtx()
     
 
 @param[in] tx_ptr
-        A pointer to the context of the transaction.
+        A pointer to the context of the transaction. Its v/r/s fields are updated.
+
+@param[out] signed_tx_ptr
+        The RLP encoded signed transaction. The caller MUST free\n
+        <signed_tx_ptr->field_ptr> with BoatFree() on success.
 
 *******************************************************************************/
-BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
+BOAT_RESULT EthSignRawtx(BOAT_INOUT BoatEthTx *tx_ptr, BOAT_OUT BoatFieldVariable *signed_tx_ptr)
 {
     unsigned int chain_id_len;
-        
-    BCHAR *tx_hash_str;
 
     RlpObject tx_rlp_object;
     RlpObject nonce_rlp_object;
@@ -137,40 +145,39 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     
     RlpEncodedStreamObject *rlp_stream_storage_ptr;
 
-    
-    BCHAR *rlp_stream_hex_str = NULL;    // Storage for RLP stream HEX string for use with web3 interface
+    BoatEthAccountInfo *account_ptr;
 
-    
     BUINT8 message_digest[32];
     BUINT8 sig_parity;
     BUINT32 v;
 
-    Param_eth_sendRawTransaction param_eth_sendRawTransaction;
-
 #ifdef DEBUG_LOG  
     BUINT32 i;
 #endif
 
+    BOAT_TX_PROFILE_DECLARE(profile_start);
+
     BOAT_RESULT result;
     boat_try_declare;
 
 
     
-    if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
+    if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL || signed_tx_ptr == NULL )
     {
-        BoatLog(BOAT_LOG_NORMAL, "Transaction and wallet pointer cannot be null.");
-        boat_throw(BOAT_ERROR_INVALID_ARGUMENT, EthSendRawtx_cleanup);
+        BoatLog(BOAT_LOG_NORMAL, "Transaction, wallet and output pointer cannot be null.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
     }
 
-    // In case the transaction should fail, tx_hash.field_len is initialized to 0
-    tx_ptr->tx_hash.field_len = 0;
-    
-    
+    signed_tx_ptr->field_ptr = NULL;
+    signed_tx_ptr->field_len = 0;
+
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+
     result = RlpInitListObject(&tx_rlp_object);
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize Tx RLP objecte.");
-        boat_throw(BOAT_ERROR_OUT_OF_MEMORY, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_OUT_OF_MEMORY, EthSignRawtx_cleanup);
     }
     
 
@@ -190,14 +197,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize nonce RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
   
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &nonce_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append nonce to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
     // Encode gasprice
@@ -207,14 +214,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize gasprice RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &gasprice_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append gasprice to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
     
@@ -225,14 +232,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize gaslimit RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &gaslimit_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append gaslimit to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     
@@ -243,14 +250,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize recipient RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &recipient_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append recipient to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -261,14 +268,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize value RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &value_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append value to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -279,14 +286,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to initialize data RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     result = RlpEncoderAppendObjectToList(&tx_rlp_object, &data_rlp_object);
     if( result < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to append data to Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -316,14 +323,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
         if( result != BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to initialize v RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
         
         v_index = RlpEncoderAppendObjectToList(&tx_rlp_object, &v_rlp_object);
         if( v_index < BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to append v to Tx RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
         
 
@@ -335,14 +342,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
         if( result != BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to initialize r RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
         
         r_index = RlpEncoderAppendObjectToList(&tx_rlp_object, &r_rlp_object);
         if( r_index < BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to append r to Tx RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
 
 
@@ -353,14 +360,14 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
         if( result != BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to initialize s RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
         
         s_index = RlpEncoderAppendObjectToList(&tx_rlp_object, &s_rlp_object);
         if( s_index < BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to append s to Tx RLP object.");
-            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+            boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
         }
 
     }
@@ -386,9 +393,10 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     else
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to encode Tx.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
-    
+
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_RLP_ENCODE, profile_start);
 
 
 
@@ -397,7 +405,9 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     **************************************************************************/
 
     // Hash the message
+    BOAT_TX_PROFILE_BEGIN(profile_start);
     keccak_256(rlp_stream_storage_ptr->stream_ptr, rlp_stream_storage_ptr->stream_len, message_digest);
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_KECCAK, profile_start);
 
 
 
@@ -405,15 +415,30 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     * STEP 3: Sign the transaction                                            *
     **************************************************************************/
 
-    // Sign the transaction
-    ecdsa_sign_digest(
-                       &secp256k1, // const ecdsa_curve *curve
-                       tx_ptr->wallet_ptr->account_info.priv_key_array, //const uint8_t *priv_key
-                       message_digest, //const uint8_t *digest
-                       tx_ptr->rawtx_fields.sig.sig64B, //uint8_t *sig,
-                       &sig_parity, //uint8_t *pby,
-                       NULL  //int (*is_canonical)(uint8_t by, uint8_t sig[64]))
-                       );
+    // Sign the transaction with its account, which isn't removed while it's referenced
+    account_ptr = BoatEthWalletAcquireAccount(tx_ptr->wallet_ptr, tx_ptr->account_index);
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No account %u in the wallet.", tx_ptr->account_index);
+        boat_throw(BOAT_ERROR_INVALID_ARGUMENT, EthSignRawtx_cleanup);
+    }
+
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+    result = BoatSignerSignDigest(
+                                  account_ptr->priv_key_array,
+                                  message_digest,
+                                  tx_ptr->rawtx_fields.sig.sig64B,
+                                  &sig_parity
+                                  );
+
+    BoatEthWalletReleaseAccount(tx_ptr->wallet_ptr, account_ptr);
+
+    if( result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to sign Tx.");
+        boat_throw(result, EthSignRawtx_cleanup);
+    }
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_SIGN, profile_start);
 
 
     // Trim r
@@ -453,6 +478,8 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     *         (See above description for details)                             *
     **************************************************************************/
 
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+
     // Re-encode v
     if( tx_ptr->wallet_ptr->network_info.eip155_compatibility == BOAT_TRUE )
     {
@@ -478,7 +505,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to re-initialize v RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
     if( tx_ptr->wallet_ptr->network_info.eip155_compatibility == BOAT_TRUE )
@@ -493,7 +520,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( v_index < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to replace v in Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -506,7 +533,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to re-initialize r RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
     
     if( tx_ptr->wallet_ptr->network_info.eip155_compatibility == BOAT_TRUE )
@@ -521,7 +548,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( r_index < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to replace r in Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -533,7 +560,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( result != BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to re-initialize s RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
     if( tx_ptr->wallet_ptr->network_info.eip155_compatibility == BOAT_TRUE )
@@ -548,7 +575,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     if( s_index < BOAT_SUCCESS )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to replace s in Tx RLP object.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
     }
 
 
@@ -574,15 +601,98 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
     else
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to re-encode Tx.");
-        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSendRawtx_cleanup);
+        boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, EthSignRawtx_cleanup);
+    }
+
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_RLP_REENCODE, profile_start);
+
+    // Take over the encoded stream so that it survives the RLP object deletion
+    signed_tx_ptr->field_ptr = rlp_stream_storage_ptr->stream_ptr;
+    signed_tx_ptr->field_len = rlp_stream_storage_ptr->stream_len;
+    rlp_stream_storage_ptr->stream_ptr = NULL;
+    rlp_stream_storage_ptr->stream_len = 0;
+
+    result = BOAT_SUCCESS;
+
+    // Clean Up
+
+    boat_catch(EthSignRawtx_cleanup)
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Exception: %d", boat_exception);
+        result = boat_exception;
     }
+
+    // Free RLP Objects
+    RlpRecursiveDeleteObject(&tx_rlp_object);
+
+    return result;
+}
+
+
+
+/*!*****************************************************************************
+@brief Construct a raw ethereum transacton asynchronously.
+
+Function: EthSendRawtx()
+
+    This function constructs a raw transacton with EthSignRawtx() and sends it
+    asynchronously (i.e. don't wait for it being mined).
+
+
+@return
+    This function returns BOAT_SUCCESS if successful. Otherwise it returns one\n
+    of the error codes.
+    
+
+@param[in] tx_ptr
+        A pointer to the context of the transaction.
+
+*******************************************************************************/
+BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
+{
+    BCHAR *tx_hash_str;
+
+    BoatFieldVariable signed_tx = {NULL, 0};
     
+    BCHAR *rlp_stream_hex_str = NULL;    // Storage for RLP stream HEX string for use with web3 interface
+
+    Param_eth_sendRawTransaction param_eth_sendRawTransaction;
+    Web3IntfContext *web3intf_context_ptr;
+
+    BOAT_TX_PROFILE_DECLARE(profile_start);
+
+    BOAT_RESULT result;
+    boat_try_declare;
+
+    // All temporary memory of the transaction is released at once on return
+    BoatTxArenaBegin();
+
+
+    if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Transaction and wallet pointer cannot be null.");
+        boat_throw(BOAT_ERROR_INVALID_ARGUMENT, EthSendRawtx_cleanup);
+    }
+
+    // In case the transaction should fail, tx_hash.field_len is initialized to 0
+    tx_ptr->tx_hash.field_len = 0;
+
+
+    /**************************************************************************
+    * STEP 1 - 4: Construct and sign the transaction                          *
+    **************************************************************************/
+
+    result = EthSignRawtx(tx_ptr, &signed_tx);
+    if( result != BOAT_SUCCESS )
+    {
+        boat_throw(result, EthSendRawtx_cleanup);
+    }
 
     // Allocate memory for RLP stream HEX string
     // It's a storage for HEX string converted from RLP stream binary. The
     // HEX string is used as input for web3. It's in a form of "0x1234ABCD".
     // Where *2 for binary to HEX conversion, +2 for "0x" prefix, + 1 for null terminator.
-    rlp_stream_hex_str = BoatMalloc(rlp_stream_storage_ptr->stream_len * 2 + 2 + 1);
+    rlp_stream_hex_str = BoatMalloc(signed_tx.field_len * 2 + 2 + 1);
 
     if( rlp_stream_hex_str == NULL )
     {
@@ -637,7 +747,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
 
     if( 0 == UtilityBin2Hex(
         rlp_stream_hex_str,
-        tx_ptr->wallet_ptr->account_info.address,
+        BoatEthWalletGetAccount(tx_ptr->wallet_ptr, tx_ptr->account_index)->address,
         20,
         BIN2HEX_LEFTTRIM_UNFMTDATA,
         BIN2HEX_PREFIX_0x_YES,
@@ -704,22 +814,30 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
 
 
 
+    BOAT_TX_PROFILE_BEGIN(profile_start);
     UtilityBin2Hex(
                 rlp_stream_hex_str,
-                rlp_stream_storage_ptr->stream_ptr,
-                rlp_stream_storage_ptr->stream_len,
+                signed_tx.field_ptr,
+                signed_tx.field_len,
                 BIN2HEX_LEFTTRIM_UNFMTDATA,
                 BIN2HEX_PREFIX_0x_YES,
                 BOAT_FALSE
                 );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_HEX_CONVERT, profile_start);
 
     param_eth_sendRawTransaction.signedtx_str = rlp_stream_hex_str;
     
-    tx_hash_str = web3_eth_sendRawTransaction( tx_ptr->wallet_ptr->web3intf_context_ptr,
+    web3intf_context_ptr = web3_thread_context();
+    if( web3intf_context_ptr == NULL )
+    {
+        boat_throw(BOAT_ERROR_OUT_OF_MEMORY, EthSendRawtx_cleanup);
+    }
+
+    tx_hash_str = web3_eth_sendRawTransaction( web3intf_context_ptr,
                                                tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                                &param_eth_sendRawTransaction);
 	result = BoatEthPraseRpcResponseResult( tx_hash_str, "", 
-											&tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf);
+											&web3intf_context_ptr->web3_result_string_buf);
 	if( result != BOAT_SUCCESS )
 	{
 		BoatLog(BOAT_LOG_NORMAL, "Fail to send raw transaction to network.");
@@ -730,7 +848,7 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
             UtilityHex2Bin(
                             tx_ptr->tx_hash.field,
                             32,
-                            (BCHAR*)tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf.field_ptr,
+                            (BCHAR*)web3intf_context_ptr->web3_result_string_buf.field_ptr,
                             TRIMBIN_TRIM_NO,
                             BOAT_FALSE
                            );
@@ -746,15 +864,20 @@ BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr)
         result = boat_exception;
     }
 
-    // Free RLP Objects
-    RlpRecursiveDeleteObject(&tx_rlp_object);
-    
+    // Free signed RLP stream
+    if( signed_tx.field_ptr != NULL )
+    {
+        BoatFree(signed_tx.field_ptr);
+    }
+
     // Free RLP hex string buffer
     if( rlp_stream_hex_str != NULL )
     {
         BoatFree(rlp_stream_hex_str);
     }
 
+    BoatTxArenaEnd();
+
     return result;
 
 }
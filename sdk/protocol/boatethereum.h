@@ -32,9 +32,12 @@ extern "C" {
 #endif
 
 
+BOAT_RESULT EthSignRawtx(BOAT_INOUT BoatEthTx *tx_ptr, BOAT_OUT BoatFieldVariable *signed_tx_ptr);
 BOAT_RESULT EthSendRawtx(BOAT_INOUT BoatEthTx *tx_ptr);
 BOAT_RESULT EthSendRawtxWithReceipt(BOAT_INOUT BoatEthTx *tx_ptr);
 
+BoatEthWallet * EthWalletInitWithPubkey(const BoatEthWalletConfig *config_ptr, BUINT32 config_size, const BUINT8 *pub_key_ptr);
+
 
 
 #ifdef __cplusplus
@@ -22,11 +22,15 @@ perform it and wait for its receipt.
 */
 
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_TX
+
 #include "boatinternal.h"
 
 #if PROTOCOL_USE_PLATONE == 1
 
 #include "web3intf.h"
+#include "boatsigner.h"
+#include "boattxprofile.h"
 #include "boatethereum.h"
 #include "boatplatone.h"
 
@@ -150,6 +154,8 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
     BCHAR *rlp_stream_hex_str = NULL;    // Storage for RLP stream HEX string for use with web3 interface
 
     
+    BoatEthAccountInfo *account_ptr;
+
     BUINT8 message_digest[32];
     BUINT8 sig_parity;
     BUINT32 v;
@@ -159,9 +165,14 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
 #ifdef DEBUG_LOG  
     BUINT32 i;
 #endif
+    BOAT_TX_PROFILE_DECLARE(profile_start);
+
     BOAT_RESULT result;
     boat_try_declare;
 
+    // All temporary memory of the transaction is released at once on return
+    BoatTxArenaBegin();
+
 
     
     if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
@@ -173,6 +184,7 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
     // In case the transaction should fail, tx_hash.field_len is initialized to 0
     tx_ptr->tx_hash.field_len = 0;
 
+    BOAT_TX_PROFILE_BEGIN(profile_start);
     
     result = RlpInitListObject(&tx_rlp_object);
     if( result != BOAT_SUCCESS )
@@ -427,7 +439,8 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
         BoatLog(BOAT_LOG_NORMAL, "Fail to encode Tx.");
         boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, PlatoneSendRawtx_cleanup);
     }
-    
+
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_RLP_ENCODE, profile_start);
 
 
 
@@ -436,7 +449,9 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
     **************************************************************************/
 
     // Hash the message
+    BOAT_TX_PROFILE_BEGIN(profile_start);
     keccak_256(rlp_stream_storage_ptr->stream_ptr, rlp_stream_storage_ptr->stream_len, message_digest);
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_KECCAK, profile_start);
 
 
 
@@ -444,15 +459,30 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
     * STEP 3: Sign the transaction                                            *
     **************************************************************************/
 
-    // Sign the transaction
-    ecdsa_sign_digest(
-                       &secp256k1, // const ecdsa_curve *curve
-                       tx_ptr->wallet_ptr->account_info.priv_key_array, //const uint8_t *priv_key
-                       message_digest, //const uint8_t *digest
-                       tx_ptr->rawtx_fields.sig.sig64B, //uint8_t *sig,
-                       &sig_parity, //uint8_t *pby,
-                       NULL  //int (*is_canonical)(uint8_t by, uint8_t sig[64]))
-                       );
+    // Sign the transaction with its account, which isn't removed while it's referenced
+    account_ptr = BoatEthWalletAcquireAccount(tx_ptr->wallet_ptr, tx_ptr->account_index);
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No account %u in the wallet.", tx_ptr->account_index);
+        boat_throw(BOAT_ERROR_INVALID_ARGUMENT, PlatoneSendRawtx_cleanup);
+    }
+
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+    result = BoatSignerSignDigest(
+                                  account_ptr->priv_key_array,
+                                  message_digest,
+                                  tx_ptr->rawtx_fields.sig.sig64B,
+                                  &sig_parity
+                                  );
+
+    BoatEthWalletReleaseAccount(tx_ptr->wallet_ptr, account_ptr);
+
+    if( result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to sign Tx.");
+        boat_throw(result, PlatoneSendRawtx_cleanup);
+    }
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_SIGN, profile_start);
 
 
     // Trim r
@@ -492,6 +522,8 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
     *         (See above description for details)                             *
     **************************************************************************/
 
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+
     // Re-encode v
     if( tx_ptr->wallet_ptr->network_info.eip155_compatibility == BOAT_TRUE )
     {
@@ -616,6 +648,8 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
         BoatLog(BOAT_LOG_NORMAL, "Fail to re-encode Tx.");
         boat_throw(BOAT_ERROR_RLP_ENCODING_FAIL, PlatoneSendRawtx_cleanup);
     }
+
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_RLP_REENCODE, profile_start);
     
 
     // Allocate memory for RLP stream HEX string
@@ -677,7 +711,7 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
 
     if( 0 == UtilityBin2Hex(
         rlp_stream_hex_str,
-        tx_ptr->wallet_ptr->account_info.address,
+        account_ptr->address,
         20,
         BIN2HEX_LEFTTRIM_UNFMTDATA,
         BIN2HEX_PREFIX_0x_YES,
@@ -744,6 +778,7 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
 
 
 
+    BOAT_TX_PROFILE_BEGIN(profile_start);
     UtilityBin2Hex(
                 rlp_stream_hex_str,
                 rlp_stream_storage_ptr->stream_ptr,
@@ -752,10 +787,11 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
                 BIN2HEX_PREFIX_0x_YES,
                 BOAT_FALSE
                 );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_HEX_CONVERT, profile_start);
 
     param_eth_sendRawTransaction.signedtx_str = rlp_stream_hex_str;
     
-    tx_hash_str = web3_eth_sendRawTransaction( tx_ptr->wallet_ptr->web3intf_context_ptr,
+    tx_hash_str = web3_eth_sendRawTransaction( web3_thread_context(),
                                                tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                                &param_eth_sendRawTransaction);
 
@@ -790,6 +826,8 @@ BOAT_RESULT PlatoneSendRawtx(BOAT_INOUT BoatPlatoneTx *tx_ptr)
         BoatFree(rlp_stream_hex_str);
     }
 
+    BoatTxArenaEnd();
+
     return result;
 
 }
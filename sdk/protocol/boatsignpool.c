@@ -0,0 +1,517 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Parallel transaction signing pool
+
+@file
+boatsignpool.c implements a pool of worker threads signing Ethereum raw
+transactions.
+
+Jobs are passed to the workers through a bounded multi-producer/multi-consumer
+ring (D. Vyukov's algorithm): every slot carries a sequence number telling
+whether it's free for the producer of a position or filled for the consumer
+of that position, so producers and consumers only contend on a CAS of their
+own position counter. A semaphore counts the filled slots to let idle workers
+sleep instead of spinning.
+
+Workers don't share any writable state except the queue: each one signs on its
+own stack and keeps its own digest buffer, and the crypto library is
+reentrant.
+*/
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_TX
+
+#include "boatinternal.h"
+
+#if BOAT_USE_SIGN_POOL == 1
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+
+#include "boatethereum.h"
+#include "boatsignpool.h"
+
+// Assumed cache line size, to keep hot counters of different threads apart
+#define BOAT_SIGN_POOL_CACHE_LINE 64
+
+#define BOAT_SIGN_POOL_DEFAULT_CAPACITY 256u
+#define BOAT_SIGN_POOL_MAX_CAPACITY     (1u << 20)
+
+
+//!@brief A slot of the job ring
+typedef struct TBoatEthSignJob
+{
+    BUINT32 sequence;                   //!< Position this slot is ready for (see file description)
+    BoatEthTx *tx_ptr;                  //!< Transaction to sign
+    BoatEthSignPoolCallback callback;   //!< Completion callback, may be NULL
+    void *user_data;                    //!< Argument of the callback
+}BoatEthSignJob;
+
+
+//!@brief Worker thread context
+typedef struct TBoatEthSignWorker
+{
+    pthread_t thread;
+    struct TBoatEthSignPool *pool_ptr;
+    BUINT8 tx_hash[32];                 //!< Digest scratch of this worker
+    BUINT8 pad[BOAT_SIGN_POOL_CACHE_LINE];
+}BoatEthSignWorker;
+
+
+struct TBoatEthSignPool
+{
+    BoatEthSignJob *job_ring_ptr;
+    BUINT32 ring_mask;                  //!< Ring capacity - 1, capacity is a power of 2
+
+    BUINT8 pad0[BOAT_SIGN_POOL_CACHE_LINE];
+    BUINT32 enqueue_pos;                //!< Next position to fill, shared by producers
+    BUINT8 pad1[BOAT_SIGN_POOL_CACHE_LINE];
+    BUINT32 dequeue_pos;                //!< Next position to take, shared by workers
+    BUINT8 pad2[BOAT_SIGN_POOL_CACHE_LINE];
+
+    BUINT32 pending_num;                //!< Jobs submitted but not completed yet
+    BBOOL is_stopping;
+
+    sem_t job_sem;                      //!< Counts filled slots
+    pthread_mutex_t idle_mutex;         //!< Protects waiting for <pending_num> to drop to 0
+    pthread_cond_t idle_cond;
+
+    BoatEthSignWorker *workers_ptr;
+    BUINT32 worker_num;
+};
+
+
+static BBOOL BoatEthSignPoolEnqueue(BoatEthSignPool *pool_ptr,
+                                    BoatEthTx *tx_ptr,
+                                    BoatEthSignPoolCallback callback,
+                                    void *user_data)
+{
+    BoatEthSignJob *job_ptr;
+    BUINT32 pos;
+    BSINT32 diff;
+
+    pos = __atomic_load_n(&pool_ptr->enqueue_pos, __ATOMIC_RELAXED);
+    for( ;; )
+    {
+        job_ptr = &pool_ptr->job_ring_ptr[pos & pool_ptr->ring_mask];
+        diff = (BSINT32)(__atomic_load_n(&job_ptr->sequence, __ATOMIC_ACQUIRE) - pos);
+
+        if( diff == 0 )
+        {
+            if( __atomic_compare_exchange_n(&pool_ptr->enqueue_pos, &pos, pos + 1, BOAT_TRUE,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+            {
+                break;
+            }
+            // <pos> is updated by the failed CAS
+        }
+        else if( diff < 0 )
+        {
+            // The slot still holds the job of the previous lap: ring is full
+            return BOAT_FALSE;
+        }
+        else
+        {
+            pos = __atomic_load_n(&pool_ptr->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    job_ptr->tx_ptr = tx_ptr;
+    job_ptr->callback = callback;
+    job_ptr->user_data = user_data;
+    __atomic_store_n(&job_ptr->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    return BOAT_TRUE;
+}
+
+
+static BBOOL BoatEthSignPoolDequeue(BoatEthSignPool *pool_ptr, BoatEthSignJob *job_out_ptr)
+{
+    BoatEthSignJob *job_ptr;
+    BUINT32 pos;
+    BSINT32 diff;
+
+    pos = __atomic_load_n(&pool_ptr->dequeue_pos, __ATOMIC_RELAXED);
+    for( ;; )
+    {
+        job_ptr = &pool_ptr->job_ring_ptr[pos & pool_ptr->ring_mask];
+        diff = (BSINT32)(__atomic_load_n(&job_ptr->sequence, __ATOMIC_ACQUIRE) - (pos + 1));
+
+        if( diff == 0 )
+        {
+            if( __atomic_compare_exchange_n(&pool_ptr->dequeue_pos, &pos, pos + 1, BOAT_TRUE,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+            {
+                break;
+            }
+        }
+        else if( diff < 0 )
+        {
+            // Not filled yet (empty, or the producer hasn't finished writing)
+            return BOAT_FALSE;
+        }
+        else
+        {
+            pos = __atomic_load_n(&pool_ptr->dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    *job_out_ptr = *job_ptr;
+    __atomic_store_n(&job_ptr->sequence, pos + pool_ptr->ring_mask + 1, __ATOMIC_RELEASE);
+
+    return BOAT_TRUE;
+}
+
+
+static void BoatEthSignPoolJobDone(BoatEthSignPool *pool_ptr)
+{
+    if( __atomic_sub_fetch(&pool_ptr->pending_num, 1, __ATOMIC_ACQ_REL) == 0 )
+    {
+        // Taking the mutex orders the wakeup after the waiter's check
+        pthread_mutex_lock(&pool_ptr->idle_mutex);
+        pthread_cond_broadcast(&pool_ptr->idle_cond);
+        pthread_mutex_unlock(&pool_ptr->idle_mutex);
+    }
+}
+
+
+static void BoatEthSignPoolRunJob(BoatEthSignWorker *worker_ptr, const BoatEthSignJob *job_ptr)
+{
+    BoatFieldVariable signed_tx;
+    BoatEthTx *tx_ptr = job_ptr->tx_ptr;
+    BOAT_RESULT result;
+
+    result = EthSignRawtx(tx_ptr, &signed_tx);
+
+    if( result == BOAT_SUCCESS )
+    {
+        // Hash of an Ethereum transaction is the hash of its signed RLP stream
+        keccak_256(signed_tx.field_ptr, signed_tx.field_len, worker_ptr->tx_hash);
+        memcpy(tx_ptr->tx_hash.field, worker_ptr->tx_hash, 32);
+        tx_ptr->tx_hash.field_len = 32;
+    }
+    else
+    {
+        memset(worker_ptr->tx_hash, 0x00, 32);
+        tx_ptr->tx_hash.field_len = 0;
+    }
+
+    if( job_ptr->callback != NULL )
+    {
+        job_ptr->callback(tx_ptr,
+                          result,
+                          signed_tx.field_ptr,
+                          signed_tx.field_len,
+                          worker_ptr->tx_hash,
+                          job_ptr->user_data);
+    }
+
+    if( signed_tx.field_ptr != NULL )
+    {
+        BoatFree(signed_tx.field_ptr);
+    }
+
+    BoatEthSignPoolJobDone(worker_ptr->pool_ptr);
+}
+
+
+static void *BoatEthSignPoolWorkerMain(void *arg)
+{
+    BoatEthSignWorker *worker_ptr = (BoatEthSignWorker *)arg;
+    BoatEthSignPool *pool_ptr = worker_ptr->pool_ptr;
+    BoatEthSignJob job;
+
+    for( ;; )
+    {
+        // Retry if interrupted by a signal
+        while( sem_wait(&pool_ptr->job_sem) != 0 )
+        {
+        }
+
+        // A token is either a filled slot or a stop request. A filled slot may
+        // be briefly invisible if an earlier position is still being written.
+        while( BoatEthSignPoolDequeue(pool_ptr, &job) != BOAT_TRUE )
+        {
+            if( __atomic_load_n(&pool_ptr->is_stopping, __ATOMIC_ACQUIRE) )
+            {
+                return NULL;
+            }
+            sched_yield();
+        }
+
+        BoatEthSignPoolRunJob(worker_ptr, &job);
+    }
+
+    return NULL;
+}
+
+
+static void BoatEthSignPoolStop(BoatEthSignPool *pool_ptr, BUINT32 started_num)
+{
+    BUINT32 i;
+
+    __atomic_store_n(&pool_ptr->is_stopping, BOAT_TRUE, __ATOMIC_RELEASE);
+
+    for( i = 0; i < started_num; i++ )
+    {
+        sem_post(&pool_ptr->job_sem);
+    }
+
+    for( i = 0; i < started_num; i++ )
+    {
+        pthread_join(pool_ptr->workers_ptr[i].thread, NULL);
+    }
+}
+
+
+static void BoatEthSignPoolFree(BoatEthSignPool *pool_ptr)
+{
+    pthread_cond_destroy(&pool_ptr->idle_cond);
+    pthread_mutex_destroy(&pool_ptr->idle_mutex);
+    sem_destroy(&pool_ptr->job_sem);
+
+    BoatFree(pool_ptr->workers_ptr);
+    BoatFree(pool_ptr->job_ring_ptr);
+    BoatFree(pool_ptr);
+}
+
+
+/*!*****************************************************************************
+@brief Create a transaction signing pool
+
+Function: BoatEthSignPoolCreate()
+
+    This function creates a signing pool and starts its worker threads.
+
+
+@return
+    This function returns the pool if successful. Otherwise it returns NULL.
+
+
+@param[in] worker_num
+    Number of worker threads, at most BOAT_SIGN_POOL_MAX_WORKER_NUM.\n
+    0 for one worker per online processor.
+
+@param[in] queue_capacity
+    Max number of jobs waiting in the queue, rounded up to a power of 2.\n
+    0 for a default capacity of 256.
+
+*******************************************************************************/
+BoatEthSignPool *BoatEthSignPoolCreate(BUINT32 worker_num, BUINT32 queue_capacity)
+{
+    BoatEthSignPool *pool_ptr;
+    BUINT32 capacity;
+    BUINT32 i;
+    long cpu_num;
+
+    if( worker_num == 0 )
+    {
+        cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_num = cpu_num > 0 ? (BUINT32)cpu_num : 1;
+    }
+
+    if( worker_num > BOAT_SIGN_POOL_MAX_WORKER_NUM )
+    {
+        worker_num = BOAT_SIGN_POOL_MAX_WORKER_NUM;
+    }
+
+    if( queue_capacity == 0 )
+    {
+        queue_capacity = BOAT_SIGN_POOL_DEFAULT_CAPACITY;
+    }
+
+    if( queue_capacity > BOAT_SIGN_POOL_MAX_CAPACITY )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Queue capacity %u exceeds %u.", queue_capacity, BOAT_SIGN_POOL_MAX_CAPACITY);
+        return NULL;
+    }
+
+    for( capacity = 2; capacity < queue_capacity; capacity <<= 1 )
+    {
+    }
+
+    pool_ptr = BoatMalloc(sizeof(BoatEthSignPool));
+    if( pool_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Fail to allocate signing pool.");
+        return NULL;
+    }
+    memset(pool_ptr, 0x00, sizeof(BoatEthSignPool));
+
+    pool_ptr->job_ring_ptr = BoatMalloc(capacity * sizeof(BoatEthSignJob));
+    pool_ptr->workers_ptr = BoatMalloc(worker_num * sizeof(BoatEthSignWorker));
+    if( pool_ptr->job_ring_ptr == NULL || pool_ptr->workers_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Fail to allocate signing pool.");
+        BoatFree(pool_ptr->workers_ptr);
+        BoatFree(pool_ptr->job_ring_ptr);
+        BoatFree(pool_ptr);
+        return NULL;
+    }
+
+    pool_ptr->ring_mask = capacity - 1;
+    for( i = 0; i < capacity; i++ )
+    {
+        pool_ptr->job_ring_ptr[i].sequence = i;
+    }
+
+    sem_init(&pool_ptr->job_sem, 0, 0);
+    pthread_mutex_init(&pool_ptr->idle_mutex, NULL);
+    pthread_cond_init(&pool_ptr->idle_cond, NULL);
+
+    for( i = 0; i < worker_num; i++ )
+    {
+        pool_ptr->workers_ptr[i].pool_ptr = pool_ptr;
+
+        if( pthread_create(&pool_ptr->workers_ptr[i].thread, NULL,
+                           BoatEthSignPoolWorkerMain, &pool_ptr->workers_ptr[i]) != 0 )
+        {
+            BoatLog(BOAT_LOG_CRITICAL, "Fail to start signing worker %u.", i);
+            BoatEthSignPoolStop(pool_ptr, i);
+            BoatEthSignPoolFree(pool_ptr);
+            return NULL;
+        }
+    }
+
+    pool_ptr->worker_num = worker_num;
+
+    return pool_ptr;
+}
+
+
+/*!*****************************************************************************
+@brief Submit a transaction to sign
+
+Function: BoatEthSignPoolSubmit()
+
+    This function queues a transaction for signing and returns immediately. It
+    may be called from any thread.
+
+    Once signed, the v/r/s fields and <tx_hash> of the transaction are updated
+    and <callback> is called in the worker thread. The callback SHOULD return
+    quickly as it blocks the worker.
+
+
+@return
+    This function returns BOAT_SUCCESS if the job is queued.\n
+    It returns BOAT_ERROR_BUFFER_EXHAUSTED if the queue is full. The caller may
+    retry later.\n
+    Otherwise it returns one of the error codes.
+
+
+@param[in] pool_ptr
+    The signing pool.
+
+@param[in] tx_ptr
+    The transaction to sign, combined with its wallet.
+
+@param[in] callback
+    The completion callback. It can be NULL.
+
+@param[in] user_data
+    The argument passed to <callback>.
+
+*******************************************************************************/
+BOAT_RESULT BoatEthSignPoolSubmit(BoatEthSignPool *pool_ptr,
+                                  BoatEthTx *tx_ptr,
+                                  BoatEthSignPoolCallback callback,
+                                  void *user_data)
+{
+    if( pool_ptr == NULL || tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    // Count the job before it becomes visible, so that it can't complete first
+    __atomic_add_fetch(&pool_ptr->pending_num, 1, __ATOMIC_ACQ_REL);
+
+    if( BoatEthSignPoolEnqueue(pool_ptr, tx_ptr, callback, user_data) != BOAT_TRUE )
+    {
+        BoatEthSignPoolJobDone(pool_ptr);
+        return BOAT_ERROR_BUFFER_EXHAUSTED;
+    }
+
+    sem_post(&pool_ptr->job_sem);
+
+    return BOAT_SUCCESS;
+}
+
+
+/*!*****************************************************************************
+@brief Wait for all submitted transactions being signed
+
+Function: BoatEthSignPoolWait()
+
+    This function blocks until every job submitted so far has completed, i.e.
+    its callback has returned.
+
+
+@return
+    This function doesn't return anything.
+
+
+@param[in] pool_ptr
+    The signing pool.
+
+*******************************************************************************/
+void BoatEthSignPoolWait(BoatEthSignPool *pool_ptr)
+{
+    if( pool_ptr == NULL )
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool_ptr->idle_mutex);
+    while( __atomic_load_n(&pool_ptr->pending_num, __ATOMIC_ACQUIRE) != 0 )
+    {
+        pthread_cond_wait(&pool_ptr->idle_cond, &pool_ptr->idle_mutex);
+    }
+    pthread_mutex_unlock(&pool_ptr->idle_mutex);
+}
+
+
+/*!*****************************************************************************
+@brief Destroy a transaction signing pool
+
+Function: BoatEthSignPoolDestroy()
+
+    This function waits for all submitted jobs, stops the worker threads and
+    frees the pool. No job may be submitted once this function is called.
+
+
+@return
+    This function doesn't return anything.
+
+
+@param[in] pool_ptr
+    The signing pool to destroy.
+
+*******************************************************************************/
+void BoatEthSignPoolDestroy(BoatEthSignPool *pool_ptr)
+{
+    if( pool_ptr == NULL )
+    {
+        return;
+    }
+
+    BoatEthSignPoolWait(pool_ptr);
+    BoatEthSignPoolStop(pool_ptr, pool_ptr->worker_num);
+    BoatEthSignPoolFree(pool_ptr);
+}
+
+#endif /* end of BOAT_USE_SIGN_POOL */
@@ -0,0 +1,81 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Header file for the parallel transaction signing pool
+
+@file
+boatsignpool.h is header file for the Ethereum transaction signing pool.
+
+A signing pool runs a number of worker threads that construct and sign raw
+transactions (see EthSignRawtx()) submitted from any thread. Submitted jobs are
+kept in a bounded lock-free queue. When a job is done, the completion callback
+is called in the worker thread with the signed RLP stream and the transaction
+hash, e.g. to queue them for sending.
+
+Each job is a transaction combined with its wallet (<tx_ptr->wallet_ptr>). The
+pool only reads the wallet, thus many transactions of the same wallet may be
+signed at the same time. A transaction MUST NOT be modified or submitted again
+before its callback is called.
+
+The pool is compiled only if BOAT_USE_SIGN_POOL is set to 1 in boatoptions.h.
+*/
+
+#ifndef __BOATSIGNPOOL_H__
+#define __BOATSIGNPOOL_H__
+
+#include "boatinternal.h"
+
+#if BOAT_USE_SIGN_POOL == 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Max number of worker threads in a pool
+#define BOAT_SIGN_POOL_MAX_WORKER_NUM 64
+
+
+typedef struct TBoatEthSignPool BoatEthSignPool;
+
+//!@brief Completion callback of a signing job
+//! <signed_tx_ptr> and <tx_hash> are only valid during the callback.
+//! If <result> is not BOAT_SUCCESS, <signed_tx_ptr> is NULL and <signed_tx_len> is 0.
+typedef void (*BoatEthSignPoolCallback)(BoatEthTx *tx_ptr,
+                                        BOAT_RESULT result,
+                                        const BUINT8 *signed_tx_ptr,
+                                        BUINT32 signed_tx_len,
+                                        const BUINT8 tx_hash[32],
+                                        void *user_data);
+
+
+BoatEthSignPool *BoatEthSignPoolCreate(BUINT32 worker_num, BUINT32 queue_capacity);
+
+BOAT_RESULT BoatEthSignPoolSubmit(BoatEthSignPool *pool_ptr,
+                                  BoatEthTx *tx_ptr,
+                                  BoatEthSignPoolCallback callback,
+                                  void *user_data);
+
+void BoatEthSignPoolWait(BoatEthSignPool *pool_ptr);
+
+void BoatEthSignPoolDestroy(BoatEthSignPool *pool_ptr);
+
+#ifdef __cplusplus
+}
+#endif /* end of __cplusplus */
+
+#endif /* end of BOAT_USE_SIGN_POOL */
+
+#endif
@@ -19,6 +19,8 @@
 @file web3intf.c contains web3 interface functions for RPC.
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_WEB3
+
 #include "boatinternal.h"
 
 #include "rpcintf.h"
@@ -28,6 +30,9 @@
 
 #include "web3intf.h"
 #include "randgenerator.h"
+#include "boattxprofile.h"
+
+#include <pthread.h>
 
 
 /******************************************************************************
@@ -48,7 +53,7 @@ static BOAT_RESULT web3_malloc_size_expand(BoatFieldVariable * mem, BUINT32 step
 	BoatFree(mem->field_ptr);
 	
 	mem->field_len += step_size;
-	mem->field_ptr  = BoatMalloc(mem->field_len);
+	mem->field_ptr  = BoatMallocPersistent(mem->field_len);
 	if( mem->field_ptr == NULL )
 	{
 		mem->field_len = 0;
@@ -97,6 +102,7 @@ BOAT_RESULT web3_parse_json_result(const BCHAR * json_string,
 	BUINT32 parse_result_str_len;
 	const char *cjson_error_ptr;
 	
+	BOAT_TX_PROFILE_DECLARE(profile_start);
 	BOAT_RESULT result = BOAT_SUCCESS;
 	boat_try_declare;
 	
@@ -107,6 +113,7 @@ BOAT_RESULT web3_parse_json_result(const BCHAR * json_string,
 	}
 	
 	// Convert string to cJSON
+	BOAT_TX_PROFILE_BEGIN(profile_start);
 	cjson_string_ptr = cJSON_Parse(json_string);
 	if (cjson_string_ptr == NULL)
     {
@@ -191,20 +198,21 @@ BOAT_RESULT web3_parse_json_result(const BCHAR * json_string,
 		BoatLog(BOAT_LOG_CRITICAL, "Un-expect object type.");
 		boat_throw(BOAT_ERROR_JSON_PARSE_FAIL, web3_parse_json_result_cleanup);
 	}
-	
+
+	BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_PARSE, profile_start);
 	
 	// Exceptional Clean Up
     boat_catch(web3_parse_json_result_cleanup)
     {
         BoatLog(BOAT_LOG_NORMAL, "Exception: %d", boat_exception);
-
-        if( cjson_string_ptr != NULL )
-        {
-            cJSON_Delete(cjson_string_ptr);
-        }
-
         result = boat_exception;
     }
+
+    // Clean Up, on success as well
+    if( cjson_string_ptr != NULL )
+    {
+        cJSON_Delete(cjson_string_ptr);
+    }
 	
 	return result;
 }
@@ -232,7 +240,7 @@ Web3IntfContext * web3_init(void)
     Web3IntfContext *web3intf_context_ptr;
     boat_try_declare;
 
-    web3intf_context_ptr = BoatMalloc(sizeof(Web3IntfContext));
+    web3intf_context_ptr = BoatMallocPersistent(sizeof(Web3IntfContext));
 
     if( web3intf_context_ptr == NULL )
     {
@@ -242,7 +250,7 @@ Web3IntfContext * web3_init(void)
 
 	web3intf_context_ptr->web3_json_string_buf.field_len = WEB3_STRING_BUF_STEP_SIZE;
     web3intf_context_ptr->web3_json_string_buf.field_ptr = \
-			BoatMalloc(web3intf_context_ptr->web3_json_string_buf.field_len);
+			BoatMallocPersistent(web3intf_context_ptr->web3_json_string_buf.field_len);
     if( web3intf_context_ptr->web3_json_string_buf.field_ptr == NULL )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to allocate Web3 JSON string buffer.");
@@ -252,7 +260,7 @@ Web3IntfContext * web3_init(void)
 
 	web3intf_context_ptr->web3_result_string_buf.field_len = WEB3_STRING_BUF_STEP_SIZE;
     web3intf_context_ptr->web3_result_string_buf.field_ptr = \
-			BoatMalloc(web3intf_context_ptr->web3_result_string_buf.field_len);
+			BoatMallocPersistent(web3intf_context_ptr->web3_result_string_buf.field_len);
     if( web3intf_context_ptr->web3_result_string_buf.field_ptr == NULL )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to allocate Web3 result string buffer.");
@@ -334,6 +342,112 @@ void web3_deinit(Web3IntfContext *web3intf_context_ptr)
     return;
 }
 
+__BOATSTATIC pthread_key_t g_web3_thread_context_key;
+__BOATSTATIC pthread_once_t g_web3_thread_context_once = PTHREAD_ONCE_INIT;
+__BOATSTATIC BBOOL g_web3_thread_context_key_created = BOAT_FALSE;
+
+
+__BOATSTATIC void web3_thread_context_destructor(void *web3intf_context_ptr)
+{
+    web3_deinit(web3intf_context_ptr);
+}
+
+
+__BOATSTATIC void web3_thread_context_key_create(void)
+{
+    g_web3_thread_context_key_created =
+        (pthread_key_create(&g_web3_thread_context_key, web3_thread_context_destructor) == 0);
+}
+
+
+/*!*****************************************************************************
+@brief Get the web3 interface context of the calling thread.
+
+Function: web3_thread_context()
+
+    This function returns the web3 interface context of the calling thread,
+    which is initialized on first use and de-initialized when the thread
+    exits.
+
+    A web3 interface context holds the REQUEST/RESPONSE buffers and the RPC
+    context, which must not be shared by threads. With one context per thread,
+    any number of threads can call web3 functions at the same time, on the
+    same wallet or not.
+
+    The strings returned by web3 functions are valid until the next web3
+    function call in the same thread.
+
+@see web3_thread_context_release()
+
+@return
+    This function returns the web3 interface context of the calling thread.\n
+    If it cannot be initialized, it returns NULL.
+
+*******************************************************************************/
+Web3IntfContext *web3_thread_context(void)
+{
+    Web3IntfContext *web3intf_context_ptr;
+
+    pthread_once(&g_web3_thread_context_once, web3_thread_context_key_create);
+
+    if( g_web3_thread_context_key_created != BOAT_TRUE )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Fail to create web3 thread context key.");
+        return NULL;
+    }
+
+    web3intf_context_ptr = pthread_getspecific(g_web3_thread_context_key);
+
+    if( web3intf_context_ptr == NULL )
+    {
+        web3intf_context_ptr = web3_init();
+
+        if(    web3intf_context_ptr != NULL
+            && pthread_setspecific(g_web3_thread_context_key, web3intf_context_ptr) != 0 )
+        {
+            web3_deinit(web3intf_context_ptr);
+            web3intf_context_ptr = NULL;
+        }
+    }
+
+    return web3intf_context_ptr;
+}
+
+
+/*!*****************************************************************************
+@brief Release the web3 interface context of the calling thread.
+
+Function: web3_thread_context_release()
+
+    This function de-initializes the web3 interface context of the calling
+    thread, if any. Contexts of other threads are released when they exit.
+    The main thread, which may not exit before the process does, calls it
+    from BoatIotSdkDeInit().
+
+@see web3_thread_context()
+
+@return This function doesn't return any thing.
+
+*******************************************************************************/
+void web3_thread_context_release(void)
+{
+    Web3IntfContext *web3intf_context_ptr;
+
+    if( g_web3_thread_context_key_created != BOAT_TRUE )
+    {
+        return;
+    }
+
+    web3intf_context_ptr = pthread_getspecific(g_web3_thread_context_key);
+
+    if( web3intf_context_ptr != NULL )
+    {
+        pthread_setspecific(g_web3_thread_context_key, NULL);
+        web3_deinit(web3intf_context_ptr);
+    }
+}
+
+
 /*!*****************************************************************************
 @brief Perform eth_getTransactionCount RPC method and get the transaction count
        of the specified account
@@ -393,6 +507,7 @@ BCHAR *web3_eth_getTransactionCount(Web3IntfContext *web3intf_context_ptr,
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -411,6 +526,7 @@ BCHAR *web3_eth_getTransactionCount(Web3IntfContext *web3intf_context_ptr,
     
    
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -434,6 +550,7 @@ BCHAR *web3_eth_getTransactionCount(Web3IntfContext *web3intf_context_ptr,
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -528,6 +645,7 @@ BCHAR *web3_eth_gasPrice(Web3IntfContext *web3intf_context_ptr, BCHAR *node_url_
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -546,6 +664,7 @@ BCHAR *web3_eth_gasPrice(Web3IntfContext *web3intf_context_ptr, BCHAR *node_url_
     
    
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -566,6 +685,7 @@ BCHAR *web3_eth_gasPrice(Web3IntfContext *web3intf_context_ptr, BCHAR *node_url_
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -665,6 +785,7 @@ BCHAR *web3_eth_getBalance(Web3IntfContext *web3intf_context_ptr,
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -683,6 +804,7 @@ BCHAR *web3_eth_getBalance(Web3IntfContext *web3intf_context_ptr,
     
    
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -705,6 +827,7 @@ BCHAR *web3_eth_getBalance(Web3IntfContext *web3intf_context_ptr,
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -805,6 +928,7 @@ BCHAR *web3_eth_sendRawTransaction(Web3IntfContext *web3intf_context_ptr,
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -823,6 +947,7 @@ BCHAR *web3_eth_sendRawTransaction(Web3IntfContext *web3intf_context_ptr,
     
 
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -844,6 +969,7 @@ BCHAR *web3_eth_sendRawTransaction(Web3IntfContext *web3intf_context_ptr,
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -958,6 +1084,7 @@ BCHAR *web3_eth_getStorageAt(Web3IntfContext *web3intf_context_ptr,
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -976,6 +1103,7 @@ BCHAR *web3_eth_getStorageAt(Web3IntfContext *web3intf_context_ptr,
     
 
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -999,6 +1127,7 @@ BCHAR *web3_eth_getStorageAt(Web3IntfContext *web3intf_context_ptr,
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
     
@@ -1116,6 +1245,7 @@ BCHAR *web3_eth_getTransactionReceiptStatus(Web3IntfContext *web3intf_context_pt
     BCHAR  *return_value_ptr = NULL;
     
 	BOAT_RESULT result;
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -1133,6 +1263,7 @@ BCHAR *web3_eth_getTransactionReceiptStatus(Web3IntfContext *web3intf_context_pt
     }
     
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -1154,6 +1285,7 @@ BCHAR *web3_eth_getTransactionReceiptStatus(Web3IntfContext *web3intf_context_pt
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -1285,6 +1417,7 @@ BCHAR *web3_eth_call(Web3IntfContext *web3intf_context_ptr,
     BOAT_RESULT result;
     BCHAR *return_value_ptr = NULL;
     
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     boat_try_declare;
     
     if( web3intf_context_ptr == NULL )
@@ -1303,6 +1436,7 @@ BCHAR *web3_eth_call(Web3IntfContext *web3intf_context_ptr,
     
 
     // Construct the REQUEST
+    BOAT_TX_PROFILE_BEGIN(profile_start);
 	do{
 		malloc_size_expand_flag = false;
 		expected_string_size = snprintf(
@@ -1328,6 +1462,7 @@ BCHAR *web3_eth_call(Web3IntfContext *web3intf_context_ptr,
 			malloc_size_expand_flag = true;
 		}
 	}while( malloc_size_expand_flag );
+    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_JSON_BUILD, profile_start);
 
     BoatLog(BOAT_LOG_VERBOSE, "REQUEST: %s", (BCHAR*)web3intf_context_ptr->web3_json_string_buf.field_ptr);
 
@@ -45,6 +45,9 @@ BOAT_RESULT web3_parse_json_result(const BCHAR * json_string,
 Web3IntfContext * web3_init(void);
 void web3_deinit(Web3IntfContext *web3intf_context_ptr);
 
+Web3IntfContext *web3_thread_context(void);
+void web3_thread_context_release(void);
+
 //!@brief Parameter for web3_eth_getTransactionCount()
 typedef struct TParam_eth_getTransactionCount
 {
@@ -20,6 +20,8 @@
 boatrlp.c contains functions to encode a stream as per RLP encoding rules.
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_RLP
+
 #include "boatinternal.h"
 
 
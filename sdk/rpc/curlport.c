@@ -25,6 +25,8 @@ provided by rpcport.
 To use libcurl porting, RPC_USE_LIBCURL in boatoptions.h must set to 1.
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_RPC
+
 #include "boatinternal.h"
 
 #if RPC_USE_LIBCURL == 1
@@ -32,8 +34,408 @@ To use libcurl porting, RPC_USE_LIBCURL in boatoptions.h must set to 1.
 #include "curlport.h"
 #include "curl/curl.h"
 
+#include <pthread.h>
+
+
+//!@brief A pooled node URL, see CurlPortEndpointGet()
+typedef struct TCurlPortEndpoint
+{
+    struct TCurlPortEndpoint *next_ptr;     //!< Next endpoint of the pool
+    BCHAR *url_str;                         //!< Node URL
+    BUINT32 url_hash;                       //!< CurlPortUrlHash() of <url_str>
+    CURLSH *share_ptr;                      //!< DNS, TLS session and connection caches
+    pthread_mutex_t share_lock_array[CURL_LOCK_DATA_LAST]; //!< Locks of <share_ptr>, per data type
+    pthread_mutex_t idle_lock;              //!< Lock of <idle_conn_array>
+    CURL *idle_conn_array[BOAT_RPC_ENDPOINT_IDLE_CONN_NUM]; //!< Configured easy handles not in use
+    BUINT32 idle_conn_num;
+}CurlPortEndpoint;
+
+
+// The endpoint pool. Endpoints are only freed by CurlPortPoolCleanup(), which
+// increases the generation so that contexts drop their cached endpoint.
+__BOATSTATIC pthread_mutex_t g_curlport_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+__BOATSTATIC CurlPortEndpoint *g_curlport_endpoint_list_ptr = NULL;
+__BOATSTATIC BUINT32 g_curlport_endpoint_num = 0;
+__BOATSTATIC BUINT32 g_curlport_pool_generation = 0;
+__BOATSTATIC struct curl_slist *g_curlport_header_list_ptr = NULL;
+
+
+__BOATSTATIC BUINT32 CurlPortUrlHash(const BCHAR *url_str)
+{
+    BUINT32 hash = 2166136261U;
+
+    while( *url_str != '\0' )
+    {
+        hash = (hash ^ (BUINT8)*url_str++) * 16777619U;
+    }
+
+    return hash;
+}
+
+
+__BOATSTATIC void CurlPortShareLock(CURL *curl_ctx_ptr, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    CurlPortEndpoint *endpoint_ptr = userptr;
+
+    (void)curl_ctx_ptr;
+    (void)access;
+
+    pthread_mutex_lock(&endpoint_ptr->share_lock_array[data]);
+}
+
+
+__BOATSTATIC void CurlPortShareUnlock(CURL *curl_ctx_ptr, curl_lock_data data, void *userptr)
+{
+    CurlPortEndpoint *endpoint_ptr = userptr;
+
+    (void)curl_ctx_ptr;
+
+    pthread_mutex_unlock(&endpoint_ptr->share_lock_array[data]);
+}
+
+
+__BOATSTATIC void CurlPortEndpointFree(CurlPortEndpoint *endpoint_ptr)
+{
+    BUINT32 i;
+
+    for( i = 0; i < endpoint_ptr->idle_conn_num; i++ )
+    {
+        curl_easy_cleanup(endpoint_ptr->idle_conn_array[i]);
+    }
+
+    if( endpoint_ptr->share_ptr != NULL )
+    {
+        curl_share_cleanup(endpoint_ptr->share_ptr);
+    }
+
+    for( i = 0; i < CURL_LOCK_DATA_LAST; i++ )
+    {
+        pthread_mutex_destroy(&endpoint_ptr->share_lock_array[i]);
+    }
+    pthread_mutex_destroy(&endpoint_ptr->idle_lock);
+
+    BoatFree(endpoint_ptr->url_str);
+    BoatFree(endpoint_ptr);
+}
+
+
+/******************************************************************************
+@brief Create an endpoint
+
+Function: CurlPortEndpointCreate()
+
+    The caller must hold the pool lock.
+
+@return
+    This function returns the endpoint, or NULL if it fails.
+
+*******************************************************************************/
+__BOATSTATIC CurlPortEndpoint *CurlPortEndpointCreate(const BCHAR *url_str, BUINT32 url_hash)
+{
+    CurlPortEndpoint *endpoint_ptr;
+    BUINT32 i;
+
+    endpoint_ptr = BoatMallocPersistent(sizeof(CurlPortEndpoint));
+    if( endpoint_ptr == NULL )
+    {
+        return NULL;
+    }
+
+    memset(endpoint_ptr, 0x00, sizeof(CurlPortEndpoint));
+    for( i = 0; i < CURL_LOCK_DATA_LAST; i++ )
+    {
+        pthread_mutex_init(&endpoint_ptr->share_lock_array[i], NULL);
+    }
+    pthread_mutex_init(&endpoint_ptr->idle_lock, NULL);
+
+    endpoint_ptr->url_hash = url_hash;
+    endpoint_ptr->url_str = BoatMallocPersistent(strlen(url_str) + 1);
+    endpoint_ptr->share_ptr = curl_share_init();
+
+    if( endpoint_ptr->url_str == NULL || endpoint_ptr->share_ptr == NULL )
+    {
+        CurlPortEndpointFree(endpoint_ptr);
+        return NULL;
+    }
+
+    strcpy(endpoint_ptr->url_str, url_str);
+
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_LOCKFUNC, CurlPortShareLock);
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_UNLOCKFUNC, CurlPortShareUnlock);
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_USERDATA, endpoint_ptr);
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    // Keep-alive connections are shared since libcurl 7.57.0. With earlier
+    // versions each idle easy handle keeps its own.
+    curl_share_setopt(endpoint_ptr->share_ptr, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+
+    return endpoint_ptr;
+}
+
+
+/******************************************************************************
+@brief Get the pooled endpoint of a node URL
+
+Function: CurlPortEndpointGet()
+
+    All requests to the same node URL go through one endpoint, which owns the
+    connections to that node. The endpoint of the last request is cached in
+    the curlport context, so the pool is only searched when the context sends
+    to another node.
+
+@return
+    This function returns the endpoint.\n
+    It returns NULL if the pool is full, in which case the request uses a
+    connection of its own.
+
+*******************************************************************************/
+__BOATSTATIC CurlPortEndpoint *CurlPortEndpointGet(CurlPortContext *curlport_context_ptr)
+{
+    const BCHAR *url_str = curlport_context_ptr->remote_url_str;
+    CurlPortEndpoint *endpoint_ptr = curlport_context_ptr->endpoint_ptr;
+    BUINT32 url_hash;
+
+    if(    endpoint_ptr != NULL
+        && curlport_context_ptr->endpoint_pool_generation == __atomic_load_n(&g_curlport_pool_generation, __ATOMIC_ACQUIRE)
+        && strcmp(endpoint_ptr->url_str, url_str) == 0 )
+    {
+        return endpoint_ptr;
+    }
+
+    url_hash = CurlPortUrlHash(url_str);
+
+    pthread_mutex_lock(&g_curlport_pool_lock);
+
+    for( endpoint_ptr = g_curlport_endpoint_list_ptr; endpoint_ptr != NULL; endpoint_ptr = endpoint_ptr->next_ptr )
+    {
+        if( endpoint_ptr->url_hash == url_hash && strcmp(endpoint_ptr->url_str, url_str) == 0 )
+        {
+            break;
+        }
+    }
+
+    if( endpoint_ptr == NULL && g_curlport_endpoint_num < BOAT_RPC_ENDPOINT_MAX_NUM )
+    {
+        endpoint_ptr = CurlPortEndpointCreate(url_str, url_hash);
+        if( endpoint_ptr != NULL )
+        {
+            endpoint_ptr->next_ptr = g_curlport_endpoint_list_ptr;
+            g_curlport_endpoint_list_ptr = endpoint_ptr;
+            g_curlport_endpoint_num++;
+        }
+    }
+
+    curlport_context_ptr->endpoint_ptr = endpoint_ptr;
+    curlport_context_ptr->endpoint_pool_generation = g_curlport_pool_generation;
+
+    pthread_mutex_unlock(&g_curlport_pool_lock);
+
+    return endpoint_ptr;
+}
+
+
+/******************************************************************************
+@brief Create an easy handle configured for a node
+
+Function: CurlPortConnCreate()
+
+    Options that are the same for every request to a node are set once here,
+    so that idle handles can be reused as they are.
+
+@return
+    This function returns the easy handle, or NULL if it fails.
+
+*******************************************************************************/
+__BOATSTATIC CURL *CurlPortConnCreate(const BCHAR *url_str, CurlPortEndpoint *endpoint_ptr)
+{
+    CURL *curl_ctx_ptr;
+    struct curl_slist *curl_opt_list_ptr = NULL;
+
+    // The HTTP headers are the same for all nodes and built once
+    pthread_mutex_lock(&g_curlport_pool_lock);
+    if( g_curlport_header_list_ptr == NULL )
+    {
+        curl_opt_list_ptr = curl_slist_append(NULL, "Content-Type:application/json;charset=UTF-8");
+
+        if(    curl_opt_list_ptr != NULL
+            && curl_slist_append(curl_opt_list_ptr, "Accept:application/json, text/javascript, */*;q=0.01") != NULL
+            && curl_slist_append(curl_opt_list_ptr, "Accept-Language:zh-CN,zh;q=0.8") != NULL )
+        {
+            g_curlport_header_list_ptr = curl_opt_list_ptr;
+        }
+        else
+        {
+            curl_slist_free_all(curl_opt_list_ptr);
+        }
+    }
+    curl_opt_list_ptr = g_curlport_header_list_ptr;
+    pthread_mutex_unlock(&g_curlport_pool_lock);
+
+    if( curl_opt_list_ptr == NULL )
+    {
+        return NULL;
+    }
+
+    curl_ctx_ptr = curl_easy_init();
+    
+    if(curl_ctx_ptr == NULL)
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "curl_easy_init() fails.");
+        return NULL;
+    }
+
+    // Set RPC URL in format "<protocol>://<target name or IP>:<port>". e.g. "http://192.168.56.1:7545"
+    if( curl_easy_setopt(curl_ctx_ptr, CURLOPT_URL, url_str) != CURLE_OK )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Unknown URL: %s", url_str);
+        curl_easy_cleanup(curl_ctx_ptr);
+        return NULL;
+    }
+
+    // Configure all protocols to be supported
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_PROTOCOLS, CURLPROTO_ALL);
+                   
+    // Configure SSL Certification Verification
+    // If certification file is not available, set them to 0.
+    // See: https://curl.haxx.se/libcurl/c/CURLOPT_SSL_VERIFYPEER.html
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_SSL_VERIFYPEER, 0);
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_SSL_VERIFYHOST, 0);
+
+    // To specify a certificate file or specify a path containing certification files
+    // Only make sense when CURLOPT_SSL_VERIFYPEER is set to non-zero.
+    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_CAINFO, "/etc/certs/cabundle.pem");
+    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_CAPATH, "/etc/cert-dir");
+
+    // Verbose Debug Info.
+    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_VERBOSE, 1);
+
+
+    // Set HTTP Type: POST
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_POST, 1L);
+
+    // Set redirection: No
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_FOLLOWLOCATION, 0);
+
+    // Set entire curl timeout in millisecond. This time includes DNS resloving.
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_TIMEOUT_MS, 30000L);
+
+    // Set Connection timeout in millisecond
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_CONNECTTIMEOUT_MS, 10000L);
+
+    // Signals can't be used for timeouts with more than one thread
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_NOSIGNAL, 1L);
+
+    // Keep idle connections alive for the next request
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    // Set HTTP HEADER Options
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_HTTPHEADER, curl_opt_list_ptr);
+
+    curl_easy_setopt(curl_ctx_ptr, CURLOPT_WRITEFUNCTION, CurlPortWriteMemoryCallback);
+
+    if( endpoint_ptr != NULL )
+    {
+        curl_easy_setopt(curl_ctx_ptr, CURLOPT_SHARE, endpoint_ptr->share_ptr);
+    }
+
+    return curl_ctx_ptr;
+}
+
+
+/******************************************************************************
+@brief Lease a connection to a node
+
+Function: CurlPortConnLease()
 
+    This function takes an idle easy handle of the endpoint, or creates one if
+    none is idle. The handle is given back by CurlPortConnReturn().
 
+@return
+    This function returns the easy handle, or NULL if it fails.
+
+*******************************************************************************/
+__BOATSTATIC CURL *CurlPortConnLease(const BCHAR *url_str, CurlPortEndpoint *endpoint_ptr)
+{
+    CURL *curl_ctx_ptr = NULL;
+
+    if( endpoint_ptr != NULL )
+    {
+        pthread_mutex_lock(&endpoint_ptr->idle_lock);
+        if( endpoint_ptr->idle_conn_num > 0 )
+        {
+            curl_ctx_ptr = endpoint_ptr->idle_conn_array[--endpoint_ptr->idle_conn_num];
+        }
+        pthread_mutex_unlock(&endpoint_ptr->idle_lock);
+    }
+
+    if( curl_ctx_ptr == NULL )
+    {
+        curl_ctx_ptr = CurlPortConnCreate(url_str, endpoint_ptr);
+    }
+
+    return curl_ctx_ptr;
+}
+
+
+__BOATSTATIC void CurlPortConnReturn(CurlPortEndpoint *endpoint_ptr, CURL *curl_ctx_ptr, BBOOL is_reusable)
+{
+    if( endpoint_ptr != NULL && is_reusable == BOAT_TRUE )
+    {
+        pthread_mutex_lock(&endpoint_ptr->idle_lock);
+        if( endpoint_ptr->idle_conn_num < BOAT_RPC_ENDPOINT_IDLE_CONN_NUM )
+        {
+            endpoint_ptr->idle_conn_array[endpoint_ptr->idle_conn_num++] = curl_ctx_ptr;
+            curl_ctx_ptr = NULL;
+        }
+        pthread_mutex_unlock(&endpoint_ptr->idle_lock);
+    }
+
+    if( curl_ctx_ptr != NULL )
+    {
+        curl_easy_cleanup(curl_ctx_ptr);
+    }
+}
+
+
+/*!*****************************************************************************
+@brief Release all pooled endpoints.
+
+Function: CurlPortPoolCleanup()
+
+    This function closes all pooled connections and frees the endpoint pool.
+    It's called by BoatIotSdkDeInit() through RpcCleanup(), when no request is
+    in progress.
+
+@return
+    This function doesn't return any value.
+
+*******************************************************************************/
+void CurlPortPoolCleanup(void)
+{
+    CurlPortEndpoint *endpoint_ptr;
+
+    pthread_mutex_lock(&g_curlport_pool_lock);
+
+    while( g_curlport_endpoint_list_ptr != NULL )
+    {
+        endpoint_ptr = g_curlport_endpoint_list_ptr;
+        g_curlport_endpoint_list_ptr = endpoint_ptr->next_ptr;
+        CurlPortEndpointFree(endpoint_ptr);
+    }
+
+    g_curlport_endpoint_num = 0;
+    __atomic_add_fetch(&g_curlport_pool_generation, 1, __ATOMIC_RELEASE);
+
+    if( g_curlport_header_list_ptr != NULL )
+    {
+        curl_slist_free_all(g_curlport_header_list_ptr);
+        g_curlport_header_list_ptr = NULL;
+    }
+
+    pthread_mutex_unlock(&g_curlport_pool_lock);
+}
 
 
 /*!*****************************************************************************
@@ -58,7 +460,7 @@ CurlPortContext * CurlPortInit(void)
 {
     CurlPortContext *curlport_context_ptr;
 
-    curlport_context_ptr = BoatMalloc(sizeof(CurlPortContext));
+    curlport_context_ptr = BoatMallocPersistent(sizeof(CurlPortContext));
 
     if( curlport_context_ptr == NULL )
     {
@@ -67,11 +469,14 @@ CurlPortContext * CurlPortInit(void)
     else
     {
     
+        curlport_context_ptr->remote_url_str = NULL;
+        curlport_context_ptr->endpoint_ptr = NULL;
+        curlport_context_ptr->endpoint_pool_generation = 0;
         curlport_context_ptr->curlport_response.string_space = CURLPORT_RECV_BUF_SIZE_STEP;
         curlport_context_ptr->curlport_response.string_len = 0;
 
 
-        curlport_context_ptr->curlport_response.string_ptr = BoatMalloc(CURLPORT_RECV_BUF_SIZE_STEP);
+        curlport_context_ptr->curlport_response.string_ptr = BoatMallocPersistent(CURLPORT_RECV_BUF_SIZE_STEP);
         
         if( curlport_context_ptr->curlport_response.string_ptr == NULL )
         {
@@ -237,7 +642,7 @@ size_t CurlPortWriteMemoryCallback(void *data_ptr, size_t size, size_t nmemb, vo
         expand_steps = (expand_size - 1) / CURLPORT_RECV_BUF_SIZE_STEP + 1;
         expanded_to_space = expand_steps * CURLPORT_RECV_BUF_SIZE_STEP + mem->string_space;
     
-        expanded_str = BoatMalloc(expanded_to_space);
+        expanded_str = BoatMallocPersistent(expanded_to_space);
 
         if( expanded_str != NULL )
         {
@@ -262,8 +667,11 @@ size_t CurlPortWriteMemoryCallback(void *data_ptr, size_t size, size_t nmemb, vo
 
 Function: CurlPortRequestSync()
 
-    This function initiates a curl session, performs a synchronous HTTP POST
-    and waits for its response.
+    This function performs a synchronous HTTP POST and waits for its response.
+
+    The POST is sent through a connection leased from the endpoint of the node
+    URL (see BOAT_RPC_ENDPOINT_MAX_NUM), which is kept alive for later requests
+    to the same node from any context.
 
 @see https://curl.haxx.se/libcurl/c/curl_easy_setopt.html
 @see https://curl.haxx.se/libcurl/c/curl_easy_perform.html
@@ -304,8 +712,8 @@ BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
                                BOAT_OUT BCHAR **response_str_ptr,
                                BOAT_OUT BUINT32 *response_len_ptr)
 {
+    CurlPortEndpoint *endpoint_ptr = NULL;
     CURL *curl_ctx_ptr = NULL;
-    struct curl_slist *curl_opt_list_ptr = NULL;
     CURLcode curl_result;
     
     long info;
@@ -314,6 +722,7 @@ BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
 
 
     if(   curlport_context_ptr == NULL
+       || curlport_context_ptr->remote_url_str == NULL
        || request_str == NULL
        || response_str_ptr == NULL
        || response_len_ptr == NULL )
@@ -323,75 +732,22 @@ BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
         boat_throw(BOAT_ERROR_NULL_POINTER, CurlPortRequestSync_cleanup);
     }
 
-    curl_ctx_ptr = curl_easy_init();
+    endpoint_ptr = CurlPortEndpointGet(curlport_context_ptr);
+
+    curl_ctx_ptr = CurlPortConnLease(curlport_context_ptr->remote_url_str, endpoint_ptr);
     
     if(curl_ctx_ptr == NULL)
     {
-        BoatLog(BOAT_LOG_CRITICAL, "curl_easy_init() fails.");
+        BoatLog(BOAT_LOG_CRITICAL, "Fail to get a connection to %s.", curlport_context_ptr->remote_url_str);
         result = BOAT_ERROR_EXT_MODULE_OPERATION_FAIL;
         boat_throw(BOAT_ERROR_EXT_MODULE_OPERATION_FAIL, CurlPortRequestSync_cleanup);
     }
-    
-    // Set RPC URL in format "<protocol>://<target name or IP>:<port>". e.g. "http://192.168.56.1:7545"
-    curl_result = curl_easy_setopt(curl_ctx_ptr, CURLOPT_URL, curlport_context_ptr->remote_url_str);
-    if( curl_result != CURLE_OK )
-    {
-        BoatLog(BOAT_LOG_NORMAL, "Unknown URL: %s", curlport_context_ptr->remote_url_str);
-        boat_throw(BOAT_ERROR_EXT_MODULE_OPERATION_FAIL, CurlPortRequestSync_cleanup);
-    }
-
-    // Configure all protocols to be supported
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_PROTOCOLS, CURLPROTO_ALL);
-                   
-    // Configure SSL Certification Verification
-    // If certification file is not available, set them to 0.
-    // See: https://curl.haxx.se/libcurl/c/CURLOPT_SSL_VERIFYPEER.html
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_SSL_VERIFYPEER, 0);
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_SSL_VERIFYHOST, 0);
-
-    // To specify a certificate file or specify a path containing certification files
-    // Only make sense when CURLOPT_SSL_VERIFYPEER is set to non-zero.
-    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_CAINFO, "/etc/certs/cabundle.pem");
-    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_CAPATH, "/etc/cert-dir");
-
-    // Allow Re-direction
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_FOLLOWLOCATION,1); 
-
-    // Verbose Debug Info.
-    // curl_easy_setopt(curl_ctx_ptr, CURLOPT_VERBOSE, 1);
-
-
-    // Set HTTP Type: POST
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_POST, 1L);
-
-    // Set redirection: No
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_FOLLOWLOCATION, 0);
-
-    // Set entire curl timeout in millisecond. This time includes DNS resloving.
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_TIMEOUT_MS, 30000L);
-
-    // Set Connection timeout in millisecond
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_CONNECTTIMEOUT_MS, 10000L);
-
-    // Set HTTP HEADER Options
-    curl_opt_list_ptr = curl_slist_append(curl_opt_list_ptr,"Content-Type:application/json;charset=UTF-8");
-    if( curl_opt_list_ptr == NULL ) boat_throw(BOAT_ERROR_EXT_MODULE_OPERATION_FAIL, CurlPortRequestSync_cleanup);
-    
-    curl_opt_list_ptr = curl_slist_append(curl_opt_list_ptr,"Accept:application/json, text/javascript, */*;q=0.01");
-    if( curl_opt_list_ptr == NULL ) boat_throw(BOAT_ERROR_EXT_MODULE_OPERATION_FAIL, CurlPortRequestSync_cleanup);
-
-    curl_opt_list_ptr = curl_slist_append(curl_opt_list_ptr,"Accept-Language:zh-CN,zh;q=0.8");
-    if( curl_opt_list_ptr == NULL ) boat_throw(BOAT_ERROR_EXT_MODULE_OPERATION_FAIL, CurlPortRequestSync_cleanup);
-
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_HTTPHEADER, curl_opt_list_ptr);
-
 
     // Set callback and receive buffer for RESPONSE
     // Clean up response buffer
     curlport_context_ptr->curlport_response.string_ptr[0] = '\0';
     curlport_context_ptr->curlport_response.string_len = 0;
     curl_easy_setopt(curl_ctx_ptr, CURLOPT_WRITEDATA, &curlport_context_ptr->curlport_response);
-    curl_easy_setopt(curl_ctx_ptr, CURLOPT_WRITEFUNCTION, CurlPortWriteMemoryCallback);
 
     // Set content to POST    
     curl_easy_setopt(curl_ctx_ptr, CURLOPT_POSTFIELDS, request_str);
@@ -426,8 +782,7 @@ BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
     }    
 
     // Clean Up
-    curl_slist_free_all(curl_opt_list_ptr);
-    curl_easy_cleanup(curl_ctx_ptr);
+    CurlPortConnReturn(endpoint_ptr, curl_ctx_ptr, BOAT_TRUE);
     
     result = BOAT_SUCCESS;
 
@@ -436,15 +791,11 @@ BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
     boat_catch(CurlPortRequestSync_cleanup)
     {
         BoatLog(BOAT_LOG_NORMAL, "Exception: %d", boat_exception);
-        
-        if( curl_opt_list_ptr != NULL )
-        {
-            curl_slist_free_all(curl_opt_list_ptr);
-        }
 
+        // A connection that failed is not reused
         if( curl_ctx_ptr != NULL )
         {
-            curl_easy_cleanup(curl_ctx_ptr);
+            CurlPortConnReturn(endpoint_ptr, curl_ctx_ptr, BOAT_FALSE);
         }
         result = boat_exception;
     }
@@ -38,10 +38,14 @@ To use libcurl porting, RPC_USE_LIBCURL in boatoptions.h must set to 1.
 
 
 
+struct TCurlPortEndpoint;
+
 typedef struct TCurlPortContext
 {
     BCHAR *remote_url_str;                 //!< URL of the blockchain node, e.g. "http://a.b.com:8545"
     StringWithLen curlport_response;    //!<  Store response from remote peer
+    struct TCurlPortEndpoint *endpoint_ptr; //!< Pooled endpoint of the last request, NULL if none
+    BUINT32 endpoint_pool_generation;   //!< Generation of the endpoint pool <endpoint_ptr> belongs to
 }CurlPortContext;
 
 #ifdef __cplusplus
@@ -54,6 +58,10 @@ void CurlPortDeinit(CurlPortContext * curlport_context_ptr);
 
 BOAT_RESULT CurlPortSetOpt(CurlPortContext * curlport_context_ptr, BCHAR *remote_url_str);
 
+void CurlPortPoolCleanup(void);
+
+size_t CurlPortWriteMemoryCallback(void *data_ptr, size_t size, size_t nmemb, void *userdata);
+
 BOAT_RESULT CurlPortRequestSync(CurlPortContext * curlport_context_ptr,
                                const BCHAR *request_str,
                                BUINT32 request_len,
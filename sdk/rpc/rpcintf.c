@@ -24,6 +24,7 @@ RPC_USE_XXX macros.
 
 #include "boatinternal.h"
 #include "rpcport.h"
+#include "boattxprofile.h"
 
 
 
@@ -94,6 +95,34 @@ void RpcDeinit(void *rpc_context_ptr)
 
 
 
+/*!*****************************************************************************
+@brief Wrapper function to release resources shared by all RPC contexts.
+
+Function: RpcCleanup()
+
+    This function releases resources that RPC contexts share, such as pooled
+    connections. It's called by BoatIotSdkDeInit() when no RPC request is in
+    progress. RPC contexts can still be used afterwards.
+    The exact implementation of the actual RPC mechanism is controlled by
+    RPC_USE_XXX macros.
+
+@see RpcInit()
+
+@return
+    This function doesn't return any value.
+
+*******************************************************************************/
+void RpcCleanup(void)
+{
+#if RPC_USE_LIBCURL == 1
+    CurlPortPoolCleanup();
+#endif
+
+    return;
+}
+
+
+
 /*!******************************************************************************
 @brief Wrapper function to perform RPC request and receive its response synchronously.
 
@@ -149,11 +178,19 @@ BOAT_RESULT RpcRequestSync(void *rpc_context_ptr,
                           BOAT_OUT BUINT32 *response_len_ptr)
 {
     BOAT_RESULT result;
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+
 #if RPC_USE_LIBCURL == 1
     result = CurlPortRequestSync(rpc_context_ptr, (const BCHAR *)request_ptr, request_len, (BOAT_OUT BCHAR **)response_pptr, response_len_ptr);
 #endif
 
+    if( result == BOAT_SUCCESS )
+    {
+        BOAT_TX_PROFILE_END(BOAT_TX_PHASE_HTTP_ROUNDTRIP, profile_start);
+    }
+
     return result;
 }
 
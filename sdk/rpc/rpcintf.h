@@ -42,6 +42,8 @@ void* RpcInit(void);
 
 void RpcDeinit(void *rpc_context_ptr);
 
+void RpcCleanup(void);
+
 
 BOAT_RESULT RpcRequestSync(void *rpc_context_ptr,
                           BUINT8 *request_ptr,
@@ -0,0 +1,583 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Bulk HEX conversion
+
+@file
+boathex.c contains the HEX conversion kernels. See boathex.h.
+
+A vector kernel converts whole vectors and returns how many bytes it has
+converted; the portable kernel converts the rest. While decoding, a vector
+kernel stops before the first vector with a non-HEX character, so that the
+portable kernel is the one that rejects it.
+*/
+
+#include "boatinternal.h"
+#include "boathex.h"
+
+#if BOAT_HEX_USE_SIMD == 1 && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BOAT_HEX_X86 1
+#include <immintrin.h>
+#else
+#define BOAT_HEX_X86 0
+#endif
+
+#if BOAT_HEX_USE_SIMD == 1 && defined(__aarch64__) && defined(__ARM_NEON)
+#define BOAT_HEX_NEON 1
+#include <arm_neon.h>
+#else
+#define BOAT_HEX_NEON 0
+#endif
+
+__BOATSTATIC const BCHAR g_boat_hex_digit_str[] = "0123456789abcdef";
+
+// BOAT_HEX_KERNEL_NUM until the kernel is selected
+__BOATSTATIC BUINT32 g_boat_hex_kernel = BOAT_HEX_KERNEL_NUM;
+
+
+__BOATSTATIC void BoatHexEncodePortable(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    BUINT32 i;
+
+    for( i = 0; i < from_len; i++ )
+    {
+        to_str[2 * i] = g_boat_hex_digit_str[from_ptr[i] >> 4];
+        to_str[2 * i + 1] = g_boat_hex_digit_str[from_ptr[i] & 0x0F];
+    }
+}
+
+
+// Returns the value of a HEX digit, or -1
+__BOATSTATIC BSINT32 BoatHexDigitValue(BCHAR halfbytechar)
+{
+    if( halfbytechar >= '0' && halfbytechar <= '9' )
+    {
+        return halfbytechar - '0';
+    }
+
+    // 'A' ~ 'F' to lower case, while nothing else becomes 'a' ~ 'f'
+    halfbytechar |= 0x20;
+
+    if( halfbytechar >= 'a' && halfbytechar <= 'f' )
+    {
+        return halfbytechar - 'a' + 0x0A;
+    }
+
+    return -1;
+}
+
+
+__BOATSTATIC BBOOL BoatHexDecodePortable(BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    BSINT32 high;
+    BSINT32 low;
+    BUINT32 i;
+
+    for( i = 0; i < to_len; i++ )
+    {
+        high = BoatHexDigitValue(from_str[2 * i]);
+        low = BoatHexDigitValue(from_str[2 * i + 1]);
+
+        if( high < 0 || low < 0 )
+        {
+            return BOAT_FALSE;
+        }
+
+        to_ptr[i] = (BUINT8)((high << 4) | low);
+    }
+
+    return BOAT_TRUE;
+}
+
+
+#if BOAT_HEX_X86 == 1
+
+// Digits of 16 nibbles: nibble + '0', plus 'a' - '0' - 10 for nibbles above 9
+__attribute__((target("sse2")))
+__BOATSTATIC __m128i BoatHexDigitsSse2(__m128i nibbles)
+{
+    __m128i letter_offset = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                          _mm_set1_epi8('a' - '0' - 10));
+
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letter_offset);
+}
+
+
+__attribute__((target("sse2")))
+__BOATSTATIC BUINT32 BoatHexEncodeSse2(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    __m128i mask = _mm_set1_epi8(0x0F);
+    __m128i bytes;
+    __m128i high;
+    __m128i low;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= from_len; i += 16 )
+    {
+        bytes = _mm_loadu_si128((const __m128i *)(from_ptr + i));
+        high = BoatHexDigitsSse2(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        low = BoatHexDigitsSse2(_mm_and_si128(bytes, mask));
+
+        _mm_storeu_si128((__m128i *)(to_str + 2 * i), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *)(to_str + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("ssse3")))
+__BOATSTATIC BUINT32 BoatHexEncodeSsse3(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    __m128i table = _mm_loadu_si128((const __m128i *)g_boat_hex_digit_str);
+    __m128i mask = _mm_set1_epi8(0x0F);
+    __m128i bytes;
+    __m128i high;
+    __m128i low;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= from_len; i += 16 )
+    {
+        bytes = _mm_loadu_si128((const __m128i *)(from_ptr + i));
+        high = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+        low = _mm_shuffle_epi8(table, _mm_and_si128(bytes, mask));
+
+        _mm_storeu_si128((__m128i *)(to_str + 2 * i), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i *)(to_str + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+__BOATSTATIC BUINT32 BoatHexEncodeAvx2(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)g_boat_hex_digit_str));
+    __m256i mask = _mm256_set1_epi8(0x0F);
+    __m256i bytes;
+    __m256i high;
+    __m256i low;
+    __m256i first;
+    __m256i second;
+    BUINT32 i;
+
+    for( i = 0; i + 32 <= from_len; i += 32 )
+    {
+        bytes = _mm256_loadu_si256((const __m256i *)(from_ptr + i));
+        high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+        low = _mm256_shuffle_epi8(table, _mm256_and_si256(bytes, mask));
+
+        // Unpacking interleaves within 128-bit lanes: bytes 0~7 and 16~23, 8~15 and 24~31
+        first = _mm256_unpacklo_epi8(high, low);
+        second = _mm256_unpackhi_epi8(high, low);
+
+        _mm256_storeu_si256((__m256i *)(to_str + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256((__m256i *)(to_str + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+
+    return i + BoatHexEncodeSsse3(to_str + 2 * i, from_ptr + i, from_len - i);
+}
+
+
+// Values of 16 HEX digits, and 0xFF in <valid_ptr> for each that is one
+__attribute__((target("sse2")))
+__BOATSTATIC __m128i BoatHexValuesSse2(__m128i digits, __m128i *valid_ptr)
+{
+    __m128i lower = _mm_or_si128(digits, _mm_set1_epi8(0x20));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(digits, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmplt_epi8(digits, _mm_set1_epi8('9' + 1)));
+    __m128i is_letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                      _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+    *valid_ptr = _mm_or_si128(is_digit, is_letter);
+
+    return _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(digits, _mm_set1_epi8('0'))),
+                        _mm_and_si128(is_letter, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+
+__attribute__((target("sse2")))
+__BOATSTATIC BUINT32 BoatHexDecodeSse2(BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    __m128i low_mask = _mm_set1_epi16(0x00F0);
+    __m128i first;
+    __m128i second;
+    __m128i first_valid;
+    __m128i second_valid;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= to_len; i += 16 )
+    {
+        first = BoatHexValuesSse2(_mm_loadu_si128((const __m128i *)(from_str + 2 * i)), &first_valid);
+        second = BoatHexValuesSse2(_mm_loadu_si128((const __m128i *)(from_str + 2 * i + 16)), &second_valid);
+
+        if( _mm_movemask_epi8(_mm_and_si128(first_valid, second_valid)) != 0xFFFF )
+        {
+            break;
+        }
+
+        // Each 16-bit lane holds the high nibble in its low byte and the low nibble in its high byte
+        first = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(first, 4), low_mask), _mm_srli_epi16(first, 8));
+        second = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(second, 4), low_mask), _mm_srli_epi16(second, 8));
+
+        _mm_storeu_si128((__m128i *)(to_ptr + i), _mm_packus_epi16(first, second));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("ssse3")))
+__BOATSTATIC BUINT32 BoatHexDecodeSsse3(BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    __m128i weights = _mm_set1_epi16(0x0110);
+    __m128i first;
+    __m128i second;
+    __m128i first_valid;
+    __m128i second_valid;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= to_len; i += 16 )
+    {
+        first = BoatHexValuesSse2(_mm_loadu_si128((const __m128i *)(from_str + 2 * i)), &first_valid);
+        second = BoatHexValuesSse2(_mm_loadu_si128((const __m128i *)(from_str + 2 * i + 16)), &second_valid);
+
+        if( _mm_movemask_epi8(_mm_and_si128(first_valid, second_valid)) != 0xFFFF )
+        {
+            break;
+        }
+
+        // high * 16 + low of each pair
+        first = _mm_maddubs_epi16(first, weights);
+        second = _mm_maddubs_epi16(second, weights);
+
+        _mm_storeu_si128((__m128i *)(to_ptr + i), _mm_packus_epi16(first, second));
+    }
+
+    return i;
+}
+
+
+__attribute__((target("avx2")))
+__BOATSTATIC __m256i BoatHexValuesAvx2(__m256i digits, __m256i *valid_ptr)
+{
+    __m256i lower = _mm256_or_si256(digits, _mm256_set1_epi8(0x20));
+    __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(digits, _mm256_set1_epi8('0' - 1)),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), digits));
+    __m256i is_letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                         _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+
+    *valid_ptr = _mm256_or_si256(is_digit, is_letter);
+
+    return _mm256_or_si256(_mm256_and_si256(is_digit, _mm256_sub_epi8(digits, _mm256_set1_epi8('0'))),
+                           _mm256_and_si256(is_letter, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+}
+
+
+__attribute__((target("avx2")))
+__BOATSTATIC BUINT32 BoatHexDecodeAvx2(BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    __m256i weights = _mm256_set1_epi16(0x0110);
+    __m256i first;
+    __m256i second;
+    __m256i first_valid;
+    __m256i second_valid;
+    BUINT32 i;
+
+    for( i = 0; i + 32 <= to_len; i += 32 )
+    {
+        first = BoatHexValuesAvx2(_mm256_loadu_si256((const __m256i *)(from_str + 2 * i)), &first_valid);
+        second = BoatHexValuesAvx2(_mm256_loadu_si256((const __m256i *)(from_str + 2 * i + 32)), &second_valid);
+
+        if( _mm256_movemask_epi8(_mm256_and_si256(first_valid, second_valid)) != -1 )
+        {
+            break;
+        }
+
+        first = _mm256_maddubs_epi16(first, weights);
+        second = _mm256_maddubs_epi16(second, weights);
+
+        // Packing works within 128-bit lanes, whose 64-bit halves are put back in order
+        _mm256_storeu_si256((__m256i *)(to_ptr + i),
+                            _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8));
+    }
+
+    return i + BoatHexDecodeSsse3(to_ptr + i, from_str + 2 * i, to_len - i);
+}
+
+#endif /* end of BOAT_HEX_X86 */
+
+
+#if BOAT_HEX_NEON == 1
+
+__BOATSTATIC BUINT32 BoatHexEncodeNeon(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    uint8x16_t table = vld1q_u8((const uint8_t *)g_boat_hex_digit_str);
+    uint8x16_t bytes;
+    uint8x16x2_t digits;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= from_len; i += 16 )
+    {
+        bytes = vld1q_u8(from_ptr + i);
+        digits.val[0] = vqtbl1q_u8(table, vshrq_n_u8(bytes, 4));
+        digits.val[1] = vqtbl1q_u8(table, vandq_u8(bytes, vdupq_n_u8(0x0F)));
+
+        // Stored interleaved
+        vst2q_u8((uint8_t *)(to_str + 2 * i), digits);
+    }
+
+    return i;
+}
+
+
+__BOATSTATIC uint8x16_t BoatHexValuesNeon(uint8x16_t digits, uint8x16_t *valid_ptr)
+{
+    uint8x16_t number = vsubq_u8(digits, vdupq_n_u8('0'));
+    uint8x16_t letter = vsubq_u8(vorrq_u8(digits, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    uint8x16_t is_digit = vcltq_u8(number, vdupq_n_u8(10));
+    uint8x16_t is_letter = vcltq_u8(letter, vdupq_n_u8(6));
+
+    *valid_ptr = vorrq_u8(is_digit, is_letter);
+
+    return vbslq_u8(is_digit, number, vaddq_u8(letter, vdupq_n_u8(10)));
+}
+
+
+__BOATSTATIC BUINT32 BoatHexDecodeNeon(BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    uint8x16x2_t digits;
+    uint8x16_t high;
+    uint8x16_t low;
+    uint8x16_t high_valid;
+    uint8x16_t low_valid;
+    BUINT32 i;
+
+    for( i = 0; i + 16 <= to_len; i += 16 )
+    {
+        // Loaded de-interleaved: high digits in val[0], low digits in val[1]
+        digits = vld2q_u8((const uint8_t *)(from_str + 2 * i));
+        high = BoatHexValuesNeon(digits.val[0], &high_valid);
+        low = BoatHexValuesNeon(digits.val[1], &low_valid);
+
+        if( vminvq_u8(vandq_u8(high_valid, low_valid)) != 0xFF )
+        {
+            break;
+        }
+
+        vst1q_u8(to_ptr + i, vsliq_n_u8(low, high, 4));
+    }
+
+    return i;
+}
+
+#endif /* end of BOAT_HEX_NEON */
+
+
+__BOATSTATIC BBOOL BoatHexKernelSupported(BoatHexKernel kernel)
+{
+    switch( kernel )
+    {
+        case BOAT_HEX_KERNEL_PORTABLE:
+            return BOAT_TRUE;
+#if BOAT_HEX_X86 == 1
+        case BOAT_HEX_KERNEL_SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? BOAT_TRUE : BOAT_FALSE;
+        case BOAT_HEX_KERNEL_SSSE3:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3") ? BOAT_TRUE : BOAT_FALSE;
+        case BOAT_HEX_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? BOAT_TRUE : BOAT_FALSE;
+#endif
+#if BOAT_HEX_NEON == 1
+        case BOAT_HEX_KERNEL_NEON:
+            return BOAT_TRUE;
+#endif
+        default:
+            return BOAT_FALSE;
+    }
+}
+
+
+/******************************************************************************
+@brief Get the HEX conversion kernel in use
+
+Function: BoatHexGetKernel()
+
+@return
+    This function returns the kernel, by default the widest one supported by the
+    build and the CPU.
+
+*******************************************************************************/
+BoatHexKernel BoatHexGetKernel(void)
+{
+    BUINT32 kernel = __atomic_load_n(&g_boat_hex_kernel, __ATOMIC_RELAXED);
+
+    if( kernel == BOAT_HEX_KERNEL_NUM )
+    {
+        // Threads racing here select the same one
+        kernel = BOAT_HEX_KERNEL_NUM - 1;
+        while( BoatHexKernelSupported(kernel) != BOAT_TRUE )
+        {
+            kernel--;
+        }
+
+        __atomic_store_n(&g_boat_hex_kernel, kernel, __ATOMIC_RELAXED);
+    }
+
+    return (BoatHexKernel)kernel;
+}
+
+
+/******************************************************************************
+@brief Select the HEX conversion kernel
+
+Function: BoatHexSetKernel()
+
+    This function selects the kernel of BoatHexEncode() and BoatHexDecode(),
+    e.g. for comparing them.
+
+@return
+    This function returns BOAT_SUCCESS if <kernel> is supported by the build and
+    the CPU. Otherwise it returns BOAT_ERROR and keeps the kernel in use.
+
+
+@param[in] kernel
+    The kernel.
+
+*******************************************************************************/
+BOAT_RESULT BoatHexSetKernel(BoatHexKernel kernel)
+{
+    if( BoatHexKernelSupported(kernel) != BOAT_TRUE )
+    {
+        return BOAT_ERROR;
+    }
+
+    __atomic_store_n(&g_boat_hex_kernel, (BUINT32)kernel, __ATOMIC_RELAXED);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert bytes to lower case HEX digits
+
+Function: BoatHexEncode()
+
+    This function writes 2 HEX digits for each byte without "0x" prefix, zero
+    trimming or null terminator, which are left to UtilityBin2Hex().
+
+@return
+    This function doesn't return anything.
+
+
+@param[out] to_str
+    The buffer of at least <from_len>*2 characters.
+
+@param[in] from_ptr
+    The bytes to convert.
+
+@param[in] from_len
+    The number of bytes to convert.
+
+*******************************************************************************/
+void BoatHexEncode(BOAT_OUT BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    BUINT32 done_len;
+
+    switch( BoatHexGetKernel() )
+    {
+#if BOAT_HEX_X86 == 1
+        case BOAT_HEX_KERNEL_SSE2:
+            done_len = BoatHexEncodeSse2(to_str, from_ptr, from_len);
+            break;
+        case BOAT_HEX_KERNEL_SSSE3:
+            done_len = BoatHexEncodeSsse3(to_str, from_ptr, from_len);
+            break;
+        case BOAT_HEX_KERNEL_AVX2:
+            done_len = BoatHexEncodeAvx2(to_str, from_ptr, from_len);
+            break;
+#endif
+#if BOAT_HEX_NEON == 1
+        case BOAT_HEX_KERNEL_NEON:
+            done_len = BoatHexEncodeNeon(to_str, from_ptr, from_len);
+            break;
+#endif
+        default:
+            done_len = 0;
+            break;
+    }
+
+    BoatHexEncodePortable(to_str + 2 * done_len, from_ptr + done_len, from_len - done_len);
+}
+
+
+/******************************************************************************
+@brief Convert pairs of HEX digits to bytes
+
+Function: BoatHexDecode()
+
+    This function converts <to_len>*2 HEX digits of either case to <to_len>
+    bytes. "0x" prefix, odd length and zero trimming are left to
+    UtilityHex2Bin().
+
+@return
+    This function returns BOAT_TRUE if all the characters are HEX digits.\n
+    Otherwise it returns BOAT_FALSE, with <to_ptr> partially written.
+
+
+@param[out] to_ptr
+    The buffer of at least <to_len> bytes.
+
+@param[in] from_str
+    The HEX digits to convert, not necessarily null-terminated.
+
+@param[in] to_len
+    The number of bytes to convert to.
+
+*******************************************************************************/
+BBOOL BoatHexDecode(BOAT_OUT BUINT8 *to_ptr, const BCHAR *from_str, BUINT32 to_len)
+{
+    BUINT32 done_len;
+
+    switch( BoatHexGetKernel() )
+    {
+#if BOAT_HEX_X86 == 1
+        case BOAT_HEX_KERNEL_SSE2:
+            done_len = BoatHexDecodeSse2(to_ptr, from_str, to_len);
+            break;
+        case BOAT_HEX_KERNEL_SSSE3:
+            done_len = BoatHexDecodeSsse3(to_ptr, from_str, to_len);
+            break;
+        case BOAT_HEX_KERNEL_AVX2:
+            done_len = BoatHexDecodeAvx2(to_ptr, from_str, to_len);
+            break;
+#endif
+#if BOAT_HEX_NEON == 1
+        case BOAT_HEX_KERNEL_NEON:
+            done_len = BoatHexDecodeNeon(to_ptr, from_str, to_len);
+            break;
+#endif
+        default:
+            done_len = 0;
+            break;
+    }
+
+    return BoatHexDecodePortable(to_ptr + done_len, from_str + 2 * done_len, to_len - done_len);
+}
@@ -0,0 +1,1089 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Asynchronous log
+
+@file
+boatlog.c contains the asynchronous backend of BoatLog().
+
+Each thread writes its logs into its own single-producer single-consumer ring
+buffer. A log is a record of the pointers to its format string, source file and
+function and a copy of its arguments, so that the calling thread never formats
+anything. A background thread takes the records of all ring buffers in the order
+they were written, formats and prints them.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "boatstaticpool.h"
+
+#if BOAT_LOG_ASYNC == 1
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#if (BOAT_LOG_ASYNC_BUFFER_SIZE & (BOAT_LOG_ASYNC_BUFFER_SIZE - 1)) != 0
+#error "BOAT_LOG_ASYNC_BUFFER_SIZE must be a power of 2"
+#endif
+
+#if BOAT_LOG_ASYNC_RECORD_MAX_SIZE % 8 != 0 || BOAT_LOG_ASYNC_RECORD_MAX_SIZE * 2 > BOAT_LOG_ASYNC_BUFFER_SIZE
+#error "BOAT_LOG_ASYNC_RECORD_MAX_SIZE must be a multiple of 8 and at most half of BOAT_LOG_ASYNC_BUFFER_SIZE"
+#endif
+
+// Records are aligned to 8 bytes in a ring buffer
+#define BOAT_LOG_RECORD_ALIGN 8
+
+// Sleep of the background thread when all ring buffers are empty
+#define BOAT_LOG_ASYNC_IDLE_NS 1000000
+
+// Size of a line formatted by the background thread
+#define BOAT_LOG_ASYNC_LINE_SIZE (2 * BOAT_LOG_ASYNC_RECORD_MAX_SIZE)
+
+// Captured length of a NULL string
+#define BOAT_LOG_NULL_STRING_LEN 0xFFFFFFFF
+
+//!@brief State of the background thread
+typedef enum
+{
+    BOAT_LOG_ASYNC_NOT_STARTED = 0,
+    BOAT_LOG_ASYNC_RUNNING,
+    BOAT_LOG_ASYNC_STOPPING,
+    BOAT_LOG_ASYNC_STOPPED
+}BoatLogAsyncState;
+
+//!@brief Length modifier of a conversion specification
+typedef enum
+{
+    BOAT_LOG_LENGTH_NONE = 0,
+    BOAT_LOG_LENGTH_HH,
+    BOAT_LOG_LENGTH_H,
+    BOAT_LOG_LENGTH_L,
+    BOAT_LOG_LENGTH_LL,
+    BOAT_LOG_LENGTH_J,
+    BOAT_LOG_LENGTH_Z,
+    BOAT_LOG_LENGTH_T,
+    BOAT_LOG_LENGTH_LONG_DOUBLE
+}BoatLogLength;
+
+//!@brief A conversion specification of a format string
+typedef struct TBoatLogSpec
+{
+    const BCHAR *flags_ptr;  //!< Flags, not terminated
+    BUINT32 flags_len;       //!< Length of the flags
+    BBOOL is_width_star;     //!< The width is an argument
+    BBOOL has_width;         //!< <width> is valid
+    BSINT32 width;           //!< Field width
+    BBOOL is_precision_star; //!< The precision is an argument
+    BBOOL has_precision;     //!< <precision> is valid
+    BSINT32 precision;       //!< Precision
+    BoatLogLength length;    //!< Length modifier
+    BCHAR conversion;        //!< Conversion specifier, or 0 if it's not supported
+}BoatLogSpec;
+
+/*!@brief Header of a log in a ring buffer
+
+    The arguments follow the header in the order of <format>. Integers, characters
+    and pointers take 8 bytes, a double 8 bytes and a long double sizeof(long double)
+    bytes. A string takes its 4-byte length followed by the characters.
+*/
+typedef struct TBoatLogRecord
+{
+    BUINT32 size;         //!< Size of the record with its arguments, taking up a multiple of BOAT_LOG_RECORD_ALIGN
+    BUINT32 level;        //!< Log level, or BOAT_LOG_NONE for padding up to the end of the ring buffer
+    BUINT64 seq;          //!< Order of the log among all threads
+    const BCHAR *file_str;
+    const BCHAR *func_str;
+    const BCHAR *format;
+    BUINT32 line;
+    BUINT32 is_truncated; //!< Arguments after the last one in the record are missing
+}BoatLogRecord;
+
+//!@brief Ring buffer of a thread, written by the thread and read by the background thread
+typedef struct TBoatLogRing
+{
+    struct TBoatLogRing *next_ptr; //!< Next ring buffer in the list of all
+    BUINT32 head;                  //!< Offset of the next record to write, wrapping around
+    BUINT32 tail;                  //!< Offset of the next record to read, wrapping around
+    BUINT32 is_orphan;             //!< The thread has exited
+    BUINT64 buffer[BOAT_LOG_ASYNC_BUFFER_SIZE / sizeof(BUINT64)];
+}BoatLogRing;
+
+//!@brief Cursor over the arguments of a record
+typedef struct TBoatLogArgs
+{
+    BUINT8 *ptr;
+    BUINT8 *end_ptr;
+}BoatLogArgs;
+
+
+__BOATSTATIC pthread_once_t g_boat_log_async_once = PTHREAD_ONCE_INIT;
+__BOATSTATIC pthread_key_t g_boat_log_ring_key;
+__BOATSTATIC pthread_t g_boat_log_async_thread;
+__BOATSTATIC BUINT32 g_boat_log_async_state = BOAT_LOG_ASYNC_NOT_STARTED;
+
+// Pushed by any thread, unlinked only by the background thread
+__BOATSTATIC BoatLogRing *g_boat_log_ring_list = NULL;
+
+// Set as the ring buffer of a thread while it's being allocated, so that a log
+// of the allocator itself is dropped instead of allocating again
+__BOATSTATIC BUINT8 g_boat_log_ring_allocating;
+
+__BOATSTATIC BUINT64 g_boat_log_seq = 0;
+__BOATSTATIC BoatLogAsyncStats g_boat_log_async_stats;
+__BOATSTATIC BUINT64 g_boat_log_printed_num = 0;
+
+
+// Parses the conversion specification after '%' and returns the character after it
+__BOATSTATIC const BCHAR *BoatLogParseSpec(const BCHAR *format, BoatLogSpec *spec_ptr)
+{
+    memset(spec_ptr, 0x00, sizeof(BoatLogSpec));
+
+    spec_ptr->flags_ptr = format;
+    while( *format != '\0' && strchr("-+ #0", *format) != NULL )
+    {
+        format++;
+    }
+    spec_ptr->flags_len = format - spec_ptr->flags_ptr;
+
+    if( *format == '*' )
+    {
+        spec_ptr->is_width_star = BOAT_TRUE;
+        format++;
+    }
+    else
+    {
+        while( *format >= '0' && *format <= '9' )
+        {
+            spec_ptr->has_width = BOAT_TRUE;
+            spec_ptr->width = BOAT_MIN(spec_ptr->width * 10 + (*format - '0'), 99999);
+            format++;
+        }
+    }
+
+    if( *format == '.' )
+    {
+        spec_ptr->has_precision = BOAT_TRUE;
+        format++;
+
+        if( *format == '*' )
+        {
+            spec_ptr->is_precision_star = BOAT_TRUE;
+            format++;
+        }
+        else
+        {
+            while( *format >= '0' && *format <= '9' )
+            {
+                spec_ptr->precision = BOAT_MIN(spec_ptr->precision * 10 + (*format - '0'), 99999);
+                format++;
+            }
+        }
+    }
+
+    switch( *format )
+    {
+        case 'h':
+            format++;
+            spec_ptr->length = (*format == 'h') ? BOAT_LOG_LENGTH_HH : BOAT_LOG_LENGTH_H;
+            format += (*format == 'h');
+            break;
+        case 'l':
+            format++;
+            spec_ptr->length = (*format == 'l') ? BOAT_LOG_LENGTH_LL : BOAT_LOG_LENGTH_L;
+            format += (*format == 'l');
+            break;
+        case 'j':
+            spec_ptr->length = BOAT_LOG_LENGTH_J;
+            format++;
+            break;
+        case 'z':
+            spec_ptr->length = BOAT_LOG_LENGTH_Z;
+            format++;
+            break;
+        case 't':
+            spec_ptr->length = BOAT_LOG_LENGTH_T;
+            format++;
+            break;
+        case 'L':
+            spec_ptr->length = BOAT_LOG_LENGTH_LONG_DOUBLE;
+            format++;
+            break;
+        default:
+            break;
+    }
+
+    if( *format != '\0' && strchr("diouxXcspfFeEgGaA%", *format) != NULL )
+    {
+        spec_ptr->conversion = *format;
+        format++;
+    }
+
+    return format;
+}
+
+
+__BOATSTATIC BBOOL BoatLogArgsPut(BoatLogArgs *args_ptr, const void *value_ptr, BUINT32 len)
+{
+    if( len > (BUINT32)(args_ptr->end_ptr - args_ptr->ptr) )
+    {
+        return BOAT_FALSE;
+    }
+
+    memcpy(args_ptr->ptr, value_ptr, len);
+    args_ptr->ptr += len;
+
+    return BOAT_TRUE;
+}
+
+
+__BOATSTATIC BBOOL BoatLogArgsGet(BoatLogArgs *args_ptr, void *value_ptr, BUINT32 len)
+{
+    if( len > (BUINT32)(args_ptr->end_ptr - args_ptr->ptr) )
+    {
+        return BOAT_FALSE;
+    }
+
+    memcpy(value_ptr, args_ptr->ptr, len);
+    args_ptr->ptr += len;
+
+    return BOAT_TRUE;
+}
+
+
+// Copies a string argument, truncated to the space left
+__BOATSTATIC BBOOL BoatLogArgsPutString(BoatLogArgs *args_ptr, const BCHAR *str, const BoatLogSpec *spec_ptr)
+{
+    BUINT32 len;
+    BUINT32 space;
+
+    if( str == NULL )
+    {
+        len = BOAT_LOG_NULL_STRING_LEN;
+        return BoatLogArgsPut(args_ptr, &len, sizeof(len));
+    }
+
+    space = args_ptr->end_ptr - args_ptr->ptr;
+    if( space < sizeof(len) )
+    {
+        return BOAT_FALSE;
+    }
+    space -= sizeof(len);
+
+    // A string with a precision may not be terminated
+    len = (spec_ptr->has_precision == BOAT_TRUE && spec_ptr->precision >= 0)
+          ? strnlen(str, BOAT_MIN((BUINT32)spec_ptr->precision, space + 1))
+          : strnlen(str, space + 1);
+
+    if( len > space )
+    {
+        len = space;
+        BoatLogArgsPut(args_ptr, &len, sizeof(len));
+        BoatLogArgsPut(args_ptr, str, len);
+        return BOAT_FALSE;
+    }
+
+    BoatLogArgsPut(args_ptr, &len, sizeof(len));
+
+    return BoatLogArgsPut(args_ptr, str, len);
+}
+
+
+// Copies the arguments of <format> and returns BOAT_FALSE if not all of them fit
+__BOATSTATIC BBOOL BoatLogCapture(const BCHAR *format, BoatLogArgs *args_ptr, va_list ap)
+{
+    BoatLogSpec spec;
+    BSINT64 int_value;
+    BUINT64 uint_value;
+    double double_value;
+    long double long_double_value;
+    BBOOL is_captured = BOAT_TRUE;
+
+    while( *format != '\0' && is_captured == BOAT_TRUE )
+    {
+        if( *format++ != '%' )
+        {
+            continue;
+        }
+
+        format = BoatLogParseSpec(format, &spec);
+
+        if( spec.conversion == 0 || spec.conversion == '%' )
+        {
+            continue;
+        }
+
+        if( spec.is_width_star == BOAT_TRUE )
+        {
+            int_value = va_arg(ap, int);
+            is_captured = BoatLogArgsPut(args_ptr, &int_value, sizeof(int_value));
+        }
+
+        if( spec.is_precision_star == BOAT_TRUE )
+        {
+            int_value = va_arg(ap, int);
+            spec.precision = (BSINT32)int_value;
+            is_captured = is_captured && BoatLogArgsPut(args_ptr, &int_value, sizeof(int_value));
+        }
+
+        if( is_captured != BOAT_TRUE )
+        {
+            break;
+        }
+
+        switch( spec.conversion )
+        {
+            case 'd':
+            case 'i':
+                switch( spec.length )
+                {
+                    case BOAT_LOG_LENGTH_HH: int_value = (signed char)va_arg(ap, int); break;
+                    case BOAT_LOG_LENGTH_H:  int_value = (short)va_arg(ap, int);       break;
+                    case BOAT_LOG_LENGTH_L:  int_value = va_arg(ap, long);             break;
+                    case BOAT_LOG_LENGTH_LL: int_value = va_arg(ap, long long);        break;
+                    case BOAT_LOG_LENGTH_J:  int_value = va_arg(ap, intmax_t);         break;
+                    case BOAT_LOG_LENGTH_Z:  int_value = (BSINT64)va_arg(ap, size_t);  break;
+                    case BOAT_LOG_LENGTH_T:  int_value = va_arg(ap, ptrdiff_t);        break;
+                    default:                 int_value = va_arg(ap, int);              break;
+                }
+                is_captured = BoatLogArgsPut(args_ptr, &int_value, sizeof(int_value));
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                switch( spec.length )
+                {
+                    case BOAT_LOG_LENGTH_HH: uint_value = (unsigned char)va_arg(ap, unsigned int);  break;
+                    case BOAT_LOG_LENGTH_H:  uint_value = (unsigned short)va_arg(ap, unsigned int); break;
+                    case BOAT_LOG_LENGTH_L:  uint_value = va_arg(ap, unsigned long);                break;
+                    case BOAT_LOG_LENGTH_LL: uint_value = va_arg(ap, unsigned long long);           break;
+                    case BOAT_LOG_LENGTH_J:  uint_value = va_arg(ap, uintmax_t);                    break;
+                    case BOAT_LOG_LENGTH_Z:  uint_value = va_arg(ap, size_t);                       break;
+                    case BOAT_LOG_LENGTH_T:  uint_value = (size_t)va_arg(ap, ptrdiff_t);            break;
+                    default:                 uint_value = va_arg(ap, unsigned int);                 break;
+                }
+                is_captured = BoatLogArgsPut(args_ptr, &uint_value, sizeof(uint_value));
+                break;
+
+            case 'c':
+                int_value = va_arg(ap, int);
+                is_captured = BoatLogArgsPut(args_ptr, &int_value, sizeof(int_value));
+                break;
+
+            case 'p':
+                uint_value = (uintptr_t)va_arg(ap, void *);
+                is_captured = BoatLogArgsPut(args_ptr, &uint_value, sizeof(uint_value));
+                break;
+
+            case 's':
+                is_captured = BoatLogArgsPutString(args_ptr, va_arg(ap, const BCHAR *), &spec);
+                break;
+
+            default:
+                if( spec.length == BOAT_LOG_LENGTH_LONG_DOUBLE )
+                {
+                    long_double_value = va_arg(ap, long double);
+                    is_captured = BoatLogArgsPut(args_ptr, &long_double_value, sizeof(long_double_value));
+                }
+                else
+                {
+                    double_value = va_arg(ap, double);
+                    is_captured = BoatLogArgsPut(args_ptr, &double_value, sizeof(double_value));
+                }
+                break;
+        }
+    }
+
+    return is_captured;
+}
+
+
+// Builds a conversion specification for snprintf() with the given length modifier
+__BOATSTATIC void BoatLogBuildSpec(BCHAR *spec_str, const BoatLogSpec *spec_ptr, const BCHAR *length_str)
+{
+    BCHAR *spec_end_ptr = spec_str;
+
+    *spec_end_ptr++ = '%';
+    memcpy(spec_end_ptr, spec_ptr->flags_ptr, BOAT_MIN(spec_ptr->flags_len, 5));
+    spec_end_ptr += BOAT_MIN(spec_ptr->flags_len, 5);
+
+    if( spec_ptr->has_width == BOAT_TRUE )
+    {
+        spec_end_ptr += sprintf(spec_end_ptr, "%d", (int)spec_ptr->width);
+    }
+
+    if( spec_ptr->has_precision == BOAT_TRUE && spec_ptr->precision >= 0 )
+    {
+        spec_end_ptr += sprintf(spec_end_ptr, ".%d", (int)spec_ptr->precision);
+    }
+
+    sprintf(spec_end_ptr, "%s%c", length_str, spec_ptr->conversion);
+}
+
+
+__BOATSTATIC void BoatLogLineAdvance(BUINT32 *line_len_ptr, int printed_len)
+{
+    if( printed_len > 0 )
+    {
+        *line_len_ptr = BOAT_MIN(*line_len_ptr + (BUINT32)printed_len, BOAT_LOG_ASYNC_LINE_SIZE - 2);
+    }
+}
+
+
+// Formats a record into a line terminated by '\n'
+__BOATSTATIC void BoatLogFormat(BoatLogRecord *record_ptr, BCHAR *line_str)
+{
+    BoatLogArgs args;
+    BoatLogSpec spec;
+    BCHAR spec_str[48];
+    const BCHAR *format = record_ptr->format;
+    const BCHAR *spec_begin_ptr;
+    const BCHAR *str;
+    BUINT32 line_len = 0;
+    BUINT32 str_len;
+    BSINT64 int_value;
+    BUINT64 uint_value;
+    double double_value;
+    long double long_double_value;
+    BBOOL is_got = BOAT_TRUE;
+
+    args.ptr = (BUINT8 *)(record_ptr + 1);
+    args.end_ptr = (BUINT8 *)record_ptr + record_ptr->size;
+
+    BoatLogLineAdvance(&line_len, snprintf(line_str, BOAT_LOG_ASYNC_LINE_SIZE - 1, "%s: %s:%u, %s(): ",
+                                           g_log_level_name_str[record_ptr->level - 1],
+                                           record_ptr->file_str, record_ptr->line, record_ptr->func_str));
+
+    while( *format != '\0' && is_got == BOAT_TRUE )
+    {
+        if( *format != '%' )
+        {
+            if( line_len < BOAT_LOG_ASYNC_LINE_SIZE - 2 )
+            {
+                line_str[line_len++] = *format;
+            }
+            format++;
+            continue;
+        }
+
+        spec_begin_ptr = format;
+        format = BoatLogParseSpec(format + 1, &spec);
+
+        if( spec.conversion == 0 )
+        {
+            // Not a conversion, printed as is
+            BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                   "%.*s", (int)(format - spec_begin_ptr), spec_begin_ptr));
+            continue;
+        }
+
+        if( spec.conversion == '%' )
+        {
+            if( line_len < BOAT_LOG_ASYNC_LINE_SIZE - 2 )
+            {
+                line_str[line_len++] = '%';
+            }
+            continue;
+        }
+
+        if( spec.is_width_star == BOAT_TRUE )
+        {
+            is_got = BoatLogArgsGet(&args, &int_value, sizeof(int_value));
+            spec.has_width = BOAT_TRUE;
+            spec.width = (BSINT32)int_value;
+        }
+
+        if( spec.is_precision_star == BOAT_TRUE )
+        {
+            is_got = is_got && BoatLogArgsGet(&args, &int_value, sizeof(int_value));
+            spec.precision = (BSINT32)int_value;
+        }
+
+        if( is_got != BOAT_TRUE )
+        {
+            break;
+        }
+
+        switch( spec.conversion )
+        {
+            case 'd':
+            case 'i':
+                is_got = BoatLogArgsGet(&args, &int_value, sizeof(int_value));
+                BoatLogBuildSpec(spec_str, &spec, "ll");
+                if( is_got == BOAT_TRUE )
+                {
+                    BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                           spec_str, (long long)int_value));
+                }
+                break;
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                is_got = BoatLogArgsGet(&args, &uint_value, sizeof(uint_value));
+                BoatLogBuildSpec(spec_str, &spec, "ll");
+                if( is_got == BOAT_TRUE )
+                {
+                    BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                           spec_str, (unsigned long long)uint_value));
+                }
+                break;
+
+            case 'c':
+                is_got = BoatLogArgsGet(&args, &int_value, sizeof(int_value));
+                BoatLogBuildSpec(spec_str, &spec, "");
+                if( is_got == BOAT_TRUE )
+                {
+                    BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                           spec_str, (int)int_value));
+                }
+                break;
+
+            case 'p':
+                is_got = BoatLogArgsGet(&args, &uint_value, sizeof(uint_value));
+                BoatLogBuildSpec(spec_str, &spec, "");
+                if( is_got == BOAT_TRUE )
+                {
+                    BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                           spec_str, (void *)(uintptr_t)uint_value));
+                }
+                break;
+
+            case 's':
+                is_got = BoatLogArgsGet(&args, &str_len, sizeof(str_len));
+                if( is_got == BOAT_TRUE && str_len == BOAT_LOG_NULL_STRING_LEN )
+                {
+                    str = "(null)";
+                }
+                else
+                {
+                    // Printed up to the captured length, which may be truncated
+                    str = (const BCHAR *)args.ptr;
+                    str_len = BOAT_MIN(str_len, (BUINT32)(args.end_ptr - args.ptr));
+                    args.ptr += str_len;
+                    spec.has_precision = BOAT_TRUE;
+                    spec.precision = (BSINT32)str_len;
+                }
+                BoatLogBuildSpec(spec_str, &spec, "");
+                if( is_got == BOAT_TRUE )
+                {
+                    BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                           spec_str, str));
+                }
+                break;
+
+            default:
+                if( spec.length == BOAT_LOG_LENGTH_LONG_DOUBLE )
+                {
+                    is_got = BoatLogArgsGet(&args, &long_double_value, sizeof(long_double_value));
+                    BoatLogBuildSpec(spec_str, &spec, "L");
+                    if( is_got == BOAT_TRUE )
+                    {
+                        BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                               spec_str, long_double_value));
+                    }
+                }
+                else
+                {
+                    is_got = BoatLogArgsGet(&args, &double_value, sizeof(double_value));
+                    BoatLogBuildSpec(spec_str, &spec, "");
+                    if( is_got == BOAT_TRUE )
+                    {
+                        BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len,
+                                                               spec_str, double_value));
+                    }
+                }
+                break;
+        }
+
+        // Nothing after the last captured argument is printed
+        if( record_ptr->is_truncated == BOAT_TRUE && args.ptr == args.end_ptr )
+        {
+            break;
+        }
+    }
+
+    if( record_ptr->is_truncated == BOAT_TRUE )
+    {
+        BoatLogLineAdvance(&line_len, snprintf(line_str + line_len, BOAT_LOG_ASYNC_LINE_SIZE - 1 - line_len, "..."));
+    }
+
+    line_str[line_len++] = '\n';
+    line_str[line_len] = '\0';
+}
+
+
+// Returns the first record of a ring buffer, or NULL if it's empty
+__BOATSTATIC BoatLogRecord *BoatLogRingFront(BoatLogRing *ring_ptr)
+{
+    BoatLogRecord *record_ptr;
+    BUINT32 head = __atomic_load_n(&ring_ptr->head, __ATOMIC_ACQUIRE);
+    BUINT32 tail = ring_ptr->tail;
+
+    while( tail != head )
+    {
+        record_ptr = (BoatLogRecord *)((BUINT8 *)ring_ptr->buffer + (tail & (BOAT_LOG_ASYNC_BUFFER_SIZE - 1)));
+
+        if( record_ptr->level != BOAT_LOG_NONE )
+        {
+            return record_ptr;
+        }
+
+        // Padding up to the end of the ring buffer
+        tail += BOAT_ROUNDUP(record_ptr->size, BOAT_LOG_RECORD_ALIGN);
+        __atomic_store_n(&ring_ptr->tail, tail, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+
+// Writes a record into a ring buffer, or returns BOAT_FALSE if it's full
+__BOATSTATIC BBOOL BoatLogRingPush(BoatLogRing *ring_ptr, const BoatLogRecord *record_ptr)
+{
+    BoatLogRecord *padding_ptr;
+    BUINT32 head = __atomic_load_n(&ring_ptr->head, __ATOMIC_RELAXED);
+    BUINT32 tail = __atomic_load_n(&ring_ptr->tail, __ATOMIC_ACQUIRE);
+    BUINT32 offset = head & (BOAT_LOG_ASYNC_BUFFER_SIZE - 1);
+    BUINT32 record_size = BOAT_ROUNDUP(record_ptr->size, BOAT_LOG_RECORD_ALIGN);
+    BUINT32 padding_size = 0;
+
+    // A record never wraps around the end of the ring buffer
+    if( record_size > BOAT_LOG_ASYNC_BUFFER_SIZE - offset )
+    {
+        padding_size = BOAT_LOG_ASYNC_BUFFER_SIZE - offset;
+    }
+
+    if( padding_size + record_size > BOAT_LOG_ASYNC_BUFFER_SIZE - (head - tail) )
+    {
+        return BOAT_FALSE;
+    }
+
+    if( padding_size > 0 )
+    {
+        padding_ptr = (BoatLogRecord *)((BUINT8 *)ring_ptr->buffer + offset);
+        padding_ptr->size = padding_size;
+        padding_ptr->level = BOAT_LOG_NONE;
+        head += padding_size;
+        offset = 0;
+    }
+
+    memcpy((BUINT8 *)ring_ptr->buffer + offset, record_ptr, record_ptr->size);
+    __atomic_store_n(&ring_ptr->head, head + record_size, __ATOMIC_RELEASE);
+
+    return BOAT_TRUE;
+}
+
+
+// Frees the ring buffers of exited threads once they are empty
+__BOATSTATIC void BoatLogRingReap(void)
+{
+    BoatLogRing *ring_ptr = __atomic_load_n(&g_boat_log_ring_list, __ATOMIC_ACQUIRE);
+    BoatLogRing *prev_ptr = NULL;
+    BoatLogRing *next_ptr;
+    BoatLogRing *expected_ptr;
+
+    while( ring_ptr != NULL )
+    {
+        next_ptr = ring_ptr->next_ptr;
+
+        if(    __atomic_load_n(&ring_ptr->is_orphan, __ATOMIC_ACQUIRE) == BOAT_TRUE
+            && BoatLogRingFront(ring_ptr) == NULL )
+        {
+            if( prev_ptr != NULL )
+            {
+                prev_ptr->next_ptr = next_ptr;
+            }
+            else
+            {
+                expected_ptr = ring_ptr;
+                if( !__atomic_compare_exchange_n(&g_boat_log_ring_list, &expected_ptr, next_ptr,
+                                                 BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) )
+                {
+                    // Other threads have pushed their ring buffers before it
+                    prev_ptr = expected_ptr;
+                    while( prev_ptr->next_ptr != ring_ptr )
+                    {
+                        prev_ptr = prev_ptr->next_ptr;
+                    }
+                    prev_ptr->next_ptr = next_ptr;
+                }
+            }
+
+            BoatDefaultFree(ring_ptr);
+        }
+        else
+        {
+            prev_ptr = ring_ptr;
+        }
+
+        ring_ptr = next_ptr;
+    }
+}
+
+
+// Prints all records in the order they were written and returns their number
+__BOATSTATIC BUINT32 BoatLogAsyncDrain(BCHAR *line_str)
+{
+    BoatLogRing *ring_ptr;
+    BoatLogRing *first_ring_ptr;
+    BoatLogRecord *record_ptr;
+    BoatLogRecord *first_record_ptr;
+    BUINT32 printed_num = 0;
+
+    while( 1 )
+    {
+        first_ring_ptr = NULL;
+        first_record_ptr = NULL;
+
+        for( ring_ptr = __atomic_load_n(&g_boat_log_ring_list, __ATOMIC_ACQUIRE);
+             ring_ptr != NULL;
+             ring_ptr = ring_ptr->next_ptr )
+        {
+            record_ptr = BoatLogRingFront(ring_ptr);
+            if( record_ptr != NULL && (first_record_ptr == NULL || record_ptr->seq < first_record_ptr->seq) )
+            {
+                first_ring_ptr = ring_ptr;
+                first_record_ptr = record_ptr;
+            }
+        }
+
+        if( first_record_ptr == NULL )
+        {
+            break;
+        }
+
+        BoatLogFormat(first_record_ptr, line_str);
+        fputs(line_str, stdout);
+
+        __atomic_store_n(&first_ring_ptr->tail,
+                         first_ring_ptr->tail + BOAT_ROUNDUP(first_record_ptr->size, BOAT_LOG_RECORD_ALIGN),
+                         __ATOMIC_RELEASE);
+        printed_num++;
+    }
+
+    if( printed_num > 0 )
+    {
+        fflush(stdout);
+        __atomic_add_fetch(&g_boat_log_printed_num, printed_num, __ATOMIC_RELEASE);
+    }
+
+    BoatLogRingReap();
+
+    return printed_num;
+}
+
+
+__BOATSTATIC void *BoatLogAsyncThread(void *arg)
+{
+    static BCHAR line_str[BOAT_LOG_ASYNC_LINE_SIZE];
+    struct timespec idle = {0, BOAT_LOG_ASYNC_IDLE_NS};
+    BUINT64 reported_dropped_num = 0;
+    BUINT64 dropped_num;
+
+    (void)arg;
+
+    while( 1 )
+    {
+        if( BoatLogAsyncDrain(line_str) == 0 )
+        {
+            if( __atomic_load_n(&g_boat_log_async_state, __ATOMIC_ACQUIRE) != BOAT_LOG_ASYNC_RUNNING )
+            {
+                break;
+            }
+            nanosleep(&idle, NULL);
+        }
+
+        dropped_num = __atomic_load_n(&g_boat_log_async_stats.dropped_num, __ATOMIC_RELAXED);
+        if( dropped_num != reported_dropped_num )
+        {
+            printf("%s: "__FILE__":%d, %s(): %llu logs dropped.\n", g_log_level_name_str[BOAT_LOG_CRITICAL - 1],
+                   __LINE__, __func__, dropped_num - reported_dropped_num);
+            reported_dropped_num = dropped_num;
+        }
+    }
+
+    fflush(stdout);
+
+    return NULL;
+}
+
+
+// Destructor of the thread-specific ring buffer, which is freed by the background thread
+__BOATSTATIC void BoatLogRingRelease(void *ring_ptr)
+{
+    __atomic_store_n(&((BoatLogRing *)ring_ptr)->is_orphan, BOAT_TRUE, __ATOMIC_RELEASE);
+}
+
+
+__BOATSTATIC void BoatLogAsyncStart(void)
+{
+    BUINT32 state = BOAT_LOG_ASYNC_NOT_STARTED;
+
+    // Stopped before the first log
+    if( !__atomic_compare_exchange_n(&g_boat_log_async_state, &state, BOAT_LOG_ASYNC_RUNNING,
+                                     BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) )
+    {
+        return;
+    }
+
+    if(    pthread_key_create(&g_boat_log_ring_key, BoatLogRingRelease) == 0
+        && pthread_create(&g_boat_log_async_thread, NULL, BoatLogAsyncThread, NULL) == 0 )
+    {
+        atexit(BoatLogAsyncStop);
+        return;
+    }
+
+    __atomic_store_n(&g_boat_log_async_state, BOAT_LOG_ASYNC_STOPPED, __ATOMIC_RELEASE);
+}
+
+
+// Returns the ring buffer of the calling thread, or NULL if it can't be allocated
+__BOATSTATIC BoatLogRing *BoatLogThreadRing(void)
+{
+    BoatLogRing *ring_ptr = pthread_getspecific(g_boat_log_ring_key);
+
+    if( ring_ptr == (void *)&g_boat_log_ring_allocating )
+    {
+        return NULL;
+    }
+    if( ring_ptr != NULL )
+    {
+        return ring_ptr;
+    }
+
+    if( pthread_setspecific(g_boat_log_ring_key, &g_boat_log_ring_allocating) != 0 )
+    {
+        return NULL;
+    }
+
+    // The ring buffer outlives the thread and is freed by the background thread,
+    // maybe after another allocator is set, so it's never from BoatMalloc()
+    ring_ptr = BoatDefaultMalloc(sizeof(BoatLogRing));
+    if( ring_ptr == NULL )
+    {
+        pthread_setspecific(g_boat_log_ring_key, NULL);
+        return NULL;
+    }
+
+    ring_ptr->head = 0;
+    ring_ptr->tail = 0;
+    ring_ptr->is_orphan = BOAT_FALSE;
+
+    if( pthread_setspecific(g_boat_log_ring_key, ring_ptr) != 0 )
+    {
+        pthread_setspecific(g_boat_log_ring_key, NULL);
+        BoatDefaultFree(ring_ptr);
+        return NULL;
+    }
+
+    ring_ptr->next_ptr = __atomic_load_n(&g_boat_log_ring_list, __ATOMIC_RELAXED);
+    while( !__atomic_compare_exchange_n(&g_boat_log_ring_list, &ring_ptr->next_ptr, ring_ptr,
+                                        BOAT_TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED) )
+    {
+        // next_ptr is reloaded by the failed exchange
+    }
+
+    return ring_ptr;
+}
+
+
+/******************************************************************************
+@brief Write a log into the ring buffer of the calling thread
+
+Function: BoatLogAsyncWrite()
+
+    This function is called by BoatLog(). It copies the arguments of <format>
+    into a record and writes it into the ring buffer of the calling thread
+    without blocking. The record is dropped if the ring buffer is full.
+
+@return
+    This function doesn't return anything.
+
+
+@param[in] level
+    Log priority level.
+
+@param[in] file_str
+    Source file of the log, a string literal.
+
+@param[in] line
+    Source line of the log.
+
+@param[in] func_str
+    Function of the log, a string literal.
+
+@param[in] format
+    Similar to that in printf(), a string literal.
+
+*******************************************************************************/
+void BoatLogAsyncWrite(BUINT32 level, const BCHAR *file_str, BUINT32 line,
+                       const BCHAR *func_str, const BCHAR *format, ...)
+{
+    BUINT64 record_buf[BOAT_LOG_ASYNC_RECORD_MAX_SIZE / sizeof(BUINT64)];
+    BoatLogRecord *record_ptr = (BoatLogRecord *)record_buf;
+    BoatLogRing *ring_ptr;
+    BoatLogArgs args;
+    va_list ap;
+
+    if( level == BOAT_LOG_NONE || level > BOAT_LOG_VERBOSE )
+    {
+        return;
+    }
+
+    pthread_once(&g_boat_log_async_once, BoatLogAsyncStart);
+
+    va_start(ap, format);
+
+    if( __atomic_load_n(&g_boat_log_async_state, __ATOMIC_ACQUIRE) != BOAT_LOG_ASYNC_RUNNING )
+    {
+        // Printed synchronously if the background thread is stopped
+        printf("%s: %s:%u, %s(): ", g_log_level_name_str[level - 1], file_str, line, func_str);
+        vprintf(format, ap);
+        printf("\n");
+        va_end(ap);
+        return;
+    }
+
+    ring_ptr = BoatLogThreadRing();
+    if( ring_ptr == NULL )
+    {
+        va_end(ap);
+        __atomic_add_fetch(&g_boat_log_async_stats.dropped_num, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    args.ptr = (BUINT8 *)(record_ptr + 1);
+    args.end_ptr = (BUINT8 *)record_buf + sizeof(record_buf);
+
+    record_ptr->is_truncated = !BoatLogCapture(format, &args, ap);
+    va_end(ap);
+
+    record_ptr->size = (BUINT32)(args.ptr - (BUINT8 *)record_buf);
+    record_ptr->level = level;
+    record_ptr->file_str = file_str;
+    record_ptr->func_str = func_str;
+    record_ptr->format = format;
+    record_ptr->line = line;
+    record_ptr->seq = __atomic_fetch_add(&g_boat_log_seq, 1, __ATOMIC_RELAXED);
+
+    if( record_ptr->is_truncated == BOAT_TRUE )
+    {
+        __atomic_add_fetch(&g_boat_log_async_stats.truncated_num, 1, __ATOMIC_RELAXED);
+    }
+
+    if( BoatLogRingPush(ring_ptr, record_ptr) == BOAT_TRUE )
+    {
+        __atomic_add_fetch(&g_boat_log_async_stats.written_num, 1, __ATOMIC_RELEASE);
+    }
+    else
+    {
+        __atomic_add_fetch(&g_boat_log_async_stats.dropped_num, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+/******************************************************************************
+@brief Wait until all logs written before are printed
+
+Function: BoatLogAsyncFlush()
+
+@return
+    This function doesn't return anything.
+
+*******************************************************************************/
+void BoatLogAsyncFlush(void)
+{
+    struct timespec idle = {0, BOAT_LOG_ASYNC_IDLE_NS};
+    BUINT64 written_num = __atomic_load_n(&g_boat_log_async_stats.written_num, __ATOMIC_ACQUIRE);
+    BUINT32 state;
+
+    while( __atomic_load_n(&g_boat_log_printed_num, __ATOMIC_ACQUIRE) < written_num )
+    {
+        state = __atomic_load_n(&g_boat_log_async_state, __ATOMIC_ACQUIRE);
+        if( state != BOAT_LOG_ASYNC_RUNNING && state != BOAT_LOG_ASYNC_STOPPING )
+        {
+            break;
+        }
+        nanosleep(&idle, NULL);
+    }
+
+    fflush(stdout);
+}
+
+
+/******************************************************************************
+@brief Print all pending logs and stop the background thread
+
+Function: BoatLogAsyncStop()
+
+@return
+    This function doesn't return anything.
+
+*******************************************************************************/
+void BoatLogAsyncStop(void)
+{
+    BUINT32 state = BOAT_LOG_ASYNC_RUNNING;
+
+    if( __atomic_compare_exchange_n(&g_boat_log_async_state, &state, BOAT_LOG_ASYNC_STOPPING,
+                                    BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) )
+    {
+        pthread_join(g_boat_log_async_thread, NULL);
+        __atomic_store_n(&g_boat_log_async_state, BOAT_LOG_ASYNC_STOPPED, __ATOMIC_RELEASE);
+    }
+    else if( state == BOAT_LOG_ASYNC_NOT_STARTED )
+    {
+        __atomic_compare_exchange_n(&g_boat_log_async_state, &state, BOAT_LOG_ASYNC_STOPPED,
+                                    BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+}
+
+
+/******************************************************************************
+@brief Get the counters of the asynchronous log
+
+Function: BoatLogAsyncGetStats()
+
+@return
+    This function returns BOAT_SUCCESS if <stats_ptr> is filled.\n
+    Otherwise it returns BOAT_ERROR_NULL_POINTER.
+
+
+@param[out] stats_ptr
+    The counters.
+
+*******************************************************************************/
+BOAT_RESULT BoatLogAsyncGetStats(BOAT_OUT BoatLogAsyncStats *stats_ptr)
+{
+    if( stats_ptr == NULL )
+    {
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    stats_ptr->written_num = __atomic_load_n(&g_boat_log_async_stats.written_num, __ATOMIC_RELAXED);
+    stats_ptr->dropped_num = __atomic_load_n(&g_boat_log_async_stats.dropped_num, __ATOMIC_RELAXED);
+    stats_ptr->truncated_num = __atomic_load_n(&g_boat_log_async_stats.truncated_num, __ATOMIC_RELAXED);
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,254 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Static block pools
+
+@file
+boatstaticpool.c contains the static block pools. See boatstaticpool.h.
+*/
+
+#include "boatinternal.h"
+#include "boatstaticpool.h"
+
+#include <pthread.h>
+
+#if BOAT_USE_STATIC_POOL == 1
+
+#if    (BOAT_STATIC_POOL_0_BLOCK_SIZE % 16) != 0 || (BOAT_STATIC_POOL_1_BLOCK_SIZE % 16) != 0 \
+    || (BOAT_STATIC_POOL_2_BLOCK_SIZE % 16) != 0 || (BOAT_STATIC_POOL_3_BLOCK_SIZE % 16) != 0 \
+    || (BOAT_STATIC_POOL_4_BLOCK_SIZE % 16) != 0 || (BOAT_STATIC_POOL_5_BLOCK_SIZE % 16) != 0
+#error "Static pool block sizes shall be multiples of 16"
+#endif
+
+#if    BOAT_STATIC_POOL_0_BLOCK_SIZE >= BOAT_STATIC_POOL_1_BLOCK_SIZE \
+    || BOAT_STATIC_POOL_1_BLOCK_SIZE >= BOAT_STATIC_POOL_2_BLOCK_SIZE \
+    || BOAT_STATIC_POOL_2_BLOCK_SIZE >= BOAT_STATIC_POOL_3_BLOCK_SIZE \
+    || BOAT_STATIC_POOL_3_BLOCK_SIZE >= BOAT_STATIC_POOL_4_BLOCK_SIZE \
+    || BOAT_STATIC_POOL_4_BLOCK_SIZE >= BOAT_STATIC_POOL_5_BLOCK_SIZE
+#error "Static pool block sizes shall be in increasing order"
+#endif
+
+// Blocks are aligned for any type
+#define BOAT_STATIC_POOL_STORAGE(n) \
+    __BOATSTATIC BUINT8 g_boat_static_pool_storage_##n[BOAT_STATIC_POOL_##n##_BLOCK_NUM * BOAT_STATIC_POOL_##n##_BLOCK_SIZE] \
+        __attribute__((aligned(16)))
+
+BOAT_STATIC_POOL_STORAGE(0);
+BOAT_STATIC_POOL_STORAGE(1);
+BOAT_STATIC_POOL_STORAGE(2);
+BOAT_STATIC_POOL_STORAGE(3);
+BOAT_STATIC_POOL_STORAGE(4);
+BOAT_STATIC_POOL_STORAGE(5);
+
+
+//!@brief A free block, linked into the free list of its pool
+typedef struct TBoatStaticPoolBlock
+{
+    struct TBoatStaticPoolBlock *next_ptr;
+}BoatStaticPoolBlock;
+
+//!@brief A pool of blocks of the same size
+typedef struct TBoatStaticPool
+{
+    BUINT8 * const storage_ptr;
+    const BUINT32 block_size;
+    const BUINT32 block_num;
+
+    pthread_mutex_t lock;
+    BoatStaticPoolBlock *free_head_ptr; //!< Blocks freed after use
+    BUINT32 unused_index;               //!< Blocks from this index on have never been used
+    BUINT32 used_num;
+    BUINT32 peak_used_num;
+    BUINT32 fail_num;
+}BoatStaticPool;
+
+#define BOAT_STATIC_POOL_INITIALIZER(n) \
+    {g_boat_static_pool_storage_##n, BOAT_STATIC_POOL_##n##_BLOCK_SIZE, BOAT_STATIC_POOL_##n##_BLOCK_NUM, \
+     PTHREAD_MUTEX_INITIALIZER, NULL, 0, 0, 0, 0}
+
+__BOATSTATIC BoatStaticPool g_boat_static_pool_array[BOAT_STATIC_POOL_NUM] =
+{
+    BOAT_STATIC_POOL_INITIALIZER(0),
+    BOAT_STATIC_POOL_INITIALIZER(1),
+    BOAT_STATIC_POOL_INITIALIZER(2),
+    BOAT_STATIC_POOL_INITIALIZER(3),
+    BOAT_STATIC_POOL_INITIALIZER(4),
+    BOAT_STATIC_POOL_INITIALIZER(5)
+};
+
+
+__BOATSTATIC void *BoatStaticPoolTake(BoatStaticPool *pool_ptr)
+{
+    void *mem_ptr = NULL;
+
+    pthread_mutex_lock(&pool_ptr->lock);
+
+    if( pool_ptr->free_head_ptr != NULL )
+    {
+        mem_ptr = pool_ptr->free_head_ptr;
+        pool_ptr->free_head_ptr = pool_ptr->free_head_ptr->next_ptr;
+    }
+    else if( pool_ptr->unused_index < pool_ptr->block_num )
+    {
+        mem_ptr = pool_ptr->storage_ptr + (size_t)pool_ptr->unused_index * pool_ptr->block_size;
+        pool_ptr->unused_index++;
+    }
+
+    if( mem_ptr != NULL )
+    {
+        pool_ptr->used_num++;
+        pool_ptr->peak_used_num = BOAT_MAX(pool_ptr->peak_used_num, pool_ptr->used_num);
+    }
+
+    pthread_mutex_unlock(&pool_ptr->lock);
+
+    return mem_ptr;
+}
+
+
+/******************************************************************************
+@brief Allocate a block from the static pools
+
+Function: BoatStaticPoolMalloc()
+
+    This function takes a free block of the smallest pool that fits <size>. If
+    the pool is exhausted, larger pools are tried in increasing order.
+
+@return
+    This function returns the address of the block.\n
+    If no free block fits, it returns NULL.
+
+@param[in] size
+    How many bytes to allocate.
+
+*******************************************************************************/
+void *BoatStaticPoolMalloc(BUINT32 size)
+{
+    BoatStaticPool *pool_ptr;
+    BUINT32 fit_index;
+    BUINT32 i;
+    void *mem_ptr;
+
+    for( fit_index = 0; fit_index < BOAT_STATIC_POOL_NUM - 1; fit_index++ )
+    {
+        if( size <= g_boat_static_pool_array[fit_index].block_size )
+        {
+            break;
+        }
+    }
+
+    for( i = fit_index; i < BOAT_STATIC_POOL_NUM; i++ )
+    {
+        if( size <= g_boat_static_pool_array[i].block_size )
+        {
+            mem_ptr = BoatStaticPoolTake(&g_boat_static_pool_array[i]);
+            if( mem_ptr != NULL )
+            {
+                return mem_ptr;
+            }
+        }
+    }
+
+    pool_ptr = &g_boat_static_pool_array[fit_index];
+
+    pthread_mutex_lock(&pool_ptr->lock);
+    pool_ptr->fail_num++;
+    pthread_mutex_unlock(&pool_ptr->lock);
+
+    BoatLog(BOAT_LOG_CRITICAL, "Static pools exhausted for %u bytes.", size);
+
+    return NULL;
+}
+
+
+/******************************************************************************
+@brief Free a block to the static pools
+
+Function: BoatStaticPoolFree()
+
+@return
+    This function doesn't return anything.
+
+@param[in] mem_ptr
+    The block to free, returned by BoatStaticPoolMalloc().
+
+*******************************************************************************/
+void BoatStaticPoolFree(void *mem_ptr)
+{
+    BoatStaticPool *pool_ptr;
+    BoatStaticPoolBlock *block_ptr = mem_ptr;
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_STATIC_POOL_NUM; i++ )
+    {
+        pool_ptr = &g_boat_static_pool_array[i];
+
+        if(    (BUINT8 *)mem_ptr >= pool_ptr->storage_ptr
+            && (BUINT8 *)mem_ptr < pool_ptr->storage_ptr + (size_t)pool_ptr->block_num * pool_ptr->block_size )
+        {
+            pthread_mutex_lock(&pool_ptr->lock);
+            block_ptr->next_ptr = pool_ptr->free_head_ptr;
+            pool_ptr->free_head_ptr = block_ptr;
+            pool_ptr->used_num--;
+            pthread_mutex_unlock(&pool_ptr->lock);
+
+            return;
+        }
+    }
+
+    BoatLog(BOAT_LOG_CRITICAL, "%p is not allocated from static pools.", mem_ptr);
+}
+
+
+/******************************************************************************
+@brief Get usage statistics of a static block pool
+
+Function: BoatStaticPoolGetStats()
+
+@return
+    This function returns BOAT_SUCCESS if the statistics are got.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] pool_index
+    Index of the pool, 0 ~ BOAT_STATIC_POOL_NUM - 1.
+
+@param[out] stats_ptr
+    The statistics of the pool.
+
+*******************************************************************************/
+BOAT_RESULT BoatStaticPoolGetStats(BUINT32 pool_index, BOAT_OUT BoatStaticPoolStats *stats_ptr)
+{
+    BoatStaticPool *pool_ptr;
+
+    if( pool_index >= BOAT_STATIC_POOL_NUM || stats_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    pool_ptr = &g_boat_static_pool_array[pool_index];
+
+    pthread_mutex_lock(&pool_ptr->lock);
+    stats_ptr->block_size = pool_ptr->block_size;
+    stats_ptr->block_num = pool_ptr->block_num;
+    stats_ptr->used_num = pool_ptr->used_num;
+    stats_ptr->peak_used_num = pool_ptr->peak_used_num;
+    stats_ptr->fail_num = pool_ptr->fail_num;
+    pthread_mutex_unlock(&pool_ptr->lock);
+
+    return BOAT_SUCCESS;
+}
+
+#endif /* end of BOAT_USE_STATIC_POOL */
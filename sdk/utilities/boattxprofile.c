@@ -0,0 +1,364 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Transaction phase timers
+
+@file
+boattxprofile.c contains the latency histograms of transaction phases. See
+boattxprofile.h.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "boattxprofile.h"
+
+#if BOAT_TX_PROFILING == 1
+
+// Each power of 2 ns is split into 2^BOAT_TX_PROFILE_SUB_BITS buckets
+#define BOAT_TX_PROFILE_SUB_BITS 3
+#define BOAT_TX_PROFILE_SUB_NUM  (1 << BOAT_TX_PROFILE_SUB_BITS)
+
+//!@brief Latencies of a phase, updated with relaxed atomics by any thread
+typedef struct TBoatTxProfilePhase
+{
+    BUINT64 count;
+    BUINT64 total_ns;
+    BUINT64 min_ns;
+    BUINT64 max_ns;
+    BUINT32 bucket_count[BOAT_TX_PROFILE_BUCKET_NUM];
+}BoatTxProfilePhase;
+
+__BOATSTATIC BoatTxProfilePhase g_boat_tx_profile_phase[BOAT_TX_PHASE_NUM];
+
+#if BOAT_TX_PROFILING_DUMP_INTERVAL > 0
+__BOATSTATIC BUINT64 g_boat_tx_profile_dump_ns = 0;
+#endif
+
+__BOATSTATIC const BCHAR * const g_boat_tx_phase_name_str[BOAT_TX_PHASE_NUM] =
+{
+    "nonce fetch",
+    "gas price fetch",
+    "RLP encode",
+    "keccak",
+    "ECDSA sign",
+    "RLP re-encode",
+    "hex conversion",
+    "JSON build",
+    "HTTP round trip",
+    "JSON parse",
+    "receipt wait"
+};
+
+
+__BOATSTATIC BUINT32 BoatTxProfileBucketIndex(BUINT64 value_ns)
+{
+    BUINT32 msb;
+
+    if( value_ns < BOAT_TX_PROFILE_SUB_NUM )
+    {
+        return (BUINT32)value_ns;
+    }
+
+    msb = 63 - __builtin_clzll(value_ns);
+
+    if( msb >= (BOAT_TX_PROFILE_BUCKET_NUM / BOAT_TX_PROFILE_SUB_NUM) + BOAT_TX_PROFILE_SUB_BITS - 1 )
+    {
+        return BOAT_TX_PROFILE_BUCKET_NUM - 1;
+    }
+
+    return   (msb - BOAT_TX_PROFILE_SUB_BITS + 1) * BOAT_TX_PROFILE_SUB_NUM
+           + (BUINT32)((value_ns >> (msb - BOAT_TX_PROFILE_SUB_BITS)) & (BOAT_TX_PROFILE_SUB_NUM - 1));
+}
+
+
+// Returns the highest latency counted by a bucket
+__BOATSTATIC BUINT64 BoatTxProfileBucketMax(BUINT32 index)
+{
+    BUINT32 msb;
+    BUINT64 sub;
+
+    if( index < BOAT_TX_PROFILE_SUB_NUM )
+    {
+        return index;
+    }
+
+    msb = index / BOAT_TX_PROFILE_SUB_NUM + BOAT_TX_PROFILE_SUB_BITS - 1;
+    sub = index % BOAT_TX_PROFILE_SUB_NUM;
+
+    return ((BOAT_TX_PROFILE_SUB_NUM + sub + 1) << (msb - BOAT_TX_PROFILE_SUB_BITS)) - 1;
+}
+
+
+BUINT64 BoatTxProfileNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (BUINT64)now.tv_sec * 1000000000ull + (BUINT64)now.tv_nsec;
+}
+
+
+void BoatTxProfileRecord(BoatTxPhase phase, BUINT64 elapsed_ns)
+{
+    BoatTxProfilePhase *phase_ptr;
+    BUINT64 old_ns;
+#if BOAT_TX_PROFILING_DUMP_INTERVAL > 0
+    BUINT64 now_ns;
+#endif
+
+    if( (BUINT32)phase >= BOAT_TX_PHASE_NUM )
+    {
+        return;
+    }
+
+    phase_ptr = &g_boat_tx_profile_phase[phase];
+
+    // min_ns of 0 means no latency has been recorded
+    old_ns = __atomic_load_n(&phase_ptr->min_ns, __ATOMIC_RELAXED);
+    while(    (old_ns == 0 || elapsed_ns < old_ns)
+           && !__atomic_compare_exchange_n(&phase_ptr->min_ns, &old_ns, BOAT_MAX(elapsed_ns, 1),
+                                           BOAT_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+    {
+        // old_ns is reloaded by the failed exchange
+    }
+
+    old_ns = __atomic_load_n(&phase_ptr->max_ns, __ATOMIC_RELAXED);
+    while(    elapsed_ns > old_ns
+           && !__atomic_compare_exchange_n(&phase_ptr->max_ns, &old_ns, elapsed_ns,
+                                           BOAT_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+    {
+        // old_ns is reloaded by the failed exchange
+    }
+
+    __atomic_add_fetch(&phase_ptr->bucket_count[BoatTxProfileBucketIndex(elapsed_ns)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&phase_ptr->total_ns, elapsed_ns, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&phase_ptr->count, 1, __ATOMIC_RELAXED);
+
+#if BOAT_TX_PROFILING_DUMP_INTERVAL > 0
+    // The thread that moves the dump time forward dumps
+    now_ns = BoatTxProfileNow();
+    old_ns = __atomic_load_n(&g_boat_tx_profile_dump_ns, __ATOMIC_RELAXED);
+
+    if( old_ns == 0 )
+    {
+        __atomic_compare_exchange_n(&g_boat_tx_profile_dump_ns, &old_ns, now_ns,
+                                    BOAT_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+    }
+    else if(    now_ns - old_ns >= BOAT_TX_PROFILING_DUMP_INTERVAL * 1000000000ull
+             && __atomic_compare_exchange_n(&g_boat_tx_profile_dump_ns, &old_ns, now_ns,
+                                            BOAT_FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
+    {
+        BoatTxProfileDump();
+    }
+#endif
+}
+
+
+/******************************************************************************
+@brief Get the latency histogram of a transaction phase
+
+Function: BoatTxProfileGetHistogram()
+
+@return
+    This function returns BOAT_SUCCESS if the histogram is got.\n
+    Otherwise it returns one of the error codes.
+
+
+@param[in] phase
+    The phase.
+
+@param[out] histogram_ptr
+    The histogram.
+
+*******************************************************************************/
+BOAT_RESULT BoatTxProfileGetHistogram(BoatTxPhase phase, BOAT_OUT BoatTxPhaseHistogram *histogram_ptr)
+{
+    const BoatTxProfilePhase *phase_ptr;
+    BUINT32 i;
+
+    if( (BUINT32)phase >= BOAT_TX_PHASE_NUM || histogram_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid phase %d or NULL histogram.", (int)phase);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    phase_ptr = &g_boat_tx_profile_phase[phase];
+
+    histogram_ptr->count    = __atomic_load_n(&phase_ptr->count, __ATOMIC_RELAXED);
+    histogram_ptr->total_ns = __atomic_load_n(&phase_ptr->total_ns, __ATOMIC_RELAXED);
+    histogram_ptr->min_ns   = __atomic_load_n(&phase_ptr->min_ns, __ATOMIC_RELAXED);
+    histogram_ptr->max_ns   = __atomic_load_n(&phase_ptr->max_ns, __ATOMIC_RELAXED);
+
+    for( i = 0; i < BOAT_TX_PROFILE_BUCKET_NUM; i++ )
+    {
+        histogram_ptr->bucket_count[i] = __atomic_load_n(&phase_ptr->bucket_count[i], __ATOMIC_RELAXED);
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Get a percentile of a latency histogram
+
+Function: BoatTxProfileGetPercentile()
+
+@return
+    This function returns the latency in ns that <percentile> percent of the\n
+    latencies don't exceed, or 0 if the histogram is empty.
+
+
+@param[in] histogram_ptr
+    The histogram.
+
+@param[in] percentile
+    The percentile, 0.0 ~ 100.0.
+
+*******************************************************************************/
+BUINT64 BoatTxProfileGetPercentile(const BoatTxPhaseHistogram *histogram_ptr, double percentile)
+{
+    BUINT64 total_count = 0;
+    BUINT64 rank;
+    BUINT64 count = 0;
+    BUINT32 i;
+
+    if( histogram_ptr == NULL )
+    {
+        return 0;
+    }
+
+    // Buckets are summed rather than taking <count>, which may be ahead of them
+    for( i = 0; i < BOAT_TX_PROFILE_BUCKET_NUM; i++ )
+    {
+        total_count += histogram_ptr->bucket_count[i];
+    }
+
+    if( total_count == 0 )
+    {
+        return 0;
+    }
+
+    percentile = BOAT_MIN(BOAT_MAX(percentile, 0.0), 100.0);
+    rank = (BUINT64)(percentile / 100.0 * total_count + 0.5);
+    rank = BOAT_MIN(BOAT_MAX(rank, 1), total_count);
+
+    for( i = 0; i < BOAT_TX_PROFILE_BUCKET_NUM; i++ )
+    {
+        count += histogram_ptr->bucket_count[i];
+        if( count >= rank )
+        {
+            break;
+        }
+    }
+
+    return BOAT_MIN(BoatTxProfileBucketMax(i), histogram_ptr->max_ns);
+}
+
+
+/******************************************************************************
+@brief Get the name of a transaction phase
+
+Function: BoatTxProfilePhaseName()
+
+@return
+    This function returns the name of <phase>, or "unknown".
+
+
+@param[in] phase
+    The phase.
+
+*******************************************************************************/
+const BCHAR *BoatTxProfilePhaseName(BoatTxPhase phase)
+{
+    if( (BUINT32)phase >= BOAT_TX_PHASE_NUM )
+    {
+        return "unknown";
+    }
+
+    return g_boat_tx_phase_name_str[phase];
+}
+
+
+/******************************************************************************
+@brief Reset the latency histograms of all transaction phases
+
+Function: BoatTxProfileReset()
+
+    Latencies recorded by other threads at the same time may be partly kept.
+
+@return
+    This function doesn't return anything.
+
+*******************************************************************************/
+void BoatTxProfileReset(void)
+{
+    BoatTxProfilePhase *phase_ptr;
+    BUINT32 i;
+    BUINT32 j;
+
+    for( i = 0; i < BOAT_TX_PHASE_NUM; i++ )
+    {
+        phase_ptr = &g_boat_tx_profile_phase[i];
+
+        __atomic_store_n(&phase_ptr->count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&phase_ptr->total_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&phase_ptr->min_ns, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&phase_ptr->max_ns, 0, __ATOMIC_RELAXED);
+
+        for( j = 0; j < BOAT_TX_PROFILE_BUCKET_NUM; j++ )
+        {
+            __atomic_store_n(&phase_ptr->bucket_count[j], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+
+/******************************************************************************
+@brief Log the latency histograms of all transaction phases
+
+Function: BoatTxProfileDump()
+
+@return
+    This function doesn't return anything.
+
+*******************************************************************************/
+void BoatTxProfileDump(void)
+{
+    BoatTxPhaseHistogram histogram;
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_TX_PHASE_NUM; i++ )
+    {
+        if( BoatTxProfileGetHistogram(i, &histogram) != BOAT_SUCCESS || histogram.count == 0 )
+        {
+            continue;
+        }
+
+        BoatLog(BOAT_LOG_NORMAL,
+                "%-16s count %llu, mean %.1f us, p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us",
+                g_boat_tx_phase_name_str[i],
+                histogram.count,
+                histogram.total_ns / 1e3 / histogram.count,
+                BoatTxProfileGetPercentile(&histogram, 50.0) / 1e3,
+                BoatTxProfileGetPercentile(&histogram, 90.0) / 1e3,
+                BoatTxProfileGetPercentile(&histogram, 99.0) / 1e3,
+                histogram.max_ns / 1e3);
+    }
+}
+
+#endif
@@ -0,0 +1,1513 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief 256-bit integer arithmetic
+
+@file
+boatuint256.c contains arithmetic and conversions of BUINT256 and BSINT256.
+
+Both are 4 64-bit limbs, the least significant first, and BSINT256 is in two's
+complement, so that they share the helpers below on limb arrays. Multiplication
+and division work on 32-bit digits, whose products fit in BUINT64.
+*/
+
+#include "boatinternal.h"
+
+#define BOAT_UINT256_LIMB_NUM  4
+#define BOAT_UINT256_DIGIT_NUM 8
+
+// 10^9, the largest power of 10 in a 32-bit digit
+#define BOAT_UINT256_DEC_CHUNK      1000000000u
+#define BOAT_UINT256_DEC_CHUNK_LEN  9
+
+// 1 ether is 10^18 wei
+#define BOAT_WEI_PER_ETH     1000000000000000000ull
+#define BOAT_WEI_PER_ETH_LEN 18
+
+#define BOAT_INT256_IS_NEGATIVE(limb) (((limb)[BOAT_UINT256_LIMB_NUM - 1] >> 63) != 0)
+
+
+__BOATSTATIC void BoatUint256ToDigits(BUINT32 digit_array[BOAT_UINT256_DIGIT_NUM], const BUINT64 *limb)
+{
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_UINT256_LIMB_NUM; i++ )
+    {
+        digit_array[2 * i] = (BUINT32)limb[i];
+        digit_array[2 * i + 1] = (BUINT32)(limb[i] >> 32);
+    }
+}
+
+
+__BOATSTATIC void BoatUint256FromDigits(BUINT64 *limb, const BUINT32 digit_array[BOAT_UINT256_DIGIT_NUM])
+{
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_UINT256_LIMB_NUM; i++ )
+    {
+        limb[i] = ((BUINT64)digit_array[2 * i + 1] << 32) | digit_array[2 * i];
+    }
+}
+
+
+// Returns the number of digits without leading zeros
+__BOATSTATIC BUINT32 BoatUint256DigitNum(const BUINT32 *digit_array, BUINT32 digit_num)
+{
+    while( digit_num > 0 && digit_array[digit_num - 1] == 0 )
+    {
+        digit_num--;
+    }
+
+    return digit_num;
+}
+
+
+__BOATSTATIC BBOOL BoatUint256IsZero(const BUINT64 *limb)
+{
+    return (limb[0] | limb[1] | limb[2] | limb[3]) == 0 ? BOAT_TRUE : BOAT_FALSE;
+}
+
+
+__BOATSTATIC BSINT32 BoatUint256CompareLimbs(const BUINT64 *a, const BUINT64 *b)
+{
+    BSINT32 i;
+
+    for( i = BOAT_UINT256_LIMB_NUM - 1; i >= 0; i-- )
+    {
+        if( a[i] != b[i] )
+        {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+
+// Returns the carry out
+__BOATSTATIC BUINT64 BoatUint256AddLimbs(BUINT64 *r, const BUINT64 *a, const BUINT64 *b)
+{
+    BUINT64 carry = 0;
+    BUINT64 sum;
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_UINT256_LIMB_NUM; i++ )
+    {
+        sum = a[i] + carry;
+        carry = (sum < carry);
+        r[i] = sum + b[i];
+        carry += (r[i] < sum);
+    }
+
+    return carry;
+}
+
+
+// Returns the borrow out
+__BOATSTATIC BUINT64 BoatUint256SubLimbs(BUINT64 *r, const BUINT64 *a, const BUINT64 *b)
+{
+    BUINT64 borrow = 0;
+    BUINT64 difference;
+    BUINT64 next_borrow;
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_UINT256_LIMB_NUM; i++ )
+    {
+        difference = a[i] - b[i];
+        next_borrow = (a[i] < b[i]);
+        next_borrow |= (difference < borrow);
+        r[i] = difference - borrow;
+        borrow = next_borrow;
+    }
+
+    return borrow;
+}
+
+
+__BOATSTATIC void BoatUint256NegateLimbs(BUINT64 *r, const BUINT64 *a)
+{
+    BUINT64 zero[BOAT_UINT256_LIMB_NUM] = {0, 0, 0, 0};
+
+    BoatUint256SubLimbs(r, zero, a);
+}
+
+
+// Returns BOAT_TRUE if the product exceeds 256 bits
+__BOATSTATIC BBOOL BoatUint256MulLimbs(BUINT64 *r, const BUINT64 *a, const BUINT64 *b)
+{
+    BUINT32 a_digit[BOAT_UINT256_DIGIT_NUM];
+    BUINT32 b_digit[BOAT_UINT256_DIGIT_NUM];
+    BUINT32 product_digit[2 * BOAT_UINT256_DIGIT_NUM] = {0};
+    BUINT64 t;
+    BUINT32 carry;
+    BUINT32 i, j;
+
+    BoatUint256ToDigits(a_digit, a);
+    BoatUint256ToDigits(b_digit, b);
+
+    for( i = 0; i < BOAT_UINT256_DIGIT_NUM; i++ )
+    {
+        if( a_digit[i] == 0 )
+        {
+            continue;
+        }
+
+        carry = 0;
+        for( j = 0; j < BOAT_UINT256_DIGIT_NUM; j++ )
+        {
+            // At most (2^32 - 1)^2 + 2 * (2^32 - 1) = 2^64 - 1
+            t = (BUINT64)a_digit[i] * b_digit[j] + product_digit[i + j] + carry;
+            product_digit[i + j] = (BUINT32)t;
+            carry = (BUINT32)(t >> 32);
+        }
+        product_digit[i + BOAT_UINT256_DIGIT_NUM] = carry;
+    }
+
+    BoatUint256FromDigits(r, product_digit);
+
+    return BoatUint256DigitNum(product_digit + BOAT_UINT256_DIGIT_NUM, BOAT_UINT256_DIGIT_NUM) != 0 ? BOAT_TRUE : BOAT_FALSE;
+}
+
+
+// <limb> = <limb> * <multiplier> + <addend>, returning the digit carried out
+__BOATSTATIC BUINT32 BoatUint256MulAddSmall(BUINT64 *limb, BUINT32 multiplier, BUINT32 addend)
+{
+    BUINT32 digit_array[BOAT_UINT256_DIGIT_NUM];
+    BUINT64 t;
+    BUINT32 carry = addend;
+    BUINT32 i;
+
+    BoatUint256ToDigits(digit_array, limb);
+
+    for( i = 0; i < BOAT_UINT256_DIGIT_NUM; i++ )
+    {
+        t = (BUINT64)digit_array[i] * multiplier + carry;
+        digit_array[i] = (BUINT32)t;
+        carry = (BUINT32)(t >> 32);
+    }
+
+    BoatUint256FromDigits(limb, digit_array);
+
+    return carry;
+}
+
+
+// <limb> = <limb> / <divisor>, returning the remainder
+__BOATSTATIC BUINT32 BoatUint256DivSmall(BUINT64 *limb, BUINT32 divisor)
+{
+    BUINT32 digit_array[BOAT_UINT256_DIGIT_NUM];
+    BUINT64 t;
+    BUINT32 remainder = 0;
+    BSINT32 i;
+
+    BoatUint256ToDigits(digit_array, limb);
+
+    for( i = BOAT_UINT256_DIGIT_NUM - 1; i >= 0; i-- )
+    {
+        t = ((BUINT64)remainder << 32) | digit_array[i];
+        digit_array[i] = (BUINT32)(t / divisor);
+        remainder = (BUINT32)(t % divisor);
+    }
+
+    BoatUint256FromDigits(limb, digit_array);
+
+    return remainder;
+}
+
+
+/*
+ * Long division of Knuth's Algorithm D (TAOCP 4.3.1) in 32-bit digits, as
+ * written in Hacker's Delight 9-2. <divisor_ptr> MUST NOT be 0.
+ */
+__BOATSTATIC void BoatUint256DivModLimbs(BUINT64 *quotient, BUINT64 *remainder,
+                                         const BUINT64 *dividend, const BUINT64 *divisor)
+{
+    const BUINT64 base = 1ull << 32;
+    BUINT32 u[BOAT_UINT256_DIGIT_NUM];
+    BUINT32 v[BOAT_UINT256_DIGIT_NUM];
+    BUINT32 q[BOAT_UINT256_DIGIT_NUM] = {0};
+    BUINT32 r[BOAT_UINT256_DIGIT_NUM] = {0};
+    BUINT32 un[BOAT_UINT256_DIGIT_NUM + 1];
+    BUINT32 vn[BOAT_UINT256_DIGIT_NUM];
+    BUINT64 qhat;
+    BUINT64 rhat;
+    BUINT64 p;
+    BUINT64 t_unsigned;
+    BSINT64 t;
+    BSINT64 k;
+    BUINT32 m, n, s;
+    BSINT32 i, j;
+
+    BoatUint256ToDigits(u, dividend);
+    BoatUint256ToDigits(v, divisor);
+    m = BoatUint256DigitNum(u, BOAT_UINT256_DIGIT_NUM);
+    n = BoatUint256DigitNum(v, BOAT_UINT256_DIGIT_NUM);
+
+    if( m < n )
+    {
+        // Quotient is 0
+        memcpy(r, u, sizeof(r));
+    }
+    else if( n == 1 )
+    {
+        k = 0;
+        for( j = m - 1; j >= 0; j-- )
+        {
+            t_unsigned = ((BUINT64)k << 32) | u[j];
+            q[j] = (BUINT32)(t_unsigned / v[0]);
+            k = (BSINT64)(t_unsigned % v[0]);
+        }
+        r[0] = (BUINT32)k;
+    }
+    else
+    {
+        // Normalize to make the leading digit of the divisor have its high bit set
+        for( s = 0; (v[n - 1] << s) < 0x80000000u; s++ )
+        {
+        }
+
+        for( i = n - 1; i > 0; i-- )
+        {
+            vn[i] = (v[i] << s) | (BUINT32)((BUINT64)v[i - 1] >> (32 - s));
+        }
+        vn[0] = v[0] << s;
+
+        un[m] = (BUINT32)((BUINT64)u[m - 1] >> (32 - s));
+        for( i = m - 1; i > 0; i-- )
+        {
+            un[i] = (u[i] << s) | (BUINT32)((BUINT64)u[i - 1] >> (32 - s));
+        }
+        un[0] = u[0] << s;
+
+        for( j = m - n; j >= 0; j-- )
+        {
+            // Estimate the quotient digit, which is at most 2 too large
+            t_unsigned = ((BUINT64)un[j + n] << 32) | un[j + n - 1];
+            qhat = t_unsigned / vn[n - 1];
+            rhat = t_unsigned % vn[n - 1];
+
+            while( qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2]) )
+            {
+                qhat--;
+                rhat += vn[n - 1];
+                if( rhat >= base )
+                {
+                    break;
+                }
+            }
+
+            // Multiply and subtract
+            k = 0;
+            for( i = 0; i < (BSINT32)n; i++ )
+            {
+                p = qhat * vn[i];
+                t = (BSINT64)un[i + j] - k - (BSINT64)(p & 0xFFFFFFFFu);
+                un[i + j] = (BUINT32)t;
+                k = (BSINT64)(p >> 32) - (t >> 32);
+            }
+            t = (BSINT64)un[j + n] - k;
+            un[j + n] = (BUINT32)t;
+
+            q[j] = (BUINT32)qhat;
+
+            // Add back if subtracted too much
+            if( t < 0 )
+            {
+                q[j]--;
+                t_unsigned = 0;
+                for( i = 0; i < (BSINT32)n; i++ )
+                {
+                    t_unsigned = (BUINT64)un[i + j] + vn[i] + t_unsigned;
+                    un[i + j] = (BUINT32)t_unsigned;
+                    t_unsigned >>= 32;
+                }
+                un[j + n] += (BUINT32)t_unsigned;
+            }
+        }
+
+        // Unnormalize the remainder
+        for( i = 0; i < (BSINT32)n; i++ )
+        {
+            r[i] = (un[i] >> s) | (BUINT32)((BUINT64)un[i + 1] << (32 - s));
+        }
+    }
+
+    if( quotient != NULL )
+    {
+        BoatUint256FromDigits(quotient, q);
+    }
+    if( remainder != NULL )
+    {
+        BoatUint256FromDigits(remainder, r);
+    }
+}
+
+
+__BOATSTATIC void BoatUint256ToBigendianLimbs(BUINT8 to_array[32], const BUINT64 *limb)
+{
+    BUINT32 i;
+
+    for( i = 0; i < 32; i++ )
+    {
+        to_array[31 - i] = (BUINT8)(limb[i / 8] >> (8 * (i % 8)));
+    }
+}
+
+
+__BOATSTATIC void BoatUint256FromBigendianLimbs(BUINT64 *limb, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    BUINT32 i;
+
+    memset(limb, 0, BOAT_UINT256_LIMB_NUM * sizeof(BUINT64));
+
+    for( i = 0; i < from_len; i++ )
+    {
+        limb[i / 8] |= (BUINT64)from_ptr[from_len - 1 - i] << (8 * (i % 8));
+    }
+}
+
+
+// Parses a decimal magnitude, returning BOAT_ERROR_INTEGER_OVERFLOW beyond 2^256 - 1
+__BOATSTATIC BOAT_RESULT BoatUint256ParseDec(BUINT64 *limb, const BCHAR *from_str)
+{
+    BUINT32 from_len = strlen(from_str);
+    BUINT32 chunk;
+    BUINT32 chunk_scale;
+    BUINT32 overflow = 0;
+    BUINT32 i;
+
+    if( from_len == 0 || strspn(from_str, "0123456789") != from_len )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "\"%s\" is not a decimal integer.", from_str);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    memset(limb, 0, BOAT_UINT256_LIMB_NUM * sizeof(BUINT64));
+
+    // 9 digits at a time
+    while( *from_str != '\0' )
+    {
+        chunk = 0;
+        chunk_scale = 1;
+        for( i = 0; i < BOAT_UINT256_DEC_CHUNK_LEN && *from_str != '\0'; i++ )
+        {
+            chunk = chunk * 10 + (BUINT32)(*from_str++ - '0');
+            chunk_scale *= 10;
+        }
+
+        overflow |= BoatUint256MulAddSmall(limb, chunk_scale, chunk);
+    }
+
+    return overflow != 0 ? BOAT_ERROR_INTEGER_OVERFLOW : BOAT_SUCCESS;
+}
+
+
+// Formats a magnitude in decimal after an optional sign, returning its length or 0
+__BOATSTATIC BUINT32 BoatUint256FormatDec(BCHAR *to_str, BUINT32 to_size, const BUINT64 *limb, BBOOL is_negative)
+{
+    BCHAR reversed_str[BOAT_UINT256_DEC_STR_SIZE];
+    BUINT64 quotient[BOAT_UINT256_LIMB_NUM];
+    BUINT32 chunk;
+    BUINT32 reversed_len = 0;
+    BUINT32 to_len = 0;
+    BUINT32 i;
+
+    if( to_str == NULL || limb == NULL )
+    {
+        return 0;
+    }
+
+    memcpy(quotient, limb, sizeof(quotient));
+
+    // 9 digits at a time, the least significant first
+    do
+    {
+        chunk = BoatUint256DivSmall(quotient, BOAT_UINT256_DEC_CHUNK);
+
+        for( i = 0; i < BOAT_UINT256_DEC_CHUNK_LEN; i++ )
+        {
+            reversed_str[reversed_len++] = (BCHAR)('0' + chunk % 10);
+            chunk /= 10;
+
+            if( chunk == 0 && BoatUint256IsZero(quotient) == BOAT_TRUE )
+            {
+                break;
+            }
+        }
+    }while( BoatUint256IsZero(quotient) != BOAT_TRUE );
+
+    if( reversed_len + (is_negative == BOAT_TRUE ? 1 : 0) + 1 > to_size )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Buffer of %u bytes is too small.", to_size);
+        return 0;
+    }
+
+    if( is_negative == BOAT_TRUE )
+    {
+        to_str[to_len++] = '-';
+    }
+
+    while( reversed_len > 0 )
+    {
+        to_str[to_len++] = reversed_str[--reversed_len];
+    }
+    to_str[to_len] = '\0';
+
+    return to_len;
+}
+
+
+/******************************************************************************
+@brief Convert a BUINT64 to BUINT256
+
+Function: UtilityUint256FromUint64()
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_integer
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityUint256FromUint64(BOAT_OUT BUINT256 *to_ptr, BUINT64 from_integer)
+{
+    if( to_ptr == NULL )
+    {
+        return;
+    }
+
+    memset(to_ptr, 0, sizeof(BUINT256));
+    to_ptr->limb[0] = from_integer;
+}
+
+
+/******************************************************************************
+@brief Convert a bigendian byte stream to BUINT256
+
+Function: UtilityUint256FromBigendian()
+
+    This function converts up to 32 bytes of bigendian integer, e.g. a uint256
+    in an ABI encoded return value. Longer streams are accepted if the extra
+    leading bytes are zeros.
+
+@return
+    This function returns BOAT_SUCCESS if the integer fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_ptr
+    The bigendian integer to convert.
+
+@param[in] from_len
+    The length of <from_ptr> in byte.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromBigendian(BOAT_OUT BUINT256 *to_ptr, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    if( to_ptr == NULL || (from_ptr == NULL && from_len != 0) )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Skip leading zeros
+    while( from_len > 32 )
+    {
+        if( *from_ptr != 0 )
+        {
+            return BOAT_ERROR_INTEGER_OVERFLOW;
+        }
+        from_ptr++;
+        from_len--;
+    }
+
+    BoatUint256FromBigendianLimbs(to_ptr->limb, from_ptr, from_len);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert a BUINT256 to 32 bytes of bigendian integer
+
+Function: UtilityUint256ToBigendian()
+
+    This function writes the 32-byte bigendian form of an integer, as an
+    ABI encoded uint256 argument. UtilityTrimBin() trims its leading zeros for
+    RLP encoding.
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_array
+    The bigendian integer.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityUint256ToBigendian(BOAT_OUT BUINT8 to_array[32], const BUINT256 *from_ptr)
+{
+    if( to_array == NULL || from_ptr == NULL )
+    {
+        return;
+    }
+
+    BoatUint256ToBigendianLimbs(to_array, from_ptr->limb);
+}
+
+
+/******************************************************************************
+@brief Convert a HEX string to BUINT256
+
+Function: UtilityUint256FromHex()
+
+    This function converts a HEX string, such as a balance returned by the
+    node, to BUINT256. "0x" prefix is optional.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> contains any non-HEX\n
+    character, or BOAT_ERROR_INTEGER_OVERFLOW if it exceeds 256 bits.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated HEX string to convert.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromHex(BOAT_OUT BUINT256 *to_ptr, const BCHAR *from_str)
+{
+    BUINT8 bin_array[32];
+    const BCHAR *digit_str;
+    BUINT32 digit_len;
+    BUINT32 bin_len;
+
+    if( to_ptr == NULL || from_str == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    digit_str = from_str;
+    if( digit_str[0] == '0' && (digit_str[1] == 'x' || digit_str[1] == 'X') )
+    {
+        digit_str += 2;
+    }
+
+    digit_len = strlen(digit_str);
+    if( digit_len == 0 || strspn(digit_str, "0123456789abcdefABCDEF") != digit_len )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "\"%s\" is not a HEX integer.", from_str);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Leading zeros don't count
+    while( digit_len > 1 && *digit_str == '0' )
+    {
+        digit_str++;
+        digit_len--;
+    }
+
+    if( digit_len > 64 )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    bin_len = UtilityHex2Bin(bin_array, sizeof(bin_array), digit_str, TRIMBIN_TRIM_NO, BOAT_FALSE);
+
+    BoatUint256FromBigendianLimbs(to_ptr->limb, bin_array, bin_len);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert a BUINT256 to HEX string
+
+Function: UtilityUint256ToHex()
+
+    This function converts an integer to HEX string as a JSON-RPC quantity,
+    i.e. without leading zeros and 0 converted to "0".
+
+@return
+    This function returns the length of the HEX string excluding null terminator.
+
+@param[out] to_str
+    The buffer of at least BOAT_UINT256_HEX_STR_SIZE bytes.
+
+@param[in] from_ptr
+    The integer to convert.
+
+@param[in] prefix_0x_mode
+    BIN2HEX_PREFIX_0x_YES: Prepend a "0x" prefix;\n
+    BIN2HEX_PREFIX_0x_NO:  Don't prepend "0x" prefix.
+
+*******************************************************************************/
+BUINT32 UtilityUint256ToHex(BOAT_OUT BCHAR *to_str, const BUINT256 *from_ptr, BIN2HEX_PREFIX_0x_MODE prefix_0x_mode)
+{
+    BUINT8 bin_array[32];
+
+    if( to_str == NULL || from_ptr == NULL )
+    {
+        return 0;
+    }
+
+    BoatUint256ToBigendianLimbs(bin_array, from_ptr->limb);
+
+    return UtilityBin2Hex(to_str, bin_array, sizeof(bin_array), BIN2HEX_LEFTTRIM_QUANTITY, prefix_0x_mode, BOAT_FALSE);
+}
+
+
+/******************************************************************************
+@brief Convert a decimal string to BUINT256
+
+Function: UtilityUint256FromDecStr()
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> is empty or contains\n
+    any non-decimal character, or BOAT_ERROR_INTEGER_OVERFLOW if it exceeds\n
+    2^256 - 1.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated decimal string to convert, such as "1000000000000000000".
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256FromDecStr(BOAT_OUT BUINT256 *to_ptr, const BCHAR *from_str)
+{
+    if( to_ptr == NULL || from_str == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    return BoatUint256ParseDec(to_ptr->limb, from_str);
+}
+
+
+/******************************************************************************
+@brief Convert a BUINT256 to decimal string
+
+Function: UtilityUint256ToDecStr()
+
+@return
+    This function returns the length of the decimal string excluding null\n
+    terminator. If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the decimal string. BOAT_UINT256_DEC_STR_SIZE bytes\n
+    are always enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+BUINT32 UtilityUint256ToDecStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BUINT256 *from_ptr)
+{
+    return BoatUint256FormatDec(to_str, to_size, from_ptr != NULL ? from_ptr->limb : NULL, BOAT_FALSE);
+}
+
+
+/******************************************************************************
+@brief Compare two BUINT256
+
+Function: UtilityUint256Compare()
+
+@return
+    This function returns a negative number, 0 or a positive number if <a_ptr>\n
+    is less than, equal to or greater than <b_ptr> respectively.
+
+@param[in] a_ptr
+    The integer to compare.
+
+@param[in] b_ptr
+    The integer to compare with.
+
+*******************************************************************************/
+BSINT32 UtilityUint256Compare(const BUINT256 *a_ptr, const BUINT256 *b_ptr)
+{
+    return BoatUint256CompareLimbs(a_ptr->limb, b_ptr->limb);
+}
+
+
+/******************************************************************************
+@brief Add two BUINT256
+
+Function: UtilityUint256Add()
+
+    This function computes <a_ptr> + <b_ptr> modulo 2^256. <sum_ptr> may be
+    the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the sum fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] sum_ptr
+    The sum.
+
+@param[in] a_ptr
+    The augend.
+
+@param[in] b_ptr
+    The addend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Add(BOAT_OUT BUINT256 *sum_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr)
+{
+    if( sum_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatUint256AddLimbs(sum_ptr->limb, a_ptr->limb, b_ptr->limb) != 0 )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Subtract a BUINT256 from another
+
+Function: UtilityUint256Sub()
+
+    This function computes <a_ptr> - <b_ptr> modulo 2^256, e.g. the balance
+    left after a transfer. <difference_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if <a_ptr> is not less than <b_ptr>.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] difference_ptr
+    The difference.
+
+@param[in] a_ptr
+    The minuend.
+
+@param[in] b_ptr
+    The subtrahend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Sub(BOAT_OUT BUINT256 *difference_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr)
+{
+    if( difference_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatUint256SubLimbs(difference_ptr->limb, a_ptr->limb, b_ptr->limb) != 0 )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Multiply two BUINT256
+
+Function: UtilityUint256Mul()
+
+    This function computes <a_ptr> * <b_ptr> modulo 2^256, e.g. the fee of gas
+    limit times gas price. <product_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the product fits in 256 bits.\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] product_ptr
+    The product.
+
+@param[in] a_ptr
+    The multiplicand.
+
+@param[in] b_ptr
+    The multiplier.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256Mul(BOAT_OUT BUINT256 *product_ptr, const BUINT256 *a_ptr, const BUINT256 *b_ptr)
+{
+    if( product_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatUint256MulLimbs(product_ptr->limb, a_ptr->limb, b_ptr->limb) == BOAT_TRUE )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Divide a BUINT256 by another
+
+Function: UtilityUint256DivMod()
+
+    This function computes the quotient and the remainder of <dividend_ptr>
+    divided by <divisor_ptr>. The outputs may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <divisor_ptr> is 0, it returns BOAT_ERROR_INVALID_ARGUMENT.
+
+@param[out] quotient_ptr
+    The quotient, or NULL if it's not needed.
+
+@param[out] remainder_ptr
+    The remainder, or NULL if it's not needed.
+
+@param[in] dividend_ptr
+    The dividend.
+
+@param[in] divisor_ptr
+    The divisor.
+
+*******************************************************************************/
+BOAT_RESULT UtilityUint256DivMod(BOAT_OUT BUINT256 *quotient_ptr,
+                                 BOAT_OUT BUINT256 *remainder_ptr,
+                                 const BUINT256 *dividend_ptr,
+                                 const BUINT256 *divisor_ptr)
+{
+    if( dividend_ptr == NULL || divisor_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatUint256IsZero(divisor_ptr->limb) == BOAT_TRUE )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Divisor cannot be 0.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    BoatUint256DivModLimbs(quotient_ptr != NULL ? quotient_ptr->limb : NULL,
+                           remainder_ptr != NULL ? remainder_ptr->limb : NULL,
+                           dividend_ptr->limb,
+                           divisor_ptr->limb);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert a BSINT64 to BSINT256
+
+Function: UtilityInt256FromInt64()
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_integer
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityInt256FromInt64(BOAT_OUT BSINT256 *to_ptr, BSINT64 from_integer)
+{
+    if( to_ptr == NULL )
+    {
+        return;
+    }
+
+    // Sign extension
+    memset(to_ptr, from_integer < 0 ? 0xFF : 0x00, sizeof(BSINT256));
+    to_ptr->limb[0] = (BUINT64)from_integer;
+}
+
+
+/******************************************************************************
+@brief Convert a bigendian two's complement byte stream to BSINT256
+
+Function: UtilityInt256FromBigendian()
+
+    This function converts up to 32 bytes of bigendian two's complement
+    integer, e.g. an int256 in an ABI encoded return value. Shorter streams
+    are sign-extended.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <from_len> exceeds 32, it returns BOAT_ERROR_INVALID_LENGTH.
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_ptr
+    The bigendian integer to convert.
+
+@param[in] from_len
+    The length of <from_ptr> in byte.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256FromBigendian(BOAT_OUT BSINT256 *to_ptr, const BUINT8 *from_ptr, BUINT32 from_len)
+{
+    BUINT8 extended_array[32];
+
+    if( to_ptr == NULL || (from_ptr == NULL && from_len != 0) )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( from_len > sizeof(extended_array) )
+    {
+        return BOAT_ERROR_INVALID_LENGTH;
+    }
+
+    memset(extended_array, (from_len > 0 && (from_ptr[0] & 0x80) != 0) ? 0xFF : 0x00, sizeof(extended_array));
+    if( from_len > 0 )
+    {
+        memcpy(extended_array + sizeof(extended_array) - from_len, from_ptr, from_len);
+    }
+
+    BoatUint256FromBigendianLimbs(to_ptr->limb, extended_array, sizeof(extended_array));
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert a BSINT256 to 32 bytes of bigendian two's complement integer
+
+Function: UtilityInt256ToBigendian()
+
+    This function writes the 32-byte bigendian form of an integer, as an
+    ABI encoded int256 argument.
+
+@return
+    This function doesn't return anything.
+
+@param[out] to_array
+    The bigendian integer.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+void UtilityInt256ToBigendian(BOAT_OUT BUINT8 to_array[32], const BSINT256 *from_ptr)
+{
+    if( to_array == NULL || from_ptr == NULL )
+    {
+        return;
+    }
+
+    BoatUint256ToBigendianLimbs(to_array, from_ptr->limb);
+}
+
+
+/******************************************************************************
+@brief Convert a decimal string to BSINT256
+
+Function: UtilityInt256FromDecStr()
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    It returns BOAT_ERROR_INVALID_ARGUMENT if <from_str> has no digits or\n
+    contains any non-decimal character, or BOAT_ERROR_INTEGER_OVERFLOW if it's\n
+    out of [-2^255, 2^255 - 1].
+
+@param[out] to_ptr
+    The converted integer.
+
+@param[in] from_str
+    The null-terminated decimal string to convert, with an optional leading\n
+    '-' or '+'.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256FromDecStr(BOAT_OUT BSINT256 *to_ptr, const BCHAR *from_str)
+{
+    BUINT64 magnitude[BOAT_UINT256_LIMB_NUM];
+    BUINT64 min_magnitude[BOAT_UINT256_LIMB_NUM] = {0, 0, 0, 1ull << 63};  // 2^255
+    BBOOL is_negative = BOAT_FALSE;
+    BSINT32 compared;
+    BOAT_RESULT result;
+
+    if( to_ptr == NULL || from_str == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( *from_str == '-' || *from_str == '+' )
+    {
+        is_negative = (*from_str == '-') ? BOAT_TRUE : BOAT_FALSE;
+        from_str++;
+    }
+
+    result = BoatUint256ParseDec(magnitude, from_str);
+    if( result != BOAT_SUCCESS )
+    {
+        return result;
+    }
+
+    // -2^255 is the only magnitude of 2^255 or more that fits
+    compared = BoatUint256CompareLimbs(magnitude, min_magnitude);
+    if( compared > 0 || (compared == 0 && is_negative == BOAT_FALSE) )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    if( is_negative == BOAT_TRUE )
+    {
+        BoatUint256NegateLimbs(to_ptr->limb, magnitude);
+    }
+    else
+    {
+        memcpy(to_ptr->limb, magnitude, sizeof(magnitude));
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Convert a BSINT256 to decimal string
+
+Function: UtilityInt256ToDecStr()
+
+@return
+    This function returns the length of the decimal string excluding null\n
+    terminator. If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the decimal string. BOAT_UINT256_DEC_STR_SIZE bytes\n
+    are always enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] from_ptr
+    The integer to convert.
+
+*******************************************************************************/
+BUINT32 UtilityInt256ToDecStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BSINT256 *from_ptr)
+{
+    BUINT64 magnitude[BOAT_UINT256_LIMB_NUM];
+
+    if( from_ptr == NULL )
+    {
+        return 0;
+    }
+
+    if( BOAT_INT256_IS_NEGATIVE(from_ptr->limb) )
+    {
+        // -2^255 negates to itself, which is 2^255 as unsigned
+        BoatUint256NegateLimbs(magnitude, from_ptr->limb);
+        return BoatUint256FormatDec(to_str, to_size, magnitude, BOAT_TRUE);
+    }
+    else
+    {
+        return BoatUint256FormatDec(to_str, to_size, from_ptr->limb, BOAT_FALSE);
+    }
+}
+
+
+/******************************************************************************
+@brief Compare two BSINT256
+
+Function: UtilityInt256Compare()
+
+@return
+    This function returns a negative number, 0 or a positive number if <a_ptr>\n
+    is less than, equal to or greater than <b_ptr> respectively.
+
+@param[in] a_ptr
+    The integer to compare.
+
+@param[in] b_ptr
+    The integer to compare with.
+
+*******************************************************************************/
+BSINT32 UtilityInt256Compare(const BSINT256 *a_ptr, const BSINT256 *b_ptr)
+{
+    BBOOL a_is_negative = BOAT_INT256_IS_NEGATIVE(a_ptr->limb);
+    BBOOL b_is_negative = BOAT_INT256_IS_NEGATIVE(b_ptr->limb);
+
+    if( a_is_negative != b_is_negative )
+    {
+        return a_is_negative ? -1 : 1;
+    }
+
+    // Two's complement of the same sign compares as unsigned
+    return BoatUint256CompareLimbs(a_ptr->limb, b_ptr->limb);
+}
+
+
+/******************************************************************************
+@brief Add two BSINT256
+
+Function: UtilityInt256Add()
+
+    This function computes <a_ptr> + <b_ptr> in two's complement, wrapping on
+    overflow. <sum_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the sum is in [-2^255, 2^255 - 1].\n
+    Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] sum_ptr
+    The sum.
+
+@param[in] a_ptr
+    The augend.
+
+@param[in] b_ptr
+    The addend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Add(BOAT_OUT BSINT256 *sum_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr)
+{
+    BBOOL a_is_negative;
+    BBOOL b_is_negative;
+
+    if( sum_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    a_is_negative = BOAT_INT256_IS_NEGATIVE(a_ptr->limb);
+    b_is_negative = BOAT_INT256_IS_NEGATIVE(b_ptr->limb);
+
+    BoatUint256AddLimbs(sum_ptr->limb, a_ptr->limb, b_ptr->limb);
+
+    // Overflows only if both operands have the same sign, which the sum doesn't have
+    if( a_is_negative == b_is_negative && BOAT_INT256_IS_NEGATIVE(sum_ptr->limb) != a_is_negative )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Subtract a BSINT256 from another
+
+Function: UtilityInt256Sub()
+
+    This function computes <a_ptr> - <b_ptr> in two's complement, wrapping on
+    overflow. <difference_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the difference is in\n
+    [-2^255, 2^255 - 1]. Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] difference_ptr
+    The difference.
+
+@param[in] a_ptr
+    The minuend.
+
+@param[in] b_ptr
+    The subtrahend.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Sub(BOAT_OUT BSINT256 *difference_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr)
+{
+    BBOOL a_is_negative;
+    BBOOL b_is_negative;
+
+    if( difference_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    a_is_negative = BOAT_INT256_IS_NEGATIVE(a_ptr->limb);
+    b_is_negative = BOAT_INT256_IS_NEGATIVE(b_ptr->limb);
+
+    BoatUint256SubLimbs(difference_ptr->limb, a_ptr->limb, b_ptr->limb);
+
+    // Overflows only if the operands have different signs, and the difference doesn't have the minuend's
+    if( a_is_negative != b_is_negative && BOAT_INT256_IS_NEGATIVE(difference_ptr->limb) != a_is_negative )
+    {
+        return BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Multiply two BSINT256
+
+Function: UtilityInt256Mul()
+
+    This function computes <a_ptr> * <b_ptr> in two's complement, wrapping on
+    overflow. <product_ptr> may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if the product is in\n
+    [-2^255, 2^255 - 1]. Otherwise it returns BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] product_ptr
+    The product.
+
+@param[in] a_ptr
+    The multiplicand.
+
+@param[in] b_ptr
+    The multiplier.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256Mul(BOAT_OUT BSINT256 *product_ptr, const BSINT256 *a_ptr, const BSINT256 *b_ptr)
+{
+    BUINT64 a_magnitude[BOAT_UINT256_LIMB_NUM];
+    BUINT64 b_magnitude[BOAT_UINT256_LIMB_NUM];
+    BUINT64 min_magnitude[BOAT_UINT256_LIMB_NUM] = {0, 0, 0, 1ull << 63};  // 2^255
+    BBOOL is_negative;
+    BBOOL is_overflow;
+
+    if( product_ptr == NULL || a_ptr == NULL || b_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    memcpy(a_magnitude, a_ptr->limb, sizeof(a_magnitude));
+    if( BOAT_INT256_IS_NEGATIVE(a_magnitude) )
+    {
+        BoatUint256NegateLimbs(a_magnitude, a_magnitude);
+    }
+
+    memcpy(b_magnitude, b_ptr->limb, sizeof(b_magnitude));
+    if( BOAT_INT256_IS_NEGATIVE(b_magnitude) )
+    {
+        BoatUint256NegateLimbs(b_magnitude, b_magnitude);
+    }
+
+    is_negative = (BOAT_INT256_IS_NEGATIVE(a_ptr->limb) != BOAT_INT256_IS_NEGATIVE(b_ptr->limb)) ? BOAT_TRUE : BOAT_FALSE;
+
+    is_overflow = BoatUint256MulLimbs(product_ptr->limb, a_magnitude, b_magnitude);
+
+    // A magnitude of 2^255 fits only if it's negative
+    if(    is_overflow == BOAT_FALSE
+        && BOAT_INT256_IS_NEGATIVE(product_ptr->limb)
+        && (is_negative == BOAT_FALSE || BoatUint256CompareLimbs(product_ptr->limb, min_magnitude) != 0) )
+    {
+        is_overflow = BOAT_TRUE;
+    }
+
+    if( is_negative == BOAT_TRUE )
+    {
+        BoatUint256NegateLimbs(product_ptr->limb, product_ptr->limb);
+    }
+
+    return is_overflow == BOAT_TRUE ? BOAT_ERROR_INTEGER_OVERFLOW : BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Divide a BSINT256 by another
+
+Function: UtilityInt256DivMod()
+
+    This function computes the quotient rounded toward zero and the remainder,
+    which has the sign of the dividend, like SDIV and SMOD of the EVM. The
+    outputs may be the same as either operand.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    If <divisor_ptr> is 0, it returns BOAT_ERROR_INVALID_ARGUMENT.\n
+    If the quotient of -2^255 divided by -1 wraps to -2^255, it returns\n
+    BOAT_ERROR_INTEGER_OVERFLOW.
+
+@param[out] quotient_ptr
+    The quotient, or NULL if it's not needed.
+
+@param[out] remainder_ptr
+    The remainder, or NULL if it's not needed.
+
+@param[in] dividend_ptr
+    The dividend.
+
+@param[in] divisor_ptr
+    The divisor.
+
+*******************************************************************************/
+BOAT_RESULT UtilityInt256DivMod(BOAT_OUT BSINT256 *quotient_ptr,
+                                BOAT_OUT BSINT256 *remainder_ptr,
+                                const BSINT256 *dividend_ptr,
+                                const BSINT256 *divisor_ptr)
+{
+    BUINT64 dividend_magnitude[BOAT_UINT256_LIMB_NUM];
+    BUINT64 divisor_magnitude[BOAT_UINT256_LIMB_NUM];
+    BUINT64 quotient[BOAT_UINT256_LIMB_NUM];
+    BUINT64 remainder[BOAT_UINT256_LIMB_NUM];
+    BBOOL dividend_is_negative;
+    BBOOL divisor_is_negative;
+    BOAT_RESULT result = BOAT_SUCCESS;
+
+    if( dividend_ptr == NULL || divisor_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatUint256IsZero(divisor_ptr->limb) == BOAT_TRUE )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Divisor cannot be 0.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    dividend_is_negative = BOAT_INT256_IS_NEGATIVE(dividend_ptr->limb);
+    divisor_is_negative = BOAT_INT256_IS_NEGATIVE(divisor_ptr->limb);
+
+    memcpy(dividend_magnitude, dividend_ptr->limb, sizeof(dividend_magnitude));
+    if( dividend_is_negative )
+    {
+        BoatUint256NegateLimbs(dividend_magnitude, dividend_magnitude);
+    }
+
+    memcpy(divisor_magnitude, divisor_ptr->limb, sizeof(divisor_magnitude));
+    if( divisor_is_negative )
+    {
+        BoatUint256NegateLimbs(divisor_magnitude, divisor_magnitude);
+    }
+
+    BoatUint256DivModLimbs(quotient, remainder, dividend_magnitude, divisor_magnitude);
+
+    if( dividend_is_negative != divisor_is_negative )
+    {
+        BoatUint256NegateLimbs(quotient, quotient);
+    }
+    else if( BOAT_INT256_IS_NEGATIVE(quotient) )
+    {
+        // Only -2^255 / -1
+        result = BOAT_ERROR_INTEGER_OVERFLOW;
+    }
+
+    if( dividend_is_negative )
+    {
+        BoatUint256NegateLimbs(remainder, remainder);
+    }
+
+    if( quotient_ptr != NULL )
+    {
+        memcpy(quotient_ptr->limb, quotient, sizeof(quotient));
+    }
+    if( remainder_ptr != NULL )
+    {
+        memcpy(remainder_ptr->limb, remainder, sizeof(remainder));
+    }
+
+    return result;
+}
+
+
+/******************************************************************************
+@brief Convert wei to ether in exact decimal string
+
+Function: UtilityWeiToEthStr()
+
+    This function formats wei as ether without losing precision, e.g.
+    1500000000000000001 wei is converted to "1.500000000000000001". Trailing
+    zeros of the fraction are omitted, and so is the decimal point of a whole
+    number of ether.
+
+@return
+    This function returns the length of the string excluding null terminator.\n
+    If <to_size> is too small, it returns 0.
+
+@param[out] to_str
+    The buffer to hold the string. BOAT_WEI_ETH_STR_SIZE bytes are always\n
+    enough.
+
+@param[in] to_size
+    The size of <to_str> in byte.
+
+@param[in] wei_ptr
+    The amount in wei.
+
+*******************************************************************************/
+BUINT32 UtilityWeiToEthStr(BOAT_OUT BCHAR *to_str, BUINT32 to_size, const BUINT256 *wei_ptr)
+{
+    BUINT64 wei_per_eth[BOAT_UINT256_LIMB_NUM] = {BOAT_WEI_PER_ETH, 0, 0, 0};
+    BUINT64 ether[BOAT_UINT256_LIMB_NUM];
+    BUINT64 fraction[BOAT_UINT256_LIMB_NUM];
+    BCHAR fraction_str[BOAT_WEI_PER_ETH_LEN];
+    BUINT32 fraction_len;
+    BUINT32 to_len;
+    BUINT64 fraction_wei;
+    BSINT32 i;
+
+    if( to_str == NULL || wei_ptr == NULL )
+    {
+        return 0;
+    }
+
+    BoatUint256DivModLimbs(ether, fraction, wei_ptr->limb, wei_per_eth);
+
+    to_len = BoatUint256FormatDec(to_str, to_size, ether, BOAT_FALSE);
+    if( to_len == 0 )
+    {
+        return 0;
+    }
+
+    // The fraction is less than 10^18 wei, i.e. the low limb, in 18 digits
+    fraction_wei = fraction[0];
+    for( i = BOAT_WEI_PER_ETH_LEN - 1; i >= 0; i-- )
+    {
+        fraction_str[i] = (BCHAR)('0' + fraction_wei % 10);
+        fraction_wei /= 10;
+    }
+
+    fraction_len = BOAT_WEI_PER_ETH_LEN;
+    while( fraction_len > 0 && fraction_str[fraction_len - 1] == '0' )
+    {
+        fraction_len--;
+    }
+
+    if( fraction_len > 0 )
+    {
+        if( to_len + 1 + fraction_len + 1 > to_size )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Buffer of %u bytes is too small.", to_size);
+            return 0;
+        }
+
+        to_str[to_len++] = '.';
+        memcpy(to_str + to_len, fraction_str, fraction_len);
+        to_len += fraction_len;
+        to_str[to_len] = '\0';
+    }
+
+    return to_len;
+}
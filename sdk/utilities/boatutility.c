@@ -21,6 +21,10 @@ boatutility.c contains utility functions for boatwallet.
 */
 
 #include "boatinternal.h"
+#include "boatstaticpool.h"
+#include "boathex.h"
+
+#include <pthread.h>
 
 
 //!@brief Literal representation of log level
@@ -31,6 +35,9 @@ const BCHAR  * const g_log_level_name_str[] =
     "LOG_VERBOSE"
 };
 
+//!@brief Log level set at runtime, see BoatLogSetLevel()
+__BOATSTATIC BUINT32 g_boat_log_level = BOAT_LOG_LEVEL;
+
 
 
 /******************************************************************************
@@ -216,11 +223,7 @@ BUINT32 UtilityBin2Hex(
                 )
 {
     BUINT32 to_offset;
-    unsigned char halfbyte;
-    unsigned char octet;
-    char halfbytechar;
-    int i, j;
-    BBOOL trim_done;
+    BUINT32 from_offset;
     
         
     if( to_str == NULL )
@@ -242,53 +245,31 @@ BUINT32 UtilityBin2Hex(
         to_str[to_offset++] = 'x';
     }
 
-    if( trim_mode == BIN2HEX_LEFTTRIM_UNFMTDATA )
-    {
-        trim_done = BOAT_TRUE;
-    }
-    else
-    {
-        trim_done = BOAT_FALSE;
-    }
-    
-    for( i = 0; i < from_len; i++ )
+    from_offset = 0;
+
+    // Trim leading double zeroes, i.e. {0x00, 0x01, 0x00 0xAB} => "0100AB"
+    if( trim_mode != BIN2HEX_LEFTTRIM_UNFMTDATA )
     {
-        octet = from_ptr[i];
-        
-        // Trim leading double zeroes, i.e. {0x00, 0x01, 0x00 0xAB} => "0100AB"
-        if( trim_done == BOAT_FALSE && octet == 0 )
+        while( from_offset < from_len && from_ptr[from_offset] == 0 )
         {
-            continue;
+            from_offset++;
         }
-        
-        for( j = 0; j < 2; j++)
-        {
-            halfbyte = (octet>>(4-j*4))&0x0F;
-
-            // Trim all leading zeroes, i.e. {0x00, 0x01, 0x00 0xAB} => "100AB"
-            if(    trim_done == BOAT_FALSE
-                && trim_mode == BIN2HEX_LEFTTRIM_QUANTITY
-                && halfbyte == 0)
-            {
-                continue;
-            }
-            
-            if( halfbyte >= 0x0 && halfbyte <= 0x9)
-            {
-                halfbytechar = halfbyte + '0';
-            }
-            else
-            {
-                halfbytechar = halfbyte - 10 + 'a';
-            }
+    }
 
-            to_str[to_offset++] = halfbytechar;
-            
-            trim_done = BOAT_TRUE;
-            
-        }
+    // Trim all leading zeroes, i.e. {0x00, 0x01, 0x00 0xAB} => "100AB"
+    if(    trim_mode == BIN2HEX_LEFTTRIM_QUANTITY
+        && from_offset < from_len
+        && (from_ptr[from_offset] >> 4) == 0 )
+    {
+        BoatHexEncode(to_str + to_offset, from_ptr + from_offset, 1);
+        to_str[to_offset] = to_str[to_offset + 1];
+        to_offset++;
+        from_offset++;
     }
 
+    BoatHexEncode(to_str + to_offset, from_ptr + from_offset, from_len - from_offset);
+    to_offset += (from_len - from_offset) * 2;
+
 
     // Special process for all zero byte array
     
@@ -319,6 +300,19 @@ BUINT32 UtilityBin2Hex(
 }
 
 
+// Logs the non-HEX character UtilityHex2Bin() stops at
+__BOATSTATIC void UtilityHex2BinLogNonHex(const BCHAR *from_str, BUINT32 from_offset)
+{
+    BCHAR halfbytechar = from_str[from_offset];
+
+    BoatLog(BOAT_LOG_NORMAL, "<from_str> contains non-HEX character 0x%02x (%c) at Position %d of \"%s\".\n", halfbytechar, halfbytechar, from_offset, from_str);
+    if( halfbytechar == ' ' || halfbytechar == '\t' )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "There should be no space between HEX codes.");
+    }
+}
+
+
 /******************************************************************************
 @brief Convert a HEX string to binary stream with optional leading zeros trimming
 
@@ -391,11 +385,10 @@ BUINT32 UtilityHex2Bin(
     BUINT32 from_offset;
     BUINT32 from_len;
     BUINT32 to_offset;
-    BUINT32 odd_flag;
+    BUINT32 to_len;
 
-    unsigned char octet;
-    unsigned char halfbyte;
-    char halfbytechar;
+    BUINT8 octet;
+    BCHAR pair_str[2];
     BBOOL bool_trim_done;
      
     if( to_ptr == NULL || to_size == 0 || from_str == NULL)
@@ -404,8 +397,6 @@ BUINT32 UtilityHex2Bin(
         return 0;
     }
 
-    octet = 0;
-
     from_len = strlen(from_str);
 
     from_offset = 0;
@@ -424,19 +415,6 @@ BUINT32 UtilityHex2Bin(
         }
     }
 
-            
-    // if HEX length is odd, treat as if it were left filled with one more '0'
-    if( (from_len&0x01) != 0 )
-    {
-        // length is odd 
-        odd_flag = 1;
-    }
-    else
-    {
-        // length is even
-        odd_flag = 0;
-    }
-
     if( trim_mode == TRIMBIN_TRIM_NO)
     {
         bool_trim_done = BOAT_TRUE;
@@ -445,71 +423,52 @@ BUINT32 UtilityHex2Bin(
     {
         bool_trim_done = BOAT_FALSE;
     }
-    
 
-    while( from_offset < from_len )
+    // if HEX length is odd, treat as if it were left filled with one more '0'
+    if( ((from_len - from_offset)&0x01) != 0 )
     {
-        halfbytechar = from_str[from_offset];
-        
-        if( halfbytechar >= '0' && halfbytechar <= '9')
-        {
-            halfbyte = halfbytechar - '0';
-        }
-        else if( halfbytechar >= 'A' && halfbytechar <= 'F')
-        {
-            halfbyte = halfbytechar - 'A' + 0x0A;
-        }
-        else if( halfbytechar >= 'a' && halfbytechar <= 'f')
-        {
-            halfbyte = halfbytechar - 'a' + 0x0A;
-        }
-        else
+        pair_str[0] = '0';
+        pair_str[1] = from_str[from_offset];
+
+        if( BoatHexDecode(&octet, pair_str, 1) != BOAT_TRUE )
         {
-            BoatLog(BOAT_LOG_NORMAL, "<from_str> contains non-HEX character 0x%02x (%c) at Position %d of \"%s\".\n", halfbytechar, halfbytechar, from_offset, from_str);
-            if( halfbytechar == ' ' || halfbytechar == '\t' )
-            {
-                BoatLog(BOAT_LOG_NORMAL, "There should be no space between HEX codes.");
-            }
+            UtilityHex2BinLogNonHex(from_str, from_offset);
             return 0;
         }
 
-        // If from_len is even, pack 2 half bytes to a byte when from_offset is odd.
-        // For example, "0x012345" is packed when from_offset points to '1', '3' and '5'.
-        //
-        // If from_len is odd, pack 2 half bytes to a byte when from_offset is even.
-        // For example, "0x12345" is packed when from_offset points to '1', '3' and '5'.
-        if( (from_offset&0x01) == odd_flag )
+        from_offset++;
+
+        if( bool_trim_done == BOAT_TRUE || octet != 0x00 )
         {
-            octet = halfbyte << 4;
-            from_offset++;
-            continue;
+            to_ptr[to_offset++] = octet;
+            bool_trim_done = BOAT_TRUE;
         }
-        else
+    }
+
+    // Trim leading zeros.
+    if( bool_trim_done == BOAT_FALSE )
+    {
+        while( from_offset < from_len && from_str[from_offset] == '0' && from_str[from_offset + 1] == '0' )
         {
-            octet |= halfbyte;
-        
-            if( bool_trim_done == BOAT_FALSE && octet == 0x00 )
-            {
-                from_offset++;
-                continue;  // Trim leading zeros.
-            }
-            else
-            {
-                bool_trim_done = BOAT_TRUE;
-            }
-            
-            to_ptr[to_offset++] = octet;
+            from_offset += 2;
+        }
+    }
 
-            from_offset++;
+    // Convert what the output buffer holds, leaving the rest unchecked
+    to_len = (from_len - from_offset) / 2;
+    if( to_len > to_size - to_offset )
+    {
+        to_len = to_size - to_offset;
+    }
 
-            // Check capacity of output buffer
-            if( to_offset >= to_size )
-            {
-                break;
-            }
-         }
+    if( BoatHexDecode(to_ptr + to_offset, from_str + from_offset, to_len) != BOAT_TRUE )
+    {
+        UtilityHex2BinLogNonHex(from_str, from_offset + strspn(from_str + from_offset, "0123456789abcdefABCDEF"));
+        return 0;
     }
 
+    to_offset += to_len;
+
     // Special process for trimed all zero HEX string
     if( to_offset == 0 && zero_as_null == BOAT_FALSE)
     {
@@ -811,20 +770,17 @@ Function: UtilityWeiStrToEthDouble()
     This function converts a string representing wei in HEX to ether in double
     float.
 
-    1 ether is 1e18 wei. Note that in Ethereum an integer type is up to 256 bits
-    while most C compilers natively support up to 64-bit integer. A 64-bit
-    unsigned interger can represent up to 2^64 - 1, which is roughly 1.845e19.
-    Thus it's not possible to convert more than 1.845e19 wei (i.e. 18.45 ether)
-    to native integer type.
-
-    Converting integer type wei to double float type ether loses pricision.
-    Fortunately the unit of ether is usually for friendly human-reading only
-    and slight pricision loss is not a problem.
+    1 ether is 1e18 wei. The wei is parsed as a 256-bit integer and divided by
+    1e18 exactly with UtilityWeiToEthStr(), so that the result is the nearest
+    double float of the exact ether. A double float has 53 bits of mantissa,
+    i.e. about 16 significant decimal digits, which is enough for human-reading.
+    Use UtilityWeiToEthStr() or compare BUINT256 wei where every wei counts.
     
 
 
 @return
-    This function returns the converted ether in double float.
+    This function returns the converted ether in double float.\n
+    If <wei_str> isn't a HEX integer of up to 256 bits, it returns 0.0.
     
 
 @param[in] wei_str
@@ -833,83 +789,381 @@ Function: UtilityWeiStrToEthDouble()
 *******************************************************************************/
 double UtilityWeiStrToEthDouble(const BCHAR *wei_str)
 {
-    BUINT32 wei_bin_len;
-    BUINT8 wei_bin[(strlen(wei_str)+1)/2];
-    BUINT64 wei_int64;
-    BUINT8 *wei_int64_addr_ptr;
-    BUINT32 shift_bits;
-    double scale_double;
-    double wei_double;
+    BUINT256 wei;
+    BCHAR ether_str[BOAT_WEI_ETH_STR_SIZE];
     double ether_double;
-    BUINT32 i;
 
-    // Conver wei from HEX to binary with leading zeros trimmed
-    wei_bin_len = UtilityHex2Bin(
-                        wei_bin,
-                        sizeof(wei_bin),
-                        wei_str,
-                        TRIMBIN_LEFTTRIM,
-                        BOAT_FALSE
-                      );
-
-    // Above binary representation of wei is in bigendian and it's possibly
-    // larger than BUINT64 (8 bytes).
-    // To convert it to littleendian, every byte in wei_bin is copied to wei_int64
-    // reversely.
-    //
-    // If wei_bin is more than 8 bytes, only most significant 8 bytes are copied,
-    // as if the integer were right shifted by some bits until its value is
-    // no more than BUINT64. After it's converted to double, 2^shift_bits is
-    // multiplied by to recover its value.
-    //
-    // If wei_bin is no more than 8 bytes, only effective bytes are copied to
-    // wei_int64.
-        
-    wei_int64 = 0;
-    wei_int64_addr_ptr = (BUINT8*)&wei_int64;
+    if( UtilityUint256FromHex(&wei, wei_str) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to convert wei.");
+        return 0.0;
+    }
+
+    UtilityWeiToEthStr(ether_str, sizeof(ether_str), &wei);
+
+    // Round the exact decimal ether to the nearest double float
+    ether_double = strtod(ether_str, NULL);
+
+    BoatLog(BOAT_LOG_VERBOSE, "%s wei converted to %s ether", wei_str, ether_str);
+    
+    return ether_double;
+}
+
+
+/******************************************************************************
+@brief The built-in allocator of the platform
+
+Function: BoatDefaultMalloc()
+
+    This function allocates from the static pools with BOAT_USE_STATIC_POOL set
+    to 1, or from the C heap. Unlike BoatMalloc() it never goes through the
+    allocator set by BoatSetAllocator(), so a block can be freed by
+    BoatDefaultFree() whichever allocator is set then.
+
+@return
+    This function returns the address of the allocated memory. If allocation\n
+    fails, it returns NULL.
+
+@param[in] size
+        How many bytes to allocate.
+
+*******************************************************************************/
+void *BoatDefaultMalloc(BUINT32 size)
+{
+#if BOAT_USE_STATIC_POOL == 1
+    return BoatStaticPoolMalloc(size);
+#else
+    return malloc(size);
+#endif
+}
+
+
+/******************************************************************************
+@brief Free a block of BoatDefaultMalloc()
 
-    if( wei_bin_len > sizeof(BUINT64) )
+Function: BoatDefaultFree()
+
+@return
+    This function doesn't return anything.
+
+@param[in] mem_ptr
+    The address returned by BoatDefaultMalloc().
+
+*******************************************************************************/
+void BoatDefaultFree(void *mem_ptr)
+{
+#if BOAT_USE_STATIC_POOL == 1
+    BoatStaticPoolFree(mem_ptr);
+#else
+    free(mem_ptr);
+#endif
+}
+
+
+__BOATSTATIC BoatAllocator g_boat_allocator = {BoatDefaultMalloc, BoatDefaultFree};
+
+
+// Blocks of a transaction arena are aligned for any type
+#define BOAT_TX_ARENA_ALIGN 16
+
+//!@brief A chunk of a transaction arena, followed by its space
+typedef struct TBoatTxArenaChunk
+{
+    struct TBoatTxArenaChunk *next_ptr; //!< The chunk allocated before this one
+    BUINT32 chunk_size;                 //!< Size of the space
+    BUINT32 used_size;                  //!< Size of the space taken
+}BoatTxArenaChunk;
+
+#define BOAT_TX_ARENA_CHUNK_HEADER_SIZE BOAT_ROUNDUP(sizeof(BoatTxArenaChunk), BOAT_TX_ARENA_ALIGN)
+
+//!@brief The transaction arena of a thread
+typedef struct TBoatTxArena
+{
+    BoatTxArenaChunk *chunk_ptr; //!< The latest chunk, heading the list of all chunks
+    BUINT32 scope_depth;         //!< Nesting depth of BoatTxArenaBegin()
+}BoatTxArena;
+
+
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+__BOATSTATIC pthread_key_t g_boat_tx_arena_key;
+__BOATSTATIC pthread_once_t g_boat_tx_arena_once = PTHREAD_ONCE_INIT;
+__BOATSTATIC BBOOL g_boat_tx_arena_key_created = BOAT_FALSE;
+
+
+__BOATSTATIC void BoatTxArenaDestroy(void *arena_ptr)
+{
+    BoatTxArenaChunk *chunk_ptr = ((BoatTxArena *)arena_ptr)->chunk_ptr;
+    BoatTxArenaChunk *next_ptr;
+
+    while( chunk_ptr != NULL )
     {
-        // If wei_bin is more than 8 bytes, copy 8 bytes only
-        for( i = 0; i< sizeof(BUINT64); i++ )
+        next_ptr = chunk_ptr->next_ptr;
+        g_boat_allocator.free_fn(chunk_ptr);
+        chunk_ptr = next_ptr;
+    }
+
+    g_boat_allocator.free_fn(arena_ptr);
+}
+
+
+__BOATSTATIC void BoatTxArenaKeyCreate(void)
+{
+    __atomic_store_n(&g_boat_tx_arena_key_created,
+                     pthread_key_create(&g_boat_tx_arena_key, BoatTxArenaDestroy) == 0,
+                     __ATOMIC_RELEASE);
+}
+
+
+// Returns the arena of the calling thread if it's in an arena scope, or NULL
+__BOATSTATIC BoatTxArena *BoatTxArenaInScope(void)
+{
+    BoatTxArena *arena_ptr;
+
+    // Threads that never began a scope may not have seen the key created
+    if( __atomic_load_n(&g_boat_tx_arena_key_created, __ATOMIC_ACQUIRE) != BOAT_TRUE )
+    {
+        return NULL;
+    }
+
+    arena_ptr = pthread_getspecific(g_boat_tx_arena_key);
+
+    return (arena_ptr != NULL && arena_ptr->scope_depth > 0) ? arena_ptr : NULL;
+}
+
+
+__BOATSTATIC void *BoatTxArenaMalloc(BoatTxArena *arena_ptr, BUINT32 size)
+{
+    BoatTxArenaChunk *chunk_ptr = arena_ptr->chunk_ptr;
+    BUINT32 block_size;
+    BUINT32 chunk_size;
+    void *mem_ptr;
+
+    if( size > 0xFFFFFFFF - BOAT_TX_ARENA_CHUNK_HEADER_SIZE - BOAT_TX_ARENA_ALIGN )
+    {
+        return NULL;
+    }
+
+    block_size = BOAT_ROUNDUP(BOAT_MAX(size, 1), BOAT_TX_ARENA_ALIGN);
+
+    if( chunk_ptr == NULL || chunk_ptr->chunk_size - chunk_ptr->used_size < block_size )
+    {
+        // Blocks larger than a chunk get a chunk of their own
+        chunk_size = BOAT_MAX(block_size, BOAT_ROUNDUP(BOAT_TX_ARENA_CHUNK_SIZE, BOAT_TX_ARENA_ALIGN));
+
+        chunk_ptr = g_boat_allocator.malloc_fn(BOAT_TX_ARENA_CHUNK_HEADER_SIZE + chunk_size);
+        if( chunk_ptr == NULL )
         {
-            // bigendian to littleendian
-            wei_int64_addr_ptr[i] =  wei_bin[sizeof(BUINT64) - 1 - i];
+            return NULL;
         }
-        
-        shift_bits = (wei_bin_len - sizeof(BUINT64))*8;
+
+        chunk_ptr->chunk_size = chunk_size;
+        chunk_ptr->used_size = 0;
+        chunk_ptr->next_ptr = arena_ptr->chunk_ptr;
+        arena_ptr->chunk_ptr = chunk_ptr;
     }
-    else
+
+    mem_ptr = (BUINT8 *)chunk_ptr + BOAT_TX_ARENA_CHUNK_HEADER_SIZE + chunk_ptr->used_size;
+    chunk_ptr->used_size += block_size;
+
+    return mem_ptr;
+}
+
+
+__BOATSTATIC BBOOL BoatTxArenaOwns(const BoatTxArena *arena_ptr, const void *mem_ptr)
+{
+    const BoatTxArenaChunk *chunk_ptr;
+    const BUINT8 *space_ptr;
+
+    for( chunk_ptr = arena_ptr->chunk_ptr; chunk_ptr != NULL; chunk_ptr = chunk_ptr->next_ptr )
     {
-        // If wei_bin is no more than 8 bytes, copy effective bytes
-        for( i = 0; i< wei_bin_len; i++ )
+        space_ptr = (const BUINT8 *)chunk_ptr + BOAT_TX_ARENA_CHUNK_HEADER_SIZE;
+        if( (const BUINT8 *)mem_ptr >= space_ptr && (const BUINT8 *)mem_ptr < space_ptr + chunk_ptr->chunk_size )
         {
-            // bigendian to littleendian
-            wei_int64_addr_ptr[i] =  wei_bin[wei_bin_len - 1 - i];
+            return BOAT_TRUE;
         }
-        shift_bits = 0;
     }
-    
-    // Convert BUINT64 to double
-    wei_double = (double)wei_int64;
 
-    // Recover shifted bits if any.
-    // DO NOT calculate 2^shift_bits by (0x1 << shift_bits), because shift_bits
-    // may be more than 64 bits. Calculate it in double instead.
-    scale_double = 1.0;
-    
-    for( i = 0; i < shift_bits; i++ )
+    return BOAT_FALSE;
+}
+#endif
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+//!@brief Accounting header prepended to each block of BoatMalloc()
+typedef struct TBoatMemHeader
+{
+    BUINT32 size;     //!< Size requested by the caller
+    BUINT32 tag;      //!< BoatMemTag the block is accounted to
+    BUINT32 magic;    //!< BOAT_MEM_MAGIC_LIVE until freed
+    BUINT32 reserved; //!< Keeps the block aligned for any type
+}BoatMemHeader;
+
+#define BOAT_MEM_HEADER_SIZE BOAT_ROUNDUP(sizeof(BoatMemHeader), 16)
+#define BOAT_MEM_MAGIC_LIVE  0xB0A7A110
+#define BOAT_MEM_MAGIC_FREED 0xB0A7F4EE
+
+__BOATSTATIC BoatMemStats g_boat_mem_tag_stats[BOAT_MEM_TAG_NUM];
+__BOATSTATIC BoatMemStats g_boat_mem_total_stats;
+
+
+__BOATSTATIC void BoatMemAccountAlloc(BoatMemStats *stats_ptr, BUINT32 size)
+{
+    BUINT64 live_bytes = __atomic_add_fetch(&stats_ptr->live_bytes, size, __ATOMIC_RELAXED);
+    BUINT64 peak_bytes = __atomic_load_n(&stats_ptr->peak_bytes, __ATOMIC_RELAXED);
+
+    while(    live_bytes > peak_bytes
+           && !__atomic_compare_exchange_n(&stats_ptr->peak_bytes, &peak_bytes, live_bytes,
+                                           BOAT_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED) )
     {
-        scale_double *= 2.0;
+        // peak_bytes is reloaded by the failed exchange
     }
-    
-    // Convert wei to ether by division by 1e18
-    ether_double = wei_double * scale_double / 1e18;
 
-    BoatLog(BOAT_LOG_VERBOSE, "%s wei converted to %f ether", wei_str, ether_double);
+    __atomic_add_fetch(&stats_ptr->alloc_num, 1, __ATOMIC_RELAXED);
+}
+
+
+__BOATSTATIC void BoatMemAccountFree(BoatMemStats *stats_ptr, BUINT32 size, BBOOL is_unfreed)
+{
+    __atomic_sub_fetch(&stats_ptr->live_bytes, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&stats_ptr->free_num, 1, __ATOMIC_RELAXED);
+
+    if( is_unfreed == BOAT_TRUE )
+    {
+        __atomic_add_fetch(&stats_ptr->unfreed_num, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+// Accounts a block as freed and marks it so that it's not accounted again
+__BOATSTATIC void BoatMemHeaderFree(BoatMemHeader *header_ptr, BBOOL is_unfreed)
+{
+    header_ptr->magic = BOAT_MEM_MAGIC_FREED;
+    BoatMemAccountFree(&g_boat_mem_tag_stats[header_ptr->tag], header_ptr->size, is_unfreed);
+    BoatMemAccountFree(&g_boat_mem_total_stats, header_ptr->size, is_unfreed);
+}
+
+
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+// Accounts the blocks of an arena chunk that are released without BoatFree()
+__BOATSTATIC void BoatTxArenaChunkAccountUnfreed(BoatTxArenaChunk *chunk_ptr)
+{
+    BUINT8 *space_ptr = (BUINT8 *)chunk_ptr + BOAT_TX_ARENA_CHUNK_HEADER_SIZE;
+    BoatMemHeader *header_ptr;
+    BUINT32 offset = 0;
+
+    // Every block of an arena is headed by BoatMallocTagged()
+    while( offset < chunk_ptr->used_size )
+    {
+        header_ptr = (BoatMemHeader *)(space_ptr + offset);
+
+        if( header_ptr->magic == BOAT_MEM_MAGIC_LIVE )
+        {
+            BoatMemHeaderFree(header_ptr, BOAT_TRUE);
+        }
+
+        offset += BOAT_ROUNDUP(BOAT_MEM_HEADER_SIZE + header_ptr->size, BOAT_TX_ARENA_ALIGN);
+    }
+}
+#endif
+#endif
+
+
+__BOATSTATIC void *BoatMallocUntagged(BUINT32 size, BBOOL is_persistent)
+{
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+    BoatTxArena *arena_ptr;
+
+    if( is_persistent != BOAT_TRUE )
+    {
+        arena_ptr = BoatTxArenaInScope();
+
+        if( arena_ptr != NULL )
+        {
+            return BoatTxArenaMalloc(arena_ptr, size);
+        }
+    }
+#else
+    (void)is_persistent;
+#endif
+
+    return g_boat_allocator.malloc_fn(size);
+}
+
+
+__BOATSTATIC void BoatFreeUntagged(void *mem_ptr)
+{
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+    BoatTxArena *arena_ptr = BoatTxArenaInScope();
+
+    if( arena_ptr != NULL && BoatTxArenaOwns(arena_ptr, mem_ptr) == BOAT_TRUE )
+    {
+        return;
+    }
+#endif
+
+    g_boat_allocator.free_fn(mem_ptr);
+}
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+/******************************************************************************
+@brief Wrapper function for memory allocation accounted to a subsystem
+
+Function: BoatMallocTagged()
+
+    This function allocates the block with an accounting header in front of it
+    as BoatMalloc() or BoatMallocPersistent() does.
+
+
+@see BoatMalloc()
+
+@return
+    This function returns the address of the allocated memory. If allocation\n
+    fails, it returns NULL.
     
-    return ether_double;
+
+@param[in] size
+        How many bytes to allocate.
+
+@param[in] tag
+        The subsystem the memory is accounted to.
+
+@param[in] is_persistent
+        BOAT_TRUE to allocate outside transaction arenas.
+
+*******************************************************************************/
+void *BoatMallocTagged(BUINT32 size, BoatMemTag tag, BBOOL is_persistent)
+{
+    BoatMemHeader *header_ptr = NULL;
+
+    if( (BUINT32)tag >= BOAT_MEM_TAG_NUM )
+    {
+        tag = BOAT_MEM_TAG_OTHER;
+    }
+
+    if( size <= 0xFFFFFFFF - BOAT_MEM_HEADER_SIZE )
+    {
+        header_ptr = BoatMallocUntagged(BOAT_MEM_HEADER_SIZE + size, is_persistent);
+    }
+
+    if( header_ptr == NULL )
+    {
+        __atomic_add_fetch(&g_boat_mem_tag_stats[tag].fail_num, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&g_boat_mem_total_stats.fail_num, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    header_ptr->size = size;
+    header_ptr->tag = tag;
+    header_ptr->magic = BOAT_MEM_MAGIC_LIVE;
+    header_ptr->reserved = 0;
+
+    BoatMemAccountAlloc(&g_boat_mem_tag_stats[tag], size);
+    BoatMemAccountAlloc(&g_boat_mem_total_stats, size);
+
+    return (BUINT8 *)header_ptr + BOAT_MEM_HEADER_SIZE;
 }
+#endif
 
 
 /******************************************************************************
@@ -919,9 +1173,43 @@ Function: BoatMalloc()
 
     This function is a wrapper for dynamic memory allocation.
 
-    It typically wraps malloc() in a linux or Windows system.
-    For RTOS it depends on the specification of the RTOS.
+    It allocates from the transaction arena of the calling thread in an arena
+    scope, or from the allocator set by BoatSetAllocator() otherwise.
+
+    The function name is parenthesized so that the BoatMalloc() macro of
+    BOAT_MEM_ACCOUNTING doesn't expand here. Calls through this function are
+    accounted to BOAT_MEM_TAG_OTHER.
+
+
+@return
+    This function returns the address of the allocated memory. If allocation\n
+    fails, it returns NULL.
+    
 
+@param[in] size
+        How many bytes to allocate.
+
+*******************************************************************************/
+void *(BoatMalloc)(BUINT32 size)
+{
+#if BOAT_MEM_ACCOUNTING == 1
+    return BoatMallocTagged(size, BOAT_MEM_TAG_OTHER, BOAT_FALSE);
+#else
+    return BoatMallocUntagged(size, BOAT_FALSE);
+#endif
+}
+
+
+/******************************************************************************
+@brief Wrapper function for memory allocation outside transaction arenas
+
+Function: BoatMallocPersistent()
+
+    This function allocates from the allocator set by BoatSetAllocator() even
+    in an arena scope.
+
+
+@see BoatMalloc()
 
 @return
     This function returns the address of the allocated memory. If allocation\n
@@ -932,9 +1220,13 @@ Function: BoatMalloc()
         How many bytes to allocate.
 
 *******************************************************************************/
-void *BoatMalloc(BUINT32 size)
+void *(BoatMallocPersistent)(BUINT32 size)
 {
-    return(malloc(size));
+#if BOAT_MEM_ACCOUNTING == 1
+    return BoatMallocTagged(size, BOAT_MEM_TAG_OTHER, BOAT_TRUE);
+#else
+    return BoatMallocUntagged(size, BOAT_TRUE);
+#endif
 }
 
 
@@ -945,8 +1237,8 @@ Function: BoatFree()
 
     This function is a wrapper for dynamic memory de-allocation.
 
-    It typically wraps free() in a linux or Windows system.
-    For RTOS it depends on the specification of the RTOS.
+    Memory taken from the transaction arena of the calling thread is left to
+    BoatTxArenaEnd().
 
 
 @see BoatMalloc()
@@ -956,13 +1248,316 @@ Function: BoatFree()
     
 
 @param[in] mem_ptr
-    The address to free. The address must be the one returned by BoatMalloc().
+    The address to free. The address must be the one returned by BoatMalloc()\n
+    or BoatMallocPersistent().
 
 *******************************************************************************/
 void BoatFree(void *mem_ptr)
 {
-    free(mem_ptr);
-    return;
+#if BOAT_MEM_ACCOUNTING == 1
+    BoatMemHeader *header_ptr;
+#endif
+
+    if( mem_ptr == NULL )
+    {
+        return;
+    }
+
+#if BOAT_MEM_ACCOUNTING == 1
+    header_ptr = (BoatMemHeader *)((BUINT8 *)mem_ptr - BOAT_MEM_HEADER_SIZE);
+
+    if( header_ptr->magic != BOAT_MEM_MAGIC_LIVE )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Freeing %p not allocated by BoatMalloc() or freed twice.", mem_ptr);
+        return;
+    }
+
+    BoatMemHeaderFree(header_ptr, BOAT_FALSE);
+    mem_ptr = header_ptr;
+#endif
+
+    BoatFreeUntagged(mem_ptr);
+}
+
+
+/******************************************************************************
+@brief Set the allocator of BoatMalloc()
+
+Function: BoatSetAllocator()
+
+@return
+    This function doesn't return anything.
+    
+
+@param[in] allocator_ptr
+    The allocator, or NULL for the default allocator.
+
+*******************************************************************************/
+void BoatSetAllocator(const BoatAllocator *allocator_ptr)
+{
+    if( allocator_ptr != NULL && allocator_ptr->malloc_fn != NULL && allocator_ptr->free_fn != NULL )
+    {
+        g_boat_allocator = *allocator_ptr;
+    }
+    else
+    {
+        g_boat_allocator.malloc_fn = BoatDefaultMalloc;
+        g_boat_allocator.free_fn = BoatDefaultFree;
+    }
+}
+
+
+/******************************************************************************
+@brief Begin a transaction arena scope
+
+Function: BoatTxArenaBegin()
+
+    This function makes BoatMalloc() of the calling thread allocate from its
+    transaction arena, which is created on first use. If it cannot be created,
+    BoatMalloc() keeps allocating each block separately.
+
+@see BoatTxArenaEnd()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaBegin(void)
+{
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+    BoatTxArena *arena_ptr;
+
+    pthread_once(&g_boat_tx_arena_once, BoatTxArenaKeyCreate);
+
+    if( g_boat_tx_arena_key_created != BOAT_TRUE )
+    {
+        return;
+    }
+
+    arena_ptr = pthread_getspecific(g_boat_tx_arena_key);
+
+    if( arena_ptr == NULL )
+    {
+        arena_ptr = g_boat_allocator.malloc_fn(sizeof(BoatTxArena));
+        if( arena_ptr == NULL )
+        {
+            return;
+        }
+
+        arena_ptr->chunk_ptr = NULL;
+        arena_ptr->scope_depth = 0;
+
+        if( pthread_setspecific(g_boat_tx_arena_key, arena_ptr) != 0 )
+        {
+            g_boat_allocator.free_fn(arena_ptr);
+            return;
+        }
+    }
+
+    arena_ptr->scope_depth++;
+#endif
+}
+
+
+/******************************************************************************
+@brief End a transaction arena scope
+
+Function: BoatTxArenaEnd()
+
+    This function ends the scope begun by BoatTxArenaBegin(). When the outermost
+    scope ends, all chunks of the arena are freed except the first one if it's
+    of standard size, which is kept empty for the next transaction.
+
+@see BoatTxArenaBegin()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaEnd(void)
+{
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+    BoatTxArena *arena_ptr = BoatTxArenaInScope();
+    BoatTxArenaChunk *chunk_ptr;
+
+    if( arena_ptr == NULL || --arena_ptr->scope_depth > 0 )
+    {
+        return;
+    }
+
+#if BOAT_MEM_ACCOUNTING == 1
+    for( chunk_ptr = arena_ptr->chunk_ptr; chunk_ptr != NULL; chunk_ptr = chunk_ptr->next_ptr )
+    {
+        BoatTxArenaChunkAccountUnfreed(chunk_ptr);
+    }
+#endif
+
+    while( arena_ptr->chunk_ptr != NULL )
+    {
+        chunk_ptr = arena_ptr->chunk_ptr;
+
+        if(    chunk_ptr->next_ptr == NULL
+            && chunk_ptr->chunk_size == BOAT_ROUNDUP(BOAT_TX_ARENA_CHUNK_SIZE, BOAT_TX_ARENA_ALIGN) )
+        {
+            chunk_ptr->used_size = 0;
+            break;
+        }
+
+        arena_ptr->chunk_ptr = chunk_ptr->next_ptr;
+        g_boat_allocator.free_fn(chunk_ptr);
+    }
+#endif
+}
+
+
+/******************************************************************************
+@brief Release the transaction arena of the calling thread
+
+Function: BoatTxArenaRelease()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatTxArenaRelease(void)
+{
+#if BOAT_TX_ARENA_CHUNK_SIZE > 0
+    BoatTxArena *arena_ptr;
+
+    if( __atomic_load_n(&g_boat_tx_arena_key_created, __ATOMIC_ACQUIRE) != BOAT_TRUE )
+    {
+        return;
+    }
+
+    arena_ptr = pthread_getspecific(g_boat_tx_arena_key);
+
+    if( arena_ptr != NULL && arena_ptr->scope_depth == 0 )
+    {
+        pthread_setspecific(g_boat_tx_arena_key, NULL);
+        BoatTxArenaDestroy(arena_ptr);
+    }
+#endif
+}
+
+
+#if BOAT_MEM_ACCOUNTING == 1
+__BOATSTATIC void BoatMemStatsLoad(const BoatMemStats *stats_ptr, BoatMemStats *copy_ptr)
+{
+    copy_ptr->live_bytes  = __atomic_load_n(&stats_ptr->live_bytes, __ATOMIC_RELAXED);
+    copy_ptr->peak_bytes  = __atomic_load_n(&stats_ptr->peak_bytes, __ATOMIC_RELAXED);
+    copy_ptr->alloc_num   = __atomic_load_n(&stats_ptr->alloc_num, __ATOMIC_RELAXED);
+    copy_ptr->free_num    = __atomic_load_n(&stats_ptr->free_num, __ATOMIC_RELAXED);
+    copy_ptr->fail_num    = __atomic_load_n(&stats_ptr->fail_num, __ATOMIC_RELAXED);
+    copy_ptr->unfreed_num = __atomic_load_n(&stats_ptr->unfreed_num, __ATOMIC_RELAXED);
+}
+
+
+__BOATSTATIC void BoatMemStatsReset(BoatMemStats *stats_ptr)
+{
+    __atomic_store_n(&stats_ptr->peak_bytes, __atomic_load_n(&stats_ptr->live_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_store_n(&stats_ptr->alloc_num, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats_ptr->free_num, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats_ptr->fail_num, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats_ptr->unfreed_num, 0, __ATOMIC_RELAXED);
+}
+
+
+/******************************************************************************
+@brief Get a snapshot of memory accounting
+
+Function: BoatMemGetSnapshot()
+
+@return
+    This function returns BOAT_SUCCESS if the snapshot is got.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[out] snapshot_ptr
+    The snapshot.
+
+*******************************************************************************/
+BOAT_RESULT BoatMemGetSnapshot(BOAT_OUT BoatMemSnapshot *snapshot_ptr)
+{
+    BUINT32 i;
+
+    if( snapshot_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Argument cannot be NULL.");
+        return BOAT_ERROR_NULL_POINTER;
+    }
+
+    for( i = 0; i < BOAT_MEM_TAG_NUM; i++ )
+    {
+        BoatMemStatsLoad(&g_boat_mem_tag_stats[i], &snapshot_ptr->tag_stats[i]);
+    }
+    BoatMemStatsLoad(&g_boat_mem_total_stats, &snapshot_ptr->total_stats);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Reset memory accounting
+
+Function: BoatMemResetStats()
+
+@return
+    This function doesn't return anything.
+    
+*******************************************************************************/
+void BoatMemResetStats(void)
+{
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_MEM_TAG_NUM; i++ )
+    {
+        BoatMemStatsReset(&g_boat_mem_tag_stats[i]);
+    }
+    BoatMemStatsReset(&g_boat_mem_total_stats);
+}
+#endif
+
+
+/******************************************************************************
+@brief Set the log level at runtime
+
+Function: BoatLogSetLevel()
+
+@return
+    This function returns BOAT_SUCCESS if <level> is valid.\n
+    Otherwise it returns BOAT_ERROR_INVALID_ARGUMENT.
+    
+
+@param[in] level
+    One of BOAT_LOG_NONE, BOAT_LOG_CRITICAL, BOAT_LOG_NORMAL or BOAT_LOG_VERBOSE.
+
+*******************************************************************************/
+BOAT_RESULT BoatLogSetLevel(BUINT32 level)
+{
+    if( level > BOAT_LOG_VERBOSE )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid log level %u.", level);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    __atomic_store_n(&g_boat_log_level, level, __ATOMIC_RELAXED);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Get the log level set at runtime
+
+Function: BoatLogGetLevel()
+
+@return
+    This function returns the level set by BoatLogSetLevel().
+    
+*******************************************************************************/
+BUINT32 BoatLogGetLevel(void)
+{
+    return __atomic_load_n(&g_boat_log_level, __ATOMIC_RELAXED);
 }
 
 
@@ -20,6 +20,8 @@
 boatethwallet.c defines the Ethereum wallet API for BoAT IoT SDK.
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_WALLET
+
 #include "boatinternal.h"
 
 #include "web3intf.h"
@@ -27,6 +29,8 @@ boatethwallet.c defines the Ethereum wallet API for BoAT IoT SDK.
 #include "rpcintf.h"
 
 #include "randgenerator.h"
+#include "boatsigner.h"
+#include "boattxprofile.h"
 #include "bignum.h"
 #include "cJSON.h"
 
@@ -36,6 +40,10 @@ boatethwallet.c defines the Ethereum wallet API for BoAT IoT SDK.
 #endif
 
 
+__BOATSTATIC BOAT_RESULT EthAccountSet(BoatEthAccountInfo *account_ptr, const BUINT8 priv_key_array[32], const BUINT8 *pub_key_ptr);
+__BOATSTATIC void EthAccountWipe(BoatEthAccountInfo *account_ptr);
+__BOATSTATIC BoatEthAccountInfo * EthWalletGetAccountLocked(BoatEthWallet *wallet_ptr, BUINT32 account_index);
+__BOATSTATIC BSINT32 EthWalletFindAccountLocked(BoatEthWallet *wallet_ptr, const BUINT8 address[BOAT_ETH_ADDRESS_SIZE]);
 
 
 /******************************************************************************
@@ -77,6 +85,40 @@ Function: BoatEthWalletInit()
 
 *******************************************************************************/
 BoatEthWallet * BoatEthWalletInit(const BoatEthWalletConfig *config_ptr, BUINT32 config_size)
+{
+    return EthWalletInitWithPubkey(config_ptr, config_size, NULL);
+}
+
+
+/******************************************************************************
+@brief Initialize Boat Ethereum Wallet with a known public key
+
+Function: EthWalletInitWithPubkey()
+
+    This function is the same as BoatEthWalletInit(), except that the public
+    key of the wallet account is given instead of derived from the private key.
+    BoatWalletCreate() calls it to load a cached wallet (see boatwalletcache.h).
+
+    The caller is responsible for <pub_key_ptr> matching the private key in
+    <config_ptr>.
+
+@see BoatEthWalletInit()
+
+@return
+    This function returns instance pointer of BoatEthWallet if initialization is successful.\n
+    Otherwise it returns NULL.
+
+@param[in] config_ptr
+    Pointer to Ethereum wallet configuration.
+
+@param[in] config_size
+    Size (in byte) of Ethereum wallet configuration.
+
+@param[in] pub_key_ptr
+    64-byte public key of the account, or NULL to derive it from the private key.
+
+*******************************************************************************/
+BoatEthWallet * EthWalletInitWithPubkey(const BoatEthWalletConfig *config_ptr, BUINT32 config_size, const BUINT8 *pub_key_ptr)
 {
     BoatEthWallet *wallet_ptr;
     BOAT_RESULT result;
@@ -100,23 +142,31 @@ BoatEthWallet * BoatEthWalletInit(const BoatEthWalletConfig *config_ptr, BUINT32
         return NULL;
     }
         
-    // Init Web3 interface
-    wallet_ptr->web3intf_context_ptr = web3_init();
-
-    if( wallet_ptr->web3intf_context_ptr == NULL )
-    {
-        BoatFree(wallet_ptr);
-        return NULL;
-    }
+    // The Web3 interface context is per thread, see web3_thread_context()
 
     // Set EIP-155 Compatibility to TRUE by default
     BoatEthWalletSetEIP155Comp(wallet_ptr, config_ptr->eip155_compatibility);
 
+    // Account 0 is the only account of a new wallet
+    memset(wallet_ptr->added_account_ptr_array, 0x00, sizeof(wallet_ptr->added_account_ptr_array));
+    wallet_ptr->selected_account_index = 0;
+    pthread_mutex_init(&wallet_ptr->account_lock, NULL);
+    pthread_cond_init(&wallet_ptr->account_cond, NULL);
+
     // Configure private key
-    result = BoatEthWalletSetPrivkey(wallet_ptr, config_ptr->priv_key_array);
+    wallet_ptr->account_info.ref_num = 0;
+    if( pub_key_ptr == NULL )
+    {
+        result = BoatEthWalletSetPrivkey(wallet_ptr, config_ptr->priv_key_array);
+    }
+    else
+    {
+        result = EthAccountSet(&wallet_ptr->account_info, config_ptr->priv_key_array, pub_key_ptr);
+    }
     if( result != BOAT_SUCCESS)
     {
-        web3_deinit(wallet_ptr->web3intf_context_ptr);
+        pthread_cond_destroy(&wallet_ptr->account_cond);
+        pthread_mutex_destroy(&wallet_ptr->account_lock);
         BoatFree(wallet_ptr);
         return NULL;
     }
@@ -129,7 +179,9 @@ BoatEthWallet * BoatEthWalletInit(const BoatEthWalletConfig *config_ptr, BUINT32
     result = BoatEthWalletSetNodeUrl(wallet_ptr, config_ptr->node_url_str);
     if( result != BOAT_SUCCESS)
     {
-        web3_deinit(wallet_ptr->web3intf_context_ptr);
+        EthAccountWipe(&wallet_ptr->account_info);
+        pthread_cond_destroy(&wallet_ptr->account_cond);
+        pthread_mutex_destroy(&wallet_ptr->account_lock);
         BoatFree(wallet_ptr);
         return NULL;
     }
@@ -161,9 +213,20 @@ void BoatEthWalletDeInit(BoatEthWallet *wallet_ptr)
 
     if( wallet_ptr != NULL )
     {
+        BUINT32 i;
 
-        // Destroy private key in wallet memory
-        memset(wallet_ptr->account_info.priv_key_array, 0x00, 32);
+        // Destroy private keys in wallet memory
+        EthAccountWipe(&wallet_ptr->account_info);
+
+        for( i = 0; i < BOAT_ETH_MAX_ACCOUNT_NUM - 1; i++ )
+        {
+            if( wallet_ptr->added_account_ptr_array[i] != NULL )
+            {
+                EthAccountWipe(wallet_ptr->added_account_ptr_array[i]);
+                BoatFree(wallet_ptr->added_account_ptr_array[i]);
+                wallet_ptr->added_account_ptr_array[i] = NULL;
+            }
+        }
 
         if( wallet_ptr->network_info.node_url_ptr != NULL )
         {
@@ -171,7 +234,8 @@ void BoatEthWalletDeInit(BoatEthWallet *wallet_ptr)
             wallet_ptr->network_info.node_url_ptr = NULL;
         }
 
-        web3_deinit(wallet_ptr->web3intf_context_ptr);
+        pthread_cond_destroy(&wallet_ptr->account_cond);
+        pthread_mutex_destroy(&wallet_ptr->account_lock);
 
         BoatFree(wallet_ptr);
     }
@@ -320,7 +384,7 @@ BOAT_RESULT BoatEthWalletSetChainId(BoatEthWallet *wallet_ptr, BUINT32 chain_id)
 
 Function: BoatEthWalletSetPrivkey()
 
-    This function sets the private key of the wallet account.
+    This function sets the private key of the wallet account, i.e. account 0.
 
     A private key is 256 bit. If it's treated as a UINT256 in bigendian, the
     valid private key value for Ethereum is [1, n-1], where n is
@@ -336,6 +400,8 @@ Function: BoatEthWalletSetPrivkey()
     private key. The public key is calculated by co-sign algorithm with the
     co-sign server.
 
+    The key is replaced once all references to account 0 are released.
+
     NOTE: Be very careful to PROTECT the private key.
 
 @see
@@ -354,8 +420,7 @@ Function: BoatEthWalletSetPrivkey()
 *******************************************************************************/
 BOAT_RESULT BoatEthWalletSetPrivkey(BoatEthWallet *wallet_ptr, const BUINT8 priv_key_array[32])
 {
-    BUINT8 pub_key[65];
-    BUINT8 pub_key_digest[32];
+    BoatEthAccountInfo new_account;
     BOAT_RESULT result;
 
     if( wallet_ptr == NULL )
@@ -382,27 +447,96 @@ BOAT_RESULT BoatEthWalletSetPrivkey(BoatEthWallet *wallet_ptr, const BUINT8 priv
     
     // Set private key and calculate public key as well as address
     // PRIVATE KEY MUST BE SET BEFORE SETTING NONCE AND GASPRICE
+    // The public key is derived before taking the lock
+    result = EthAccountSet(&new_account, priv_key_array, NULL);
+    if( result != BOAT_SUCCESS )
+    {
+        EthAccountWipe(&new_account);
+        return result;
+    }
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+
+    // Wait for transactions being signed by account 0, as BoatEthWalletRemoveAccount() does
+    while( wallet_ptr->account_info.ref_num != 0 )
+    {
+        pthread_cond_wait(&wallet_ptr->account_cond, &wallet_ptr->account_lock);
+    }
+
+    memcpy(wallet_ptr->account_info.priv_key_array, new_account.priv_key_array, 32);
+    memcpy(wallet_ptr->account_info.pub_key_array, new_account.pub_key_array, 64);
+    memcpy(wallet_ptr->account_info.address, new_account.address, BOAT_ETH_ADDRESS_SIZE);
+
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+
+    // Wipe the copy of the key
+    EthAccountWipe(&new_account);
+
+    return BOAT_SUCCESS;
+}
 
-    memcpy(wallet_ptr->account_info.priv_key_array, priv_key_array, 32);
-    
-    // Calculate address from private key;
-    ecdsa_get_public_key65(
-                            &secp256k1,
-                            wallet_ptr->account_info.priv_key_array,
-                            pub_key);
 
-    // pub_key[] is a 65-byte array with pub_key[0] being 0x04 SECG prefix followed by 64-byte public key
-    // Thus skip pub_key[0]
-    memcpy(wallet_ptr->account_info.pub_key_array, &pub_key[1], 64);
+/******************************************************************************
+@brief Set an account from a checked private key
+
+Function: EthAccountSet()
+
+    This function sets the private key, the public key and the address of an
+    account. If <pub_key_ptr> is NULL, the public key is derived from the
+    private key.
+
+@return
+    This function returns BOAT_SUCCESS if setting is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] account_ptr
+    The account.
+
+@param[in] priv_key_array
+    Private key to use. It must have been checked.
+
+@param[in] pub_key_ptr
+    64-byte public key of <priv_key_array>, or NULL.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT EthAccountSet(BoatEthAccountInfo *account_ptr, const BUINT8 priv_key_array[32], const BUINT8 *pub_key_ptr)
+{
+    BUINT8 pub_key_digest[32];
+    BOAT_RESULT result;
+
+    memcpy(account_ptr->priv_key_array, priv_key_array, 32);
+
+    if( pub_key_ptr != NULL )
+    {
+        memcpy(account_ptr->pub_key_array, pub_key_ptr, 64);
+    }
+    else
+    {
+        // Calculate address from private key;
+        result = BoatSignerGetPubkey(account_ptr->priv_key_array,
+                                     account_ptr->pub_key_array);
+
+        if( result != BOAT_SUCCESS )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Fail to calculate public key.");
+            return result;
+        }
+    }
 
-    keccak_256(&pub_key[1], 64, pub_key_digest);
+    keccak_256(account_ptr->pub_key_array, 64, pub_key_digest);
 
-    memcpy(wallet_ptr->account_info.address, pub_key_digest+12, 20); // Address is the least significant 20 bytes of public key's hash
+    memcpy(account_ptr->address, pub_key_digest+12, 20); // Address is the least significant 20 bytes of public key's hash
 
     return BOAT_SUCCESS;
 }
 
 
+__BOATSTATIC void EthAccountWipe(BoatEthAccountInfo *account_ptr)
+{
+    memset(account_ptr->priv_key_array, 0x00, 32);
+}
+
+
 /******************************************************************************
 @brief Generate Private Key
 
@@ -551,7 +685,7 @@ Function: BoatEthWalletGetBalance()
 
 @param[in] alt_address_str
     A string representing which address to get balance from.
-    If NULL, get balance of the wallet's owner address.\n
+    If NULL, get balance of the selected account of the wallet.\n
     Otherwise, get balance of the specified altered address, in HEX format like\n
     "0x19c91A4649654265823512a457D2c16981bB64F5".
 
@@ -559,6 +693,7 @@ Function: BoatEthWalletGetBalance()
 BCHAR * BoatEthWalletGetBalance(BoatEthWallet *wallet_ptr, BCHAR *alt_address_str)
 {
     BUINT8 alt_address[BOAT_ETH_ADDRESS_SIZE];   // Binary altered address converted from alt_address_str
+    BoatEthAccountInfo *account_ptr;
     BUINT8 *address_ptr;     // Point to an address in binary format, either wallet
                              // owner's or the one converted from alt_address_str
     BCHAR address_str[43];   // Address in string format, converted from address_ptr
@@ -578,7 +713,17 @@ BCHAR * BoatEthWalletGetBalance(BoatEthWallet *wallet_ptr, BCHAR *alt_address_st
         // PRIVATE KEY MUST BE SET BEFORE GETTING BALANCE, BECAUSE GETTING BALANCE FROM
         // NETWORK NEEDS ETHEREUM ADDRESS, WHICH IS COMPUTED FROM KEY
 
-        address_ptr = wallet_ptr->account_info.address;
+        account_ptr = BoatEthWalletAcquireAccount(wallet_ptr,
+                                                  __atomic_load_n(&wallet_ptr->selected_account_index, __ATOMIC_RELAXED));
+        if( account_ptr == NULL )
+        {
+            // Removed after it was read as selected
+            account_ptr = BoatEthWalletAcquireAccount(wallet_ptr, 0);
+        }
+        memcpy(alt_address, account_ptr->address, BOAT_ETH_ADDRESS_SIZE);
+        BoatEthWalletReleaseAccount(wallet_ptr, account_ptr);
+
+        address_ptr = alt_address;
     }
     else
     {
@@ -613,7 +758,7 @@ BCHAR * BoatEthWalletGetBalance(BoatEthWallet *wallet_ptr, BCHAR *alt_address_st
 
 
     
-    tx_balance_str = web3_eth_getBalance(wallet_ptr->web3intf_context_ptr,
+    tx_balance_str = web3_eth_getBalance(web3_thread_context(),
                                     wallet_ptr->network_info.node_url_ptr,
                                     &param_eth_getBalance);
 
@@ -627,6 +772,463 @@ BCHAR * BoatEthWalletGetBalance(BoatEthWallet *wallet_ptr, BCHAR *alt_address_st
 }
 
 
+/******************************************************************************
+@brief Get Balance of the wallet account in wei
+
+Function: BoatEthWalletGetBalanceUint256()
+
+    This function gets the balance of the wallet account from network, as
+    BoatEthWalletGetBalance() does, and parses it to a 256-bit integer in wei.
+    Compare it with UtilityUint256Compare() and format it with
+    UtilityWeiToEthStr() without losing any wei.
+
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+    
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] alt_address_str
+    A string representing which address to get balance from.
+    If NULL, get balance of the selected account of the wallet.\n
+    Otherwise, get balance of the specified altered address, in HEX format like\n
+    "0x19c91A4649654265823512a457D2c16981bB64F5".
+
+@param[out] balance_ptr
+    The balance in wei.
+
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletGetBalanceUint256(BoatEthWallet *wallet_ptr,
+                                           BCHAR *alt_address_str,
+                                           BOAT_OUT BUINT256 *balance_ptr)
+{
+    BCHAR *tx_balance_str;
+    Web3IntfContext *web3intf_context_ptr;
+    BOAT_RESULT result;
+
+    if( wallet_ptr == NULL || balance_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Arguments cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    web3intf_context_ptr = web3_thread_context();
+    if( web3intf_context_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    tx_balance_str = BoatEthWalletGetBalance(wallet_ptr, alt_address_str);
+
+    result = BoatEthPraseRpcResponseResult(tx_balance_str, "",
+                                           &web3intf_context_ptr->web3_result_string_buf);
+    if( result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to get balance from network.");
+        return result;
+    }
+
+    return UtilityUint256FromHex(balance_ptr,
+                                 (BCHAR*)web3intf_context_ptr->web3_result_string_buf.field_ptr);
+}
+
+
+/******************************************************************************
+@brief Add an account to the wallet
+
+Function: BoatEthWalletAddAccount()
+
+    This function adds an account with given private key to the wallet. Added
+    accounts share the network information of the wallet and are not persistent.
+
+@return
+    This function returns the index of the account.\n
+    Otherwise it returns one of the error codes, which are negative.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] priv_key_array
+    Private key of the account.
+        
+*******************************************************************************/
+BSINT32 BoatEthWalletAddAccount(BoatEthWallet *wallet_ptr, const BUINT8 priv_key_array[32])
+{
+    BoatEthAccountInfo *account_ptr;
+    BSINT32 free_index = -1;
+    BSINT32 found_index;
+    BUINT32 i;
+    BOAT_RESULT result;
+
+    if( wallet_ptr == NULL || priv_key_array == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Argument cannot be NULL.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    if( BoatEthWalletCheckPrivkey(priv_key_array) != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Private key is not valid.");
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    account_ptr = BoatMalloc(sizeof(BoatEthAccountInfo));
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to allocate account.");
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    // The public key is derived before taking the lock
+    account_ptr->ref_num = 0;
+    result = EthAccountSet(account_ptr, priv_key_array, NULL);
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+
+    // An account that is already in the wallet keeps its index
+    found_index = (result == BOAT_SUCCESS) ? EthWalletFindAccountLocked(wallet_ptr, account_ptr->address) : -1;
+
+    for( i = 0; i < BOAT_ETH_MAX_ACCOUNT_NUM - 1 && found_index < 0; i++ )
+    {
+        if( wallet_ptr->added_account_ptr_array[i] == NULL )
+        {
+            free_index = i;
+            break;
+        }
+    }
+
+    if( result == BOAT_SUCCESS && found_index < 0 && free_index >= 0 )
+    {
+        wallet_ptr->added_account_ptr_array[free_index] = account_ptr;
+    }
+
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+
+    if( result != BOAT_SUCCESS || found_index >= 0 || free_index < 0 )
+    {
+        EthAccountWipe(account_ptr);
+        BoatFree(account_ptr);
+
+        if( result != BOAT_SUCCESS )
+        {
+            return result;
+        }
+        if( found_index >= 0 )
+        {
+            return found_index;
+        }
+
+        BoatLog(BOAT_LOG_NORMAL, "Too many accounts in the wallet.");
+        return BOAT_ERROR;
+    }
+
+    return free_index + 1;
+}
+
+
+/******************************************************************************
+@brief Remove an account from the wallet
+
+Function: BoatEthWalletRemoveAccount()
+
+    This function removes an added account and wipes its private key. If it's
+    selected, account 0 is selected instead.
+
+@return
+    This function returns BOAT_SUCCESS if the account is removed.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account to remove, which must not be 0.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletRemoveAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index)
+{
+    BoatEthAccountInfo *account_ptr = NULL;
+
+    if( wallet_ptr != NULL && account_index != 0 && account_index < BOAT_ETH_MAX_ACCOUNT_NUM )
+    {
+        pthread_mutex_lock(&wallet_ptr->account_lock);
+
+        // Once it's out of the table, no new reference can be taken
+        account_ptr = wallet_ptr->added_account_ptr_array[account_index - 1];
+        wallet_ptr->added_account_ptr_array[account_index - 1] = NULL;
+
+        if( account_ptr != NULL )
+        {
+            // Wait for transactions being signed by the account
+            while( account_ptr->ref_num != 0 )
+            {
+                pthread_cond_wait(&wallet_ptr->account_cond, &wallet_ptr->account_lock);
+            }
+
+            // Checked last, as BoatEthWalletSelectAccount() selects while holding a reference
+            if( wallet_ptr->selected_account_index == account_index )
+            {
+                __atomic_store_n(&wallet_ptr->selected_account_index, 0, __ATOMIC_RELAXED);
+            }
+        }
+
+        pthread_mutex_unlock(&wallet_ptr->account_lock);
+    }
+
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No removable account %u.", account_index);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    EthAccountWipe(account_ptr);
+    BoatFree(account_ptr);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Select the default account of the wallet
+
+Function: BoatEthWalletSelectAccount()
+
+@return
+    This function returns BOAT_SUCCESS if the account is selected.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account to select.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthWalletSelectAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index)
+{
+    BoatEthAccountInfo *account_ptr;
+
+    account_ptr = BoatEthWalletAcquireAccount(wallet_ptr, account_index);
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No account %u in the wallet.", account_index);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    // The account can't be removed before it's selected
+    __atomic_store_n(&wallet_ptr->selected_account_index, account_index, __ATOMIC_RELAXED);
+    BoatEthWalletReleaseAccount(wallet_ptr, account_ptr);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Find an account of the wallet by address
+
+Function: BoatEthWalletFindAccount()
+
+@return
+    This function returns the index of the account with given address.\n
+    If the wallet has no such account, it returns BOAT_ERROR.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] address
+    Address of the account to find.
+        
+*******************************************************************************/
+BSINT32 BoatEthWalletFindAccount(BoatEthWallet *wallet_ptr, const BUINT8 address[BOAT_ETH_ADDRESS_SIZE])
+{
+    BSINT32 found_index;
+
+    if( wallet_ptr == NULL || address == NULL )
+    {
+        return BOAT_ERROR;
+    }
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+    found_index = EthWalletFindAccountLocked(wallet_ptr, address);
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+
+    return found_index;
+}
+
+
+/******************************************************************************
+@brief Get an account of the wallet by index
+
+Function: BoatEthWalletGetAccount()
+
+    This function takes no reference to the account, see
+    BoatEthWalletAcquireAccount().
+
+@return
+    This function returns the account information, or NULL if the wallet has
+    no account with given index.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account.
+        
+*******************************************************************************/
+BoatEthAccountInfo * BoatEthWalletGetAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index)
+{
+    BoatEthAccountInfo *account_ptr;
+
+    if( wallet_ptr == NULL || account_index >= BOAT_ETH_MAX_ACCOUNT_NUM )
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+    account_ptr = EthWalletGetAccountLocked(wallet_ptr, account_index);
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+
+    return account_ptr;
+}
+
+
+/******************************************************************************
+@brief Take a reference to an account of the wallet
+
+Function: BoatEthWalletAcquireAccount()
+
+    This function gets an account and keeps BoatEthWalletRemoveAccount() from
+    freeing it until BoatEthWalletReleaseAccount() is called.
+
+@return
+    This function returns the account information, or NULL if the wallet has
+    no account with given index.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account.
+        
+*******************************************************************************/
+BoatEthAccountInfo * BoatEthWalletAcquireAccount(BoatEthWallet *wallet_ptr, BUINT32 account_index)
+{
+    BoatEthAccountInfo *account_ptr;
+
+    if( wallet_ptr == NULL || account_index >= BOAT_ETH_MAX_ACCOUNT_NUM )
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+    account_ptr = EthWalletGetAccountLocked(wallet_ptr, account_index);
+    if( account_ptr != NULL )
+    {
+        account_ptr->ref_num++;
+    }
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+
+    return account_ptr;
+}
+
+
+/******************************************************************************
+@brief Release a reference to an account of the wallet
+
+Function: BoatEthWalletReleaseAccount()
+
+    This function releases a reference taken by BoatEthWalletAcquireAccount(),
+    waking up BoatEthWalletRemoveAccount() if it waits for the last one.
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_ptr
+    The account returned by BoatEthWalletAcquireAccount().
+        
+*******************************************************************************/
+void BoatEthWalletReleaseAccount(BoatEthWallet *wallet_ptr, BoatEthAccountInfo *account_ptr)
+{
+    if( wallet_ptr == NULL || account_ptr == NULL )
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&wallet_ptr->account_lock);
+    if( --account_ptr->ref_num == 0 )
+    {
+        pthread_cond_broadcast(&wallet_ptr->account_cond);
+    }
+    pthread_mutex_unlock(&wallet_ptr->account_lock);
+}
+
+
+/******************************************************************************
+@brief Get an account of the wallet by index, with the account lock held
+
+Function: EthWalletGetAccountLocked()
+
+@return
+    This function returns the account information, or NULL if the wallet has
+    no account with given index.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] account_index
+    Index of the account, less than BOAT_ETH_MAX_ACCOUNT_NUM.
+        
+*******************************************************************************/
+__BOATSTATIC BoatEthAccountInfo * EthWalletGetAccountLocked(BoatEthWallet *wallet_ptr, BUINT32 account_index)
+{
+    if( account_index == 0 )
+    {
+        return &wallet_ptr->account_info;
+    }
+
+    return wallet_ptr->added_account_ptr_array[account_index - 1];
+}
+
+
+/******************************************************************************
+@brief Find an account of the wallet by address, with the account lock held
+
+Function: EthWalletFindAccountLocked()
+
+@return
+    This function returns the index of the account with given address.\n
+    If the wallet has no such account, it returns BOAT_ERROR.
+
+@param[in] wallet_ptr
+    Wallet context pointer.
+
+@param[in] address
+    Address of the account to find.
+        
+*******************************************************************************/
+__BOATSTATIC BSINT32 EthWalletFindAccountLocked(BoatEthWallet *wallet_ptr, const BUINT8 address[BOAT_ETH_ADDRESS_SIZE])
+{
+    BoatEthAccountInfo *account_ptr;
+    BUINT32 i;
+
+    for( i = 0; i < BOAT_ETH_MAX_ACCOUNT_NUM; i++ )
+    {
+        account_ptr = EthWalletGetAccountLocked(wallet_ptr, i);
+        if( account_ptr != NULL && memcmp(account_ptr->address, address, BOAT_ETH_ADDRESS_SIZE) == 0 )
+        {
+            return i;
+        }
+    }
+
+    return BOAT_ERROR;
+}
+
+
 
 
 
@@ -730,6 +1332,8 @@ BOAT_RESULT BoatEthTxInit(BoatEthWallet *wallet_ptr,
 
     memset(&tx_ptr->rawtx_fields, 0x00, sizeof(tx_ptr->rawtx_fields));
 
+    // Sign with the selected account unless BoatEthTxSetAccount() is called
+    tx_ptr->account_index = __atomic_load_n(&wallet_ptr->selected_account_index, __ATOMIC_RELAXED);
 
     // Set synchronous transaction flag
     tx_ptr->is_sync_tx = is_sync_tx;
@@ -850,7 +1454,10 @@ BOAT_RESULT BoatEthTxSetNonce(BoatEthTx *tx_ptr, BUINT64 nonce)
 {
     BCHAR account_address_str[43];
     Param_eth_getTransactionCount param_eth_getTransactionCount;
+    BoatEthAccountInfo *account_ptr;
     BCHAR *tx_count_str;
+    Web3IntfContext *web3intf_context_ptr;
+    BOAT_TX_PROFILE_DECLARE(profile_start);
 	BOAT_RESULT result = BOAT_SUCCESS;
 
     if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
@@ -866,26 +1473,41 @@ BOAT_RESULT BoatEthTxSetNonce(BoatEthTx *tx_ptr, BUINT64 nonce)
     // Get transaction count from network
     // Return value of web3_eth_getTransactionCount() is transaction count
     
+    account_ptr = BoatEthWalletAcquireAccount(tx_ptr->wallet_ptr, tx_ptr->account_index);
+    if( account_ptr == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No account %u in the wallet.", tx_ptr->account_index);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
     UtilityBin2Hex(
         account_address_str,
-        tx_ptr->wallet_ptr->account_info.address,
+        account_ptr->address,
         BOAT_ETH_ADDRESS_SIZE,
         BIN2HEX_LEFTTRIM_UNFMTDATA,
         BIN2HEX_PREFIX_0x_YES,
         BOAT_FALSE
         );
+    BoatEthWalletReleaseAccount(tx_ptr->wallet_ptr, account_ptr);
         
     param_eth_getTransactionCount.address_str = account_address_str;
     param_eth_getTransactionCount.block_num_str = "latest";
 
     if (BOAT_ETH_NONCE_AUTO == nonce)
     {
-        tx_count_str = web3_eth_getTransactionCount(tx_ptr->wallet_ptr->web3intf_context_ptr,
+        BOAT_TX_PROFILE_BEGIN(profile_start);
+
+        web3intf_context_ptr = web3_thread_context();
+        if( web3intf_context_ptr == NULL )
+        {
+            return BOAT_ERROR_OUT_OF_MEMORY;
+        }
+        tx_count_str = web3_eth_getTransactionCount(web3intf_context_ptr,
                                         tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                         &param_eth_getTransactionCount);
 
 		result = BoatEthPraseRpcResponseResult( tx_count_str, "", 
-												&tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf);
+												&web3intf_context_ptr->web3_result_string_buf);
         if( result != BOAT_SUCCESS )
         { 
             BoatLog(BOAT_LOG_CRITICAL, "Fail to get transaction count from network.");
@@ -897,10 +1519,12 @@ BOAT_RESULT BoatEthTxSetNonce(BoatEthTx *tx_ptr, BUINT64 nonce)
         UtilityHex2Bin(
                         tx_ptr->rawtx_fields.nonce.field,
                         32,
-                        (BCHAR*)tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf.field_ptr,
+                        (BCHAR*)web3intf_context_ptr->web3_result_string_buf.field_ptr,
                         TRIMBIN_LEFTTRIM,
                         BOAT_TRUE
                       );
+
+        BOAT_TX_PROFILE_END(BOAT_TX_PHASE_NONCE_FETCH, profile_start);
     }
     else
     {
@@ -919,6 +1543,40 @@ BOAT_RESULT BoatEthTxSetNonce(BoatEthTx *tx_ptr, BUINT64 nonce)
 }
 
 
+/******************************************************************************
+@brief Set Transaction Parameter: Signing Account
+
+Function: BoatEthTxSetAccount()
+
+    This function sets the wallet account that signs the transaction.
+
+
+@return
+    This function returns BOAT_SUCCESS if setting is successful.\n
+    Otherwise it returns one of the error codes.
+
+
+@param[in] tx_ptr
+    Pointer to the transaction structure.
+
+@param[in] account_index
+    Index of the signing account in the wallet of the transaction.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthTxSetAccount(BoatEthTx *tx_ptr, BUINT32 account_index)
+{
+    if( tx_ptr == NULL || BoatEthWalletGetAccount(tx_ptr->wallet_ptr, account_index) == NULL )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "No account %u in the wallet.", account_index);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    tx_ptr->account_index = account_index;
+
+    return BOAT_SUCCESS;
+}
+
+
 /******************************************************************************
 @brief Set Transaction Parameter: GasPrice
 
@@ -943,6 +1601,8 @@ Function: BoatEthTxSetGasPrice()
 BOAT_RESULT BoatEthTxSetGasPrice(BoatEthTx *tx_ptr, BoatFieldMax32B *gas_price_ptr)
 {
     BCHAR *gas_price_from_net_str;
+    Web3IntfContext *web3intf_context_ptr;
+    BOAT_TX_PROFILE_DECLARE(profile_start);
     BOAT_RESULT result = BOAT_SUCCESS;
 
     if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL )
@@ -964,9 +1624,16 @@ BOAT_RESULT BoatEthTxSetGasPrice(BoatEthTx *tx_ptr, BoatFieldMax32B *gas_price_p
         // Get current gas price from network
         // Return value of web3_eth_gasPrice is in wei
         
-        gas_price_from_net_str = web3_eth_gasPrice(tx_ptr->wallet_ptr->web3intf_context_ptr, tx_ptr->wallet_ptr->network_info.node_url_ptr);
+        BOAT_TX_PROFILE_BEGIN(profile_start);
+
+        web3intf_context_ptr = web3_thread_context();
+        if( web3intf_context_ptr == NULL )
+        {
+            return BOAT_ERROR_OUT_OF_MEMORY;
+        }
+        gas_price_from_net_str = web3_eth_gasPrice(web3intf_context_ptr, tx_ptr->wallet_ptr->network_info.node_url_ptr);
 		result = BoatEthPraseRpcResponseResult( gas_price_from_net_str, "", 
-												&tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf);
+												&web3intf_context_ptr->web3_result_string_buf);
         if( result != BOAT_SUCCESS )
         {
             BoatLog(BOAT_LOG_NORMAL, "Fail to get gasPrice from network.");
@@ -979,11 +1646,13 @@ BOAT_RESULT BoatEthTxSetGasPrice(BoatEthTx *tx_ptr, BoatFieldMax32B *gas_price_p
             UtilityHex2Bin(
                             tx_ptr->rawtx_fields.gasprice.field,
                             32,
-                            (BCHAR*)tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf.field_ptr,
+                            (BCHAR*)web3intf_context_ptr->web3_result_string_buf.field_ptr,
                             TRIMBIN_LEFTTRIM,
                             BOAT_TRUE
                           );
 
+            BOAT_TX_PROFILE_END(BOAT_TX_PHASE_GAS_PRICE_FETCH, profile_start);
+
             BoatLog(BOAT_LOG_VERBOSE, "Use gasPrice from network: %s wei.", gas_price_from_net_str);
         }
     }
@@ -1122,6 +1791,45 @@ BOAT_RESULT BoatEthTxSetValue(BoatEthTx *tx_ptr, BoatFieldMax32B *value_ptr)
 }
 
 
+/******************************************************************************
+@brief Set Transaction Parameter: Transaction Value in 256-bit integer
+
+Function: BoatEthTxSetValueUint256()
+
+    This function sets the value of the transaction from a 256-bit integer in
+    wei, trimming its leading zeros as RLP encoding requires.
+
+
+@return
+    This function returns BOAT_SUCCESS if setting is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] tx_ptr
+    Pointer to the transaction structure.    
+
+@param[in] value_ptr
+    The value of the transaction in wei.\n
+    If <value_ptr> is NULL, it's treated as no value being transfered.
+        
+*******************************************************************************/
+BOAT_RESULT BoatEthTxSetValueUint256(BoatEthTx *tx_ptr, const BUINT256 *value_ptr)
+{
+    BoatFieldMax32B value;
+    BUINT8 value_array[32];
+
+    if( value_ptr == NULL )
+    {
+        return BoatEthTxSetValue(tx_ptr, NULL);
+    }
+
+    UtilityUint256ToBigendian(value_array, value_ptr);
+
+    value.field_len = UtilityTrimBin(value.field, value_array, sizeof(value_array), TRIMBIN_LEFTTRIM, BOAT_TRUE);
+
+    return BoatEthTxSetValue(tx_ptr, &value);
+}
+
+
 /******************************************************************************
 @brief Set Transaction Parameter: Data
 
@@ -1365,7 +2073,7 @@ BCHAR * BoatEthCallContractFunc(
 
     param_eth_call.block_num_str = "latest";
 
-    retval_str = web3_eth_call( tx_ptr->wallet_ptr->web3intf_context_ptr,
+    retval_str = web3_eth_call( web3_thread_context(),
                                 tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                 &param_eth_call);
 
@@ -1404,7 +2112,7 @@ Function: BoatEthTransfer()
 *******************************************************************************/
 BOAT_RESULT BoatEthTransfer(BoatEthTx *tx_ptr, BCHAR * value_hex_str)
 {
-    BoatFieldMax32B value;
+    BUINT256 value;
     BOAT_RESULT result;
    
     if( tx_ptr == NULL || tx_ptr->wallet_ptr == NULL|| value_hex_str == NULL )
@@ -1419,17 +2127,14 @@ BOAT_RESULT BoatEthTransfer(BoatEthTx *tx_ptr, BCHAR * value_hex_str)
     
 
     // Set value
+    result = UtilityUint256FromHex(&value, value_hex_str);
+    if( result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid value: %s.", value_hex_str);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
 
-    value.field_len =
-    UtilityHex2Bin(
-                    value.field,
-                    32,
-                    value_hex_str,
-                    TRIMBIN_LEFTTRIM,
-                    BOAT_TRUE
-                  );
-
-    result =BoatEthTxSetValue(tx_ptr, &value);
+    result = BoatEthTxSetValueUint256(tx_ptr, &value);
 
     if( result != BOAT_SUCCESS ) return BOAT_ERROR;
 
@@ -1475,6 +2180,8 @@ BOAT_RESULT BoatEthGetTransactionReceipt(BoatEthTx *tx_ptr)
     BCHAR *tx_status_str;
     Param_eth_getTransactionReceipt param_eth_getTransactionReceipt;
     BSINT32 tx_mined_timeout;
+    Web3IntfContext *web3intf_context_ptr;
+    BOAT_TX_PROFILE_DECLARE(profile_start);
 
     BOAT_RESULT result = BOAT_SUCCESS;
 
@@ -1495,15 +2202,23 @@ BOAT_RESULT BoatEthGetTransactionReceipt(BoatEthTx *tx_ptr)
     tx_mined_timeout = BOAT_WAIT_PENDING_TX_TIMEOUT;
     param_eth_getTransactionReceipt.tx_hash_str = tx_hash_str;
 
+    web3intf_context_ptr = web3_thread_context();
+    if( web3intf_context_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    BOAT_TX_PROFILE_BEGIN(profile_start);
+
     do
     {
         BoatSleep(BOAT_MINE_INTERVAL); // Sleep waiting for the block being mined
         
-        tx_status_str = web3_eth_getTransactionReceiptStatus(tx_ptr->wallet_ptr->web3intf_context_ptr,
+        tx_status_str = web3_eth_getTransactionReceiptStatus(web3intf_context_ptr,
                                         tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                         &param_eth_getTransactionReceipt);
 		result = BoatEthPraseRpcResponseResult( tx_status_str, "status", 
-												&tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf);
+												&web3intf_context_ptr->web3_result_string_buf);
         if( result != BOAT_SUCCESS )
 		{
             BoatLog(BOAT_LOG_NORMAL, "Fail to get transaction receipt due to RPC failure.");
@@ -1515,12 +2230,13 @@ BOAT_RESULT BoatEthGetTransactionReceipt(BoatEthTx *tx_ptr)
             // status of tx_status_str == "": the transaction is pending
             // status of tx_status_str == "0x1": the transaction is successfully mined
             // status of tx_status_str == "0x0": the transaction fails
-            if( tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf.field_ptr[0] != '\0' )
+            if( web3intf_context_ptr->web3_result_string_buf.field_ptr[0] != '\0' )
             {
-                if( strcmp((BCHAR*)tx_ptr->wallet_ptr->web3intf_context_ptr->web3_result_string_buf.field_ptr, "0x1") == 0 )
+                if( strcmp((BCHAR*)web3intf_context_ptr->web3_result_string_buf.field_ptr, "0x1") == 0 )
                 {
                     BoatLog(BOAT_LOG_NORMAL, "Transaction has got mined.");
                     result = BOAT_SUCCESS;
+                    BOAT_TX_PROFILE_END(BOAT_TX_PHASE_RECEIPT_WAIT, profile_start);
                     break;
                 }
                 else
@@ -270,7 +270,7 @@ Function: BoatPlatoneTransfer()
 *******************************************************************************/
 BOAT_RESULT BoatPlatoneTransfer(BoatPlatoneTx *tx_ptr, BCHAR * value_hex_str)
 {
-    BoatFieldMax32B value;
+    BUINT256 value;
     BoatFieldVariable data;
     BUINT64 tx_type_big;
     BOAT_RESULT result;
@@ -287,17 +287,14 @@ BOAT_RESULT BoatPlatoneTransfer(BoatPlatoneTx *tx_ptr, BCHAR * value_hex_str)
     
 
     // Set value
+    result = UtilityUint256FromHex(&value, value_hex_str);
+    if( result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Invalid value: %s.", value_hex_str);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
 
-    value.field_len =
-    UtilityHex2Bin(
-                    value.field,
-                    32,
-                    value_hex_str,
-                    TRIMBIN_LEFTTRIM,
-                    BOAT_TRUE
-                  );
-
-    result = BoatPlatoneTxSetValue(tx_ptr, &value);
+    result = BoatPlatoneTxSetValueUint256(tx_ptr, &value);
 
     if( result != BOAT_SUCCESS ) return BOAT_ERROR;
 
@@ -414,7 +411,7 @@ BCHAR * BoatPlatoneCallContractFunc(
 
     param_eth_call.block_num_str = "latest";
 
-    retval_str = web3_eth_call( tx_ptr->wallet_ptr->web3intf_context_ptr,
+    retval_str = web3_eth_call( web3_thread_context(),
                                 tx_ptr->wallet_ptr->network_info.node_url_ptr,
                                 &param_eth_call);
 
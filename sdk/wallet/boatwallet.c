@@ -22,6 +22,8 @@ boatwallet.c is the SDK main entry.
 @author aitos.io
 */
 
+#define BOAT_MEM_TAG BOAT_MEM_TAG_WALLET
+
 #include "boatinternal.h"
 #include "boatwallet.h"
 
@@ -34,6 +36,10 @@ boatwallet.c is the SDK main entry.
 #include "cJSON.h"
 
 #include "persiststore.h"
+#include "boatwalletcache.h"
+#include "memzero.h"
+
+#include <pthread.h>
 
 
 
@@ -41,18 +47,411 @@ BoatIotSdkContext g_boat_iot_sdk_context;
 
 
 
+#define BOAT_WALLET_NAME_SLOT_EMPTY   (-1)
+#define BOAT_WALLET_NAME_SLOT_REMOVED (-2)
+
+//!@brief Set in BoatWalletList::ref_state while the wallet is loaded
+#define BOAT_WALLET_REF_LOADED 0x80000000U
+
+// Serializes changes to the wallet registry: index allocation, chunk allocation
+// and the name table. Looking up or referencing a wallet by index doesn't take it.
+__BOATSTATIC pthread_mutex_t g_boat_wallet_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+__BOATSTATIC BUINT32 WalletNameHash(const BCHAR *name_str)
+{
+    BUINT32 hash = 2166136261U;
+
+    while( *name_str != '\0' )
+    {
+        hash ^= (BUINT8)*name_str++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+
+/******************************************************************************
+@brief Get the wallet list entry of a wallet index
+
+Function: WalletEntry()
+
+    Chunks of the wallet list never move, and a chunk is published before the
+    list length covers it, so this function doesn't need the registry lock.
+
+@return
+    This function returns the entry, or NULL if the index is out of range.
+
+@param[in] wallet_index
+    The wallet index.
+
+*******************************************************************************/
+__BOATSTATIC BoatWalletList *WalletEntry(BSINT32 wallet_index)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BoatWalletList *chunk_ptr;
+
+    if(    wallet_index < 0
+        || (BUINT32)wallet_index >= __atomic_load_n(&context_ptr->wallet_list_len, __ATOMIC_ACQUIRE) )
+    {
+        return NULL;
+    }
+
+    chunk_ptr = __atomic_load_n(&context_ptr->wallet_chunk_list[wallet_index / context_ptr->wallet_chunk_len],
+                                __ATOMIC_ACQUIRE);
+
+    return &chunk_ptr[wallet_index % context_ptr->wallet_chunk_len];
+}
+
+
+/******************************************************************************
+@brief Find the name table slot of a persistent wallet
+
+Function: WalletNameFind()
+
+@return
+    This function returns the slot position if the name is found.\n
+    Otherwise it returns -1.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+*******************************************************************************/
+__BOATSTATIC BSINT32 WalletNameFind(const BCHAR *wallet_name_str)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BUINT32 mask = context_ptr->name_table_len - 1;
+    BUINT32 pos;
+    BSINT32 index;
+
+    if( context_ptr->name_table == NULL )
+    {
+        return -1;
+    }
+
+    // The table is never full, so an empty slot ends the probe
+    for( pos = WalletNameHash(wallet_name_str) & mask; ; pos = (pos + 1) & mask )
+    {
+        index = context_ptr->name_table[pos];
+        if( index == BOAT_WALLET_NAME_SLOT_EMPTY )
+        {
+            return -1;
+        }
+        if(    index >= 0
+            && strcmp(WalletEntry(index)->wallet_name_str, wallet_name_str) == 0 )
+        {
+            return pos;
+        }
+    }
+}
+
+
+/******************************************************************************
+@brief Resize the name table and drop removed marks
+
+Function: WalletNameTableRebuild()
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns BOAT_ERROR_OUT_OF_MEMORY.
+
+@param[in] table_len
+    New table length, a power of 2 larger than the number of names.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT WalletNameTableRebuild(BUINT32 table_len)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BSINT32 *table_ptr;
+    BUINT32 pos;
+    BUINT32 i;
+
+    table_ptr = BoatMalloc(table_len * sizeof(BSINT32));
+    if( table_ptr == NULL )
+    {
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    for( i = 0; i < table_len; i++ )
+    {
+        table_ptr[i] = BOAT_WALLET_NAME_SLOT_EMPTY;
+    }
+
+    context_ptr->name_used_num = 0;
+    for( i = 0; i < context_ptr->name_table_len; i++ )
+    {
+        if( context_ptr->name_table[i] >= 0 )
+        {
+            pos = WalletNameHash(WalletEntry(context_ptr->name_table[i])->wallet_name_str) & (table_len - 1);
+            while( table_ptr[pos] != BOAT_WALLET_NAME_SLOT_EMPTY )
+            {
+                pos = (pos + 1) & (table_len - 1);
+            }
+            table_ptr[pos] = context_ptr->name_table[i];
+            context_ptr->name_used_num++;
+        }
+    }
+
+    BoatFree(context_ptr->name_table);
+    context_ptr->name_table = table_ptr;
+    context_ptr->name_table_len = table_len;
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Map the name of a loaded persistent wallet to its index
+
+Function: WalletNameInsert()
+
+    If a wallet with the same name is already mapped, the name is mapped to
+    the new index. The caller must hold the registry lock.
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns BOAT_ERROR_OUT_OF_MEMORY.
+
+@param[in] wallet_index
+    Index of a wallet with a non-NULL name.
+
+*******************************************************************************/
+__BOATSTATIC BOAT_RESULT WalletNameInsert(BSINT32 wallet_index)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    const BCHAR *name_str = WalletEntry(wallet_index)->wallet_name_str;
+    BUINT32 table_len;
+    BUINT32 pos;
+    BSINT32 found_pos;
+
+    found_pos = WalletNameFind(name_str);
+    if( found_pos >= 0 )
+    {
+        context_ptr->name_table[found_pos] = wallet_index;
+        return BOAT_SUCCESS;
+    }
+
+    // Keep the load factor (removed marks included) below 3/4
+    if( (context_ptr->name_used_num + 1) * 4 > context_ptr->name_table_len * 3 )
+    {
+        for( table_len = 16; table_len < (context_ptr->wallet_num + 1) * 2; table_len *= 2 );
+
+        if( WalletNameTableRebuild(table_len) != BOAT_SUCCESS )
+        {
+            return BOAT_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    pos = WalletNameHash(name_str) & (context_ptr->name_table_len - 1);
+    while( context_ptr->name_table[pos] >= 0 )
+    {
+        pos = (pos + 1) & (context_ptr->name_table_len - 1);
+    }
+
+    if( context_ptr->name_table[pos] == BOAT_WALLET_NAME_SLOT_EMPTY )
+    {
+        context_ptr->name_used_num++;
+    }
+    context_ptr->name_table[pos] = wallet_index;
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief Unmap the name of a persistent wallet, if it's mapped to the given index
+
+Function: WalletNameRemove()
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_index
+    Index of a wallet with a non-NULL name.
+
+*******************************************************************************/
+__BOATSTATIC void WalletNameRemove(BSINT32 wallet_index)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BSINT32 found_pos;
+
+    found_pos = WalletNameFind(WalletEntry(wallet_index)->wallet_name_str);
+    if( found_pos >= 0 && context_ptr->name_table[found_pos] == wallet_index )
+    {
+        context_ptr->name_table[found_pos] = BOAT_WALLET_NAME_SLOT_REMOVED;
+    }
+}
+
+
+/******************************************************************************
+@brief Take a wallet index from the free list
+
+Function: WalletIndexAlloc()
+
+    A new chunk of the wallet list is allocated if no index is free, up to the
+    wallet capacity. Entries never move to another address.
+
+@return
+    This function returns a free wallet index, which is used but not loaded.\n
+    It returns -1 if the wallet capacity is reached or memory is exhausted.
+
+*******************************************************************************/
+__BOATSTATIC BSINT32 WalletIndexAlloc(void)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BoatWalletList *chunk_ptr;
+    BoatWalletList *entry_ptr;
+    BUINT32 list_len;
+    BUINT32 chunk_len;
+    BSINT32 index;
+    BUINT32 i;
+
+    pthread_mutex_lock(&g_boat_wallet_registry_lock);
+
+    list_len = context_ptr->wallet_list_len;
+
+    if( context_ptr->free_index < 0 && list_len < context_ptr->wallet_capacity )
+    {
+        chunk_len = BOAT_MIN(context_ptr->wallet_chunk_len, context_ptr->wallet_capacity - list_len);
+
+        chunk_ptr = BoatMalloc(chunk_len * sizeof(BoatWalletList));
+        if( chunk_ptr != NULL )
+        {
+            // Chain the new entries in ascending order
+            for( i = 0; i < chunk_len; i++ )
+            {
+                chunk_ptr[i].is_used = BOAT_FALSE;
+                chunk_ptr[i].protocol_type = BOAT_PROTOCOL_UNKNOWN;
+                chunk_ptr[i].wallet_name_str = NULL;
+                chunk_ptr[i].wallet_ptr = NULL;
+                chunk_ptr[i].next_free_index = (i + 1 < chunk_len) ? (BSINT32)(list_len + i + 1) : -1;
+                chunk_ptr[i].ref_state = 0;
+            }
+
+            context_ptr->free_index = list_len;
+            __atomic_store_n(&context_ptr->wallet_chunk_list[list_len / context_ptr->wallet_chunk_len],
+                             chunk_ptr, __ATOMIC_RELEASE);
+            __atomic_store_n(&context_ptr->wallet_list_len, list_len + chunk_len, __ATOMIC_RELEASE);
+        }
+    }
+
+    index = context_ptr->free_index;
+    if( index >= 0 )
+    {
+        entry_ptr = WalletEntry(index);
+        context_ptr->free_index = entry_ptr->next_free_index;
+        entry_ptr->is_used = BOAT_TRUE;
+        entry_ptr->wallet_ptr = NULL;
+        entry_ptr->wallet_name_str = NULL;
+        __atomic_store_n(&entry_ptr->ref_state, 0, __ATOMIC_RELAXED);
+        context_ptr->wallet_num++;
+    }
+
+    pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+
+    return index;
+}
+
+
+/******************************************************************************
+@brief Return a wallet index to the free list
+
+Function: WalletIndexFree()
+
+    The name of a persistent wallet is unmapped and freed.
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_index
+    A used wallet index, which is not loaded.
+
+*******************************************************************************/
+__BOATSTATIC void WalletIndexFree(BSINT32 wallet_index)
+{
+    BoatIotSdkContext *context_ptr = &g_boat_iot_sdk_context;
+    BoatWalletList *entry_ptr = WalletEntry(wallet_index);
+
+    pthread_mutex_lock(&g_boat_wallet_registry_lock);
+
+    if( entry_ptr->wallet_name_str != NULL )
+    {
+        WalletNameRemove(wallet_index);
+        BoatFree(entry_ptr->wallet_name_str);
+        entry_ptr->wallet_name_str = NULL;
+    }
+
+    entry_ptr->wallet_ptr = NULL;
+    entry_ptr->is_used = BOAT_FALSE;
+    entry_ptr->next_free_index = context_ptr->free_index;
+    context_ptr->free_index = wallet_index;
+    context_ptr->wallet_num--;
+
+    pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+}
+
+
+/******************************************************************************
+@brief Destroy a wallet
+
+Function: WalletDestroy()
+
+    This function de-initializes a wallet and frees its index. It's called by
+    whichever of BoatWalletUnload() and BoatWalletRelease() drops the last
+    reference to an unloaded wallet, so it runs exactly once per wallet.
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_index
+    The wallet index.
+
+*******************************************************************************/
+__BOATSTATIC void WalletDestroy(BSINT32 wallet_index)
+{
+    BoatWalletList *entry_ptr = WalletEntry(wallet_index);
+
+    switch(entry_ptr->protocol_type)
+    {
+
+    #if PROTOCOL_USE_ETHEREUM == 1
+        case BOAT_PROTOCOL_ETHEREUM:
+            BoatEthWalletDeInit(entry_ptr->wallet_ptr);
+        break;
+    #endif
+
+    #if PROTOCOL_USE_HLFABRIC == 1
+        case BOAT_PROTOCOL_HLFABRIC:
+            BoatHLFabricWalletDeInit(entry_ptr->wallet_ptr);
+        break;
+    #endif
+
+    #if PROTOCOL_USE_PLATONE == 1
+        case BOAT_PROTOCOL_PLATONE:
+            BoatPlatoneWalletDeInit(entry_ptr->wallet_ptr);
+        break;
+    #endif
+    
+        default:
+            BoatLog(BOAT_LOG_VERBOSE, "Unknown blockchain protocol type: %u.", entry_ptr->protocol_type);
+    }
+
+    WalletIndexFree(wallet_index);
+}
+
+
 /******************************************************************************
 @brief Initialize Boat IoT SDK
 
 Function: BoatIotSdkInit()
 
-    This function initialize global context of Boat IoT SDK.
+    This function initialize global context of Boat IoT SDK. Up to
+    BOAT_MAX_WALLET_NUM wallets can be loaded at the same time. To load more,
+    call BoatIotSdkInitWithCapacity() instead.
 
     BoatIotSdkInit() MUST be called before any use of BoAT IoT SDK per process.
     BoatIotSdkDeInit() MUST be called after use of BoAT IoT SDK.
     
 
-@see BoatIotSdkDeInit()
+@see BoatIotSdkDeInit() BoatIotSdkInitWithCapacity()
 
 @return
     This function returns BOAT_SUCCESS if initialization is successful.\n
@@ -63,24 +462,100 @@ Function: BoatIotSdkInit()
 *******************************************************************************/
 BOAT_RESULT BoatIotSdkInit(void)
 {
-    BUINT32 i;
+    return BoatIotSdkInitWithCapacity(BOAT_MAX_WALLET_NUM);
+}
+
+
+/******************************************************************************
+@brief Initialize Boat IoT SDK with a given wallet capacity
+
+Function: BoatIotSdkInitWithCapacity()
+
+    This function initialize global context of Boat IoT SDK, which can hold up
+    to <max_wallet_num> loaded wallets.
+
+    The wallet list and the name table are allocated when the first wallet is
+    created and grow on demand.
+
+    Wallets can be created, used and unloaded from any number of threads. See
+    BoatWalletAcquire() for sharing a wallet among threads.
+
+@see BoatIotSdkInit() BoatIotSdkDeInit()
+
+@return
+    This function returns BOAT_SUCCESS if initialization is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] max_wallet_num
+    Maximum number of loaded wallets, 1 ~ BOAT_MAX_WALLET_CAPACITY.
+*******************************************************************************/
+BOAT_RESULT BoatIotSdkInitWithCapacity(BUINT32 max_wallet_num)
+{
+    return BoatIotSdkInitWithAllocator(max_wallet_num, NULL);
+}
+
+
+// Allocator of cJSON, whose memory is accounted to BOAT_MEM_TAG_JSON
+__BOATSTATIC void *BoatJsonMalloc(size_t size)
+{
+    if( size > 0xFFFFFFFF )
+    {
+        return NULL;
+    }
+
+#if BOAT_MEM_ACCOUNTING == 1
+    return BoatMallocTagged((BUINT32)size, BOAT_MEM_TAG_JSON, BOAT_FALSE);
+#else
+    return BoatMalloc((BUINT32)size);
+#endif
+}
+
+
+/******************************************************************************
+@brief Initialize Boat IoT SDK with a given wallet capacity and allocator
+
+Function: BoatIotSdkInitWithAllocator()
+
+    This function sets the allocator of BoatMalloc() and initializes global
+    context of Boat IoT SDK, which can hold up to <max_wallet_num> loaded
+    wallets.
+
+@see BoatIotSdkInitWithCapacity() BoatSetAllocator()
+
+@return
+    This function returns BOAT_SUCCESS if initialization is successful.\n
+    Otherwise it returns one of the error codes.
+
+@param[in] max_wallet_num
+    Maximum number of loaded wallets, 1 ~ BOAT_MAX_WALLET_CAPACITY.
+
+@param[in] allocator_ptr
+    The allocator, or NULL for the default allocator.
+*******************************************************************************/
+BOAT_RESULT BoatIotSdkInitWithAllocator(BUINT32 max_wallet_num, const BoatAllocator *allocator_ptr)
+{
     cJSON_Hooks hooks;
     
 #if RPC_USE_LIBCURL == 1
     CURLcode curl_result;
 #endif
 
-    hooks.malloc_fn = BoatMalloc;
+    if( max_wallet_num == 0 || max_wallet_num > BOAT_MAX_WALLET_CAPACITY )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Invalid wallet capacity: %u.", max_wallet_num);
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    BoatSetAllocator(allocator_ptr);
+
+    hooks.malloc_fn = BoatJsonMalloc;
     hooks.free_fn = BoatFree;
     cJSON_InitHooks(&hooks);
 
-// For Multi-Thread Support: CreateMutex Here
-
-    for( i = 0; i < BOAT_MAX_WALLET_NUM; i++ )
-    {
-        g_boat_iot_sdk_context.wallet_list[i].is_used = BOAT_FALSE;
-        g_boat_iot_sdk_context.wallet_list[i].wallet_ptr = NULL;
-    }
+    memset(&g_boat_iot_sdk_context, 0x00, sizeof(g_boat_iot_sdk_context));
+    g_boat_iot_sdk_context.wallet_capacity = max_wallet_num;
+    g_boat_iot_sdk_context.wallet_chunk_len = BOAT_MIN(max_wallet_num, BOAT_WALLET_CHUNK_LEN);
+    g_boat_iot_sdk_context.free_index = -1;
     
 #if RPC_USE_LIBCURL == 1
     curl_result = curl_global_init(CURL_GLOBAL_DEFAULT);
@@ -92,7 +567,11 @@ BOAT_RESULT BoatIotSdkInit(void)
     }
 #endif
 
-
+    if( BoatWalletCacheInit() != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_CRITICAL, "Unable to initialize wallet cache.");
+        return BOAT_ERROR;
+    }
     
     return BOAT_SUCCESS;
 
@@ -104,7 +583,9 @@ BOAT_RESULT BoatIotSdkInit(void)
 
 Function: BoatIotSdkDeInit()
 
-    This function de-initialize context of BoAT IoT SDK.
+    This function de-initialize context of BoAT IoT SDK. All wallets are
+    unloaded. No other thread may use the SDK at the same time, and all
+    references taken by BoatWalletAcquire() MUST have been released.
 
     BoatIotSdkInit() MUST be called before any use of BoAT IoT SDK per process.
     BoatIotSdkDeInit() MUST be called after use of BoAT IoT SDK.
@@ -121,19 +602,29 @@ void BoatIotSdkDeInit(void)
     BUINT32 i;
     
 
-    for( i = 0; i < BOAT_MAX_WALLET_NUM; i++ )
+    for( i = 0; i < g_boat_iot_sdk_context.wallet_list_len; i++ )
     {
         BoatWalletUnload(i);
     }
 
-        
+    for( i = 0; i < sizeof(g_boat_iot_sdk_context.wallet_chunk_list) / sizeof(g_boat_iot_sdk_context.wallet_chunk_list[0]); i++ )
+    {
+        BoatFree(g_boat_iot_sdk_context.wallet_chunk_list[i]);
+    }
+    BoatFree(g_boat_iot_sdk_context.name_table);
+    memset(&g_boat_iot_sdk_context, 0x00, sizeof(g_boat_iot_sdk_context));
+    g_boat_iot_sdk_context.free_index = -1;
+
+    web3_thread_context_release();
+    RpcCleanup();
+    BoatTxArenaRelease();
+
+    BoatWalletCacheDeInit();
 
 #if RPC_USE_LIBCURL == 1
     curl_global_cleanup();
 #endif
 
-// For Multi-Thread Support: DeleteMutex Here
-
     return;
 }
 
@@ -203,7 +694,12 @@ Function: BoatWalletCreate()
 BSINT32 BoatWalletCreate(BoatProtocolType protocol_type, const BCHAR *wallet_name_str, const void * wallet_config_ptr, BUINT32 wallet_config_size)
 {
     BSINT32 i;
+    BoatWalletList *entry_ptr;
+    BCHAR *name_copy_str;
     BUINT8 loaded_wallet_config_array[wallet_config_size];
+    BUINT8 cached_pub_key_array[64];
+    BBOOL has_cached_pub_key = BOAT_FALSE;
+    const BUINT8 *pub_key_ptr = NULL;
 
 
     // Check wallet configuration
@@ -213,22 +709,16 @@ BSINT32 BoatWalletCreate(BoatProtocolType protocol_type, const BCHAR *wallet_nam
         return -1;
     }
 
-    // For Multi-Thread Support: ObtainMutex Here
-    for( i = 0; i < BOAT_MAX_WALLET_NUM; i++ )
-    {
-        if( g_boat_iot_sdk_context.wallet_list[i].is_used == BOAT_FALSE )
-        {
-            g_boat_iot_sdk_context.wallet_list[i].is_used = BOAT_TRUE;
-            break;
-        }
-    }
-    // For Multi-Thread Support: ReleaseMutex Here
+    // The index is used but not loaded until the wallet is initialized, which
+    // is done without the registry lock
+    i = WalletIndexAlloc();
 
-    if( i >= BOAT_MAX_WALLET_NUM )
+    if( i < 0 )
     {
         BoatLog(BOAT_LOG_NORMAL, "Too many wallets was loaded.");
         return -1;
     }
+    entry_ptr = WalletEntry(i);
 
     if( wallet_name_str != NULL )
     {
@@ -237,16 +727,28 @@ BSINT32 BoatWalletCreate(BoatProtocolType protocol_type, const BCHAR *wallet_nam
             // Create persistent wallet / Overwrite existed configuration
             if( BOAT_SUCCESS != BoatPersistStore(wallet_name_str, wallet_config_ptr, wallet_config_size) )
             {
+                WalletIndexFree(i);
                 return -1;
             }
             
             memcpy(loaded_wallet_config_array, wallet_config_ptr, wallet_config_size);
         }
+        else if( BOAT_SUCCESS == BoatWalletCacheGet(wallet_name_str, protocol_type,
+                                                    loaded_wallet_config_array, wallet_config_size,
+                                                    cached_pub_key_array, &has_cached_pub_key) )
+        {
+            // Load cached persistent wallet, which needs neither storage access nor key derivation
+            if( has_cached_pub_key == BOAT_TRUE )
+            {
+                pub_key_ptr = cached_pub_key_array;
+            }
+        }
         else
         {
             // Load persistent wallet;
             if( BOAT_SUCCESS != BoatPersistRead(wallet_name_str, loaded_wallet_config_array, wallet_config_size) )
             {
+                WalletIndexFree(i);
                 return -1;
             }
         }
@@ -257,44 +759,80 @@ BSINT32 BoatWalletCreate(BoatProtocolType protocol_type, const BCHAR *wallet_nam
     }
 
     // Check protocol type
-    g_boat_iot_sdk_context.wallet_list[i].protocol_type = protocol_type;
+    entry_ptr->protocol_type = protocol_type;
     
     switch(protocol_type)
     {
 
     #if PROTOCOL_USE_ETHEREUM == 1
         case BOAT_PROTOCOL_ETHEREUM:
-            g_boat_iot_sdk_context.wallet_list[i].wallet_ptr = BoatEthWalletInit((BoatEthWalletConfig*)loaded_wallet_config_array, wallet_config_size);
+            entry_ptr->wallet_ptr = EthWalletInitWithPubkey((BoatEthWalletConfig*)loaded_wallet_config_array, wallet_config_size, pub_key_ptr);
         break;
     #endif
 
     #if PROTOCOL_USE_HLFABRIC == 1
         case BOAT_PROTOCOL_HLFABRIC:
-            g_boat_iot_sdk_context.wallet_list[i].wallet_ptr  = BoatHLFabricWalletInit((BoatHLFabricWalletConfig*)loaded_wallet_config_array, wallet_config_size);
+            entry_ptr->wallet_ptr  = BoatHLFabricWalletInit((BoatHLFabricWalletConfig*)loaded_wallet_config_array, wallet_config_size);
         break;
     #endif
 
     #if PROTOCOL_USE_PLATONE == 1
         case BOAT_PROTOCOL_PLATONE:
-            g_boat_iot_sdk_context.wallet_list[i].wallet_ptr  = BoatPlatoneWalletInit((BoatPlatoneWalletConfig*)loaded_wallet_config_array, wallet_config_size);
+            // A PlatONE wallet is an Ethereum wallet (see BoatPlatoneWalletInit())
+            entry_ptr->wallet_ptr  = EthWalletInitWithPubkey((BoatPlatoneWalletConfig*)loaded_wallet_config_array, wallet_config_size, pub_key_ptr);
         break;
     #endif
     
         default:
-        g_boat_iot_sdk_context.wallet_list[i].wallet_ptr = NULL;
+        entry_ptr->wallet_ptr = NULL;
         
     }
 
-    if( g_boat_iot_sdk_context.wallet_list[i].wallet_ptr == NULL )
+    if( entry_ptr->wallet_ptr == NULL )
     {
         BoatLog(BOAT_LOG_NORMAL, "Fail to create wallet: protocol type: %d.", (BSINT32)protocol_type);
-        g_boat_iot_sdk_context.wallet_list[i].is_used = BOAT_FALSE;
+        WalletIndexFree(i);
 
+        memzero(loaded_wallet_config_array, wallet_config_size);
         return -1;
     }
 
-    
+    // Keep the decrypted configuration of a persistent wallet for the next load
+    if( wallet_name_str != NULL )
+    {
+        pub_key_ptr = NULL;
+        
+    #if PROTOCOL_USE_ETHEREUM == 1 || PROTOCOL_USE_PLATONE == 1
+        if(    protocol_type == BOAT_PROTOCOL_ETHEREUM
+            || protocol_type == BOAT_PROTOCOL_PLATONE )
+        {
+            pub_key_ptr = ((BoatEthWallet *)entry_ptr->wallet_ptr)->account_info.pub_key_array;
+        }
+    #endif
+
+        BoatWalletCachePut(wallet_name_str, protocol_type, loaded_wallet_config_array, wallet_config_size, pub_key_ptr);
+
+        // A wallet that cannot be found by name is still usable by index
+        name_copy_str = BoatMalloc(strlen(wallet_name_str) + 1);
+        if( name_copy_str != NULL )
+        {
+            strcpy(name_copy_str, wallet_name_str);
+
+            pthread_mutex_lock(&g_boat_wallet_registry_lock);
+            entry_ptr->wallet_name_str = name_copy_str;
+            if( WalletNameInsert(i) != BOAT_SUCCESS )
+            {
+                BoatFree(entry_ptr->wallet_name_str);
+                entry_ptr->wallet_name_str = NULL;
+            }
+            pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+        }
+    }
 
+    memzero(loaded_wallet_config_array, wallet_config_size);
+
+    // Publish the wallet to BoatGetWalletByIndex() and BoatWalletAcquire()
+    __atomic_store_n(&entry_ptr->ref_state, BOAT_WALLET_REF_LOADED, __ATOMIC_RELEASE);
     
     return i;
 
@@ -311,8 +849,11 @@ Function: BoatWalletUnload()
     delete it from non-volatile memory. To delete a persistent wallet from
     non-volatile memory, call BoatWalletDelete().
 
+    If the wallet is referenced by BoatWalletAcquire(), it's no longer found by
+    index or name, but it's de-initialized by the last BoatWalletRelease().
+
 
-@see BoatWalletCreate() BoatWalletDelete()
+@see BoatWalletCreate() BoatWalletDelete() BoatWalletRelease()
 
 @return This function doesn't return any thing.
 
@@ -322,51 +863,122 @@ Function: BoatWalletUnload()
 *******************************************************************************/
 void BoatWalletUnload(BSINT32 wallet_index)
 {
-    BoatProtocolType protocol;
-
+    BoatWalletList *entry_ptr;
+    BUINT32 ref_state;
 
-    if( wallet_index >= 0 && wallet_index < BOAT_MAX_WALLET_NUM
-        && g_boat_iot_sdk_context.wallet_list[wallet_index].is_used != BOAT_FALSE
-        && g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr != NULL )
+    entry_ptr = WalletEntry(wallet_index);
+    if( entry_ptr == NULL )
     {
-        protocol = g_boat_iot_sdk_context.wallet_list[wallet_index].protocol_type;
+        return;
+    }
 
-        switch(protocol)
+    // Only one caller can clear the loaded flag
+    ref_state = __atomic_load_n(&entry_ptr->ref_state, __ATOMIC_ACQUIRE);
+    do
+    {
+        if( (ref_state & BOAT_WALLET_REF_LOADED) == 0 )
         {
-
-        #if PROTOCOL_USE_ETHEREUM == 1
-            case BOAT_PROTOCOL_ETHEREUM:
-                BoatEthWalletDeInit(g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr);
-            break;
-        #endif
-
-        #if PROTOCOL_USE_HLFABRIC == 1
-            case BOAT_PROTOCOL_HLFABRIC:
-                BoatHLFabricWalletDeInit(g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr);
-            break;
-        #endif
-
-        #if PROTOCOL_USE_PLATONE == 1
-            case BOAT_PROTOCOL_PLATONE:
-                BoatPlatoneWalletDeInit(g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr);
-            break;
-        #endif
-        
-            default:
-                BoatLog(BOAT_LOG_VERBOSE, "Unknown blockchain protocol type: %u.", protocol);
-                protocol = BOAT_PROTOCOL_UNKNOWN;
-            
+            return;
         }
+    }while( !__atomic_compare_exchange_n(&entry_ptr->ref_state, &ref_state, ref_state & ~BOAT_WALLET_REF_LOADED,
+                                         BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) );
+
+    // The wallet can no longer be found by name, even if it's still referenced
+    pthread_mutex_lock(&g_boat_wallet_registry_lock);
+    if( entry_ptr->wallet_name_str != NULL )
+    {
+        WalletNameRemove(wallet_index);
+    }
+    pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+
+    if( ref_state == BOAT_WALLET_REF_LOADED )
+    {
+        WalletDestroy(wallet_index);
+    }
 
-        if( protocol != BOAT_PROTOCOL_UNKNOWN )
+    return;
+}
+
+
+/******************************************************************************
+@brief Take a reference to a loaded wallet
+
+Function: BoatWalletAcquire()
+
+    This function returns the wallet context like BoatGetWalletByIndex() and
+    takes a reference to it. A referenced wallet is not de-initialized until
+    the reference is released by BoatWalletRelease(), even if it's unloaded by
+    BoatWalletUnload() meanwhile.
+
+    A thread that uses a wallet which another thread may unload MUST hold a
+    reference while using it.
+
+@see BoatWalletRelease() BoatWalletUnload()
+
+@return
+    This function returns a pointer to the wallet context.\n
+    It returns NULL if the wallet is not loaded, and no reference is taken.
+
+@param[in] wallet_index
+    The wallet index.
+
+*******************************************************************************/
+void * BoatWalletAcquire(BSINT32 wallet_index)
+{
+    BoatWalletList *entry_ptr;
+    BUINT32 ref_state;
+
+    entry_ptr = WalletEntry(wallet_index);
+    if( entry_ptr == NULL )
+    {
+        return NULL;
+    }
+
+    ref_state = __atomic_load_n(&entry_ptr->ref_state, __ATOMIC_ACQUIRE);
+    do
+    {
+        if( (ref_state & BOAT_WALLET_REF_LOADED) == 0 )
         {
-            g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr = NULL;
-            g_boat_iot_sdk_context.wallet_list[wallet_index].is_used = BOAT_FALSE;
+            return NULL;
         }
+    }while( !__atomic_compare_exchange_n(&entry_ptr->ref_state, &ref_state, ref_state + 1,
+                                         BOAT_FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) );
+
+    return entry_ptr->wallet_ptr;
+}
+
+
+/******************************************************************************
+@brief Release a reference to a wallet
+
+Function: BoatWalletRelease()
+
+    This function releases a reference taken by BoatWalletAcquire(). If the
+    wallet has been unloaded and this is the last reference, the wallet is
+    de-initialized.
+
+@see BoatWalletAcquire()
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_index
+    The wallet index passed to BoatWalletAcquire().
+
+*******************************************************************************/
+void BoatWalletRelease(BSINT32 wallet_index)
+{
+    BoatWalletList *entry_ptr;
+
+    entry_ptr = WalletEntry(wallet_index);
+    if( entry_ptr == NULL )
+    {
+        return;
     }
-    
 
-    return;
+    if( __atomic_sub_fetch(&entry_ptr->ref_state, 1, __ATOMIC_ACQ_REL) == 0 )
+    {
+        WalletDestroy(wallet_index);
+    }
 }
 
 
@@ -390,7 +1002,22 @@ Function: BoatWalletDelete()
 *******************************************************************************/
 void BoatWalletDelete(BCHAR * wallet_name_str)
 {
+    BSINT32 pos;
+    BSINT32 index;
+    
+    // The loaded wallets of this name become one-time wallets
+    pthread_mutex_lock(&g_boat_wallet_registry_lock);
+    while( (pos = WalletNameFind(wallet_name_str)) >= 0 )
+    {
+        index = g_boat_iot_sdk_context.name_table[pos];
+        WalletNameRemove(index);
+        BoatFree(WalletEntry(index)->wallet_name_str);
+        WalletEntry(index)->wallet_name_str = NULL;
+    }
+    pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+
     // Delete persistent wallet
+    BoatWalletCacheEvict(wallet_name_str);
     BoatPersistDelete(wallet_name_str);
     return;
 }
@@ -412,14 +1039,14 @@ Function: BoatGetWalletByIndex()
 *******************************************************************************/
 void * BoatGetWalletByIndex(BSINT32 wallet_index)
 {
+    BoatWalletList *entry_ptr;
+
+    entry_ptr = WalletEntry(wallet_index);
 
-    if( wallet_index >= 0 && wallet_index < BOAT_MAX_WALLET_NUM )
+    if(    entry_ptr != NULL
+        && (__atomic_load_n(&entry_ptr->ref_state, __ATOMIC_ACQUIRE) & BOAT_WALLET_REF_LOADED) != 0 )
     {
-        if(    g_boat_iot_sdk_context.wallet_list[wallet_index].is_used != BOAT_FALSE
-            && g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr != NULL )
-        {
-            return(g_boat_iot_sdk_context.wallet_list[wallet_index].wallet_ptr);
-        }
+        return(entry_ptr->wallet_ptr);
     }
 
     return NULL;
@@ -427,3 +1054,38 @@ void * BoatGetWalletByIndex(BSINT32 wallet_index)
 }
 
 
+/******************************************************************************
+@brief Get the index of a loaded persistent wallet by name.
+
+Function: BoatGetWalletIndexByName()
+
+    This function gets the index of a loaded persistent wallet. If the wallet
+    is loaded more than once, the index of the last loaded one is returned.
+
+
+@return
+    This function returns the non-negative index of the wallet.\n
+    It returns -1 if no persistent wallet with the given name is loaded.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+*******************************************************************************/
+BSINT32 BoatGetWalletIndexByName(const BCHAR *wallet_name_str)
+{
+    BSINT32 pos;
+    BSINT32 index;
+
+    if( wallet_name_str == NULL )
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_boat_wallet_registry_lock);
+    pos = WalletNameFind(wallet_name_str);
+    index = (pos >= 0) ? g_boat_iot_sdk_context.name_table[pos] : -1;
+    pthread_mutex_unlock(&g_boat_wallet_registry_lock);
+
+    return index;
+}
+
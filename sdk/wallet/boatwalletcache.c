@@ -0,0 +1,651 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+/*!@brief Cache of decrypted persistent wallet configurations
+
+@file
+boatwalletcache.c contains the wallet cache. See boatwalletcache.h.
+*/
+
+// posix_memalign() and mlock() are POSIX
+#define _POSIX_C_SOURCE 200809L
+
+#define BOAT_MEM_TAG BOAT_MEM_TAG_WALLET
+
+#include "boatinternal.h"
+#include "boatwalletcache.h"
+#include "memzero.h"
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#if BOAT_WALLET_CACHE_SIZE > 0
+
+#define BOAT_WALLET_CACHE_NIL (-1)
+
+#if BOAT_USE_STATIC_POOL == 1
+// No heap in static pool mode: the configurations are kept in a static area,
+// aligned to the common page size of 4 KiB
+#define BOAT_WALLET_CACHE_STATIC_AREA_SIZE BOAT_ROUNDUP(BOAT_WALLET_CACHE_SIZE * BOAT_WALLET_CACHE_MAX_CONFIG_SIZE, 4096)
+__BOATSTATIC BUINT8 g_boat_wallet_cache_static_area[BOAT_WALLET_CACHE_STATIC_AREA_SIZE] __attribute__((aligned(4096)));
+#endif
+
+typedef struct TBoatWalletCacheEntry
+{
+    BCHAR *wallet_name_str;          //!< NULL if the entry is free
+    BUINT64 name_hash;
+    BoatProtocolType protocol_type;
+    BUINT32 wallet_config_size;
+    BBOOL has_pub_key;
+    BUINT8 pub_key_array[64];
+
+    BSINT32 lru_prev;                //!< Towards the most recently used entry
+    BSINT32 lru_next;                //!< Towards the least recently used entry, or the next free entry
+    BSINT32 bucket_next;             //!< Next entry in the same hash bucket
+}BoatWalletCacheEntry;
+
+typedef struct TBoatWalletCache
+{
+    pthread_mutex_t lock;
+    BUINT32 bucket_num;              //!< Power of 2, 0 if the cache isn't initialized
+    BoatWalletCacheEntry *entry_array;
+    BSINT32 *bucket_array;
+
+    // Configurations, BOAT_WALLET_CACHE_MAX_CONFIG_SIZE bytes per entry, in locked memory
+    BUINT8 *config_area_ptr;
+    size_t config_area_len;
+    BBOOL is_locked;
+
+    BSINT32 lru_head;
+    BSINT32 lru_tail;
+    BSINT32 free_head;
+}BoatWalletCache;
+
+__BOATSTATIC BoatWalletCache g_boat_wallet_cache = { PTHREAD_MUTEX_INITIALIZER, 0, NULL, NULL, NULL, 0, BOAT_FALSE, 0, 0, 0 };
+
+
+__BOATSTATIC BUINT64 WalletCacheNameHash(const BCHAR *name_str)
+{
+    BUINT64 hash = 0xcbf29ce484222325ULL;
+
+    while( *name_str != '\0' )
+    {
+        hash ^= (BUINT8)*name_str++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+__BOATSTATIC BUINT8 *WalletCacheConfig(BSINT32 index)
+{
+    return g_boat_wallet_cache.config_area_ptr + (size_t)index * BOAT_WALLET_CACHE_MAX_CONFIG_SIZE;
+}
+
+
+__BOATSTATIC BSINT32 WalletCacheFind(const BCHAR *wallet_name_str, BUINT64 name_hash)
+{
+    BSINT32 index;
+
+    index = g_boat_wallet_cache.bucket_array[name_hash & (g_boat_wallet_cache.bucket_num - 1)];
+
+    while( index != BOAT_WALLET_CACHE_NIL )
+    {
+        if(    g_boat_wallet_cache.entry_array[index].name_hash == name_hash
+            && strcmp(g_boat_wallet_cache.entry_array[index].wallet_name_str, wallet_name_str) == 0 )
+        {
+            break;
+        }
+        index = g_boat_wallet_cache.entry_array[index].bucket_next;
+    }
+
+    return index;
+}
+
+
+__BOATSTATIC void WalletCacheLruUnlink(BSINT32 index)
+{
+    BoatWalletCacheEntry *entry_ptr = &g_boat_wallet_cache.entry_array[index];
+
+    if( entry_ptr->lru_prev != BOAT_WALLET_CACHE_NIL )
+    {
+        g_boat_wallet_cache.entry_array[entry_ptr->lru_prev].lru_next = entry_ptr->lru_next;
+    }
+    else
+    {
+        g_boat_wallet_cache.lru_head = entry_ptr->lru_next;
+    }
+
+    if( entry_ptr->lru_next != BOAT_WALLET_CACHE_NIL )
+    {
+        g_boat_wallet_cache.entry_array[entry_ptr->lru_next].lru_prev = entry_ptr->lru_prev;
+    }
+    else
+    {
+        g_boat_wallet_cache.lru_tail = entry_ptr->lru_prev;
+    }
+}
+
+
+__BOATSTATIC void WalletCacheLruPushFront(BSINT32 index)
+{
+    BoatWalletCacheEntry *entry_ptr = &g_boat_wallet_cache.entry_array[index];
+
+    entry_ptr->lru_prev = BOAT_WALLET_CACHE_NIL;
+    entry_ptr->lru_next = g_boat_wallet_cache.lru_head;
+
+    if( g_boat_wallet_cache.lru_head != BOAT_WALLET_CACHE_NIL )
+    {
+        g_boat_wallet_cache.entry_array[g_boat_wallet_cache.lru_head].lru_prev = index;
+    }
+    else
+    {
+        g_boat_wallet_cache.lru_tail = index;
+    }
+    g_boat_wallet_cache.lru_head = index;
+}
+
+
+/******************************************************************************
+@brief Wipe an entry and return it to the free list
+
+Function: WalletCacheRemove()
+
+    The caller must hold the cache lock.
+
+*******************************************************************************/
+__BOATSTATIC void WalletCacheRemove(BSINT32 index)
+{
+    BoatWalletCacheEntry *entry_ptr = &g_boat_wallet_cache.entry_array[index];
+    BSINT32 *link_ptr;
+
+    // Unlink from the hash bucket
+    link_ptr = &g_boat_wallet_cache.bucket_array[entry_ptr->name_hash & (g_boat_wallet_cache.bucket_num - 1)];
+    while( *link_ptr != index )
+    {
+        link_ptr = &g_boat_wallet_cache.entry_array[*link_ptr].bucket_next;
+    }
+    *link_ptr = entry_ptr->bucket_next;
+
+    WalletCacheLruUnlink(index);
+
+    memzero(WalletCacheConfig(index), BOAT_WALLET_CACHE_MAX_CONFIG_SIZE);
+    BoatFree(entry_ptr->wallet_name_str);
+    memset(entry_ptr, 0x00, sizeof(BoatWalletCacheEntry));
+
+    entry_ptr->lru_next = g_boat_wallet_cache.free_head;
+    g_boat_wallet_cache.free_head = index;
+}
+
+
+/******************************************************************************
+@brief Initialize the wallet cache
+
+Function: BoatWalletCacheInit()
+
+    This function allocates BOAT_WALLET_CACHE_SIZE entries. The configuration
+    area is page aligned and locked with mlock(). If locking fails (typically
+    RLIMIT_MEMLOCK is too low), the cache still works but its memory may be
+    swapped out.
+
+    It's called by BoatIotSdkInit().
+
+@return
+    This function returns BOAT_SUCCESS if successful.\n
+    Otherwise it returns one of the error codes.
+
+*******************************************************************************/
+BOAT_RESULT BoatWalletCacheInit(void)
+{
+    BoatWalletCache *cache_ptr = &g_boat_wallet_cache;
+    void *area_ptr = NULL;
+    long page_size;
+    BUINT32 bucket_num;
+    BSINT32 i;
+
+    pthread_mutex_lock(&cache_ptr->lock);
+
+    if( cache_ptr->bucket_num != 0 )
+    {
+        pthread_mutex_unlock(&cache_ptr->lock);
+        return BOAT_SUCCESS;
+    }
+
+    for( bucket_num = 1; bucket_num < BOAT_WALLET_CACHE_SIZE * 2; bucket_num *= 2 );
+
+#if BOAT_USE_STATIC_POOL == 1
+    (void)page_size;
+    area_ptr = g_boat_wallet_cache_static_area;
+    cache_ptr->config_area_len = BOAT_WALLET_CACHE_STATIC_AREA_SIZE;
+#else
+    page_size = sysconf(_SC_PAGESIZE);
+    if( page_size <= 0 )
+    {
+        page_size = 4096;
+    }
+    cache_ptr->config_area_len = ((size_t)BOAT_WALLET_CACHE_SIZE * BOAT_WALLET_CACHE_MAX_CONFIG_SIZE + page_size - 1)
+                                 / page_size * page_size;
+
+    // Page aligned, so that no other data shares the locked pages
+    if( posix_memalign(&area_ptr, page_size, cache_ptr->config_area_len) != 0 )
+    {
+        area_ptr = NULL;
+    }
+#endif
+
+    cache_ptr->entry_array = BoatMalloc(BOAT_WALLET_CACHE_SIZE * sizeof(BoatWalletCacheEntry));
+    cache_ptr->bucket_array = BoatMalloc(bucket_num * sizeof(BSINT32));
+
+    if(    cache_ptr->entry_array == NULL
+        || cache_ptr->bucket_array == NULL
+        || area_ptr == NULL )
+    {
+#if BOAT_USE_STATIC_POOL != 1
+        free(area_ptr);
+#endif
+        BoatFree(cache_ptr->entry_array);
+        BoatFree(cache_ptr->bucket_array);
+        cache_ptr->entry_array = NULL;
+        cache_ptr->bucket_array = NULL;
+        pthread_mutex_unlock(&cache_ptr->lock);
+        return BOAT_ERROR_OUT_OF_MEMORY;
+    }
+
+    cache_ptr->config_area_ptr = area_ptr;
+    memset(cache_ptr->config_area_ptr, 0x00, cache_ptr->config_area_len);
+
+    cache_ptr->is_locked = (mlock(cache_ptr->config_area_ptr, cache_ptr->config_area_len) == 0);
+    if( cache_ptr->is_locked != BOAT_TRUE )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Fail to lock wallet cache memory, it may be swapped out.");
+    }
+
+    memset(cache_ptr->entry_array, 0x00, BOAT_WALLET_CACHE_SIZE * sizeof(BoatWalletCacheEntry));
+    for( i = 0; i < BOAT_WALLET_CACHE_SIZE; i++ )
+    {
+        cache_ptr->entry_array[i].lru_next = (i + 1 < BOAT_WALLET_CACHE_SIZE) ? i + 1 : BOAT_WALLET_CACHE_NIL;
+    }
+    for( i = 0; i < (BSINT32)bucket_num; i++ )
+    {
+        cache_ptr->bucket_array[i] = BOAT_WALLET_CACHE_NIL;
+    }
+
+    cache_ptr->free_head = 0;
+    cache_ptr->lru_head = BOAT_WALLET_CACHE_NIL;
+    cache_ptr->lru_tail = BOAT_WALLET_CACHE_NIL;
+    cache_ptr->bucket_num = bucket_num;
+
+    pthread_mutex_unlock(&cache_ptr->lock);
+
+    return BOAT_SUCCESS;
+}
+
+
+/******************************************************************************
+@brief De-initialize the wallet cache
+
+Function: BoatWalletCacheDeInit()
+
+    This function wipes all entries and frees the cache.
+
+    It's called by BoatIotSdkDeInit().
+
+@return This function doesn't return any thing.
+
+*******************************************************************************/
+void BoatWalletCacheDeInit(void)
+{
+    BoatWalletCache *cache_ptr = &g_boat_wallet_cache;
+
+    BoatWalletCacheClear();
+
+    pthread_mutex_lock(&cache_ptr->lock);
+
+    if( cache_ptr->bucket_num != 0 )
+    {
+        memzero(cache_ptr->config_area_ptr, cache_ptr->config_area_len);
+        if( cache_ptr->is_locked == BOAT_TRUE )
+        {
+            munlock(cache_ptr->config_area_ptr, cache_ptr->config_area_len);
+        }
+
+#if BOAT_USE_STATIC_POOL != 1
+        // Allocated by posix_memalign()
+        free(cache_ptr->config_area_ptr);
+#endif
+        BoatFree(cache_ptr->entry_array);
+        BoatFree(cache_ptr->bucket_array);
+
+        cache_ptr->config_area_ptr = NULL;
+        cache_ptr->entry_array = NULL;
+        cache_ptr->bucket_array = NULL;
+        cache_ptr->is_locked = BOAT_FALSE;
+        cache_ptr->bucket_num = 0;
+    }
+
+    pthread_mutex_unlock(&cache_ptr->lock);
+}
+
+
+/******************************************************************************
+@brief Look up a wallet in the cache
+
+Function: BoatWalletCacheGet()
+
+    This function copies the cached configuration of a wallet and marks it as
+    most recently used.
+
+@return
+    This function returns BOAT_SUCCESS if the wallet is cached with the same
+    protocol type and configuration size.\n
+    Otherwise it returns BOAT_ERROR.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+@param[in] protocol_type
+    The protocol type of the wallet.
+
+@param[out] wallet_config_ptr
+    Buffer to hold the configuration.
+
+@param[in] wallet_config_size
+    Size (in byte) of the configuration.
+
+@param[out] pub_key_array
+    Public key of the wallet account, if <*has_pub_key_ptr> is BOAT_TRUE.
+
+@param[out] has_pub_key_ptr
+    Whether the public key is cached.
+
+*******************************************************************************/
+BOAT_RESULT BoatWalletCacheGet(const BCHAR *wallet_name_str,
+                               BoatProtocolType protocol_type,
+                               BOAT_OUT void *wallet_config_ptr,
+                               BUINT32 wallet_config_size,
+                               BOAT_OUT BUINT8 pub_key_array[64],
+                               BOAT_OUT BBOOL *has_pub_key_ptr)
+{
+    BoatWalletCacheEntry *entry_ptr;
+    BSINT32 index;
+    BOAT_RESULT result = BOAT_ERROR;
+
+    if( wallet_name_str == NULL || wallet_config_ptr == NULL || pub_key_array == NULL || has_pub_key_ptr == NULL )
+    {
+        return BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    pthread_mutex_lock(&g_boat_wallet_cache.lock);
+
+    if( g_boat_wallet_cache.bucket_num != 0 )
+    {
+        index = WalletCacheFind(wallet_name_str, WalletCacheNameHash(wallet_name_str));
+        if( index != BOAT_WALLET_CACHE_NIL )
+        {
+            entry_ptr = &g_boat_wallet_cache.entry_array[index];
+
+            if(    entry_ptr->protocol_type == protocol_type
+                && entry_ptr->wallet_config_size == wallet_config_size )
+            {
+                memcpy(wallet_config_ptr, WalletCacheConfig(index), wallet_config_size);
+                memcpy(pub_key_array, entry_ptr->pub_key_array, 64);
+                *has_pub_key_ptr = entry_ptr->has_pub_key;
+
+                WalletCacheLruUnlink(index);
+                WalletCacheLruPushFront(index);
+
+                result = BOAT_SUCCESS;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+
+    return result;
+}
+
+
+/******************************************************************************
+@brief Put a wallet into the cache
+
+Function: BoatWalletCachePut()
+
+    This function caches or updates the configuration of a wallet and marks it
+    as most recently used. If the cache is full, the least recently used
+    wallet is evicted.
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+@param[in] protocol_type
+    The protocol type of the wallet.
+
+@param[in] wallet_config_ptr
+    The decrypted configuration.
+
+@param[in] wallet_config_size
+    Size (in byte) of the configuration.\n
+    Configurations larger than BOAT_WALLET_CACHE_MAX_CONFIG_SIZE are not cached.
+
+@param[in] pub_key_ptr
+    64-byte public key of the wallet account, or NULL if not applicable.
+
+*******************************************************************************/
+void BoatWalletCachePut(const BCHAR *wallet_name_str,
+                        BoatProtocolType protocol_type,
+                        const void *wallet_config_ptr,
+                        BUINT32 wallet_config_size,
+                        const BUINT8 *pub_key_ptr)
+{
+    BoatWalletCacheEntry *entry_ptr;
+    BUINT64 name_hash;
+    BCHAR *name_copy_str;
+    size_t name_len;
+    BSINT32 index;
+
+    if(    wallet_name_str == NULL
+        || wallet_config_ptr == NULL
+        || wallet_config_size > BOAT_WALLET_CACHE_MAX_CONFIG_SIZE )
+    {
+        return;
+    }
+
+    name_hash = WalletCacheNameHash(wallet_name_str);
+
+    pthread_mutex_lock(&g_boat_wallet_cache.lock);
+
+    if( g_boat_wallet_cache.bucket_num == 0 )
+    {
+        pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+        return;
+    }
+
+    index = WalletCacheFind(wallet_name_str, name_hash);
+
+    if( index != BOAT_WALLET_CACHE_NIL )
+    {
+        WalletCacheLruUnlink(index);
+    }
+    else
+    {
+        name_len = strlen(wallet_name_str);
+        name_copy_str = BoatMalloc(name_len + 1);
+        if( name_copy_str == NULL )
+        {
+            pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+            return;
+        }
+        memcpy(name_copy_str, wallet_name_str, name_len + 1);
+
+        if( g_boat_wallet_cache.free_head == BOAT_WALLET_CACHE_NIL )
+        {
+            WalletCacheRemove(g_boat_wallet_cache.lru_tail);
+        }
+
+        index = g_boat_wallet_cache.free_head;
+        g_boat_wallet_cache.free_head = g_boat_wallet_cache.entry_array[index].lru_next;
+
+        entry_ptr = &g_boat_wallet_cache.entry_array[index];
+        entry_ptr->wallet_name_str = name_copy_str;
+        entry_ptr->name_hash = name_hash;
+        entry_ptr->bucket_next = g_boat_wallet_cache.bucket_array[name_hash & (g_boat_wallet_cache.bucket_num - 1)];
+        g_boat_wallet_cache.bucket_array[name_hash & (g_boat_wallet_cache.bucket_num - 1)] = index;
+    }
+
+    entry_ptr = &g_boat_wallet_cache.entry_array[index];
+    entry_ptr->protocol_type = protocol_type;
+    entry_ptr->wallet_config_size = wallet_config_size;
+    memzero(WalletCacheConfig(index), BOAT_WALLET_CACHE_MAX_CONFIG_SIZE);
+    memcpy(WalletCacheConfig(index), wallet_config_ptr, wallet_config_size);
+
+    entry_ptr->has_pub_key = (pub_key_ptr != NULL);
+    if( pub_key_ptr != NULL )
+    {
+        memcpy(entry_ptr->pub_key_array, pub_key_ptr, 64);
+    }
+
+    WalletCacheLruPushFront(index);
+
+    pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+}
+
+
+/*!*****************************************************************************
+@brief Evict a wallet from the wallet cache
+
+Function: BoatWalletCacheEvict()
+
+    This function wipes the cached configuration of a persistent wallet. The
+    next BoatWalletCreate() for this wallet reads its persistent storage again.
+    A loaded wallet is not affected.
+
+@return This function doesn't return any thing.
+
+@param[in] wallet_name_str
+    The wallet name.
+
+*******************************************************************************/
+void BoatWalletCacheEvict(const BCHAR *wallet_name_str)
+{
+    BSINT32 index;
+
+    if( wallet_name_str == NULL )
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&g_boat_wallet_cache.lock);
+
+    if( g_boat_wallet_cache.bucket_num != 0 )
+    {
+        index = WalletCacheFind(wallet_name_str, WalletCacheNameHash(wallet_name_str));
+        if( index != BOAT_WALLET_CACHE_NIL )
+        {
+            WalletCacheRemove(index);
+        }
+    }
+
+    pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+}
+
+
+/*!*****************************************************************************
+@brief Evict all wallets from the wallet cache
+
+Function: BoatWalletCacheClear()
+
+    This function wipes all cached configurations. Loaded wallets are not
+    affected.
+
+@return This function doesn't return any thing.
+
+*******************************************************************************/
+void BoatWalletCacheClear(void)
+{
+    pthread_mutex_lock(&g_boat_wallet_cache.lock);
+
+    if( g_boat_wallet_cache.bucket_num != 0 )
+    {
+        while( g_boat_wallet_cache.lru_head != BOAT_WALLET_CACHE_NIL )
+        {
+            WalletCacheRemove(g_boat_wallet_cache.lru_head);
+        }
+    }
+
+    pthread_mutex_unlock(&g_boat_wallet_cache.lock);
+}
+
+#else   // BOAT_WALLET_CACHE_SIZE > 0
+
+BOAT_RESULT BoatWalletCacheInit(void)
+{
+    return BOAT_SUCCESS;
+}
+
+
+void BoatWalletCacheDeInit(void)
+{
+    return;
+}
+
+
+BOAT_RESULT BoatWalletCacheGet(const BCHAR *wallet_name_str,
+                               BoatProtocolType protocol_type,
+                               BOAT_OUT void *wallet_config_ptr,
+                               BUINT32 wallet_config_size,
+                               BOAT_OUT BUINT8 pub_key_array[64],
+                               BOAT_OUT BBOOL *has_pub_key_ptr)
+{
+    (void)wallet_name_str;
+    (void)protocol_type;
+    (void)wallet_config_ptr;
+    (void)wallet_config_size;
+    (void)pub_key_array;
+    (void)has_pub_key_ptr;
+
+    return BOAT_ERROR;
+}
+
+
+void BoatWalletCachePut(const BCHAR *wallet_name_str,
+                        BoatProtocolType protocol_type,
+                        const void *wallet_config_ptr,
+                        BUINT32 wallet_config_size,
+                        const BUINT8 *pub_key_ptr)
+{
+    (void)wallet_name_str;
+    (void)protocol_type;
+    (void)wallet_config_ptr;
+    (void)wallet_config_size;
+    (void)pub_key_ptr;
+}
+
+
+void BoatWalletCacheEvict(const BCHAR *wallet_name_str)
+{
+    (void)wallet_name_str;
+}
+
+
+void BoatWalletCacheClear(void)
+{
+    return;
+}
+
+#endif  // BOAT_WALLET_CACHE_SIZE > 0
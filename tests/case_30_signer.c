@@ -0,0 +1,242 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatsigner.h"
+#include "testcommon.h"
+
+#include <pthread.h>
+#include <time.h>
+
+#define CASE_30_BENCH_ROUNDS  1000
+#define CASE_30_THREAD_NUM    8
+#define CASE_30_THREAD_ROUNDS 16
+
+static BUINT8 g_case_30_priv_key[32] =
+{
+    0xe8, 0xf3, 0x2e, 0x72, 0x3d, 0xec, 0xf4, 0x05, 0x1a, 0xef, 0xac, 0x8e, 0x2c, 0x93, 0xc9, 0xc5,
+    0xb2, 0x14, 0x31, 0x38, 0x17, 0xcd, 0xb0, 0x1a, 0x14, 0x94, 0xb9, 0x17, 0xc8, 0x43, 0x6b, 0x35
+};
+
+
+typedef struct TCase30ThreadArg
+{
+    BUINT32 index;
+    BBOOL is_pass;
+}Case30ThreadArg;
+
+
+// Each thread signs its own digests and checks them against the built-in crypto
+static void *Case_30_SignerThread(void *arg)
+{
+    BUINT8 digest[32];
+    BUINT8 sig[64];
+    BUINT8 ref_sig[64];
+    BUINT8 recid;
+    BUINT8 ref_recid;
+    BUINT32 i;
+    Case30ThreadArg *arg_ptr = arg;
+
+    memset(digest, (BUINT8)arg_ptr->index, sizeof(digest));
+    keccak_256(digest, 32, digest);
+
+    for( i = 0; i < CASE_30_THREAD_ROUNDS; i++ )
+    {
+        ecdsa_sign_digest(&secp256k1, g_case_30_priv_key, digest, ref_sig, &ref_recid, NULL);
+
+        if(    BoatSignerSignDigest(g_case_30_priv_key, digest, sig, &recid) != BOAT_SUCCESS
+            || memcmp(sig, ref_sig, 64) != 0
+            || recid != ref_recid )
+        {
+            arg_ptr->is_pass = BOAT_FALSE;
+        }
+
+        keccak_256(digest, 32, digest);
+    }
+
+    return NULL;
+}
+
+
+// Threads signing at the same time, the first of them creating the backend's
+// context, must all get correct signatures
+static BOAT_RESULT Case_30_SignerConcurrent(void)
+{
+    pthread_t thread_array[CASE_30_THREAD_NUM];
+    Case30ThreadArg arg_array[CASE_30_THREAD_NUM];
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < CASE_30_THREAD_NUM; i++ )
+    {
+        arg_array[i].index = i;
+        arg_array[i].is_pass = BOAT_TRUE;
+        if( pthread_create(&thread_array[i], NULL, Case_30_SignerThread, &arg_array[i]) != 0 )
+        {
+            arg_array[i].is_pass = BOAT_FALSE;
+            thread_array[i] = pthread_self();
+        }
+    }
+
+    for( i = 0; i < CASE_30_THREAD_NUM; i++ )
+    {
+        if( !pthread_equal(thread_array[i], pthread_self()) )
+        {
+            pthread_join(thread_array[i], NULL);
+        }
+        is_pass = is_pass && arg_array[i].is_pass;
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_30_SignerConcurrent_3003");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_30_SignerCrossCheck(void)
+{
+    BUINT8 digest[32];
+    BUINT8 sig[64];
+    BUINT8 ref_sig[64];
+    BUINT8 recid;
+    BUINT8 ref_recid;
+    BUINT8 pub_key[64];
+    BUINT8 pub_key65[65];
+    BUINT8 recovered_pub_key[64];
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    BoatLog(BOAT_LOG_NORMAL, "Signer backend: %s.", BoatSignerBackendName());
+
+    ecdsa_get_public_key65(&secp256k1, g_case_30_priv_key, pub_key65);
+    if(    BoatSignerGetPubkey(g_case_30_priv_key, pub_key) != BOAT_SUCCESS
+        || memcmp(pub_key, &pub_key65[1], 64) != 0 )
+    {
+        is_pass = BOAT_FALSE;
+    }
+    BoatDisplayTestResult(is_pass, "Case_30_SignerGetPubkey_3001");
+
+    keccak_256(g_case_30_priv_key, 32, digest);
+
+    for( i = 0; i < 16; i++ )
+    {
+        // Both backends use RFC6979 and low-s, the signatures must be identical
+        ecdsa_sign_digest(&secp256k1, g_case_30_priv_key, digest, ref_sig, &ref_recid, NULL);
+
+        if(    BoatSignerSignDigest(g_case_30_priv_key, digest, sig, &recid) != BOAT_SUCCESS
+            || memcmp(sig, ref_sig, 64) != 0
+            || recid != ref_recid )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        if(    BoatSignerRecoverPubkey(sig, digest, recid, recovered_pub_key) != BOAT_SUCCESS
+            || memcmp(recovered_pub_key, pub_key, 64) != 0 )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        keccak_256(digest, 32, digest);
+    }
+    BoatDisplayTestResult(is_pass, "Case_30_SignerSignRecover_3002");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_30_SignerBenchmark(void)
+{
+    BUINT8 digest[32];
+    BUINT8 sig[64];
+    BUINT8 recid;
+    BUINT8 pub_key[64];
+    BUINT8 pub_key65[65];
+    clock_t start;
+    double builtin_sec;
+    double signer_sec;
+    BUINT32 i;
+
+    memset(digest, 0x5a, sizeof(digest));
+
+    start = clock();
+    for( i = 0; i < CASE_30_BENCH_ROUNDS; i++ )
+    {
+        digest[0] = (BUINT8)i;
+        ecdsa_sign_digest(&secp256k1, g_case_30_priv_key, digest, sig, &recid, NULL);
+    }
+    builtin_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( i = 0; i < CASE_30_BENCH_ROUNDS; i++ )
+    {
+        digest[0] = (BUINT8)i;
+        BoatSignerSignDigest(g_case_30_priv_key, digest, sig, &recid);
+    }
+    signer_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "Sign %u digests: builtin %.3f ms/sig, %s %.3f ms/sig.",
+            CASE_30_BENCH_ROUNDS,
+            builtin_sec * 1000 / CASE_30_BENCH_ROUNDS,
+            BoatSignerBackendName(),
+            signer_sec * 1000 / CASE_30_BENCH_ROUNDS);
+
+    start = clock();
+    for( i = 0; i < CASE_30_BENCH_ROUNDS; i++ )
+    {
+        digest[0] = (BUINT8)i;
+        ecdsa_recover_pub_from_sig(&secp256k1, pub_key65, sig, digest, recid);
+    }
+    builtin_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( i = 0; i < CASE_30_BENCH_ROUNDS; i++ )
+    {
+        digest[0] = (BUINT8)i;
+        BoatSignerRecoverPubkey(sig, digest, recid, pub_key);
+    }
+    signer_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "Recover %u public keys: builtin %.3f ms/op, %s %.3f ms/op.",
+            CASE_30_BENCH_ROUNDS,
+            builtin_sec * 1000 / CASE_30_BENCH_ROUNDS,
+            BoatSignerBackendName(),
+            signer_sec * 1000 / CASE_30_BENCH_ROUNDS);
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_30_SignerMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_30_SignerConcurrent();
+    case_result += Case_30_SignerCrossCheck();
+    case_result += Case_30_SignerBenchmark();
+
+    if( case_result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_30_Signer Failed: %d.", case_result);
+    }
+    else
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_30_Signer Passed.");
+    }
+
+    return case_result;
+}
@@ -0,0 +1,207 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+
+#include <time.h>
+
+#define CASE_31_CHECK_ROUNDS 1000
+#define CASE_31_BENCH_ROUNDS 10000
+
+
+// Reference inverse x^(prime-2) by square-and-multiply, independent of the
+// bn_inverse() implementation selected in options.h
+static void Case_31_FermatInverse(bignum256 *x, const bignum256 *prime)
+{
+    bignum256 exp = *prime;
+    bignum256 res;
+    int i;
+
+    exp.val[0] -= 2;
+    bn_one(&res);
+
+    for( i = 255; i >= 0; i-- )
+    {
+        bn_multiply(&res, &res, prime);
+        if( bn_testbit(&exp, (uint8_t)i) )
+        {
+            bn_multiply(x, &res, prime);
+        }
+    }
+    bn_mod(&res, prime);
+    *x = res;
+}
+
+
+static BBOOL Case_31_CheckModulus(const bignum256 *prime)
+{
+    BUINT8 seed[32];
+    bignum256 x;
+    bignum256 inv;
+    bignum256 ref;
+    bignum256 one;
+    BUINT32 i;
+
+    memset(seed, 0xa5, sizeof(seed));
+    bn_one(&one);
+
+    for( i = 0; i < CASE_31_CHECK_ROUNDS; i++ )
+    {
+        keccak_256(seed, 32, seed);
+
+        // Edge cases first: 1, prime - 1, 2^256 - 1 (not reduced)
+        if( i == 0 )
+        {
+            memset(seed, 0x00, sizeof(seed));
+            seed[31] = 1;
+        }
+        else if( i == 1 )
+        {
+            bn_write_be(prime, seed);
+            seed[31] -= 1;
+        }
+        else if( i == 2 )
+        {
+            memset(seed, 0xff, sizeof(seed));
+        }
+
+        bn_read_be(seed, &x);
+        bn_fast_mod(&x, prime);
+        bn_mod(&x, prime);
+        if( bn_is_zero(&x) )
+        {
+            continue;
+        }
+
+        inv = x;
+        bn_inverse(&inv, prime);
+        ref = x;
+        Case_31_FermatInverse(&ref, prime);
+
+        if( !bn_is_equal(&inv, &ref) || !bn_is_less(&inv, prime) )
+        {
+            return BOAT_FALSE;
+        }
+
+#if USE_INVERSE_FAST
+        // the implementation bn_inverse() used before safegcd
+        ref = x;
+        bn_inverse_fast(&ref, prime);
+        if( !bn_is_equal(&inv, &ref) )
+        {
+            return BOAT_FALSE;
+        }
+#endif
+
+        bn_multiply(&x, &inv, prime);
+        bn_mod(&inv, prime);
+        if( !bn_is_equal(&inv, &one) )
+        {
+            return BOAT_FALSE;
+        }
+    }
+
+    return BOAT_TRUE;
+}
+
+
+static BOAT_RESULT Case_31_BnInverseCrossCheck(void)
+{
+    BBOOL is_pass;
+
+    is_pass = Case_31_CheckModulus(&secp256k1.prime);
+    BoatDisplayTestResult(is_pass, "Case_31_BnInversePrime_3101");
+
+    is_pass = Case_31_CheckModulus(&secp256k1.order);
+    BoatDisplayTestResult(is_pass, "Case_31_BnInverseOrder_3102");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_31_BnInverseBenchmark(void)
+{
+    BUINT8 seed[32];
+    bignum256 x;
+    clock_t start;
+    double inverse_sec;
+    double fast_sec = 0;
+    double fermat_sec;
+    BUINT32 i;
+    int m;
+
+    memset(seed, 0x3c, sizeof(seed));
+    bn_read_be(seed, &x);
+
+    for( m = 0; m < 2; m++ )
+    {
+        const bignum256 *modulus = (m == 0) ? &secp256k1.prime : &secp256k1.order;
+
+        start = clock();
+        for( i = 0; i < CASE_31_BENCH_ROUNDS; i++ )
+        {
+            bn_inverse(&x, modulus);
+        }
+        inverse_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+#if USE_INVERSE_FAST
+        start = clock();
+        for( i = 0; i < CASE_31_BENCH_ROUNDS; i++ )
+        {
+            bn_inverse_fast(&x, modulus);
+        }
+        fast_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+#endif
+
+        start = clock();
+        for( i = 0; i < CASE_31_BENCH_ROUNDS; i++ )
+        {
+            Case_31_FermatInverse(&x, modulus);
+        }
+        fermat_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        BoatLog(BOAT_LOG_NORMAL, "Invert mod %s %u times: bn_inverse %.3f us/op, "
+                "previous bn_inverse_fast %.3f us/op, fermat %.3f us/op.",
+                (m == 0) ? "p" : "n",
+                CASE_31_BENCH_ROUNDS,
+                inverse_sec * 1000000 / CASE_31_BENCH_ROUNDS,
+                fast_sec * 1000000 / CASE_31_BENCH_ROUNDS,
+                fermat_sec * 1000000 / CASE_31_BENCH_ROUNDS);
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_31_BnInverseMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_31_BnInverseCrossCheck();
+    case_result += Case_31_BnInverseBenchmark();
+
+    if( case_result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_31_BnInverse Failed: %d.", case_result);
+    }
+    else
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_31_BnInverse Passed.");
+    }
+
+    return case_result;
+}
@@ -0,0 +1,267 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+#include "sha3.h"
+#include "rand.h"
+
+#include <time.h>
+
+#define CASE_32_BUF_SIZE     4096
+#define CASE_32_STATE_NUM    1000
+#define CASE_32_PERM_ROUNDS  1000000
+#define CASE_32_BATCH_SIZE   64
+#define CASE_32_BENCH_ROUNDS 1000
+
+static BUINT8 g_case_32_buf[4][CASE_32_BUF_SIZE];
+static BUINT8 g_case_32_big_buf[65536];
+
+
+static void Case_32_FillBuffers(void)
+{
+    BUINT32 i;
+    BUINT32 j;
+
+    for( i = 0; i < 4; i++ )
+    {
+        for( j = 0; j < CASE_32_BUF_SIZE; j += 32 )
+        {
+            keccak_256(j == 0 ? (BUINT8 *)&i : g_case_32_buf[i] + j - 32,
+                       j == 0 ? sizeof(i) : 32,
+                       g_case_32_buf[i] + j);
+        }
+    }
+
+    for( j = 0; j < sizeof(g_case_32_big_buf); j += CASE_32_BUF_SIZE )
+    {
+        memcpy(g_case_32_big_buf + j, g_case_32_buf[(j / CASE_32_BUF_SIZE) % 4], CASE_32_BUF_SIZE);
+    }
+}
+
+
+static BOAT_RESULT Case_32_KeccakX4CrossCheck(void)
+{
+    const BUINT8 *data[4];
+    size_t len[4];
+    BUINT8 digest_buf[4][32];
+    BUINT8 *digest[4];
+    BUINT8 ref_digest[32];
+    BUINT32 round;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < 4; i++ )
+    {
+        digest[i] = digest_buf[i];
+    }
+
+    // Equal and unequal lengths around the 136-byte block boundary,
+    // unaligned input included
+    for( round = 0; round < 600 && is_pass; round++ )
+    {
+        for( i = 0; i < 4; i++ )
+        {
+            len[i]  = (round % 2 == 0) ? round : (round * (i + 1) * 7) % (CASE_32_BUF_SIZE - 8);
+            data[i] = g_case_32_buf[i] + (round + i) % 8;
+        }
+
+        keccak_256_x4(data, len, digest);
+
+        for( i = 0; i < 4; i++ )
+        {
+            keccak_256(data[i], len[i], ref_digest);
+            if( memcmp(ref_digest, digest[i], 32) != 0 )
+            {
+                is_pass = BOAT_FALSE;
+            }
+        }
+    }
+    BoatDisplayTestResult(is_pass, "Case_32_KeccakX4_3201");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_32_KeccakBatchBenchmark(void)
+{
+    const BUINT8 *data[CASE_32_BATCH_SIZE];
+    size_t len[CASE_32_BATCH_SIZE];
+    BUINT8 digest_buf[CASE_32_BATCH_SIZE][32];
+    BUINT8 *digest[CASE_32_BATCH_SIZE];
+    clock_t start;
+    double scalar_sec;
+    double batch_sec;
+    BUINT32 round;
+    BUINT32 i;
+
+    // 64-byte public keys, as in batch address derivation
+    for( i = 0; i < CASE_32_BATCH_SIZE; i++ )
+    {
+        data[i]   = g_case_32_buf[i % 4] + 64 * (i / 4);
+        len[i]    = 64;
+        digest[i] = digest_buf[i];
+    }
+
+    start = clock();
+    for( round = 0; round < CASE_32_BENCH_ROUNDS; round++ )
+    {
+        for( i = 0; i < CASE_32_BATCH_SIZE; i++ )
+        {
+            keccak_256(data[i], len[i], digest[i]);
+        }
+    }
+    scalar_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( round = 0; round < CASE_32_BENCH_ROUNDS; round++ )
+    {
+        keccak_256_batch(data, len, digest, CASE_32_BATCH_SIZE);
+    }
+    batch_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "Hash %u x %u 64-byte messages: keccak_256 %.3f us/msg, keccak_256_batch %.3f us/msg.",
+            CASE_32_BENCH_ROUNDS, CASE_32_BATCH_SIZE,
+            scalar_sec * 1000000 / (CASE_32_BENCH_ROUNDS * CASE_32_BATCH_SIZE),
+            batch_sec * 1000000 / (CASE_32_BENCH_ROUNDS * CASE_32_BATCH_SIZE));
+
+    return BOAT_SUCCESS;
+}
+
+
+// The permutation of the hash functions against the generic round functions
+static BOAT_RESULT Case_32_PermutationCrossCheck(void)
+{
+    uint64_t state[25];
+    uint64_t ref_state[25];
+    BUINT32 round;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( round = 0; round < CASE_32_STATE_NUM && is_pass; round++ )
+    {
+        if( round == 0 )
+        {
+            memset(state, 0x00, sizeof(state));
+        }
+        else if( round == 1 )
+        {
+            memset(state, 0xff, sizeof(state));
+        }
+        else
+        {
+            random_buffer((BUINT8 *)state, sizeof(state));
+        }
+        memcpy(ref_state, state, sizeof(state));
+
+        keccak_f1600(state);
+        keccak_f1600_generic(ref_state);
+        is_pass = memcmp(state, ref_state, sizeof(state)) == 0;
+    }
+    BoatDisplayTestResult(is_pass, "Case_32_KeccakPermutation_3202");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_32_PermutationBenchmark(void)
+{
+    uint64_t state[25];
+    clock_t start;
+    double perm_sec;
+    double generic_sec;
+    BUINT32 round;
+
+    memset(state, 0x32, sizeof(state));
+
+    start = clock();
+    for( round = 0; round < CASE_32_PERM_ROUNDS; round++ )
+    {
+        keccak_f1600(state);
+    }
+    perm_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( round = 0; round < CASE_32_PERM_ROUNDS; round++ )
+    {
+        keccak_f1600_generic(state);
+    }
+    generic_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "Keccak-f[1600] (USE_KECCAK_UNROLLED=%d): %.1f ns, generic round functions: %.1f ns.",
+            USE_KECCAK_UNROLLED,
+            perm_sec * 1e9 / CASE_32_PERM_ROUNDS,
+            generic_sec * 1e9 / CASE_32_PERM_ROUNDS);
+
+    return BOAT_SUCCESS;
+}
+
+
+// Single message throughput
+static BOAT_RESULT Case_32_KeccakBenchmark(void)
+{
+    static const size_t msg_len[3] = {32, 1024, 65536};
+    BUINT8 digest[32];
+    clock_t start;
+    double elapsed_sec;
+    BUINT32 rounds;
+    BUINT32 round;
+    BUINT32 i;
+
+    for( i = 0; i < 3; i++ )
+    {
+        // Hash about 64MB per message size
+        rounds = (BUINT32)(64 * 1024 * 1024 / msg_len[i]);
+
+        start = clock();
+        for( round = 0; round < rounds; round++ )
+        {
+            keccak_256(g_case_32_big_buf, msg_len[i], digest);
+        }
+        elapsed_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        BoatLog(BOAT_LOG_NORMAL, "keccak_256 on %u-byte messages (USE_KECCAK_UNROLLED=%d): %.3f us/msg, %.1f MB/s.",
+                (BUINT32)msg_len[i], USE_KECCAK_UNROLLED,
+                elapsed_sec * 1000000 / rounds,
+                elapsed_sec > 0 ? (double)msg_len[i] * rounds / elapsed_sec / 1000000 : 0.0);
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_32_KeccakMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    Case_32_FillBuffers();
+
+    case_result += Case_32_KeccakX4CrossCheck();
+    case_result += Case_32_PermutationCrossCheck();
+    case_result += Case_32_PermutationBenchmark();
+    case_result += Case_32_KeccakBenchmark();
+    case_result += Case_32_KeccakBatchBenchmark();
+
+    if( case_result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_32_Keccak Failed: %d.", case_result);
+    }
+    else
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_32_Keccak Passed.");
+    }
+
+    return case_result;
+}
@@ -0,0 +1,284 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "boatsigner.h"
+#include "boatethereum.h"
+#include "boatsignpool.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#include <sched.h>
+
+#if BOAT_USE_SIGN_POOL == 1
+
+#define CASE_33_TX_NUM       256
+#define CASE_33_BENCH_ROUNDS 8
+
+static BUINT8 g_case_33_priv_key[32] =
+{
+    0xe8, 0xf3, 0x2e, 0x72, 0x3d, 0xec, 0xf4, 0x05, 0x1a, 0xef, 0xac, 0x8e, 0x2c, 0x93, 0xc9, 0xc5,
+    0xb2, 0x14, 0x31, 0x38, 0x17, 0xcd, 0xb0, 0x1a, 0x14, 0x94, 0xb9, 0x17, 0xc8, 0x43, 0x6b, 0x35
+};
+
+static BoatEthWallet g_case_33_wallet;
+static BoatEthTx g_case_33_tx[CASE_33_TX_NUM];
+
+// Reference results of inline signing
+static BUINT8 *g_case_33_ref_tx_ptr[CASE_33_TX_NUM];
+static BUINT32 g_case_33_ref_tx_len[CASE_33_TX_NUM];
+static BUINT8 g_case_33_ref_hash[CASE_33_TX_NUM][32];
+
+static BUINT32 g_case_33_mismatch_num;
+
+
+static void Case_33_TxInit(BoatEthTx *tx_ptr, BUINT32 nonce)
+{
+    memset(tx_ptr, 0x00, sizeof(BoatEthTx));
+
+    tx_ptr->wallet_ptr = &g_case_33_wallet;
+
+    tx_ptr->rawtx_fields.nonce.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.nonce.field, nonce, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gasprice.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gasprice.field, 1000000000u, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gaslimit.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gaslimit.field, 21000, TRIMBIN_LEFTTRIM);
+    memset(tx_ptr->rawtx_fields.recipient, 0x5a, BOAT_ETH_ADDRESS_SIZE);
+    tx_ptr->rawtx_fields.value.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.value.field, 1000000u + nonce, TRIMBIN_LEFTTRIM);
+}
+
+
+static void Case_33_CheckCallback(BoatEthTx *tx_ptr,
+                                  BOAT_RESULT result,
+                                  const BUINT8 *signed_tx_ptr,
+                                  BUINT32 signed_tx_len,
+                                  const BUINT8 tx_hash[32],
+                                  void *user_data)
+{
+    BUINT32 index = (BUINT32)(size_t)user_data;
+
+    if(    result != BOAT_SUCCESS
+        || tx_ptr != &g_case_33_tx[index]
+        || signed_tx_len != g_case_33_ref_tx_len[index]
+        || memcmp(signed_tx_ptr, g_case_33_ref_tx_ptr[index], signed_tx_len) != 0
+        || memcmp(tx_hash, g_case_33_ref_hash[index], 32) != 0
+        || memcmp(tx_ptr->tx_hash.field, g_case_33_ref_hash[index], 32) != 0 )
+    {
+        __atomic_add_fetch(&g_case_33_mismatch_num, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+static void Case_33_CountCallback(BoatEthTx *tx_ptr,
+                                  BOAT_RESULT result,
+                                  const BUINT8 *signed_tx_ptr,
+                                  BUINT32 signed_tx_len,
+                                  const BUINT8 tx_hash[32],
+                                  void *user_data)
+{
+    (void)tx_ptr;
+    (void)signed_tx_ptr;
+    (void)signed_tx_len;
+    (void)tx_hash;
+    (void)user_data;
+
+    if( result != BOAT_SUCCESS )
+    {
+        __atomic_add_fetch(&g_case_33_mismatch_num, 1, __ATOMIC_RELAXED);
+    }
+}
+
+
+static void Case_33_SubmitAll(BoatEthSignPool *pool_ptr, BoatEthSignPoolCallback callback)
+{
+    BUINT32 i;
+
+    for( i = 0; i < CASE_33_TX_NUM; i++ )
+    {
+        // Queue full: let the workers catch up
+        while( BoatEthSignPoolSubmit(pool_ptr, &g_case_33_tx[i], callback, (void *)(size_t)i)
+               == BOAT_ERROR_BUFFER_EXHAUSTED )
+        {
+            sched_yield();
+        }
+    }
+}
+
+
+static BOAT_RESULT Case_33_SignPoolCrossCheck(void)
+{
+    BoatFieldVariable signed_tx;
+    BoatEthSignPool *pool_ptr;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < CASE_33_TX_NUM; i++ )
+    {
+        Case_33_TxInit(&g_case_33_tx[i], i);
+
+        if( EthSignRawtx(&g_case_33_tx[i], &signed_tx) != BOAT_SUCCESS )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        g_case_33_ref_tx_ptr[i] = signed_tx.field_ptr;
+        g_case_33_ref_tx_len[i] = signed_tx.field_len;
+        keccak_256(signed_tx.field_ptr, signed_tx.field_len, g_case_33_ref_hash[i]);
+    }
+    BoatDisplayTestResult(is_pass, "Case_33_EthSignRawtx_3301");
+
+    // A small queue exercises the full queue path as well
+    g_case_33_mismatch_num = 0;
+    pool_ptr = BoatEthSignPoolCreate(4, 16);
+    if( pool_ptr == NULL )
+    {
+        is_pass = BOAT_FALSE;
+    }
+    else
+    {
+        for( i = 0; i < CASE_33_TX_NUM; i++ )
+        {
+            Case_33_TxInit(&g_case_33_tx[i], i);
+        }
+
+        Case_33_SubmitAll(pool_ptr, Case_33_CheckCallback);
+        BoatEthSignPoolWait(pool_ptr);
+        BoatEthSignPoolDestroy(pool_ptr);
+
+        is_pass = (g_case_33_mismatch_num == 0);
+    }
+    BoatDisplayTestResult(is_pass, "Case_33_SignPoolCrossCheck_3302");
+
+    for( i = 0; i < CASE_33_TX_NUM; i++ )
+    {
+        BoatFree(g_case_33_ref_tx_ptr[i]);
+        g_case_33_ref_tx_ptr[i] = NULL;
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_33_SignPoolBenchmark(void)
+{
+    BoatFieldVariable signed_tx;
+    BoatEthSignPool *pool_ptr;
+    BUINT32 worker_num;
+    BUINT32 max_worker_num;
+    BUINT32 round;
+    BUINT32 i;
+    double start;
+    double sec;
+    double sigs_per_sec;
+    long cpu_num;
+    BBOOL is_pass = BOAT_TRUE;
+
+    cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+    max_worker_num = cpu_num > 0 ? (BUINT32)cpu_num : 1;
+    if( max_worker_num > BOAT_SIGN_POOL_MAX_WORKER_NUM )
+    {
+        max_worker_num = BOAT_SIGN_POOL_MAX_WORKER_NUM;
+    }
+
+    // Inline signing as in EthSendRawtx()
+    start = TestNow();
+    for( round = 0; round < CASE_33_BENCH_ROUNDS; round++ )
+    {
+        for( i = 0; i < CASE_33_TX_NUM; i++ )
+        {
+            Case_33_TxInit(&g_case_33_tx[i], i);
+            if( EthSignRawtx(&g_case_33_tx[i], &signed_tx) != BOAT_SUCCESS )
+            {
+                is_pass = BOAT_FALSE;
+                break;
+            }
+            BoatFree(signed_tx.field_ptr);
+        }
+    }
+    sec = TestNow() - start;
+    BoatLog(BOAT_LOG_NORMAL, "inline: %.0f sigs/s.",
+            CASE_33_BENCH_ROUNDS * CASE_33_TX_NUM / sec);
+
+    for( worker_num = 1; worker_num <= max_worker_num && is_pass == BOAT_TRUE; worker_num *= 2 )
+    {
+        pool_ptr = BoatEthSignPoolCreate(worker_num, 0);
+        if( pool_ptr == NULL )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        g_case_33_mismatch_num = 0;
+        start = TestNow();
+        for( round = 0; round < CASE_33_BENCH_ROUNDS; round++ )
+        {
+            for( i = 0; i < CASE_33_TX_NUM; i++ )
+            {
+                Case_33_TxInit(&g_case_33_tx[i], i);
+            }
+            Case_33_SubmitAll(pool_ptr, Case_33_CountCallback);
+            BoatEthSignPoolWait(pool_ptr);
+        }
+        sec = TestNow() - start;
+
+        BoatEthSignPoolDestroy(pool_ptr);
+
+        sigs_per_sec = CASE_33_BENCH_ROUNDS * CASE_33_TX_NUM / sec;
+        BoatLog(BOAT_LOG_NORMAL, "%u worker(s): %.0f sigs/s, %.0f sigs/s/core.",
+                worker_num, sigs_per_sec, sigs_per_sec / worker_num);
+
+        if( g_case_33_mismatch_num != 0 )
+        {
+            is_pass = BOAT_FALSE;
+        }
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_33_SignPoolBenchmark_3303");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_33_SignPoolMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    memset(&g_case_33_wallet, 0x00, sizeof(g_case_33_wallet));
+    memcpy(g_case_33_wallet.account_info.priv_key_array, g_case_33_priv_key, 32);
+    g_case_33_wallet.network_info.chain_id = 1;
+    g_case_33_wallet.network_info.eip155_compatibility = BOAT_TRUE;
+
+    case_result += Case_33_SignPoolCrossCheck();
+    case_result += Case_33_SignPoolBenchmark();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_33_SignPoolMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Signing pool is disabled (BOAT_USE_SIGN_POOL).");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,275 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+
+#include <time.h>
+
+#include "bignum.h"
+#include "ecdsa.h"
+#include "rand.h"
+#include "secp256k1_fe52.h"
+
+#if USE_SECP256K1_5X52
+
+#define CASE_34_CHECK_ROUNDS 64
+#define CASE_34_BENCH_ROUNDS 2000
+
+
+static BBOOL Case_34_CheckTable(const scalar52_gen_table *table_ptr)
+{
+    static const BUINT8 small_k[4][32] =
+    {
+        {[31] = 1},
+        {[31] = 2},
+        // order - 1 and order - 2
+        {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+         0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x40},
+        {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+         0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x3f}
+    };
+    BUINT8 k_bytes[32];
+    bignum256 k;
+    curve_point res;
+    curve_point ref;
+    BUINT32 i;
+
+    memset(k_bytes, 0x34, sizeof(k_bytes));
+
+    for( i = 0; i < CASE_34_CHECK_ROUNDS + 4; i++ )
+    {
+        if( i < 4 )
+        {
+            bn_read_be(small_k[i], &k);
+        }
+        else
+        {
+            keccak_256(k_bytes, 32, k_bytes);
+            bn_read_be(k_bytes, &k);
+            bn_mod(&k, &secp256k1.order);
+        }
+
+        scalar52_multiply_table(table_ptr, &k, &res);
+        point_multiply(&secp256k1, &k, &secp256k1.G, &ref);
+
+        if( !point_is_equal(&res, &ref) )
+        {
+            return BOAT_FALSE;
+        }
+    }
+
+    return BOAT_TRUE;
+}
+
+
+// Under BOAT_USE_STATIC_POOL, tables larger than the largest block are skipped
+#if BOAT_USE_STATIC_POOL == 1
+#define CASE_34_TABLE_FITS(window) \
+    (SCALAR52_GEN_TABLE_POINTS(window) * sizeof(affine_point52) + 16 <= BOAT_STATIC_POOL_5_BLOCK_SIZE)
+#else
+#define CASE_34_TABLE_FITS(window) 1
+#endif
+
+
+static BOAT_RESULT Case_34_EcmultGenCheck(void)
+{
+    scalar52_gen_table table;
+    affine_point52 *points_ptr;
+    int window;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( window = 2; window <= SCALAR52_GEN_MAX_WINDOW && is_pass == BOAT_TRUE; window++ )
+    {
+        if( !CASE_34_TABLE_FITS(window) )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Window %d skipped: table exceeds the static pools.", window);
+            continue;
+        }
+        points_ptr = BoatMalloc(SCALAR52_GEN_TABLE_POINTS(window) * sizeof(affine_point52));
+        if(    points_ptr == NULL
+            || scalar52_gen_table_build(&table, window, points_ptr) != 0
+            || Case_34_CheckTable(&table) != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Window %d failed.", window);
+            is_pass = BOAT_FALSE;
+        }
+        BoatFree(points_ptr);
+    }
+    BoatDisplayTestResult(is_pass, "Case_34_EcmultGenCheck_3401");
+
+    return BOAT_SUCCESS;
+}
+
+
+// The table path against the precomputed cp table path on random scalars,
+// including scalars whose windows are all zero or all ones
+static BOAT_RESULT Case_34_EcmultGenCrossCheck(void)
+{
+    scalar52_gen_table table;
+    affine_point52 *points_ptr;
+    BUINT8 k_bytes[32];
+    bignum256 k;
+    curve_point res;
+    curve_point ref;
+    BUINT32 i;
+    int window;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( window = 2; window <= SCALAR52_GEN_MAX_WINDOW && is_pass == BOAT_TRUE; window++ )
+    {
+        if( !CASE_34_TABLE_FITS(window) )
+        {
+            continue;
+        }
+        points_ptr = BoatMalloc(SCALAR52_GEN_TABLE_POINTS(window) * sizeof(affine_point52));
+        if(    points_ptr == NULL
+            || scalar52_gen_table_build(&table, window, points_ptr) != 0 )
+        {
+            is_pass = BOAT_FALSE;
+            BoatFree(points_ptr);
+            break;
+        }
+
+        for( i = 0; i < CASE_34_CHECK_ROUNDS && is_pass == BOAT_TRUE; i++ )
+        {
+            if( i < 2 )
+            {
+                memset(k_bytes, (i == 0) ? 0x00 : 0xff, sizeof(k_bytes));
+                k_bytes[0] = 0x7f;
+            }
+            else
+            {
+                random_buffer(k_bytes, sizeof(k_bytes));
+            }
+            bn_read_be(k_bytes, &k);
+            bn_mod(&k, &secp256k1.order);
+
+            scalar52_multiply_table(&table, &k, &res);
+            scalar52_multiply_cp(&k, &ref);
+            if( !point_is_equal(&res, &ref) )
+            {
+                BoatLog(BOAT_LOG_NORMAL, "Window %d differs from the cp table.", window);
+                is_pass = BOAT_FALSE;
+            }
+        }
+        BoatFree(points_ptr);
+    }
+    BoatDisplayTestResult(is_pass, "Case_34_EcmultGenCrossCheck_3403");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_34_EcmultGenBenchmark(void)
+{
+    scalar52_gen_table table;
+    affine_point52 *points_ptr;
+    BUINT8 k_bytes[32];
+    BUINT8 pub_key65[65];
+    bignum256 k;
+    curve_point res;
+    clock_t start;
+    double build_sec;
+    double mult_sec;
+    BUINT32 i;
+    int window;
+    BBOOL is_pass = BOAT_TRUE;
+
+    memset(k_bytes, 0x35, sizeof(k_bytes));
+    keccak_256(k_bytes, 32, k_bytes);
+    bn_read_be(k_bytes, &k);
+    bn_mod(&k, &secp256k1.order);
+
+    BoatLog(BOAT_LOG_NORMAL, "window  points  memory(KiB)  build(ms)  additions  k*G(us)");
+    for( window = 2; window <= SCALAR52_GEN_MAX_WINDOW && CASE_34_TABLE_FITS(window); window++ )
+    {
+        points_ptr = BoatMalloc(SCALAR52_GEN_TABLE_POINTS(window) * sizeof(affine_point52));
+        if( points_ptr == NULL )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        start = clock();
+        scalar52_gen_table_build(&table, window, points_ptr);
+        build_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for( i = 0; i < CASE_34_BENCH_ROUNDS; i++ )
+        {
+            scalar52_multiply_table(&table, &k, &res);
+        }
+        mult_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        BoatLog(BOAT_LOG_NORMAL, "%6d  %6u  %11.1f  %9.2f  %9d  %7.2f",
+                window,
+                (BUINT32)SCALAR52_GEN_TABLE_POINTS(window),
+                SCALAR52_GEN_TABLE_POINTS(window) * sizeof(affine_point52) / 1024.0,
+                build_sec * 1e3,
+                table.windows - 1,
+                mult_sec * 1e6 / CASE_34_BENCH_ROUNDS);
+
+        BoatFree(points_ptr);
+    }
+
+    // Precomputed cp table path, i.e. USE_SECP256K1_GEN_WINDOW set to 0
+    start = clock();
+    for( i = 0; i < CASE_34_BENCH_ROUNDS; i++ )
+    {
+        scalar52_multiply_cp(&k, &res);
+    }
+    mult_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+    BoatLog(BOAT_LOG_NORMAL, "scalar52_multiply_cp: %.2f us.", mult_sec * 1e6 / CASE_34_BENCH_ROUNDS);
+
+    // Default path of signing and public key derivation (USE_SECP256K1_GEN_WINDOW)
+    ecdsa_get_public_key65(&secp256k1, k_bytes, pub_key65);
+    start = clock();
+    for( i = 0; i < CASE_34_BENCH_ROUNDS; i++ )
+    {
+        ecdsa_get_public_key65(&secp256k1, k_bytes, pub_key65);
+    }
+    mult_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+    BoatLog(BOAT_LOG_NORMAL, "ecdsa_get_public_key65 (window %d): %.2f us.",
+            USE_SECP256K1_GEN_WINDOW, mult_sec * 1e6 / CASE_34_BENCH_ROUNDS);
+
+    BoatDisplayTestResult(is_pass, "Case_34_EcmultGenBenchmark_3402");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_34_EcmultGenMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_34_EcmultGenCheck();
+    case_result += Case_34_EcmultGenCrossCheck();
+    case_result += Case_34_EcmultGenBenchmark();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_34_EcmultGenMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Fixed-base table needs USE_SECP256K1_5X52.");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
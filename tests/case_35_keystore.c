@@ -0,0 +1,296 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "persiststore.h"
+#include "keystore.h"
+#include "testcommon.h"
+
+#include <time.h>
+
+#define CASE_35_KEYSTORE_FILE "case_35_keystore.bin"
+#define CASE_35_RECORD_NUM    1000
+#define CASE_35_BENCH_ROUNDS  100000
+
+
+static void Case_35_RecordName(BCHAR *name_str, BUINT32 index)
+{
+    sprintf(name_str, "case_35_wallet_%u", index);
+}
+
+
+// Record content depends on the index and the generation it's written in
+static BUINT32 Case_35_RecordFill(BUINT8 *record_ptr, BUINT32 index, BUINT32 generation)
+{
+    BUINT32 record_len = 40 + (index * 7 + generation) % 120;
+    BUINT32 i;
+
+    for( i = 0; i < record_len; i++ )
+    {
+        record_ptr[i] = (BUINT8)(index * 31 + generation * 17 + i);
+    }
+
+    return record_len;
+}
+
+
+static BBOOL Case_35_CheckRecord(BoatKeystore *keystore_ptr, BUINT32 index, BUINT32 generation)
+{
+    BCHAR name_str[32];
+    BUINT8 expected_array[256];
+    BUINT32 expected_len;
+    const BUINT8 *record_ptr;
+    BUINT32 record_len;
+
+    Case_35_RecordName(name_str, index);
+
+    if( generation == 0 )
+    {
+        // Removed
+        return BoatKeystoreGet(keystore_ptr, name_str, &record_ptr, &record_len) != BOAT_SUCCESS;
+    }
+
+    expected_len = Case_35_RecordFill(expected_array, index, generation);
+
+    return    BoatKeystoreGet(keystore_ptr, name_str, &record_ptr, &record_len) == BOAT_SUCCESS
+           && record_len == expected_len
+           && memcmp(record_ptr, expected_array, expected_len) == 0;
+}
+
+
+static BBOOL Case_35_CheckAll(BoatKeystore *keystore_ptr, const BUINT32 *generation_array)
+{
+    BUINT32 i;
+
+    for( i = 0; i < CASE_35_RECORD_NUM; i++ )
+    {
+        if( Case_35_CheckRecord(keystore_ptr, i, generation_array[i]) != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Record %u mismatch.", i);
+            return BOAT_FALSE;
+        }
+    }
+
+    return BOAT_TRUE;
+}
+
+
+static BOAT_RESULT Case_35_KeystoreRecords(void)
+{
+    static BUINT32 generation_array[CASE_35_RECORD_NUM];
+    BoatKeystore *keystore_ptr;
+    BCHAR name_str[32];
+    BUINT8 record_array[256];
+    BUINT32 record_len;
+    BUINT32 live_num = CASE_35_RECORD_NUM;
+    BUINT32 generation;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    remove(CASE_35_KEYSTORE_FILE);
+
+    keystore_ptr = BoatKeystoreOpen(CASE_35_KEYSTORE_FILE);
+    if( keystore_ptr == NULL )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_35_KeystoreRecords_3501");
+        return BOAT_ERROR;
+    }
+
+    // Put (the index grows several times), then overwrite everything twice,
+    // which leaves enough dead space to trigger compaction
+    for( generation = 1; generation <= 3 && is_pass == BOAT_TRUE; generation++ )
+    {
+        for( i = 0; i < CASE_35_RECORD_NUM; i++ )
+        {
+            Case_35_RecordName(name_str, i);
+            record_len = Case_35_RecordFill(record_array, i, generation);
+            if( BoatKeystorePut(keystore_ptr, name_str, record_array, record_len) != BOAT_SUCCESS )
+            {
+                is_pass = BOAT_FALSE;
+                break;
+            }
+            generation_array[i] = generation;
+        }
+
+        is_pass = is_pass && Case_35_CheckAll(keystore_ptr, generation_array);
+    }
+
+    // Remove every third record
+    for( i = 0; i < CASE_35_RECORD_NUM && is_pass == BOAT_TRUE; i += 3 )
+    {
+        Case_35_RecordName(name_str, i);
+        if( BoatKeystoreRemove(keystore_ptr, name_str) != BOAT_SUCCESS )
+        {
+            is_pass = BOAT_FALSE;
+        }
+        generation_array[i] = 0;
+        live_num--;
+    }
+
+    is_pass =    is_pass
+              && BoatKeystoreRemove(keystore_ptr, "case_35_wallet_0") != BOAT_SUCCESS
+              && BoatKeystoreRecordNum(keystore_ptr) == live_num
+              && Case_35_CheckAll(keystore_ptr, generation_array);
+
+    // Reopen
+    BoatKeystoreClose(keystore_ptr);
+    keystore_ptr = BoatKeystoreOpen(CASE_35_KEYSTORE_FILE);
+
+    is_pass =    is_pass
+              && keystore_ptr != NULL
+              && BoatKeystoreRecordNum(keystore_ptr) == live_num
+              && Case_35_CheckAll(keystore_ptr, generation_array);
+
+    // Explicit compaction, then put a removed name again
+    is_pass = is_pass && BoatKeystoreCompact(keystore_ptr) == BOAT_SUCCESS;
+
+    record_len = Case_35_RecordFill(record_array, 3, 4);
+    is_pass = is_pass && BoatKeystorePut(keystore_ptr, "case_35_wallet_3", record_array, record_len) == BOAT_SUCCESS;
+    generation_array[3] = 4;
+    live_num++;
+
+    is_pass =    is_pass
+              && BoatKeystoreRecordNum(keystore_ptr) == live_num
+              && Case_35_CheckAll(keystore_ptr, generation_array);
+
+    BoatKeystoreClose(keystore_ptr);
+
+    BoatDisplayTestResult(is_pass, "Case_35_KeystoreRecords_3501");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_35_PersistStore(void)
+{
+    BoatKeystore *keystore_ptr;
+    const BUINT8 *record_ptr;
+    BUINT32 record_len;
+    BUINT8 data_array[200];
+    BUINT8 read_array[200];
+    FILE *file_ptr;
+    BBOOL is_pass;
+
+    memset(data_array, 0x35, sizeof(data_array));
+    memset(read_array, 0x00, sizeof(read_array));
+
+    is_pass =    BoatPersistStore("case_35_persist_a", data_array, sizeof(data_array)) == BOAT_SUCCESS
+              && BoatPersistRead("case_35_persist_a", read_array, sizeof(read_array)) == BOAT_SUCCESS
+              && memcmp(data_array, read_array, sizeof(data_array)) == 0
+              // Length mismatch must not decrypt
+              && BoatPersistRead("case_35_persist_a", read_array, sizeof(read_array) - 20) != BOAT_SUCCESS;
+
+#if BOAT_PERSIST_USE_KEYSTORE == 1
+    // A storage file written by an earlier version has the same format as the
+    // keystore record. Write one and check that it's imported on first read.
+    keystore_ptr = BoatKeystoreOpen(BOAT_KEYSTORE_FILE_NAME);
+    if(    keystore_ptr != NULL
+        && BoatKeystoreGet(keystore_ptr, "case_35_persist_a", &record_ptr, &record_len) == BOAT_SUCCESS )
+    {
+        file_ptr = fopen("case_35_persist_b", "wb");
+        if( file_ptr != NULL )
+        {
+            fwrite(record_ptr, 1, record_len, file_ptr);
+            fclose(file_ptr);
+        }
+    }
+    BoatKeystoreClose(keystore_ptr);
+
+    memset(read_array, 0x00, sizeof(read_array));
+    is_pass =    is_pass
+              && BoatPersistRead("case_35_persist_b", read_array, sizeof(read_array)) == BOAT_SUCCESS
+              && memcmp(data_array, read_array, sizeof(data_array)) == 0;
+
+    // Delete removes both the record and the file. Nothing is left to read.
+    is_pass =    is_pass
+              && BoatPersistDelete("case_35_persist_b") == BOAT_SUCCESS
+              && BoatPersistRead("case_35_persist_b", read_array, sizeof(read_array)) != BOAT_SUCCESS;
+#else
+    (void)keystore_ptr;
+    (void)record_ptr;
+    (void)record_len;
+    (void)file_ptr;
+#endif
+
+    is_pass =    is_pass
+              && BoatPersistDelete("case_35_persist_a") == BOAT_SUCCESS
+              && BoatPersistRead("case_35_persist_a", read_array, sizeof(read_array)) != BOAT_SUCCESS
+              && BoatPersistDelete("case_35_persist_a") != BOAT_SUCCESS;
+
+    BoatDisplayTestResult(is_pass, "Case_35_PersistStore_3502");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_35_KeystoreBenchmark(void)
+{
+    BoatKeystore *keystore_ptr;
+    BCHAR name_str[32];
+    const BUINT8 *record_ptr;
+    BUINT32 record_len;
+    BUINT32 i;
+    clock_t start;
+    double sec;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // The keystore left by Case_35_KeystoreRecords()
+    start = clock();
+    keystore_ptr = BoatKeystoreOpen(CASE_35_KEYSTORE_FILE);
+    sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if( keystore_ptr == NULL )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_35_KeystoreBenchmark_3503");
+        return BOAT_ERROR;
+    }
+
+    BoatLog(BOAT_LOG_NORMAL, "open with %u records: %.1f us.",
+            BoatKeystoreRecordNum(keystore_ptr), sec * 1e6);
+
+    start = clock();
+    for( i = 0; i < CASE_35_BENCH_ROUNDS; i++ )
+    {
+        Case_35_RecordName(name_str, (i * 7919) % CASE_35_RECORD_NUM);
+        if(    BoatKeystoreGet(keystore_ptr, name_str, &record_ptr, &record_len) != BOAT_SUCCESS
+            && (i * 7919) % CASE_35_RECORD_NUM % 3 != 0 )
+        {
+            is_pass = BOAT_FALSE;
+        }
+    }
+    sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "lookup: %.3f us.", sec * 1e6 / CASE_35_BENCH_ROUNDS);
+
+    BoatKeystoreClose(keystore_ptr);
+    remove(CASE_35_KEYSTORE_FILE);
+
+    BoatDisplayTestResult(is_pass, "Case_35_KeystoreBenchmark_3503");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_35_KeystoreMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_35_KeystoreRecords();
+    case_result += Case_35_PersistStore();
+    case_result += Case_35_KeystoreBenchmark();
+
+    return case_result;
+}
@@ -0,0 +1,296 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "persiststore.h"
+#include "testcommon.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+#if BOAT_USE_OPENSSL != 0
+
+#define CASE_37_STREAM_NAME   "case_37_stream"
+#define CASE_37_UPDATE_LEN    1000
+#define CASE_37_READ_LEN      777
+#define CASE_37_BENCH_LEN     (32 * 1024 * 1024)
+#define CASE_37_BENCH_BUF_LEN (256 * 1024)
+
+
+static BUINT8 Case_37_DataAt(BUINT32 pos)
+{
+    return (BUINT8)(pos ^ (pos >> 8) ^ (pos >> 16));
+}
+
+
+static BOAT_RESULT Case_37_Write(const BCHAR *name_str, BUINT32 total_len)
+{
+    BoatPersistWriter *writer_ptr;
+    BUINT8 buf_array[CASE_37_UPDATE_LEN];
+    BUINT32 pos = 0;
+    BUINT32 len;
+    BUINT32 i;
+
+    writer_ptr = BoatPersistWriterInit(name_str);
+    if( writer_ptr == NULL )
+    {
+        return BOAT_ERROR;
+    }
+
+    while( pos < total_len )
+    {
+        len = BOAT_MIN(CASE_37_UPDATE_LEN, total_len - pos);
+        for( i = 0; i < len; i++ )
+        {
+            buf_array[i] = Case_37_DataAt(pos + i);
+        }
+
+        if( BoatPersistWriterUpdate(writer_ptr, buf_array, len) != BOAT_SUCCESS )
+        {
+            BoatPersistWriterAbort(writer_ptr);
+            return BOAT_ERROR;
+        }
+        pos += len;
+    }
+
+    return BoatPersistWriterFinal(writer_ptr);
+}
+
+
+static BBOOL Case_37_Check(const BCHAR *name_str, BUINT32 total_len)
+{
+    BoatPersistReader *reader_ptr;
+    BUINT8 buf_array[CASE_37_READ_LEN];
+    BUINT32 pos = 0;
+    BUINT32 read_len;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    reader_ptr = BoatPersistReaderInit(name_str);
+    if( reader_ptr == NULL )
+    {
+        return BOAT_FALSE;
+    }
+
+    do
+    {
+        if( BoatPersistReaderUpdate(reader_ptr, buf_array, sizeof(buf_array), &read_len) != BOAT_SUCCESS )
+        {
+            is_pass = BOAT_FALSE;
+            break;
+        }
+
+        for( i = 0; i < read_len && is_pass == BOAT_TRUE; i++ )
+        {
+            is_pass = (buf_array[i] == Case_37_DataAt(pos + i));
+        }
+        pos += read_len;
+    }while( read_len == sizeof(buf_array) && is_pass == BOAT_TRUE );
+
+    is_pass = is_pass && (pos == total_len);
+
+    return (BoatPersistReaderFinal(reader_ptr) == BOAT_SUCCESS) && is_pass;
+}
+
+
+static BOAT_RESULT Case_37_RoundTrip(void)
+{
+    const BUINT32 len_array[] =
+    {
+        0,
+        1,
+        BOAT_PERSIST_STREAM_CHUNK_SIZE - 1,
+        BOAT_PERSIST_STREAM_CHUNK_SIZE,
+        BOAT_PERSIST_STREAM_CHUNK_SIZE + 1,
+        3 * BOAT_PERSIST_STREAM_CHUNK_SIZE,
+        5 * 1024 * 1024 + 3
+    };
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < sizeof(len_array) / sizeof(len_array[0]) && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass =    Case_37_Write(CASE_37_STREAM_NAME, len_array[i]) == BOAT_SUCCESS
+                  && Case_37_Check(CASE_37_STREAM_NAME, len_array[i]) == BOAT_TRUE;
+        if( is_pass != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Length %u failed.", len_array[i]);
+        }
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_37_StreamRoundTrip_3701");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_37_Tamper(void)
+{
+    BoatPersistWriter *writer_ptr;
+    const BUINT32 total_len = 3 * BOAT_PERSIST_STREAM_CHUNK_SIZE + 100;
+    const long chunk_len = BOAT_PERSIST_STREAM_CHUNK_SIZE + 16;
+    BUINT8 *file_ptr_array = NULL;
+    long file_size;
+    FILE *file_ptr;
+    BBOOL is_pass;
+
+    is_pass = Case_37_Write(CASE_37_STREAM_NAME, total_len) == BOAT_SUCCESS;
+
+    file_ptr = fopen(CASE_37_STREAM_NAME, "rb");
+    if( is_pass == BOAT_TRUE && file_ptr != NULL )
+    {
+        fseek(file_ptr, 0, SEEK_END);
+        file_size = ftell(file_ptr);
+        rewind(file_ptr);
+        // Test data only, kept out of the SDK allocator
+        file_ptr_array = malloc(file_size + 1);
+        is_pass = file_ptr_array != NULL && fread(file_ptr_array, 1, file_size, file_ptr) == (size_t)file_size;
+        fclose(file_ptr);
+    }
+    else
+    {
+        is_pass = BOAT_FALSE;
+        file_size = 0;
+    }
+
+    // Flipped bit in the second chunk
+    if( is_pass == BOAT_TRUE )
+    {
+        file_ptr_array[16 + chunk_len + 5] ^= 0x01;
+        file_ptr = fopen("case_37_tampered", "wb");
+        fwrite(file_ptr_array, 1, file_size, file_ptr);
+        fclose(file_ptr);
+        file_ptr_array[16 + chunk_len + 5] ^= 0x01;
+        is_pass = Case_37_Check("case_37_tampered", total_len) == BOAT_FALSE;
+    }
+
+    // Last chunk dropped: the stream ends with a full chunk
+    if( is_pass == BOAT_TRUE )
+    {
+        file_ptr = fopen("case_37_tampered", "wb");
+        fwrite(file_ptr_array, 1, 16 + 3 * chunk_len, file_ptr);
+        fclose(file_ptr);
+        is_pass = Case_37_Check("case_37_tampered", 3 * BOAT_PERSIST_STREAM_CHUNK_SIZE) == BOAT_FALSE;
+    }
+
+    // Trailing garbage
+    if( is_pass == BOAT_TRUE )
+    {
+        file_ptr_array[file_size] = 0x37;
+        file_ptr = fopen("case_37_tampered", "wb");
+        fwrite(file_ptr_array, 1, file_size + 1, file_ptr);
+        fclose(file_ptr);
+        is_pass = Case_37_Check("case_37_tampered", total_len) == BOAT_FALSE;
+    }
+    remove("case_37_tampered");
+    free(file_ptr_array);
+
+    // An aborted writer leaves the existing storage untouched
+    writer_ptr = BoatPersistWriterInit(CASE_37_STREAM_NAME);
+    is_pass =    is_pass
+              && writer_ptr != NULL
+              && BoatPersistWriterUpdate(writer_ptr, "garbage", 7) == BOAT_SUCCESS;
+    BoatPersistWriterAbort(writer_ptr);
+    is_pass = is_pass && Case_37_Check(CASE_37_STREAM_NAME, total_len) == BOAT_TRUE;
+
+    BoatDisplayTestResult(is_pass, "Case_37_StreamTamper_3702");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_37_Benchmark(void)
+{
+    BoatPersistWriter *writer_ptr;
+    BoatPersistReader *reader_ptr;
+    BUINT8 *buf_ptr;
+    BUINT32 pos;
+    BUINT32 read_len = 0;
+    BUINT32 total_read_len = 0;
+    clock_t start;
+    double write_sec;
+    double read_sec;
+    BBOOL is_pass = BOAT_FALSE;
+
+    buf_ptr = malloc(CASE_37_BENCH_BUF_LEN);
+    writer_ptr = BoatPersistWriterInit(CASE_37_STREAM_NAME);
+
+    if( buf_ptr != NULL && writer_ptr != NULL )
+    {
+        memset(buf_ptr, 0x37, CASE_37_BENCH_BUF_LEN);
+
+        start = clock();
+        is_pass = BOAT_TRUE;
+        for( pos = 0; pos < CASE_37_BENCH_LEN && is_pass == BOAT_TRUE; pos += CASE_37_BENCH_BUF_LEN )
+        {
+            is_pass = BoatPersistWriterUpdate(writer_ptr, buf_ptr, CASE_37_BENCH_BUF_LEN) == BOAT_SUCCESS;
+        }
+        is_pass = (BoatPersistWriterFinal(writer_ptr) == BOAT_SUCCESS) && is_pass;
+        write_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        reader_ptr = BoatPersistReaderInit(CASE_37_STREAM_NAME);
+        do
+        {
+            if( BoatPersistReaderUpdate(reader_ptr, buf_ptr, CASE_37_BENCH_BUF_LEN, &read_len) != BOAT_SUCCESS )
+            {
+                is_pass = BOAT_FALSE;
+                break;
+            }
+            total_read_len += read_len;
+        }while( read_len == CASE_37_BENCH_BUF_LEN );
+        is_pass = (BoatPersistReaderFinal(reader_ptr) == BOAT_SUCCESS) && is_pass && total_read_len == CASE_37_BENCH_LEN;
+        read_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        BoatLog(BOAT_LOG_NORMAL, "%u MiB in %u KiB chunks: write %.1f MB/s, read %.1f MB/s.",
+                CASE_37_BENCH_LEN >> 20, BOAT_PERSIST_STREAM_CHUNK_SIZE >> 10,
+                CASE_37_BENCH_LEN / 1e6 / write_sec, CASE_37_BENCH_LEN / 1e6 / read_sec);
+    }
+    else
+    {
+        BoatPersistWriterAbort(writer_ptr);
+    }
+
+    free(buf_ptr);
+    BoatPersistDelete(CASE_37_STREAM_NAME);
+
+    BoatDisplayTestResult(is_pass, "Case_37_StreamBenchmark_3703");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_37_PersistStreamMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_37_RoundTrip();
+    case_result += Case_37_Tamper();
+    case_result += Case_37_Benchmark();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_37_PersistStreamMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Streaming persistent storage needs OpenSSL.");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatwallet.h"
+#include "persiststore.h"
+#include "testcommon.h"
+
+#include <time.h>
+
+#define CASE_38_WALLET_NAME  "case_38_wallet"
+#define CASE_38_BENCH_ROUNDS 200
+
+
+static void Case_38_Config(BoatEthWalletConfig *config_ptr, BUINT32 seed)
+{
+    memset(config_ptr, 0x00, sizeof(BoatEthWalletConfig));
+    memset(config_ptr->priv_key_array, 0x38, 32);
+    config_ptr->priv_key_array[31] = (BUINT8)seed;
+    config_ptr->chain_id = 1;
+    config_ptr->eip155_compatibility = 0;
+    strncpy(config_ptr->node_url_str, "http://127.0.0.1:7545", BOAT_NODE_URL_MAX_LEN - 1);
+}
+
+
+// Load a persistent wallet and get its address, then unload it
+static BBOOL Case_38_Load(const BCHAR *name_str, BUINT8 address_array[20])
+{
+    BoatEthWallet *wallet_ptr;
+    BSINT32 index;
+
+    index = BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, name_str, NULL, sizeof(BoatEthWalletConfig));
+    if( index < 0 )
+    {
+        return BOAT_FALSE;
+    }
+
+    wallet_ptr = BoatGetWalletByIndex(index);
+    memcpy(address_array, wallet_ptr->account_info.address, 20);
+    BoatWalletUnload(index);
+
+    return BOAT_TRUE;
+}
+
+
+static BBOOL Case_38_Create(const BCHAR *name_str, BUINT32 seed, BUINT8 address_array[20])
+{
+    BoatEthWalletConfig config;
+    BoatEthWallet *wallet_ptr;
+    BSINT32 index;
+
+    Case_38_Config(&config, seed);
+
+    index = BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, name_str, &config, sizeof(config));
+    if( index < 0 )
+    {
+        return BOAT_FALSE;
+    }
+
+    wallet_ptr = BoatGetWalletByIndex(index);
+    memcpy(address_array, wallet_ptr->account_info.address, 20);
+    BoatWalletUnload(index);
+
+    return BOAT_TRUE;
+}
+
+
+static BOAT_RESULT Case_38_HotLoad(void)
+{
+    BUINT8 created_address[20];
+    BUINT8 loaded_address[20];
+    BBOOL is_pass;
+
+    is_pass =    Case_38_Create(CASE_38_WALLET_NAME, 1, created_address) == BOAT_TRUE
+              // Remove the storage behind the cache: a hot load must not need it
+              && BoatPersistDelete(CASE_38_WALLET_NAME) == BOAT_SUCCESS
+              && Case_38_Load(CASE_38_WALLET_NAME, loaded_address) == BOAT_TRUE
+              && memcmp(created_address, loaded_address, 20) == 0;
+
+    // Once evicted, the wallet is gone
+    BoatWalletCacheEvict(CASE_38_WALLET_NAME);
+    is_pass = is_pass && Case_38_Load(CASE_38_WALLET_NAME, loaded_address) == BOAT_FALSE;
+
+    // Cold load from the storage fills the cache again
+    memset(loaded_address, 0x00, 20);
+    is_pass =    is_pass
+              && Case_38_Create(CASE_38_WALLET_NAME, 2, created_address) == BOAT_TRUE
+              && (BoatWalletCacheEvict(CASE_38_WALLET_NAME), BOAT_TRUE)
+              && Case_38_Load(CASE_38_WALLET_NAME, loaded_address) == BOAT_TRUE
+              && memcmp(created_address, loaded_address, 20) == 0
+              && BoatPersistDelete(CASE_38_WALLET_NAME) == BOAT_SUCCESS
+              && Case_38_Load(CASE_38_WALLET_NAME, loaded_address) == BOAT_TRUE
+              && memcmp(created_address, loaded_address, 20) == 0;
+
+    // A configuration of another protocol or size never comes from the cache
+    is_pass =    is_pass
+              && BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, CASE_38_WALLET_NAME, NULL, sizeof(BoatEthWalletConfig) - 1) < 0
+              && BoatWalletCreate(BOAT_PROTOCOL_HLFABRIC, CASE_38_WALLET_NAME, NULL, sizeof(BoatEthWalletConfig)) < 0;
+
+    BoatWalletCacheEvict(CASE_38_WALLET_NAME);
+
+    BoatDisplayTestResult(is_pass, "Case_38_WalletCacheHotLoad_3801");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_38_Eviction(void)
+{
+    BCHAR name_str[32];
+    BUINT8 address_array[BOAT_WALLET_CACHE_SIZE + 1][20];
+    BUINT8 loaded_address[20];
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // One more wallet than the cache holds: the first one is least recently used
+    for( i = 0; i <= BOAT_WALLET_CACHE_SIZE && is_pass == BOAT_TRUE; i++ )
+    {
+        sprintf(name_str, "case_38_wallet_%u", i);
+        is_pass =    Case_38_Create(name_str, i + 3, address_array[i]) == BOAT_TRUE
+                  && BoatPersistDelete(name_str) == BOAT_SUCCESS;
+    }
+
+#if BOAT_WALLET_CACHE_SIZE > 0
+    is_pass = is_pass && Case_38_Load("case_38_wallet_0", loaded_address) == BOAT_FALSE;
+    for( i = 1; i <= BOAT_WALLET_CACHE_SIZE && is_pass == BOAT_TRUE; i++ )
+    {
+        sprintf(name_str, "case_38_wallet_%u", i);
+        is_pass =    Case_38_Load(name_str, loaded_address) == BOAT_TRUE
+                  && memcmp(address_array[i], loaded_address, 20) == 0;
+    }
+
+    // BoatWalletDelete() evicts as well
+    BoatWalletDelete("case_38_wallet_1");
+    is_pass = is_pass && Case_38_Load("case_38_wallet_1", loaded_address) == BOAT_FALSE;
+
+    // Clear wipes everything
+    BoatWalletCacheClear();
+    sprintf(name_str, "case_38_wallet_%u", BOAT_WALLET_CACHE_SIZE);
+    is_pass = is_pass && Case_38_Load(name_str, loaded_address) == BOAT_FALSE;
+#else
+    (void)loaded_address;
+#endif
+
+    BoatDisplayTestResult(is_pass, "Case_38_WalletCacheEviction_3802");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_38_Benchmark(void)
+{
+    BUINT8 address_array[20];
+    BUINT32 i;
+    clock_t start;
+    double cold_sec;
+    double hot_sec;
+    BBOOL is_pass;
+
+    is_pass = Case_38_Create(CASE_38_WALLET_NAME, 38, address_array) == BOAT_TRUE;
+
+    start = clock();
+    for( i = 0; i < CASE_38_BENCH_ROUNDS && is_pass == BOAT_TRUE; i++ )
+    {
+        BoatWalletCacheEvict(CASE_38_WALLET_NAME);
+        is_pass = Case_38_Load(CASE_38_WALLET_NAME, address_array);
+    }
+    cold_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( i = 0; i < CASE_38_BENCH_ROUNDS && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass = Case_38_Load(CASE_38_WALLET_NAME, address_array);
+    }
+    hot_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "wallet load: cold %.1f us, hot %.1f us.",
+            cold_sec * 1e6 / CASE_38_BENCH_ROUNDS, hot_sec * 1e6 / CASE_38_BENCH_ROUNDS);
+
+    BoatWalletDelete(CASE_38_WALLET_NAME);
+
+    BoatDisplayTestResult(is_pass, "Case_38_WalletCacheBenchmark_3803");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_38_WalletCacheMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_38_HotLoad();
+    case_result += Case_38_Eviction();
+    case_result += Case_38_Benchmark();
+
+    return case_result;
+}
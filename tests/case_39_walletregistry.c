@@ -0,0 +1,202 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatwallet.h"
+#include "testcommon.h"
+
+#include <time.h>
+
+#if BOAT_USE_STATIC_POOL == 1
+// Each wallet takes two blocks of BOAT_STATIC_POOL_1
+#define CASE_39_CAPACITY   128
+#define CASE_39_NAMED_NUM  100
+#else
+#define CASE_39_CAPACITY   20000
+#define CASE_39_NAMED_NUM  200
+#endif
+
+
+static BSINT32 Case_39_Create(const BCHAR *name_str, BUINT32 seed)
+{
+    BoatEthWalletConfig config;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, 0x39, 32);
+    config.priv_key_array[30] = (BUINT8)(seed >> 8);
+    config.priv_key_array[31] = (BUINT8)seed;
+    config.chain_id = 1;
+    strncpy(config.node_url_str, "http://127.0.0.1:7545", BOAT_NODE_URL_MAX_LEN - 1);
+
+    return BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, name_str, &config, sizeof(config));
+}
+
+
+static BOAT_RESULT Case_39_Capacity(void)
+{
+    static BSINT32 index_array[CASE_39_CAPACITY];
+    static BBOOL seen_array[CASE_39_CAPACITY];
+    BoatEthWallet *wallet_ptr;
+    BUINT32 i;
+    clock_t start;
+    double create_sec;
+    double unload_sec;
+    BBOOL is_pass = BOAT_TRUE;
+
+    memset(seen_array, 0x00, sizeof(seen_array));
+
+    start = clock();
+    for( i = 0; i < CASE_39_CAPACITY && is_pass == BOAT_TRUE; i++ )
+    {
+        index_array[i] = Case_39_Create(NULL, i + 1);
+        is_pass =    index_array[i] >= 0
+                  && index_array[i] < CASE_39_CAPACITY
+                  && seen_array[index_array[i]] == BOAT_FALSE;
+        if( is_pass == BOAT_TRUE )
+        {
+            seen_array[index_array[i]] = BOAT_TRUE;
+        }
+    }
+    create_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    // Full
+    is_pass = is_pass && Case_39_Create(NULL, 1) < 0;
+
+    // Every wallet is still reachable by its index after the list has grown
+    for( i = 0; i < CASE_39_CAPACITY && is_pass == BOAT_TRUE; i++ )
+    {
+        wallet_ptr = BoatGetWalletByIndex(index_array[i]);
+        is_pass =    wallet_ptr != NULL
+                  && wallet_ptr->account_info.priv_key_array[30] == (BUINT8)((i + 1) >> 8)
+                  && wallet_ptr->account_info.priv_key_array[31] == (BUINT8)(i + 1);
+    }
+
+    // Freed indices are reused
+    for( i = 0; i < CASE_39_CAPACITY && is_pass == BOAT_TRUE; i += 2 )
+    {
+        BoatWalletUnload(index_array[i]);
+        is_pass = BoatGetWalletByIndex(index_array[i]) == NULL;
+    }
+    for( i = 0; i < CASE_39_CAPACITY && is_pass == BOAT_TRUE; i += 2 )
+    {
+        index_array[i] = Case_39_Create(NULL, i + 1);
+        is_pass = index_array[i] >= 0;
+    }
+    is_pass = is_pass && Case_39_Create(NULL, 1) < 0;
+
+    start = clock();
+    for( i = 0; i < CASE_39_CAPACITY; i++ )
+    {
+        BoatWalletUnload(index_array[i]);
+    }
+    unload_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "%u wallets: create %.1f us, unload %.1f us per wallet.",
+            CASE_39_CAPACITY, create_sec * 1e6 / CASE_39_CAPACITY, unload_sec * 1e6 / CASE_39_CAPACITY);
+
+    BoatDisplayTestResult(is_pass, "Case_39_WalletRegistryCapacity_3901");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_39_Names(void)
+{
+    static BSINT32 index_array[CASE_39_NAMED_NUM];
+    BCHAR name_str[32];
+    BSINT32 index;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < CASE_39_NAMED_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        sprintf(name_str, "case_39_wallet_%u", i);
+        index_array[i] = Case_39_Create(name_str, i + 1);
+        is_pass = index_array[i] >= 0;
+    }
+
+    for( i = 0; i < CASE_39_NAMED_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        sprintf(name_str, "case_39_wallet_%u", i);
+        is_pass = BoatGetWalletIndexByName(name_str) == index_array[i];
+    }
+
+    is_pass =    is_pass
+              && BoatGetWalletIndexByName("case_39_wallet_x") < 0
+              && BoatGetWalletIndexByName(NULL) < 0;
+
+    // Unloaded wallets are no longer found
+    for( i = 0; i < CASE_39_NAMED_NUM && is_pass == BOAT_TRUE; i += 3 )
+    {
+        sprintf(name_str, "case_39_wallet_%u", i);
+        BoatWalletUnload(index_array[i]);
+        is_pass = BoatGetWalletIndexByName(name_str) < 0;
+        index_array[i] = -1;
+    }
+    for( i = 0; i < CASE_39_NAMED_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        sprintf(name_str, "case_39_wallet_%u", i);
+        is_pass = BoatGetWalletIndexByName(name_str) == index_array[i];
+    }
+
+    // A name loaded twice maps to the last loaded wallet, and to nothing once that's unloaded
+    index = BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, "case_39_wallet_1", NULL, sizeof(BoatEthWalletConfig));
+    is_pass =    is_pass
+              && index >= 0
+              && BoatGetWalletIndexByName("case_39_wallet_1") == index;
+    BoatWalletUnload(index);
+    is_pass = is_pass && BoatGetWalletIndexByName("case_39_wallet_1") < 0;
+
+    // A deleted wallet stays loaded as a one-time wallet
+    BoatWalletDelete("case_39_wallet_2");
+    is_pass =    is_pass
+              && BoatGetWalletIndexByName("case_39_wallet_2") < 0
+              && BoatGetWalletByIndex(index_array[2]) != NULL;
+
+    for( i = 0; i < CASE_39_NAMED_NUM; i++ )
+    {
+        sprintf(name_str, "case_39_wallet_%u", i);
+        BoatWalletUnload(index_array[i]);
+        BoatWalletDelete(name_str);
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_39_WalletRegistryNames_3902");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_39_WalletRegistryMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    BoatIotSdkDeInit();
+
+    if(    BoatIotSdkInitWithCapacity(0) == BOAT_SUCCESS
+        || BoatIotSdkInitWithCapacity(CASE_39_CAPACITY) != BOAT_SUCCESS )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_39_WalletRegistryCapacity_3901");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_39_Capacity();
+    case_result += Case_39_Names();
+
+    BoatIotSdkDeInit();
+    BoatIotSdkInit();
+
+    return case_result;
+}
@@ -0,0 +1,281 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "boatwallet.h"
+#include "web3intf.h"
+#include "testcommon.h"
+
+#include <pthread.h>
+
+#define CASE_40_THREAD_NUM  8
+#define CASE_40_ROUNDS      200
+#define CASE_40_NAMED_EVERY 8
+
+
+typedef struct TCase40Thread
+{
+    pthread_t thread;
+    BUINT32 thread_id;
+    BBOOL is_pass;
+    void *ptr;
+}Case40Thread;
+
+
+static BSINT32 Case_40_Create(const BCHAR *name_str, BUINT32 thread_id, BUINT32 round)
+{
+    BoatEthWalletConfig config;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, 0x40, 32);
+    config.priv_key_array[29] = (BUINT8)thread_id;
+    config.priv_key_array[30] = (BUINT8)(round >> 8);
+    config.priv_key_array[31] = (BUINT8)round;
+    config.chain_id = 1;
+    strncpy(config.node_url_str, "http://127.0.0.1:7545", BOAT_NODE_URL_MAX_LEN - 1);
+
+    return BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, name_str, &config, sizeof(config));
+}
+
+
+// Each thread loads and unloads its own one-time and persistent wallets
+static void *Case_40_CreateThread(void *arg)
+{
+    Case40Thread *thread_ptr = arg;
+    BoatEthWallet *wallet_ptr;
+    BCHAR name_str[32];
+    BCHAR *wallet_name_str;
+    BSINT32 index;
+    BUINT32 round;
+
+    thread_ptr->is_pass = BOAT_TRUE;
+
+    for( round = 0; round < CASE_40_ROUNDS && thread_ptr->is_pass == BOAT_TRUE; round++ )
+    {
+        sprintf(name_str, "case_40_wallet_%u", thread_ptr->thread_id);
+        wallet_name_str = (round % CASE_40_NAMED_EVERY == 0) ? name_str : NULL;
+
+        index = Case_40_Create(wallet_name_str, thread_ptr->thread_id, round);
+        wallet_ptr = BoatGetWalletByIndex(index);
+
+        thread_ptr->is_pass =    index >= 0
+                              && wallet_ptr != NULL
+                              && wallet_ptr->account_info.priv_key_array[29] == (BUINT8)thread_ptr->thread_id
+                              && wallet_ptr->account_info.priv_key_array[30] == (BUINT8)(round >> 8)
+                              && wallet_ptr->account_info.priv_key_array[31] == (BUINT8)round
+                              && (   wallet_name_str == NULL
+                                  || BoatGetWalletIndexByName(wallet_name_str) == index);
+
+        BoatWalletUnload(index);
+
+        thread_ptr->is_pass =    thread_ptr->is_pass
+                              && (   wallet_name_str == NULL
+                                  || BoatGetWalletIndexByName(wallet_name_str) < 0);
+    }
+
+    sprintf(name_str, "case_40_wallet_%u", thread_ptr->thread_id);
+    BoatWalletDelete(name_str);
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_40_ConcurrentCreate(void)
+{
+    Case40Thread thread_array[CASE_40_THREAD_NUM];
+    BSINT32 index_array[CASE_40_THREAD_NUM];
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        thread_array[i].thread_id = i;
+        thread_array[i].is_pass = BOAT_FALSE;
+        is_pass = is_pass && pthread_create(&thread_array[i].thread, NULL, Case_40_CreateThread, &thread_array[i]) == 0;
+    }
+
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        pthread_join(thread_array[i].thread, NULL);
+        is_pass = is_pass && thread_array[i].is_pass;
+    }
+
+    // Every index has been freed: the registry is full again after loading its capacity
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        index_array[i] = Case_40_Create(NULL, 0, i);
+        is_pass = is_pass && index_array[i] >= 0;
+    }
+    is_pass = is_pass && Case_40_Create(NULL, 0, 0) < 0;
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        BoatWalletUnload(index_array[i]);
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_40_ThreadSafetyCreate_4001");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void *Case_40_UnloadThread(void *arg)
+{
+    Case40Thread *thread_ptr = arg;
+
+    BoatWalletUnload(thread_ptr->thread_id);
+    thread_ptr->is_pass = BoatGetWalletByIndex(thread_ptr->thread_id) == NULL;
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_40_Reference(void)
+{
+    Case40Thread unload_thread;
+    BoatEthWallet *wallet_ptr;
+    BSINT32 index;
+    BSINT32 other_index;
+    BBOOL is_pass;
+
+    index = Case_40_Create("case_40_wallet_ref", 0, 40);
+    wallet_ptr = BoatWalletAcquire(index);
+    is_pass =    wallet_ptr != NULL
+              && wallet_ptr == BoatGetWalletByIndex(index);
+
+    // Another thread unloads the wallet while it's referenced
+    unload_thread.thread_id = index;
+    unload_thread.is_pass = BOAT_FALSE;
+    is_pass =    is_pass
+              && pthread_create(&unload_thread.thread, NULL, Case_40_UnloadThread, &unload_thread) == 0
+              && pthread_join(unload_thread.thread, NULL) == 0
+              && unload_thread.is_pass == BOAT_TRUE;
+
+    // It can't be found or referenced any more, but stays valid for the holder
+    is_pass =    is_pass
+              && BoatGetWalletIndexByName("case_40_wallet_ref") < 0
+              && BoatWalletAcquire(index) == NULL
+              && wallet_ptr->account_info.priv_key_array[31] == 40
+              && wallet_ptr->network_info.chain_id == 1;
+
+    // Its index is not reused until released
+    other_index = Case_40_Create(NULL, 0, 41);
+    is_pass = is_pass && other_index >= 0 && other_index != index;
+    BoatWalletUnload(other_index);
+
+    BoatWalletRelease(index);
+    other_index = Case_40_Create(NULL, 0, 42);
+    is_pass = is_pass && other_index == index;
+    BoatWalletUnload(other_index);
+
+    // Unloading twice is harmless
+    BoatWalletUnload(index);
+    is_pass = is_pass && BoatWalletAcquire(-1) == NULL;
+
+    BoatWalletDelete("case_40_wallet_ref");
+
+    BoatDisplayTestResult(is_pass, "Case_40_ThreadSafetyReference_4002");
+
+    return BOAT_SUCCESS;
+}
+
+
+static pthread_barrier_t g_case_40_barrier;
+
+static void *Case_40_Web3Thread(void *arg)
+{
+    Case40Thread *thread_ptr = arg;
+
+    thread_ptr->ptr = web3_thread_context();
+    thread_ptr->is_pass =    thread_ptr->ptr != NULL
+                          && thread_ptr->ptr == web3_thread_context();
+
+    // All contexts are alive until every thread has got its own
+    pthread_barrier_wait(&g_case_40_barrier);
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_40_Web3Context(void)
+{
+    Case40Thread thread_array[CASE_40_THREAD_NUM];
+    Web3IntfContext *main_context_ptr;
+    BUINT32 i;
+    BUINT32 j;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // Taken before any thread exits, whose context memory may be reused
+    main_context_ptr = web3_thread_context();
+
+    pthread_barrier_init(&g_case_40_barrier, NULL, CASE_40_THREAD_NUM + 1);
+
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        thread_array[i].is_pass = BOAT_FALSE;
+        if( pthread_create(&thread_array[i].thread, NULL, Case_40_Web3Thread, &thread_array[i]) != 0 )
+        {
+            BoatDisplayTestResult(BOAT_FALSE, "Case_40_ThreadSafetyWeb3Context_4003");
+            return BOAT_ERROR;
+        }
+    }
+
+    pthread_barrier_wait(&g_case_40_barrier);
+
+    for( i = 0; i < CASE_40_THREAD_NUM; i++ )
+    {
+        pthread_join(thread_array[i].thread, NULL);
+        is_pass =    is_pass
+                  && thread_array[i].is_pass
+                  && thread_array[i].ptr != main_context_ptr;
+
+        for( j = 0; j < i; j++ )
+        {
+            is_pass = is_pass && thread_array[i].ptr != thread_array[j].ptr;
+        }
+    }
+
+    pthread_barrier_destroy(&g_case_40_barrier);
+
+    BoatDisplayTestResult(is_pass, "Case_40_ThreadSafetyWeb3Context_4003");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_40_ThreadSafetyMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    // Each thread has one wallet loaded at a time
+    BoatIotSdkDeInit();
+
+    if( BoatIotSdkInitWithCapacity(CASE_40_THREAD_NUM) != BOAT_SUCCESS )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_40_ThreadSafetyCreate_4001");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_40_ConcurrentCreate();
+    case_result += Case_40_Reference();
+    case_result += Case_40_Web3Context();
+
+    BoatIotSdkDeInit();
+    BoatIotSdkInit();
+
+    return case_result;
+}
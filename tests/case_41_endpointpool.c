@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "web3intf.h"
+#include "rpcintf.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#include <pthread.h>
+
+#define CASE_41_REQUEST_NUM 50
+#define CASE_41_THREAD_NUM  4
+
+#define CASE_41_RESULT_STR "\"0x4a817c800\""
+
+
+// The node answers every request with the same gas price
+static const BCHAR *Case_41_NodeResult(const BCHAR *request_str)
+{
+    (void)request_str;
+
+    return CASE_41_RESULT_STR;
+}
+
+
+
+
+static BBOOL Case_41_Request(void)
+{
+    Web3IntfContext *web3intf_context_ptr = web3_thread_context();
+    BCHAR *response_str;
+
+    if( web3intf_context_ptr == NULL )
+    {
+        return BOAT_FALSE;
+    }
+
+    response_str = web3_eth_gasPrice(web3intf_context_ptr, (BCHAR *)TestNodeUrl());
+
+    return response_str != NULL && strstr(response_str, "0x4a817c800") != NULL;
+}
+
+
+static BOAT_RESULT Case_41_KeepAlive(void)
+{
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    RpcCleanup();
+    TestNodeResetAcceptNum();
+
+    for( i = 0; i < CASE_41_REQUEST_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass = Case_41_Request();
+    }
+
+    // One connection serves all requests
+    is_pass = is_pass && TestNodeAcceptNum() == 1;
+
+    BoatDisplayTestResult(is_pass, "Case_41_EndpointPoolKeepAlive_4101");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void *Case_41_RequestThread(void *arg)
+{
+    BBOOL *is_pass_ptr = arg;
+    BUINT32 i;
+
+    *is_pass_ptr = BOAT_TRUE;
+    for( i = 0; i < CASE_41_REQUEST_NUM && *is_pass_ptr == BOAT_TRUE; i++ )
+    {
+        *is_pass_ptr = Case_41_Request();
+    }
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_41_Concurrent(void)
+{
+    pthread_t thread_array[CASE_41_THREAD_NUM];
+    BBOOL is_pass_array[CASE_41_THREAD_NUM];
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    RpcCleanup();
+    TestNodeResetAcceptNum();
+
+    for( i = 0; i < CASE_41_THREAD_NUM; i++ )
+    {
+        is_pass_array[i] = BOAT_FALSE;
+        is_pass = is_pass && pthread_create(&thread_array[i], NULL, Case_41_RequestThread, &is_pass_array[i]) == 0;
+    }
+    for( i = 0; i < CASE_41_THREAD_NUM; i++ )
+    {
+        pthread_join(thread_array[i], NULL);
+        is_pass = is_pass && is_pass_array[i];
+    }
+
+    // Connections are shared by all threads: no more than concurrent requests
+    is_pass = is_pass && TestNodeAcceptNum() <= CASE_41_THREAD_NUM;
+
+    BoatLog(BOAT_LOG_NORMAL, "%u requests from %u threads over %u connections.",
+            CASE_41_REQUEST_NUM * CASE_41_THREAD_NUM, CASE_41_THREAD_NUM,
+            TestNodeAcceptNum());
+
+    BoatDisplayTestResult(is_pass, "Case_41_EndpointPoolConcurrent_4102");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_41_Benchmark(void)
+{
+    BUINT32 i;
+    double start;
+    double pooled_sec;
+    double unpooled_sec;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // Dropping the pool before each request makes every request connect
+    start = TestNow();
+    for( i = 0; i < CASE_41_REQUEST_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        RpcCleanup();
+        is_pass = Case_41_Request();
+    }
+    unpooled_sec = TestNow() - start;
+
+    start = TestNow();
+    for( i = 0; i < CASE_41_REQUEST_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass = Case_41_Request();
+    }
+    pooled_sec = TestNow() - start;
+
+    BoatLog(BOAT_LOG_NORMAL, "RPC request: new connection %.1f us, pooled %.1f us.",
+            unpooled_sec * 1e6 / CASE_41_REQUEST_NUM, pooled_sec * 1e6 / CASE_41_REQUEST_NUM);
+
+    BoatDisplayTestResult(is_pass, "Case_41_EndpointPoolBenchmark_4103");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_41_EndpointPoolMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    if( TestNodeStart(Case_41_NodeResult) != BOAT_TRUE )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_41_EndpointPoolKeepAlive_4101");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_41_KeepAlive();
+    case_result += Case_41_Concurrent();
+    case_result += Case_41_Benchmark();
+
+    RpcCleanup();
+    TestNodeStop();
+
+    return case_result;
+}
@@ -0,0 +1,477 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatethereum.h"
+#include "testcommon.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define CASE_42_MANAGER_NUM    3
+#define CASE_42_SIGNER_NUM     4
+#define CASE_42_MANAGER_ROUNDS 300
+
+
+typedef struct TCase42Thread
+{
+    pthread_t thread;
+    BUINT32 thread_id;
+    BBOOL is_pass;
+    BoatEthWallet *wallet_ptr;
+}Case42Thread;
+
+// Address and signed transaction of each manager thread's account
+static BUINT8 g_case_42_address[CASE_42_MANAGER_NUM][BOAT_ETH_ADDRESS_SIZE];
+static BoatFieldVariable g_case_42_ref_tx[CASE_42_MANAGER_NUM];
+static BUINT32 g_case_42_running_num;
+
+
+static BSINT32 Case_42_Create(BUINT8 key_byte)
+{
+    BoatEthWalletConfig config;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, key_byte, 32);
+    config.chain_id = 1;
+    strncpy(config.node_url_str, "http://127.0.0.1:7545", BOAT_NODE_URL_MAX_LEN - 1);
+
+    return BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, NULL, &config, sizeof(config));
+}
+
+
+static void Case_42_TxInit(BoatEthTx *tx_ptr, BoatEthWallet *wallet_ptr)
+{
+    memset(tx_ptr, 0x00, sizeof(BoatEthTx));
+
+    tx_ptr->wallet_ptr = wallet_ptr;
+
+    tx_ptr->rawtx_fields.nonce.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.nonce.field, 7, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gasprice.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gasprice.field, 1000000000u, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gaslimit.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gaslimit.field, 21000, TRIMBIN_LEFTTRIM);
+    memset(tx_ptr->rawtx_fields.recipient, 0x5a, BOAT_ETH_ADDRESS_SIZE);
+    tx_ptr->rawtx_fields.value.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.value.field, 1000000u, TRIMBIN_LEFTTRIM);
+}
+
+
+static BOAT_RESULT Case_42_Manage(void)
+{
+    BoatEthWallet *wallet_ptr;
+    BoatEthWallet *other_wallet_ptr;
+    BUINT8 priv_key_array[32];
+    BSINT32 index;
+    BSINT32 other_index;
+    BSINT32 account_index;
+    BSINT32 i;
+    BBOOL is_pass;
+
+    index = Case_42_Create(0x42);
+    other_index = Case_42_Create(0x43);
+    wallet_ptr = BoatGetWalletByIndex(index);
+    other_wallet_ptr = BoatGetWalletByIndex(other_index);
+
+    is_pass = wallet_ptr != NULL && other_wallet_ptr != NULL;
+
+    // Account 0 is the wallet's own account
+    is_pass =    is_pass
+              && wallet_ptr->selected_account_index == 0
+              && BoatEthWalletGetAccount(wallet_ptr, 0) == &wallet_ptr->account_info
+              && BoatEthWalletGetAccount(wallet_ptr, 1) == NULL
+              && BoatEthWalletFindAccount(wallet_ptr, wallet_ptr->account_info.address) == 0;
+
+    // An added account has the address of its key
+    memset(priv_key_array, 0x43, 32);
+    account_index = is_pass ? BoatEthWalletAddAccount(wallet_ptr, priv_key_array) : BOAT_ERROR;
+    is_pass =    is_pass
+              && account_index == 1
+              && BoatEthWalletFindAccount(wallet_ptr, other_wallet_ptr->account_info.address) == 1
+              && memcmp(BoatEthWalletGetAccount(wallet_ptr, 1)->pub_key_array,
+                        other_wallet_ptr->account_info.pub_key_array, 64) == 0;
+
+    // Adding an account twice keeps its index
+    is_pass =    is_pass
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == 1
+              && BoatEthWalletAddAccount(wallet_ptr, wallet_ptr->account_info.priv_key_array) == 0;
+
+    // Invalid keys are rejected
+    memset(priv_key_array, 0x00, 32);
+    is_pass =    is_pass
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == BOAT_ERROR_INVALID_ARGUMENT
+              && BoatEthWalletAddAccount(NULL, priv_key_array) == BOAT_ERROR_INVALID_ARGUMENT;
+
+    // The wallet is full after adding BOAT_ETH_MAX_ACCOUNT_NUM - 2 more accounts
+    for( i = 2; i < BOAT_ETH_MAX_ACCOUNT_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        memset(priv_key_array, 0x50 + i, 32);
+        is_pass = BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == i;
+    }
+    memset(priv_key_array, 0x7f, 32);
+    is_pass = is_pass && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == BOAT_ERROR;
+
+    // Removing the selected account selects account 0, and frees its index
+    is_pass =    is_pass
+              && BoatEthWalletSelectAccount(wallet_ptr, 3) == BOAT_SUCCESS
+              && wallet_ptr->selected_account_index == 3
+              && BoatEthWalletRemoveAccount(wallet_ptr, 3) == BOAT_SUCCESS
+              && wallet_ptr->selected_account_index == 0
+              && BoatEthWalletGetAccount(wallet_ptr, 3) == NULL
+              && BoatEthWalletSelectAccount(wallet_ptr, 3) == BOAT_ERROR_INVALID_ARGUMENT
+              && BoatEthWalletRemoveAccount(wallet_ptr, 3) == BOAT_ERROR_INVALID_ARGUMENT
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == 3;
+
+    // Account 0 can't be removed
+    is_pass =    is_pass
+              && BoatEthWalletRemoveAccount(wallet_ptr, 0) == BOAT_ERROR_INVALID_ARGUMENT
+              && BoatEthWalletSelectAccount(wallet_ptr, BOAT_ETH_MAX_ACCOUNT_NUM) == BOAT_ERROR_INVALID_ARGUMENT;
+
+    // Added accounts are wiped with the wallet
+    BoatWalletUnload(index);
+    BoatWalletUnload(other_index);
+
+    BoatDisplayTestResult(is_pass, "Case_42_MultiAccountManage_4201");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_42_SignByAccount(void)
+{
+    BoatEthWallet *wallet_ptr;
+    BoatEthWallet *other_wallet_ptr;
+    BoatEthTx tx;
+    BoatFieldVariable signed_tx = {NULL, 0};
+    BoatFieldVariable other_signed_tx = {NULL, 0};
+    BoatFieldVariable own_signed_tx = {NULL, 0};
+    BUINT8 priv_key_array[32];
+    BSINT32 index;
+    BSINT32 other_index;
+    BBOOL is_pass;
+
+    index = Case_42_Create(0x42);
+    other_index = Case_42_Create(0x43);
+    wallet_ptr = BoatGetWalletByIndex(index);
+    other_wallet_ptr = BoatGetWalletByIndex(other_index);
+
+    memset(priv_key_array, 0x43, 32);
+    is_pass =    wallet_ptr != NULL
+              && other_wallet_ptr != NULL
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == 1;
+
+    // A transaction signed by account 1 is the one the other wallet signs
+    if( is_pass == BOAT_TRUE )
+    {
+        Case_42_TxInit(&tx, wallet_ptr);
+        is_pass =    BoatEthTxSetAccount(&tx, 1) == BOAT_SUCCESS
+                  && EthSignRawtx(&tx, &signed_tx) == BOAT_SUCCESS;
+
+        Case_42_TxInit(&tx, other_wallet_ptr);
+        is_pass = is_pass && EthSignRawtx(&tx, &other_signed_tx) == BOAT_SUCCESS;
+
+        // Transactions without an account set are signed by account 0
+        Case_42_TxInit(&tx, wallet_ptr);
+        is_pass = is_pass && EthSignRawtx(&tx, &own_signed_tx) == BOAT_SUCCESS;
+
+        is_pass =    is_pass
+                  && signed_tx.field_len == other_signed_tx.field_len
+                  && memcmp(signed_tx.field_ptr, other_signed_tx.field_ptr, signed_tx.field_len) == 0
+                  && (   own_signed_tx.field_len != signed_tx.field_len
+                      || memcmp(own_signed_tx.field_ptr, signed_tx.field_ptr, signed_tx.field_len) != 0);
+
+        // A removed account can't sign
+        Case_42_TxInit(&tx, wallet_ptr);
+        tx.account_index = 1;
+        is_pass =    is_pass
+                  && BoatEthWalletRemoveAccount(wallet_ptr, 1) == BOAT_SUCCESS
+                  && BoatEthTxSetAccount(&tx, 1) == BOAT_ERROR_INVALID_ARGUMENT
+                  && BoatEthTxSetAccount(&tx, 2) == BOAT_ERROR_INVALID_ARGUMENT;
+        BoatFree(signed_tx.field_ptr);
+        signed_tx.field_ptr = NULL;
+        is_pass = is_pass && EthSignRawtx(&tx, &signed_tx) == BOAT_ERROR_INVALID_ARGUMENT;
+    }
+
+    BoatFree(signed_tx.field_ptr);
+    BoatFree(other_signed_tx.field_ptr);
+    BoatFree(own_signed_tx.field_ptr);
+
+    BoatWalletUnload(index);
+    BoatWalletUnload(other_index);
+
+    BoatDisplayTestResult(is_pass, "Case_42_MultiAccountSign_4202");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Each manager thread adds, selects and removes its own account
+static void *Case_42_ManagerThread(void *arg)
+{
+    Case42Thread *thread_ptr = arg;
+    BoatEthTx tx;
+    BoatFieldVariable signed_tx = {NULL, 0};
+    BUINT8 priv_key_array[32];
+    BSINT32 account_index;
+    BUINT32 round;
+
+    memset(priv_key_array, 0x44 + thread_ptr->thread_id, 32);
+    thread_ptr->is_pass = BOAT_TRUE;
+
+    for( round = 0; round < CASE_42_MANAGER_ROUNDS && thread_ptr->is_pass == BOAT_TRUE; round++ )
+    {
+        account_index = BoatEthWalletAddAccount(thread_ptr->wallet_ptr, priv_key_array);
+
+        // No other thread has taken the index or replaced the account
+        thread_ptr->is_pass =    account_index >= 1
+                              && BoatEthWalletFindAccount(thread_ptr->wallet_ptr,
+                                                          g_case_42_address[thread_ptr->thread_id]) == account_index
+                              && BoatEthWalletSelectAccount(thread_ptr->wallet_ptr, account_index) == BOAT_SUCCESS;
+
+        // Sign with the account, and let the signers in while it's there
+        Case_42_TxInit(&tx, thread_ptr->wallet_ptr);
+        thread_ptr->is_pass =    thread_ptr->is_pass
+                              && BoatEthTxSetAccount(&tx, account_index) == BOAT_SUCCESS
+                              && EthSignRawtx(&tx, &signed_tx) == BOAT_SUCCESS
+                              && signed_tx.field_len == g_case_42_ref_tx[thread_ptr->thread_id].field_len
+                              && memcmp(signed_tx.field_ptr, g_case_42_ref_tx[thread_ptr->thread_id].field_ptr,
+                                        signed_tx.field_len) == 0;
+        BoatFree(signed_tx.field_ptr);
+        signed_tx.field_ptr = NULL;
+        sched_yield();
+
+        thread_ptr->is_pass =    thread_ptr->is_pass
+                              && BoatEthWalletRemoveAccount(thread_ptr->wallet_ptr, account_index) == BOAT_SUCCESS;
+    }
+
+    __atomic_sub_fetch(&g_case_42_running_num, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+
+// Signer threads sign with whatever accounts are there while managers run
+static void *Case_42_SignerThread(void *arg)
+{
+    Case42Thread *thread_ptr = arg;
+    BoatEthTx tx;
+    BoatFieldVariable signed_tx;
+    BOAT_RESULT result;
+    BUINT32 round = 0;
+    BUINT32 i;
+
+    thread_ptr->is_pass = BOAT_TRUE;
+
+    while(    __atomic_load_n(&g_case_42_running_num, __ATOMIC_ACQUIRE) != 0
+           && thread_ptr->is_pass == BOAT_TRUE )
+    {
+        Case_42_TxInit(&tx, thread_ptr->wallet_ptr);
+        tx.account_index = 1 + (thread_ptr->thread_id + round++) % CASE_42_MANAGER_NUM;
+
+        result = EthSignRawtx(&tx, &signed_tx);
+        if( result == BOAT_SUCCESS )
+        {
+            // Signed by one of the accounts, never by a wiped one
+            thread_ptr->is_pass = BOAT_FALSE;
+            for( i = 0; i < CASE_42_MANAGER_NUM; i++ )
+            {
+                if(    signed_tx.field_len == g_case_42_ref_tx[i].field_len
+                    && memcmp(signed_tx.field_ptr, g_case_42_ref_tx[i].field_ptr, signed_tx.field_len) == 0 )
+                {
+                    thread_ptr->is_pass = BOAT_TRUE;
+                }
+            }
+            BoatFree(signed_tx.field_ptr);
+        }
+        else
+        {
+            // The account is not there at the moment
+            thread_ptr->is_pass = (result == BOAT_ERROR_INVALID_ARGUMENT);
+        }
+    }
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_42_Concurrent(void)
+{
+    Case42Thread manager_array[CASE_42_MANAGER_NUM];
+    Case42Thread signer_array[CASE_42_SIGNER_NUM];
+    BoatEthWallet *wallet_ptr;
+    BoatEthWallet *ref_wallet_ptr;
+    BoatEthTx tx;
+    BSINT32 index;
+    BSINT32 ref_index;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    index = Case_42_Create(0x42);
+    wallet_ptr = BoatGetWalletByIndex(index);
+    is_pass = wallet_ptr != NULL;
+
+    // References from wallets whose account 0 is the account of a manager
+    for( i = 0; i < CASE_42_MANAGER_NUM; i++ )
+    {
+        g_case_42_ref_tx[i].field_ptr = NULL;
+        ref_index = Case_42_Create(0x44 + i);
+        ref_wallet_ptr = BoatGetWalletByIndex(ref_index);
+        if( ref_wallet_ptr != NULL )
+        {
+            memcpy(g_case_42_address[i], ref_wallet_ptr->account_info.address, BOAT_ETH_ADDRESS_SIZE);
+            Case_42_TxInit(&tx, ref_wallet_ptr);
+            is_pass = is_pass && EthSignRawtx(&tx, &g_case_42_ref_tx[i]) == BOAT_SUCCESS;
+        }
+        else
+        {
+            is_pass = BOAT_FALSE;
+        }
+        BoatWalletUnload(ref_index);
+    }
+
+    g_case_42_running_num = CASE_42_MANAGER_NUM;
+    for( i = 0; i < CASE_42_MANAGER_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        manager_array[i].thread_id = i;
+        manager_array[i].wallet_ptr = wallet_ptr;
+        is_pass = pthread_create(&manager_array[i].thread, NULL, Case_42_ManagerThread, &manager_array[i]) == 0;
+    }
+    for( i = 0; i < CASE_42_SIGNER_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        signer_array[i].thread_id = i;
+        signer_array[i].wallet_ptr = wallet_ptr;
+        is_pass = pthread_create(&signer_array[i].thread, NULL, Case_42_SignerThread, &signer_array[i]) == 0;
+    }
+
+    if( is_pass == BOAT_TRUE )
+    {
+        for( i = 0; i < CASE_42_MANAGER_NUM; i++ )
+        {
+            pthread_join(manager_array[i].thread, NULL);
+            is_pass = is_pass && manager_array[i].is_pass;
+        }
+        for( i = 0; i < CASE_42_SIGNER_NUM; i++ )
+        {
+            pthread_join(signer_array[i].thread, NULL);
+            is_pass = is_pass && signer_array[i].is_pass;
+        }
+    }
+
+    // Only account 0 is left, and selected again
+    for( i = 1; i < BOAT_ETH_MAX_ACCOUNT_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass = BoatEthWalletGetAccount(wallet_ptr, i) == NULL;
+    }
+    is_pass = is_pass && wallet_ptr->selected_account_index == 0;
+
+    for( i = 0; i < CASE_42_MANAGER_NUM; i++ )
+    {
+        BoatFree(g_case_42_ref_tx[i].field_ptr);
+    }
+    BoatWalletUnload(index);
+
+    BoatDisplayTestResult(is_pass, "Case_42_MultiAccountConcurrent_4203");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BUINT32 g_case_42_set_done;
+
+static void *Case_42_SetPrivkeyThread(void *arg)
+{
+    BUINT8 priv_key_array[32];
+    BOAT_RESULT result;
+
+    memset(priv_key_array, 0x47, 32);
+    result = BoatEthWalletSetPrivkey(arg, priv_key_array);
+    __atomic_store_n(&g_case_42_set_done, (result == BOAT_SUCCESS) ? 1 : 2, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+
+// The key of account 0 isn't replaced while a transaction is being signed by it
+static BOAT_RESULT Case_42_SetPrivkey(void)
+{
+    BoatEthWallet *wallet_ptr;
+    BoatEthWallet *ref_wallet_ptr;
+    BoatEthAccountInfo *account_ptr = NULL;
+    BUINT8 old_address[BOAT_ETH_ADDRESS_SIZE];
+    pthread_t thread;
+    BSINT32 index;
+    BSINT32 ref_index;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    index = Case_42_Create(0x42);
+    ref_index = Case_42_Create(0x47);
+    wallet_ptr = BoatGetWalletByIndex(index);
+    ref_wallet_ptr = BoatGetWalletByIndex(ref_index);
+    is_pass = wallet_ptr != NULL && ref_wallet_ptr != NULL;
+
+    if( is_pass == BOAT_TRUE )
+    {
+        memcpy(old_address, wallet_ptr->account_info.address, BOAT_ETH_ADDRESS_SIZE);
+        account_ptr = BoatEthWalletAcquireAccount(wallet_ptr, 0);
+        __atomic_store_n(&g_case_42_set_done, 0, __ATOMIC_RELAXED);
+        is_pass =    account_ptr != NULL
+                  && pthread_create(&thread, NULL, Case_42_SetPrivkeyThread, wallet_ptr) == 0;
+    }
+
+    if( is_pass == BOAT_TRUE )
+    {
+        // Let the thread run into the wait
+        for( i = 0; i < 1000; i++ )
+        {
+            sched_yield();
+        }
+        is_pass =    __atomic_load_n(&g_case_42_set_done, __ATOMIC_ACQUIRE) == 0
+                  && memcmp(account_ptr->address, old_address, BOAT_ETH_ADDRESS_SIZE) == 0;
+
+        BoatEthWalletReleaseAccount(wallet_ptr, account_ptr);
+        pthread_join(thread, NULL);
+
+        is_pass =    is_pass
+                  && __atomic_load_n(&g_case_42_set_done, __ATOMIC_ACQUIRE) == 1
+                  && BoatEthWalletFindAccount(wallet_ptr, ref_wallet_ptr->account_info.address) == 0;
+    }
+    else if( account_ptr != NULL )
+    {
+        BoatEthWalletReleaseAccount(wallet_ptr, account_ptr);
+    }
+
+    BoatWalletUnload(index);
+    BoatWalletUnload(ref_index);
+
+    BoatDisplayTestResult(is_pass, "Case_42_MultiAccountSetPrivkey_4204");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_42_MultiAccountMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_42_Manage();
+    case_result += Case_42_SignByAccount();
+    case_result += Case_42_Concurrent();
+    case_result += Case_42_SetPrivkey();
+
+    return case_result;
+}
@@ -0,0 +1,292 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatethereum.h"
+#include "rpcintf.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#define CASE_43_TX_NUM       32
+#define CASE_43_BLOCK_NUM    16
+#define CASE_43_BENCH_ROUNDS 100000
+
+#define CASE_43_TX_HASH_STR "0x5e2c1c8bdf0a0d1b7b9c2f8e4a3d6b1c0f9e8d7c6b5a49382716051423324150"
+
+
+// Allocator counting its calls and live blocks
+static BUINT32 g_case_43_malloc_num = 0;
+static BSINT32 g_case_43_live_num = 0;
+
+static void *Case_43_Malloc(BUINT32 size)
+{
+    void *mem_ptr = malloc(size);
+
+    if( mem_ptr != NULL )
+    {
+        __atomic_add_fetch(&g_case_43_malloc_num, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&g_case_43_live_num, 1, __ATOMIC_RELAXED);
+    }
+
+    return mem_ptr;
+}
+
+static void Case_43_Free(void *mem_ptr)
+{
+    __atomic_sub_fetch(&g_case_43_live_num, 1, __ATOMIC_RELAXED);
+    free(mem_ptr);
+}
+
+static const BoatAllocator g_case_43_allocator = {Case_43_Malloc, Case_43_Free};
+
+
+// The node accepts any transaction
+static const BCHAR *Case_43_NodeResult(const BCHAR *request_str)
+{
+    (void)request_str;
+
+    return "\"" CASE_43_TX_HASH_STR "\"";
+}
+
+
+
+
+static BOAT_RESULT Case_43_ArenaScope(void)
+{
+    void *block_ptr_array[CASE_43_BLOCK_NUM];
+    void *nested_ptr;
+    void *persistent_ptr;
+    void *large_ptr;
+    BUINT32 malloc_num;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // The first scope of the thread allocates the arena and its first chunk
+    BoatTxArenaBegin();
+    is_pass = BoatMalloc(1) != NULL;
+    BoatTxArenaEnd();
+
+    malloc_num = __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED);
+
+    BoatTxArenaBegin();
+    for( i = 0; i < CASE_43_BLOCK_NUM; i++ )
+    {
+        block_ptr_array[i] = BoatMalloc(i * 7 + 1);
+        is_pass =    is_pass
+                  && block_ptr_array[i] != NULL
+                  && ((size_t)block_ptr_array[i] & 0x0F) == 0;
+        memset(block_ptr_array[i], (int)i, i * 7 + 1);
+    }
+
+    // Nested scopes share the outermost one's memory, which outlives the inner end
+    BoatTxArenaBegin();
+    nested_ptr = BoatMalloc(32);
+    is_pass = is_pass && nested_ptr != NULL;
+    if( nested_ptr != NULL )
+    {
+        memset(nested_ptr, 0x43, 32);
+    }
+    BoatFree(nested_ptr);
+    BoatTxArenaEnd();
+    is_pass = is_pass && ((BUINT8 *)nested_ptr)[31] == 0x43;
+
+    // Freeing arena memory is deferred
+    for( i = 0; i < CASE_43_BLOCK_NUM; i++ )
+    {
+        is_pass = is_pass && ((BUINT8 *)block_ptr_array[i])[i * 7] == (BUINT8)i;
+        BoatFree(block_ptr_array[i]);
+    }
+
+    // Small blocks come from the retained chunk
+    is_pass = is_pass && __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED) == malloc_num;
+
+    // Blocks larger than a chunk and persistent memory come from the allocator
+    large_ptr = BoatMalloc(BOAT_TX_ARENA_CHUNK_SIZE * 3);
+    persistent_ptr = BoatMallocPersistent(64);
+    is_pass =    is_pass
+              && large_ptr != NULL
+              && persistent_ptr != NULL
+              && __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED) == malloc_num + 2;
+    memset(large_ptr, 0x43, BOAT_TX_ARENA_CHUNK_SIZE * 3);
+    memset(persistent_ptr, 0x43, 64);
+    BoatTxArenaEnd();
+
+    // Persistent memory outlives the scope, the oversized chunk doesn't
+    is_pass = is_pass && ((BUINT8 *)persistent_ptr)[63] == 0x43;
+    BoatFree(persistent_ptr);
+
+    // Out of scope BoatMalloc() allocates from the allocator again
+    persistent_ptr = BoatMalloc(16);
+    is_pass = is_pass && __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED) == malloc_num + 3;
+    BoatFree(persistent_ptr);
+
+    BoatDisplayTestResult(is_pass, "Case_43_TxArenaScope_4301");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void Case_43_TxInit(BoatEthTx *tx_ptr, BoatEthWallet *wallet_ptr, BUINT32 nonce)
+{
+    memset(tx_ptr, 0x00, sizeof(BoatEthTx));
+
+    tx_ptr->wallet_ptr = wallet_ptr;
+
+    tx_ptr->rawtx_fields.nonce.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.nonce.field, nonce, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gasprice.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gasprice.field, 1000000000u, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gaslimit.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gaslimit.field, 21000, TRIMBIN_LEFTTRIM);
+    memset(tx_ptr->rawtx_fields.recipient, 0x5a, BOAT_ETH_ADDRESS_SIZE);
+    tx_ptr->rawtx_fields.value.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.value.field, 1000000u + nonce, TRIMBIN_LEFTTRIM);
+}
+
+
+static BOAT_RESULT Case_43_SendRawtx(void)
+{
+    BoatEthWalletConfig config;
+    BoatEthWallet *wallet_ptr;
+    BoatEthTx tx;
+    BUINT8 tx_hash[32];
+    BSINT32 index;
+    BSINT32 live_num;
+    BUINT32 malloc_num;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, 0x43, 32);
+    config.chain_id = 1;
+    strncpy(config.node_url_str, TestNodeUrl(), BOAT_NODE_URL_MAX_LEN - 1);
+
+    index = BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, NULL, &config, sizeof(config));
+    wallet_ptr = BoatGetWalletByIndex(index);
+    is_pass = wallet_ptr != NULL;
+
+    UtilityHex2Bin(tx_hash, 32, CASE_43_TX_HASH_STR, TRIMBIN_TRIM_NO, BOAT_TRUE);
+
+    // The first transaction sets up the thread's RPC context and arena
+    if( is_pass == BOAT_TRUE )
+    {
+        Case_43_TxInit(&tx, wallet_ptr, 0);
+        is_pass = EthSendRawtx(&tx) == BOAT_SUCCESS;
+    }
+
+    malloc_num = __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED);
+    live_num = __atomic_load_n(&g_case_43_live_num, __ATOMIC_RELAXED);
+
+    for( i = 1; i <= CASE_43_TX_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        Case_43_TxInit(&tx, wallet_ptr, i);
+        is_pass =    EthSendRawtx(&tx) == BOAT_SUCCESS
+                  && tx.tx_hash.field_len == 32
+                  && memcmp(tx.tx_hash.field, tx_hash, 32) == 0;
+    }
+
+    // All temporary memory of the transactions came from the arena
+    BoatLog(BOAT_LOG_NORMAL, "%u transactions made %u allocator calls.",
+            CASE_43_TX_NUM, __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED) - malloc_num);
+
+    is_pass =    is_pass
+              && __atomic_load_n(&g_case_43_malloc_num, __ATOMIC_RELAXED) == malloc_num
+              && __atomic_load_n(&g_case_43_live_num, __ATOMIC_RELAXED) == live_num;
+
+    BoatWalletUnload(index);
+
+    BoatDisplayTestResult(is_pass, "Case_43_TxArenaSendRawtx_4302");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void Case_43_AllocateBlocks(void)
+{
+    void *block_ptr_array[CASE_43_BLOCK_NUM];
+    BUINT32 i;
+
+    for( i = 0; i < CASE_43_BLOCK_NUM; i++ )
+    {
+        block_ptr_array[i] = BoatMalloc(32 + i * 24);
+    }
+    for( i = 0; i < CASE_43_BLOCK_NUM; i++ )
+    {
+        BoatFree(block_ptr_array[i]);
+    }
+}
+
+
+static BOAT_RESULT Case_43_Benchmark(void)
+{
+    double heap_sec;
+    double arena_sec;
+    double start;
+    BUINT32 i;
+
+    start = TestNow();
+    for( i = 0; i < CASE_43_BENCH_ROUNDS; i++ )
+    {
+        Case_43_AllocateBlocks();
+    }
+    heap_sec = TestNow() - start;
+
+    start = TestNow();
+    for( i = 0; i < CASE_43_BENCH_ROUNDS; i++ )
+    {
+        BoatTxArenaBegin();
+        Case_43_AllocateBlocks();
+        BoatTxArenaEnd();
+    }
+    arena_sec = TestNow() - start;
+
+    BoatLog(BOAT_LOG_NORMAL, "%u blocks per transaction: heap %.1f ns, arena %.1f ns.",
+            CASE_43_BLOCK_NUM, heap_sec * 1e9 / CASE_43_BENCH_ROUNDS, arena_sec * 1e9 / CASE_43_BENCH_ROUNDS);
+
+    BoatDisplayTestResult(BOAT_TRUE, "Case_43_TxArenaBenchmark_4303");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_43_TxArenaMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    BoatIotSdkDeInit();
+
+    if(    BoatIotSdkInitWithAllocator(BOAT_MAX_WALLET_NUM, &g_case_43_allocator) != BOAT_SUCCESS
+        || TestNodeStart(Case_43_NodeResult) != BOAT_TRUE )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_43_TxArenaScope_4301");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_43_ArenaScope();
+    case_result += Case_43_SendRawtx();
+    case_result += Case_43_Benchmark();
+
+    // Everything allocated from the allocator is freed with the SDK
+    BoatIotSdkDeInit();
+    TestNodeStop();
+
+    BoatDisplayTestResult(__atomic_load_n(&g_case_43_live_num, __ATOMIC_RELAXED) == 0,
+                          "Case_43_TxArenaDeInit_4304");
+
+    BoatIotSdkInit();
+
+    return case_result;
+}
@@ -0,0 +1,263 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boatethereum.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#if BOAT_USE_STATIC_POOL == 1
+
+#define CASE_44_SOAK_ROUNDS      5000
+#define CASE_44_PERSIST_EVERY    50
+#define CASE_44_EXHAUST_MAX_NUM  4096
+
+// BOAT_MEM_ACCOUNTING prepends a 16-byte header to each block of BoatMalloc()
+#if BOAT_MEM_ACCOUNTING == 1
+#define CASE_44_MEM_HEADER_SIZE  16
+#else
+#define CASE_44_MEM_HEADER_SIZE  0
+#endif
+
+#define CASE_44_RESULT_STR "\"0x5e2c1c8bdf0a0d1b7b9c2f8e4a3d6b1c0f9e8d7c6b5a49382716051423324150\""
+
+
+// The node accepts any transaction
+static const BCHAR *Case_44_NodeResult(const BCHAR *request_str)
+{
+    (void)request_str;
+
+    return CASE_44_RESULT_STR;
+}
+
+
+
+
+static BSINT32 Case_44_Create(const BCHAR *wallet_name_str, BUINT32 round)
+{
+    BoatEthWalletConfig config;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, 0x44, 32);
+    config.priv_key_array[30] = (BUINT8)(round >> 8);
+    config.priv_key_array[31] = (BUINT8)round;
+    config.chain_id = 1;
+    strncpy(config.node_url_str, TestNodeUrl(), BOAT_NODE_URL_MAX_LEN - 1);
+
+    return BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, wallet_name_str, &config, sizeof(config));
+}
+
+
+static void Case_44_TxInit(BoatEthTx *tx_ptr, BoatEthWallet *wallet_ptr, BUINT32 nonce)
+{
+    memset(tx_ptr, 0x00, sizeof(BoatEthTx));
+
+    tx_ptr->wallet_ptr = wallet_ptr;
+
+    tx_ptr->rawtx_fields.nonce.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.nonce.field, nonce, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gasprice.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gasprice.field, 1000000000u, TRIMBIN_LEFTTRIM);
+    tx_ptr->rawtx_fields.gaslimit.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.gaslimit.field, 21000, TRIMBIN_LEFTTRIM);
+    memset(tx_ptr->rawtx_fields.recipient, 0x5a, BOAT_ETH_ADDRESS_SIZE);
+    tx_ptr->rawtx_fields.value.field_len =
+        UtilityUint32ToBigend(tx_ptr->rawtx_fields.value.field, 1000000u + nonce, TRIMBIN_LEFTTRIM);
+}
+
+
+// One round: a wallet with two accounts sends a transaction of each
+static BBOOL Case_44_Round(BUINT32 round)
+{
+    BoatEthWallet *wallet_ptr;
+    BoatEthTx tx;
+    BUINT8 priv_key_array[32];
+    BCHAR *wallet_name_str;
+    BSINT32 index;
+    BBOOL is_pass;
+
+    wallet_name_str = (round % CASE_44_PERSIST_EVERY == 0) ? "case_44_wallet" : NULL;
+
+    index = Case_44_Create(wallet_name_str, round);
+    wallet_ptr = BoatGetWalletByIndex(index);
+
+    memset(priv_key_array, 0x45, 32);
+    is_pass =    wallet_ptr != NULL
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == 1;
+
+    if( is_pass == BOAT_TRUE )
+    {
+        Case_44_TxInit(&tx, wallet_ptr, round);
+        is_pass = EthSendRawtx(&tx) == BOAT_SUCCESS;
+
+        Case_44_TxInit(&tx, wallet_ptr, round);
+        is_pass =    is_pass
+                  && BoatEthTxSetAccount(&tx, 1) == BOAT_SUCCESS
+                  && EthSendRawtx(&tx) == BOAT_SUCCESS;
+    }
+
+    BoatWalletUnload(index);
+    if( wallet_name_str != NULL )
+    {
+        BoatWalletDelete(wallet_name_str);
+    }
+
+    return is_pass;
+}
+
+
+static BOAT_RESULT Case_44_Soak(void)
+{
+    BoatStaticPoolStats start_stats_array[BOAT_STATIC_POOL_NUM];
+    BoatStaticPoolStats stats;
+    BUINT32 round;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    // The first round sets up the thread's RPC context and arena
+    is_pass = Case_44_Round(0);
+
+    for( i = 0; i < BOAT_STATIC_POOL_NUM; i++ )
+    {
+        BoatStaticPoolGetStats(i, &start_stats_array[i]);
+    }
+
+    for( round = 1; round <= CASE_44_SOAK_ROUNDS && is_pass == BOAT_TRUE; round++ )
+    {
+        is_pass = Case_44_Round(round);
+    }
+
+    // Every block is back in its pool, and no request has failed since the
+    // first round. Earlier cases may have counted failures of their own.
+    for( i = 0; i < BOAT_STATIC_POOL_NUM; i++ )
+    {
+        BoatStaticPoolGetStats(i, &stats);
+        BoatLog(BOAT_LOG_NORMAL, "Pool %u of %u x %u bytes: %u used, peak %u, %u failed.",
+                i, stats.block_num, stats.block_size, stats.used_num, stats.peak_used_num, stats.fail_num);
+
+        is_pass =    is_pass
+                  && stats.used_num == start_stats_array[i].used_num
+                  && stats.fail_num == start_stats_array[i].fail_num;
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_44_StaticPoolSoak_4401");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_44_Exhaustion(void)
+{
+    void **block_ptr_array;
+    BoatStaticPoolStats stats;
+    BoatEthWallet *wallet_ptr;
+    BoatEthTx tx;
+    BUINT8 priv_key_array[32];
+    BUINT32 block_num = 0;
+    BUINT32 fail_num;
+    BSINT32 index;
+    BSINT32 other_index;
+    BSINT32 i;
+    BBOOL is_pass;
+
+    // Requests larger than every block fail cleanly
+    BoatStaticPoolGetStats(BOAT_STATIC_POOL_NUM - 1, &stats);
+    fail_num = stats.fail_num;
+    is_pass = BoatMalloc(BOAT_STATIC_POOL_5_BLOCK_SIZE + 1) == NULL;
+    BoatStaticPoolGetStats(BOAT_STATIC_POOL_NUM - 1, &stats);
+    is_pass = is_pass && stats.fail_num == fail_num + 1;
+
+    index = Case_44_Create(NULL, 1);
+    wallet_ptr = BoatGetWalletByIndex(index);
+    is_pass = is_pass && wallet_ptr != NULL;
+
+    // Drain every pool, largest first, so that no request can be served
+    block_ptr_array = malloc(CASE_44_EXHAUST_MAX_NUM * sizeof(void *));
+    for( i = BOAT_STATIC_POOL_NUM - 1; i >= 0 && block_ptr_array != NULL; i-- )
+    {
+        BoatStaticPoolGetStats(i, &stats);
+        while(    block_num < CASE_44_EXHAUST_MAX_NUM
+               && (block_ptr_array[block_num] = BoatMalloc(stats.block_size - CASE_44_MEM_HEADER_SIZE)) != NULL )
+        {
+            block_num++;
+        }
+    }
+
+    for( i = 0; i < BOAT_STATIC_POOL_NUM; i++ )
+    {
+        BoatStaticPoolGetStats(i, &stats);
+        is_pass = is_pass && stats.used_num == stats.block_num;
+    }
+
+    // The SDK reports errors
+    memset(priv_key_array, 0x45, 32);
+    is_pass =    is_pass
+              && Case_44_Create(NULL, 2) < 0
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == BOAT_ERROR_OUT_OF_MEMORY;
+
+    // while a transaction of a thread that has sent one fits in its arena chunk
+    Case_44_TxInit(&tx, wallet_ptr, 1);
+    is_pass = is_pass && EthSendRawtx(&tx) == BOAT_SUCCESS;
+
+    // and recovers once memory is freed
+    while( block_num > 0 )
+    {
+        BoatFree(block_ptr_array[--block_num]);
+    }
+    free(block_ptr_array);
+
+    other_index = Case_44_Create(NULL, 2);
+    is_pass =    is_pass
+              && BoatEthWalletAddAccount(wallet_ptr, priv_key_array) == 1
+              && other_index >= 0;
+
+    BoatWalletUnload(other_index);
+    BoatWalletUnload(index);
+
+    BoatDisplayTestResult(is_pass, "Case_44_StaticPoolExhaustion_4402");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_44_StaticPoolMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    if( TestNodeStart(Case_44_NodeResult) != BOAT_TRUE )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_44_StaticPoolSoak_4401");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_44_Soak();
+    case_result += Case_44_Exhaustion();
+
+    TestNodeStop();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_44_StaticPoolMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Static pools are disabled (BOAT_USE_STATIC_POOL).");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,228 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "web3intf.h"
+#include "testcommon.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#if BOAT_MEM_ACCOUNTING == 1
+
+#define CASE_45_THREAD_NUM 4
+#define CASE_45_ROUNDS     10000
+
+#define CASE_45_RESPONSE_STR "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":\"0x4a817c800\"}"
+
+
+static BOAT_RESULT Case_45_Tags(void)
+{
+    BoatMemSnapshot before;
+    BoatMemSnapshot after;
+    void *other_ptr;
+    void *rlp_ptr;
+    BBOOL is_pass;
+
+    BoatMemResetStats();
+    is_pass = BoatMemGetSnapshot(&before) == BOAT_SUCCESS;
+
+    other_ptr = BoatMalloc(100);
+    rlp_ptr = BoatMallocTagged(1000, BOAT_MEM_TAG_RLP, BOAT_TRUE);
+    BoatMemGetSnapshot(&after);
+
+    is_pass =    is_pass
+              && other_ptr != NULL
+              && rlp_ptr != NULL
+              && ((uintptr_t)other_ptr & 0xF) == 0
+              && ((uintptr_t)rlp_ptr & 0xF) == 0
+              && after.tag_stats[BOAT_MEM_TAG_OTHER].live_bytes == before.tag_stats[BOAT_MEM_TAG_OTHER].live_bytes + 100
+              && after.tag_stats[BOAT_MEM_TAG_RLP].live_bytes == before.tag_stats[BOAT_MEM_TAG_RLP].live_bytes + 1000
+              && after.tag_stats[BOAT_MEM_TAG_RLP].alloc_num == 1
+              && after.total_stats.live_bytes == before.total_stats.live_bytes + 1100
+              && after.total_stats.peak_bytes == after.total_stats.live_bytes;
+
+    BoatFree(rlp_ptr);
+    BoatFree(other_ptr);
+    BoatMemGetSnapshot(&after);
+
+    // Peaks are kept after freeing, until reset
+    is_pass =    is_pass
+              && after.total_stats.live_bytes == before.total_stats.live_bytes
+              && after.total_stats.peak_bytes == before.total_stats.live_bytes + 1100
+              && after.tag_stats[BOAT_MEM_TAG_RLP].free_num == 1
+              && after.tag_stats[BOAT_MEM_TAG_RLP].peak_bytes == before.tag_stats[BOAT_MEM_TAG_RLP].live_bytes + 1000;
+
+    BoatMemResetStats();
+    BoatMemGetSnapshot(&after);
+
+    is_pass =    is_pass
+              && after.total_stats.peak_bytes == after.total_stats.live_bytes
+              && after.total_stats.alloc_num == 0
+              && after.total_stats.free_num == 0;
+
+    BoatDisplayTestResult(is_pass, "Case_45_MemAccountingTags_4501");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_45_JsonLeak(void)
+{
+    BoatMemSnapshot before;
+    BoatMemSnapshot after;
+    BoatFieldVariable result_out;
+    BBOOL is_pass;
+
+    result_out.field_len = 64;
+    result_out.field_ptr = BoatMalloc(result_out.field_len);
+
+    BoatMemResetStats();
+    BoatMemGetSnapshot(&before);
+
+    // A successful parse frees all JSON memory it allocates
+    is_pass =    result_out.field_ptr != NULL
+              && web3_parse_json_result(CASE_45_RESPONSE_STR, "", &result_out) == BOAT_SUCCESS
+              && strcmp((BCHAR *)result_out.field_ptr, "0x4a817c800") == 0;
+
+    BoatMemGetSnapshot(&after);
+
+    is_pass =    is_pass
+              && after.tag_stats[BOAT_MEM_TAG_JSON].alloc_num > 0
+              && after.tag_stats[BOAT_MEM_TAG_JSON].free_num == after.tag_stats[BOAT_MEM_TAG_JSON].alloc_num
+              && after.tag_stats[BOAT_MEM_TAG_JSON].live_bytes == before.tag_stats[BOAT_MEM_TAG_JSON].live_bytes;
+
+    BoatLog(BOAT_LOG_NORMAL, "Parsing a response: %llu JSON allocations, %llu bytes at peak.",
+            after.tag_stats[BOAT_MEM_TAG_JSON].alloc_num,
+            after.tag_stats[BOAT_MEM_TAG_JSON].peak_bytes - before.tag_stats[BOAT_MEM_TAG_JSON].live_bytes);
+
+    BoatFree(result_out.field_ptr);
+
+    BoatDisplayTestResult(is_pass, "Case_45_MemAccountingJsonLeak_4502");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_45_ArenaUnfreed(void)
+{
+    BoatMemSnapshot before;
+    BoatMemSnapshot after;
+    void *freed_ptr;
+    void *unfreed_ptr;
+    BBOOL is_pass;
+
+    BoatMemResetStats();
+    BoatMemGetSnapshot(&before);
+
+    BoatTxArenaBegin();
+    freed_ptr = BoatMallocTagged(50, BOAT_MEM_TAG_TX, BOAT_FALSE);
+    unfreed_ptr = BoatMallocTagged(100, BOAT_MEM_TAG_TX, BOAT_FALSE);
+    BoatFree(freed_ptr);
+    BoatTxArenaEnd();
+
+    BoatMemGetSnapshot(&after);
+
+    // The block left to the arena is released but counted
+    is_pass =    freed_ptr != NULL
+              && unfreed_ptr != NULL
+              && after.tag_stats[BOAT_MEM_TAG_TX].live_bytes == before.tag_stats[BOAT_MEM_TAG_TX].live_bytes
+              && after.tag_stats[BOAT_MEM_TAG_TX].alloc_num == 2
+              && after.tag_stats[BOAT_MEM_TAG_TX].free_num == 2
+              && after.tag_stats[BOAT_MEM_TAG_TX].unfreed_num == 1
+              && after.total_stats.unfreed_num == 1;
+
+    BoatDisplayTestResult(is_pass, "Case_45_MemAccountingArenaUnfreed_4503");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void *Case_45_AllocThread(void *arg)
+{
+    BUINT32 i;
+    void *mem_ptr;
+
+    (void)arg;
+
+    for( i = 0; i < CASE_45_ROUNDS; i++ )
+    {
+        mem_ptr = BoatMallocTagged(16 + i % 256, BOAT_MEM_TAG_STORAGE, BOAT_FALSE);
+        BoatFree(mem_ptr);
+    }
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_45_Concurrent(void)
+{
+    pthread_t thread_array[CASE_45_THREAD_NUM];
+    BoatMemSnapshot before;
+    BoatMemSnapshot after;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    BoatMemResetStats();
+    BoatMemGetSnapshot(&before);
+
+    for( i = 0; i < CASE_45_THREAD_NUM; i++ )
+    {
+        is_pass = is_pass && pthread_create(&thread_array[i], NULL, Case_45_AllocThread, NULL) == 0;
+    }
+    for( i = 0; i < CASE_45_THREAD_NUM; i++ )
+    {
+        pthread_join(thread_array[i], NULL);
+    }
+
+    BoatMemGetSnapshot(&after);
+
+    is_pass =    is_pass
+              && after.tag_stats[BOAT_MEM_TAG_STORAGE].live_bytes == before.tag_stats[BOAT_MEM_TAG_STORAGE].live_bytes
+              && after.tag_stats[BOAT_MEM_TAG_STORAGE].alloc_num == CASE_45_THREAD_NUM * CASE_45_ROUNDS
+              && after.tag_stats[BOAT_MEM_TAG_STORAGE].free_num == CASE_45_THREAD_NUM * CASE_45_ROUNDS
+              && after.tag_stats[BOAT_MEM_TAG_STORAGE].peak_bytes <= before.tag_stats[BOAT_MEM_TAG_STORAGE].live_bytes + CASE_45_THREAD_NUM * (16 + 255);
+
+    BoatDisplayTestResult(is_pass, "Case_45_MemAccountingConcurrent_4504");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_45_MemAccountingMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_45_Tags();
+    case_result += Case_45_JsonLeak();
+    case_result += Case_45_ArenaUnfreed();
+    case_result += Case_45_Concurrent();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_45_MemAccountingMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Memory accounting is disabled (BOAT_MEM_ACCOUNTING).");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,188 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boattxprofile.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#if BOAT_TX_PROFILING == 1
+
+#define CASE_46_SAMPLE_NUM 1000
+
+#define CASE_46_RECIPIENT_STR "0x19c91A4649654265823512a457D2c16981bB64F5"
+
+
+// The node answers each method the transfer calls
+static const BCHAR *Case_46_NodeResult(const BCHAR *request_str)
+{
+    if( strstr(request_str, "eth_getTransactionCount") != NULL )
+    {
+        return "\"0x5\"";
+    }
+    else if( strstr(request_str, "eth_gasPrice") != NULL )
+    {
+        return "\"0x3b9aca00\"";
+    }
+    else if( strstr(request_str, "eth_getTransactionReceipt") != NULL )
+    {
+        return "{\"status\":\"0x1\"}";
+    }
+    else
+    {
+        return "\"0x5e2c1c8bdf0a0d1b7b9c2f8e4a3d6b1c0f9e8d7c6b5a49382716051423324150\"";
+    }
+}
+
+
+
+
+// Checks a percentile against the exact value, within a bucket width
+static BBOOL Case_46_PercentileNear(const BoatTxPhaseHistogram *histogram_ptr, double percentile, BUINT64 exact_ns)
+{
+    BUINT64 value_ns = BoatTxProfileGetPercentile(histogram_ptr, percentile);
+
+    return value_ns >= exact_ns && value_ns <= exact_ns + exact_ns / 8;
+}
+
+
+static BOAT_RESULT Case_46_Histogram(void)
+{
+    BoatTxPhaseHistogram histogram;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    BoatTxProfileReset();
+
+    // 1 us ~ 1 ms, evenly
+    for( i = 1; i <= CASE_46_SAMPLE_NUM; i++ )
+    {
+        BoatTxProfileRecord(BOAT_TX_PHASE_KECCAK, i * 1000ull);
+    }
+
+    is_pass =    BoatTxProfileGetHistogram(BOAT_TX_PHASE_KECCAK, &histogram) == BOAT_SUCCESS
+              && histogram.count == CASE_46_SAMPLE_NUM
+              && histogram.min_ns == 1000
+              && histogram.max_ns == CASE_46_SAMPLE_NUM * 1000ull
+              && histogram.total_ns == 1000ull * CASE_46_SAMPLE_NUM * (CASE_46_SAMPLE_NUM + 1) / 2
+              && Case_46_PercentileNear(&histogram, 50.0, 500000)
+              && Case_46_PercentileNear(&histogram, 90.0, 900000)
+              && Case_46_PercentileNear(&histogram, 99.0, 990000)
+              && BoatTxProfileGetPercentile(&histogram, 100.0) == histogram.max_ns;
+
+    // Small and huge latencies are counted too
+    BoatTxProfileRecord(BOAT_TX_PHASE_SIGN, 3);
+    BoatTxProfileRecord(BOAT_TX_PHASE_SIGN, 1ull << 50);
+
+    is_pass =    is_pass
+              && BoatTxProfileGetHistogram(BOAT_TX_PHASE_SIGN, &histogram) == BOAT_SUCCESS
+              && histogram.bucket_count[3] == 1
+              && histogram.bucket_count[BOAT_TX_PROFILE_BUCKET_NUM - 1] == 1
+              && BoatTxProfileGetPercentile(&histogram, 50.0) == 3
+              && BoatTxProfileGetHistogram(BOAT_TX_PHASE_NUM, &histogram) != BOAT_SUCCESS;
+
+    BoatTxProfileReset();
+
+    is_pass =    is_pass
+              && BoatTxProfileGetHistogram(BOAT_TX_PHASE_KECCAK, &histogram) == BOAT_SUCCESS
+              && histogram.count == 0
+              && BoatTxProfileGetPercentile(&histogram, 50.0) == 0;
+
+    BoatDisplayTestResult(is_pass, "Case_46_TxProfileHistogram_4601");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_46_Pipeline(void)
+{
+    // Number of times each phase is expected in a synchronous transfer
+    static const BUINT64 phase_count_array[BOAT_TX_PHASE_NUM] = {1, 1, 1, 1, 1, 1, 1, 4, 4, 4, 1};
+    BoatEthWalletConfig config;
+    BoatEthWallet *wallet_ptr;
+    BoatEthTx tx;
+    BoatTxPhaseHistogram histogram;
+    BSINT32 index;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    memset(&config, 0x00, sizeof(config));
+    memset(config.priv_key_array, 0x46, 32);
+    config.chain_id = 1;
+    config.eip155_compatibility = BOAT_TRUE;
+    strncpy(config.node_url_str, TestNodeUrl(), BOAT_NODE_URL_MAX_LEN - 1);
+
+    index = BoatWalletCreate(BOAT_PROTOCOL_ETHEREUM, NULL, &config, sizeof(config));
+    wallet_ptr = BoatGetWalletByIndex(index);
+
+    BoatTxProfileReset();
+
+    // Gas price and nonce from network, waiting for the receipt
+    is_pass =    wallet_ptr != NULL
+              && BoatEthTxInit(wallet_ptr, &tx, BOAT_TRUE, NULL, "0x5208", CASE_46_RECIPIENT_STR) == BOAT_SUCCESS
+              && BoatEthTransfer(&tx, "0x1") == BOAT_SUCCESS;
+
+    for( i = 0; i < BOAT_TX_PHASE_NUM && is_pass == BOAT_TRUE; i++ )
+    {
+        is_pass =    BoatTxProfileGetHistogram(i, &histogram) == BOAT_SUCCESS
+                  && histogram.count == phase_count_array[i]
+                  && histogram.min_ns > 0;
+
+        if( is_pass != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Phase %s timed %llu times.", BoatTxProfilePhaseName(i), histogram.count);
+        }
+    }
+
+    BoatTxProfileDump();
+
+    BoatWalletUnload(index);
+
+    BoatDisplayTestResult(is_pass, "Case_46_TxProfilePipeline_4602");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_46_TxProfileMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_46_Histogram();
+
+    if( TestNodeStart(Case_46_NodeResult) != BOAT_TRUE )
+    {
+        BoatDisplayTestResult(BOAT_FALSE, "Case_46_TxProfilePipeline_4602");
+        return BOAT_ERROR;
+    }
+
+    case_result += Case_46_Pipeline();
+
+    TestNodeStop();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_46_TxProfileMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Transaction profiling is disabled (BOAT_TX_PROFILING).");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
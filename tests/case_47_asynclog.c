@@ -0,0 +1,417 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "boatinternal.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#if BOAT_LOG_ASYNC == 1
+
+#define CASE_47_FORMAT_NUM  16
+#define CASE_47_LINE_SIZE   256
+#define CASE_47_THREAD_NUM  4
+#define CASE_47_THREAD_LOGS 2000
+#define CASE_47_BODY_LEN    1024
+#define CASE_47_BURST_LOGS  20000
+
+
+// Logs through BoatLog() and keeps what printf() would have printed
+#define CASE_47_LOG(format, ...)\
+    do{\
+        BoatLog(BOAT_LOG_NORMAL, format, ##__VA_ARGS__);\
+        snprintf(g_case_47_expected_str[g_case_47_expected_num++], CASE_47_LINE_SIZE, format, ##__VA_ARGS__);\
+    }while(0)
+
+static BCHAR g_case_47_expected_str[CASE_47_FORMAT_NUM][CASE_47_LINE_SIZE];
+static BUINT32 g_case_47_expected_num;
+
+static int g_case_47_stdout_fd = -1;
+static FILE *g_case_47_file_ptr = NULL;
+
+
+// Redirects stdout, where the background thread prints, into a temporary file
+static BBOOL Case_47_CaptureBegin(void)
+{
+    BoatLogAsyncFlush();
+
+    g_case_47_file_ptr = tmpfile();
+    g_case_47_stdout_fd = dup(STDOUT_FILENO);
+
+    return    g_case_47_file_ptr != NULL
+           && g_case_47_stdout_fd >= 0
+           && dup2(fileno(g_case_47_file_ptr), STDOUT_FILENO) >= 0;
+}
+
+
+static void Case_47_CaptureEnd(void)
+{
+    BoatLogAsyncFlush();
+
+    dup2(g_case_47_stdout_fd, STDOUT_FILENO);
+    close(g_case_47_stdout_fd);
+    rewind(g_case_47_file_ptr);
+}
+
+
+// Returns the next captured log of this file without its prefix, or NULL
+static BCHAR *Case_47_NextLog(BCHAR **line_str_ptr, size_t *line_size_ptr)
+{
+    BCHAR *log_str;
+    ssize_t line_len;
+
+    while( (line_len = getline(line_str_ptr, line_size_ptr, g_case_47_file_ptr)) > 0 )
+    {
+        if( (*line_str_ptr)[line_len - 1] == '\n' )
+        {
+            (*line_str_ptr)[line_len - 1] = '\0';
+        }
+
+        if(    strstr(*line_str_ptr, "case_47_asynclog.c:") != NULL
+            && (log_str = strstr(*line_str_ptr, "(): ")) != NULL )
+        {
+            return log_str + 4;
+        }
+    }
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_47_Format(void)
+{
+    BoatLogAsyncStats before;
+    BoatLogAsyncStats after;
+    BCHAR long_str[BOAT_LOG_ASYNC_RECORD_MAX_SIZE + 100];
+    BCHAR unterminated_array[4] = {'a', 'b', 'c', 'd'};
+    // Not literals, so that the compiler doesn't warn about the NULL string
+    // and the unknown conversion, which are printed the same way as printf()
+    const BCHAR *volatile null_str = NULL;
+    const BCHAR *volatile unknown_format = "not a conversion %y %d";
+    BCHAR *line_str = NULL;
+    BCHAR *log_str;
+    size_t line_size = 0;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    memset(long_str, 'L', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = '\0';
+
+    BoatLogAsyncGetStats(&before);
+    is_pass = Case_47_CaptureBegin();
+
+    g_case_47_expected_num = 0;
+    CASE_47_LOG("plain text, 100%% literal");
+    CASE_47_LOG("int %d %i %u %x %X %o", -42, 7, 4000000000u, 0xBEEF, 0xBEEF, 8);
+    CASE_47_LOG("length %ld %lld %llu %hhd %hhu %hd %zu", -1234567890L, -1LL, 18446744073709551615ULL, 300, 300, 70000, (size_t)12345);
+    CASE_47_LOG("flags [%5d] [%-5d] [%05d] [%+d] [% d] [%#x] [%#o]", 12, 12, 12, 12, 12, 255, 8);
+    CASE_47_LOG("star [%*d] [%-*d] [%.*d] [%*.*f]", 6, 1, 6, 1, 4, 3, 8, 2, 3.14159);
+    CASE_47_LOG("char %c%c%c", 'B', 'o', 'A');
+    CASE_47_LOG("string [%s] [%-16s] [%10s] [%.3s] [%.*s] [%s]", "boat", "left", "right", "abcdef", 2, unterminated_array, null_str);
+    CASE_47_LOG("pointer %p", (void *)&before);
+    CASE_47_LOG("float %f %.2f %10.3e %g %G %a %Lf", 1.5, 2.345, 12345.678, 0.0001, 1e20, 1.0, (long double)3.25);
+    CASE_47_LOG(unknown_format, 3);
+
+    BoatLog(BOAT_LOG_NORMAL, "long %s tail %d", long_str, 5);
+
+    Case_47_CaptureEnd();
+    BoatLogAsyncGetStats(&after);
+
+    for( i = 0; i < g_case_47_expected_num && is_pass == BOAT_TRUE; i++ )
+    {
+        log_str = Case_47_NextLog(&line_str, &line_size);
+        is_pass = log_str != NULL && strcmp(log_str, g_case_47_expected_str[i]) == 0;
+
+        if( is_pass != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Expected \"%s\", got \"%s\".", g_case_47_expected_str[i], log_str);
+        }
+    }
+
+    // Truncated to the record, without the arguments after the string
+    log_str = Case_47_NextLog(&line_str, &line_size);
+    is_pass =    is_pass
+              && log_str != NULL
+              && strncmp(log_str, "long LLLL", 9) == 0
+              && strlen(log_str) > BOAT_LOG_ASYNC_RECORD_MAX_SIZE - 100
+              && strlen(log_str) < BOAT_LOG_ASYNC_RECORD_MAX_SIZE
+              && strcmp(log_str + strlen(log_str) - 4, "L...") == 0
+              && after.truncated_num == before.truncated_num + 1
+              && after.written_num == before.written_num + g_case_47_expected_num + 1;
+
+    free(line_str);
+    fclose(g_case_47_file_ptr);
+
+    BoatDisplayTestResult(is_pass, "Case_47_AsyncLogFormat_4701");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_47_Level(void)
+{
+    BoatLogAsyncStats before;
+    BoatLogAsyncStats after;
+    BBOOL is_pass;
+
+    BoatLogAsyncGetStats(&before);
+
+    is_pass = BoatLogSetLevel(BOAT_LOG_CRITICAL) == BOAT_SUCCESS && BoatLogGetLevel() == BOAT_LOG_CRITICAL;
+
+    // Filtered out before anything is copied
+    BoatLog(BOAT_LOG_NORMAL, "Case_47 filtered %d", 1);
+    BoatLog(BOAT_LOG_VERBOSE, "Case_47 filtered %d", 2);
+    BoatLogAsyncGetStats(&after);
+    is_pass = is_pass && after.written_num == before.written_num;
+
+    BoatLog(BOAT_LOG_CRITICAL, "Case_47 kept at runtime level %u.", BoatLogGetLevel());
+    BoatLogAsyncGetStats(&after);
+    is_pass = is_pass && after.written_num + after.dropped_num == before.written_num + before.dropped_num + 1;
+
+    is_pass =    is_pass
+              && BoatLogSetLevel(BOAT_LOG_VERBOSE + 1) == BOAT_ERROR_INVALID_ARGUMENT
+              && BoatLogGetLevel() == BOAT_LOG_CRITICAL
+              && BoatLogSetLevel(BOAT_LOG_LEVEL) == BOAT_SUCCESS;
+
+    BoatDisplayTestResult(is_pass, "Case_47_AsyncLogLevel_4702");
+
+    return BOAT_SUCCESS;
+}
+
+
+static void *Case_47_LogThread(void *arg)
+{
+    BUINT32 thread_id = (BUINT32)(uintptr_t)arg;
+    BUINT32 i;
+
+    for( i = 0; i < CASE_47_THREAD_LOGS; i++ )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "thread %u seq %u", thread_id, i);
+    }
+
+    return NULL;
+}
+
+
+static BOAT_RESULT Case_47_Concurrent(void)
+{
+    pthread_t thread_array[CASE_47_THREAD_NUM];
+    BSINT32 last_seq_array[CASE_47_THREAD_NUM];
+    BoatLogAsyncStats before;
+    BoatLogAsyncStats after;
+    BCHAR *line_str = NULL;
+    BCHAR *log_str;
+    size_t line_size = 0;
+    BUINT32 thread_id;
+    BUINT32 seq;
+    BUINT32 line_num = 0;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    BoatLogAsyncGetStats(&before);
+    is_pass = Case_47_CaptureBegin();
+
+    for( i = 0; i < CASE_47_THREAD_NUM; i++ )
+    {
+        last_seq_array[i] = -1;
+        is_pass = is_pass && pthread_create(&thread_array[i], NULL, Case_47_LogThread, (void *)(uintptr_t)i) == 0;
+    }
+    for( i = 0; i < CASE_47_THREAD_NUM; i++ )
+    {
+        pthread_join(thread_array[i], NULL);
+    }
+
+    Case_47_CaptureEnd();
+    BoatLogAsyncGetStats(&after);
+
+    // Every written log is printed once, in the order of its thread
+    while( (log_str = Case_47_NextLog(&line_str, &line_size)) != NULL )
+    {
+        is_pass =    is_pass
+                  && sscanf(log_str, "thread %u seq %u", &thread_id, &seq) == 2
+                  && thread_id < CASE_47_THREAD_NUM
+                  && (BSINT32)seq > last_seq_array[thread_id];
+        if( is_pass == BOAT_TRUE )
+        {
+            last_seq_array[thread_id] = seq;
+        }
+        line_num++;
+    }
+
+    is_pass =    is_pass
+              && line_num == after.written_num - before.written_num
+              && line_num + after.dropped_num - before.dropped_num == CASE_47_THREAD_NUM * CASE_47_THREAD_LOGS;
+
+    BoatLog(BOAT_LOG_NORMAL, "%u threads: %u logs printed, %llu dropped.", CASE_47_THREAD_NUM, line_num,
+            after.dropped_num - before.dropped_num);
+
+    free(line_str);
+    fclose(g_case_47_file_ptr);
+
+    BoatDisplayTestResult(is_pass, "Case_47_AsyncLogConcurrent_4703");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BUINT32 g_case_47_alloc_num;
+
+
+static void *Case_47_CountingMalloc(BUINT32 size)
+{
+    __atomic_add_fetch(&g_case_47_alloc_num, 1, __ATOMIC_RELAXED);
+
+    return malloc(size);
+}
+
+
+static void *Case_47_OneLogThread(void *arg)
+{
+    (void)arg;
+    BoatLog(BOAT_LOG_NORMAL, "one log of a short-lived thread");
+
+    return NULL;
+}
+
+
+// The ring buffer of a thread never comes from the allocator set by
+// BoatSetAllocator(), as it's freed by the background thread after the
+// thread exits, maybe with another allocator set by then
+static BOAT_RESULT Case_47_Allocator(void)
+{
+    const BoatAllocator allocator = {Case_47_CountingMalloc, free};
+    pthread_t thread;
+    BBOOL is_pass;
+
+    g_case_47_alloc_num = 0;
+    BoatSetAllocator(&allocator);
+
+    is_pass = pthread_create(&thread, NULL, Case_47_OneLogThread, NULL) == 0;
+    if( is_pass )
+    {
+        pthread_join(thread, NULL);
+    }
+
+    BoatSetAllocator(NULL);
+
+    // Printed and its ring buffer freed with the default allocator set
+    BoatLogAsyncFlush();
+    is_pass = is_pass && __atomic_load_n(&g_case_47_alloc_num, __ATOMIC_RELAXED) == 0;
+
+    BoatDisplayTestResult(is_pass, "Case_47_AsyncLogAllocator_4705");
+
+    return BOAT_SUCCESS;
+}
+
+
+// A burst of request body sized logs never blocks the calling thread
+static BOAT_RESULT Case_47_Burst(void)
+{
+    static BCHAR line_array[BOAT_LOG_ASYNC_RECORD_MAX_SIZE];
+    BCHAR body_str[CASE_47_BODY_LEN + 1];
+    BoatLogAsyncStats before;
+    BoatLogAsyncStats after;
+    BCHAR *line_str = NULL;
+    size_t line_size = 0;
+    BUINT64 begin_ns;
+    BUINT64 async_ns;
+    BUINT64 sync_ns;
+    BUINT32 line_num = 0;
+    BUINT32 i;
+    BBOOL is_pass;
+
+    memset(body_str, 'J', CASE_47_BODY_LEN);
+    body_str[CASE_47_BODY_LEN] = '\0';
+
+    BoatLogAsyncGetStats(&before);
+    is_pass = Case_47_CaptureBegin();
+
+    begin_ns = TestNowNs();
+    for( i = 0; i < CASE_47_BURST_LOGS; i++ )
+    {
+        BoatLog(BOAT_LOG_VERBOSE, "Post: %s", body_str);
+    }
+    async_ns = TestNowNs() - begin_ns;
+
+    Case_47_CaptureEnd();
+    BoatLogAsyncGetStats(&after);
+
+    while( Case_47_NextLog(&line_str, &line_size) != NULL )
+    {
+        line_num++;
+    }
+    fclose(g_case_47_file_ptr);
+    free(line_str);
+
+    // The same logs printed synchronously, as BoatLog() does with BOAT_LOG_ASYNC set to 0
+    g_case_47_file_ptr = tmpfile();
+    begin_ns = TestNowNs();
+    for( i = 0; i < CASE_47_BURST_LOGS && g_case_47_file_ptr != NULL; i++ )
+    {
+        snprintf(line_array, sizeof(line_array), "%s: "__FILE__":%d, %s(): Post: %s\n",
+                 g_log_level_name_str[BOAT_LOG_VERBOSE - 1], __LINE__, __func__, body_str);
+        fputs(line_array, g_case_47_file_ptr);
+    }
+    sync_ns = TestNowNs() - begin_ns;
+    if( g_case_47_file_ptr != NULL )
+    {
+        fclose(g_case_47_file_ptr);
+    }
+
+    is_pass =    is_pass
+              && line_num == after.written_num - before.written_num
+              && line_num + after.dropped_num - before.dropped_num == CASE_47_BURST_LOGS;
+
+    BoatLog(BOAT_LOG_NORMAL, "%u logs of %u bytes: %.1f ns per log asynchronously (%llu dropped), %.1f ns synchronously.",
+            CASE_47_BURST_LOGS, CASE_47_BODY_LEN, (double)async_ns / CASE_47_BURST_LOGS,
+            after.dropped_num - before.dropped_num, (double)sync_ns / CASE_47_BURST_LOGS);
+
+    BoatDisplayTestResult(is_pass, "Case_47_AsyncLogBurst_4704");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_47_AsyncLogMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_47_Format();
+    case_result += Case_47_Level();
+    case_result += Case_47_Concurrent();
+    case_result += Case_47_Burst();
+    case_result += Case_47_Allocator();
+
+    BoatLogAsyncFlush();
+
+    return case_result;
+}
+
+#else
+
+BOAT_RESULT Case_47_AsyncLogMain(void)
+{
+    BoatLog(BOAT_LOG_NORMAL, "Asynchronous log is disabled (BOAT_LOG_ASYNC).");
+
+    return BOAT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,457 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "boathex.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#define CASE_48_MAX_LEN       300
+#define CASE_48_ROUNDS        4
+#define CASE_48_BENCH_MAX_LEN (1024 * 1024)
+#define CASE_48_BENCH_BYTES   (64 * 1024 * 1024)
+
+static const BCHAR * const g_case_48_kernel_name_str[BOAT_HEX_KERNEL_NUM] =
+{
+    "portable",
+    "SSE2",
+    "SSSE3",
+    "AVX2",
+    "NEON"
+};
+
+// Characters rejected at every position, including ones that only differ from a HEX digit in bit 5
+static const BUINT8 g_case_48_nonhex_array[] =
+{
+    ' ', '\t', '/', ':', '@', 'G', '`', 'g', 'x', 'X', 0x10, 0x7F, 0x80, 0xB0, 0xC1, 0xE1, 0xFF
+};
+
+
+// UtilityBin2Hex() before the kernels, a nibble at a time
+static BUINT32 Case_48_RefBin2Hex(BCHAR *to_str, const BUINT8 *from_ptr, BUINT32 from_len,
+                                  BIN2HEX_TRIM_MODE trim_mode, BIN2HEX_PREFIX_0x_MODE prefix_0x_mode,
+                                  BBOOL zero_as_null)
+{
+    BUINT32 to_offset = 0;
+    BUINT8 halfbyte;
+    BUINT32 i, j;
+    BBOOL trim_done = (trim_mode == BIN2HEX_LEFTTRIM_UNFMTDATA) ? BOAT_TRUE : BOAT_FALSE;
+
+    if( from_ptr == NULL || from_len == 0 )
+    {
+        to_str[0] = '\0';
+        return 0;
+    }
+
+    if( prefix_0x_mode == BIN2HEX_PREFIX_0x_YES )
+    {
+        to_str[to_offset++] = '0';
+        to_str[to_offset++] = 'x';
+    }
+
+    for( i = 0; i < from_len; i++ )
+    {
+        if( trim_done == BOAT_FALSE && from_ptr[i] == 0 )
+        {
+            continue;
+        }
+
+        for( j = 0; j < 2; j++ )
+        {
+            halfbyte = (from_ptr[i] >> (4 - j * 4)) & 0x0F;
+            if( trim_done == BOAT_FALSE && trim_mode == BIN2HEX_LEFTTRIM_QUANTITY && halfbyte == 0 )
+            {
+                continue;
+            }
+            to_str[to_offset++] = halfbyte < 10 ? halfbyte + '0' : halfbyte - 10 + 'a';
+            trim_done = BOAT_TRUE;
+        }
+    }
+
+    if( to_offset == (prefix_0x_mode == BIN2HEX_PREFIX_0x_YES ? 2 : 0) )
+    {
+        if( zero_as_null == BOAT_FALSE )
+        {
+            to_str[to_offset++] = '0';
+            if( trim_mode != BIN2HEX_LEFTTRIM_QUANTITY )
+            {
+                to_str[to_offset++] = '0';
+            }
+        }
+        else
+        {
+            to_offset = 0;
+        }
+    }
+
+    to_str[to_offset] = '\0';
+
+    return to_offset;
+}
+
+
+// UtilityHex2Bin() before the kernels, a digit at a time
+static BUINT32 Case_48_RefHex2Bin(BUINT8 *to_ptr, BUINT32 to_size, const BCHAR *from_str,
+                                  TRIMBIN_TRIM_MODE trim_mode, BBOOL zero_as_null)
+{
+    BUINT32 from_len = strlen(from_str);
+    BUINT32 from_offset = 0;
+    BUINT32 to_offset = 0;
+    BUINT32 odd_flag = from_len & 0x01;
+    BUINT8 octet = 0;
+    BUINT8 halfbyte;
+    BCHAR halfbytechar;
+    BBOOL trim_done = (trim_mode == TRIMBIN_TRIM_NO) ? BOAT_TRUE : BOAT_FALSE;
+
+    if( from_len > 2 && from_str[0] == '0' && (from_str[1] == 'x' || from_str[1] == 'X') )
+    {
+        from_offset = 2;
+    }
+
+    for( ; from_offset < from_len; from_offset++ )
+    {
+        halfbytechar = from_str[from_offset];
+        if( halfbytechar >= '0' && halfbytechar <= '9' )
+        {
+            halfbyte = halfbytechar - '0';
+        }
+        else if( halfbytechar >= 'A' && halfbytechar <= 'F' )
+        {
+            halfbyte = halfbytechar - 'A' + 10;
+        }
+        else if( halfbytechar >= 'a' && halfbytechar <= 'f' )
+        {
+            halfbyte = halfbytechar - 'a' + 10;
+        }
+        else
+        {
+            return 0;
+        }
+
+        if( (from_offset & 0x01) == odd_flag )
+        {
+            octet = halfbyte << 4;
+            continue;
+        }
+
+        octet |= halfbyte;
+        if( trim_done == BOAT_FALSE && octet == 0 )
+        {
+            continue;
+        }
+        trim_done = BOAT_TRUE;
+
+        to_ptr[to_offset++] = octet;
+        if( to_offset >= to_size )
+        {
+            break;
+        }
+    }
+
+    if( to_offset == 0 && zero_as_null == BOAT_FALSE )
+    {
+        to_ptr[0] = 0;
+        to_offset = 1;
+    }
+
+    return to_offset;
+}
+
+
+// Random bytes, with a random number of leading zeros and a random high nibble after them
+static void Case_48_RandomBin(BUINT8 *bin_ptr, BUINT32 len)
+{
+    BUINT32 zero_len = (len > 0) ? (BUINT32)rand() % (len + 1) : 0;
+    BUINT32 i;
+
+    for( i = 0; i < len; i++ )
+    {
+        bin_ptr[i] = (i < zero_len) ? 0 : (BUINT8)rand();
+    }
+
+    if( zero_len < len && (rand() & 1) != 0 )
+    {
+        bin_ptr[zero_len] &= 0x0F;
+    }
+}
+
+
+// Converting to HEX matches the reference for every kernel and every mode
+static BOAT_RESULT Case_48_Bin2Hex(void)
+{
+    static BUINT8 bin_array[CASE_48_MAX_LEN];
+    static BCHAR hex_str[CASE_48_MAX_LEN * 2 + 3];
+    static BCHAR ref_str[CASE_48_MAX_LEN * 2 + 3];
+    BoatHexKernel default_kernel = BoatHexGetKernel();
+    BUINT32 hex_len;
+    BUINT32 ref_len;
+    BUINT32 kernel, len, round, trim_mode, prefix_0x_mode, zero_as_null;
+    BUINT32 kernel_num = 0;
+    BBOOL is_pass = BOAT_TRUE;
+
+    srand(48);
+
+    for( kernel = 0; kernel < BOAT_HEX_KERNEL_NUM; kernel++ )
+    {
+        if( BoatHexSetKernel(kernel) != BOAT_SUCCESS )
+        {
+            continue;
+        }
+        kernel_num++;
+
+        for( len = 0; len <= CASE_48_MAX_LEN && is_pass == BOAT_TRUE; len++ )
+        {
+            for( round = 0; round < CASE_48_ROUNDS; round++ )
+            {
+                Case_48_RandomBin(bin_array, len);
+
+                for( trim_mode = BIN2HEX_LEFTTRIM_UNFMTDATA; trim_mode <= BIN2HEX_LEFTTRIM_TWOHEXPERBYTE; trim_mode++ )
+                for( prefix_0x_mode = BIN2HEX_PREFIX_0x_NO; prefix_0x_mode <= BIN2HEX_PREFIX_0x_YES; prefix_0x_mode++ )
+                for( zero_as_null = BOAT_FALSE; zero_as_null <= BOAT_TRUE; zero_as_null++ )
+                {
+                    hex_len = UtilityBin2Hex(hex_str, bin_array, len, trim_mode, prefix_0x_mode, zero_as_null);
+                    ref_len = Case_48_RefBin2Hex(ref_str, bin_array, len, trim_mode, prefix_0x_mode, zero_as_null);
+
+                    if( hex_len != ref_len || strcmp(hex_str, ref_str) != 0 )
+                    {
+                        BoatLog(BOAT_LOG_NORMAL, "%s: %u bytes, mode %u/%u/%u: \"%s\" != \"%s\".",
+                                g_case_48_kernel_name_str[kernel], len, trim_mode, prefix_0x_mode,
+                                zero_as_null, hex_str, ref_str);
+                        is_pass = BOAT_FALSE;
+                    }
+                }
+            }
+        }
+    }
+
+    BoatHexSetKernel(default_kernel);
+
+    BoatLog(BOAT_LOG_NORMAL, "%u kernels checked, %s in use.", kernel_num, g_case_48_kernel_name_str[default_kernel]);
+
+    BoatDisplayTestResult(is_pass, "Case_48_HexBin2Hex_4801");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BBOOL Case_48_Hex2BinMatch(BoatHexKernel kernel, const BCHAR *hex_str, BUINT32 to_size)
+{
+    static BUINT8 bin_array[CASE_48_MAX_LEN + 1];
+    static BUINT8 ref_array[CASE_48_MAX_LEN + 1];
+    BUINT32 bin_len;
+    BUINT32 ref_len;
+    BUINT32 trim_mode, zero_as_null;
+    BBOOL is_match = BOAT_TRUE;
+
+    for( trim_mode = TRIMBIN_TRIM_NO; trim_mode <= TRIMBIN_LEFTTRIM; trim_mode++ )
+    for( zero_as_null = BOAT_FALSE; zero_as_null <= BOAT_TRUE; zero_as_null++ )
+    {
+        bin_len = UtilityHex2Bin(bin_array, to_size, hex_str, trim_mode, zero_as_null);
+        ref_len = Case_48_RefHex2Bin(ref_array, to_size, hex_str, trim_mode, zero_as_null);
+
+        if( bin_len != ref_len || memcmp(bin_array, ref_array, bin_len) != 0 )
+        {
+            BoatLog(BOAT_LOG_CRITICAL, "%s: \"%s\" to %u bytes, mode %u/%u: %u bytes != %u bytes.",
+                    g_case_48_kernel_name_str[kernel], hex_str, to_size, trim_mode, zero_as_null,
+                    bin_len, ref_len);
+            is_match = BOAT_FALSE;
+        }
+    }
+
+    return is_match;
+}
+
+
+// Converting from HEX matches the reference for every kernel and every mode,
+// and rejects a non-HEX character wherever it is
+static BOAT_RESULT Case_48_Hex2Bin(void)
+{
+    static BUINT8 bin_array[CASE_48_MAX_LEN];
+    static BCHAR hex_str[CASE_48_MAX_LEN * 2 + 3];
+    BoatHexKernel default_kernel = BoatHexGetKernel();
+    BCHAR *digit_str;
+    BUINT32 kernel, len, round, i, j;
+    BUINT32 digit_len;
+    BUINT32 to_size;
+    BBOOL is_pass = BOAT_TRUE;
+
+    // Rejected characters are logged
+    BoatLogSetLevel(BOAT_LOG_CRITICAL);
+
+    srand(4802);
+
+    for( kernel = 0; kernel < BOAT_HEX_KERNEL_NUM; kernel++ )
+    {
+        if( BoatHexSetKernel(kernel) != BOAT_SUCCESS )
+        {
+            continue;
+        }
+
+        for( len = 0; len <= CASE_48_MAX_LEN && is_pass == BOAT_TRUE; len++ )
+        {
+            for( round = 0; round < CASE_48_ROUNDS; round++ )
+            {
+                Case_48_RandomBin(bin_array, len);
+                UtilityBin2Hex(hex_str, bin_array, len, BIN2HEX_LEFTTRIM_UNFMTDATA,
+                               (round & 1) ? BIN2HEX_PREFIX_0x_YES : BIN2HEX_PREFIX_0x_NO, BOAT_FALSE);
+                if( (round & 1) != 0 )
+                {
+                    hex_str[1] = 'X';
+                }
+
+                digit_str = hex_str + ((round & 1) ? 2 : 0);
+                digit_len = strlen(digit_str);
+
+                // Mixed case, and an odd number of digits every other round
+                for( i = 0; i < digit_len; i++ )
+                {
+                    if( (rand() & 1) != 0 && digit_str[i] >= 'a' )
+                    {
+                        digit_str[i] -= 'a' - 'A';
+                    }
+                }
+                if( round >= 2 && digit_len > 0 )
+                {
+                    memmove(digit_str, digit_str + 1, digit_len--);
+                }
+
+                // Large enough, and too small
+                to_size = (digit_len + 1) / 2;
+                is_pass = is_pass && Case_48_Hex2BinMatch(kernel, hex_str, to_size + 1);
+                if( to_size > 1 )
+                {
+                    is_pass = is_pass && Case_48_Hex2BinMatch(kernel, hex_str, 1 + (BUINT32)rand() % (to_size - 1));
+                }
+            }
+        }
+
+        // A non-HEX character at every position of a string of digits, behind leading zeros
+        memset(hex_str, 'a', 2 * CASE_48_MAX_LEN);
+        hex_str[2 * CASE_48_MAX_LEN] = '\0';
+
+        for( i = 0; i < 2 * CASE_48_MAX_LEN && is_pass == BOAT_TRUE; i++ )
+        {
+            for( j = 0; j < sizeof(g_case_48_nonhex_array); j++ )
+            {
+                hex_str[i] = (BCHAR)g_case_48_nonhex_array[j];
+
+                // Except for "0x" prefix
+                is_pass =    is_pass
+                          && (   (i == 1 && (hex_str[i] | 0x20) == 'x')
+                              || UtilityHex2Bin(bin_array, CASE_48_MAX_LEN, hex_str, TRIMBIN_TRIM_NO, BOAT_FALSE) == 0)
+                          && Case_48_Hex2BinMatch(kernel, hex_str, CASE_48_MAX_LEN)
+                          && Case_48_Hex2BinMatch(kernel, hex_str, i / 2 + 1);
+            }
+            hex_str[i] = '0';
+        }
+    }
+
+    BoatHexSetKernel(default_kernel);
+    BoatLogSetLevel(BOAT_LOG_LEVEL);
+
+    BoatDisplayTestResult(is_pass, "Case_48_HexHex2Bin_4802");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Throughput of each kernel from 32 bytes to 1 MB, which all give the same result
+static BOAT_RESULT Case_48_Bench(void)
+{
+    BoatHexKernel default_kernel = BoatHexGetKernel();
+    BUINT8 *bin_ptr = malloc(CASE_48_BENCH_MAX_LEN);
+    BUINT8 *back_ptr = malloc(CASE_48_BENCH_MAX_LEN);
+    BCHAR *hex_str = malloc(CASE_48_BENCH_MAX_LEN * 2 + 3);
+    BCHAR *ref_str = malloc(CASE_48_BENCH_MAX_LEN * 2 + 3);
+    BUINT64 begin_ns;
+    BUINT64 encode_ns;
+    BUINT64 decode_ns;
+    BUINT32 kernel, len, i, repeat_num;
+    BBOOL is_pass = BOAT_TRUE;
+
+    if( bin_ptr == NULL || back_ptr == NULL || hex_str == NULL || ref_str == NULL )
+    {
+        is_pass = BOAT_FALSE;
+    }
+
+    for( i = 0; i < CASE_48_BENCH_MAX_LEN && is_pass == BOAT_TRUE; i++ )
+    {
+        bin_ptr[i] = (BUINT8)(i * 131 + 7);
+    }
+
+    for( len = 32; len <= CASE_48_BENCH_MAX_LEN && is_pass == BOAT_TRUE; len *= 8 )
+    {
+        repeat_num = CASE_48_BENCH_BYTES / len;
+
+        BoatHexSetKernel(BOAT_HEX_KERNEL_PORTABLE);
+        UtilityBin2Hex(ref_str, bin_ptr, len, BIN2HEX_LEFTTRIM_UNFMTDATA, BIN2HEX_PREFIX_0x_YES, BOAT_FALSE);
+
+        for( kernel = 0; kernel < BOAT_HEX_KERNEL_NUM; kernel++ )
+        {
+            if( BoatHexSetKernel(kernel) != BOAT_SUCCESS )
+            {
+                continue;
+            }
+
+            begin_ns = TestNowNs();
+            for( i = 0; i < repeat_num; i++ )
+            {
+                UtilityBin2Hex(hex_str, bin_ptr, len, BIN2HEX_LEFTTRIM_UNFMTDATA, BIN2HEX_PREFIX_0x_YES, BOAT_FALSE);
+            }
+            encode_ns = TestNowNs() - begin_ns;
+
+            begin_ns = TestNowNs();
+            for( i = 0; i < repeat_num; i++ )
+            {
+                UtilityHex2Bin(back_ptr, len, hex_str, TRIMBIN_TRIM_NO, BOAT_FALSE);
+            }
+            decode_ns = TestNowNs() - begin_ns;
+
+            is_pass =    is_pass
+                      && strcmp(hex_str, ref_str) == 0
+                      && memcmp(back_ptr, bin_ptr, len) == 0;
+
+            // Bytes per nanosecond is GB/s, reported as MB/s
+            BoatLog(BOAT_LOG_NORMAL, "%7u bytes, %-8s: encode %8.1f MB/s, decode %8.1f MB/s.",
+                    len, g_case_48_kernel_name_str[kernel],
+                    (double)len * repeat_num * 1000.0 / (encode_ns + 1),
+                    (double)len * repeat_num * 1000.0 / (decode_ns + 1));
+        }
+    }
+
+    BoatHexSetKernel(default_kernel);
+
+    free(bin_ptr);
+    free(back_ptr);
+    free(hex_str);
+    free(ref_str);
+
+    BoatDisplayTestResult(is_pass, "Case_48_HexBench_4803");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_48_HexMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_48_Bin2Hex();
+    case_result += Case_48_Hex2Bin();
+    case_result += Case_48_Bench();
+
+    return case_result;
+}
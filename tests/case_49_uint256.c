@@ -0,0 +1,382 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+#include "testhelper.h"
+
+#define CASE_49_ROUNDS       20000
+#define CASE_49_BENCH_ROUNDS 200000
+
+// 2^256 - 1
+#define CASE_49_UINT256_MAX_DEC_STR "115792089237316195423570985008687907853269984665640564039457584007913129639935"
+#define CASE_49_UINT256_MAX_HEX_STR "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+// -2^255 and 2^255 - 1
+#define CASE_49_INT256_MIN_DEC_STR  "-57896044618658097711785492504343953926634992332820282019728792003956564819968"
+#define CASE_49_INT256_MAX_DEC_STR  "57896044618658097711785492504343953926634992332820282019728792003956564819967"
+
+
+// Digits likely to need the corrections of long division, or random ones
+static BUINT32 Case_49_RandomDigit(void)
+{
+    switch( rand() % 6 )
+    {
+        case 0:  return 0;
+        case 1:  return 0xFFFFFFFF;
+        case 2:  return 0x80000000;
+        case 3:  return 1;
+        default: return ((BUINT32)rand() << 16) ^ (BUINT32)rand();
+    }
+}
+
+
+// A random integer of 0 ~ 8 significant 32-bit digits
+static void Case_49_RandomUint256(BUINT64 limb[4])
+{
+    BUINT32 digit_num = rand() % 9;
+    BUINT32 digit;
+    BUINT32 i;
+
+    memset(limb, 0, 4 * sizeof(BUINT64));
+
+    for( i = 0; i < digit_num; i++ )
+    {
+        digit = Case_49_RandomDigit();
+        limb[i / 2] |= (BUINT64)digit << (32 * (i % 2));
+    }
+}
+
+
+// Formatting and parsing of known values, and rejection of invalid strings
+static BOAT_RESULT Case_49_Uint256Vector(void)
+{
+    BUINT256 a, b, c;
+    BCHAR str[BOAT_UINT256_DEC_STR_SIZE];
+    BUINT8 bin_array[33];
+    BBOOL is_pass = BOAT_TRUE;
+
+    // 2^256 - 1 round trips
+    is_pass = is_pass && UtilityUint256FromDecStr(&a, CASE_49_UINT256_MAX_DEC_STR) == BOAT_SUCCESS;
+    is_pass = is_pass && a.limb[0] == ~0ull && a.limb[1] == ~0ull && a.limb[2] == ~0ull && a.limb[3] == ~0ull;
+    is_pass = is_pass && UtilityUint256ToDecStr(str, sizeof(str), &a) == strlen(CASE_49_UINT256_MAX_DEC_STR);
+    is_pass = is_pass && strcmp(str, CASE_49_UINT256_MAX_DEC_STR) == 0;
+    is_pass = is_pass && UtilityUint256ToHex(str, &a, BIN2HEX_PREFIX_0x_YES) == 66;
+    is_pass = is_pass && strcmp(str, CASE_49_UINT256_MAX_HEX_STR) == 0;
+    is_pass = is_pass && UtilityUint256FromHex(&b, CASE_49_UINT256_MAX_HEX_STR) == BOAT_SUCCESS;
+    is_pass = is_pass && UtilityUint256Compare(&a, &b) == 0;
+
+    // One more than 2^256 - 1
+    is_pass = is_pass && UtilityUint256FromDecStr(&b, "115792089237316195423570985008687907853269984665640564039457584007913129639936") == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0x10000000000000000000000000000000000000000000000000000000000000000") == BOAT_ERROR_INTEGER_OVERFLOW;
+    // Leading zeros don't overflow
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0x0000ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff") == BOAT_SUCCESS;
+    is_pass = is_pass && UtilityUint256Compare(&a, &b) == 0;
+    is_pass = is_pass && UtilityUint256FromDecStr(&b, "000000000000000000000000000000000000000000000000000000000000000000000000000000000042") == BOAT_SUCCESS;
+    is_pass = is_pass && b.limb[0] == 42 && b.limb[1] == 0 && b.limb[2] == 0 && b.limb[3] == 0;
+
+    // Zero
+    UtilityUint256FromUint64(&c, 0);
+    is_pass = is_pass && UtilityUint256ToDecStr(str, sizeof(str), &c) == 1 && strcmp(str, "0") == 0;
+    is_pass = is_pass && UtilityUint256ToHex(str, &c, BIN2HEX_PREFIX_0x_YES) == 3 && strcmp(str, "0x0") == 0;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0x0") == BOAT_SUCCESS && UtilityUint256Compare(&b, &c) == 0;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "00") == BOAT_SUCCESS && UtilityUint256Compare(&b, &c) == 0;
+
+    // Odd number of HEX digits without prefix
+    is_pass = is_pass && UtilityUint256FromHex(&b, "abc") == BOAT_SUCCESS && b.limb[0] == 0xABC;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0XDE0B6B3A7640000") == BOAT_SUCCESS && b.limb[0] == 1000000000000000000ull;
+
+    // Invalid strings
+    is_pass = is_pass && UtilityUint256FromHex(&b, "") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0x") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "0x12g4") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromHex(&b, "-1") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromDecStr(&b, "") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromDecStr(&b, "12a") == BOAT_ERROR_INVALID_ARGUMENT;
+    is_pass = is_pass && UtilityUint256FromDecStr(&b, "-1") == BOAT_ERROR_INVALID_ARGUMENT;
+
+    // Buffer one byte too small
+    is_pass = is_pass && UtilityUint256ToDecStr(str, strlen(CASE_49_UINT256_MAX_DEC_STR), &a) == 0;
+
+    // Bigendian
+    UtilityUint256FromUint64(&b, 0x0102030405060708ull);
+    UtilityUint256ToBigendian(bin_array, &b);
+    is_pass = is_pass && bin_array[0] == 0 && bin_array[23] == 0 && bin_array[24] == 1 && bin_array[31] == 8;
+    is_pass = is_pass && UtilityUint256FromBigendian(&c, bin_array + 24, 8) == BOAT_SUCCESS && UtilityUint256Compare(&b, &c) == 0;
+    memset(bin_array, 0, sizeof(bin_array));
+    bin_array[32] = 7;
+    is_pass = is_pass && UtilityUint256FromBigendian(&c, bin_array, 33) == BOAT_SUCCESS && c.limb[0] == 7;
+    bin_array[0] = 1;
+    is_pass = is_pass && UtilityUint256FromBigendian(&c, bin_array, 33) == BOAT_ERROR_INTEGER_OVERFLOW;
+
+    // Overflow wraps
+    UtilityUint256FromUint64(&b, 1);
+    is_pass = is_pass && UtilityUint256Add(&c, &a, &b) == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && (c.limb[0] | c.limb[1] | c.limb[2] | c.limb[3]) == 0;
+    is_pass = is_pass && UtilityUint256Sub(&c, &c, &b) == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityUint256Compare(&a, &c) == 0;
+    is_pass = is_pass && UtilityUint256Mul(&c, &a, &a) == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityUint256Compare(&b, &c) == 0;
+
+    // Division by 0
+    UtilityUint256FromUint64(&c, 0);
+    is_pass = is_pass && UtilityUint256DivMod(&b, NULL, &a, &c) == BOAT_ERROR_INVALID_ARGUMENT;
+
+    BoatDisplayTestResult(is_pass, "Case_49_Uint256Vector_4901");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Arithmetic of random integers, checked against native integers and against
+// the identity of division, which only the true quotient and remainder meet
+static BOAT_RESULT Case_49_Uint256Random(void)
+{
+    BUINT256 a, b, q, r, t;
+    BCHAR str[BOAT_UINT256_DEC_STR_SIZE];
+    BUINT64 x, y;
+    BUINT32 round;
+    BBOOL is_pass = BOAT_TRUE;
+
+    srand(49);
+
+    for( round = 0; round < CASE_49_ROUNDS && is_pass == BOAT_TRUE; round++ )
+    {
+        Case_49_RandomUint256(a.limb);
+        Case_49_RandomUint256(b.limb);
+        if( (b.limb[0] | b.limb[1] | b.limb[2] | b.limb[3]) == 0 )
+        {
+            b.limb[0] = round + 1;
+        }
+
+        // Division: a = q * b + r, r < b
+        is_pass = is_pass && UtilityUint256DivMod(&q, &r, &a, &b) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&r, &b) < 0;
+        is_pass = is_pass && UtilityUint256Mul(&t, &q, &b) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Add(&t, &t, &r) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&t, &a) == 0;
+
+        // In place, and either output alone
+        t = a;
+        is_pass = is_pass && UtilityUint256DivMod(&t, NULL, &t, &b) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&t, &q) == 0;
+        t = a;
+        is_pass = is_pass && UtilityUint256DivMod(NULL, &t, &t, &b) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&t, &r) == 0;
+
+        // Subtraction undoes addition, modulo 2^256 too
+        UtilityUint256Add(&t, &a, &b);
+        UtilityUint256Sub(&t, &t, &b);
+        is_pass = is_pass && UtilityUint256Compare(&t, &a) == 0;
+        is_pass = is_pass && (UtilityUint256Sub(&t, &a, &b) == BOAT_SUCCESS) == (UtilityUint256Compare(&a, &b) >= 0);
+
+        // Decimal and HEX round trips
+        is_pass = is_pass && UtilityUint256ToDecStr(str, sizeof(str), &a) != 0;
+        is_pass = is_pass && UtilityUint256FromDecStr(&t, str) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&t, &a) == 0;
+        is_pass = is_pass && UtilityUint256ToHex(str, &a, BIN2HEX_PREFIX_0x_NO) != 0;
+        is_pass = is_pass && UtilityUint256FromHex(&t, str) == BOAT_SUCCESS;
+        is_pass = is_pass && UtilityUint256Compare(&t, &a) == 0;
+
+        // Native 64-bit integers
+        x = a.limb[0];
+        y = b.limb[0] | 1;
+        UtilityUint256FromUint64(&a, x);
+        UtilityUint256FromUint64(&b, y);
+        UtilityUint256DivMod(&q, &r, &a, &b);
+        is_pass = is_pass && q.limb[0] == x / y && r.limb[0] == x % y && (q.limb[1] | r.limb[1]) == 0;
+        UtilityUint256Add(&t, &a, &b);
+        is_pass = is_pass && t.limb[0] == x + y && t.limb[1] == (x + y < x ? 1 : 0);
+        UtilityUint256ToDecStr(str, sizeof(str), &a);
+        is_pass = is_pass && strtoull(str, NULL, 10) == x;
+
+        if( is_pass != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Round %u fails.", round);
+        }
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_49_Uint256Random_4902");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Signed limits, overflow detection and truncated division
+static BOAT_RESULT Case_49_Int256(void)
+{
+    BSINT256 min, max, a, b, q, r, t;
+    BCHAR str[BOAT_UINT256_DEC_STR_SIZE];
+    BUINT8 bin_array[32];
+    BSINT64 x, y;
+    BUINT32 round;
+    BBOOL is_pass = BOAT_TRUE;
+
+    is_pass = is_pass && UtilityInt256FromDecStr(&min, CASE_49_INT256_MIN_DEC_STR) == BOAT_SUCCESS;
+    is_pass = is_pass && min.limb[3] == 0x8000000000000000ull && (min.limb[0] | min.limb[1] | min.limb[2]) == 0;
+    is_pass = is_pass && UtilityInt256ToDecStr(str, sizeof(str), &min) != 0 && strcmp(str, CASE_49_INT256_MIN_DEC_STR) == 0;
+    is_pass = is_pass && UtilityInt256FromDecStr(&max, CASE_49_INT256_MAX_DEC_STR) == BOAT_SUCCESS;
+    is_pass = is_pass && UtilityInt256ToDecStr(str, sizeof(str), &max) != 0 && strcmp(str, CASE_49_INT256_MAX_DEC_STR) == 0;
+    is_pass = is_pass && UtilityInt256Compare(&min, &max) < 0;
+
+    // Just out of range
+    is_pass = is_pass && UtilityInt256FromDecStr(&a, "-57896044618658097711785492504343953926634992332820282019728792003956564819969") == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityInt256FromDecStr(&a, "+57896044618658097711785492504343953926634992332820282019728792003956564819968") == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityInt256FromDecStr(&a, "-") == BOAT_ERROR_INVALID_ARGUMENT;
+
+    // Sign extension
+    UtilityInt256FromInt64(&a, -2);
+    UtilityInt256ToBigendian(bin_array, &a);
+    is_pass = is_pass && bin_array[0] == 0xFF && bin_array[31] == 0xFE;
+    is_pass = is_pass && UtilityInt256FromBigendian(&b, bin_array + 31, 1) == BOAT_SUCCESS && UtilityInt256Compare(&a, &b) == 0;
+    is_pass = is_pass && UtilityInt256ToDecStr(str, sizeof(str), &b) == 2 && strcmp(str, "-2") == 0;
+
+    // Overflows
+    UtilityInt256FromInt64(&a, 1);
+    is_pass = is_pass && UtilityInt256Add(&t, &max, &a) == BOAT_ERROR_INTEGER_OVERFLOW && UtilityInt256Compare(&t, &min) == 0;
+    is_pass = is_pass && UtilityInt256Sub(&t, &min, &a) == BOAT_ERROR_INTEGER_OVERFLOW && UtilityInt256Compare(&t, &max) == 0;
+    UtilityInt256FromInt64(&a, -1);
+    is_pass = is_pass && UtilityInt256Mul(&t, &min, &a) == BOAT_ERROR_INTEGER_OVERFLOW;
+    is_pass = is_pass && UtilityInt256DivMod(&t, NULL, &min, &a) == BOAT_ERROR_INTEGER_OVERFLOW && UtilityInt256Compare(&t, &min) == 0;
+    is_pass = is_pass && UtilityInt256Mul(&t, &max, &a) == BOAT_SUCCESS;
+    is_pass = is_pass && UtilityInt256Add(&t, &t, &a) == BOAT_SUCCESS && UtilityInt256Compare(&t, &min) == 0;
+    UtilityInt256FromInt64(&a, 2);
+    is_pass = is_pass && UtilityInt256Mul(&t, &max, &a) == BOAT_ERROR_INTEGER_OVERFLOW;
+    UtilityInt256FromInt64(&a, -2);
+    UtilityInt256FromInt64(&b, 0);
+    is_pass = is_pass && UtilityInt256DivMod(&q, &r, &min, &a) == BOAT_SUCCESS;
+    is_pass = is_pass && UtilityInt256Mul(&t, &q, &a) == BOAT_SUCCESS && UtilityInt256Compare(&t, &min) == 0;
+    is_pass = is_pass && UtilityInt256DivMod(&q, &r, &min, &b) == BOAT_ERROR_INVALID_ARGUMENT;
+
+    // Native 64-bit integers, away from the 64-bit limits
+    srand(4903);
+    for( round = 0; round < CASE_49_ROUNDS && is_pass == BOAT_TRUE; round++ )
+    {
+        x = (BSINT64)(((BUINT64)rand() << 31) ^ (BUINT64)rand()) - (1ll << 40);
+        y = (BSINT64)rand() - (RAND_MAX / 2);
+        if( round % 4 == 0 )
+        {
+            y = y % 7;
+        }
+        UtilityInt256FromInt64(&a, x);
+        UtilityInt256FromInt64(&b, y);
+
+        is_pass = is_pass && UtilityInt256Add(&t, &a, &b) == BOAT_SUCCESS && (BSINT64)t.limb[0] == x + y;
+        is_pass = is_pass && UtilityInt256Sub(&t, &a, &b) == BOAT_SUCCESS && (BSINT64)t.limb[0] == x - y;
+        is_pass = is_pass && UtilityInt256Mul(&t, &a, &b) == BOAT_SUCCESS && (BSINT64)t.limb[0] == x * y;
+        is_pass = is_pass && (UtilityInt256Compare(&a, &b) < 0) == (x < y);
+
+        if( y != 0 )
+        {
+            is_pass = is_pass && UtilityInt256DivMod(&q, &r, &a, &b) == BOAT_SUCCESS;
+            is_pass = is_pass && (BSINT64)q.limb[0] == x / y && (BSINT64)r.limb[0] == x % y;
+            // Sign extended to all limbs
+            is_pass = is_pass && q.limb[3] == (x / y < 0 ? ~0ull : 0) && r.limb[3] == (x % y < 0 ? ~0ull : 0);
+        }
+
+        UtilityInt256ToDecStr(str, sizeof(str), &a);
+        is_pass = is_pass && strtoll(str, NULL, 10) == x;
+        is_pass = is_pass && UtilityInt256FromDecStr(&t, str) == BOAT_SUCCESS && UtilityInt256Compare(&t, &a) == 0;
+
+        if( is_pass != BOAT_TRUE )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "Round %u fails: %lld, %lld.", round, (long long)x, (long long)y);
+        }
+    }
+
+    BoatDisplayTestResult(is_pass, "Case_49_Int256_4903");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Wei to ether formatting is exact, and the double float is the nearest one
+static BOAT_RESULT Case_49_WeiToEth(void)
+{
+    static const struct
+    {
+        const BCHAR *wei_str;
+        const BCHAR *eth_str;
+    }wei_vector_array[] =
+    {
+        {"0",                                       "0"},
+        {"1",                                       "0.000000000000000001"},
+        {"1000000000000000000",                     "1"},
+        {"1500000000000000001",                     "1.500000000000000001"},
+        {"123000000000000000000",                   "123"},
+        {"100000000000000000",                      "0.1"},
+        {"18446744073709551616",                    "18.446744073709551616"},
+        {CASE_49_UINT256_MAX_DEC_STR,               "115792089237316195423570985008687907853269984665640564039457.584007913129639935"},
+    };
+    BUINT256 wei;
+    BCHAR eth_str[BOAT_WEI_ETH_STR_SIZE];
+    BCHAR wei_hex_str[BOAT_UINT256_HEX_STR_SIZE];
+    BUINT64 begin_ns;
+    BUINT64 elapsed_ns;
+    volatile double eth_double = 0.0;
+    BUINT32 i;
+    BBOOL is_pass = BOAT_TRUE;
+
+    for( i = 0; i < sizeof(wei_vector_array) / sizeof(wei_vector_array[0]); i++ )
+    {
+        UtilityUint256FromDecStr(&wei, wei_vector_array[i].wei_str);
+
+        if(    UtilityWeiToEthStr(eth_str, sizeof(eth_str), &wei) != strlen(wei_vector_array[i].eth_str)
+            || strcmp(eth_str, wei_vector_array[i].eth_str) != 0 )
+        {
+            BoatLog(BOAT_LOG_NORMAL, "%s wei: \"%s\" != \"%s\".", wei_vector_array[i].wei_str, eth_str, wei_vector_array[i].eth_str);
+            is_pass = BOAT_FALSE;
+        }
+
+        UtilityUint256ToHex(wei_hex_str, &wei, BIN2HEX_PREFIX_0x_YES);
+        is_pass = is_pass && UtilityWeiStrToEthDouble(wei_hex_str) == strtod(wei_vector_array[i].eth_str, NULL);
+    }
+
+    // The longest string just fits
+    UtilityUint256FromDecStr(&wei, CASE_49_UINT256_MAX_DEC_STR);
+    is_pass = is_pass && UtilityWeiToEthStr(eth_str, BOAT_WEI_ETH_STR_SIZE - 1, &wei) == 0;
+
+    is_pass = is_pass && UtilityWeiStrToEthDouble("0xDE0B6B3A7640000") == 1.0;
+    is_pass = is_pass && UtilityWeiStrToEthDouble("0xZZ") == 0.0;
+
+    // Cost of a 256-bit balance, e.g. 2^255 + 1 wei
+    BoatLogSetLevel(BOAT_LOG_NORMAL);
+    begin_ns = TestNowNs();
+    for( i = 0; i < CASE_49_BENCH_ROUNDS; i++ )
+    {
+        eth_double += UtilityWeiStrToEthDouble("0x8000000000000000000000000000000000000000000000000000000000000001");
+    }
+    elapsed_ns = TestNowNs() - begin_ns;
+    BoatLogSetLevel(BOAT_LOG_LEVEL);
+
+    BoatLog(BOAT_LOG_NORMAL, "UtilityWeiStrToEthDouble() of 256 bits: %.1f ns.", (double)elapsed_ns / CASE_49_BENCH_ROUNDS);
+
+    BoatDisplayTestResult(is_pass, "Case_49_WeiToEth_4904");
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_49_Uint256Main(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_49_Uint256Vector();
+    case_result += Case_49_Uint256Random();
+    case_result += Case_49_Int256();
+    case_result += Case_49_WeiToEth();
+
+    return case_result;
+}
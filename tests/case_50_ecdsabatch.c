@@ -0,0 +1,342 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+#include "testhelper.h"
+#include "ecdsa_batch.h"
+
+// 37 items span two full batch chunks and a partial one
+#define CASE_50_ITEM_NUM     37
+#define CASE_50_THREAD_NUM   4
+#define CASE_50_BENCH_NUM    256
+#define CASE_50_BENCH_ROUNDS 4
+
+
+typedef struct TCase50Sig
+{
+    BUINT8 digest[32];
+    BUINT8 sig[64];
+    BUINT8 pub_key[65];
+    BUINT8 pub_key_out[65];
+    BUINT8 ref_pub_key[65];
+    int recid;
+    int ref_result;
+}Case50Sig;
+
+
+static Case50Sig g_case50_sigs[CASE_50_BENCH_NUM];
+static ecdsa_batch_item g_case50_items[CASE_50_BENCH_NUM];
+
+
+// Sign count digests with different keys. Public keys alternate between the
+// compressed and uncompressed form.
+static void Case_50_MakeSigs(BUINT32 count)
+{
+    BUINT8 priv_key[32];
+    BUINT8 pby;
+    BUINT32 i;
+
+    memset(priv_key, 0x5c, sizeof(priv_key));
+
+    for( i = 0; i < count; i++ )
+    {
+        keccak_256(priv_key, 32, priv_key);
+        keccak_256(priv_key, 32, g_case50_sigs[i].digest);
+        ecdsa_sign_digest(&secp256k1, priv_key, g_case50_sigs[i].digest,
+                          g_case50_sigs[i].sig, &pby, NULL);
+        g_case50_sigs[i].recid = pby;
+
+        if( i % 2 == 0 )
+        {
+            ecdsa_get_public_key65(&secp256k1, priv_key, g_case50_sigs[i].pub_key);
+        }
+        else
+        {
+            ecdsa_get_public_key33(&secp256k1, priv_key, g_case50_sigs[i].pub_key);
+        }
+    }
+
+    memset(priv_key, 0x00, sizeof(priv_key));
+}
+
+
+// Break some of the signatures so that every error path of the batch code is
+// taken next to valid items in the same chunk
+static void Case_50_TamperSigs(void)
+{
+    // digest changed after signing: verify fails, recover yields another key
+    g_case50_sigs[3].digest[7] ^= 0x01;
+    // r = 0
+    memset(g_case50_sigs[5].sig, 0x00, 32);
+    // s >= n
+    memset(g_case50_sigs[8].sig + 32, 0xff, 32);
+    // public key not on the curve
+    g_case50_sigs[14].pub_key[64] ^= 0x01;
+    // public key prefix invalid
+    g_case50_sigs[15].pub_key[0] = 0x05;
+    // public key of another signer
+    memcpy(g_case50_sigs[17].pub_key, g_case50_sigs[16].pub_key, 65);
+    // s changed after signing
+    g_case50_sigs[20].sig[40] ^= 0x80;
+    // wrong recovery id parity: a different key is recovered
+    g_case50_sigs[22].recid ^= 1;
+    // recovery id 2/3: r + n is not a valid x coordinate
+    g_case50_sigs[25].recid |= 2;
+    // s = 0
+    memset(g_case50_sigs[33].sig + 32, 0x00, 32);
+}
+
+
+static void Case_50_SetupItems(BUINT32 count)
+{
+    BUINT32 i;
+
+    for( i = 0; i < count; i++ )
+    {
+        g_case50_items[i].sig         = g_case50_sigs[i].sig;
+        g_case50_items[i].digest      = g_case50_sigs[i].digest;
+        g_case50_items[i].pub_key     = g_case50_sigs[i].pub_key;
+        g_case50_items[i].pub_key_out = g_case50_sigs[i].pub_key_out;
+        g_case50_items[i].recid       = g_case50_sigs[i].recid;
+        g_case50_items[i].result      = -1;
+        memset(g_case50_sigs[i].pub_key_out, 0x00, 65);
+    }
+}
+
+
+static void Case_50_ReferenceResults(BUINT32 count, BBOOL recover)
+{
+    BUINT32 i;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( recover )
+        {
+            g_case50_sigs[i].ref_result = ecdsa_recover_pub_from_sig(&secp256k1, g_case50_sigs[i].ref_pub_key,
+                                                                      g_case50_sigs[i].sig, g_case50_sigs[i].digest,
+                                                                      g_case50_sigs[i].recid);
+        }
+        else
+        {
+            g_case50_sigs[i].ref_result = ecdsa_verify_digest(&secp256k1, g_case50_sigs[i].pub_key,
+                                                               g_case50_sigs[i].sig, g_case50_sigs[i].digest);
+        }
+    }
+}
+
+
+static BBOOL Case_50_CompareResults(BUINT32 count, BBOOL recover)
+{
+    BUINT32 i;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( g_case50_items[i].result != g_case50_sigs[i].ref_result )
+        {
+            BoatLog(BOAT_LOG_CRITICAL, "Item %u of %u: result %d, expected %d.",
+                    i, count, g_case50_items[i].result, g_case50_sigs[i].ref_result);
+            return BOAT_FALSE;
+        }
+        if( recover && g_case50_sigs[i].ref_result == 0
+            && memcmp(g_case50_sigs[i].pub_key_out, g_case50_sigs[i].ref_pub_key, 65) != 0 )
+        {
+            BoatLog(BOAT_LOG_CRITICAL, "Item %u of %u: recovered public key differs.", i, count);
+            return BOAT_FALSE;
+        }
+    }
+
+    return BOAT_TRUE;
+}
+
+
+// Run the batch and the threaded batch function on count items and compare
+// every item with the single signature function
+static BBOOL Case_50_CheckBatch(BUINT32 count, BBOOL recover)
+{
+    BBOOL is_pass;
+
+    Case_50_ReferenceResults(count, recover);
+
+    Case_50_SetupItems(count);
+    if( recover )
+    {
+        ecdsa_recover_pub_from_sig_batch(&secp256k1, g_case50_items, count);
+    }
+    else
+    {
+        ecdsa_verify_digest_batch(&secp256k1, g_case50_items, count);
+    }
+    is_pass = Case_50_CompareResults(count, recover);
+
+#if USE_ECDSA_BATCH_THREADS
+    Case_50_SetupItems(count);
+    if( recover )
+    {
+        is_pass = is_pass && ecdsa_recover_pub_from_sig_batch_mt(&secp256k1, g_case50_items, count, CASE_50_THREAD_NUM) == 0;
+    }
+    else
+    {
+        is_pass = is_pass && ecdsa_verify_digest_batch_mt(&secp256k1, g_case50_items, count, CASE_50_THREAD_NUM) == 0;
+    }
+    is_pass = is_pass && Case_50_CompareResults(count, recover);
+#endif
+
+    return is_pass;
+}
+
+
+static BOAT_RESULT Case_50_EcdsaBatchCrossCheck(void)
+{
+    BBOOL is_pass;
+    BBOOL has_error = BOAT_FALSE;
+    BUINT32 i;
+
+    Case_50_MakeSigs(CASE_50_ITEM_NUM);
+    Case_50_TamperSigs();
+
+    // an empty batch must not touch the items
+    Case_50_SetupItems(1);
+    ecdsa_verify_digest_batch(&secp256k1, g_case50_items, 0);
+    ecdsa_recover_pub_from_sig_batch(&secp256k1, g_case50_items, 0);
+#if USE_ECDSA_BATCH_THREADS
+    ecdsa_verify_digest_batch_mt(&secp256k1, g_case50_items, 0, CASE_50_THREAD_NUM);
+    ecdsa_recover_pub_from_sig_batch_mt(&secp256k1, g_case50_items, 0, CASE_50_THREAD_NUM);
+#endif
+    is_pass = (g_case50_items[0].result == -1);
+    BoatDisplayTestResult(is_pass, "Case_50_EcdsaBatchEmpty_5001");
+
+    // a single item, a partial chunk and all items including the broken ones
+    is_pass = Case_50_CheckBatch(1, BOAT_FALSE) && Case_50_CheckBatch(5, BOAT_FALSE)
+              && Case_50_CheckBatch(CASE_50_ITEM_NUM, BOAT_FALSE);
+    BoatDisplayTestResult(is_pass, "Case_50_EcdsaBatchVerify_5002");
+
+    is_pass = Case_50_CheckBatch(1, BOAT_TRUE) && Case_50_CheckBatch(5, BOAT_TRUE)
+              && Case_50_CheckBatch(CASE_50_ITEM_NUM, BOAT_TRUE);
+    BoatDisplayTestResult(is_pass, "Case_50_EcdsaBatchRecover_5003");
+
+    // make sure the tampered items really are rejected, not only consistent
+    Case_50_ReferenceResults(CASE_50_ITEM_NUM, BOAT_FALSE);
+    for( i = 0; i < CASE_50_ITEM_NUM; i++ )
+    {
+        if( (g_case50_sigs[i].ref_result == 0) !=
+            (i != 3 && i != 5 && i != 8 && i != 14 && i != 15 && i != 17 && i != 20 && i != 33) )
+        {
+            has_error = BOAT_TRUE;
+        }
+    }
+    BoatDisplayTestResult(!has_error, "Case_50_EcdsaBatchTampered_5004");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_50_EcdsaBatchBenchmark(void)
+{
+    double start;
+    double single_sec;
+    double batch_sec;
+    double mt_sec = 0;
+    BUINT32 round;
+    BUINT32 i;
+    int recover;
+
+    Case_50_MakeSigs(CASE_50_BENCH_NUM);
+
+    for( recover = 0; recover < 2; recover++ )
+    {
+        Case_50_SetupItems(CASE_50_BENCH_NUM);
+
+        start = TestNow();
+        for( round = 0; round < CASE_50_BENCH_ROUNDS; round++ )
+        {
+            for( i = 0; i < CASE_50_BENCH_NUM; i++ )
+            {
+                if( recover )
+                {
+                    ecdsa_recover_pub_from_sig(&secp256k1, g_case50_sigs[i].ref_pub_key, g_case50_sigs[i].sig,
+                                               g_case50_sigs[i].digest, g_case50_sigs[i].recid);
+                }
+                else
+                {
+                    ecdsa_verify_digest(&secp256k1, g_case50_sigs[i].pub_key,
+                                        g_case50_sigs[i].sig, g_case50_sigs[i].digest);
+                }
+            }
+        }
+        single_sec = TestNow() - start;
+
+        start = TestNow();
+        for( round = 0; round < CASE_50_BENCH_ROUNDS; round++ )
+        {
+            if( recover )
+            {
+                ecdsa_recover_pub_from_sig_batch(&secp256k1, g_case50_items, CASE_50_BENCH_NUM);
+            }
+            else
+            {
+                ecdsa_verify_digest_batch(&secp256k1, g_case50_items, CASE_50_BENCH_NUM);
+            }
+        }
+        batch_sec = TestNow() - start;
+
+#if USE_ECDSA_BATCH_THREADS
+        start = TestNow();
+        for( round = 0; round < CASE_50_BENCH_ROUNDS; round++ )
+        {
+            if( recover )
+            {
+                ecdsa_recover_pub_from_sig_batch_mt(&secp256k1, g_case50_items, CASE_50_BENCH_NUM, CASE_50_THREAD_NUM);
+            }
+            else
+            {
+                ecdsa_verify_digest_batch_mt(&secp256k1, g_case50_items, CASE_50_BENCH_NUM, CASE_50_THREAD_NUM);
+            }
+        }
+        mt_sec = TestNow() - start;
+#endif
+
+        BoatLog(BOAT_LOG_NORMAL, "%s %u signatures: single %.0f/s, batch %.0f/s, %d threads %.0f/s.",
+                recover ? "Recover" : "Verify",
+                CASE_50_BENCH_NUM * CASE_50_BENCH_ROUNDS,
+                CASE_50_BENCH_NUM * CASE_50_BENCH_ROUNDS / single_sec,
+                CASE_50_BENCH_NUM * CASE_50_BENCH_ROUNDS / batch_sec,
+                CASE_50_THREAD_NUM,
+                mt_sec > 0 ? CASE_50_BENCH_NUM * CASE_50_BENCH_ROUNDS / mt_sec : 0.0);
+    }
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_50_EcdsaBatchMain(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_50_EcdsaBatchCrossCheck();
+    case_result += Case_50_EcdsaBatchBenchmark();
+
+    if( case_result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_50_EcdsaBatch Failed: %d.", case_result);
+    }
+    else
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_50_EcdsaBatch Passed.");
+    }
+
+    return case_result;
+}
@@ -0,0 +1,331 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#include "boatinternal.h"
+#include "testcommon.h"
+#include "sha2.h"
+
+#include <time.h>
+
+#define CASE_51_RANDOM_MSG_NUM  3000
+#define CASE_51_RANDOM_MSG_MAX  1024
+#define CASE_51_BENCH_BLOCKS    100000
+
+
+// FIPS 180-2 appendix B and C test vectors
+typedef struct TCase51Vector
+{
+    const BCHAR *msg;
+    BUINT32 repeat;
+    const BCHAR *sha256_hex;
+    const BCHAR *sha512_hex;
+}Case51Vector;
+
+static const Case51Vector g_case51_vectors[] =
+{
+    {
+        "abc", 1,
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+        "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"
+    },
+    // the 448-bit message of SHA-256, two blocks after padding
+    {
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+        NULL
+    },
+    // the 896-bit message of SHA-512, two blocks after padding
+    {
+        "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+        "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+        NULL,
+        "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+        "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"
+    },
+    // one million 'a'
+    {
+        "a", 1000000,
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+        "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+        "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b"
+    },
+};
+
+
+static BUINT32 Case_51_ReadBe32(const BUINT8 *p)
+{
+    return ((BUINT32)p[0] << 24) | ((BUINT32)p[1] << 16) | ((BUINT32)p[2] << 8) | p[3];
+}
+
+
+static void Case_51_TransformBlocks(BUINT32 state[8], const BUINT8 *blocks, BUINT32 num)
+{
+    BUINT32 data[16];
+    BUINT32 i;
+    BUINT32 j;
+
+    for( i = 0; i < num; i++ )
+    {
+        // sha256_Transform() takes the block as host order words
+        for( j = 0; j < 16; j++ )
+        {
+            data[j] = Case_51_ReadBe32(blocks + 64 * i + 4 * j);
+        }
+        sha256_Transform_sw(state, data, state);
+    }
+}
+
+
+// SHA-256 on top of the portable transform only, the reference for the
+// hardware path that sha256_Raw() takes on capable CPUs
+static void Case_51_Sha256Portable(const BUINT8 *msg, BUINT32 len, BUINT8 digest[32])
+{
+    BUINT32 state[8];
+    BUINT8 tail[128];
+    BUINT32 full = len / 64;
+    BUINT32 rest = len % 64;
+    BUINT32 tail_len = (rest + 9 <= 64) ? 64 : 128;
+    BUINT64 bit_len = (BUINT64)len * 8;
+    BUINT32 i;
+
+    memcpy(state, sha256_initial_hash_value, sizeof(state));
+    Case_51_TransformBlocks(state, msg, full);
+
+    memset(tail, 0x00, sizeof(tail));
+    memcpy(tail, msg + 64 * full, rest);
+    tail[rest] = 0x80;
+    for( i = 0; i < 8; i++ )
+    {
+        tail[tail_len - 1 - i] = (BUINT8)(bit_len >> (8 * i));
+    }
+    Case_51_TransformBlocks(state, tail, tail_len / 64);
+
+    for( i = 0; i < 32; i++ )
+    {
+        digest[i] = (BUINT8)(state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
+
+static BBOOL Case_51_CheckVector(const Case51Vector *vector, BBOOL is_sha512)
+{
+    SHA256_CTX ctx256;
+    SHA512_CTX ctx512;
+    BUINT8 expected[SHA512_DIGEST_LENGTH];
+    BUINT8 digest[SHA512_DIGEST_LENGTH];
+    BUINT32 digest_len = is_sha512 ? SHA512_DIGEST_LENGTH : SHA256_DIGEST_LENGTH;
+    BUINT32 msg_len = strlen(vector->msg);
+    BUINT32 i;
+
+    UtilityHex2Bin(expected, sizeof(expected), is_sha512 ? vector->sha512_hex : vector->sha256_hex,
+                   TRIMBIN_TRIM_NO, BOAT_FALSE);
+
+    if( is_sha512 )
+    {
+        sha512_Init(&ctx512);
+        for( i = 0; i < vector->repeat; i++ )
+        {
+            sha512_Update(&ctx512, (const BUINT8 *)vector->msg, msg_len);
+        }
+        sha512_Final(&ctx512, digest);
+    }
+    else
+    {
+        sha256_Init(&ctx256);
+        for( i = 0; i < vector->repeat; i++ )
+        {
+            sha256_Update(&ctx256, (const BUINT8 *)vector->msg, msg_len);
+        }
+        sha256_Final(&ctx256, digest);
+    }
+
+    if( memcmp(digest, expected, digest_len) != 0 )
+    {
+        return BOAT_FALSE;
+    }
+
+    // the same message in one piece
+    if( vector->repeat == 1 )
+    {
+        if( is_sha512 )
+        {
+            sha512_Raw((const BUINT8 *)vector->msg, msg_len, digest);
+        }
+        else
+        {
+            sha256_Raw((const BUINT8 *)vector->msg, msg_len, digest);
+        }
+        if( memcmp(digest, expected, digest_len) != 0 )
+        {
+            return BOAT_FALSE;
+        }
+    }
+
+    // the portable transform must reproduce the vector on its own
+    if( !is_sha512 && vector->repeat == 1 )
+    {
+        Case_51_Sha256Portable((const BUINT8 *)vector->msg, msg_len, digest);
+        if( memcmp(digest, expected, digest_len) != 0 )
+        {
+            return BOAT_FALSE;
+        }
+    }
+
+    return BOAT_TRUE;
+}
+
+
+static BOAT_RESULT Case_51_Sha2Vectors(void)
+{
+    BBOOL is_pass = BOAT_TRUE;
+    BUINT32 i;
+
+    for( i = 0; i < sizeof(g_case51_vectors) / sizeof(g_case51_vectors[0]); i++ )
+    {
+        if( g_case51_vectors[i].sha256_hex != NULL )
+        {
+            is_pass = is_pass && Case_51_CheckVector(&g_case51_vectors[i], BOAT_FALSE);
+        }
+    }
+    BoatDisplayTestResult(is_pass, "Case_51_Sha256Fips_5101");
+
+    for( i = 0; i < sizeof(g_case51_vectors) / sizeof(g_case51_vectors[0]); i++ )
+    {
+        if( g_case51_vectors[i].sha512_hex != NULL )
+        {
+            is_pass = is_pass && Case_51_CheckVector(&g_case51_vectors[i], BOAT_TRUE);
+        }
+    }
+    BoatDisplayTestResult(is_pass, "Case_51_Sha512Fips_5102");
+
+    return BOAT_SUCCESS;
+}
+
+
+// Compare sha256_Transform(), which takes the hardware path if the CPU
+// supports it, with the portable transform on random states and blocks and
+// on random length messages
+static BOAT_RESULT Case_51_Sha256HwCrossCheck(void)
+{
+    static BUINT8 msg[CASE_51_RANDOM_MSG_MAX];
+    BUINT8 seed[32];
+    BUINT32 state[8];
+    BUINT32 data[16];
+    BUINT32 hw_out[8];
+    BUINT32 sw_out[8];
+    BUINT8 digest[32];
+    BUINT8 ref_digest[32];
+    BUINT32 offset;
+    BUINT32 len;
+    BUINT32 i;
+    BUINT32 j;
+    BBOOL is_pass = BOAT_TRUE;
+
+    BoatLog(BOAT_LOG_NORMAL, "SHA-256 transform: %s.",
+            sha256_hw_supported() ? "hardware" : "portable (no hardware support, comparing portable with itself)");
+
+    memset(seed, 0x51, sizeof(seed));
+    for( i = 0; i < sizeof(msg); i += 32 )
+    {
+        keccak_256(seed, 32, seed);
+        memcpy(msg + i, seed, 32);
+    }
+
+    for( i = 0; i < CASE_51_RANDOM_MSG_NUM && is_pass; i++ )
+    {
+        keccak_256(seed, 32, seed);
+
+        // raw transform on a random state and block
+        for( j = 0; j < 8; j++ )
+        {
+            state[j] = Case_51_ReadBe32(seed + 4 * j);
+        }
+        for( j = 0; j < 16; j++ )
+        {
+            data[j] = Case_51_ReadBe32(msg + 4 * ((i + j) % (sizeof(msg) / 4)));
+        }
+        sha256_Transform(state, data, hw_out);
+        sha256_Transform_sw(state, data, sw_out);
+        is_pass = (memcmp(hw_out, sw_out, sizeof(hw_out)) == 0);
+
+        // whole message of random length, also at unaligned addresses
+        offset = i % 8;
+        len = Case_51_ReadBe32(seed + 28) % (sizeof(msg) - offset + 1);
+        sha256_Raw(msg + offset, len, digest);
+        Case_51_Sha256Portable(msg + offset, len, ref_digest);
+        is_pass = is_pass && (memcmp(digest, ref_digest, sizeof(digest)) == 0);
+    }
+    BoatDisplayTestResult(is_pass, "Case_51_Sha256HwCrossCheck_5103");
+
+    return BOAT_SUCCESS;
+}
+
+
+static BOAT_RESULT Case_51_Sha256Benchmark(void)
+{
+    BUINT32 state[8];
+    BUINT32 data[16];
+    clock_t start;
+    double hw_sec;
+    double sw_sec;
+    BUINT32 i;
+
+    memcpy(state, sha256_initial_hash_value, sizeof(state));
+    memset(data, 0x5a, sizeof(data));
+
+    start = clock();
+    for( i = 0; i < CASE_51_BENCH_BLOCKS; i++ )
+    {
+        sha256_Transform(state, data, state);
+    }
+    hw_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for( i = 0; i < CASE_51_BENCH_BLOCKS; i++ )
+    {
+        sha256_Transform_sw(state, data, state);
+    }
+    sw_sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    BoatLog(BOAT_LOG_NORMAL, "Compress %u blocks: sha256_Transform %.1f MB/s, portable %.1f MB/s.",
+            CASE_51_BENCH_BLOCKS,
+            CASE_51_BENCH_BLOCKS * 64 / hw_sec / 1000000,
+            CASE_51_BENCH_BLOCKS * 64 / sw_sec / 1000000);
+
+    return BOAT_SUCCESS;
+}
+
+
+BOAT_RESULT Case_51_Sha2Main(void)
+{
+    BOAT_RESULT case_result = BOAT_SUCCESS;
+
+    case_result += Case_51_Sha2Vectors();
+    case_result += Case_51_Sha256HwCrossCheck();
+    case_result += Case_51_Sha256Benchmark();
+
+    if( case_result != BOAT_SUCCESS )
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_51_Sha2 Failed: %d.", case_result);
+    }
+    else
+    {
+        BoatLog(BOAT_LOG_NORMAL, "Case_51_Sha2 Passed.");
+    }
+
+    return case_result;
+}
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "testhelper.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+
+static int g_test_node_listen_fd = -1;
+static pthread_t g_test_node_thread;
+static TestNodeResultCallback g_test_node_result_callback = NULL;
+static BUINT32 g_test_node_accept_num = 0;
+static BCHAR g_test_node_url_str[64];
+
+
+static void *TestNodeConnThread(void *arg)
+{
+    int fd = (int)(intptr_t)arg;
+    BCHAR buf[4096];
+    BCHAR body_str[256];
+    BCHAR response_str[512];
+    size_t buf_len = 0;
+    ssize_t read_len;
+    BCHAR *header_end_ptr;
+    BCHAR *length_ptr;
+    size_t request_len;
+
+    while( 1 )
+    {
+        buf[buf_len] = '\0';
+        header_end_ptr = strstr(buf, "\r\n\r\n");
+
+        if( header_end_ptr != NULL )
+        {
+            length_ptr = strstr(buf, "Content-Length:");
+            request_len = (header_end_ptr + 4 - buf) + ((length_ptr != NULL) ? strtoul(length_ptr + 15, NULL, 10) : 0);
+
+            if( buf_len >= request_len )
+            {
+                snprintf(body_str, sizeof(body_str), "{\"jsonrpc\":\"2.0\",\"id\":1,\"result\":%s}",
+                         g_test_node_result_callback(header_end_ptr));
+                snprintf(response_str, sizeof(response_str),
+                         "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %u\r\n\r\n%s",
+                         (unsigned)strlen(body_str), body_str);
+                if( write(fd, response_str, strlen(response_str)) < 0 )
+                {
+                    break;
+                }
+
+                memmove(buf, buf + request_len, buf_len - request_len);
+                buf_len -= request_len;
+                continue;
+            }
+        }
+
+        read_len = read(fd, buf + buf_len, sizeof(buf) - 1 - buf_len);
+        if( read_len <= 0 )
+        {
+            break;
+        }
+        buf_len += read_len;
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+
+static void *TestNodeThread(void *arg)
+{
+    pthread_t thread;
+    int fd;
+
+    (void)arg;
+
+    while( (fd = accept(g_test_node_listen_fd, NULL, NULL)) >= 0 )
+    {
+        __atomic_add_fetch(&g_test_node_accept_num, 1, __ATOMIC_RELAXED);
+        if( pthread_create(&thread, NULL, TestNodeConnThread, (void *)(intptr_t)fd) == 0 )
+        {
+            pthread_detach(thread);
+        }
+        else
+        {
+            close(fd);
+        }
+    }
+
+    return NULL;
+}
+
+
+BBOOL TestNodeStart(TestNodeResultCallback result_callback)
+{
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    g_test_node_result_callback = result_callback;
+    __atomic_store_n(&g_test_node_accept_num, 0, __ATOMIC_RELAXED);
+
+    g_test_node_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(    g_test_node_listen_fd < 0
+        || bind(g_test_node_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        || listen(g_test_node_listen_fd, 16) != 0
+        || getsockname(g_test_node_listen_fd, (struct sockaddr *)&addr, &addr_len) != 0 )
+    {
+        if( g_test_node_listen_fd >= 0 )
+        {
+            close(g_test_node_listen_fd);
+            g_test_node_listen_fd = -1;
+        }
+        return BOAT_FALSE;
+    }
+
+    sprintf(g_test_node_url_str, "http://127.0.0.1:%u", ntohs(addr.sin_port));
+
+    if( pthread_create(&g_test_node_thread, NULL, TestNodeThread, NULL) != 0 )
+    {
+        close(g_test_node_listen_fd);
+        g_test_node_listen_fd = -1;
+        return BOAT_FALSE;
+    }
+
+    return BOAT_TRUE;
+}
+
+
+void TestNodeStop(void)
+{
+    shutdown(g_test_node_listen_fd, SHUT_RDWR);
+    close(g_test_node_listen_fd);
+    pthread_join(g_test_node_thread, NULL);
+    g_test_node_listen_fd = -1;
+}
+
+
+const BCHAR *TestNodeUrl(void)
+{
+    return g_test_node_url_str;
+}
+
+
+BUINT32 TestNodeAcceptNum(void)
+{
+    return __atomic_load_n(&g_test_node_accept_num, __ATOMIC_RELAXED);
+}
+
+
+void TestNodeResetAcceptNum(void)
+{
+    __atomic_store_n(&g_test_node_accept_num, 0, __ATOMIC_RELAXED);
+}
+
+
+double TestNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+BUINT64 TestNowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (BUINT64)ts.tv_sec * 1000000000ull + (BUINT64)ts.tv_nsec;
+}
@@ -0,0 +1,38 @@
+/******************************************************************************
+ * Copyright (C) 2018-2021 aitos.io
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *****************************************************************************/
+
+#ifndef __TESTHELPER_H__
+#define __TESTHELPER_H__
+
+#include "boatiotsdk.h"
+
+// Returns the JSON value of the "result" member answering a JSON-RPC request
+typedef const BCHAR *(*TestNodeResultCallback)(const BCHAR *request_str);
+
+// A minimal keep-alive JSON-RPC node on 127.0.0.1, one at a time
+BBOOL TestNodeStart(TestNodeResultCallback result_callback);
+void TestNodeStop(void);
+const BCHAR *TestNodeUrl(void);
+
+// Number of connections accepted since TestNodeStart() or the last reset
+BUINT32 TestNodeAcceptNum(void);
+void TestNodeResetAcceptNum(void);
+
+// Monotonic wall clock time, in seconds and in nanoseconds
+double TestNow(void);
+BUINT64 TestNowNs(void);
+
+#endif
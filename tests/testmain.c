@@ -31,6 +31,50 @@ BOAT_RESULT Case_15_PlatONEMain(void);
 
 BOAT_RESULT Case_16_PlatONECovMain(void);
 
+BOAT_RESULT Case_30_SignerMain(void);
+
+BOAT_RESULT Case_31_BnInverseMain(void);
+
+BOAT_RESULT Case_32_KeccakMain(void);
+
+BOAT_RESULT Case_33_SignPoolMain(void);
+
+BOAT_RESULT Case_34_EcmultGenMain(void);
+
+BOAT_RESULT Case_35_KeystoreMain(void);
+
+BOAT_RESULT Case_36_PersistAeadMain(void);
+
+BOAT_RESULT Case_37_PersistStreamMain(void);
+
+BOAT_RESULT Case_38_WalletCacheMain(void);
+
+BOAT_RESULT Case_39_WalletRegistryMain(void);
+
+BOAT_RESULT Case_40_ThreadSafetyMain(void);
+
+BOAT_RESULT Case_41_EndpointPoolMain(void);
+
+BOAT_RESULT Case_42_MultiAccountMain(void);
+
+BOAT_RESULT Case_43_TxArenaMain(void);
+
+BOAT_RESULT Case_44_StaticPoolMain(void);
+
+BOAT_RESULT Case_45_MemAccountingMain(void);
+
+BOAT_RESULT Case_46_TxProfileMain(void);
+
+BOAT_RESULT Case_47_AsyncLogMain(void);
+
+BOAT_RESULT Case_48_HexMain(void);
+
+BOAT_RESULT Case_49_Uint256Main(void);
+
+BOAT_RESULT Case_50_EcdsaBatchMain(void);
+
+BOAT_RESULT Case_51_Sha2Main(void);
+
 int main(int argc, char *argv[])
 {
 
@@ -45,6 +89,29 @@ int main(int argc, char *argv[])
     case_result += Case_15_PlatONEMain();
     case_result += Case_16_PlatONECovMain();
 
+    //case_result += Case_30_SignerMain();
+    //case_result += Case_31_BnInverseMain();
+    //case_result += Case_32_KeccakMain();
+    //case_result += Case_33_SignPoolMain();
+    //case_result += Case_34_EcmultGenMain();
+    //case_result += Case_35_KeystoreMain();
+    //case_result += Case_36_PersistAeadMain();
+    //case_result += Case_37_PersistStreamMain();
+    //case_result += Case_38_WalletCacheMain();
+    //case_result += Case_39_WalletRegistryMain();
+    //case_result += Case_40_ThreadSafetyMain();
+    //case_result += Case_41_EndpointPoolMain();
+    //case_result += Case_42_MultiAccountMain();
+    //case_result += Case_43_TxArenaMain();
+    //case_result += Case_44_StaticPoolMain();
+    //case_result += Case_45_MemAccountingMain();
+    //case_result += Case_46_TxProfileMain();
+    //case_result += Case_47_AsyncLogMain();
+    //case_result += Case_48_HexMain();
+    //case_result += Case_49_Uint256Main();
+    //case_result += Case_50_EcdsaBatchMain();
+    //case_result += Case_51_Sha2Main();
+
     BoatLog(BOAT_LOG_NORMAL, "case_result: %d.", case_result);
     TestPostCondition();
     
@@ -92,9 +92,7 @@ generated_types_for_solidity_str = '''
     typedef BUINT8 Bbytes32[32];
 
     typedef Bbytes16 BUINT128;
-    typedef Bbytes16 SUINT128;
-    typedef Bbytes32 BUINT256;
-    typedef Bbytes32 SUINT256;
+    typedef Bbytes16 BSINT128;
 
 '''
 
@@ -187,13 +185,11 @@ class CFunctionGen():
             'uint32'    :'BUINT32',
             'uint64'    :'BUINT64',
             'uint128'   :'BUINT128',
-            'uint256'   :'BUINT256',
             'int8'      :'BSINT8',
             'int16'     :'BSINT16',
             'int32'     :'BSINT32',
             'int64'     :'BSINT64',
-            'int128'    :'BSINT128',
-            'int256'    :'BSINT256'
+            'int128'    :'BSINT128'
         }
 
         if abitype in types_to_change_endian.keys():
@@ -202,13 +198,25 @@ class CFunctionGen():
             return False
 
 
+    # BUINT256 and BSINT256 are limbs in host endian, which are converted to
+    # bigendian by the SDK
+    def get_bigendian_converter(self, abitype):
+        types_to_bigendian = {
+            'uint256'   :'UtilityUint256ToBigendian',
+            'int256'    :'UtilityInt256ToBigendian'
+        }
+
+        if abitype in types_to_bigendian.keys():
+            return types_to_bigendian[abitype]
+        else:
+            return None
+
+
     def is_array_type(self, abitype):
         types_of_array = {
             'address'   :'BoatAddress',
             'uint128'   :'BUINT128',
             'int128'    :'BSINT128',
-            'uint256'   :'BUINT256',
-            'int256'    :'BSINT256',
             'bytes1'    :'Bbytes1',
             'bytes2'    :'Bbytes2',
             'bytes3'    :'Bbytes3',
@@ -533,7 +541,9 @@ class CFunctionGen():
                 c_address_sign = '&'
 
             inputName_str = self.gen_input_name(input)
-            if self.require_endian_change(input['type']) == True:
+            if self.get_bigendian_converter(input['type']) != None:
+                func_body_str += '    ' + self.get_bigendian_converter(input['type']) + '(data_offset_ptr, &' + inputName_str + ');\n'
+            elif self.require_endian_change(input['type']) == True:
                 func_body_str += '    UtilityChangeEndian(' + c_address_sign + inputName_str + ', ' + param_size_str + ');\n'
                 func_body_str += '    memset(data_offset_ptr, 0x00, 32);\n'
                 func_body_str += '    memcpy(data_offset_ptr+(32-' + param_size_str + '), ' + c_address_sign + inputName_str + ', ' + param_size_str + ');\n'